@@ -1,5 +1,7 @@
 struct PushConstants
 {
+	float2 uvScale; // the scene's only rendered into this much of its target (dynamic resolution)
+	float2 uvMax;
 	int mipLevel;
 };
 
@@ -15,6 +17,11 @@ struct PSInput
 Texture2D renderTarget : register(t0);
 SamplerState samplerState : register(s0);
 
+float4 sampleScene(float2 uv)
+{
+	return renderTarget.Sample(samplerState, min(uv, pc.uvMax));
+}
+
 float rgbToLuminance(float3 col)
 {
 	return dot(col, float3(0.2126, 0.7152, 0.0722));
@@ -38,21 +45,21 @@ float4 main(PSInput input) : SV_TARGET
 	float dx = texelSize.x;
 	float dy = texelSize.y;
 	
-	float2 uv = input.texCoord;
+	float2 uv = input.texCoord * pc.uvScale;
 	
-	float3 a = renderTarget.Sample(samplerState, float2(uv.x - 2*dx,	uv.y + 2*dy	)).rgb;
-	float3 b = renderTarget.Sample(samplerState, float2(uv.x,			uv.y + 2*dy	)).rgb;
-	float3 c = renderTarget.Sample(samplerState, float2(uv.x + 2*dx,	uv.y + 2*dy	)).rgb;
-	float3 d = renderTarget.Sample(samplerState, float2(uv.x - 2*dx,	uv.y		)).rgb;
-	float3 e = renderTarget.Sample(samplerState, float2(uv.x,			uv.y		)).rgb;
-	float3 f = renderTarget.Sample(samplerState, float2(uv.x + 2*dx,	uv.y		)).rgb;
-	float3 g = renderTarget.Sample(samplerState, float2(uv.x - 2*dx,	uv.y - 2*dy	)).rgb;
-	float3 h = renderTarget.Sample(samplerState, float2(uv.x,			uv.y - 2*dy	)).rgb;
-	float3 i = renderTarget.Sample(samplerState, float2(uv.x + 2*dx,	uv.y - 2*dy	)).rgb;
-	float3 j = renderTarget.Sample(samplerState, float2(uv.x -   dx,	uv.y +   dy	)).rgb;
-	float3 k = renderTarget.Sample(samplerState, float2(uv.x +   dx,	uv.y +   dy	)).rgb;
-	float3 l = renderTarget.Sample(samplerState, float2(uv.x -   dx,	uv.y -   dy	)).rgb;
-	float3 m = renderTarget.Sample(samplerState, float2(uv.x +   dx,	uv.y -   dy	)).rgb;
+	float3 a = sampleScene(float2(uv.x - 2*dx,	uv.y + 2*dy	)).rgb;
+	float3 b = sampleScene(float2(uv.x,			uv.y + 2*dy	)).rgb;
+	float3 c = sampleScene(float2(uv.x + 2*dx,	uv.y + 2*dy	)).rgb;
+	float3 d = sampleScene(float2(uv.x - 2*dx,	uv.y		)).rgb;
+	float3 e = sampleScene(float2(uv.x,			uv.y		)).rgb;
+	float3 f = sampleScene(float2(uv.x + 2*dx,	uv.y		)).rgb;
+	float3 g = sampleScene(float2(uv.x - 2*dx,	uv.y - 2*dy	)).rgb;
+	float3 h = sampleScene(float2(uv.x,			uv.y - 2*dy	)).rgb;
+	float3 i = sampleScene(float2(uv.x + 2*dx,	uv.y - 2*dy	)).rgb;
+	float3 j = sampleScene(float2(uv.x -   dx,	uv.y +   dy	)).rgb;
+	float3 k = sampleScene(float2(uv.x +   dx,	uv.y +   dy	)).rgb;
+	float3 l = sampleScene(float2(uv.x -   dx,	uv.y -   dy	)).rgb;
+	float3 m = sampleScene(float2(uv.x +   dx,	uv.y -   dy	)).rgb;
 	
 	float3 downsample = 0.0;
 	
@@ -18,6 +18,7 @@ struct FrameUBO
     float4x4 projMatrix;
     float4x4 viewMatrix;
     float4 viewPos;
+    float4 irradianceSH[9];
 //    Light lights[MAX_N_LIGHTS];
 };
 
@@ -40,7 +41,6 @@ struct PushConstants
 {
 	int transform_ID;
 	
-	int irradianceMap_ID;
 	int prefilterMap_ID;
 	
 	int brdfLUT_ID;
@@ -0,0 +1,45 @@
+struct PushConstants
+{
+	float4x4 proj;
+	float4 origin;
+};
+
+[[vk::push_constant]]
+PushConstants pc;
+
+// the rotation part of each face's view matrix, +x, -x, +y, -y, +z, -z.
+// these are the same lookAts the faces used to be drawn with one at a time.
+static const float3x3 FACE_ROTATIONS[6] = {
+	float3x3( 0.0, 0.0, 1.0,	 0.0, 1.0, 0.0,		-1.0, 0.0, 0.0),
+	float3x3( 0.0, 0.0,-1.0,	 0.0, 1.0, 0.0,		 1.0, 0.0, 0.0),
+	float3x3( 1.0, 0.0, 0.0,	 0.0, 0.0, 1.0,		 0.0,-1.0, 0.0),
+	float3x3( 1.0, 0.0, 0.0,	 0.0, 0.0,-1.0,		 0.0, 1.0, 0.0),
+	float3x3( 1.0, 0.0, 0.0,	 0.0, 1.0, 0.0,		 0.0, 0.0, 1.0),
+	float3x3(-1.0, 0.0, 0.0,	 0.0, 1.0, 0.0,		 0.0, 0.0,-1.0)
+};
+
+struct VSInput
+{
+	[[vk::location(0)]]
+	float3 position : POSITION;
+};
+
+struct VSOutput
+{
+	float4 svPosition : SV_Position;
+	
+	[[vk::location(0)]]
+	float3 worldPos : TEXCOORD0;
+};
+
+// drawn once per face in a multiview pass, the view index picks which
+VSOutput main(VSInput input, uint viewID : SV_ViewID)
+{
+	float3 viewPos = mul(FACE_ROTATIONS[viewID], input.position - pc.origin.xyz);
+
+	VSOutput output;
+	output.svPosition = mul(pc.proj, float4(viewPos, 1.0));
+	output.worldPos = input.position;
+
+	return output;
+}
@@ -2,6 +2,8 @@ struct PushConstants
 {
 	float exposure;
 	float bloomIntensity;
+	float2 uvScale; // the scene's only rendered into this much of its target (dynamic resolution)
+	float2 uvMax;
 };
 
 [[vk::push_constant]]
@@ -21,7 +23,9 @@ SamplerState bloomSampler : register(s1);
 
 float4 main(PSInput input) : SV_TARGET
 {
-	float3 col = renderTarget.Sample(samplerState, input.uv).rgb;
+	float2 sceneUV = min(input.uv * pc.uvScale, pc.uvMax);
+
+	float3 col = renderTarget.Sample(samplerState, sceneUV).rgb;
 	float3 bloom = bloomTexture.Sample(bloomSampler, input.uv).rgb;
 	
 	col = lerp(col, bloom, pc.bloomIntensity);
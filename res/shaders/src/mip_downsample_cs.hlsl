@@ -0,0 +1,182 @@
+// single pass mip generation, along the same lines as amd's spd.
+// every group reduces a 64x64 tile of the source down to 1x1 (six levels), and the last
+// group to finish per slice picks up those 1x1 results and reduces them another six levels.
+
+#define TILE_SIZE 64
+#define MAX_MIPS 12
+
+struct PushConstants
+{
+	uint2 sourceSize;
+	uint mipCount;		// levels to write below the source, at most 12
+	uint tileCount;		// groups per slice
+	uint isSRGB;
+};
+
+[[vk::push_constant]]
+PushConstants pc;
+
+// srgb textures are bound through unorm views, so the conversions happen here
+[[vk::binding(0, 0)]] Texture2DArray<float4> source;
+[[vk::binding(1, 0)]] RWTexture2DArray<float4> mips[MAX_MIPS];
+
+[[vk::binding(2, 0)]] globallycoherent RWStructuredBuffer<uint> counters;
+[[vk::binding(3, 0)]] globallycoherent RWStructuredBuffer<float4> midMip;
+
+groupshared float4 tileValues[16][16];
+groupshared uint isLastGroup;
+
+float3 srgbToLinear(float3 col)
+{
+	return col <= 0.04045 ? col / 12.92 : pow((col + 0.055) / 1.055, 2.4);
+}
+
+float3 linearToSrgb(float3 col)
+{
+	return col <= 0.0031308 ? col * 12.92 : 1.055 * pow(col, 1.0 / 2.4) - 0.055;
+}
+
+float4 loadTexel(bool fromMidMip, uint2 pos, uint slice)
+{
+	if (fromMidMip)
+	{
+		uint2 midSize = max(pc.sourceSize >> 6, 1);
+		pos = min(pos, midSize - 1);
+
+		return midMip[(slice * TILE_SIZE + pos.y) * TILE_SIZE + pos.x];
+	}
+
+	pos = min(pos, pc.sourceSize - 1);
+
+	float4 col = source.Load(int4(pos, slice, 0));
+
+	if (pc.isSRGB) {
+		col.rgb = srgbToLinear(col.rgb);
+	}
+
+	return col;
+}
+
+float4 reduceQuad(bool fromMidMip, uint2 pos, uint slice)
+{
+	return (
+		loadTexel(fromMidMip, pos + uint2(0, 0), slice) +
+		loadTexel(fromMidMip, pos + uint2(1, 0), slice) +
+		loadTexel(fromMidMip, pos + uint2(0, 1), slice) +
+		loadTexel(fromMidMip, pos + uint2(1, 1), slice)
+	) * 0.25;
+}
+
+void storeTexel(uint mip, uint2 pos, uint slice, float4 col)
+{
+	if (mip > pc.mipCount) {
+		return;
+	}
+
+	uint2 mipSize = max(pc.sourceSize >> mip, 1);
+
+	if (any(pos >= mipSize)) {
+		return;
+	}
+
+	if (pc.isSRGB) {
+		col.rgb = linearToSrgb(col.rgb);
+	}
+
+	mips[mip - 1][uint3(pos, slice)] = col;
+}
+
+// reduces one 64x64 tile six levels, leaving the final 1x1 value in tileValues[0][0]
+void downsampleTile(uint2 tile, uint2 thread, uint slice, uint baseMip, bool fromMidMip)
+{
+	// first two levels: each thread takes a 4x4 block
+	uint2 blockPos = tile * TILE_SIZE + thread * 4;
+
+	float4 quads[4];
+
+	[unroll]
+	for (uint i = 0; i < 4; i++)
+	{
+		uint2 offset = uint2(i & 1, i >> 1);
+
+		quads[i] = reduceQuad(fromMidMip, blockPos + offset * 2, slice);
+		storeTexel(baseMip + 1, tile * (TILE_SIZE / 2) + thread * 2 + offset, slice, quads[i]);
+	}
+
+	float4 col = (quads[0] + quads[1] + quads[2] + quads[3]) * 0.25;
+	storeTexel(baseMip + 2, tile * (TILE_SIZE / 4) + thread, slice, col);
+
+	tileValues[thread.y][thread.x] = col;
+
+	// the other four levels reduce the 16x16 results in group shared memory
+	uint size = 16;
+
+	[unroll]
+	for (uint level = 3; level <= 6; level++)
+	{
+		GroupMemoryBarrierWithGroupSync();
+
+		size >>= 1;
+
+		bool active = all(thread < size);
+
+		if (active)
+		{
+			uint2 pos = thread * 2;
+
+			col = (
+				tileValues[pos.y + 0][pos.x + 0] +
+				tileValues[pos.y + 0][pos.x + 1] +
+				tileValues[pos.y + 1][pos.x + 0] +
+				tileValues[pos.y + 1][pos.x + 1]
+			) * 0.25;
+
+			storeTexel(baseMip + level, tile * size + thread, slice, col);
+		}
+
+		GroupMemoryBarrierWithGroupSync();
+
+		if (active) {
+			tileValues[thread.y][thread.x] = col;
+		}
+	}
+}
+
+[numthreads(256, 1, 1)]
+void main(uint3 groupID : SV_GroupID, uint localIndex : SV_GroupIndex)
+{
+	uint2 thread = uint2(localIndex % 16, localIndex / 16);
+	uint slice = groupID.z;
+
+	downsampleTile(groupID.xy, thread, slice, 0, false);
+
+	if (pc.mipCount <= 6) {
+		return;
+	}
+
+	// hand this tile's 1x1 result over, whoever finishes last carries on with all of them
+	if (localIndex == 0)
+	{
+		midMip[(slice * TILE_SIZE + groupID.y) * TILE_SIZE + groupID.x] = tileValues[0][0];
+
+		DeviceMemoryBarrier();
+
+		uint previous = 0;
+		InterlockedAdd(counters[slice], 1, previous);
+
+		isLastGroup = (previous == pc.tileCount - 1) ? 1 : 0;
+
+		// ready for the next dispatch
+		if (isLastGroup) {
+			counters[slice] = 0;
+		}
+	}
+
+	AllMemoryBarrierWithGroupSync();
+
+	if (isLastGroup == 0) {
+		return;
+	}
+
+	downsampleTile(uint2(0, 0), thread, slice, 6, true);
+}
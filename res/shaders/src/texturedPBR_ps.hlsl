@@ -50,6 +50,25 @@ float geometrySmith(float NdotV, float NdotL, float roughness)
 	return ggx1 * ggx2;
 }
 
+// the coefficients come premultiplied by the cosine lobe and the basis constants, so this is just the polynomial
+float3 evaluateIrradianceSH(float3 n)
+{
+	float3 irradiance = frameData.irradianceSH[0].rgb;
+	
+	irradiance += frameData.irradianceSH[1].rgb * n.y;
+	irradiance += frameData.irradianceSH[2].rgb * n.z;
+	irradiance += frameData.irradianceSH[3].rgb * n.x;
+	
+	irradiance += frameData.irradianceSH[4].rgb * (n.x * n.y);
+	irradiance += frameData.irradianceSH[5].rgb * (n.y * n.z);
+	irradiance += frameData.irradianceSH[6].rgb * (3.0 * n.z * n.z - 1.0);
+	irradiance += frameData.irradianceSH[7].rgb * (n.x * n.z);
+	irradiance += frameData.irradianceSH[8].rgb * (n.x * n.x - n.y * n.y);
+	
+	// ringing can take the odd direction just under zero
+	return max(irradiance, 0.0);
+}
+
 float4 main(PSInput input) : SV_Target
 {
 	float2 uv = frac(input.texCoord);
@@ -60,7 +79,7 @@ float4 main(PSInput input) : SV_Target
 	float3 albedo				= texture2DTable[pc.diffuseTexture_ID]	.Sample(textureSampler, uv).rgb;
 	float ambientOcclusion		= texture2DTable[pc.aoTexture_ID]		.Sample(textureSampler, uv).r;
 	float3 metallicRoughness	= texture2DTable[pc.mrTexture_ID]		.Sample(textureSampler, uv).rgb;
-	float3 normal				= texture2DTable[pc.normalTexture_ID]	.Sample(textureSampler, uv).rgb;
+	float2 normalXY				= texture2DTable[pc.normalTexture_ID]	.Sample(textureSampler, uv).rg;
 	float3 emissive				= texture2DTable[pc.emissiveTexture_ID]	.Sample(textureSampler, uv).rgb;
 	
 	ambientOcclusion += metallicRoughness.r;
@@ -69,7 +88,12 @@ float4 main(PSInput input) : SV_Target
 	
 	float3 F0 = lerp(0.04, albedo, metallicValue);
 	
-	normal = normalize(mul(normalize(2.0 * normal - 1.0), input.tbn));
+	// normal maps can be bc5 (only xy stored), so z is always rebuilt
+	float3 normal;
+	normal.xy = 2.0 * normalXY - 1.0;
+	normal.z = sqrt(saturate(1.0 - dot(normal.xy, normal.xy)));
+	
+	normal = normalize(mul(normal, input.tbn));
 	float3 viewDir = normalize(frameData.viewPos.xyz - input.position);
 	
 	float NdotV = max(0.0, dot(normal, viewDir));
@@ -120,7 +144,7 @@ float4 main(PSInput input) : SV_Target
 	float2 environmentBRDF = texture2DTable[pc.brdfLUT_ID].Sample(textureSampler, float2(NdotV, roughnessValue)).xy;
 	float3 specular = prefilteredColour * (F * environmentBRDF.x + environmentBRDF.y);
 	
-	float3 irradiance = textureCubeTable[pc.irradianceMap_ID].Sample(cubemapSampler, normal).rgb;
+	float3 irradiance = evaluateIrradianceSH(normal);
 	float3 diffuse = irradiance * albedo;
 	float3 ambient = (kD * diffuse + specular) * ambientOcclusion;
 	
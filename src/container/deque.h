@@ -11,20 +11,19 @@ namespace llt
 	/**
 	 * Dynamically-resizing double ended queue to which you can add
 	 * new objects or pick the first one out of the queue.
+	 *
+	 * Elements live in fixed size chunks, and a map of chunk pointers keeps them in order.
+	 * When either end runs out of chunks the used ones are moved back into the middle of the map,
+	 * which only grows once more than half of it is in use, so a queue that pushes at the back and
+	 * pops at the front keeps reusing the same chunks.
 	 */
-	template <typename T, uint64_t ChunkSize = 64>
+	template <typename T, uint64_t ChunkSize = 64, MemTag Tag = MEM_TAG_CONTAINERS>
 	class Deque
 	{
-		enum
-		{
-			EXPAND_FRONT,
-			EXPAND_BACK
-		};
-
 	public:
 		class Iterator
 		{
-			friend class Deque<T, ChunkSize>;
+			friend class Deque<T, ChunkSize, Tag>;
 
 		public:
 			Iterator() : m_cur(nullptr), m_first(nullptr), m_last(nullptr), m_chunk(nullptr) { }
@@ -75,19 +74,20 @@ namespace llt
 			}
 
 			Iterator &operator += (int64_t d) {
-				int64_t offset = d + m_cur - m_first; // calculate our chunk offset
-				if (offset >= 0 && offset < ChunkSize) {
+				constexpr int64_t chunkSize = ChunkSize; // signed, so going backwards doesn't wrap around
+				int64_t offset = d + (m_cur - m_first); // calculate our chunk offset
+				if (offset >= 0 && offset < chunkSize) {
 					m_cur += d; // if we're not crossing over a chunk, just add it on
 				} else {
 					// calculate the number of chunks which we just crossed over
 					int64_t chunkOffset = 0;
 					if (offset > 0) {
-						chunkOffset = offset / ChunkSize;
+						chunkOffset = offset / chunkSize;
 					} else {
-						chunkOffset = ((offset + 1) / ChunkSize) - 1;
+						chunkOffset = ((offset + 1) / chunkSize) - 1;
 					}
 					setChunk(m_chunk + chunkOffset); // update our chunk accordingly
-					m_cur = m_first + (offset - (chunkOffset * ChunkSize)); // set our current location relative to the chunk
+					m_cur = m_first + (offset - (chunkOffset * chunkSize)); // set our current location relative to the chunk
 				}
 				return *this;
 			}
@@ -162,12 +162,26 @@ namespace llt
 		const T &operator [] (uint64_t idx) const;
 
 	private:
-		void increaseSize(int frontOrBack);
-		void expandFront();
-		void expandBack();
+		/*
+		 * Makes sure there's a free chunk on both sides of the used ones,
+		 * by moving them back into the middle of the map or growing it if it's too full.
+		 */
+		void makeRoom();
+
+		/*
+		 * Puts m_begin and m_end back at the start of the middle chunk, only for when it's empty.
+		 */
+		void resetEnds();
+
+		/*
+		 * Where the next element goes at either end, making room for it first if needed.
+		 */
+		T *nextFront();
+		T *nextBack();
 
 		constexpr int chunks() const;
 
+		// m_begin is the first element and m_end is one past the last, and both always point into a chunk
 		Iterator m_begin;
 		Iterator m_end;
 
@@ -176,71 +190,66 @@ namespace llt
 		uint64_t m_capacity;
 	};
 
-	template <typename T, uint64_t ChunkSize>
-	Deque<T, ChunkSize>::Deque(int initialCapacity)
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
+	Deque<T, ChunkSize, Tag>::Deque(int initialCapacity)
 		: m_begin()
 		, m_end()
 		, m_map(nullptr)
 		, m_size(0)
 		, m_capacity(0)
 	{
-		T **newMap = (T **)::operator new (sizeof(T *) * initialCapacity);
-		mem::set(newMap, 0, sizeof(T *) * initialCapacity);
+		if (initialCapacity < 1) {
+			initialCapacity = 1;
+		}
 
-		T **base = newMap + (initialCapacity / 2);
+		m_map = (T **)mem::alloc(sizeof(T *) * initialCapacity, Tag);
 
 		// allocate the initial capacity of chunks
 		for (int j = 0; j < initialCapacity; j++) {
-			if (!newMap[j]) {
-				newMap[j] = (T *)::operator new (sizeof(T) * ChunkSize);
-			}
+			m_map[j] = (T *)mem::alloc(sizeof(T) * ChunkSize, Tag);
 		}
 
-		m_map = newMap;
 		m_capacity = initialCapacity * ChunkSize;
 
-		m_begin.setChunk(base);
-		m_begin.m_cur = m_begin.m_first;
-
-		m_end.setChunk(base);
-		m_end.m_cur = m_end.m_first + 1;
+		resetEnds();
 	}
 
-	template <typename T, uint64_t ChunkSize>
-	Deque<T, ChunkSize>::Deque(const Deque &other)
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
+	Deque<T, ChunkSize, Tag>::Deque(const Deque &other)
 		: Deque()
 	{
-		clear();
-
-		// add all the chunks from the other double ended queue
-		for (T *cur = other.m_begin.m_cur + 1; cur < other.m_end.m_cur; cur++) {
-			pushBack(*cur);
+		// add all the elements from the other double ended queue
+		for (Iterator it = other.m_begin; it != other.m_end; it++) {
+			pushBack(*it);
 		}
 	}
 
-	template <typename T, uint64_t ChunkSize>
-	Deque<T, ChunkSize>::Deque(Deque &&other) noexcept
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
+	Deque<T, ChunkSize, Tag>::Deque(Deque &&other) noexcept
 		: Deque()
 	{
-		clear();
 		swap(other);
 	}
 
-	template <typename T, uint64_t ChunkSize>
-	Deque<T, ChunkSize> &Deque<T, ChunkSize>::operator = (const Deque &other)
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
+	Deque<T, ChunkSize, Tag> &Deque<T, ChunkSize, Tag>::operator = (const Deque &other)
 	{
+		if (this == &other) {
+			return *this;
+		}
+
 		clear();
 
-		// add all the chunks from the other double ended queue
-		for (T *cur = other.m_begin.m_cur + 1; cur < other.m_end.m_cur; cur++) {
-			pushBack(*cur);
+		// add all the elements from the other double ended queue
+		for (Iterator it = other.m_begin; it != other.m_end; it++) {
+			pushBack(*it);
 		}
 
 		return *this;
 	}
 
-	template <typename T, uint64_t ChunkSize>
-	Deque<T, ChunkSize> &Deque<T, ChunkSize>::operator = (Deque &&other) noexcept
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
+	Deque<T, ChunkSize, Tag> &Deque<T, ChunkSize, Tag>::operator = (Deque &&other) noexcept
 	{
 		clear();
 		swap(other);
@@ -248,132 +257,153 @@ namespace llt
 		return *this;
 	}
 
-	template <typename T, uint64_t ChunkSize>
-	Deque<T, ChunkSize>::~Deque()
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
+	Deque<T, ChunkSize, Tag>::~Deque()
 	{
+		if (!m_map) {
+			return;
+		}
+
 		clear();
 
 		for (int i = 0; i < chunks(); i++) {
-			::operator delete (m_map[i], sizeof(T) * ChunkSize);
+			mem::free(m_map[i], sizeof(T) * ChunkSize, Tag);
 		}
 
-		::operator delete (m_map, sizeof(T *) * chunks());
+		mem::free(m_map, sizeof(T *) * chunks(), Tag);
 
 		m_map = nullptr;
 		m_capacity = 0;
 		m_size = 0;
 	}
 
-	template <typename T, uint64_t ChunkSize>
-	void Deque<T, ChunkSize>::clear()
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
+	void Deque<T, ChunkSize, Tag>::clear()
 	{
-		for (Iterator ptr = m_begin + 1; ptr.m_cur <= m_end.m_cur; ptr++) {
-			ptr.get()->~T();
-		}
-
-		for (int i = 0; i < chunks(); i++) {
-			mem::set(m_map[i], 0, sizeof(T) * ChunkSize);
+		for (Iterator it = m_begin; it != m_end; it++) {
+			it.get()->~T();
 		}
 
 		m_size = 0;
 
-		T **base  = m_map + (chunks() / 2);
+		resetEnds();
+	}
+
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
+	void Deque<T, ChunkSize, Tag>::resetEnds()
+	{
+		T **base = m_map + (chunks() / 2);
 
 		m_begin.setChunk(base);
 		m_begin.m_cur = m_begin.m_first;
 
-		m_end.setChunk(base);
-		m_end.m_cur = m_end.m_first + 1;
+		m_end = m_begin;
 	}
 
-	template <typename T, uint64_t ChunkSize>
-	void Deque<T, ChunkSize>::increaseSize(int frontOrBack)
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
+	void Deque<T, ChunkSize, Tag>::makeRoom()
 	{
-		// double our number of chunks
-		uint64_t numChunks = chunks() * 2;
-
-		// allocate our map!
-		T **newMap = (T**)::operator new (sizeof(T *) * numChunks);
-		mem::set(newMap, 0, sizeof(T *) * numChunks);
+		int oldChunks = chunks();
+		int firstUsed = m_begin.m_chunk - m_map;
+		int usedChunks = (m_end.m_chunk - m_begin.m_chunk) + 1;
 
-		int begin_offset = m_begin	.m_cur   - m_begin	.m_first;
-		int end_offset   = m_end  	.m_cur   - m_end	.m_first;
-		int begin_chunk  = m_begin	.m_chunk - m_map			;
-		int end_chunk    = m_end	.m_chunk - m_begin	.m_chunk;
+		// only grow once more than half is used, otherwise recentring happens too often to be worth it
+		int newChunks = oldChunks;
 
-		// copy our data map to specific regions depending on what direction we are allocating in
-		if (frontOrBack == EXPAND_FRONT) {
-			mem::copy(newMap + chunks(), m_map, sizeof(T *) * chunks());
-		} else if (frontOrBack == EXPAND_BACK) {
-			mem::copy(newMap, m_map, sizeof(T *) * chunks());
+		while (usedChunks * 2 + 2 > newChunks) {
+			newChunks *= 2;
 		}
 
-		// allocate the new size
-		for (int j = 0; j < numChunks; j++) {
-			if (!newMap[j]) {
-				newMap[j] = (T *)::operator new (sizeof(T) * ChunkSize);
+		T **newMap = (T **)mem::alloc(sizeof(T *) * newChunks, Tag);
+
+		int newFirst = (newChunks - usedChunks) / 2;
+
+		mem::copy(newMap + newFirst, m_map + firstUsed, sizeof(T *) * usedChunks);
+
+		// the chunks that weren't in use are handed out again before any new ones get allocated
+		int spare = 0;
+
+		for (int j = 0; j < newChunks; j++)
+		{
+			if (j >= newFirst && j < newFirst + usedChunks) {
+				continue;
+			}
+
+			if (spare == firstUsed) {
+				spare += usedChunks;
 			}
-		}
 
-		// set our begin and end iterator chunks to the new
-		// expended-to locations depending on the direction
-		// in which we are allocating.
-		if (frontOrBack == EXPAND_FRONT) {
-			m_begin.setChunk(newMap + chunks());
-			m_end  .setChunk(newMap + chunks() + end_chunk);
-		} else if (frontOrBack == EXPAND_BACK) {
-			m_begin.setChunk(newMap + begin_chunk + 1);
-			m_end  .setChunk(newMap + chunks() - 1);
+			if (spare < oldChunks) {
+				newMap[j] = m_map[spare++];
+			} else {
+				newMap[j] = (T *)mem::alloc(sizeof(T) * ChunkSize, Tag);
+			}
 		}
 
-		m_begin.m_cur = m_begin.m_first + begin_offset;
-		m_end  .m_cur = m_end  .m_first + end_offset;
+		int beginOffset = m_begin.m_cur - m_begin.m_first;
+		int endOffset = m_end.m_cur - m_end.m_first;
+
+		m_begin.setChunk(newMap + newFirst);
+		m_begin.m_cur = m_begin.m_first + beginOffset;
+
+		m_end.setChunk(newMap + newFirst + usedChunks - 1);
+		m_end.m_cur = m_end.m_first + endOffset;
 
-		// destroy our old map
-		::operator delete (m_map, sizeof(T *) * m_capacity);
+		mem::free(m_map, sizeof(T *) * oldChunks, Tag);
 
 		m_map = newMap;
-		m_capacity *= 2;
+		m_capacity = newChunks * ChunkSize;
 	}
 
-	template <typename T, uint64_t ChunkSize>
-	void Deque<T, ChunkSize>::expandFront()
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
+	T *Deque<T, ChunkSize, Tag>::nextFront()
 	{
-		if ((m_begin - 1).m_chunk <= m_map) {
-			increaseSize(EXPAND_FRONT);
+		if (m_begin.m_cur == m_begin.m_first && m_begin.m_chunk == m_map) {
+			makeRoom();
 		}
+
+		m_begin--;
 		m_size++;
+
+		return m_begin.get();
 	}
 
-	template <typename T, uint64_t ChunkSize>
-	void Deque<T, ChunkSize>::expandBack()
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
+	T *Deque<T, ChunkSize, Tag>::nextBack()
 	{
-		if ((m_end + 1).m_chunk >= (m_map + chunks())) {
-			increaseSize(EXPAND_BACK);
+		// m_end has to be able to step past the new element without leaving the map
+		if (m_end.m_cur + 1 == m_end.m_last && m_end.m_chunk + 1 == m_map + chunks()) {
+			makeRoom();
 		}
+
+		T *slot = m_end.get();
+
+		m_end++;
 		m_size++;
+
+		return slot;
 	}
 
-	template <typename T, uint64_t ChunkSize>
-	constexpr int Deque<T, ChunkSize>::chunks() const
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
+	constexpr int Deque<T, ChunkSize, Tag>::chunks() const
 	{
 		return m_capacity / ChunkSize;
 	}
 
-	template <typename T, uint64_t ChunkSize>
-	bool Deque<T, ChunkSize>::empty() const
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
+	bool Deque<T, ChunkSize, Tag>::empty() const
 	{
 		return m_size == 0;
 	}
 
-	template <typename T, uint64_t ChunkSize>
-	uint64_t Deque<T, ChunkSize>::size() const
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
+	uint64_t Deque<T, ChunkSize, Tag>::size() const
 	{
 		return m_size;
 	}
 
-	template <typename T, uint64_t ChunkSize>
-	void Deque<T, ChunkSize>::swap(Deque &other)
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
+	void Deque<T, ChunkSize, Tag>::swap(Deque &other)
 	{
 		Iterator t_begin = this->m_begin;
 		Iterator t_end = this->m_end;
@@ -394,118 +424,116 @@ namespace llt
 		other.m_capacity = t_capacity;
 	}
 
-	template <typename T, uint64_t ChunkSize>
-	T &Deque<T, ChunkSize>::pushFront(const T &item)
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
+	T &Deque<T, ChunkSize, Tag>::pushFront(const T &item)
 	{
-		expandFront();
-		(*m_begin) = std::move(item);
-		m_begin--;
-		return *(m_begin + 1);
+		return *new (nextFront()) T(item);
 	}
 
-	template <typename T, uint64_t ChunkSize>
-	T &Deque<T, ChunkSize>::pushBack(const T &item)
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
+	T &Deque<T, ChunkSize, Tag>::pushBack(const T &item)
 	{
-		expandBack();
-		(*m_end) = std::move(item);
-		m_end++;
-		return *(m_end - 1);
+		return *new (nextBack()) T(item);
 	}
 
-	template <typename T, uint64_t ChunkSize>
-	T Deque<T, ChunkSize>::popFront()
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
+	T Deque<T, ChunkSize, Tag>::popFront()
 	{
 		LLT_ASSERT(m_size > 0, "Deque must not be empty!");
-		m_size--;
+
+		T item = std::move(*m_begin);
+		m_begin.get()->~T();
+
 		m_begin++;
-		return *m_begin;
+		m_size--;
+
+		return item;
 	}
 
-	template <typename T, uint64_t ChunkSize>
-	T Deque<T, ChunkSize>::popBack()
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
+	T Deque<T, ChunkSize, Tag>::popBack()
 	{
 		LLT_ASSERT(m_size > 0, "Deque must not be empty!");
-		m_size--;
+
 		m_end--;
-		return *m_end;
+		m_size--;
+
+		T item = std::move(*m_end);
+		m_end.get()->~T();
+
+		return item;
 	}
 
-	template <typename T, uint64_t ChunkSize>
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
 	template <typename ...Args>
-	T &Deque<T, ChunkSize>::emplaceFront(Args &&...args)
+	T &Deque<T, ChunkSize, Tag>::emplaceFront(Args &&...args)
 	{
-		expandFront();
-		new (m_begin.get()) T(std::forward<Args>(args)...);
-		m_begin--;
-		return *(m_begin + 1);
+		return *new (nextFront()) T(std::forward<Args>(args)...);
 	}
 
-	template <typename T, uint64_t ChunkSize>
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
 	template <typename ...Args>
-	T &Deque<T, ChunkSize>::emplaceBack(Args &&...args)
+	T &Deque<T, ChunkSize, Tag>::emplaceBack(Args &&...args)
 	{
-		expandBack();
-		new (m_end.get()) T(std::forward<Args>(args)...);
-		m_end++;
-		return *(m_end - 1);
+		return *new (nextBack()) T(std::forward<Args>(args)...);
 	}
 
-	template <typename T, uint64_t ChunkSize>
-	T &Deque<T, ChunkSize>::front()
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
+	T &Deque<T, ChunkSize, Tag>::front()
 	{
-		return *(m_begin + 1);
+		return *m_begin;
 	}
 
-	template <typename T, uint64_t ChunkSize>
-	const T &Deque<T, ChunkSize>::front() const
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
+	const T &Deque<T, ChunkSize, Tag>::front() const
 	{
-		return *(m_begin + 1);
+		return *m_begin;
 	}
 
-	template <typename T, uint64_t ChunkSize>
-	T &Deque<T, ChunkSize>::back()
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
+	T &Deque<T, ChunkSize, Tag>::back()
 	{
 		return *(m_end - 1);
 	}
 
-	template <typename T, uint64_t ChunkSize>
-	const T &Deque<T, ChunkSize>::back() const
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
+	const T &Deque<T, ChunkSize, Tag>::back() const
 	{
 		return *(m_end - 1);
 	}
 
-	template <typename T, uint64_t ChunkSize>
-	typename Deque<T, ChunkSize>::Iterator Deque<T, ChunkSize>::begin()
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
+	typename Deque<T, ChunkSize, Tag>::Iterator Deque<T, ChunkSize, Tag>::begin()
 	{
 		return m_begin;
 	}
 
-	template <typename T, uint64_t ChunkSize>
-	typename Deque<T, ChunkSize>::Iterator Deque<T, ChunkSize>::end()
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
+	typename Deque<T, ChunkSize, Tag>::Iterator Deque<T, ChunkSize, Tag>::end()
 	{
 		return m_end;
 	}
 
-	template <typename T, uint64_t ChunkSize>
-	T &Deque<T, ChunkSize>::at(uint64_t idx)
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
+	T &Deque<T, ChunkSize, Tag>::at(uint64_t idx)
 	{
 		return m_begin[idx];
 	}
 
-	template <typename T, uint64_t ChunkSize>
-	const T &Deque<T, ChunkSize>::at(uint64_t idx) const
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
+	const T &Deque<T, ChunkSize, Tag>::at(uint64_t idx) const
 	{
 		return m_begin[idx];
 	}
 
-	template <typename T, uint64_t ChunkSize>
-	T &Deque<T, ChunkSize>::operator [] (uint64_t idx)
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
+	T &Deque<T, ChunkSize, Tag>::operator [] (uint64_t idx)
 	{
 		return m_begin[idx];
 	}
 
-	template <typename T, uint64_t ChunkSize>
-	const T &Deque<T, ChunkSize>::operator [] (uint64_t idx) const
+	template <typename T, uint64_t ChunkSize, MemTag Tag>
+	const T &Deque<T, ChunkSize, Tag>::operator [] (uint64_t idx) const
 	{
 		return m_begin[idx];
 	}
@@ -48,6 +48,8 @@ namespace llt
 
 		~Function();
 
+		Function &operator = (const Function &other);
+
 		Result call(Args ...args) const;
 		Result operator ()(Args ...args) const;
 
@@ -124,6 +126,35 @@ namespace llt
 		delete[] m_data;
 	}
 
+	template <typename Result, typename ...Args>
+	Function<Result(Args ...)> &Function<Result(Args ...)>::operator = (const Function<Result(Args ...)> &other)
+	{
+		if (this == &other) {
+			return *this;
+		}
+
+		// destroy whatever we were holding before taking a deep copy of the other function
+		if (m_destroyFn && m_data) {
+			m_destroyFn(m_data);
+		}
+
+		delete[] m_data;
+
+		m_callFn = other.m_callFn;
+		m_createFn = other.m_createFn;
+		m_destroyFn = other.m_destroyFn;
+		m_data = nullptr;
+		m_dataSize = other.m_dataSize;
+
+		if (m_callFn && other.m_data)
+		{
+			m_data = new byte[m_dataSize];
+			m_createFn(m_data, other.m_data);
+		}
+
+		return *this;
+	}
+
 	template <typename Result, typename ...Args>
 	Result Function<Result(Args ...)>::call(Args ...args) const
 	{
@@ -1,6 +1,9 @@
 #ifndef HASH_MAP_H_
 #define HASH_MAP_H_
 
+#include <new>
+#include <utility>
+
 #include "core/common.h"
 
 #include "pair.h"
@@ -10,8 +13,13 @@ namespace llt
 	/**
 	 * Dictionary structure that uses a getHash function
 	 * to index the different elements inside it.
+	 * Elements and buckets are counted under Tag.
+	 *
+	 * Every element is on one list (next/prev) that iteration walks, in bucket order, with each bucket's
+	 * elements next to each other and the bucket pointing at its first one. So a lookup only has to walk
+	 * from the bucket until the elements stop belonging to it.
 	 */
-	template <typename TKey, typename TValue>
+	template <typename TKey, typename TValue, MemTag Tag = MEM_TAG_CONTAINERS>
 	class HashMap
 	{
 	public:
@@ -136,24 +144,32 @@ namespace llt
 		void realloc();
 
 		/*
-		 * Re-Aligns the pointers for the first and last entries to ensure
-		 * that the iterators still work.
+		 * Puts an element into its bucket, and onto the list between the buckets either side of it.
 		 */
-		void realignPtrs();
+		void linkElement(Element *element);
 
 		/*
-		 * (Internal without pointer re-alignment)
+		 * (Internal without counting or growing)
 		 * Insert a key-value pair.
 		 */
 		void _insert(const KeyValuePair &pair);
 
+		/*
+		 * Where the element after this one would be, if it's still in the same bucket.
+		 */
+		Element *nextInBucket(const Element *element, int idx) const;
+
+		template <typename ...Args>
+		Element *allocElement(Args &&...args);
+		void freeElement(Element *element);
+
 		Element **m_elements;
 		int m_elementCount;
 		int m_capacity;
 	};
 
-	template <typename TKey, typename TValue>
-	HashMap<TKey, TValue>::HashMap()
+	template <typename TKey, typename TValue, MemTag Tag>
+	HashMap<TKey, TValue, Tag>::HashMap()
 		: m_elements(nullptr)
 		, m_elementCount(0)
 		, m_capacity(0)
@@ -161,8 +177,8 @@ namespace llt
 		realloc();
 	}
 
-	template <typename TKey, typename TValue>
-	HashMap<TKey, TValue>::HashMap(int initial_capacity)
+	template <typename TKey, typename TValue, MemTag Tag>
+	HashMap<TKey, TValue, Tag>::HashMap(int initial_capacity)
 		: m_elements(nullptr)
 		, m_elementCount(0)
 		, m_capacity(initial_capacity)
@@ -170,8 +186,8 @@ namespace llt
 		realloc();
 	}
 
-	template <typename TKey, typename TValue>
-	HashMap<TKey, TValue>::HashMap(const HashMap &other)
+	template <typename TKey, typename TValue, MemTag Tag>
+	HashMap<TKey, TValue, Tag>::HashMap(const HashMap &other)
 	{
 		this->m_elements = nullptr;
 		this->m_elementCount = other.m_elementCount;
@@ -186,26 +202,13 @@ namespace llt
 		/*
 		 * Add all elements in the other hashmap.
 		 */
-		for (int i = 0; i < other.m_capacity; i++)
-		{
-			if (other.m_elements[i])
-			{
-				Element *elemPtr = other.m_elements[i];
-
-				while (elemPtr) {
-					_insert(elemPtr->data);
-					elemPtr = elemPtr->next;
-				}
-
-				break;
-			}
+		for (const Element *e = other.first(); e; e = e->next) {
+			_insert(e->data);
 		}
-
-		realignPtrs();
 	}
 
-	template <typename TKey, typename TValue>
-	HashMap<TKey, TValue>::HashMap(HashMap &&other) noexcept
+	template <typename TKey, typename TValue, MemTag Tag>
+	HashMap<TKey, TValue, Tag>::HashMap(HashMap &&other) noexcept
 	{
 		this->m_elements = std::move(other.m_elements);
 		this->m_elementCount = std::move(other.m_elementCount);
@@ -216,9 +219,15 @@ namespace llt
 		other.m_capacity = 0;
 	}
 
-	template <typename TKey, typename TValue>
-	HashMap<TKey, TValue> &HashMap<TKey, TValue>::operator = (const HashMap &other)
+	template <typename TKey, typename TValue, MemTag Tag>
+	HashMap<TKey, TValue, Tag> &HashMap<TKey, TValue, Tag>::operator = (const HashMap &other)
 	{
+		if (this == &other) {
+			return *this;
+		}
+
+		clear();
+
 		this->m_elements = nullptr;
 		this->m_elementCount = other.m_elementCount;
 		this->m_capacity = other.m_capacity;
@@ -229,29 +238,18 @@ namespace llt
 			return *this;
 		}
 
-		for (int i = 0; i < other.m_capacity; i++)
-		{
-			if (other.m_elements[i])
-			{
-				Element *elemPtr = other.m_elements[i];
-
-				while (elemPtr) {
-					_insert(elemPtr->data);
-					elemPtr = elemPtr->next;
-				}
-
-				break;
-			}
+		for (const Element *e = other.first(); e; e = e->next) {
+			_insert(e->data);
 		}
 
-		realignPtrs();
-
 		return *this;
 	}
 
-	template <typename TKey, typename TValue>
-	HashMap<TKey, TValue> &HashMap<TKey, TValue>::operator = (HashMap &&other) noexcept
+	template <typename TKey, typename TValue, MemTag Tag>
+	HashMap<TKey, TValue, Tag> &HashMap<TKey, TValue, Tag>::operator = (HashMap &&other) noexcept
 	{
+		clear();
+
 		this->m_elements = std::move(other.m_elements);
 		this->m_elementCount = std::move(other.m_elementCount);
 		this->m_capacity = std::move(other.m_capacity);
@@ -263,61 +261,131 @@ namespace llt
 		return *this;
 	}
 
-	template <typename TKey, typename TValue>
-	HashMap<TKey, TValue>::~HashMap()
+	template <typename TKey, typename TValue, MemTag Tag>
+	HashMap<TKey, TValue, Tag>::~HashMap()
 	{
 		clear();
 	}
 
-	template <typename TKey, typename TValue>
-	void HashMap<TKey, TValue>::insert(const TKey &key, const TValue &value)
+	template <typename TKey, typename TValue, MemTag Tag>
+	void HashMap<TKey, TValue, Tag>::insert(const TKey &key, const TValue &value)
 	{
 		this->insert(KeyValuePair(key, value));
 	}
 
-	template <typename TKey, typename TValue>
-	void HashMap<TKey, TValue>::insert(const KeyValuePair &pair)
+	template <typename TKey, typename TValue, MemTag Tag>
+	void HashMap<TKey, TValue, Tag>::insert(const KeyValuePair &pair)
 	{
 		_insert(pair);
 
-		realignPtrs();
-
 		m_elementCount++;
+
+		// past one element per bucket on average the chains start getting long
+		if (m_elementCount >= m_capacity) {
+			realloc();
+		}
 	}
 
-	template <typename TKey, typename TValue>
-	void HashMap<TKey, TValue>::_insert(const KeyValuePair &pair)
+	template <typename TKey, typename TValue, MemTag Tag>
+	void HashMap<TKey, TValue, Tag>::_insert(const KeyValuePair &pair)
 	{
-		auto idx = indexOf(pair.first);
+		linkElement(allocElement(pair));
+	}
 
-		Element *b = m_elements[idx];
+	template <typename TKey, typename TValue, MemTag Tag>
+	void HashMap<TKey, TValue, Tag>::linkElement(Element *element)
+	{
+		int idx = indexOf(element->data.first);
+
+		Element *head = m_elements[idx];
 
-		if (b)
+		// goes in second so the bucket doesn't have to be walked to find its end
+		if (head)
 		{
-			while (b->next) {
-				b = b->next;
+			element->prev = head;
+			element->next = head->next;
+
+			if (head->next) {
+				head->next->prev = element;
 			}
 
-			b->next = new Element(pair);
-			b->next->prev = b;
+			head->next = element;
+
+			return;
+		}
+
+		// a new bucket, which goes after the end of the closest one before it
+		Element *prev = nullptr;
+
+		for (int i = idx - 1; i >= 0; i--)
+		{
+			if (m_elements[i])
+			{
+				prev = m_elements[i];
+
+				while (Element *next = nextInBucket(prev, i)) {
+					prev = next;
+				}
+
+				break;
+			}
+		}
+
+		Element *next = nullptr;
+
+		if (prev)
+		{
+			next = prev->next;
 		}
 		else
 		{
-			m_elements[idx] = new Element(pair);
+			for (int i = idx + 1; i < m_capacity; i++)
+			{
+				if (m_elements[i])
+				{
+					next = m_elements[i];
+					break;
+				}
+			}
+		}
+
+		element->prev = prev;
+		element->next = next;
+
+		if (prev) {
+			prev->next = element;
 		}
+
+		if (next) {
+			next->prev = element;
+		}
+
+		m_elements[idx] = element;
 	}
 
-	template <typename TKey, typename TValue>
-	void HashMap<TKey, TValue>::erase(const TKey &key)
+	template <typename TKey, typename TValue, MemTag Tag>
+	typename HashMap<TKey, TValue, Tag>::Element *HashMap<TKey, TValue, Tag>::nextInBucket(const Element *element, int idx) const
 	{
-		Element *b = m_elements[indexOf(key)];
+		Element *next = element->next;
 
-		while (b)
+		if (next && indexOf(next->data.first) == idx) {
+			return next;
+		}
+
+		return nullptr;
+	}
+
+	template <typename TKey, typename TValue, MemTag Tag>
+	void HashMap<TKey, TValue, Tag>::erase(const TKey &key)
+	{
+		int idx = indexOf(key);
+
+		for (Element *b = m_elements[idx]; b; b = nextInBucket(b, idx))
 		{
 			if (b->data.first == key)
 			{
-				if (b == m_elements[indexOf(key)]) {
-					m_elements[indexOf(key)] = b->next;
+				if (b == m_elements[idx]) {
+					m_elements[idx] = nextInBucket(b, idx);
 				}
 
 				if (b->next) {
@@ -328,21 +396,17 @@ namespace llt
 					b->prev->next = b->next;
 				}
 
-				::operator delete(b, sizeof(Element));
+				freeElement(b);
 
 				m_elementCount--;
 
-				realignPtrs();
-
 				return;
 			}
-
-			b = b->next;
 		}
 	}
 
-	template <typename TKey, typename TValue>
-	void HashMap<TKey, TValue>::clear()
+	template <typename TKey, typename TValue, MemTag Tag>
+	void HashMap<TKey, TValue, Tag>::clear()
 	{
 		if (!m_elements)
 			return;
@@ -361,19 +425,19 @@ namespace llt
 		while (e)
 		{
 			Element *next = e->next;
-			delete e;
+			freeElement(e);
 			e = next;
 		}
 
-		delete[] m_elements;
+		mem::free(m_elements, sizeof(Element *) * m_capacity, Tag);
 		m_elements = nullptr;
 
 		m_capacity = 0;
 		m_elementCount = 0;
 	}
 
-	template <typename TKey, typename TValue>
-	void HashMap<TKey, TValue>::realloc()
+	template <typename TKey, typename TValue, MemTag Tag>
+	void HashMap<TKey, TValue, Tag>::realloc()
 	{
 		int oldCapacity = m_capacity;
 
@@ -386,8 +450,8 @@ namespace llt
 			m_capacity *= 2;
 		}
 
-		Element **newBuffer = new Element *[m_capacity];
-		mem::set(newBuffer, 0, sizeof(Element *) * m_capacity);
+		// has to be found with the old capacity, before the buckets are swapped out
+		Element *e = nullptr;
 
 		if (m_elements)
 		{
@@ -395,127 +459,75 @@ namespace llt
 			{
 				if (m_elements[i])
 				{
-					int idx = indexOf(m_elements[i]->data.first);
-					newBuffer[idx] = new Element(std::move(*m_elements[i]));
+					e = m_elements[i];
+					break;
 				}
 			}
 		}
 
-		delete[] m_elements;
+		Element **newBuffer = (Element **)mem::alloc(sizeof(Element *) * m_capacity, Tag);
+		mem::set(newBuffer, 0, sizeof(Element *) * m_capacity);
+
+		mem::free(m_elements, sizeof(Element *) * oldCapacity, Tag);
 		m_elements = newBuffer;
 
-		realignPtrs();
+		// the elements themselves stay where they are, they're only relinked into their new buckets
+		while (e)
+		{
+			Element *next = e->next;
+			linkElement(e);
+			e = next;
+		}
 	}
 
-	template <typename TKey, typename TValue>
-	void HashMap<TKey, TValue>::realignPtrs()
+	template <typename TKey, typename TValue, MemTag Tag>
+	template <typename ...Args>
+	typename HashMap<TKey, TValue, Tag>::Element *HashMap<TKey, TValue, Tag>::allocElement(Args &&...args)
 	{
-		Element *f = first();
-		Element *l = last();
-
-		if (f == nullptr && l == nullptr) {
-			return;
-		}
-
-		for (int i = 0; i < m_capacity; i++)
-		{
-			Element *bucket = m_elements[i];
-
-			// make sure we are on a valid bucket
-			if (!bucket) {
-				continue;
-			}
-
-			// do this only if we are not the last element to prevent an infinite loop when iterating
-			if (bucket != l)
-			{
-				// backwards pass
-				for (int j = 0; j < m_capacity - 1; j++)
-				{
-					int checkIdx = (i + j + 1) % m_capacity;
-
-					if (m_elements[checkIdx])
-					{
-						Element *lastElem = m_elements[i];
-
-						while (lastElem->next) {
-							for (int k = 0; k < m_capacity; k++) {
-								if (lastElem->next == m_elements[k]) {
-									goto nextAlignFound;
-								}
-							}
-							lastElem = lastElem->next;
-						}
-
-nextAlignFound:
-						lastElem->next = m_elements[checkIdx];
-						break;
-					}
-				}
-			}
+		return new (mem::alloc(sizeof(Element), Tag)) Element(std::forward<Args>(args)...);
+	}
 
-			// do this only if we are not the first element to prevent an infinite loop when iterating
-			if (bucket != f)
-			{
-				// forwards pass
-				for (int j = 0; j < m_capacity - 1; j++)
-				{
-					int check_idx = m_capacity - 1 - j + i;
-
-					if (check_idx < 0) {
-						check_idx += m_capacity;
-					} else if (check_idx >= m_capacity) {
-						check_idx -= m_capacity;
-					}
-
-					if (m_elements[check_idx])
-					{
-						bucket->prev = m_elements[check_idx];
-						break;
-					}
-				}
-			}
-		}
+	template <typename TKey, typename TValue, MemTag Tag>
+	void HashMap<TKey, TValue, Tag>::freeElement(Element *element)
+	{
+		element->~Element();
+		mem::free(element, sizeof(Element), Tag);
 	}
 
-	template <typename TKey, typename TValue>
-	TValue &HashMap<TKey, TValue>::get(const TKey &key)
+	template <typename TKey, typename TValue, MemTag Tag>
+	TValue &HashMap<TKey, TValue, Tag>::get(const TKey &key)
 	{
-		Element *b = m_elements[indexOf(key)];
+		int idx = indexOf(key);
 
-		while (b)
+		for (Element *b = m_elements[idx]; b; b = nextInBucket(b, idx))
 		{
 			if (b->data.first == key) {
 				return b->data.second;
 			}
-
-			b = b->next;
 		}
 
 		LLT_ERROR("Could not find bucket matching key.");
 		return m_elements[0]->data.second;
 	}
 
-	template <typename TKey, typename TValue>
-	const TValue &HashMap<TKey, TValue>::get(const TKey &key) const
+	template <typename TKey, typename TValue, MemTag Tag>
+	const TValue &HashMap<TKey, TValue, Tag>::get(const TKey &key) const
 	{
-		Element *b = m_elements[indexOf(key)];
+		int idx = indexOf(key);
 
-		while (b)
+		for (Element *b = m_elements[idx]; b; b = nextInBucket(b, idx))
 		{
 			if (b->data.first == key) {
 				return b->data.second;
 			}
-
-			b = b->next;
 		}
 
 		LLT_ERROR("Could not find element matching key.");
 		return m_elements[0]->data.second;
 	}
 
-	template <typename TKey, typename TValue>
-	TValue &HashMap<TKey, TValue>::getOrDefault(const TKey &key, TValue &fallback)
+	template <typename TKey, typename TValue, MemTag Tag>
+	TValue &HashMap<TKey, TValue, Tag>::getOrDefault(const TKey &key, TValue &fallback)
 	{
 		if (contains(key))
 			return get(key);
@@ -523,8 +535,8 @@ nextAlignFound:
 		return fallback;
 	}
 
-	template <typename TKey, typename TValue>
-	const TValue &HashMap<TKey, TValue>::getOrDefault(const TKey &key, const TValue &fallback) const
+	template <typename TKey, typename TValue, MemTag Tag>
+	const TValue &HashMap<TKey, TValue, Tag>::getOrDefault(const TKey &key, const TValue &fallback) const
 	{
 		if (contains(key))
 			return get(key);
@@ -532,55 +544,47 @@ nextAlignFound:
 		return fallback;
 	}
 
-	template <typename TKey, typename TValue>
-	bool HashMap<TKey, TValue>::contains(const TKey &key) const
+	template <typename TKey, typename TValue, MemTag Tag>
+	bool HashMap<TKey, TValue, Tag>::contains(const TKey &key) const
 	{
-		Element *b = m_elements[indexOf(key)];
+		int idx = indexOf(key);
 
-		while (b)
+		for (Element *b = m_elements[idx]; b; b = nextInBucket(b, idx))
 		{
 			if (b->data.first == key) {
 				return true;
 			}
-
-			b = b->next;
 		}
 
 		return false;
 	}
 
-	template <typename TKey, typename TValue>
-	int HashMap<TKey, TValue>::getElementCount() const
+	template <typename TKey, typename TValue, MemTag Tag>
+	int HashMap<TKey, TValue, Tag>::getElementCount() const
 	{
 		return m_elementCount;
 	}
 
-	template <typename TKey, typename TValue>
-	int HashMap<TKey, TValue>::getCapacity() const
+	template <typename TKey, typename TValue, MemTag Tag>
+	int HashMap<TKey, TValue, Tag>::getCapacity() const
 	{
 		return m_capacity;
 	}
 
-	template <typename TKey, typename TValue>
-	bool HashMap<TKey, TValue>::isEmpty() const
+	template <typename TKey, typename TValue, MemTag Tag>
+	bool HashMap<TKey, TValue, Tag>::isEmpty() const
 	{
-		for (int i = 0; i < m_capacity; i++) {
-			if (m_elements[i]) {
-				return false;
-			}
-		}
-
-		return true;
+		return m_elementCount == 0;
 	}
 
-	template <typename TKey, typename TValue>
-	int HashMap<TKey, TValue>::indexOf(const TKey &key) const
+	template <typename TKey, typename TValue, MemTag Tag>
+	int HashMap<TKey, TValue, Tag>::indexOf(const TKey &key) const
 	{
 		return hash::calc(&key) % m_capacity;
 	}
 
-	template <typename TKey, typename TValue>
-	typename HashMap<TKey, TValue>::Element *HashMap<TKey, TValue>::first()
+	template <typename TKey, typename TValue, MemTag Tag>
+	typename HashMap<TKey, TValue, Tag>::Element *HashMap<TKey, TValue, Tag>::first()
 	{
 		for (int i = 0; i < m_capacity; i++) {
 			if (m_elements[i]) {
@@ -591,8 +595,8 @@ nextAlignFound:
 		return nullptr;
 	}
 
-	template <typename TKey, typename TValue>
-	const typename HashMap<TKey, TValue>::Element *HashMap<TKey, TValue>::first() const
+	template <typename TKey, typename TValue, MemTag Tag>
+	const typename HashMap<TKey, TValue, Tag>::Element *HashMap<TKey, TValue, Tag>::first() const
 	{
 		for (int i = 0; i < m_capacity; i++) {
 			if (m_elements[i]) {
@@ -603,74 +607,90 @@ nextAlignFound:
 		return nullptr;
 	}
 
-	template <typename TKey, typename TValue>
-	typename HashMap<TKey, TValue>::Element *HashMap<TKey, TValue>::last()
+	template <typename TKey, typename TValue, MemTag Tag>
+	typename HashMap<TKey, TValue, Tag>::Element *HashMap<TKey, TValue, Tag>::last()
 	{
-		for (int i = m_capacity - 1; i >= 0; i--) {
-			if (m_elements[i]) {
-				return m_elements[i];
+		for (int i = m_capacity - 1; i >= 0; i--)
+		{
+			if (m_elements[i])
+			{
+				Element *e = m_elements[i];
+
+				while (e->next) {
+					e = e->next;
+				}
+
+				return e;
 			}
 		}
 
 		return nullptr;
 	}
 
-	template <typename TKey, typename TValue>
-	const typename HashMap<TKey, TValue>::Element *HashMap<TKey, TValue>::last() const
+	template <typename TKey, typename TValue, MemTag Tag>
+	const typename HashMap<TKey, TValue, Tag>::Element *HashMap<TKey, TValue, Tag>::last() const
 	{
-		for (int i = m_capacity; i >= 0; i--) {
-			if (m_elements[i]) {
-				return m_elements[i];
+		for (int i = m_capacity - 1; i >= 0; i--)
+		{
+			if (m_elements[i])
+			{
+				const Element *e = m_elements[i];
+
+				while (e->next) {
+					e = e->next;
+				}
+
+				return e;
 			}
 		}
 
 		return nullptr;
 	}
 
-	template <typename TKey, typename TValue>
-	typename HashMap<TKey, TValue>::Iterator HashMap<TKey, TValue>::begin()
+	template <typename TKey, typename TValue, MemTag Tag>
+	typename HashMap<TKey, TValue, Tag>::Iterator HashMap<TKey, TValue, Tag>::begin()
 	{
 		return Iterator(first());
 	}
 
-	template <typename TKey, typename TValue>
-	typename HashMap<TKey, TValue>::ConstIterator HashMap<TKey, TValue>::begin() const
+	template <typename TKey, typename TValue, MemTag Tag>
+	typename HashMap<TKey, TValue, Tag>::ConstIterator HashMap<TKey, TValue, Tag>::begin() const
 	{
 		return ConstIterator(first());
 	}
 
-	template <typename TKey, typename TValue>
-	typename HashMap<TKey, TValue>::ConstIterator HashMap<TKey, TValue>::cbegin() const
+	template <typename TKey, typename TValue, MemTag Tag>
+	typename HashMap<TKey, TValue, Tag>::ConstIterator HashMap<TKey, TValue, Tag>::cbegin() const
 	{
 		return ConstIterator(first());
 	}
 
-	template <typename TKey, typename TValue>
-	typename HashMap<TKey, TValue>::Iterator HashMap<TKey, TValue>::end()
+	template <typename TKey, typename TValue, MemTag Tag>
+	typename HashMap<TKey, TValue, Tag>::Iterator HashMap<TKey, TValue, Tag>::end()
 	{
 		return Iterator(nullptr);
 	}
 
-	template <typename TKey, typename TValue>
-	typename HashMap<TKey, TValue>::ConstIterator HashMap<TKey, TValue>::end() const
+	template <typename TKey, typename TValue, MemTag Tag>
+	typename HashMap<TKey, TValue, Tag>::ConstIterator HashMap<TKey, TValue, Tag>::end() const
 	{
 		return ConstIterator(nullptr);
 	}
 
-	template <typename TKey, typename TValue>
-	typename HashMap<TKey, TValue>::ConstIterator HashMap<TKey, TValue>::cend() const
+	template <typename TKey, typename TValue, MemTag Tag>
+	typename HashMap<TKey, TValue, Tag>::ConstIterator HashMap<TKey, TValue, Tag>::cend() const
 	{
 		return ConstIterator(nullptr);
 	}
 
-	template <typename TKey, typename TValue>
-	TValue &HashMap<TKey, TValue>::operator [] (const TKey &idx)
+	template <typename TKey, typename TValue, MemTag Tag>
+	TValue &HashMap<TKey, TValue, Tag>::operator [] (const TKey &idx)
 	{
 		return get(idx);
 	}
 
-	template <typename TKey, typename TValue>
-	const TValue &HashMap<TKey, TValue>::operator [] (const TKey &idx) const
+	template <typename TKey, typename TValue, MemTag Tag>
+	const TValue &HashMap<TKey, TValue, Tag>::operator [] (const TKey &idx) const
 	{
 		return get(idx);
 	}
@@ -2,75 +2,86 @@
 #define LINKED_LIST_H_
 
 #include <new>
+#include <utility>
 
-#include "common.h"
+#include "core/common.h"
 
-namespace rvn
+namespace llt
 {
 	/**
 	 * List in which each "link" points to the next and previous link.
+	 * The ends are joined up through a sentinel that lives in the list itself, so end() is always valid
+	 * and inserting or erasing never has to check for the first or last link.
 	 */
-	template <typename T>
+	template <typename T, MemTag Tag = MEM_TAG_CONTAINERS>
 	class LinkedList
 	{
-		struct Link
+		struct Node
+		{
+			Node *next;
+			Node *prev;
+		};
+
+		struct Link : Node
 		{
-			Link *next;
-			Link *prev;
 			T data;
 		};
 
 	public:
 		struct Iterator
 		{
-			friend class LinkedList<T>;
+			friend class LinkedList<T, Tag>;
 		public:
 			Iterator() : m_ptr(nullptr) { }
-			Iterator(Link *ptr) : m_ptr(ptr) { }
+			Iterator(Node *ptr) : m_ptr(ptr) { }
 			~Iterator() = default;
-			T &operator * () const { return m_ptr->data; }
-			T *operator -> () const { return &m_ptr->data; }
-			Iterator operator + (int n) { for (int i = 0; i < n - 1; i++) { m_ptr = m_ptr->next; } return Iterator(m_ptr); }
-			Iterator operator - (int n) { for (int i = 0; i < n - 0; i++) { m_ptr = m_ptr->prev; } return Iterator(m_ptr); }
+			T &operator * () const { return ((Link *)m_ptr)->data; }
+			T *operator -> () const { return &((Link *)m_ptr)->data; }
+			Iterator operator + (int n) { Node *p = m_ptr; for (int i = 0; i < n; i++) { p = p->next; } return Iterator(p); }
+			Iterator operator - (int n) { Node *p = m_ptr; for (int i = 0; i < n; i++) { p = p->prev; } return Iterator(p); }
 			Iterator &operator ++ () { m_ptr = m_ptr->next; return *this; }
 			Iterator &operator -- () { m_ptr = m_ptr->prev; return *this; }
-			const Iterator operator ++ (int) { m_ptr = m_ptr->next; return *this; }
-			const Iterator operator -- (int) { m_ptr = m_ptr->prev; return *this; }
+			Iterator operator ++ (int) { Iterator t = *this; m_ptr = m_ptr->next; return t; }
+			Iterator operator -- (int) { Iterator t = *this; m_ptr = m_ptr->prev; return t; }
 			bool operator == (const Iterator &other) const { return this->m_ptr == other.m_ptr; }
 			bool operator != (const Iterator &other) const { return this->m_ptr != other.m_ptr; }
 		private:
-			Link *m_ptr;
+			Node *m_ptr;
 		};
 
 		struct ConstIterator
 		{
-			friend class LinkedList<T>;
+			friend class LinkedList<T, Tag>;
 		public:
 			ConstIterator() : m_ptr(nullptr) { }
-			ConstIterator(Link *ptr) : m_ptr(ptr) { }
+			ConstIterator(const Node *ptr) : m_ptr(ptr) { }
 			~ConstIterator() = default;
-			T &operator * () const { return m_ptr->data; }
-			T *operator -> () const { return &m_ptr->data; }
-			ConstIterator operator + (int n) { for (int i = 0; i < n - 1; i++) { m_ptr = m_ptr->next; } return ConstIterator(m_ptr); }
-			ConstIterator operator - (int n) { for (int i = 0; i < n - 0; i++) { m_ptr = m_ptr->prev; } return ConstIterator(m_ptr); }
+			const T &operator * () const { return ((const Link *)m_ptr)->data; }
+			const T *operator -> () const { return &((const Link *)m_ptr)->data; }
+			ConstIterator operator + (int n) { const Node *p = m_ptr; for (int i = 0; i < n; i++) { p = p->next; } return ConstIterator(p); }
+			ConstIterator operator - (int n) { const Node *p = m_ptr; for (int i = 0; i < n; i++) { p = p->prev; } return ConstIterator(p); }
 			ConstIterator &operator ++ () { m_ptr = m_ptr->next; return *this; }
 			ConstIterator &operator -- () { m_ptr = m_ptr->prev; return *this; }
-			const ConstIterator operator ++ (int) { m_ptr = m_ptr->next; return *this; }
-			const ConstIterator operator -- (int) { m_ptr = m_ptr->prev; return *this; }
+			ConstIterator operator ++ (int) { ConstIterator t = *this; m_ptr = m_ptr->next; return t; }
+			ConstIterator operator -- (int) { ConstIterator t = *this; m_ptr = m_ptr->prev; return t; }
 			bool operator == (const ConstIterator &other) const { return this->m_ptr == other.m_ptr; }
 			bool operator != (const ConstIterator &other) const { return this->m_ptr != other.m_ptr; }
 		private:
-			Link *m_ptr;
+			const Node *m_ptr;
 		};
 
 		LinkedList();
 		~LinkedList();
 
+		// links point back at the sentinel, so the list can't be copied or moved by value
+		LinkedList(const LinkedList &other) = delete;
+		LinkedList &operator = (const LinkedList &other) = delete;
+
 		/*
 		 * Remove items from the list.
 		 */
 		void clear();
-		void erase(const Iterator &it);
+		Iterator erase(const Iterator &it);
 		void remove(const T &item);
 
 		/*
@@ -84,12 +95,12 @@ namespace rvn
 		bool empty() const;
 
 		/*
-		 * Add a new item at a point.
+		 * Add a new item in front of a point.
 		 */
 		Iterator insert(const T &item, const Iterator &it);
 
 		template <typename ...Args>
-		Iterator emplace(Args &&...args, const Iterator &it);
+		Iterator emplace(const Iterator &it, Args &&...args);
 
 		template <typename ...Args>
 		Iterator emplaceFront(Args &&...args);
@@ -117,229 +128,217 @@ namespace rvn
 		ConstIterator cend() const;
 
 	private:
-		Link *m_root;
+		Iterator link(Link *l, const Iterator &it);
+
+		Node m_root;
 		uint64_t m_size;
 	};
 
-	template <typename T>
-	LinkedList<T>::LinkedList()
-		: m_root(nullptr)
+	template <typename T, MemTag Tag>
+	LinkedList<T, Tag>::LinkedList()
+		: m_root()
 		, m_size(0)
 	{
-		m_root = new Link();
-		m_root->next = m_root;
-		m_root->prev = m_root;
+		m_root.next = &m_root;
+		m_root.prev = &m_root;
 	}
 
-	template <typename T>
-	LinkedList<T>::~LinkedList()
+	template <typename T, MemTag Tag>
+	LinkedList<T, Tag>::~LinkedList()
 	{
 		clear();
 	}
 
-	template <typename T>
-	void LinkedList<T>::clear()
+	template <typename T, MemTag Tag>
+	void LinkedList<T, Tag>::clear()
 	{
-		Link *curr = m_root;
+		Node *curr = m_root.next;
 
-		for (int i = 0; i < m_size; i++)
+		while (curr != &m_root)
 		{
-			Link *next = curr->next;
-			delete curr;
+			Node *next = curr->next;
+
+			((Link *)curr)->~Link();
+			mem::free(curr, sizeof(Link), Tag);
+
 			curr = next;
 		}
 
 		m_size = 0;
-		m_root = new Link();
-		m_root->next = m_root;
-		m_root->prev = m_root;
+		m_root.next = &m_root;
+		m_root.prev = &m_root;
 	}
 
-	template <typename T>
-	void LinkedList<T>::erase(const Iterator &it)
+	template <typename T, MemTag Tag>
+	typename LinkedList<T, Tag>::Iterator LinkedList<T, Tag>::erase(const Iterator &it)
 	{
-		it.m_ptr->prev->next = it.m_ptr->next;
-		it.m_ptr->next->prev = it.m_ptr->prev;
-		delete it.m_ptr;
+		Node *node = it.m_ptr;
+		Node *next = node->next;
+
+		node->prev->next = node->next;
+		node->next->prev = node->prev;
+
+		((Link *)node)->~Link();
+		mem::free(node, sizeof(Link), Tag);
+
 		m_size--;
+
+		return Iterator(next);
 	}
 
-	template<class T>
-	void LinkedList<T>::remove(const T &item)
+	template <typename T, MemTag Tag>
+	void LinkedList<T, Tag>::remove(const T &item)
 	{
 		Iterator curr = begin();
-		Iterator last = end();
-		Iterator next = curr;
 
-		while (curr != last)
+		while (curr != end())
 		{
-			next++;
-
 			if (*curr == item) {
-				erase(curr);
+				curr = erase(curr);
+			} else {
+				curr++;
 			}
-
-			curr = next;
 		}
 	}
 
-	template <typename T>
-	LinkedList<T>::Iterator LinkedList<T>::insert(const T &item, const Iterator &it)
+	template <typename T, MemTag Tag>
+	typename LinkedList<T, Tag>::Iterator LinkedList<T, Tag>::link(Link *l, const Iterator &it)
 	{
-		Link *l = new Link();
-
-		l->data = item;
-
 		l->next = it.m_ptr;
 		l->prev = it.m_ptr->prev;
 
 		l->prev->next = l;
 		l->next->prev = l;
 
-		it.m_ptr->prev = l;
-
 		m_size++;
 
 		return Iterator(l);
 	}
 
-	template <typename T>
-	template <typename ...Args>
-	LinkedList<T>::Iterator LinkedList<T>::emplace(Args &&...args, const Iterator &it)
+	template <typename T, MemTag Tag>
+	typename LinkedList<T, Tag>::Iterator LinkedList<T, Tag>::insert(const T &item, const Iterator &it)
 	{
-		Link *l = new Link();
+		return emplace(it, item);
+	}
 
+	template <typename T, MemTag Tag>
+	template <typename ...Args>
+	typename LinkedList<T, Tag>::Iterator LinkedList<T, Tag>::emplace(const Iterator &it, Args &&...args)
+	{
+		Link *l = (Link *)mem::alloc(sizeof(Link), Tag);
 		new (&l->data) T(std::forward<Args>(args)...);
 
-		l->next = it.m_ptr;
-		l->prev = it.m_ptr->prev;
-
-		l->prev->next = l;
-		l->next->prev = l;
-
-		it.m_ptr->prev = l;
-
-		m_size++;
-
-		return Iterator(l);
+		return link(l, it);
 	}
 
-	template <typename T>
+	template <typename T, MemTag Tag>
 	template <typename ...Args>
-	LinkedList<T>::Iterator LinkedList<T>::emplaceFront(Args &&...args)
+	typename LinkedList<T, Tag>::Iterator LinkedList<T, Tag>::emplaceFront(Args &&...args)
 	{
-		return emplace(std::forward<Args>(args)..., begin());
+		return emplace(begin(), std::forward<Args>(args)...);
 	}
 
-	template <typename T>
+	template <typename T, MemTag Tag>
 	template <typename ...Args>
-	LinkedList<T>::Iterator LinkedList<T>::emplaceBack(Args &&...args)
+	typename LinkedList<T, Tag>::Iterator LinkedList<T, Tag>::emplaceBack(Args &&...args)
 	{
-		return emplace(std::forward<Args>(args)..., end());
+		return emplace(end(), std::forward<Args>(args)...);
 	}
 
-	template <typename T>
-	LinkedList<T>::Iterator LinkedList<T>::pushFront(const T &item)
+	template <typename T, MemTag Tag>
+	typename LinkedList<T, Tag>::Iterator LinkedList<T, Tag>::pushFront(const T &item)
 	{
 		return insert(item, begin());
 	}
 
-	template <typename T>
-	LinkedList<T>::Iterator LinkedList<T>::pushBack(const T &item)
+	template <typename T, MemTag Tag>
+	typename LinkedList<T, Tag>::Iterator LinkedList<T, Tag>::pushBack(const T &item)
 	{
 		return insert(item, end());
 	}
 
-	template <typename T>
-	void LinkedList<T>::popFront()
+	template <typename T, MemTag Tag>
+	void LinkedList<T, Tag>::popFront()
 	{
-		Link *l = m_root->next;
-		m_root->next = m_root->next->next;
-		m_root->next->prev = m_root;
-		delete l;
-		m_size--;
+		erase(begin());
 	}
 
-	template <typename T>
-	void LinkedList<T>::popBack()
+	template <typename T, MemTag Tag>
+	void LinkedList<T, Tag>::popBack()
 	{
-		Link *l = m_root;
-		m_root = m_root->prev;
-		m_root->next = l->next;
-		delete l;
-		m_size--;
+		erase(Iterator(m_root.prev));
 	}
 
-	template <typename T>
-	uint64_t LinkedList<T>::size() const
+	template <typename T, MemTag Tag>
+	uint64_t LinkedList<T, Tag>::size() const
 	{
 		return m_size;
 	}
 
-	template <typename T>
-	bool LinkedList<T>::empty() const
+	template <typename T, MemTag Tag>
+	bool LinkedList<T, Tag>::empty() const
 	{
 		return m_size == 0;
 	}
 
-	template <typename T>
-	T &LinkedList<T>::front()
+	template <typename T, MemTag Tag>
+	T &LinkedList<T, Tag>::front()
 	{
-		return m_root->next->data;
+		return ((Link *)m_root.next)->data;
 	}
 
-	template <typename T>
-	const T &LinkedList<T>::front() const
+	template <typename T, MemTag Tag>
+	const T &LinkedList<T, Tag>::front() const
 	{
-		return m_root->next->data;
+		return ((const Link *)m_root.next)->data;
 	}
 
-	template <typename T>
-	T &LinkedList<T>::back()
+	template <typename T, MemTag Tag>
+	T &LinkedList<T, Tag>::back()
 	{
-		return m_root->data;
+		return ((Link *)m_root.prev)->data;
 	}
 
-	template <typename T>
-	const T &LinkedList<T>::back() const
+	template <typename T, MemTag Tag>
+	const T &LinkedList<T, Tag>::back() const
 	{
-		return m_root->data;
+		return ((const Link *)m_root.prev)->data;
 	}
 
-	template <typename T>
-	typename LinkedList<T>::Iterator LinkedList<T>::begin()
+	template <typename T, MemTag Tag>
+	typename LinkedList<T, Tag>::Iterator LinkedList<T, Tag>::begin()
 	{
-		return Iterator(m_root->next);
+		return Iterator(m_root.next);
 	}
 
-	template <typename T>
-	typename LinkedList<T>::ConstIterator LinkedList<T>::begin() const
+	template <typename T, MemTag Tag>
+	typename LinkedList<T, Tag>::ConstIterator LinkedList<T, Tag>::begin() const
 	{
-		return ConstIterator(m_root->next);
+		return ConstIterator(m_root.next);
 	}
 
-	template <typename T>
-	typename LinkedList<T>::Iterator LinkedList<T>::end()
+	template <typename T, MemTag Tag>
+	typename LinkedList<T, Tag>::Iterator LinkedList<T, Tag>::end()
 	{
-		return Iterator(m_root);
+		return Iterator(&m_root);
 	}
 
-	template <typename T>
-	typename LinkedList<T>::ConstIterator LinkedList<T>::end() const
+	template <typename T, MemTag Tag>
+	typename LinkedList<T, Tag>::ConstIterator LinkedList<T, Tag>::end() const
 	{
-		return Iterator(m_root);
+		return ConstIterator(&m_root);
 	}
 
-	template <typename T>
-	typename LinkedList<T>::ConstIterator LinkedList<T>::cbegin() const
+	template <typename T, MemTag Tag>
+	typename LinkedList<T, Tag>::ConstIterator LinkedList<T, Tag>::cbegin() const
 	{
-		return ConstIterator(m_root->next);
+		return ConstIterator(m_root.next);
 	}
 
-	template <typename T>
-	typename LinkedList<T>::ConstIterator LinkedList<T>::cend() const
+	template <typename T, MemTag Tag>
+	typename LinkedList<T, Tag>::ConstIterator LinkedList<T, Tag>::cend() const
 	{
-		return Iterator(m_root);
+		return ConstIterator(&m_root);
 	}
 }
 
@@ -208,7 +208,7 @@ namespace llt
 	Str<Size>::Str()
 		: m_length(0)
 	{
-		m_buf = new char[Size];
+		m_buf = (char *)mem::alloc(Size, MEM_TAG_STRINGS);
 		mem::set(m_buf, 0, Size);
 	}
 
@@ -218,7 +218,7 @@ namespace llt
 	{
 		LLT_ASSERT(m_length < (Size - 1), "Length must not exceed maximum size."); // -1 for '\0'
 
-		m_buf = new char[Size];
+		m_buf = (char *)mem::alloc(Size, MEM_TAG_STRINGS);
 		cstr::copy(m_buf, str, m_length);
 		m_buf[m_length] = '\0';
 	}
@@ -228,7 +228,7 @@ namespace llt
 	{
 		LLT_ASSERT(other.m_length < (Size - 1), "Length must not exceed maximum size.");
 
-		m_buf = new char[Size];
+		m_buf = (char *)mem::alloc(Size, MEM_TAG_STRINGS);
 
 		m_length = other.m_length;
 		cstr::copy(m_buf, other.m_buf, other.m_length);
@@ -241,8 +241,6 @@ namespace llt
 	{
 		LLT_ASSERT(other.m_length < (Size - 1), "Length must not exceed maximum size.");
 
-		m_buf = new char[Size];
-
 		m_length = std::move(other.m_length);
 		m_buf = std::move(other.m_buf);
 
@@ -256,7 +254,7 @@ namespace llt
 		LLT_ASSERT(other.m_length < (Size - 1), "Length must not exceed maximum size.");
 
 		if (!m_buf) {
-			m_buf = new char[Size];
+			m_buf = (char *)mem::alloc(Size, MEM_TAG_STRINGS);
 		}
 
 		if (m_length > other.m_length) {
@@ -275,8 +273,11 @@ namespace llt
 	{
 		LLT_ASSERT(other.m_length < (Size - 1), "Length must not exceed maximum size");
 
-		if (!m_buf)
-			m_buf = new char[Size];
+		if (this == &other) {
+			return *this;
+		}
+
+		mem::free(m_buf, Size, MEM_TAG_STRINGS);
 
 		m_length = std::move(other.m_length);
 		m_buf = std::move(other.m_buf);
@@ -291,7 +292,10 @@ namespace llt
 	Str<Size>::~Str()
 	{
 		m_length = 0;
-		delete[] m_buf;
+		mem::free(m_buf, Size, MEM_TAG_STRINGS);
+
+		// anything that assigns to a destroyed string frees null instead of this buffer again
+		m_buf = nullptr;
 	}
 
 	template <uint64_t Size>
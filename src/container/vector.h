@@ -12,9 +12,9 @@
 namespace llt
 {
 	/**
-	 * Dynamically sized array.
+	 * Dynamically sized array, its buffer counted under Tag.
 	 */
-	template <typename T>
+	template <typename T, MemTag Tag = MEM_TAG_CONTAINERS>
 	class Vector
 	{
     public:
@@ -203,16 +203,16 @@ namespace llt
         uint64_t m_capacity;
 	};
 
-    template <typename T>
-    Vector<T>::Vector()
+    template <typename T, MemTag Tag>
+    Vector<T, Tag>::Vector()
 		: m_buf(nullptr)
         , m_size(0)
         , m_capacity(0)
     {
     }
     
-    template <typename T>
-    Vector<T>::Vector(std::initializer_list<T> data)
+    template <typename T, MemTag Tag>
+    Vector<T, Tag>::Vector(std::initializer_list<T> data)
         : Vector()
     {
         allocate(data.size());
@@ -223,32 +223,32 @@ namespace llt
         }
     }
 
-    template <typename T>
-    Vector<T>::Vector(uint64_t initialCapacity)
+    template <typename T, MemTag Tag>
+    Vector<T, Tag>::Vector(uint64_t initialCapacity)
         : Vector()
     {
         allocate(initialCapacity);
         m_size = initialCapacity;
 
-        for (uint64_t i = 0; i < m_capacity; i++) {
+        for (uint64_t i = 0; i < m_size; i++) {
             new (m_buf + i) T();
         }
     }
 
-    template <typename T>
-    Vector<T>::Vector(uint64_t initialCapacity, const T &initialElement)
+    template <typename T, MemTag Tag>
+    Vector<T, Tag>::Vector(uint64_t initialCapacity, const T &initialElement)
         : Vector()
     {
         allocate(initialCapacity);
         m_size = initialCapacity;
 
-        for (uint64_t i = 0; i < m_capacity; i++) {
+        for (uint64_t i = 0; i < m_size; i++) {
             new (m_buf + i) T(initialElement);
         }
     }
 
-	template <typename T>
-	Vector<T>::Vector(T *buf, uint64_t length)
+	template <typename T, MemTag Tag>
+	Vector<T, Tag>::Vector(T *buf, uint64_t length)
 		: Vector()
 	{
 		allocate(length);
@@ -259,8 +259,8 @@ namespace llt
         }
 	}
 
-	template <typename T>
-	Vector<T>::Vector(const Iterator &begin, const Iterator &end)
+	template <typename T, MemTag Tag>
+	Vector<T, Tag>::Vector(const Iterator &begin, const Iterator &end)
 		: Vector()
 	{
 		allocate(end.m_ptr - begin.m_ptr);
@@ -271,8 +271,8 @@ namespace llt
         }
 	}
 
-    template <typename T>
-    Vector<T>::Vector(const Vector &other)
+    template <typename T, MemTag Tag>
+    Vector<T, Tag>::Vector(const Vector &other)
         : Vector()
     {
         if (other.m_capacity <= 0) {
@@ -288,8 +288,8 @@ namespace llt
 		}
     }
 
-    template <typename T>
-    Vector<T>::Vector(Vector &&other) noexcept
+    template <typename T, MemTag Tag>
+    Vector<T, Tag>::Vector(Vector &&other) noexcept
 		: Vector()
     {
         this->m_capacity = std::move(other.m_capacity);
@@ -301,8 +301,8 @@ namespace llt
         other.m_buf = nullptr;
     }
     
-    template <typename T>
-    Vector<T> &Vector<T>::operator = (const Vector &other)
+    template <typename T, MemTag Tag>
+    Vector<T, Tag> &Vector<T, Tag>::operator = (const Vector &other)
     {
 		allocate(other.m_capacity);
 		clear();
@@ -316,13 +316,13 @@ namespace llt
         return *this;
     }
     
-    template <typename T>
-    Vector<T> &Vector<T>::operator = (Vector &&other) noexcept
+    template <typename T, MemTag Tag>
+    Vector<T, Tag> &Vector<T, Tag>::operator = (Vector &&other) noexcept
     {
 		clear();
 
 		if (m_buf) {
-			::operator delete (m_buf, sizeof(T) * m_capacity);
+			mem::free(m_buf, sizeof(T) * m_capacity, Tag);
 		}
 
 		this->m_capacity = std::move(other.m_capacity);
@@ -336,13 +336,13 @@ namespace llt
         return *this;
     }
 
-    template <typename T>
-    Vector<T>::~Vector()
+    template <typename T, MemTag Tag>
+    Vector<T, Tag>::~Vector()
     {
         clear();
 
 		if (m_buf) {
-			::operator delete (m_buf, sizeof(T) * m_capacity);
+			mem::free(m_buf, sizeof(T) * m_capacity, Tag);
 		}
 
         m_buf = nullptr;
@@ -350,19 +350,22 @@ namespace llt
         m_size = 0;
     }
 
-    template <typename T>
-    void Vector<T>::clear()
+    template <typename T, MemTag Tag>
+    void Vector<T, Tag>::clear()
     {
         for (int i = 0; i < m_size; i++) {
             m_buf[i].~T();
 		}
 
-		mem::set(m_buf, 0, m_size * sizeof(T));
+		if (m_buf) {
+			mem::set(m_buf, 0, m_size * sizeof(T));
+		}
+
         m_size = 0;
     }
 
-    template <typename T>
-    void Vector<T>::allocate(uint64_t capacity)
+    template <typename T, MemTag Tag>
+    void Vector<T, Tag>::allocate(uint64_t capacity)
     {
 		// check if we even need to allocate more
         if (capacity <= m_capacity) {
@@ -379,17 +382,18 @@ namespace llt
 		}
 
 		// allocate a new command buffer
-		T *newBuffer = (T*)::operator new (sizeof(T) * newCapacity);
+		T *newBuffer = (T*)mem::alloc(sizeof(T) * newCapacity, Tag);
 		mem::set(newBuffer, 0, sizeof(T) * newCapacity);
 
 		// move all of our elements into the new buffer
 		for (int i = 0; i < m_size; i++) {
 			new (newBuffer + i) T(std::move(m_buf[i]));
+			m_buf[i].~T();
 		}
 
 		// destroy our old buffer
 		if (m_buf) {
-			::operator delete (m_buf, sizeof(T) * m_capacity);
+			mem::free(m_buf, sizeof(T) * m_capacity, Tag);
 		}
 
 		// update our old buffer and capacity to new buffer and capacity
@@ -397,8 +401,8 @@ namespace llt
 		m_capacity = newCapacity;
     }
 
-    template <typename T>
-    void Vector<T>::resize(uint64_t newSize)
+    template <typename T, MemTag Tag>
+    void Vector<T, Tag>::resize(uint64_t newSize)
     {
         if (newSize < m_size) {
             erase(newSize, m_size - newSize);
@@ -409,8 +413,8 @@ namespace llt
 		m_size = newSize;
     }
 
-    template <typename T>
-    void Vector<T>::expand(uint64_t amount)
+    template <typename T, MemTag Tag>
+    void Vector<T, Tag>::expand(uint64_t amount)
     {
         LLT_ASSERT(amount > 0, "Expand amount must be higher than 0");
 
@@ -421,52 +425,41 @@ namespace llt
         }
     }
 
-    template <typename T>
-    void Vector<T>::fill(byte value)
+    template <typename T, MemTag Tag>
+    void Vector<T, Tag>::fill(byte value)
     {
         mem::set(m_buf, value, sizeof(T) * m_capacity);
     }
 
-	template <typename T>
-	void Vector<T>::erase(uint64_t index, uint64_t amount)
+	template <typename T, MemTag Tag>
+	void Vector<T, Tag>::erase(uint64_t index, uint64_t amount)
 	{
 		if (amount <= 0) {
 			return;
 		}
 
-		for (uint64_t i = 0; i < amount; i++) {
-			m_buf[i + index].~T();
-		}
-
-		// shuffle all of our elements back
-		for (uint64_t i = 0; i < m_size - amount; i++) {
-			m_buf[i + index] = std::move(m_buf[i + index + amount]);
+		// shuffle all of our elements back, over the ones being erased while they're still alive,
+		// so the move assignment always has a valid element to release
+		for (uint64_t i = index; i < m_size - amount; i++) {
+			m_buf[i] = std::move(m_buf[i + amount]);
         }
 
+		// whatever's left at the end has been moved from, or was erased with nothing after it
+		for (uint64_t i = m_size - amount; i < m_size; i++) {
+			m_buf[i].~T();
+		}
+
 		m_size -= amount;
 	}
 
-	template <typename T>
-	void Vector<T>::erase(Iterator it, uint64_t amount)
+	template <typename T, MemTag Tag>
+	void Vector<T, Tag>::erase(Iterator it, uint64_t amount)
 	{
-		if (amount <= 0) {
-			return;
-		}
-
-		// shuffle all of our elements back
-		for (int i = 0; i < m_size - amount; i++) {
-			*(it.m_ptr + i) = std::move(*(it.m_ptr + i + amount));
-        }
-
-		for (int i = m_size - amount; i < m_size; i++) {
-			it->~T();
-        }
-
-		m_size -= amount;
+		erase(&(*it) - m_buf, amount);
 	}
 
-	template <typename T>
-	typename Vector<T>::Iterator Vector<T>::find(const T &item)
+	template <typename T, MemTag Tag>
+	typename Vector<T, Tag>::Iterator Vector<T, Tag>::find(const T &item)
 	{
 		// linear search
 		for (uint64_t i = 0; i < m_size; i++) {
@@ -478,44 +471,48 @@ namespace llt
 		return end();
 	}
 
-	template <typename T>
-	Vector<T>::Iterator Vector<T>::insert(int index, const T &item)
+	template <typename T, MemTag Tag>
+	Vector<T, Tag>::Iterator Vector<T, Tag>::insert(int index, const T &item)
 	{
-		resize(m_size + 1);
+		// the new slot is constructed in place, resizing would default-construct one first just to overwrite it
+		allocate(m_size + 1);
 		mem::move(m_buf + index + 1, m_buf + index, sizeof(T) * (m_size - index));
 		new (m_buf + index) T(std::move(item));
+		m_size++;
 		return Iterator(m_buf + index);
 	}
 
-    template <typename T>
-	Vector<T>::Iterator Vector<T>::pushFront(const T &item)
+    template <typename T, MemTag Tag>
+	Vector<T, Tag>::Iterator Vector<T, Tag>::pushFront(const T &item)
     {
-        resize(m_size + 1);
+        allocate(m_size + 1);
         mem::move(m_buf + 1, m_buf, sizeof(T) * m_size);
         new (m_buf) T(std::move(item));
+        m_size++;
 		return Iterator(m_buf);
     }
 
-    template <typename T>
-	Vector<T>::Iterator Vector<T>::pushBack(const T &item)
+    template <typename T, MemTag Tag>
+	Vector<T, Tag>::Iterator Vector<T, Tag>::pushBack(const T &item)
     {
-        resize(m_size + 1);
-        new (m_buf + m_size - 1) T(std::move(item));
+        allocate(m_size + 1);
+        new (m_buf + m_size) T(std::move(item));
+        m_size++;
 		return Iterator(m_buf + m_size - 1);
     }
 
-    template <typename T>
-    T Vector<T>::popFront()
+    template <typename T, MemTag Tag>
+    T Vector<T, Tag>::popFront()
     {
         T item = std::move(m_buf[0]);
         m_buf[0].~T();
-		mem::move(m_buf, m_buf + 1, m_size - 1);
+		mem::move(m_buf, m_buf + 1, sizeof(T) * (m_size - 1));
         m_size--;
 		return item;
     }
 
-    template <typename T>
-    T Vector<T>::popBack()
+    template <typename T, MemTag Tag>
+    T Vector<T, Tag>::popBack()
     {
         T item = std::move(m_buf[m_size - 1]);
         m_buf[m_size - 1].~T();
@@ -523,174 +520,176 @@ namespace llt
 		return item;
     }
 
-	template <typename T>
+	template <typename T, MemTag Tag>
 	template <typename ...Args>
-	Vector<T>::Iterator Vector<T>::emplaceFront(Args &&...args)
+	Vector<T, Tag>::Iterator Vector<T, Tag>::emplaceFront(Args &&...args)
 	{
-		resize(m_size + 1);
-		mem::move(m_buf + 1, m_buf, sizeof(T) * (m_size - 1));
+		allocate(m_size + 1);
+		mem::move(m_buf + 1, m_buf, sizeof(T) * m_size);
 		new (m_buf) T(std::forward<Args>(args)...);
+		m_size++;
 		return Iterator(m_buf);
 	}
 
-	template <typename T>
+	template <typename T, MemTag Tag>
 	template <typename ...Args>
-	Vector<T>::Iterator Vector<T>::emplaceBack(Args &&...args)
+	Vector<T, Tag>::Iterator Vector<T, Tag>::emplaceBack(Args &&...args)
 	{
-		resize(m_size + 1);
-		new (m_buf + m_size - 1) T(std::forward<Args>(args)...);
+		allocate(m_size + 1);
+		new (m_buf + m_size) T(std::forward<Args>(args)...);
+		m_size++;
 		return Iterator(m_buf + m_size - 1);
 	}
 
-	template <typename T>
-	T *Vector<T>::data()
+	template <typename T, MemTag Tag>
+	T *Vector<T, Tag>::data()
 	{
 		return m_buf;
 	}
 
-	template <typename T>
-	const T *Vector<T>::data() const
+	template <typename T, MemTag Tag>
+	const T *Vector<T, Tag>::data() const
 	{
 		return m_buf;
 	}
 
-	template <typename T>
-	T &Vector<T>::front()
+	template <typename T, MemTag Tag>
+	T &Vector<T, Tag>::front()
 	{
 		return m_buf[0];
 	}
 
-	template <typename T>
-	const T &Vector<T>::front() const
+	template <typename T, MemTag Tag>
+	const T &Vector<T, Tag>::front() const
 	{
 		return m_buf[0];
 	}
 
-	template <typename T>
-	T &Vector<T>::back()
+	template <typename T, MemTag Tag>
+	T &Vector<T, Tag>::back()
 	{
 		return m_buf[m_size - 1];
 	}
 
-	template <typename T>
-	const T &Vector<T>::back() const
+	template <typename T, MemTag Tag>
+	const T &Vector<T, Tag>::back() const
 	{
 		return m_buf[m_size - 1];
 	}
 
-    template <typename T>
-    uint64_t Vector<T>::size() const
+    template <typename T, MemTag Tag>
+    uint64_t Vector<T, Tag>::size() const
     {
         return m_size;
     }
 
-	template <typename T>
-	bool Vector<T>::any() const
+	template <typename T, MemTag Tag>
+	bool Vector<T, Tag>::any() const
 	{
 		return m_size != 0;
 	}
 
-	template <typename T>
-	bool Vector<T>::empty() const
+	template <typename T, MemTag Tag>
+	bool Vector<T, Tag>::empty() const
 	{
 		return m_size == 0;
 	}
 
-	template <typename T>
-	typename Vector<T>::Iterator Vector<T>::begin()
+	template <typename T, MemTag Tag>
+	typename Vector<T, Tag>::Iterator Vector<T, Tag>::begin()
 	{
 		return Iterator(m_buf);
 	}
 
-	template <typename T>
-	typename Vector<T>::ConstIterator Vector<T>::begin() const
+	template <typename T, MemTag Tag>
+	typename Vector<T, Tag>::ConstIterator Vector<T, Tag>::begin() const
 	{
 		return ConstIterator(m_buf);
 	}
 
-	template <typename T>
-	typename Vector<T>::Iterator Vector<T>::end()
+	template <typename T, MemTag Tag>
+	typename Vector<T, Tag>::Iterator Vector<T, Tag>::end()
 	{
 		return Iterator(m_buf + m_size);
 	}
 
-	template <typename T>
-	typename Vector<T>::ConstIterator Vector<T>::end() const
+	template <typename T, MemTag Tag>
+	typename Vector<T, Tag>::ConstIterator Vector<T, Tag>::end() const
 	{
 		return ConstIterator(m_buf + m_size);
 	}
 
-	template <typename T>
-	typename Vector<T>::ReverseIterator Vector<T>::rbegin()
+	template <typename T, MemTag Tag>
+	typename Vector<T, Tag>::ReverseIterator Vector<T, Tag>::rbegin()
 	{
 		return ReverseIterator(m_buf + m_size - 1);
 	}
 
-	template <typename T>
-	typename Vector<T>::ReverseConstIterator Vector<T>::rbegin() const
+	template <typename T, MemTag Tag>
+	typename Vector<T, Tag>::ReverseConstIterator Vector<T, Tag>::rbegin() const
 	{
 		return ReverseConstIterator(m_buf + m_size - 1);
 	}
 
-	template <typename T>
-	typename Vector<T>::ReverseIterator Vector<T>::rend()
+	template <typename T, MemTag Tag>
+	typename Vector<T, Tag>::ReverseIterator Vector<T, Tag>::rend()
 	{
 		return ReverseIterator(m_buf - 1);
 	}
 
-	template <typename T>
-	typename Vector<T>::ReverseConstIterator Vector<T>::rend() const
+	template <typename T, MemTag Tag>
+	typename Vector<T, Tag>::ReverseConstIterator Vector<T, Tag>::rend() const
 	{
 		return ReverseConstIterator(m_buf - 1);
 	}
 
-	template <typename T>
-	typename Vector<T>::ConstIterator Vector<T>::cbegin() const
+	template <typename T, MemTag Tag>
+	typename Vector<T, Tag>::ConstIterator Vector<T, Tag>::cbegin() const
 	{
 		return ConstIterator(m_buf);
 	}
 
-	template <typename T>
-	typename Vector<T>::ConstIterator Vector<T>::cend() const
+	template <typename T, MemTag Tag>
+	typename Vector<T, Tag>::ConstIterator Vector<T, Tag>::cend() const
 	{
 		return ConstIterator(m_buf + m_size);
 	}
 
-	template <typename T>
-	typename Vector<T>::ReverseConstIterator Vector<T>::crbegin() const
+	template <typename T, MemTag Tag>
+	typename Vector<T, Tag>::ReverseConstIterator Vector<T, Tag>::crbegin() const
 	{
 		return ReverseConstIterator(m_buf + m_size - 1);
 	}
 
-	template <typename T>
-	typename Vector<T>::ReverseConstIterator Vector<T>::crend() const
+	template <typename T, MemTag Tag>
+	typename Vector<T, Tag>::ReverseConstIterator Vector<T, Tag>::crend() const
 	{
 		return ReverseConstIterator(m_buf - 1);
 	}
 
-    template <typename T>
-    T &Vector<T>::at(uint64_t idx)
+    template <typename T, MemTag Tag>
+    T &Vector<T, Tag>::at(uint64_t idx)
     {
 		LLT_ASSERT(idx >= 0 && idx < m_size, "Index must be within bounds: INDEX=%llu, SIZE=%llu", idx, m_size);
         return m_buf[idx];
     }
 
-    template <typename T>
-    const T &Vector<T>::at(uint64_t idx) const
+    template <typename T, MemTag Tag>
+    const T &Vector<T, Tag>::at(uint64_t idx) const
     {
 		LLT_ASSERT(idx >= 0 && idx < m_size, "Index must be within bounds: INDEX=%llu, SIZE=%llu", idx, m_size);
         return m_buf[idx];
     }
 
-    template <typename T>
-    T &Vector<T>::operator [] (uint64_t idx)
+    template <typename T, MemTag Tag>
+    T &Vector<T, Tag>::operator [] (uint64_t idx)
     {
 		LLT_ASSERT(idx >= 0 && idx < m_size, "Index must be within bounds: INDEX=%llu, SIZE=%llu", idx, m_size);
         return m_buf[idx];
     }
 
-    template <typename T>
-    const T &Vector<T>::operator [] (uint64_t idx) const
+    template <typename T, MemTag Tag>
+    const T &Vector<T, Tag>::operator [] (uint64_t idx) const
     {
 		LLT_ASSERT(idx >= 0 && idx < m_size, "Index must be within bounds: INDEX=%llu, SIZE=%llu", idx, m_size);
         return m_buf[idx];
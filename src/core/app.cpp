@@ -2,15 +2,26 @@
 
 #include "platform.h"
 #include "debug_ui.h"
+#include "benchmark.h"
 #include "profiler.h"
+#include "cpu_profiler.h"
+#include "thread_pool.h"
+#include "mem_tracker.h"
+#include "frame_replay.h"
 
 #include "vulkan/core.h"
+#include "vulkan/frame_capture.h"
 
 #include "rendering/camera.h"
 #include "rendering/material_system.h"
+#include "rendering/texture_mgr.h"
+#include "rendering/dynamic_resolution.h"
 
 #include "input/input.h"
 
+#include "io/async_io.h"
+#include "io/vfs.h"
+
 #include "math/timer.h"
 #include "math/calc.h"
 #include "math/colour.h"
@@ -25,36 +36,62 @@ App::App(const Config &config)
 	, m_camera(config.width, config.height, 75.0f, 0.01f, 100.0f)
 	, m_renderer()
 	, m_frameCount(0)
+	, m_benchmark(nullptr)
 {
+#ifdef LLT_DEBUG
+	if (m_config.hasFlag(Config::FLAG_TRACK_LEAKS_BIT)) {
+		memtrack::setCallstackCapture(true);
+	}
+#endif // LLT_DEBUG
+
+	cpuprofiler::setThreadName("main");
+
 	g_platform = new Platform(config);
+
+	// created before the vulkan backend since its managers hand work off to the pool
+	g_threadPool = new ThreadPool();
+
 	g_vkCore = new VulkanCore(config);
 
+	g_asyncIO = AsyncIO::create();
+
+	// anything in the archive shadows the loose file under res/, built with the packer tool
+	g_vfs = new VirtualFileSystem();
+	g_vfs->mount("../../res/assets.llpk", "../../res/");
+
 	g_inputState = new Input();
 
-	Swapchain *swapchain = g_vkCore->createSwapchain();
-	swapchain->setClearColours(Colour::black());
+	if (m_config.hasFlag(Config::FLAG_HEADLESS_BIT))
+	{
+		g_vkCore->createHeadlessTarget(m_config.width, m_config.height);
+	}
+	else
+	{
+		Swapchain *swapchain = g_vkCore->createSwapchain();
+		swapchain->setClearColours(Colour::black());
 
-	g_platform->initImGui();
+		g_platform->initImGui();
 
-	g_platform->setWindowName(m_config.name);
-	g_platform->setWindowSize({ m_config.width, m_config.height });
-	g_platform->setWindowMode(m_config.windowMode);
-	g_platform->setWindowOpacity(m_config.opacity);
-	g_platform->setCursorVisible(!m_config.hasFlag(Config::FLAG_CURSOR_INVISIBLE_BIT));
-	g_platform->toggleWindowResizable(m_config.hasFlag(Config::FLAG_RESIZABLE_BIT));
-	g_platform->lockCursor(m_config.hasFlag(Config::FLAG_LOCK_CURSOR_BIT));
+		g_platform->setWindowName(m_config.name);
+		g_platform->setWindowSize({ m_config.width, m_config.height });
+		g_platform->setWindowMode(m_config.windowMode);
+		g_platform->setWindowOpacity(m_config.opacity);
+		g_platform->setCursorVisible(!m_config.hasFlag(Config::FLAG_CURSOR_INVISIBLE_BIT));
+		g_platform->toggleWindowResizable(m_config.hasFlag(Config::FLAG_RESIZABLE_BIT));
+		g_platform->lockCursor(m_config.hasFlag(Config::FLAG_LOCK_CURSOR_BIT));
 
-	if (m_config.hasFlag(Config::FLAG_CENTRE_WINDOW_BIT))
-	{
-		glm::ivec2 screenSize = g_platform->getScreenSize();
+		if (m_config.hasFlag(Config::FLAG_CENTRE_WINDOW_BIT))
+		{
+			glm::ivec2 screenSize = g_platform->getScreenSize();
 
-		g_platform->setWindowPosition({
-			(int)((screenSize.x - m_config.width) * 0.5f),
-			(int)((screenSize.y - m_config.height) * 0.5f)
-		});
+			g_platform->setWindowPosition({
+				(int)((screenSize.x - m_config.width) * 0.5f),
+				(int)((screenSize.y - m_config.height) * 0.5f)
+			});
+		}
 	}
 
-	g_profiler = new Profiler(100);
+	g_profiler = new Profiler();
 
 	m_running = true;
 
@@ -64,6 +101,35 @@ App::App(const Config &config)
 
 	m_renderer.init();
 
+	if (m_config.dynamicResolutionMs > 0.0f)
+	{
+		g_dynamicResolution.setTargetMs(m_config.dynamicResolutionMs);
+		g_dynamicResolution.setMinScale(m_config.dynamicResolutionMinScale);
+		g_dynamicResolution.setEnabled(true);
+	}
+
+	if (m_config.benchmarkScenario)
+	{
+		m_benchmark = Benchmark::create(
+			m_config.benchmarkScenario,
+			m_config.benchmarkWarmupFrames,
+			m_config.benchmarkMeasuredFrames,
+			m_config.benchmarkOutputPath
+		);
+
+		if (!m_benchmark)
+		{
+			Benchmark::logScenarios();
+			LLT_ERROR("Unknown benchmark scenario: %s", m_config.benchmarkScenario);
+		}
+
+		m_benchmark->build(m_renderer, m_camera);
+	}
+	else
+	{
+		m_renderer.loadDefaultScene();
+	}
+
 	dbgui::init();
 
 	if (m_config.onInit) {
@@ -77,12 +143,21 @@ App::~App()
 		m_config.onDestroy();
 	}
 
+	// make sure no reads are still landing in buffers owned by the systems we're about to tear down
+	g_asyncIO->waitIdle();
+
+	delete m_benchmark;
+
 	m_renderer.cleanUp();
 
+	delete g_asyncIO;
+	delete g_vfs;
+
 	delete g_profiler;
 	delete g_inputState;
 
 	delete g_vkCore;
+	delete g_threadPool;
 	delete g_platform;
 }
 
@@ -96,19 +171,37 @@ void App::run()
 
 	while (m_running)
 	{
+		cpuprofiler::beginFrame();
+
+		LLT_PROFILE_SCOPE("App::run");
+
 		g_platform->pollEvents();
 		g_inputState->update();
 
+		g_asyncIO->poll();
+		g_textureManager->update();
+
 		if (g_inputState->isPressed(KB_KEY_ESCAPE)) {
 			exit();
 		}
 
-		g_platform->imGuiNewFrame();
+		if (g_platform->hasWindow()) {
+			g_platform->imGuiNewFrame();
+		}
 
 		double deltaTime = deltaTimer.reset();
 
 		accumulator += CalcF::min(deltaTime, fixedDeltaTime);
 
+		// benchmarks step by frame rather than by time so every run renders exactly the same frames
+		if (m_benchmark)
+		{
+			deltaTime = fixedDeltaTime;
+			accumulator = 0.0;
+
+			m_benchmark->updateCamera(m_camera);
+		}
+
 		while (accumulator >= fixedDeltaTime)
 		{
 			if (g_inputState->isDown(KB_KEY_F))
@@ -118,7 +211,7 @@ void App::run()
 
 				m_camera.update(fixedDeltaTime);
 			}
-			else
+			else if (g_platform->hasWindow())
 			{
 				g_platform->setCursorVisible(true);
 			}
@@ -126,11 +219,59 @@ void App::run()
 			accumulator -= fixedDeltaTime;
 		}
 
-		dbgui::update();
+		if (g_platform->hasWindow())
+		{
+			LLT_PROFILE_SCOPE("dbgui::update");
+			dbgui::update();
+		}
+
+		bool capturing = m_config.capturePath && m_frameCount == (int)m_config.captureFrame;
+
+		if (capturing)
+		{
+			g_frameCapture = new FrameCapture();
+			g_frameCapture->begin();
+		}
 
 		m_renderer.render(m_camera, deltaTime);
 
+		if (capturing)
+		{
+			g_frameCapture->end();
+
+			FrameCapture *capture = g_frameCapture;
+			g_frameCapture = nullptr;
+
+			if (capture->save(m_config.capturePath)) {
+				LLT_LOG("Captured %" PRIu64 " commands (%" PRIu64 " bytes) from frame %d to %s", capture->getCommandCount(), capture->getSize(), m_frameCount, m_config.capturePath);
+			}
+
+			delete capture;
+
+			// straight away, before the next frame recycles any of the descriptor sets or buffers the capture names
+			if (m_config.replayIterations > 0)
+			{
+				framereplay::run(m_config.capturePath, m_config.replayIterations, m_config.benchmarkOutputPath);
+				exit();
+			}
+		}
+
+		memtrack::endFrame();
+
 		m_frameCount++;
+
+		if (m_config.frameLimit > 0 && m_frameCount >= (int)m_config.frameLimit) {
+			exit();
+		}
+
+		if (m_benchmark && m_benchmark->endFrame()) {
+			exit();
+		}
+	}
+
+	// stands in for presenting when headless, so the result of an automated run can still be looked at
+	if (g_vkCore->isHeadless() && m_config.headlessReadbackPath) {
+		g_vkCore->saveHeadlessTarget(m_config.headlessReadbackPath);
 	}
 }
 
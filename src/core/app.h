@@ -31,7 +31,10 @@ namespace llt
 			FLAG_CURSOR_INVISIBLE_BIT   = 1 << 2,
 			FLAG_CENTRE_WINDOW_BIT      = 1 << 3,
 			FLAG_HIGH_PIXEL_DENSITY_BIT = 1 << 4,
-			FLAG_LOCK_CURSOR_BIT		= 1 << 5
+			FLAG_LOCK_CURSOR_BIT		= 1 << 5,
+			FLAG_HEADLESS_BIT			= 1 << 6, // no window or swapchain, frames are rendered into a width x height target instead
+			FLAG_TRACK_LEAKS_BIT		= 1 << 7, // debug builds only, remembers where every tracked allocation came from and logs what's left on exit
+			FLAG_API_STATS_BIT			= 1 << 8  // counts and times the vulkan calls made each frame, see vulkan/api_stats.h
 		};
 
 		const char *name = nullptr;
@@ -42,6 +45,27 @@ namespace llt
 		int flags = 0;
 		bool vsync = false;
 
+		// exits once this many frames have been rendered, 0 runs until told to exit
+		unsigned frameLimit = 0;
+
+		// headless only, the last frame is read back and saved here as a png on the way out
+		const char *headlessReadbackPath = nullptr;
+
+		// runs the named benchmark scenario instead of the default scene and exits once it's written its report
+		const char *benchmarkScenario = nullptr;
+		unsigned benchmarkWarmupFrames = 120;
+		unsigned benchmarkMeasuredFrames = 600;
+		const char *benchmarkOutputPath = "benchmark"; // .json and .csv are added on
+
+		// saves what the graphics queue was given on one frame, then replays it on its own replayIterations times (see core/frame_replay.h)
+		const char *capturePath = nullptr;
+		unsigned captureFrame = 120;
+		unsigned replayIterations = 0;
+
+		// gpu budget for the forward pass, the scene's rendered at a lower resolution to stay in it (see rendering/dynamic_resolution.h). 0 keeps it at full resolution
+		float dynamicResolutionMs = 0.0f;
+		float dynamicResolutionMinScale = 0.5f;
+
 		WindowMode windowMode = WINDOW_MODE_WINDOWED_BIT;
 
 		Function<void(void)> onInit = nullptr;
@@ -51,6 +75,8 @@ namespace llt
 		constexpr bool hasFlag(ConfigFlag flag) const { return flags & flag; }
 	};
 
+	class Benchmark;
+
 	class App
 	{
 	public:
@@ -65,6 +91,8 @@ namespace llt
 		bool m_running;
 		int m_frameCount;
 
+		Benchmark *m_benchmark;
+
 		Camera m_camera;
 		Renderer m_renderer;
 	};
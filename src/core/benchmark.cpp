@@ -0,0 +1,736 @@
+#include "benchmark.h"
+
+#include <algorithm>
+#include <fstream>
+
+#include <glm/glm.hpp>
+
+#include "profiler.h"
+#include "cpu_profiler.h"
+#include "mem_tracker.h"
+
+#include "vulkan/core.h"
+#include "vulkan/image.h"
+
+#include "rendering/renderer.h"
+#include "rendering/camera.h"
+#include "rendering/material_system.h"
+#include "rendering/mesh_loader.h"
+#include "rendering/texture_mgr.h"
+#include "rendering/bindless_resource_mgr.h"
+#include "rendering/dynamic_resolution.h"
+
+#include "math/calc.h"
+#include "math/colour.h"
+
+using namespace llt;
+
+// past this many frames after the last measured one, any gpu time still missing is given up on
+static constexpr unsigned MAX_DRAIN_FRAMES = 16;
+
+static constexpr const char *WOOD_CUBE_PATH = "../../res/models/GLTF/WoodCube/Scene.gltf";
+static constexpr const char *SPONZA_PATH = "../../res/models/GLTF/Sponza/Sponza.gltf";
+
+const Benchmark::Scenario Benchmark::SCENARIOS[] =
+{
+	{ "sponza",				"the sponza atrium, walked through end to end",						Benchmark::buildSponza },
+	{ "many-instances",		"a 32x32 grid of separately loaded cubes sharing one material",		Benchmark::buildManyInstances },
+	{ "many-materials",		"a 16x16 grid of cubes, each with a material of its own",			Benchmark::buildManyMaterials },
+	{ "huge-mesh",			"one sphere of ~4m triangles split into 16 bit index chunks",		Benchmark::buildHugeMesh }
+};
+
+Benchmark *Benchmark::create(const char *scenario, unsigned warmupFrames, unsigned measuredFrames, const char *outputPath)
+{
+	for (auto &entry : SCENARIOS)
+	{
+		if (cstr::compare(entry.name, scenario) == 0) {
+			return new Benchmark(&entry, warmupFrames, measuredFrames, outputPath);
+		}
+	}
+
+	return nullptr;
+}
+
+void Benchmark::logScenarios()
+{
+	LLT_LOG("Benchmark scenarios:");
+
+	for (auto &entry : SCENARIOS) {
+		LLT_LOG("  %-16s %s", entry.name, entry.description);
+	}
+}
+
+Benchmark::Benchmark(const Scenario *scenario, unsigned warmupFrames, unsigned measuredFrames, const char *outputPath)
+	: m_scenario(scenario)
+	, m_warmupFrames(warmupFrames)
+	, m_measuredFrames(CalcU::max(measuredFrames, 1))
+	, m_outputPath(outputPath)
+	, m_path()
+	, m_frame(0)
+	, m_lastFrameStart(0)
+	, m_results()
+	, m_pendingGpu(0)
+	, m_drainFrames(0)
+	, m_drawCount(0)
+	, m_triangleCount(0)
+	, m_renderStats()
+	, m_apiCalls()
+	, m_peakGpuMemoryUsage(0)
+	, m_gpuMemoryBudget(0)
+	, m_peakCpuMemoryUsage(0)
+	, m_cpuAllocations()
+{
+}
+
+Benchmark::~Benchmark()
+{
+}
+
+void Benchmark::build(Renderer &renderer, Camera &camera)
+{
+	LLT_LOG("Building benchmark scenario '%s'...", m_scenario->name);
+
+	m_scenario->build(renderer, m_path);
+
+	LLT_ASSERT(m_path.size() > 0, "Benchmark scenario has no camera path.");
+
+	const Vector<SubMesh *> &renderList = renderer.getScene().getRenderList();
+
+	if (renderList.size() > BindlessResourceManager::MAX_TRANSFORMS) {
+		LLT_LOG("Benchmark scene has %" PRIu64 " draws, only the first %d will be rendered.", renderList.size(), BindlessResourceManager::MAX_TRANSFORMS);
+	}
+
+	m_drawCount = Calc<uint64_t>::min(renderList.size(), BindlessResourceManager::MAX_TRANSFORMS);
+
+	for (int i = 0; i < m_drawCount; i++) {
+		m_triangleCount += renderList[i]->getIndexCount() / 3;
+	}
+
+	m_results.allocate(m_measuredFrames);
+
+	updateCamera(camera);
+
+	// with no warmup the first measured frame has nothing before it, so time it from the end of the build
+	m_lastFrameStart = cpuprofiler::now();
+}
+
+void Benchmark::updateCamera(Camera &camera)
+{
+	// held at the start of the path while warming up, then across it once over the measured frames
+	float t = 0.0f;
+
+	if (m_frame >= m_warmupFrames && m_measuredFrames > 1) {
+		t = CalcF::min((float)(m_frame - m_warmupFrames) / (float)(m_measuredFrames - 1), 1.0f);
+	}
+
+	float segment = t * (float)(m_path.size() - 1);
+	int index = CalcI::min((int)segment, (int)m_path.size() - 2);
+
+	if (m_path.size() == 1)
+	{
+		camera.position = m_path[0].position;
+		camera.lookAt(m_path[0].target);
+		return;
+	}
+
+	float alpha = segment - (float)index;
+
+	const CameraKey &from = m_path[index];
+	const CameraKey &to = m_path[index + 1];
+
+	camera.position = glm::mix(from.position, to.position, alpha);
+	camera.lookAt(glm::mix(from.target, to.target, alpha));
+}
+
+bool Benchmark::endFrame()
+{
+	uint64_t frameStart = cpuprofiler::now();
+	uint64_t frameIndex = cpuprofiler::getFrameIndex();
+
+	unsigned frame = m_frame++;
+
+	// the first measured frame needs the one before it to have been timed from
+	if (frame >= m_warmupFrames && frame < m_warmupFrames + m_measuredFrames)
+	{
+		double msPerTick = 1000.0 / (double)cpuprofiler::getTicksPerSecond();
+
+		FrameResult result = {};
+		result.frameIndex = frameIndex;
+		result.cpuMs = (double)(frameStart - m_lastFrameStart) * msPerTick;
+		result.gpuMs = 0.0;
+		result.hasGpu = false;
+		result.renderScale = g_dynamicResolution.getScale();
+
+		m_results.pushBack(result);
+		m_pendingGpu++;
+
+		// the renderer's already moved this frame's counters over by the time we get here
+		const RenderStats &stats = renderstats::getLastFrame();
+
+		m_renderStats.drawCalls += stats.drawCalls;
+		m_renderStats.instances += stats.instances;
+		m_renderStats.triangles += stats.triangles;
+		m_renderStats.pipelineBinds += stats.pipelineBinds;
+		m_renderStats.descriptorSetBinds += stats.descriptorSetBinds;
+		m_renderStats.pushConstantBytes += stats.pushConstantBytes;
+		m_renderStats.barriers += stats.barriers;
+		m_renderStats.submissions += stats.submissions;
+		m_renderStats.fenceWaits += stats.fenceWaits;
+		m_renderStats.uploadBytes += stats.uploadBytes;
+
+		const Vector<ApiCallStats> &calls = apistats::getLastFrame();
+
+		// empty unless --api-stats, otherwise the same functions in the same order every frame
+		if (m_apiCalls.empty())
+		{
+			m_apiCalls = calls;
+		}
+		else
+		{
+			for (int i = 0; i < calls.size(); i++)
+			{
+				m_apiCalls[i].calls += calls[i].calls;
+				m_apiCalls[i].ms += calls[i].ms;
+			}
+		}
+
+		sampleMemory();
+	}
+
+	m_lastFrameStart = frameStart;
+
+	collectGpuTimes();
+
+	if (frame + 1 < m_warmupFrames + m_measuredFrames) {
+		return false;
+	}
+
+	// keep rendering until the gpu has caught up with the last measured frame
+	if (m_pendingGpu > 0 && m_drainFrames++ < MAX_DRAIN_FRAMES) {
+		return false;
+	}
+
+	if (m_pendingGpu > 0) {
+		LLT_LOG("Gave up waiting on the gpu times of %u frames.", m_pendingGpu);
+	}
+
+	writeReport();
+
+	return true;
+}
+
+void Benchmark::collectGpuTimes()
+{
+	// the profiler only keeps so many frames around, so this has to keep up every frame rather than at the end
+	for (int i = (int)m_results.size() - 1; i >= 0 && m_pendingGpu > 0; i--)
+	{
+		FrameResult &result = m_results[i];
+
+		if (result.hasGpu) {
+			continue;
+		}
+
+		if (g_profiler->getFrameTime(result.frameIndex, &result.gpuMs))
+		{
+			result.hasGpu = true;
+			m_pendingGpu--;
+		}
+	}
+}
+
+void Benchmark::sampleMemory()
+{
+	VmaBudget budgets[VK_MAX_MEMORY_HEAPS] = {};
+	vmaGetHeapBudgets(g_vkCore->m_vmaAllocator, budgets);
+
+	const VkPhysicalDeviceMemoryProperties *memoryProperties = nullptr;
+	vmaGetMemoryProperties(g_vkCore->m_vmaAllocator, &memoryProperties);
+
+	uint64_t usage = 0;
+	uint64_t budget = 0;
+
+	for (int i = 0; i < memoryProperties->memoryHeapCount; i++)
+	{
+		if (!(memoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)) {
+			continue;
+		}
+
+		usage += budgets[i].usage;
+		budget += budgets[i].budget;
+	}
+
+	m_peakGpuMemoryUsage = Calc<uint64_t>::max(m_peakGpuMemoryUsage, usage);
+	m_gpuMemoryBudget = budget;
+
+	m_peakCpuMemoryUsage = Calc<uint64_t>::max(m_peakCpuMemoryUsage, memtrack::getTotalLiveBytes());
+
+	for (int i = 0; i < MEM_TAG_MAX_ENUM; i++) {
+		m_cpuAllocations[i] += memtrack::getStats((MemTag)i).frameAllocations;
+	}
+}
+
+Benchmark::Percentiles Benchmark::calcPercentiles(bool gpu) const
+{
+	Vector<double> times;
+
+	for (auto &result : m_results)
+	{
+		if (gpu && !result.hasGpu) {
+			continue;
+		}
+
+		times.pushBack(gpu ? result.gpuMs : result.cpuMs);
+	}
+
+	Percentiles percentiles = {};
+	percentiles.count = times.size();
+
+	if (times.size() == 0) {
+		return percentiles;
+	}
+
+	std::sort(times.data(), times.data() + times.size());
+
+	// nearest rank, so every percentile is a time that was actually measured
+	auto percentile = [&](double p) -> double {
+		uint64_t rank = (uint64_t)glm::ceil(p * (double)times.size());
+		return times[Calc<uint64_t>::max(rank, 1) - 1];
+	};
+
+	double sum = 0.0;
+
+	for (double time : times) {
+		sum += time;
+	}
+
+	percentiles.min = times[0];
+	percentiles.avg = sum / (double)times.size();
+	percentiles.p50 = percentile(0.50);
+	percentiles.p90 = percentile(0.90);
+	percentiles.p95 = percentile(0.95);
+	percentiles.p99 = percentile(0.99);
+	percentiles.max = times[times.size() - 1];
+
+	return percentiles;
+}
+
+static void writePercentiles(std::ofstream &file, const char *name, uint32_t count, double min, double avg, double p50, double p90, double p95, double p99, double max)
+{
+	char buffer[512];
+
+	snprintf(
+		buffer, sizeof(buffer),
+		"\t\"%s\": { \"count\": %u, \"min\": %.4f, \"avg\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f }",
+		name, count, min, avg, p50, p90, p95, p99, max
+	);
+
+	file << buffer;
+}
+
+bool Benchmark::writeReport() const
+{
+	String jsonPath = String(m_outputPath) + ".json";
+	String csvPath = String(m_outputPath) + ".csv";
+
+	std::ofstream json(jsonPath.cstr(), std::ios::trunc);
+	std::ofstream csv(csvPath.cstr(), std::ios::trunc);
+
+	if (!json.is_open() || !csv.is_open())
+	{
+		LLT_LOG("Failed to open benchmark report for writing: %s", m_outputPath);
+		return false;
+	}
+
+	Percentiles cpu = calcPercentiles(false);
+	Percentiles gpu = calcPercentiles(true);
+
+	char buffer[512];
+
+	json << "{\n";
+
+	snprintf(
+		buffer, sizeof(buffer),
+		"\t\"scenario\": \"%s\",\n"
+		"\t\"warmupFrames\": %u,\n"
+		"\t\"measuredFrames\": %u,\n"
+		"\t\"width\": %u,\n"
+		"\t\"height\": %u,\n"
+		"\t\"drawCount\": %" PRIu64 ",\n"
+		"\t\"triangleCount\": %" PRIu64 ",\n"
+		"\t\"gpuMemoryPeakMB\": %.2f,\n"
+		"\t\"gpuMemoryBudgetMB\": %.2f,\n"
+		"\t\"cpuMemoryPeakMB\": %.2f,\n",
+		m_scenario->name,
+		m_warmupFrames,
+		m_measuredFrames,
+		g_vkCore->getBackbuffer()->getWidth(),
+		g_vkCore->getBackbuffer()->getHeight(),
+		m_drawCount,
+		m_triangleCount,
+		(double)m_peakGpuMemoryUsage / (1024.0 * 1024.0),
+		(double)m_gpuMemoryBudget / (1024.0 * 1024.0),
+		(double)m_peakCpuMemoryUsage / (1024.0 * 1024.0)
+	);
+
+	json << buffer;
+
+	writePercentiles(json, "cpuFrameMs", cpu.count, cpu.min, cpu.avg, cpu.p50, cpu.p90, cpu.p95, cpu.p99, cpu.max);
+	json << ",\n";
+	writePercentiles(json, "gpuFrameMs", gpu.count, gpu.min, gpu.avg, gpu.p50, gpu.p90, gpu.p95, gpu.p99, gpu.max);
+	json << ",\n";
+
+	double frameCount = (double)CalcU::max(m_results.size(), 1);
+
+	snprintf(
+		buffer, sizeof(buffer),
+		"\t\"perFrame\": { \"drawCalls\": %.1f, \"instances\": %.1f, \"triangles\": %.1f, \"pipelineBinds\": %.1f, "
+		"\"descriptorSetBinds\": %.1f, \"pushConstantBytes\": %.1f, \"barriers\": %.1f, \"submissions\": %.1f, "
+		"\"fenceWaits\": %.1f, \"uploadBytes\": %.1f },\n",
+		(double)m_renderStats.drawCalls / frameCount,
+		(double)m_renderStats.instances / frameCount,
+		(double)m_renderStats.triangles / frameCount,
+		(double)m_renderStats.pipelineBinds / frameCount,
+		(double)m_renderStats.descriptorSetBinds / frameCount,
+		(double)m_renderStats.pushConstantBytes / frameCount,
+		(double)m_renderStats.barriers / frameCount,
+		(double)m_renderStats.submissions / frameCount,
+		(double)m_renderStats.fenceWaits / frameCount,
+		(double)m_renderStats.uploadBytes / frameCount
+	);
+
+	json << buffer;
+
+	// frame times at a moving resolution can't be compared with fixed ones, so it says how far it moved
+	if (g_dynamicResolution.isEnabled())
+	{
+		float minScale = DynamicResolution::MAX_SCALE;
+		double scaleSum = 0.0;
+
+		for (auto &result : m_results)
+		{
+			minScale = CalcF::min(minScale, result.renderScale);
+			scaleSum += result.renderScale;
+		}
+
+		snprintf(
+			buffer, sizeof(buffer),
+			"\t\"renderScale\": { \"targetMs\": %.3f, \"avg\": %.4f, \"min\": %.4f },\n",
+			g_dynamicResolution.getTargetMs(),
+			scaleSum / frameCount,
+			minScale
+		);
+
+		json << buffer;
+	}
+
+	// live and peak are as of the end of the run, peak being since startup
+	json << "\t\"cpuMemory\": {\n";
+
+	for (int i = 0; i < MEM_TAG_MAX_ENUM; i++)
+	{
+		MemTagStats stats = memtrack::getStats((MemTag)i);
+
+		snprintf(
+			buffer, sizeof(buffer),
+			"\t\t\"%s\": { \"liveMB\": %.2f, \"peakMB\": %.2f, \"liveAllocations\": %" PRIu64 ", \"allocationsPerFrame\": %.1f }%s\n",
+			memtrack::getTagName((MemTag)i),
+			(double)stats.liveBytes / (1024.0 * 1024.0),
+			(double)stats.peakBytes / (1024.0 * 1024.0),
+			stats.liveAllocations,
+			(double)m_cpuAllocations[i] / frameCount,
+			(i + 1 < MEM_TAG_MAX_ENUM) ? "," : ""
+		);
+
+		json << buffer;
+	}
+
+	json << "\t}";
+
+	if (apistats::isInstalled())
+	{
+		json << ",\n\t\"vulkanApi\": {\n";
+
+		bool first = true;
+
+		for (auto &call : m_apiCalls)
+		{
+			if (call.calls == 0) {
+				continue;
+			}
+
+			snprintf(
+				buffer, sizeof(buffer),
+				"%s\t\t\"%s\": { \"callsPerFrame\": %.1f, \"msPerFrame\": %.4f }",
+				first ? "" : ",\n",
+				call.name,
+				(double)call.calls / frameCount,
+				call.ms / frameCount
+			);
+
+			json << buffer;
+			first = false;
+		}
+
+		json << "\n\t}";
+	}
+
+	json << "\n}\n";
+
+	csv << "frame,cpu_ms,gpu_ms\n";
+
+	for (int i = 0; i < m_results.size(); i++)
+	{
+		const FrameResult &result = m_results[i];
+
+		if (result.hasGpu) {
+			snprintf(buffer, sizeof(buffer), "%d,%.4f,%.4f\n", i, result.cpuMs, result.gpuMs);
+		} else {
+			snprintf(buffer, sizeof(buffer), "%d,%.4f,\n", i, result.cpuMs);
+		}
+
+		csv << buffer;
+	}
+
+	LLT_LOG(
+		"Benchmark '%s': cpu p50 %.3fms p99 %.3fms, gpu p50 %.3fms p99 %.3fms, written to %s.json",
+		m_scenario->name, cpu.p50, cpu.p99, gpu.p50, gpu.p99, m_outputPath
+	);
+
+	return true;
+}
+
+static RenderObject *createObject(Scene &scene, Mesh *mesh, const glm::vec3 &position, const glm::vec3 &scale)
+{
+	auto object = scene.createRenderObject();
+	object->transform.setPosition(position);
+	object->transform.setRotation(0.0f, { 1.0f, 0.0f, 0.0f });
+	object->transform.setScale(scale);
+	object->transform.setOrigin({ 0.0f, 0.0f, 0.0f });
+	object->mesh = mesh;
+	object->mesh->setOwner(&(*object));
+
+	return &(*object);
+}
+
+void Benchmark::buildSponza(Renderer &renderer, Vector<CameraKey> &path)
+{
+	Scene &scene = renderer.getScene();
+
+	Mesh *mesh = g_meshLoader->loadMesh("benchmark_sponza", SPONZA_PATH);
+	LLT_ASSERT(mesh, "Failed to load sponza for the benchmark.");
+
+	createObject(scene, mesh, { 0.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f });
+
+	// down the length of the atrium, then back along the upper floor looking across it
+	path.pushBack({ { -11.0f, 1.6f,  0.0f }, {  0.0f, 2.0f,  0.0f } });
+	path.pushBack({ {  -3.0f, 1.6f, -1.5f }, {  6.0f, 3.0f,  0.0f } });
+	path.pushBack({ {   9.0f, 1.6f,  0.0f }, { 12.0f, 4.0f,  0.0f } });
+	path.pushBack({ {   9.0f, 5.5f,  3.0f }, {  0.0f, 4.0f, -3.0f } });
+	path.pushBack({ {  -9.0f, 5.5f,  3.0f }, {  0.0f, 1.0f,  0.0f } });
+}
+
+void Benchmark::buildManyInstances(Renderer &renderer, Vector<CameraKey> &path)
+{
+	const int GRID_SIZE = 32;
+	const float SPACING = 3.0f;
+
+	Scene &scene = renderer.getScene();
+	scene.reserve(GRID_SIZE * GRID_SIZE);
+
+	char name[64];
+
+	for (int z = 0; z < GRID_SIZE; z++)
+	{
+		for (int x = 0; x < GRID_SIZE; x++)
+		{
+			// every object needs a mesh of its own, that's where the forward pass gets the transform from
+			snprintf(name, sizeof(name), "benchmark_cube_%d_%d", x, z);
+
+			Mesh *mesh = g_meshLoader->loadMesh(name, WOOD_CUBE_PATH);
+			LLT_ASSERT(mesh, "Failed to load the cube for the benchmark.");
+
+			createObject(
+				scene, mesh,
+				{ (x - GRID_SIZE * 0.5f) * SPACING, 0.0f, (z - GRID_SIZE * 0.5f) * SPACING },
+				{ 1.0f, 1.0f, 1.0f }
+			);
+		}
+	}
+
+	float extent = GRID_SIZE * SPACING * 0.5f;
+
+	path.pushBack({ { -extent, 12.0f,  extent }, { 0.0f, 0.0f, 0.0f } });
+	path.pushBack({ {  extent, 12.0f,  extent }, { 0.0f, 0.0f, 0.0f } });
+	path.pushBack({ {  extent,  4.0f, -extent }, { 0.0f, 0.0f, 0.0f } });
+	path.pushBack({ {    0.0f,  2.0f,    0.0f }, { -extent, 0.0f, -extent } });
+}
+
+void Benchmark::buildManyMaterials(Renderer &renderer, Vector<CameraKey> &path)
+{
+	const int GRID_SIZE = 16;
+	const float SPACING = 3.0f;
+	const int TEXTURE_SIZE = 4;
+
+	Scene &scene = renderer.getScene();
+	scene.reserve(GRID_SIZE * GRID_SIZE);
+
+	char name[64];
+
+	for (int z = 0; z < GRID_SIZE; z++)
+	{
+		for (int x = 0; x < GRID_SIZE; x++)
+		{
+			snprintf(name, sizeof(name), "benchmark_material_cube_%d_%d", x, z);
+
+			Mesh *mesh = g_meshLoader->loadMesh(name, WOOD_CUBE_PATH);
+			LLT_ASSERT(mesh, "Failed to load the cube for the benchmark.");
+
+			// a solid colour diffuse per cube is enough to make its material unique
+			Colour colour(
+				(uint8_t)(64 + x * 191 / (GRID_SIZE - 1)),
+				(uint8_t)(64 + z * 191 / (GRID_SIZE - 1)),
+				(uint8_t)(255 - (x + z) * 191 / (2 * GRID_SIZE - 2))
+			);
+
+			Image image(TEXTURE_SIZE, TEXTURE_SIZE);
+
+			image.paint([&](uint32_t, uint32_t) -> Colour {
+				return colour;
+			});
+
+			snprintf(name, sizeof(name), "benchmark_material_%d_%d", x, z);
+
+			Texture *diffuse = g_textureManager->createFromImage(name, image);
+
+			for (int i = 0; i < mesh->getSubmeshCount(); i++)
+			{
+				SubMesh *submesh = mesh->getSubmesh(i);
+
+				MaterialData data;
+				data.technique = "texturedPBR_opaque";
+				data.textures.pushBack(diffuse->getStandardView());
+				data.textures.pushBack(g_materialSystem->getAOFallback()->getStandardView());
+				data.textures.pushBack(g_materialSystem->getRoughnessMetallicFallback()->getStandardView());
+				data.textures.pushBack(g_materialSystem->getNormalFallback()->getStandardView());
+				data.textures.pushBack(g_materialSystem->getEmissiveFallback()->getStandardView());
+
+				submesh->setMaterial(g_materialSystem->getRegistry().buildMaterial(data));
+			}
+
+			createObject(
+				scene, mesh,
+				{ (x - GRID_SIZE * 0.5f) * SPACING, 0.0f, (z - GRID_SIZE * 0.5f) * SPACING },
+				{ 1.0f, 1.0f, 1.0f }
+			);
+		}
+	}
+
+	float extent = GRID_SIZE * SPACING * 0.5f;
+
+	path.pushBack({ { -extent, 8.0f,  extent }, { 0.0f, 0.0f, 0.0f } });
+	path.pushBack({ {  extent, 8.0f,  extent }, { 0.0f, 0.0f, 0.0f } });
+	path.pushBack({ {  extent, 3.0f, -extent }, { 0.0f, 0.0f, 0.0f } });
+}
+
+void Benchmark::buildHugeMesh(Renderer &renderer, Vector<CameraKey> &path)
+{
+	const int SEGMENTS = 2048;
+	const int RINGS = 1024;
+	const float RADIUS = 2.0f;
+
+	// submeshes use 16 bit indices, so the sphere is cut into bands of rings that each fit
+	const int ROWS_PER_CHUNK = (65535 / (SEGMENTS + 1)) - 1;
+
+	Mesh *mesh = g_meshLoader->createMesh("benchmark_huge_mesh");
+
+	MaterialData data;
+	data.technique = "texturedPBR_opaque";
+	data.textures.pushBack(g_materialSystem->getDiffuseFallback()->getStandardView());
+	data.textures.pushBack(g_materialSystem->getAOFallback()->getStandardView());
+	data.textures.pushBack(g_materialSystem->getRoughnessMetallicFallback()->getStandardView());
+	data.textures.pushBack(g_materialSystem->getNormalFallback()->getStandardView());
+	data.textures.pushBack(g_materialSystem->getEmissiveFallback()->getStandardView());
+
+	Material *material = g_materialSystem->getRegistry().buildMaterial(data);
+
+	Vector<ModelVertex> vertices;
+	Vector<uint16_t> indices;
+
+	for (int firstRow = 0; firstRow < RINGS; firstRow += ROWS_PER_CHUNK)
+	{
+		int rowCount = CalcI::min(ROWS_PER_CHUNK, RINGS - firstRow);
+
+		vertices.clear();
+		indices.clear();
+
+		glm::vec3 boundsMin(RADIUS);
+		glm::vec3 boundsMax(-RADIUS);
+
+		for (int row = 0; row <= rowCount; row++)
+		{
+			float v = (float)(firstRow + row) / (float)RINGS;
+			float theta = v * CalcF::PI;
+
+			for (int segment = 0; segment <= SEGMENTS; segment++)
+			{
+				float u = (float)segment / (float)SEGMENTS;
+				float phi = u * 2.0f * CalcF::PI;
+
+				glm::vec3 normal(
+					glm::sin(theta) * glm::cos(phi),
+					glm::cos(theta),
+					glm::sin(theta) * glm::sin(phi)
+				);
+
+				ModelVertex vertex = {};
+				vertex.position = normal * RADIUS;
+				vertex.uv = { u, v };
+				vertex.colour = { 1.0f, 1.0f, 1.0f };
+				vertex.normal = normal;
+				vertex.tangent = { -glm::sin(phi), 0.0f, glm::cos(phi) };
+				vertex.bitangent = glm::cross(vertex.normal, vertex.tangent);
+
+				boundsMin = glm::min(boundsMin, vertex.position);
+				boundsMax = glm::max(boundsMax, vertex.position);
+
+				vertices.pushBack(vertex);
+			}
+		}
+
+		for (int row = 0; row < rowCount; row++)
+		{
+			for (int segment = 0; segment < SEGMENTS; segment++)
+			{
+				uint16_t i0 = (uint16_t)(row * (SEGMENTS + 1) + segment);
+				uint16_t i1 = (uint16_t)(i0 + SEGMENTS + 1);
+
+				// clockwise from outside, the same as imported meshes end up after their winding's flipped
+				indices.pushBack(i0);
+				indices.pushBack(i1);
+				indices.pushBack(i0 + 1);
+
+				indices.pushBack(i1);
+				indices.pushBack(i1 + 1);
+				indices.pushBack(i0 + 1);
+			}
+		}
+
+		SubMesh *submesh = mesh->createSubmesh();
+
+		submesh->build(
+			g_modelVertexFormat,
+			vertices.data(), vertices.size(),
+			indices.data(), indices.size()
+		);
+
+		submesh->setBounds(boundsMin, boundsMax);
+		submesh->setMaterial(material);
+	}
+
+	createObject(renderer.getScene(), mesh, { 0.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f });
+
+	path.pushBack({ {  0.0f, 1.0f,  6.0f }, { 0.0f, 0.0f, 0.0f } });
+	path.pushBack({ {  6.0f, 2.0f,  0.0f }, { 0.0f, 0.0f, 0.0f } });
+	path.pushBack({ {  0.0f, 1.0f, -6.0f }, { 0.0f, 0.0f, 0.0f } });
+	path.pushBack({ {  0.0f, 0.5f,  2.5f }, { 0.0f, 0.0f, 0.0f } });
+}
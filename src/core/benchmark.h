@@ -0,0 +1,141 @@
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include <glm/vec3.hpp>
+
+#include "common.h"
+
+#include "container/vector.h"
+
+#include "vulkan/render_stats.h"
+#include "vulkan/api_stats.h"
+
+namespace llt
+{
+	class Camera;
+	class Renderer;
+
+	/**
+	 * Runs one of a fixed set of scenes with the camera on a scripted path and writes out how long the frames took.
+	 *
+	 * Nothing depends on wall time, the camera moves by frame number and the scene is the same every run,
+	 * so two reports of the same scenario on the same machine can be compared directly (tools/bench/compare.py).
+	 * The first few frames are thrown away so loading, pipeline creation and texture streaming have settled,
+	 * then every measured frame's cpu time (start to start) and gpu time (from the profiler) is kept.
+	 *
+	 * The report goes to <output>.json (percentiles, per frame counters, gpu and tagged cpu memory, vulkan calls with --api-stats)
+	 * and <output>.csv (every frame).
+	 */
+	class Benchmark
+	{
+	public:
+		/*
+		 * Null if there's no scenario by that name.
+		 */
+		static Benchmark *create(const char *scenario, unsigned warmupFrames, unsigned measuredFrames, const char *outputPath);
+
+		static void logScenarios();
+
+		~Benchmark();
+
+		/*
+		 * Fills the renderer's (empty) scene in and puts the camera at the start of the path.
+		 */
+		void build(Renderer &renderer, Camera &camera);
+
+		/*
+		 * Moves the camera to wherever it should be for the frame that's about to be rendered.
+		 */
+		void updateCamera(Camera &camera);
+
+		/*
+		 * Called once the frame's been submitted. True once the report's been written and the app can exit.
+		 */
+		bool endFrame();
+
+	private:
+		struct CameraKey
+		{
+			glm::vec3 position;
+			glm::vec3 target;
+		};
+
+		struct Scenario
+		{
+			const char *name;
+			const char *description;
+			void (*build)(Renderer &renderer, Vector<CameraKey> &path);
+		};
+
+		struct FrameResult
+		{
+			uint64_t frameIndex;
+			double cpuMs;
+			double gpuMs;
+			bool hasGpu;
+
+			// below 1 when dynamic resolution brought the scene down for this frame
+			float renderScale;
+		};
+
+		struct Percentiles
+		{
+			double min;
+			double avg;
+			double p50;
+			double p90;
+			double p95;
+			double p99;
+			double max;
+			uint32_t count;
+		};
+
+		static void buildSponza(Renderer &renderer, Vector<CameraKey> &path);
+		static void buildManyInstances(Renderer &renderer, Vector<CameraKey> &path);
+		static void buildManyMaterials(Renderer &renderer, Vector<CameraKey> &path);
+		static void buildHugeMesh(Renderer &renderer, Vector<CameraKey> &path);
+
+		static const Scenario SCENARIOS[];
+
+		Benchmark(const Scenario *scenario, unsigned warmupFrames, unsigned measuredFrames, const char *outputPath);
+
+		void collectGpuTimes();
+		void sampleMemory();
+
+		Percentiles calcPercentiles(bool gpu) const;
+
+		bool writeReport() const;
+
+		const Scenario *m_scenario;
+
+		unsigned m_warmupFrames;
+		unsigned m_measuredFrames;
+		const char *m_outputPath;
+
+		Vector<CameraKey> m_path;
+
+		// counts every frame since the benchmark started, warm-up included
+		unsigned m_frame;
+		uint64_t m_lastFrameStart;
+
+		Vector<FrameResult> m_results;
+		uint32_t m_pendingGpu;
+		unsigned m_drainFrames;
+
+		uint64_t m_drawCount;
+		uint64_t m_triangleCount;
+
+		// summed over the measured frames
+		RenderStats m_renderStats;
+		Vector<ApiCallStats> m_apiCalls;
+
+		uint64_t m_peakGpuMemoryUsage;
+		uint64_t m_gpuMemoryBudget;
+
+		// everything mem::alloc() has counted, allocations summed over the measured frames like the render stats
+		uint64_t m_peakCpuMemoryUsage;
+		uint64_t m_cpuAllocations[MEM_TAG_MAX_ENUM];
+	};
+}
+
+#endif // BENCHMARK_H_
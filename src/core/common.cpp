@@ -23,6 +23,35 @@ uint64_t hash::calc(uint64_t start, const String *str)
 	return calc(start, str->cstr());
 }
 
+uint64_t hash::calcBytes(uint64_t start, const void *data, uint64_t size)
+{
+	const uint64_t prime = 0x100000001B3;
+	const byte *input = (const byte *)data;
+
+	uint64_t output = start ^ 0xCBF29CE484222325;
+	uint64_t i = 0;
+
+	for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+	{
+		uint64_t word = 0;
+		::memcpy(&word, input + i, sizeof(uint64_t));
+
+		output ^= word;
+		output *= prime;
+
+		// a multiply only carries upwards, so fold the top half back down or the high bits of each word would barely count
+		output ^= output >> 32;
+	}
+
+	for (; i < size; i++)
+	{
+		output ^= input[i];
+		output *= prime;
+	}
+
+	return output;
+}
+
 void *mem::set(void *ptr, byte val, uint64_t size)
 {
 	return ::memset(ptr, val, size);
@@ -15,8 +15,8 @@
 
 #else
 
-#define LLT_ASSERT(_exp, _msg)
-#define LLT_ERROR(_msg)
+#define LLT_ASSERT(_exp, _msg, ...)
+#define LLT_ERROR(_msg, ...)
 #define LLT_LOG(_msg, ...) do{::printf((_msg "\n"), ##__VA_ARGS__);}while(0)
 
 #endif
@@ -47,6 +47,20 @@ using byte  = unsigned char;
 
 namespace llt
 {
+	/*
+	 * Which part of the engine an allocation belongs to, see core/mem_tracker.h.
+	 */
+	enum MemTag
+	{
+		MEM_TAG_GENERAL,
+		MEM_TAG_CONTAINERS,
+		MEM_TAG_STRINGS,
+		MEM_TAG_RENDERING,
+		MEM_TAG_ASSETS,
+		MEM_TAG_IO,
+		MEM_TAG_MAX_ENUM
+	};
+
 	template <uint64_t Size> class Str;
 	using String = Str<512>;
 
@@ -85,6 +99,9 @@ namespace llt
 
 		template <> uint64_t calc(uint64_t start, const char *str);
 		template <> uint64_t calc(uint64_t start, const String *str);
+
+		// for big blobs like whole files, goes a word at a time rather than a byte
+		uint64_t calcBytes(uint64_t start, const void *data, uint64_t size);
 	}
 
 	// wrapper around C memory functions to make code more legible
@@ -96,6 +113,10 @@ namespace llt
 		void *chr(void *ptr, byte val, uint64_t size);
 		int compare(const void *p1, const void *p2, uint64_t size);
 		bool vcompare(void *ptr, byte val, uint64_t size);
+
+		// tracked heap allocations, free has to be given the same size and tag the block was allocated with
+		void *alloc(uint64_t size, MemTag tag);
+		void free(void *ptr, uint64_t size, MemTag tag);
 	}
 
 	// wrapper around C string functions to make code more legible
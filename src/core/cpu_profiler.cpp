@@ -0,0 +1,265 @@
+#include "cpu_profiler.h"
+
+#include <atomic>
+#include <fstream>
+
+#if _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <time.h>
+#endif // _WIN32
+
+#include "math/calc.h"
+
+using namespace llt;
+
+struct ThreadBuffer
+{
+	cpuprofiler::Event events[cpuprofiler::EVENTS_PER_THREAD];
+	std::atomic<uint64_t> head;
+	std::atomic<const char *> name;
+	uint32_t id;
+};
+
+// never freed, a thread can still be recording into its buffer while everything else shuts down
+static std::atomic<ThreadBuffer *> g_threadBuffers[cpuprofiler::MAX_THREADS];
+static std::atomic<uint32_t> g_threadCount(0);
+
+static thread_local ThreadBuffer *t_threadBuffer = nullptr;
+static thread_local bool t_threadDropped = false;
+
+static uint64_t g_frameStarts[cpuprofiler::FRAME_HISTORY_LENGTH];
+static std::atomic<uint64_t> g_frameCount(0);
+
+static ThreadBuffer *getThreadBuffer()
+{
+	if (t_threadBuffer || t_threadDropped) {
+		return t_threadBuffer;
+	}
+
+	uint32_t id = g_threadCount.fetch_add(1);
+
+	if (id >= cpuprofiler::MAX_THREADS)
+	{
+		t_threadDropped = true;
+		return nullptr;
+	}
+
+	ThreadBuffer *buffer = new ThreadBuffer();
+	buffer->head = 0;
+	buffer->name = nullptr;
+	buffer->id = id;
+
+	g_threadBuffers[id].store(buffer, std::memory_order_release);
+	t_threadBuffer = buffer;
+
+	return buffer;
+}
+
+uint64_t cpuprofiler::now()
+{
+#if _WIN32
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return counter.QuadPart;
+#else
+	timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (uint64_t)time.tv_sec * 1000000000ull + (uint64_t)time.tv_nsec;
+#endif // _WIN32
+}
+
+uint64_t cpuprofiler::getTicksPerSecond()
+{
+#if _WIN32
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	return frequency.QuadPart;
+#else
+	return 1000000000ull;
+#endif // _WIN32
+}
+
+void cpuprofiler::record(const char *name, uint64_t begin, uint64_t end)
+{
+	ThreadBuffer *buffer = getThreadBuffer();
+
+	if (!buffer) {
+		return;
+	}
+
+	// only this thread ever writes the head, the release makes the event visible before it
+	uint64_t head = buffer->head.load(std::memory_order_relaxed);
+
+	Event &event = buffer->events[head & (EVENTS_PER_THREAD - 1)];
+	event.name = name;
+	event.begin = begin;
+	event.end = end;
+
+	buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void cpuprofiler::setThreadName(const char *name)
+{
+	ThreadBuffer *buffer = getThreadBuffer();
+
+	if (buffer) {
+		buffer->name = name;
+	}
+}
+
+void cpuprofiler::beginFrame()
+{
+	uint64_t frame = g_frameCount.load();
+
+	g_frameStarts[frame % FRAME_HISTORY_LENGTH] = now();
+	g_frameCount.store(frame + 1);
+}
+
+uint64_t cpuprofiler::getFrameIndex()
+{
+	uint64_t frameCount = g_frameCount.load();
+
+	return frameCount > 0 ? frameCount - 1 : 0;
+}
+
+static void writeEscaped(std::ofstream &file, const char *str)
+{
+	for (const char *c = str; *c; c++)
+	{
+		if (*c == '"' || *c == '\\') {
+			file.put('\\');
+		}
+
+		file.put(*c);
+	}
+}
+
+static void writeCompleteEvent(std::ofstream &file, const char *name, int pid, uint32_t tid, double ts, double dur)
+{
+	char buffer[128];
+
+	file << ",\n{\"name\":\"";
+	writeEscaped(file, name);
+
+	snprintf(buffer, sizeof(buffer), "\",\"ph\":\"X\",\"pid\":%d,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", pid, tid, ts, dur);
+	file << buffer;
+}
+
+bool cpuprofiler::exportChromeTrace(const char *path, uint64_t firstFrame, uint64_t frameCount, const Vector<Event> &gpuEvents)
+{
+	uint64_t framesRecorded = g_frameCount.load();
+	uint64_t oldestFrame = framesRecorded > FRAME_HISTORY_LENGTH ? framesRecorded - FRAME_HISTORY_LENGTH : 0;
+
+	uint64_t first = Calc<uint64_t>::max(firstFrame, oldestFrame);
+	uint64_t last = Calc<uint64_t>::min(firstFrame + frameCount, framesRecorded);
+
+	if (first >= last)
+	{
+		LLT_LOG("No profiled frames left in [%" PRIu64 ", %" PRIu64 ").", firstFrame, firstFrame + frameCount);
+		return false;
+	}
+
+	uint64_t windowBegin = g_frameStarts[first % FRAME_HISTORY_LENGTH];
+	uint64_t windowEnd = last < framesRecorded ? g_frameStarts[last % FRAME_HISTORY_LENGTH] : now();
+
+	double microsecondsPerTick = 1000000.0 / (double)getTicksPerSecond();
+
+	auto toTraceTime = [&](uint64_t ticks) -> double {
+		return (double)(Calc<uint64_t>::max(ticks, windowBegin) - windowBegin) * microsecondsPerTick;
+	};
+
+	std::ofstream file(path, std::ios::trunc);
+
+	if (!file.is_open())
+	{
+		LLT_LOG("Failed to open trace file for writing: %s", path);
+		return false;
+	}
+
+	char buffer[256];
+
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"CPU\"}},\n";
+	file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"GPU\"}},\n";
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Graphics Queue\"}}";
+
+	for (uint64_t frame = first; frame < last; frame++)
+	{
+		snprintf(
+			buffer, sizeof(buffer),
+			",\n{\"name\":\"Frame %" PRIu64 "\",\"ph\":\"i\",\"s\":\"g\",\"pid\":0,\"tid\":0,\"ts\":%.3f}",
+			frame, toTraceTime(g_frameStarts[frame % FRAME_HISTORY_LENGTH])
+		);
+
+		file << buffer;
+	}
+
+	uint32_t threadCount = CalcU::min(g_threadCount.load(), MAX_THREADS);
+
+	Vector<Event> events;
+
+	for (uint32_t i = 0; i < threadCount; i++)
+	{
+		ThreadBuffer *thread = g_threadBuffers[i].load(std::memory_order_acquire);
+
+		if (!thread) {
+			continue;
+		}
+
+		const char *name = thread->name.load();
+
+		if (name)
+		{
+			file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << thread->id << ",\"args\":{\"name\":\"";
+			writeEscaped(file, name);
+			file << "\"}}";
+		}
+
+		uint64_t head = thread->head.load(std::memory_order_acquire);
+		uint64_t tail = head > EVENTS_PER_THREAD ? head - EVENTS_PER_THREAD : 0;
+
+		events.clear();
+
+		for (uint64_t j = tail; j < head; j++) {
+			events.pushBack(thread->events[j & (EVENTS_PER_THREAD - 1)]);
+		}
+
+		// anything the thread could have lapped while we were copying can't be trusted
+		uint64_t headAfter = thread->head.load(std::memory_order_acquire);
+		uint64_t safeTail = headAfter > EVENTS_PER_THREAD ? headAfter - EVENTS_PER_THREAD : 0;
+
+		for (uint64_t j = tail; j < head; j++)
+		{
+			const Event &event = events[j - tail];
+
+			if (j < safeTail || event.end <= windowBegin || event.begin >= windowEnd) {
+				continue;
+			}
+
+			double ts = toTraceTime(event.begin);
+			double end = toTraceTime(Calc<uint64_t>::min(event.end, windowEnd));
+
+			writeCompleteEvent(file, event.name, 0, thread->id, ts, end - ts);
+		}
+	}
+
+	for (auto &event : gpuEvents)
+	{
+		if (event.end <= windowBegin || event.begin >= windowEnd) {
+			continue;
+		}
+
+		double ts = toTraceTime(event.begin);
+		double end = toTraceTime(Calc<uint64_t>::min(event.end, windowEnd));
+
+		writeCompleteEvent(file, event.name, 1, 0, ts, end - ts);
+	}
+
+	file << "\n]}\n";
+
+	LLT_LOG("Wrote frames %" PRIu64 " to %" PRIu64 " to %s.", first, last - 1, path);
+
+	return true;
+}
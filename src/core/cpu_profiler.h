@@ -0,0 +1,93 @@
+#ifndef CPU_PROFILER_H_
+#define CPU_PROFILER_H_
+
+#include "common.h"
+
+#include "container/vector.h"
+
+#define LLT_PROFILE_CONCAT_INNER(_a, _b) _a##_b
+#define LLT_PROFILE_CONCAT(_a, _b) LLT_PROFILE_CONCAT_INNER(_a, _b)
+
+#ifdef LLT_DEBUG
+
+// times the rest of the enclosing scope. the name has to outlive the profiler, so a string literal
+#define LLT_PROFILE_SCOPE(_name) ::llt::cpuprofiler::Scope LLT_PROFILE_CONCAT(__lltProfileScope, __LINE__)(_name)
+
+#else
+
+#define LLT_PROFILE_SCOPE(_name)
+
+#endif // LLT_DEBUG
+
+namespace llt
+{
+	/*
+	 * Scope timings on the cpu, for every thread.
+	 *
+	 * Each thread gets its own ring buffer the first time it records anything, after that recording is
+	 * two clock reads and a store with no locks and no allocation. The oldest events get overwritten once
+	 * a buffer fills up. The main thread marks out frames, so a range of them can be exported as a chrome
+	 * trace (chrome://tracing or ui.perfetto.dev) along with the gpu zones of the same frames.
+	 */
+	namespace cpuprofiler
+	{
+		static constexpr uint32_t EVENTS_PER_THREAD = 1 << 15;
+		static constexpr uint32_t MAX_THREADS = 64;
+		static constexpr uint32_t FRAME_HISTORY_LENGTH = 1024;
+
+		struct Event
+		{
+			const char *name;
+			uint64_t begin;
+			uint64_t end;
+		};
+
+		/*
+		 * The same clock vkutil::HOST_TIME_DOMAIN names, so calibrated gpu timestamps land on it directly.
+		 */
+		uint64_t now();
+		uint64_t getTicksPerSecond();
+
+		void record(const char *name, uint64_t begin, uint64_t end);
+
+		/*
+		 * Shows up as the thread's name in the trace, otherwise it's just numbered.
+		 */
+		void setThreadName(const char *name);
+
+		/*
+		 * Called by the main thread at the start of every frame.
+		 */
+		void beginFrame();
+		uint64_t getFrameIndex();
+
+		/*
+		 * Writes out every event from the frames in [firstFrame, firstFrame + frameCount) that are still
+		 * in the history, the frame in progress ending now. Meant for the main thread, and while other
+		 * threads keep recording their oldest events can get overwritten mid export, which are dropped.
+		 * The gpu events go on a track of their own and have to already be on this clock.
+		 */
+		bool exportChromeTrace(const char *path, uint64_t firstFrame, uint64_t frameCount, const Vector<Event> &gpuEvents);
+
+		class Scope
+		{
+		public:
+			Scope(const char *name)
+				: m_name(name)
+				, m_begin(now())
+			{
+			}
+
+			~Scope()
+			{
+				record(m_name, m_begin, now());
+			}
+
+		private:
+			const char *m_name;
+			uint64_t m_begin;
+		};
+	}
+}
+
+#endif // CPU_PROFILER_H_
@@ -1,10 +1,25 @@
 #include "debug_ui.h"
 
+#include <algorithm>
+
+#include "profiler.h"
+#include "cpu_profiler.h"
+#include "mem_tracker.h"
+
+#include "vulkan/core.h"
+#include "vulkan/render_stats.h"
+#include "vulkan/api_stats.h"
+
 #include "rendering/material_system.h"
 #include "rendering/light.h"
+#include "rendering/texture_mgr.h"
+#include "rendering/mip_generator.h"
+#include "rendering/dynamic_resolution.h"
 
 #include "rendering/passes/post_process_pass.h"
 
+#include "math/calc.h"
+
 #include "third_party/imgui/imgui.h"
 
 using namespace llt;
@@ -13,11 +28,135 @@ static float g_exposure;
 static float g_bloomRadius;
 static float g_bloomIntensity;
 
+static Vector<MipBenchmarkResult> g_mipBenchmarkResults;
+
+// the frame time comparison regenerates the ibl maps in each format in turn and averages a few hundred frames of each
+static constexpr int IBL_WARMUP_FRAMES = 30;
+static constexpr int IBL_MEASURED_FRAMES = 300;
+
+// the newest few won't have their gpu zones yet since those frames are still in flight
+static constexpr uint64_t TRACE_EXPORT_FRAMES = 120;
+
+static constexpr int FRAME_GRAPH_LENGTH = 256;
+
+// rings of the most recent frame times, the cursor being where the next one goes
+static float g_cpuFrameTimes[FRAME_GRAPH_LENGTH];
+static float g_gpuFrameTimes[FRAME_GRAPH_LENGTH];
+static int g_cpuFrameTimeCursor;
+static int g_gpuFrameTimeCursor;
+static uint64_t g_nextGpuFrame;
+
+static int g_iblFormat;
+static int g_iblComparedFormat; // -1 when no comparison is running
+static int g_iblComparisonFrame;
+static double g_iblComparisonTime;
+static IBLFormat g_iblFormatBeforeComparison;
+static double g_iblFrameTimes[IBL_FORMAT_MAX_ENUM];
+
+static void recordFrameTimes()
+{
+	g_cpuFrameTimes[g_cpuFrameTimeCursor] = ImGui::GetIO().DeltaTime * 1000.0f;
+	g_cpuFrameTimeCursor = (g_cpuFrameTimeCursor + 1) % FRAME_GRAPH_LENGTH;
+
+	uint64_t currentFrame = cpuprofiler::getFrameIndex();
+
+	// anything the profiler's already let go of isn't worth waiting on
+	if (g_nextGpuFrame + Profiler::TRACE_FRAME_COUNT < currentFrame) {
+		g_nextGpuFrame = currentFrame - Profiler::TRACE_FRAME_COUNT;
+	}
+
+	while (g_nextGpuFrame < currentFrame)
+	{
+		double gpuMs = 0.0;
+
+		if (g_profiler->getFrameTime(g_nextGpuFrame, &gpuMs))
+		{
+			g_gpuFrameTimes[g_gpuFrameTimeCursor] = (float)gpuMs;
+			g_gpuFrameTimeCursor = (g_gpuFrameTimeCursor + 1) % FRAME_GRAPH_LENGTH;
+		}
+		else if (currentFrame - g_nextGpuFrame <= mgc::FRAMES_IN_FLIGHT + 1)
+		{
+			// still in flight, try again next frame
+			break;
+		}
+
+		g_nextGpuFrame++;
+	}
+}
+
+static void plotFrameTimes(const char *label, const float *times, int cursor)
+{
+	float sum = 0.0f;
+	float max = 0.0f;
+
+	for (int i = 0; i < FRAME_GRAPH_LENGTH; i++)
+	{
+		sum += times[i];
+		max = CalcF::max(max, times[i]);
+	}
+
+	char overlay[64];
+	snprintf(overlay, sizeof(overlay), "avg %.2f ms, max %.2f ms", sum / (float)FRAME_GRAPH_LENGTH, max);
+
+	ImGui::PlotLines(label, times, FRAME_GRAPH_LENGTH, cursor, overlay, 0.0f, CalcF::max(max * 1.2f, 1.0f), ImVec2(0.0f, 60.0f));
+}
+
+static void setIBLFormat(IBLFormat format)
+{
+	g_materialSystem->setIBLFormat(format);
+
+	// stays where it was if the format isn't supported
+	g_iblFormat = g_materialSystem->getIBLFormat();
+}
+
+static void compareIBLFormatFrom(int format)
+{
+	while (format < IBL_FORMAT_MAX_ENUM && !MaterialSystem::isIBLFormatSupported((IBLFormat)format)) {
+		format++;
+	}
+
+	if (format >= IBL_FORMAT_MAX_ENUM)
+	{
+		g_iblComparedFormat = -1;
+		setIBLFormat(g_iblFormatBeforeComparison);
+		return;
+	}
+
+	g_iblComparedFormat = format;
+	g_iblComparisonFrame = 0;
+	g_iblComparisonTime = 0.0;
+
+	setIBLFormat((IBLFormat)format);
+}
+
+static void updateIBLComparison()
+{
+	if (g_iblComparedFormat < 0) {
+		return;
+	}
+
+	g_iblComparisonFrame++;
+
+	// the first few frames after regenerating pay for the stall and any new pipelines
+	if (g_iblComparisonFrame > IBL_WARMUP_FRAMES) {
+		g_iblComparisonTime += ImGui::GetIO().DeltaTime;
+	}
+
+	if (g_iblComparisonFrame == IBL_WARMUP_FRAMES + IBL_MEASURED_FRAMES)
+	{
+		g_iblFrameTimes[g_iblComparedFormat] = 1000.0 * g_iblComparisonTime / (double)IBL_MEASURED_FRAMES;
+		compareIBLFormatFrom(g_iblComparedFormat + 1);
+	}
+}
+
 void dbgui::init()
 {
 	g_exposure = g_postProcessPass.getExposure();
 	g_bloomRadius = g_postProcessPass.getBloomRadius();
 	g_bloomIntensity = g_postProcessPass.getBloomIntensity();
+
+	g_iblFormat = g_materialSystem->getIBLFormat();
+	g_iblComparedFormat = -1;
 }
 
 void dbgui::update()
@@ -45,6 +184,188 @@ void dbgui::update()
 	ImGui::End();
 	*/
 
+	recordFrameTimes();
+
+	ImGui::Begin("Performance");
+	{
+		plotFrameTimes("CPU", g_cpuFrameTimes, g_cpuFrameTimeCursor);
+		plotFrameTimes("GPU", g_gpuFrameTimes, g_gpuFrameTimeCursor);
+
+		if (ImGui::CollapsingHeader("Counters", ImGuiTreeNodeFlags_DefaultOpen))
+		{
+			const RenderStats &stats = renderstats::getLastFrame();
+
+			if (ImGui::BeginTable("Counters", 2, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+			{
+				auto row = [&](const char *name, uint64_t value) -> void {
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn();
+					ImGui::TextUnformatted(name);
+					ImGui::TableNextColumn();
+					ImGui::Text("%" PRIu64, value);
+				};
+
+				row("Draws", stats.drawCalls);
+				row("Instances", stats.instances);
+				row("Triangles", stats.triangles);
+				row("Pipeline Binds", stats.pipelineBinds);
+				row("Descriptor Set Binds", stats.descriptorSetBinds);
+				row("Push Constant Bytes", stats.pushConstantBytes);
+				row("Barriers", stats.barriers);
+				row("Submissions", stats.submissions);
+				row("Fence Waits", stats.fenceWaits);
+				row("Upload Bytes", stats.uploadBytes);
+
+				ImGui::EndTable();
+			}
+		}
+
+		if (ImGui::CollapsingHeader("Vulkan API"))
+		{
+			if (apistats::isInstalled())
+			{
+				Vector<ApiCallStats> calls = apistats::getLastFrame();
+
+				std::sort(calls.data(), calls.data() + calls.size(), [&](const ApiCallStats &a, const ApiCallStats &b) -> bool {
+					return a.ms > b.ms;
+				});
+
+				if (ImGui::BeginTable("Vulkan API", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+				{
+					ImGui::TableSetupColumn("Function");
+					ImGui::TableSetupColumn("Calls");
+					ImGui::TableSetupColumn("CPU (ms)");
+					ImGui::TableHeadersRow();
+
+					for (auto &call : calls)
+					{
+						if (call.calls == 0) {
+							continue;
+						}
+
+						ImGui::TableNextRow();
+						ImGui::TableNextColumn();
+						ImGui::TextUnformatted(call.name);
+						ImGui::TableNextColumn();
+						ImGui::Text("%" PRIu64, call.calls);
+						ImGui::TableNextColumn();
+						ImGui::Text("%.3f", call.ms);
+					}
+
+					ImGui::EndTable();
+				}
+			}
+			else
+			{
+				ImGui::TextUnformatted("Run with --api-stats to count vulkan calls.");
+			}
+		}
+
+		if (ImGui::CollapsingHeader("GPU Zones", ImGuiTreeNodeFlags_DefaultOpen))
+		{
+			Vector<ProfilerZoneStats> zones = g_profiler->getStats();
+
+			double totalMs = 0.0;
+
+			for (auto &zone : zones)
+			{
+				if (zone.depth == 0) {
+					totalMs += zone.avgMs;
+				}
+			}
+
+			char label[128];
+
+			// each bar is the zone's share of the whole frame, so nested ones line up against their parents
+			for (auto &zone : zones)
+			{
+				float indent = zone.depth * ImGui::GetStyle().IndentSpacing;
+
+				if (zone.depth > 0) {
+					ImGui::Indent(indent);
+				}
+
+				snprintf(label, sizeof(label), "%s %.3f ms", zone.name, zone.avgMs);
+				ImGui::ProgressBar(totalMs > 0.0 ? (float)(zone.avgMs / totalMs) : 0.0f, ImVec2(-FLT_MIN, 0.0f), label);
+
+				if (zone.depth > 0) {
+					ImGui::Unindent(indent);
+				}
+			}
+		}
+
+		if (ImGui::CollapsingHeader("GPU Memory", ImGuiTreeNodeFlags_DefaultOpen))
+		{
+			VmaBudget budgets[VK_MAX_MEMORY_HEAPS] = {};
+			vmaGetHeapBudgets(g_vkCore->m_vmaAllocator, budgets);
+
+			const VkPhysicalDeviceMemoryProperties *memoryProperties = nullptr;
+			vmaGetMemoryProperties(g_vkCore->m_vmaAllocator, &memoryProperties);
+
+			char label[128];
+
+			for (int i = 0; i < memoryProperties->memoryHeapCount; i++)
+			{
+				const VmaBudget &budget = budgets[i];
+
+				if (budget.budget == 0) {
+					continue;
+				}
+
+				bool deviceLocal = memoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+
+				ImGui::Text(
+					"Heap %d (%s): %u allocations in %u blocks",
+					i, deviceLocal ? "device" : "host",
+					budget.statistics.allocationCount, budget.statistics.blockCount
+				);
+
+				snprintf(
+					label, sizeof(label), "%.1f / %.1f MB",
+					(float)budget.usage / (1024.0f * 1024.0f),
+					(float)budget.budget / (1024.0f * 1024.0f)
+				);
+
+				ImGui::ProgressBar((float)((double)budget.usage / (double)budget.budget), ImVec2(-FLT_MIN, 0.0f), label);
+			}
+		}
+
+		if (ImGui::CollapsingHeader("CPU Memory", ImGuiTreeNodeFlags_DefaultOpen))
+		{
+			ImGui::Text("Tracked: %.2f MB", (double)memtrack::getTotalLiveBytes() / (1024.0 * 1024.0));
+
+			if (ImGui::BeginTable("CPU Memory", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+			{
+				ImGui::TableSetupColumn("Tag");
+				ImGui::TableSetupColumn("Live (KB)");
+				ImGui::TableSetupColumn("Peak (KB)");
+				ImGui::TableSetupColumn("Allocations");
+				ImGui::TableSetupColumn("Per Frame");
+				ImGui::TableHeadersRow();
+
+				for (int i = 0; i < MEM_TAG_MAX_ENUM; i++)
+				{
+					MemTagStats stats = memtrack::getStats((MemTag)i);
+
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn();
+					ImGui::TextUnformatted(memtrack::getTagName((MemTag)i));
+					ImGui::TableNextColumn();
+					ImGui::Text("%.1f", (double)stats.liveBytes / 1024.0);
+					ImGui::TableNextColumn();
+					ImGui::Text("%.1f", (double)stats.peakBytes / 1024.0);
+					ImGui::TableNextColumn();
+					ImGui::Text("%" PRIu64, stats.liveAllocations);
+					ImGui::TableNextColumn();
+					ImGui::Text("%" PRIu64, stats.frameAllocations);
+				}
+
+				ImGui::EndTable();
+			}
+		}
+	}
+	ImGui::End();
+
 	ImGui::Begin("Post Processing");
 	{
 		if (ImGui::SliderFloat("HDR Exposure", &g_exposure, 0.0f, 5.0f))
@@ -61,6 +382,254 @@ void dbgui::update()
 		{
 			g_postProcessPass.setBloomIntensity(g_bloomIntensity);
 		}
+
+		if (ImGui::CollapsingHeader("Dynamic Resolution"))
+		{
+			bool enabled = g_dynamicResolution.isEnabled();
+			float targetMs = g_dynamicResolution.getTargetMs();
+			float minScale = g_dynamicResolution.getMinScale();
+
+			if (ImGui::Checkbox("Enabled", &enabled))
+			{
+				// something to aim for if it wasn't given one on the command line
+				if (enabled && targetMs <= 0.0f) {
+					g_dynamicResolution.setTargetMs(8.0f);
+				}
+
+				g_dynamicResolution.setEnabled(enabled);
+			}
+
+			if (ImGui::SliderFloat("Forward Budget (ms)", &targetMs, 0.5f, 33.0f))
+			{
+				g_dynamicResolution.setTargetMs(targetMs);
+			}
+
+			if (ImGui::SliderFloat("Min Scale", &minScale, 0.25f, 1.0f))
+			{
+				g_dynamicResolution.setMinScale(minScale);
+			}
+
+			uint32_t width = g_vkCore->getBackbuffer()->getWidth();
+			uint32_t height = g_vkCore->getBackbuffer()->getHeight();
+
+			ImGui::Text(
+				"Scale: %.0f%% (%ux%u of %ux%u)",
+				g_dynamicResolution.getScale() * 100.0f,
+				g_dynamicResolution.scaleSize(width), g_dynamicResolution.scaleSize(height),
+				width, height
+			);
+
+			ImGui::Text("Forward (smoothed): %.3f ms", g_dynamicResolution.getSmoothedMs());
+		}
+	}
+	ImGui::End();
+
+	ImGui::Begin("Textures");
+	{
+		TextureMemoryStats stats = g_textureManager->getMemoryStats();
+		TextureStreamer &streamer = g_textureManager->getStreamer();
+
+		float residentMB = (float)stats.residentBytes / (1024.0f * 1024.0f);
+		float uncompressedMB = (float)stats.uncompressedBytes / (1024.0f * 1024.0f);
+
+		ImGui::Text("Block Compression: %s", g_textureManager->isBlockCompressionSupported() ? "Supported" : "Unsupported");
+		ImGui::Text("Loaded: %u (%u compressed)", stats.textureCount, stats.compressedCount);
+		ImGui::Text("Resident: %.2f MB", residentMB);
+		ImGui::Text("Uncompressed: %.2f MB", uncompressedMB);
+
+		if (stats.uncompressedBytes > 0) {
+			ImGui::Text("Saved: %.2f MB (%.1f%%)", uncompressedMB - residentMB, 100.0f * (1.0f - residentMB / uncompressedMB));
+		}
+
+		ImGui::Separator();
+
+		ImGui::Text("Streamed: %u (%u changes pending)", stats.streamedCount, streamer.getPendingCount());
+		ImGui::Text("Streamed Resident: %.2f / %.2f MB", (float)streamer.getResidentBytes() / (1024.0f * 1024.0f), (float)streamer.getBudget() / (1024.0f * 1024.0f));
+
+		int budgetMB = (int)(streamer.getBudget() / LLT_MEGABYTES(1));
+
+		if (ImGui::SliderInt("Streaming Budget (MB)", &budgetMB, 16, 4096))
+		{
+			streamer.setBudget((uint64_t)budgetMB * LLT_MEGABYTES(1));
+		}
+
+		ImGui::Separator();
+
+		if (ImGui::Button("Benchmark Mip Generation"))
+		{
+			g_mipBenchmarkResults = g_mipGenerator->benchmark();
+		}
+
+		for (auto &result : g_mipBenchmarkResults)
+		{
+			if (result.computeMs >= 0.0) {
+				ImGui::Text("%s: compute %.3fms, blit %.3fms", result.name.cstr(), result.computeMs, result.blitMs);
+			} else {
+				ImGui::Text("%s: compute unsupported, blit %.3fms", result.name.cstr(), result.blitMs);
+			}
+		}
+	}
+	ImGui::End();
+
+	ImGui::Begin("Image Based Lighting");
+	{
+		updateIBLComparison();
+
+		const char *formatNames[IBL_FORMAT_MAX_ENUM] = {};
+
+		for (int i = 0; i < IBL_FORMAT_MAX_ENUM; i++) {
+			formatNames[i] = MaterialSystem::getIBLFormatName((IBLFormat)i);
+		}
+
+		bool comparing = g_iblComparedFormat >= 0;
+
+		ImGui::BeginDisabled(comparing);
+		{
+			if (ImGui::Combo("Format", &g_iblFormat, formatNames, IBL_FORMAT_MAX_ENUM))
+			{
+				setIBLFormat((IBLFormat)g_iblFormat);
+			}
+		}
+		ImGui::EndDisabled();
+
+		ImGui::Text("Resident: %.2f MB", (float)g_materialSystem->getIBLMemorySize() / (1024.0f * 1024.0f));
+
+		if (ImGui::BeginTable("IBL Formats", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+		{
+			ImGui::TableSetupColumn("Format");
+			ImGui::TableSetupColumn("Memory");
+			ImGui::TableSetupColumn("Frame Time");
+			ImGui::TableHeadersRow();
+
+			for (int i = 0; i < IBL_FORMAT_MAX_ENUM; i++)
+			{
+				IBLFormat format = (IBLFormat)i;
+
+				ImGui::TableNextRow();
+
+				ImGui::TableNextColumn();
+				ImGui::Text("%s%s", formatNames[i], format == g_materialSystem->getIBLFormat() ? " (current)" : "");
+
+				ImGui::TableNextColumn();
+				ImGui::Text("%.2f MB", (float)MaterialSystem::calcIBLMemorySize(format) / (1024.0f * 1024.0f));
+
+				ImGui::TableNextColumn();
+
+				if (!MaterialSystem::isIBLFormatSupported(format)) {
+					ImGui::TextUnformatted("Unsupported");
+				} else if (g_iblFrameTimes[i] > 0.0) {
+					ImGui::Text("%.3f ms", g_iblFrameTimes[i]);
+				} else {
+					ImGui::TextUnformatted("-");
+				}
+			}
+
+			ImGui::EndTable();
+		}
+
+		if (comparing)
+		{
+			ImGui::Text("Measuring %s... (%d / %d frames)", formatNames[g_iblComparedFormat], g_iblComparisonFrame, IBL_WARMUP_FRAMES + IBL_MEASURED_FRAMES);
+		}
+		else if (ImGui::Button("Compare Frame Times"))
+		{
+			g_iblFormatBeforeComparison = g_materialSystem->getIBLFormat();
+			compareIBLFormatFrom(0);
+		}
+	}
+	ImGui::End();
+
+	ImGui::Begin("GPU Profiler");
+	{
+		Vector<ProfilerZoneStats> zones = g_profiler->getStats();
+
+		bool statistics = g_profiler->isPipelineStatisticsSupported();
+		int columnCount = statistics ? 7 : 5;
+
+		ImGui::Text("Over the last %u frames.", Profiler::HISTORY_LENGTH);
+
+		if (ImGui::Button("Export Trace"))
+		{
+			uint64_t lastFrame = cpuprofiler::getFrameIndex();
+			uint64_t firstFrame = lastFrame >= TRACE_EXPORT_FRAMES ? lastFrame - TRACE_EXPORT_FRAMES + 1 : 0;
+
+			Vector<cpuprofiler::Event> gpuZones;
+			g_profiler->getTraceZones(firstFrame, lastFrame + 1, gpuZones);
+
+			cpuprofiler::exportChromeTrace("trace.json", firstFrame, lastFrame - firstFrame + 1, gpuZones);
+		}
+
+		ImGui::SameLine();
+		ImGui::Text("Writes the last %" PRIu64 " frames to trace.json.", TRACE_EXPORT_FRAMES);
+
+		if (ImGui::BeginTable("Zones", columnCount, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+		{
+			ImGui::TableSetupColumn("Zone");
+			ImGui::TableSetupColumn("Min");
+			ImGui::TableSetupColumn("Avg");
+			ImGui::TableSetupColumn("Max");
+			ImGui::TableSetupColumn("P99");
+
+			if (statistics)
+			{
+				ImGui::TableSetupColumn("Vertices");
+				ImGui::TableSetupColumn("Fragments");
+			}
+
+			ImGui::TableHeadersRow();
+
+			for (auto &zone : zones)
+			{
+				ImGui::TableNextRow();
+
+				ImGui::TableNextColumn();
+				// nested zones are indented under their parent, it's never given 0 since that indents by the default spacing
+				float indent = zone.depth * ImGui::GetStyle().IndentSpacing;
+
+				if (zone.depth > 0) {
+					ImGui::Indent(indent);
+				}
+
+				ImGui::TextUnformatted(zone.name);
+
+				if (zone.depth > 0) {
+					ImGui::Unindent(indent);
+				}
+
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f ms", zone.minMs);
+
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f ms", zone.avgMs);
+
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f ms", zone.maxMs);
+
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f ms", zone.p99Ms);
+
+				if (statistics)
+				{
+					ImGui::TableNextColumn();
+
+					if (zone.hasPipelineStatistics) {
+						ImGui::Text("%llu", (unsigned long long)zone.vertexInvocations);
+					} else {
+						ImGui::TextUnformatted("-");
+					}
+
+					ImGui::TableNextColumn();
+
+					if (zone.hasPipelineStatistics) {
+						ImGui::Text("%llu", (unsigned long long)zone.fragmentInvocations);
+					} else {
+						ImGui::TextUnformatted("-");
+					}
+				}
+			}
+
+			ImGui::EndTable();
+		}
 	}
 	ImGui::End();
 
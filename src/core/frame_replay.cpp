@@ -0,0 +1,195 @@
+#include "frame_replay.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+#include "cpu_profiler.h"
+
+#include "container/vector.h"
+#include "container/string.h"
+
+#include "vulkan/core.h"
+#include "vulkan/util.h"
+#include "vulkan/command_buffer.h"
+#include "vulkan/frame_capture.h"
+
+using namespace llt;
+
+struct ReplayPercentiles
+{
+	double min;
+	double avg;
+	double p50;
+	double p90;
+	double p95;
+	double p99;
+	double max;
+	uint32_t count;
+};
+
+static ReplayPercentiles calcPercentiles(Vector<double> &times)
+{
+	ReplayPercentiles percentiles = {};
+	percentiles.count = times.size();
+
+	if (times.size() == 0) {
+		return percentiles;
+	}
+
+	std::sort(times.data(), times.data() + times.size());
+
+	// nearest rank, the same as the benchmark report so the two can be read side by side
+	auto percentile = [&](double p) -> double {
+		uint64_t rank = (uint64_t)std::ceil(p * (double)times.size());
+		return times[(rank > 1 ? rank : 1) - 1];
+	};
+
+	double sum = 0.0;
+
+	for (double time : times) {
+		sum += time;
+	}
+
+	percentiles.min = times[0];
+	percentiles.avg = sum / (double)times.size();
+	percentiles.p50 = percentile(0.50);
+	percentiles.p90 = percentile(0.90);
+	percentiles.p95 = percentile(0.95);
+	percentiles.p99 = percentile(0.99);
+	percentiles.max = times[times.size() - 1];
+
+	return percentiles;
+}
+
+static void writePercentiles(std::ofstream &file, const char *name, const ReplayPercentiles &p)
+{
+	char buffer[512];
+
+	snprintf(
+		buffer, sizeof(buffer),
+		"\t\"%s\": { \"count\": %u, \"min\": %.4f, \"avg\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f }",
+		name, p.count, p.min, p.avg, p.p50, p.p90, p.p95, p.p99, p.max
+	);
+
+	file << buffer;
+}
+
+bool framereplay::run(const char *capturePath, unsigned iterations, const char *outputPath)
+{
+	if (!g_vkCore->isHeadless())
+	{
+		LLT_LOG("Frame replay needs --headless, skipping it.");
+		return false;
+	}
+
+	FrameCapture capture;
+
+	if (!capture.load(capturePath)) {
+		return false;
+	}
+
+	// nothing from the frame that was captured can still be in flight
+	g_vkCore->syncStall();
+
+	VkQueryPoolCreateInfo queryPoolInfo = {};
+	queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	queryPoolInfo.queryCount = 2;
+
+	VkQueryPool queryPool = VK_NULL_HANDLE;
+
+	LLT_VK_CHECK(
+		vkCreateQueryPool(g_vkCore->m_device, &queryPoolInfo, nullptr, &queryPool),
+		"Failed to create frame replay query pool."
+	);
+
+	double msPerTick = 1000.0 / (double)cpuprofiler::getTicksPerSecond();
+	double msPerDeviceTick = (double)g_vkCore->m_physicalData.properties.properties.limits.timestampPeriod / 1000000.0;
+
+	Vector<double> cpuTimes;
+	Vector<double> gpuTimes;
+
+	cpuTimes.allocate(iterations);
+	gpuTimes.allocate(iterations);
+
+	LLT_LOG("Replaying %s (%" PRIu64 " commands) %u times...", capturePath, capture.getCommandCount(), iterations);
+
+	for (unsigned i = 0; i < WARMUP_ITERATIONS + iterations; i++)
+	{
+		CommandBuffer cmd = vkutil::beginSingleTimeCommands(g_vkCore->getGraphicsCommandPool());
+
+		cmd.resetQueryPool(queryPool, 0, 2);
+		cmd.writeTimestamp(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, 0);
+
+		uint64_t recordStart = cpuprofiler::now();
+		capture.replay(cmd);
+		uint64_t recordEnd = cpuprofiler::now();
+
+		cmd.writeTimestamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, 1);
+
+		vkutil::endSingleTimeCommands(g_vkCore->getGraphicsCommandPool(), cmd, g_vkCore->m_graphicsQueue.getQueue());
+
+		uint64_t timestamps[2] = {};
+
+		vkGetQueryPoolResults(
+			g_vkCore->m_device,
+			queryPool,
+			0, 2,
+			sizeof(timestamps), timestamps,
+			sizeof(uint64_t),
+			VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT
+		);
+
+		if (i < WARMUP_ITERATIONS) {
+			continue;
+		}
+
+		cpuTimes.pushBack((double)(recordEnd - recordStart) * msPerTick);
+		gpuTimes.pushBack((double)(timestamps[1] - timestamps[0]) * msPerDeviceTick);
+	}
+
+	vkDestroyQueryPool(g_vkCore->m_device, queryPool, nullptr);
+
+	ReplayPercentiles cpu = calcPercentiles(cpuTimes);
+	ReplayPercentiles gpu = calcPercentiles(gpuTimes);
+
+	LLT_LOG("Replay record avg: %.4fms (p99 %.4fms), gpu avg: %.4fms (p99 %.4fms)", cpu.avg, cpu.p99, gpu.avg, gpu.p99);
+
+	String jsonPath = String(outputPath) + ".json";
+	std::ofstream json(jsonPath.cstr(), std::ios::trunc);
+
+	if (!json.is_open())
+	{
+		LLT_LOG("Failed to open replay report for writing: %s", jsonPath.cstr());
+		return false;
+	}
+
+	char buffer[512];
+
+	snprintf(
+		buffer, sizeof(buffer),
+		"{\n"
+		"\t\"capture\": \"%s\",\n"
+		"\t\"commandCount\": %" PRIu64 ",\n"
+		"\t\"captureBytes\": %" PRIu64 ",\n"
+		"\t\"warmupIterations\": %u,\n"
+		"\t\"measuredIterations\": %u,\n",
+		capturePath,
+		capture.getCommandCount(),
+		capture.getSize(),
+		WARMUP_ITERATIONS,
+		iterations
+	);
+
+	json << buffer;
+
+	writePercentiles(json, "cpuRecordMs", cpu);
+	json << ",\n";
+	writePercentiles(json, "gpuMs", gpu);
+	json << "\n}\n";
+
+	LLT_LOG("Wrote replay report to %s", jsonPath.cstr());
+
+	return true;
+}
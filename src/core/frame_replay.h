@@ -0,0 +1,29 @@
+#ifndef FRAME_REPLAY_H_
+#define FRAME_REPLAY_H_
+
+#include "common.h"
+
+namespace llt
+{
+	/**
+	 * Re-issues a captured frame (vulkan/frame_capture.h) over and over on its own, outside of the renderer,
+	 * so changes to how the frame's recorded or what the gpu does with it can be measured without the rest
+	 * of the app (scene updates, culling, streaming) moving the numbers around.
+	 *
+	 * Every iteration records the whole capture into one command buffer, submits it and waits, timing the
+	 * recording on the cpu and the submission with a pair of timestamps. The capture only names handles,
+	 * so it has to be replayed in the same run that captured it, which is why this lives in the app rather
+	 * than as a tool of its own. Headless only, the swapchain's images don't stay put between frames.
+	 *
+	 * The report goes to <output>.json, with the same percentiles as the benchmark.
+	 */
+	namespace framereplay
+	{
+		// thrown away before measuring starts, the first few submissions pay for the driver settling in
+		static constexpr unsigned WARMUP_ITERATIONS = 8;
+
+		bool run(const char *capturePath, unsigned iterations, const char *outputPath);
+	}
+}
+
+#endif // FRAME_REPLAY_H_
@@ -0,0 +1,355 @@
+#include "mem_tracker.h"
+
+#include <atomic>
+#include <new>
+
+#ifdef LLT_DEBUG
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+
+#if _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <dbghelp.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "dbghelp.lib")
+#endif // _MSC_VER
+#else
+#include <execinfo.h>
+#include <stdlib.h>
+#endif // _WIN32
+
+#endif // LLT_DEBUG
+
+using namespace llt;
+
+struct TagCounters
+{
+	std::atomic<uint64_t> liveBytes;
+	std::atomic<uint64_t> peakBytes;
+	std::atomic<uint64_t> liveAllocations;
+
+	std::atomic<uint64_t> totalAllocations;
+	std::atomic<uint64_t> totalBytes;
+
+	// what total* were when the last frame ended, and what the frame before that added
+	uint64_t frameStartAllocations;
+	uint64_t frameStartBytes;
+	uint64_t frameAllocations;
+	uint64_t frameBytes;
+};
+
+static TagCounters g_tagCounters[MEM_TAG_MAX_ENUM];
+
+static const char *g_tagNames[] = {
+	"General",
+	"Containers",
+	"Strings",
+	"Rendering",
+	"Assets",
+	"IO"
+};
+
+static_assert(LLT_ARRAY_LENGTH(g_tagNames) == MEM_TAG_MAX_ENUM, "Every tag needs a name.");
+
+#ifdef LLT_DEBUG
+
+struct AllocationRecord
+{
+	uint64_t size;
+	MemTag tag;
+	int depth;
+	void *stack[memtrack::MAX_CALLSTACK_DEPTH];
+};
+
+static std::atomic<bool> g_captureCallstacks(false);
+static std::mutex g_recordMutex;
+
+// never freed, allocations can still be made and freed by static destructors after the report
+static std::unordered_map<void *, AllocationRecord> *g_records = nullptr;
+
+// so the allocations the record map makes for itself (through plain new) can't end up back in here
+static thread_local bool t_recording = false;
+
+static void captureAllocation(void *ptr, uint64_t size, MemTag tag)
+{
+	if (t_recording) {
+		return;
+	}
+
+	t_recording = true;
+
+	AllocationRecord record;
+	record.size = size;
+	record.tag = tag;
+
+#if _WIN32
+	record.depth = CaptureStackBackTrace(2, memtrack::MAX_CALLSTACK_DEPTH, record.stack, nullptr);
+#else
+	record.depth = backtrace(record.stack, memtrack::MAX_CALLSTACK_DEPTH);
+#endif // _WIN32
+
+	{
+		std::lock_guard<std::mutex> lock(g_recordMutex);
+		(*g_records)[ptr] = record;
+	}
+
+	t_recording = false;
+}
+
+static void releaseAllocation(void *ptr)
+{
+	if (t_recording) {
+		return;
+	}
+
+	t_recording = true;
+
+	{
+		std::lock_guard<std::mutex> lock(g_recordMutex);
+		g_records->erase(ptr);
+	}
+
+	t_recording = false;
+}
+
+static void logCallstack(void *const *stack, int depth)
+{
+#if _WIN32
+	HANDLE process = GetCurrentProcess();
+
+	static bool initialized = false;
+
+	if (!initialized)
+	{
+		SymInitialize(process, nullptr, TRUE);
+		initialized = true;
+	}
+
+	char buffer[sizeof(SYMBOL_INFO) + 256];
+	SYMBOL_INFO *symbol = (SYMBOL_INFO *)buffer;
+
+	for (int i = 0; i < depth; i++)
+	{
+		mem::set(buffer, 0, sizeof(buffer));
+		symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+		symbol->MaxNameLen = 255;
+
+		if (SymFromAddr(process, (DWORD64)stack[i], nullptr, symbol)) {
+			LLT_LOG("        %s", symbol->Name);
+		} else {
+			LLT_LOG("        %p", stack[i]);
+		}
+	}
+#else
+	char **symbols = backtrace_symbols(stack, depth);
+
+	// the first two frames are always captureAllocation() and mem::alloc()
+	for (int i = 2; i < depth; i++)
+	{
+		if (symbols) {
+			LLT_LOG("        %s", symbols[i]);
+		} else {
+			LLT_LOG("        %p", stack[i]);
+		}
+	}
+
+	::free(symbols);
+#endif // _WIN32
+}
+
+#endif // LLT_DEBUG
+
+void *mem::alloc(uint64_t size, MemTag tag)
+{
+	void *ptr = ::operator new (size);
+
+	TagCounters &counters = g_tagCounters[tag];
+
+	uint64_t live = counters.liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+	uint64_t peak = counters.peakBytes.load(std::memory_order_relaxed);
+
+	while (live > peak && !counters.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+	}
+
+	counters.liveAllocations.fetch_add(1, std::memory_order_relaxed);
+	counters.totalAllocations.fetch_add(1, std::memory_order_relaxed);
+	counters.totalBytes.fetch_add(size, std::memory_order_relaxed);
+
+#ifdef LLT_DEBUG
+	if (g_captureCallstacks.load(std::memory_order_relaxed)) {
+		captureAllocation(ptr, size, tag);
+	}
+#endif // LLT_DEBUG
+
+	return ptr;
+}
+
+void mem::free(void *ptr, uint64_t size, MemTag tag)
+{
+	if (!ptr) {
+		return;
+	}
+
+	TagCounters &counters = g_tagCounters[tag];
+
+	counters.liveBytes.fetch_sub(size, std::memory_order_relaxed);
+	counters.liveAllocations.fetch_sub(1, std::memory_order_relaxed);
+
+#ifdef LLT_DEBUG
+	if (g_records) {
+		releaseAllocation(ptr);
+	}
+#endif // LLT_DEBUG
+
+	::operator delete (ptr, size);
+}
+
+const char *memtrack::getTagName(MemTag tag)
+{
+	if (tag >= MEM_TAG_MAX_ENUM) {
+		return "Unknown";
+	}
+
+	return g_tagNames[tag];
+}
+
+void memtrack::endFrame()
+{
+	for (int i = 0; i < MEM_TAG_MAX_ENUM; i++)
+	{
+		TagCounters &counters = g_tagCounters[i];
+
+		uint64_t allocations = counters.totalAllocations.load(std::memory_order_relaxed);
+		uint64_t bytes = counters.totalBytes.load(std::memory_order_relaxed);
+
+		counters.frameAllocations = allocations - counters.frameStartAllocations;
+		counters.frameBytes = bytes - counters.frameStartBytes;
+
+		counters.frameStartAllocations = allocations;
+		counters.frameStartBytes = bytes;
+	}
+}
+
+MemTagStats memtrack::getStats(MemTag tag)
+{
+	const TagCounters &counters = g_tagCounters[tag];
+
+	MemTagStats stats = {};
+	stats.liveBytes = counters.liveBytes.load(std::memory_order_relaxed);
+	stats.peakBytes = counters.peakBytes.load(std::memory_order_relaxed);
+	stats.liveAllocations = counters.liveAllocations.load(std::memory_order_relaxed);
+	stats.totalAllocations = counters.totalAllocations.load(std::memory_order_relaxed);
+	stats.totalBytes = counters.totalBytes.load(std::memory_order_relaxed);
+	stats.frameAllocations = counters.frameAllocations;
+	stats.frameBytes = counters.frameBytes;
+
+	return stats;
+}
+
+uint64_t memtrack::getTotalLiveBytes()
+{
+	uint64_t total = 0;
+
+	for (int i = 0; i < MEM_TAG_MAX_ENUM; i++) {
+		total += g_tagCounters[i].liveBytes.load(std::memory_order_relaxed);
+	}
+
+	return total;
+}
+
+#ifdef LLT_DEBUG
+
+void memtrack::setCallstackCapture(bool enabled)
+{
+	if (enabled && !g_records)
+	{
+		std::lock_guard<std::mutex> lock(g_recordMutex);
+		g_records = new std::unordered_map<void *, AllocationRecord>();
+	}
+
+	g_captureCallstacks.store(enabled, std::memory_order_relaxed);
+}
+
+bool memtrack::isCallstackCaptureEnabled()
+{
+	return g_captureCallstacks.load(std::memory_order_relaxed);
+}
+
+void memtrack::reportLeaks()
+{
+	if (!g_records)
+	{
+		LLT_LOG("Call stacks weren't being captured, no leaks to report.");
+		return;
+	}
+
+	struct LeakGroup
+	{
+		const AllocationRecord *record;
+		uint64_t bytes;
+		uint64_t count;
+	};
+
+	std::lock_guard<std::mutex> lock(g_recordMutex);
+
+	t_recording = true;
+
+	// allocations made from the same place are almost always the same leak, so group them by call stack
+	std::vector<LeakGroup> groups;
+	std::unordered_map<uint64_t, uint64_t> groupIndices;
+
+	uint64_t totalBytes = 0;
+
+	for (auto &[ptr, record] : *g_records)
+	{
+		uint64_t key = hash::calcBytes(record.tag, record.stack, sizeof(void *) * record.depth);
+
+		auto it = groupIndices.find(key);
+
+		if (it == groupIndices.end())
+		{
+			groupIndices[key] = groups.size();
+			groups.push_back({ &record, record.size, 1 });
+		}
+		else
+		{
+			groups[it->second].bytes += record.size;
+			groups[it->second].count++;
+		}
+
+		totalBytes += record.size;
+	}
+
+	if (groups.empty())
+	{
+		LLT_LOG("No leaks.");
+		t_recording = false;
+		return;
+	}
+
+	std::sort(groups.data(), groups.data() + groups.size(), [&](const LeakGroup &a, const LeakGroup &b) -> bool {
+		return a.bytes > b.bytes;
+	});
+
+	LLT_LOG("%zu allocation(s) (%" PRIu64 " bytes) still alive from %zu place(s):", g_records->size(), totalBytes, groups.size());
+
+	for (uint64_t i = 0; i < groups.size() && i < MAX_LEAKS_REPORTED; i++)
+	{
+		const LeakGroup &group = groups[i];
+
+		LLT_LOG("    %" PRIu64 " bytes in %" PRIu64 " allocation(s) [%s]", group.bytes, group.count, getTagName(group.record->tag));
+		logCallstack(group.record->stack, group.record->depth);
+	}
+
+	if (groups.size() > MAX_LEAKS_REPORTED) {
+		LLT_LOG("    ... and %zu more", groups.size() - MAX_LEAKS_REPORTED);
+	}
+
+	t_recording = false;
+}
+
+#endif // LLT_DEBUG
@@ -0,0 +1,97 @@
+#ifndef MEM_TRACKER_H_
+#define MEM_TRACKER_H_
+
+#include <new>
+
+#include "common.h"
+
+namespace llt
+{
+	/*
+	 * How much one tag has on the heap. The per frame numbers are from the last frame to finish.
+	 */
+	struct MemTagStats
+	{
+		uint64_t liveBytes;
+		uint64_t peakBytes;
+		uint64_t liveAllocations;
+
+		uint64_t totalAllocations;
+		uint64_t totalBytes;
+
+		uint64_t frameAllocations;
+		uint64_t frameBytes;
+	};
+
+	/*
+	 * Counts every allocation made through mem::alloc() by the tag it was made under.
+	 *
+	 * The containers, strings and the asset / gpu resource classes all allocate through it, so the
+	 * numbers cover most of what the engine itself keeps around, but not third party libraries or anything
+	 * still using plain new. Counting is a few relaxed atomics per allocation and always on.
+	 *
+	 * In debug builds it can also remember the call stack of every live allocation, so whatever's still
+	 * around at shutdown can be reported grouped by where it came from. That's a lock and a stack walk
+	 * per allocation, so it's off unless asked for (--track-leaks).
+	 */
+	namespace memtrack
+	{
+		static constexpr int MAX_CALLSTACK_DEPTH = 24;
+		static constexpr int MAX_LEAKS_REPORTED = 16;
+
+		const char *getTagName(MemTag tag);
+
+		/*
+		 * Called by the main thread once a frame, closes off the per frame numbers.
+		 */
+		void endFrame();
+
+		MemTagStats getStats(MemTag tag);
+		uint64_t getTotalLiveBytes();
+
+#ifdef LLT_DEBUG
+
+		/*
+		 * Only allocations made after this is turned on are remembered.
+		 */
+		void setCallstackCapture(bool enabled);
+		bool isCallstackCaptureEnabled();
+
+		/*
+		 * Logs every allocation still alive that had its call stack captured, biggest first.
+		 */
+		void reportLeaks();
+
+#endif // LLT_DEBUG
+	}
+
+	/**
+	 * Inherit from this to have everything allocated with new counted under the tag.
+	 */
+	template <MemTag Tag>
+	class MemTagged
+	{
+	public:
+		static void *operator new (size_t size)
+		{
+			return mem::alloc(size, Tag);
+		}
+
+		static void operator delete (void *ptr, size_t size)
+		{
+			mem::free(ptr, size, Tag);
+		}
+
+		// the class specific new hides the global placement one, which the containers construct with
+		static void *operator new (size_t size, void *ptr) noexcept
+		{
+			return ptr;
+		}
+
+		static void operator delete (void *ptr, void *place) noexcept
+		{
+		}
+	};
+}
+
+#endif // MEM_TRACKER_H_
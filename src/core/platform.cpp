@@ -26,6 +26,13 @@ Platform::Platform(const Config &config)
 		SDL_INIT_SENSOR |
 		SDL_INIT_CAMERA;
 
+	bool headless = config.hasFlag(Config::FLAG_HEADLESS_BIT);
+
+	// there might not be a display (or audio device) to initialize at all when headless
+	if (headless) {
+		initFlags = SDL_INIT_EVENTS;
+	}
+
 	// i have no idea why this is the case but whatever
 #ifdef _WIN32
 	bool failedInit = SDL_Init(initFlags) == 0;
@@ -36,6 +43,12 @@ Platform::Platform(const Config &config)
 	if (failedInit)
 		LLT_ERROR("Failed to initialize: %s", SDL_GetError());
 
+	if (headless)
+	{
+		LLT_LOG("SDL Initialized! (headless)");
+		return;
+	}
+
 	uint64_t flags = SDL_WINDOW_HIGH_PIXEL_DENSITY;
 
 	if (config.hasFlag(Config::FLAG_RESIZABLE_BIT)) {
@@ -61,7 +74,9 @@ Platform::~Platform()
 {
 	closeAllGamepads();
 
-	SDL_DestroyWindow(m_window);
+	if (m_window) {
+		SDL_DestroyWindow(m_window);
+	}
 	SDL_Quit();
 
 	LLT_LOG("SDL Destroyed!");
@@ -74,7 +89,9 @@ void Platform::pollEvents()
 
 	while (SDL_PollEvent(&ev))
 	{
-		ImGui_ImplSDL3_ProcessEvent(&ev);
+		if (m_window) {
+			ImGui_ImplSDL3_ProcessEvent(&ev);
+		}
 
 		switch (ev.type)
 		{
@@ -216,6 +233,11 @@ void Platform::closeGamepad(int player) const
 	SDL_CloseGamepad(SDL_GetGamepadFromPlayerIndex(player));
 }
 
+bool Platform::hasWindow() const
+{
+	return m_window != nullptr;
+}
+
 String Platform::getWindowName() const
 {
 	return SDL_GetWindowTitle(m_window);
@@ -23,6 +23,11 @@ namespace llt
 
 		void pollEvents();
 
+		/*
+		 * False when running headless, in which case none of the window functions should be used.
+		 */
+		bool hasWindow() const;
+
 		void imGuiNewFrame();
 
 		String getWindowName() const;
@@ -1,6 +1,11 @@
 #include "profiler.h"
 
+#include <algorithm>
+
+#include "math/calc.h"
+
 #include "vulkan/core.h"
+#include "vulkan/util.h"
 
 // cheers to the vulkan engine guide for helping me with this
 
@@ -8,121 +13,487 @@ llt::Profiler *llt::g_profiler = nullptr;
 
 using namespace llt;
 
-Profiler::Profiler(int perFramePoolSizes)
-	: m_period(0.0f)
+static constexpr uint32_t NO_QUERY = 0xFFFFFFFF;
+
+// in the order vulkan writes them out, lowest bit first
+static constexpr VkQueryPipelineStatisticFlags PIPELINE_STATISTICS =
+	VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+	VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+static constexpr int PIPELINE_STATISTIC_COUNT = 2;
+
+Profiler::Profiler()
+	: m_period(0.0)
+	, m_timestampMask(~0ull)
+	, m_hostTicksPerDeviceTick(0.0)
+	, m_statisticsSupported(false)
+	, m_inFrame(false)
 	, m_queryFrames()
-	, m_timings()
+	, m_openZones()
+	, m_openStatisticsZone(-1)
+	, m_history()
+	, m_historyOrder()
+	, m_traceFrames(TRACE_FRAME_COUNT)
 {
 	m_period = g_vkCore->m_physicalData.properties.properties.limits.timestampPeriod;
+	m_hostTicksPerDeviceTick = (m_period * (double)cpuprofiler::getTicksPerSecond()) / 1000000000.0;
+	m_statisticsSupported = g_vkCore->m_physicalData.features.features.pipelineStatisticsQuery;
 
-	VkQueryPoolCreateInfo queryPoolInfo = {};
-	queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
-	queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
-	queryPoolInfo.queryCount = perFramePoolSizes;
+	uint32_t queueFamilyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(g_vkCore->m_physicalData.device, &queueFamilyCount, nullptr);
+
+	Vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(g_vkCore->m_physicalData.device, &queueFamilyCount, queueFamilies.data());
+
+	// timestamps only count up in the low bits, the rest is garbage
+	uint32_t validBits = queueFamilies[g_vkCore->m_graphicsQueue.getFamilyIdx().value()].timestampValidBits;
+
+	if (validBits > 0 && validBits < 64) {
+		m_timestampMask = (1ull << validBits) - 1;
+	}
+
+	LLT_ASSERT(validBits > 0, "Graphics queue doesn't support timestamps.");
 
 	for (auto &frame : m_queryFrames)
 	{
-		vkCreateQueryPool(
-			g_vkCore->m_device,
-			&queryPoolInfo,
-			nullptr,
-			&frame.queryPool
-		);
+		createPool(frame.timestamps, VK_QUERY_TYPE_TIMESTAMP, INITIAL_TIMESTAMP_QUERY_COUNT);
+
+		if (m_statisticsSupported) {
+			createPool(frame.statistics, VK_QUERY_TYPE_PIPELINE_STATISTICS, INITIAL_STATISTICS_QUERY_COUNT);
+		} else {
+			frame.statistics = {};
+		}
 
-		frame.last = 0;
+		frame.recorded = false;
+	}
+
+	for (auto &frame : m_traceFrames) {
+		frame.valid = false;
 	}
 }
 
 Profiler::~Profiler()
 {
 	for (auto &frame : m_queryFrames)
-		vkDestroyQueryPool(g_vkCore->m_device, frame.queryPool, nullptr);
+	{
+		vkDestroyQueryPool(g_vkCore->m_device, frame.timestamps.pool, nullptr);
+
+		if (frame.statistics.pool != VK_NULL_HANDLE) {
+			vkDestroyQueryPool(g_vkCore->m_device, frame.statistics.pool, nullptr);
+		}
+	}
 }
 
-void Profiler::getQuerys(CommandBuffer &cmd)
+void Profiler::createPool(QueryPool &pool, VkQueryType type, uint32_t capacity)
 {
-	int currentFrame = g_vkCore->getCurrentFrameIdx();
+	VkQueryPoolCreateInfo queryPoolInfo = {};
+	queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	queryPoolInfo.queryType = type;
+	queryPoolInfo.queryCount = capacity;
+	queryPoolInfo.pipelineStatistics = (type == VK_QUERY_TYPE_PIPELINE_STATISTICS) ? PIPELINE_STATISTICS : 0;
+
+	LLT_VK_CHECK(
+		vkCreateQueryPool(g_vkCore->m_device, &queryPoolInfo, nullptr, &pool.pool),
+		"Failed to create profiler query pool."
+	);
+
+	pool.capacity = capacity;
+	pool.count = 0;
+}
 
-	QueryFrameState &state = m_queryFrames[currentFrame];
+void Profiler::preparePool(CommandBuffer &cmd, QueryPool &pool, VkQueryType type)
+{
+	if (pool.pool == VK_NULL_HANDLE) {
+		return;
+	}
 
-	cmd.resetQueryPool(m_queryFrames[currentFrame].queryPool, 0, m_queryFrames[currentFrame].last);
+	// the frame that last used the pool has retired, so it can be swapped out for a bigger one
+	if (pool.count > pool.capacity)
+	{
+		uint32_t capacity = CalcU::max(pool.capacity * 2, pool.count);
 
-	m_queryFrames[currentFrame].last = 0;
-	m_queryFrames[currentFrame].samples.clear();
+		vkDestroyQueryPool(g_vkCore->m_device, pool.pool, nullptr);
+		createPool(pool, type, capacity);
+	}
+
+	cmd.resetQueryPool(pool.pool, 0, pool.capacity);
+
+	pool.count = 0;
+}
+
+uint32_t Profiler::allocateQuery(QueryPool &pool)
+{
+	// still counted past the end so the pool knows how far to grow
+	uint32_t query = pool.count++;
+
+	return (query < pool.capacity) ? query : NO_QUERY;
+}
+
+void Profiler::beginFrame(CommandBuffer &cmd)
+{
+	LLT_ASSERT(!m_inFrame, "Profiler frame was never ended.");
 
-	Vector<uint64_t> queryState;
-	queryState.resize(state.last);
+	QueryFrameState &state = m_queryFrames[g_vkCore->getCurrentFrameIdx()];
 
-	if (state.last != 0)
+	if (state.recorded) {
+		collectResults(state);
+	}
+
+	preparePool(cmd, state.timestamps, VK_QUERY_TYPE_TIMESTAMP);
+	preparePool(cmd, state.statistics, VK_QUERY_TYPE_PIPELINE_STATISTICS);
+
+	state.zones.clear();
+	state.recorded = true;
+
+	state.frameIndex = cpuprofiler::getFrameIndex();
+	state.hostBegin = cpuprofiler::now();
+
+	calibrate(state);
+
+	m_openZones.clear();
+	m_openStatisticsZone = -1;
+
+	m_inFrame = true;
+}
+
+void Profiler::calibrate(QueryFrameState &state)
+{
+	state.calibrated = false;
+
+	if (!g_vkCore->m_physicalData.calibratedTimestamps) {
+		return;
+	}
+
+	VkCalibratedTimestampInfoEXT infos[2] = {};
+
+	infos[0].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+	infos[0].timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+
+	infos[1].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+	infos[1].timeDomain = vkutil::HOST_TIME_DOMAIN;
+
+	uint64_t timestamps[2] = {};
+	uint64_t maxDeviation = 0;
+
+	if (vkGetCalibratedTimestampsEXT(g_vkCore->m_device, 2, infos, timestamps, &maxDeviation) != VK_SUCCESS) {
+		return;
+	}
+
+	state.calibrated = true;
+	state.calibrationDevice = timestamps[0];
+	state.calibrationHost = timestamps[1];
+}
+
+void Profiler::endFrame()
+{
+	LLT_ASSERT(m_openZones.size() == 0, "Profiler zones left open at the end of the frame.");
+
+	m_inFrame = false;
+}
+
+void Profiler::beginZone(CommandBuffer &cmd, const char *name, bool pipelineStatistics)
+{
+	if (!m_inFrame) {
+		return;
+	}
+
+	QueryFrameState &state = m_queryFrames[g_vkCore->getCurrentFrameIdx()];
+
+	uint64_t key = m_openZones.size() > 0 ? state.zones[m_openZones.back()].key : 0;
+	uint64_t nameHash = hash::calcBytes(0, name, cstr::length(name));
+	hash::combine(&key, &nameHash);
+
+	if (!m_history.contains(key))
+	{
+		ZoneHistory history = {};
+		history.name = name;
+		history.depth = m_openZones.size();
+
+		m_history.insert(key, history);
+		m_historyOrder.pushBack(key);
+	}
+
+	ZoneRecord zone = {};
+	zone.key = key;
+	zone.startQuery = allocateQuery(state.timestamps);
+	zone.endQuery = NO_QUERY;
+	zone.statisticsQuery = NO_QUERY;
+
+	if (zone.startQuery != NO_QUERY) {
+		cmd.writeTimestamp(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, state.timestamps.pool, zone.startQuery);
+	}
+
+	if (pipelineStatistics && m_statisticsSupported && m_openStatisticsZone < 0)
+	{
+		zone.statisticsQuery = allocateQuery(state.statistics);
+
+		if (zone.statisticsQuery != NO_QUERY)
+		{
+			cmd.beginQuery(state.statistics.pool, zone.statisticsQuery);
+			m_openStatisticsZone = state.zones.size();
+		}
+	}
+
+	m_openZones.pushBack(state.zones.size());
+	state.zones.pushBack(zone);
+}
+
+void Profiler::endZone(CommandBuffer &cmd)
+{
+	if (!m_inFrame) {
+		return;
+	}
+
+	LLT_ASSERT(m_openZones.size() > 0, "Ending a profiler zone that was never begun.");
+
+	QueryFrameState &state = m_queryFrames[g_vkCore->getCurrentFrameIdx()];
+
+	uint32_t index = m_openZones.back();
+	m_openZones.popBack();
+
+	ZoneRecord &zone = state.zones[index];
+
+	if (m_openStatisticsZone == (int)index)
+	{
+		cmd.endQuery(state.statistics.pool, zone.statisticsQuery);
+		m_openStatisticsZone = -1;
+	}
+
+	// a zone that didn't get a start doesn't need an end
+	if (zone.startQuery != NO_QUERY) {
+		zone.endQuery = allocateQuery(state.timestamps);
+	}
+
+	if (zone.endQuery != NO_QUERY) {
+		cmd.writeTimestamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, state.timestamps.pool, zone.endQuery);
+	}
+}
+
+void Profiler::collectResults(QueryFrameState &state)
+{
+	// every result comes with its availability after it, anything the gpu didn't get to is skipped rather than waited on
+	uint32_t timestampCount = CalcU::min(state.timestamps.count, state.timestamps.capacity);
+	Vector<uint64_t> timestamps(timestampCount * 2);
+
+	if (timestampCount > 0)
 	{
 		vkGetQueryPoolResults(
 			g_vkCore->m_device,
-			state.queryPool,
+			state.timestamps.pool,
 			0,
-			state.last,
-			queryState.size() * sizeof(uint64_t),
-			queryState.data(),
-			sizeof(uint64_t),
-			VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT
+			timestampCount,
+			timestamps.size() * sizeof(uint64_t),
+			timestamps.data(),
+			sizeof(uint64_t) * 2,
+			VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT
 		);
 	}
 
-	for (auto &timer : state.samples)
+	const int statisticsStride = PIPELINE_STATISTIC_COUNT + 1;
+
+	uint32_t statisticsCount = CalcU::min(state.statistics.count, state.statistics.capacity);
+	Vector<uint64_t> statistics(statisticsCount * statisticsStride);
+
+	if (statisticsCount > 0)
+	{
+		vkGetQueryPoolResults(
+			g_vkCore->m_device,
+			state.statistics.pool,
+			0,
+			statisticsCount,
+			statistics.size() * sizeof(uint64_t),
+			statistics.data(),
+			sizeof(uint64_t) * statisticsStride,
+			VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT
+		);
+	}
+
+	TraceFrame &trace = m_traceFrames[state.frameIndex % TRACE_FRAME_COUNT];
+	trace.frameIndex = state.frameIndex;
+	trace.valid = true;
+	trace.gpuMs = 0.0;
+	trace.zones.clear();
+
+	// without a calibration the first thing the gpu did is lined up with when the frame began recording
+	uint64_t deviceBase = state.calibrationDevice;
+	uint64_t hostBase = state.calibrationHost;
+
+	if (!state.calibrated)
+	{
+		deviceBase = ~0ull;
+		hostBase = state.hostBegin;
+
+		for (auto &zone : state.zones)
+		{
+			if (zone.startQuery != NO_QUERY && timestamps[zone.startQuery * 2 + 1] != 0) {
+				deviceBase = Calc<uint64_t>::min(deviceBase, timestamps[zone.startQuery * 2]);
+			}
+		}
+	}
+
+	auto toHostTime = [&](uint64_t ticks) -> uint64_t {
+		int64_t delta = (int64_t)((ticks - deviceBase) & m_timestampMask);
+
+		// a masked difference that's wrapped around is really a negative one
+		if (m_timestampMask != ~0ull && (uint64_t)delta > (m_timestampMask >> 1)) {
+			delta -= (int64_t)m_timestampMask + 1;
+		}
+
+		return hostBase + (int64_t)((double)delta * m_hostTicksPerDeviceTick);
+	};
+
+	for (auto &zone : state.zones)
 	{
-		uint64_t begin = queryState[timer.start];
-		uint64_t end = queryState[timer.end];
+		ZoneHistory &history = m_history.get(zone.key);
+
+		if (zone.startQuery != NO_QUERY && zone.endQuery != NO_QUERY)
+		{
+			const uint64_t *start = &timestamps[zone.startQuery * 2];
+			const uint64_t *end = &timestamps[zone.endQuery * 2];
+
+			if (start[1] != 0 && end[1] != 0)
+			{
+				uint64_t ticks = (end[0] - start[0]) & m_timestampMask;
+				double ms = (m_period * (double)ticks) / 1000000.0;
+
+				// nested zones are already counted by their parents
+				if (history.depth == 0) {
+					trace.gpuMs += ms;
+				}
 
-		uint64_t range = end - begin;
+				history.times[history.next] = (float)ms;
+				history.next = (history.next + 1) % HISTORY_LENGTH;
+				history.sampleCount = CalcU::min(history.sampleCount + 1, HISTORY_LENGTH);
+				history.lastFrameIndex = state.frameIndex;
 
-		double time = (m_period * (double)range) / 1000000.0;
+				cpuprofiler::Event traceZone = {};
+				traceZone.name = history.name;
+				traceZone.begin = toHostTime(start[0]);
+				traceZone.end = toHostTime(end[0]);
 
-		m_timings.insert(timer.name, time);
+				trace.zones.pushBack(traceZone);
+			}
+		}
+
+		if (zone.statisticsQuery != NO_QUERY)
+		{
+			const uint64_t *result = &statistics[zone.statisticsQuery * statisticsStride];
+
+			if (result[PIPELINE_STATISTIC_COUNT] != 0)
+			{
+				history.hasPipelineStatistics = true;
+				history.vertexInvocations = result[0];
+				history.fragmentInvocations = result[1];
+			}
+		}
 	}
 }
 
-void Profiler::storeSample(const ScopeTimer::Sample &sample)
+bool Profiler::isPipelineStatisticsSupported() const
 {
-	m_queryFrames[g_vkCore->getCurrentFrameIdx()].samples.pushBack(sample);
+	return m_statisticsSupported;
 }
 
-VkQueryPool Profiler::getTimerPool() const
+Vector<ProfilerZoneStats> Profiler::getStats() const
 {
-	return m_queryFrames[g_vkCore->getCurrentFrameIdx()].queryPool;
+	Vector<ProfilerZoneStats> result;
+
+	float sorted[HISTORY_LENGTH];
+
+	for (uint64_t key : m_historyOrder)
+	{
+		const ZoneHistory &history = m_history.get(key);
+
+		ProfilerZoneStats stats = {};
+		stats.name = history.name;
+		stats.depth = history.depth;
+		stats.sampleCount = history.sampleCount;
+		stats.hasPipelineStatistics = history.hasPipelineStatistics;
+		stats.vertexInvocations = history.vertexInvocations;
+		stats.fragmentInvocations = history.fragmentInvocations;
+
+		if (history.sampleCount > 0)
+		{
+			mem::copy(sorted, history.times, sizeof(float) * history.sampleCount);
+			std::sort(sorted, sorted + history.sampleCount);
+
+			double total = 0.0;
+
+			for (int i = 0; i < history.sampleCount; i++) {
+				total += sorted[i];
+			}
+
+			uint32_t p99Index = (history.sampleCount * 99 + 99) / 100 - 1;
+
+			stats.minMs = sorted[0];
+			stats.maxMs = sorted[history.sampleCount - 1];
+			stats.avgMs = total / (double)history.sampleCount;
+			stats.p99Ms = sorted[p99Index];
+		}
+
+		result.pushBack(stats);
+	}
+
+	return result;
 }
 
-uint64_t Profiler::getTimestampID()
+bool Profiler::getFrameTime(uint64_t frameIndex, double *gpuMs) const
 {
-	return m_queryFrames[g_vkCore->getCurrentFrameIdx()].last++;
+	const TraceFrame &frame = m_traceFrames[frameIndex % TRACE_FRAME_COUNT];
+
+	if (!frame.valid || frame.frameIndex != frameIndex) {
+		return false;
+	}
+
+	(*gpuMs) = frame.gpuMs;
+
+	return true;
 }
 
-ScopeTimer::ScopeTimer(const char *name, CommandBuffer &cmd)
-	: m_sample()
-	, m_cmd(cmd)
+bool Profiler::getLatestZoneTime(const char *name, double *gpuMs, uint64_t *frameIndex) const
 {
-	m_sample.name = name;
-	m_sample.start = g_profiler->getTimestampID();
-	m_sample.end = 0;
+	// keyed the same way beginZone does it, with no parent
+	uint64_t key = 0;
+	uint64_t nameHash = hash::calcBytes(0, name, cstr::length(name));
+	hash::combine(&key, &nameHash);
+
+	if (!m_history.contains(key)) {
+		return false;
+	}
 
-	VkQueryPool pool = g_profiler->getTimerPool();
+	const ZoneHistory &history = m_history.get(key);
 
-	m_cmd.writeTimestamp(
-		VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
-		pool,
-		m_sample.start
-	);
+	if (history.sampleCount == 0) {
+		return false;
+	}
+
+	(*gpuMs) = history.times[(history.next + HISTORY_LENGTH - 1) % HISTORY_LENGTH];
+	(*frameIndex) = history.lastFrameIndex;
+
+	return true;
 }
 
-ScopeTimer::~ScopeTimer()
+void Profiler::getTraceZones(uint64_t firstFrame, uint64_t lastFrame, Vector<cpuprofiler::Event> &zones) const
 {
-	m_sample.end = g_profiler->getTimestampID();
+	for (auto &frame : m_traceFrames)
+	{
+		if (!frame.valid || frame.frameIndex < firstFrame || frame.frameIndex >= lastFrame) {
+			continue;
+		}
 
-	VkQueryPool pool = g_profiler->getTimerPool();
+		for (auto &zone : frame.zones) {
+			zones.pushBack(zone);
+		}
+	}
+}
 
-	m_cmd.writeTimestamp(
-		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-		pool,
-		m_sample.end
-	);
+ScopeTimer::ScopeTimer(const char *name, CommandBuffer &cmd, bool pipelineStatistics)
+	: m_cmd(cmd)
+{
+	g_profiler->beginZone(m_cmd, name, pipelineStatistics);
+}
 
-	g_profiler->storeSample(m_sample);
+ScopeTimer::~ScopeTimer()
+{
+	g_profiler->endZone(m_cmd);
 }
@@ -4,63 +4,196 @@
 #include "third_party/volk.h"
 
 #include "common.h"
+#include "cpu_profiler.h"
 
 #include "vulkan/command_buffer.h"
 
-#include "container/string.h"
 #include "container/array.h"
 #include "container/vector.h"
 #include "container/hash_map.h"
 
 namespace llt
 {
-	class Profiler;
-
-	class ScopeTimer
+	/*
+	 * How a zone did over the last Profiler::HISTORY_LENGTH frames it was recorded in.
+	 */
+	struct ProfilerZoneStats
 	{
-	public:
-		struct Sample
-		{
-			String name;
-			uint64_t start;
-			uint64_t end;
-		};
+		const char *name;
+		int depth;
 
-		ScopeTimer(const char *name, CommandBuffer &cmd);
-		~ScopeTimer();
+		double minMs;
+		double avgMs;
+		double maxMs;
+		double p99Ms;
 
-	private:
-		Sample m_sample;
-		CommandBuffer &m_cmd;
+		uint32_t sampleCount;
+
+		// from the last frame only, and only for zones that asked for them
+		bool hasPipelineStatistics;
+		uint64_t vertexInvocations;
+		uint64_t fragmentInvocations;
 	};
 
+	/**
+	 * Times nested zones of gpu work with timestamp queries.
+	 *
+	 * Each frame in flight has its own query pools. They're read back at the start of the frame that reuses
+	 * them, by which point the frame that wrote them has retired, so nothing ever waits on the gpu for results.
+	 * A frame that needs more queries than its pools hold drops the zones that don't fit and the pools grow
+	 * before they're next used.
+	 *
+	 * A zone is identified by its name and the zones it's nested in, so the same name under different parents
+	 * gets timed separately. Names have to outlive the profiler (string literals, usually).
+	 *
+	 * The zones of the last few frames are also kept around for traces. With VK_EXT_calibrated_timestamps
+	 * they're placed exactly on the cpu timeline, otherwise each frame's work is assumed to start when
+	 * the frame began recording.
+	 */
 	class Profiler
 	{
 	public:
-		Profiler(int perFramePoolSizes);
-		~Profiler();
+		static constexpr uint32_t HISTORY_LENGTH = 128;
+		static constexpr uint32_t INITIAL_TIMESTAMP_QUERY_COUNT = 64;
+		static constexpr uint32_t INITIAL_STATISTICS_QUERY_COUNT = 8;
+		static constexpr uint32_t TRACE_FRAME_COUNT = 256;
 
-		void getQuerys(CommandBuffer &cmd);
+		Profiler();
+		~Profiler();
 
-		void storeSample(const ScopeTimer::Sample &sample);
+		/*
+		 * Collects what the frame that last used this frame's pools recorded and resets them.
+		 * Has to be the first thing recorded into the frame's command buffer, zones outside of a frame are ignored.
+		 */
+		void beginFrame(CommandBuffer &cmd);
+		void endFrame();
+
+		/*
+		 * Pipeline statistics (vertex and fragment shader invocations) can't nest, so a zone inside one that's
+		 * already collecting them only gets timed. Like any query they can't span a rendering scope either,
+		 * the zone has to begin and end inside the same one or outside of any.
+		 */
+		void beginZone(CommandBuffer &cmd, const char *name, bool pipelineStatistics);
+		void endZone(CommandBuffer &cmd);
+
+		bool isPipelineStatisticsSupported() const;
+
+		/*
+		 * Every zone recorded so far, each parent coming before its children.
+		 */
+		Vector<ProfilerZoneStats> getStats() const;
+
+		/*
+		 * How long the outermost zones of a retired frame took altogether, counted like the cpu profiler does.
+		 * False until the frame's retired, or once it's older than TRACE_FRAME_COUNT frames.
+		 */
+		bool getFrameTime(uint64_t frameIndex, double *gpuMs) const;
+
+		/*
+		 * How long an outermost zone took the last time it was read back, and the frame it was recorded in.
+		 * False if it's never been recorded.
+		 */
+		bool getLatestZoneTime(const char *name, double *gpuMs, uint64_t *frameIndex) const;
+
+		/*
+		 * The zones of the retired frames in [firstFrame, lastFrame), frames being counted by the cpu profiler
+		 * and times being on its clock.
+		 */
+		void getTraceZones(uint64_t firstFrame, uint64_t lastFrame, Vector<cpuprofiler::Event> &zones) const;
 
-		VkQueryPool getTimerPool() const;
+	private:
+		struct ZoneRecord
+		{
+			uint64_t key;
+			uint32_t startQuery;
+			uint32_t endQuery;
+			uint32_t statisticsQuery;
+		};
 
-		uint64_t getTimestampID();
+		struct QueryPool
+		{
+			VkQueryPool pool;
+			uint32_t capacity;
+			uint32_t count;
+		};
 
-		HashMap<String, double> m_timings;
+		struct QueryFrameState
+		{
+			QueryPool timestamps;
+			QueryPool statistics;
+			Vector<ZoneRecord> zones;
+			bool recorded;
+
+			uint64_t frameIndex;
+			uint64_t hostBegin;
+
+			// a device timestamp and the host time it was taken at, if they could be calibrated
+			bool calibrated;
+			uint64_t calibrationDevice;
+			uint64_t calibrationHost;
+		};
 
-	private:
-		float m_period;
+		struct TraceFrame
+		{
+			uint64_t frameIndex;
+			bool valid;
+			double gpuMs;
+			Vector<cpuprofiler::Event> zones;
+		};
 
-		struct QueryFrameState
+		struct ZoneHistory
 		{
-			Vector<ScopeTimer::Sample> samples;
-			VkQueryPool queryPool;
-			uint64_t last;
+			const char *name;
+			int depth;
+
+			float times[HISTORY_LENGTH];
+			uint32_t sampleCount;
+			uint32_t next;
+			uint64_t lastFrameIndex;
+
+			bool hasPipelineStatistics;
+			uint64_t vertexInvocations;
+			uint64_t fragmentInvocations;
 		};
 
+		void createPool(QueryPool &pool, VkQueryType type, uint32_t capacity);
+		void preparePool(CommandBuffer &cmd, QueryPool &pool, VkQueryType type);
+
+		uint32_t allocateQuery(QueryPool &pool);
+
+		void collectResults(QueryFrameState &state);
+		void calibrate(QueryFrameState &state);
+
+		double m_period;
+		uint64_t m_timestampMask;
+		double m_hostTicksPerDeviceTick;
+
+		bool m_statisticsSupported;
+		bool m_inFrame;
+
 		Array<QueryFrameState, mgc::FRAMES_IN_FLIGHT> m_queryFrames;
+
+		// indices into the current frame's zones, innermost last
+		Vector<uint32_t> m_openZones;
+		int m_openStatisticsZone;
+
+		HashMap<uint64_t, ZoneHistory> m_history;
+		Vector<uint64_t> m_historyOrder;
+
+		Vector<TraceFrame> m_traceFrames;
+	};
+
+	/*
+	 * Times whatever is recorded into the command buffer for as long as it's around.
+	 */
+	class ScopeTimer
+	{
+	public:
+		ScopeTimer(const char *name, CommandBuffer &cmd, bool pipelineStatistics = false);
+		~ScopeTimer();
+
+	private:
+		CommandBuffer &m_cmd;
 	};
 
 	extern Profiler *g_profiler;
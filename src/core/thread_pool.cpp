@@ -0,0 +1,179 @@
+#include "thread_pool.h"
+
+#include <atomic>
+
+#include "cpu_profiler.h"
+
+llt::ThreadPool *llt::g_threadPool = nullptr;
+
+using namespace llt;
+
+ThreadPool::ThreadPool(uint32_t workerCount)
+	: m_workers()
+	, m_mutex()
+	, m_jobCondition()
+	, m_idleCondition()
+	, m_jobs()
+	, m_activeCount(0)
+	, m_stopping(false)
+{
+	if (workerCount == 0)
+	{
+		uint32_t hardwareThreads = std::thread::hardware_concurrency();
+		workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+	}
+
+	for (int i = 0; i < workerCount; i++) {
+		m_workers.pushBack(new std::thread(&ThreadPool::workerMain, this));
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+
+	m_jobCondition.notify_all();
+
+	for (auto &worker : m_workers)
+	{
+		worker->join();
+		delete worker;
+	}
+
+	m_workers.clear();
+}
+
+void ThreadPool::enqueue(const Job &job)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_jobs.push_back(job);
+	}
+
+	m_jobCondition.notify_one();
+}
+
+void ThreadPool::parallelFor(uint32_t count, const Function<void(uint32_t)> &fn)
+{
+	if (count == 0) {
+		return;
+	}
+
+	LLT_PROFILE_SCOPE("parallel for");
+
+	std::mutex doneMutex;
+	std::condition_variable doneCondition;
+	std::atomic<uint32_t> remaining = count;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			m_jobs.push_back([&, i]() -> void
+			{
+				fn(i);
+
+				// decrement under the lock so the caller can't return and destroy it while we're still notifying
+				std::lock_guard<std::mutex> doneLock(doneMutex);
+
+				if (--remaining == 0) {
+					doneCondition.notify_one();
+				}
+			});
+		}
+	}
+
+	m_jobCondition.notify_all();
+
+	// help out while we wait, so calling this from inside a job can't starve the pool of workers
+	while (remaining > 0)
+	{
+		Job job;
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			if (!m_jobs.empty())
+			{
+				job = m_jobs.front();
+				m_jobs.pop_front();
+
+				m_activeCount++;
+			}
+		}
+
+		if (job)
+		{
+			{
+				LLT_PROFILE_SCOPE("job");
+				job();
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_activeCount--;
+			}
+
+			m_idleCondition.notify_all();
+			continue;
+		}
+
+		// everything left is already running on another thread
+		std::unique_lock<std::mutex> lock(doneMutex);
+		doneCondition.wait(lock, [&]() { return remaining == 0; });
+	}
+
+	// the last job might still be holding the lock if we saw it finish without waiting
+	std::lock_guard<std::mutex> lock(doneMutex);
+}
+
+void ThreadPool::waitIdle()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_idleCondition.wait(lock, [this]() { return m_jobs.empty() && m_activeCount == 0; });
+}
+
+uint32_t ThreadPool::getWorkerCount() const
+{
+	return m_workers.size();
+}
+
+void ThreadPool::workerMain()
+{
+	cpuprofiler::setThreadName("worker");
+
+	while (true)
+	{
+		Job job;
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_jobCondition.wait(lock, [this]() { return m_stopping || !m_jobs.empty(); });
+
+			if (m_stopping) {
+				return;
+			}
+
+			job = m_jobs.front();
+			m_jobs.pop_front();
+
+			m_activeCount++;
+		}
+
+		{
+			LLT_PROFILE_SCOPE("job");
+			job();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_activeCount--;
+		}
+
+		m_idleCondition.notify_all();
+	}
+}
@@ -0,0 +1,64 @@
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <deque>
+
+#include "core/common.h"
+
+#include "container/vector.h"
+#include "container/function.h"
+
+namespace llt
+{
+	/**
+	 * General purpose worker threads for cpu-heavy jobs (image decoding, cooking, etc...).
+	 * Jobs must not touch the vulkan api, anything gpu-side gets handed back to the main thread.
+	 */
+	class ThreadPool
+	{
+	public:
+		using Job = Function<void()>;
+
+		/*
+		 * A worker count of 0 leaves one hardware thread free for the main thread.
+		 */
+		ThreadPool(uint32_t workerCount = 0);
+		~ThreadPool();
+
+		void enqueue(const Job &job);
+
+		/*
+		 * Runs fn(i) for every i in [0, count) across the workers and blocks until they've all finished.
+		 * The calling thread picks up queued jobs while it waits, so this is safe to call from inside a job.
+		 */
+		void parallelFor(uint32_t count, const Function<void(uint32_t)> &fn);
+
+		/*
+		 * Blocks until the queue is empty and no worker is running a job.
+		 */
+		void waitIdle();
+
+		uint32_t getWorkerCount() const;
+
+	private:
+		void workerMain();
+
+		Vector<std::thread *> m_workers;
+
+		std::mutex m_mutex;
+		std::condition_variable m_jobCondition;
+		std::condition_variable m_idleCondition;
+
+		std::deque<Job> m_jobs;
+		uint32_t m_activeCount;
+
+		bool m_stopping;
+	};
+
+	extern ThreadPool *g_threadPool;
+}
+
+#endif // THREAD_POOL_H_
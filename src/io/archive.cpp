@@ -0,0 +1,374 @@
+#include "archive.h"
+#include "lz4.h"
+
+#include <fstream>
+#include <algorithm>
+
+using namespace llt;
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+String archive::normalisePath(const char *path)
+{
+	String result;
+
+	while (path[0] != '\0')
+	{
+		// skip separators, collapsing any repeats
+		if (path[0] == '/' || path[0] == '\\')
+		{
+			path++;
+			continue;
+		}
+
+		uint64_t segmentLength = 0;
+
+		while (path[segmentLength] != '\0' && path[segmentLength] != '/' && path[segmentLength] != '\\') {
+			segmentLength++;
+		}
+
+		bool isCurrent = segmentLength == 1 && path[0] == '.';
+		bool isParent = segmentLength == 2 && path[0] == '.' && path[1] == '.';
+
+		if (isCurrent)
+		{
+			// "./" doesn't change anything
+		}
+		else if (isParent && result.length() > 0 && result != ".." && !result.endsWith("/.."))
+		{
+			// "a/b/../" -> "a/"
+			int end = result.length() - 1;
+
+			while (end >= 0 && result[end] != '/') {
+				end--;
+			}
+
+			String trimmed;
+
+			for (int i = 0; i < end; i++) {
+				trimmed.pushBack(result[i]);
+			}
+
+			result = trimmed;
+		}
+		else
+		{
+			if (result.length() > 0) {
+				result.pushBack('/');
+			}
+
+			for (int i = 0; i < segmentLength; i++) {
+				result.pushBack(path[i]);
+			}
+		}
+
+		path += segmentLength;
+	}
+
+	return result;
+}
+
+uint64_t archive::hashPath(const char *normalisedPath)
+{
+	return hash::calc(0, normalisedPath);
+}
+
+ArchiveWriter::ArchiveWriter()
+	: m_entries()
+	, m_strings()
+{
+}
+
+ArchiveWriter::~ArchiveWriter()
+{
+	for (auto &pending : m_entries) {
+		delete pending.data;
+	}
+
+	m_entries.clear();
+}
+
+void ArchiveWriter::addFile(const char *path, const void *data, uint64_t size, bool compress, float minSavings)
+{
+	String normalised = archive::normalisePath(path);
+
+	PendingEntry pending = {};
+	pending.entry.pathHash = archive::hashPath(normalised.cstr());
+	pending.entry.size = size;
+	pending.entry.pathOffset = m_strings.size();
+	pending.entry.compression = archive::COMPRESSION_STORED;
+
+	pending.data = new Vector<byte>();
+
+	uint64_t pathLength = normalised.length() + 1;
+	m_strings.resize(m_strings.size() + pathLength);
+	mem::copy(m_strings.data() + pending.entry.pathOffset, normalised.cstr(), pathLength);
+
+	if (compress && size > 0)
+	{
+		pending.data->resize(lz4::compressBound(size));
+
+		int64_t compressedSize = lz4::compress(data, size, pending.data->data(), pending.data->size());
+
+		if (compressedSize > 0 && compressedSize <= (int64_t)(size * (1.0f - minSavings)))
+		{
+			pending.data->resize(compressedSize);
+			pending.entry.storedSize = compressedSize;
+			pending.entry.compression = archive::COMPRESSION_LZ4;
+
+			m_entries.pushBack(pending);
+			return;
+		}
+	}
+
+	pending.data->resize(size);
+	mem::copy(pending.data->data(), data, size);
+	pending.entry.storedSize = size;
+
+	m_entries.pushBack(pending);
+}
+
+bool ArchiveWriter::save(const String &path) const
+{
+	Vector<archive::Entry> entries(m_entries.size());
+	Vector<const Vector<byte> *> datas(m_entries.size());
+
+	// sort by hash so lookups can binary search
+	Vector<uint32_t> order(m_entries.size());
+
+	for (int i = 0; i < m_entries.size(); i++) {
+		order[i] = i;
+	}
+
+	std::sort(order.data(), order.data() + order.size(), [this](uint32_t a, uint32_t b) {
+		return m_entries[a].entry.pathHash < m_entries[b].entry.pathHash;
+	});
+
+	archive::Header header = {};
+	header.magic = archive::MAGIC;
+	header.version = archive::VERSION;
+	header.entryCount = m_entries.size();
+	header.entryTableOffset = sizeof(archive::Header);
+	header.stringTableOffset = header.entryTableOffset + sizeof(archive::Entry) * m_entries.size();
+	header.stringTableSize = m_strings.size();
+
+	uint64_t offset = header.stringTableOffset + header.stringTableSize;
+
+	for (int i = 0; i < order.size(); i++)
+	{
+		const PendingEntry &pending = m_entries[order[i]];
+
+		entries[i] = pending.entry;
+		datas[i] = pending.data;
+
+		uint64_t alignment = pending.entry.compression == archive::COMPRESSION_STORED
+			? archive::STORED_ALIGNMENT
+			: archive::COMPRESSED_ALIGNMENT;
+
+		offset = alignUp(offset, alignment);
+
+		entries[i].offset = offset;
+		offset += pending.entry.storedSize;
+	}
+
+	std::ofstream file(path.cstr(), std::ios::binary | std::ios::trunc);
+
+	if (!file.is_open())
+	{
+		LLT_LOG("Failed to open archive for writing: %s", path.cstr());
+		return false;
+	}
+
+	file.write((const char *)&header, sizeof(header));
+	file.write((const char *)entries.data(), sizeof(archive::Entry) * entries.size());
+	file.write(m_strings.data(), m_strings.size());
+
+	uint64_t written = header.stringTableOffset + header.stringTableSize;
+
+	const char zeros[archive::STORED_ALIGNMENT] = {};
+
+	for (int i = 0; i < entries.size(); i++)
+	{
+		file.write(zeros, entries[i].offset - written);
+		file.write((const char *)datas[i]->data(), entries[i].storedSize);
+
+		written = entries[i].offset + entries[i].storedSize;
+	}
+
+	return file.good();
+}
+
+uint32_t ArchiveWriter::getEntryCount() const
+{
+	return m_entries.size();
+}
+
+uint64_t ArchiveWriter::getTotalSize() const
+{
+	uint64_t total = 0;
+
+	for (auto &pending : m_entries) {
+		total += pending.entry.size;
+	}
+
+	return total;
+}
+
+uint64_t ArchiveWriter::getTotalStoredSize() const
+{
+	uint64_t total = 0;
+
+	for (auto &pending : m_entries) {
+		total += pending.entry.storedSize;
+	}
+
+	return total;
+}
+
+// ---
+
+ArchiveReader::ArchiveReader()
+	: m_file()
+	, m_header(nullptr)
+	, m_entries(nullptr)
+	, m_strings(nullptr)
+{
+}
+
+bool ArchiveReader::open(const String &path)
+{
+	close();
+
+	if (!m_file.open(path, MAPPED_FILE_ACCESS_RANDOM)) {
+		return false;
+	}
+
+	if (m_file.size() < sizeof(archive::Header))
+	{
+		LLT_LOG("Archive is too small to be valid: %s", path.cstr());
+		close();
+		return false;
+	}
+
+	const archive::Header *header = (const archive::Header *)m_file.data();
+
+	if (header->magic != archive::MAGIC || header->version != archive::VERSION)
+	{
+		LLT_LOG("Archive has an unknown format or version: %s", path.cstr());
+		close();
+		return false;
+	}
+
+	uint64_t entryTableEnd = header->entryTableOffset + sizeof(archive::Entry) * header->entryCount;
+	uint64_t stringTableEnd = header->stringTableOffset + header->stringTableSize;
+
+	if (entryTableEnd > m_file.size() || stringTableEnd > m_file.size())
+	{
+		LLT_LOG("Archive index is truncated: %s", path.cstr());
+		close();
+		return false;
+	}
+
+	m_header = header;
+	m_entries = (const archive::Entry *)(m_file.data() + header->entryTableOffset);
+	m_strings = (const char *)(m_file.data() + header->stringTableOffset);
+
+	for (int i = 0; i < m_header->entryCount; i++)
+	{
+		if (m_entries[i].offset + m_entries[i].storedSize > m_file.size() || m_entries[i].pathOffset >= m_header->stringTableSize)
+		{
+			LLT_LOG("Archive entry %d points outside of the file: %s", i, path.cstr());
+			close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void ArchiveReader::close()
+{
+	m_file.close();
+
+	m_header = nullptr;
+	m_entries = nullptr;
+	m_strings = nullptr;
+}
+
+bool ArchiveReader::isOpen() const
+{
+	return m_header != nullptr;
+}
+
+const archive::Entry *ArchiveReader::find(const char *path) const
+{
+	if (!m_header) {
+		return nullptr;
+	}
+
+	String normalised = archive::normalisePath(path);
+	uint64_t pathHash = archive::hashPath(normalised.cstr());
+
+	const archive::Entry *begin = m_entries;
+	const archive::Entry *end = m_entries + m_header->entryCount;
+
+	const archive::Entry *it = std::lower_bound(begin, end, pathHash, [](const archive::Entry &entry, uint64_t hash) {
+		return entry.pathHash < hash;
+	});
+
+	// walk any entries that share the hash and compare the actual path
+	for (; it != end && it->pathHash == pathHash; it++)
+	{
+		if (cstr::compare(m_strings + it->pathOffset, normalised.cstr()) == 0) {
+			return it;
+		}
+	}
+
+	return nullptr;
+}
+
+const char *ArchiveReader::getPath(const archive::Entry *entry) const
+{
+	return m_strings + entry->pathOffset;
+}
+
+std::span<const byte> ArchiveReader::view(const archive::Entry *entry) const
+{
+	if (entry->compression != archive::COMPRESSION_STORED) {
+		return std::span<const byte>();
+	}
+
+	return m_file.view(entry->offset, entry->storedSize);
+}
+
+bool ArchiveReader::extract(const archive::Entry *entry, void *dst) const
+{
+	const byte *src = m_file.data() + entry->offset;
+
+	switch (entry->compression)
+	{
+		case archive::COMPRESSION_STORED:
+			mem::copy(dst, src, entry->storedSize);
+			return true;
+
+		case archive::COMPRESSION_LZ4:
+			return lz4::decompress(src, entry->storedSize, dst, entry->size) == (int64_t)entry->size;
+
+		default:
+			LLT_LOG("Unknown compression type in archive entry: %s", getPath(entry));
+			return false;
+	}
+}
+
+uint32_t ArchiveReader::getEntryCount() const
+{
+	return m_header ? m_header->entryCount : 0;
+}
+
+const archive::Entry *ArchiveReader::getEntry(uint32_t index) const
+{
+	return m_entries + index;
+}
@@ -0,0 +1,145 @@
+#ifndef ARCHIVE_H_
+#define ARCHIVE_H_
+
+#include <span>
+
+#include "core/common.h"
+
+#include "container/vector.h"
+#include "container/string.h"
+
+#include "mapped_file.h"
+
+namespace llt
+{
+	/*
+	 * Packed asset archive.
+	 *
+	 * [Header][Entry * n, sorted by pathHash][string table][entry data...]
+	 *
+	 * Stored (uncompressed) entries start on a page boundary so they can be used
+	 * in-place straight out of a mapping of the whole archive.
+	 */
+	namespace archive
+	{
+		static constexpr uint32_t MAGIC = 0x4B504C4C; // "LLPK"
+		static constexpr uint32_t VERSION = 1;
+
+		static constexpr uint64_t STORED_ALIGNMENT = 4096;
+		static constexpr uint64_t COMPRESSED_ALIGNMENT = 16;
+
+		enum Compression : uint32_t
+		{
+			COMPRESSION_STORED,
+			COMPRESSION_LZ4
+		};
+
+		struct Header
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t entryCount;
+			uint32_t _padding;
+
+			uint64_t entryTableOffset;
+			uint64_t stringTableOffset;
+			uint64_t stringTableSize;
+		};
+
+		struct Entry
+		{
+			uint64_t pathHash;
+
+			uint64_t offset;
+			uint64_t storedSize;	// size in the archive
+			uint64_t size;			// size once decompressed
+
+			uint32_t pathOffset;	// into the string table, used to resolve hash collisions
+			uint32_t compression;
+		};
+
+		/*
+		 * Archive paths are always forward-slashed and relative, with "." and "x/.." segments resolved.
+		 */
+		String normalisePath(const char *path);
+
+		uint64_t hashPath(const char *normalisedPath);
+	}
+
+	/**
+	 * Builds an archive in memory and writes it out in one go.
+	 * Only really used by the packer tool.
+	 */
+	class ArchiveWriter
+	{
+	public:
+		ArchiveWriter();
+		~ArchiveWriter();
+
+		/*
+		 * Compressed entries are only kept as compressed if they actually save at least minSavings (0-1)
+		 * of the original size, otherwise they're stored (already-compressed formats like jpg/png).
+		 */
+		void addFile(const char *path, const void *data, uint64_t size, bool compress, float minSavings = 0.1f);
+
+		bool save(const String &path) const;
+
+		uint32_t getEntryCount() const;
+		uint64_t getTotalSize() const;
+		uint64_t getTotalStoredSize() const;
+
+	private:
+		struct PendingEntry
+		{
+			archive::Entry entry;
+			Vector<byte> *data;
+		};
+
+		Vector<PendingEntry> m_entries;
+		Vector<char> m_strings;
+	};
+
+	/**
+	 * Read-only access to a memory-mapped archive.
+	 */
+	class ArchiveReader
+	{
+	public:
+		ArchiveReader();
+		~ArchiveReader() = default;
+
+		bool open(const String &path);
+		void close();
+
+		bool isOpen() const;
+
+		/*
+		 * Binary search over the sorted index. Returns nullptr if there's no such entry.
+		 */
+		const archive::Entry *find(const char *path) const;
+
+		const char *getPath(const archive::Entry *entry) const;
+
+		/*
+		 * Zero-copy access to a stored entry. Returns an empty span for compressed entries.
+		 */
+		std::span<const byte> view(const archive::Entry *entry) const;
+
+		/*
+		 * Decompresses (or copies, if stored) the entry into dst, which must hold at least entry->size bytes.
+		 */
+		bool extract(const archive::Entry *entry, void *dst) const;
+
+		uint32_t getEntryCount() const;
+		const archive::Entry *getEntry(uint32_t index) const;
+
+	private:
+		MappedFile m_file;
+
+		const archive::Header *m_header;
+		const archive::Entry *m_entries;
+		const char *m_strings;
+	};
+}
+
+#endif // ARCHIVE_H_
@@ -0,0 +1,241 @@
+#include "async_io.h"
+
+#include <fstream>
+
+#include "core/cpu_profiler.h"
+
+llt::AsyncIO *llt::g_asyncIO = nullptr;
+
+using namespace llt;
+
+AsyncIO *AsyncIO::create(uint32_t workerCount)
+{
+#ifdef LLT_IO_URING
+	UringAsyncIO *uring = new UringAsyncIO();
+
+	if (uring->init(256)) {
+		return uring;
+	}
+
+	LLT_LOG("io_uring unavailable, falling back to thread pool async i/o.");
+	delete uring;
+#endif // LLT_IO_URING
+
+	if (workerCount == 0)
+	{
+		// i/o threads spend most of their time blocked so we don't need a whole core each
+		uint32_t hardwareThreads = std::thread::hardware_concurrency();
+		workerCount = hardwareThreads > 4 ? hardwareThreads / 2 : 2;
+	}
+
+	return new ThreadPoolAsyncIO(workerCount);
+}
+
+AsyncIO::AsyncIO()
+	: m_completionMutex()
+	, m_completionCondition()
+	, m_completions()
+	, m_pending(0)
+{
+}
+
+void AsyncIO::submit(const AsyncReadRequest &request)
+{
+	AsyncReadRequest *copy = new AsyncReadRequest(request);
+
+	m_pending++;
+	enqueue(&copy, 1);
+}
+
+void AsyncIO::submit(const Vector<AsyncReadRequest> &requests)
+{
+	if (requests.size() == 0) {
+		return;
+	}
+
+	Vector<AsyncReadRequest *> copies(requests.size());
+
+	for (int i = 0; i < requests.size(); i++) {
+		copies[i] = new AsyncReadRequest(requests[i]);
+	}
+
+	m_pending += requests.size();
+	enqueue(copies.data(), copies.size());
+}
+
+uint32_t AsyncIO::poll()
+{
+	LLT_PROFILE_SCOPE("async io poll");
+
+	harvest(false);
+
+	Vector<Completion> completions;
+
+	{
+		// take the whole queue so callbacks can submit more reads without deadlocking
+		std::lock_guard<std::mutex> lock(m_completionMutex);
+		completions = std::move(m_completions);
+	}
+
+	for (auto &completion : completions)
+	{
+		AsyncReadRequest *request = completion.request;
+
+		if (request->callback)
+		{
+			AsyncReadResult result = {};
+			result.buffer = request->buffer;
+			result.bytesRead = completion.bytesRead > 0 ? completion.bytesRead : 0;
+			result.success = completion.bytesRead >= 0;
+			result.userData = request->userData;
+
+			request->callback(result);
+		}
+
+		delete request;
+	}
+
+	m_pending -= completions.size();
+
+	return completions.size();
+}
+
+void AsyncIO::waitIdle()
+{
+	while (m_pending > 0)
+	{
+		harvest(true);
+		poll();
+	}
+}
+
+uint32_t AsyncIO::getPendingCount() const
+{
+	return m_pending;
+}
+
+void AsyncIO::complete(AsyncReadRequest *request, int64_t bytesRead)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_completionMutex);
+		m_completions.pushBack({ request, bytesRead });
+	}
+
+	m_completionCondition.notify_one();
+}
+
+// ---
+
+ThreadPoolAsyncIO::ThreadPoolAsyncIO(uint32_t workerCount)
+	: AsyncIO()
+	, m_workers()
+	, m_jobMutex()
+	, m_jobCondition()
+	, m_jobs()
+	, m_stopping(false)
+{
+	for (int i = 0; i < workerCount; i++) {
+		m_workers.pushBack(new std::thread(&ThreadPoolAsyncIO::workerMain, this));
+	}
+}
+
+ThreadPoolAsyncIO::~ThreadPoolAsyncIO()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_jobMutex);
+		m_stopping = true;
+	}
+
+	m_jobCondition.notify_all();
+
+	for (auto &worker : m_workers)
+	{
+		worker->join();
+		delete worker;
+	}
+
+	m_workers.clear();
+
+	// anything that never got picked up is dropped without running its callback
+	for (auto *job : m_jobs) {
+		delete job;
+	}
+
+	for (auto &completion : m_completions) {
+		delete completion.request;
+	}
+}
+
+const char *ThreadPoolAsyncIO::getBackendName() const
+{
+	return "thread pool";
+}
+
+void ThreadPoolAsyncIO::enqueue(AsyncReadRequest **requests, uint64_t count)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_jobMutex);
+
+		for (int i = 0; i < count; i++) {
+			m_jobs.push_back(requests[i]);
+		}
+	}
+
+	if (count > 1) {
+		m_jobCondition.notify_all();
+	} else {
+		m_jobCondition.notify_one();
+	}
+}
+
+void ThreadPoolAsyncIO::harvest(bool wait)
+{
+	if (!wait) {
+		return; // workers push their completions directly
+	}
+
+	std::unique_lock<std::mutex> lock(m_completionMutex);
+	m_completionCondition.wait(lock, [this]() { return m_completions.size() > 0; });
+}
+
+void ThreadPoolAsyncIO::workerMain()
+{
+	cpuprofiler::setThreadName("async io");
+
+	while (true)
+	{
+		AsyncReadRequest *request = nullptr;
+
+		{
+			std::unique_lock<std::mutex> lock(m_jobMutex);
+			m_jobCondition.wait(lock, [this]() { return m_stopping || !m_jobs.empty(); });
+
+			if (m_stopping) {
+				return;
+			}
+
+			request = m_jobs.front();
+			m_jobs.pop_front();
+		}
+
+		LLT_PROFILE_SCOPE("async read");
+
+		std::ifstream file(request->path.cstr(), std::ios::binary);
+
+		if (!file.is_open())
+		{
+			complete(request, -1);
+			continue;
+		}
+
+		file.seekg(request->offset, std::ios::beg);
+		file.read((char *)request->buffer, request->length);
+
+		// hitting eof early is a short read, not a failure
+		int64_t bytesRead = file.gcount();
+
+		bool failed = file.bad() || (file.fail() && !file.eof());
+
+		complete(request, failed ? -1 : bytesRead);
+	}
+}
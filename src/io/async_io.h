@@ -0,0 +1,175 @@
+#ifndef ASYNC_IO_H_
+#define ASYNC_IO_H_
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <deque>
+
+#include "core/common.h"
+
+#include "container/vector.h"
+#include "container/string.h"
+#include "container/function.h"
+
+namespace llt
+{
+	struct AsyncReadResult
+	{
+		void *buffer;
+		uint64_t bytesRead;
+		bool success;
+		void *userData;
+	};
+
+	using AsyncReadCallback = Function<void(const AsyncReadResult &)>;
+
+	/*
+	 * Read length bytes from offset in path into buffer.
+	 * The buffer is owned by the caller and must stay alive until the callback has run.
+	 */
+	struct AsyncReadRequest
+	{
+		String path;
+		void *buffer = nullptr;
+		uint64_t offset = 0;
+		uint64_t length = 0;
+		void *userData = nullptr;
+		AsyncReadCallback callback = nullptr;
+	};
+
+	/**
+	 * Batched asynchronous file reads.
+	 * Reads happen in the background but callbacks are only ever run from poll() / waitIdle(),
+	 * so they always execute on whichever thread owns the service (the main thread for g_asyncIO).
+	 */
+	class AsyncIO
+	{
+	public:
+		/*
+		 * Picks the fastest backend available, falling back to a thread pool.
+		 * A worker count of 0 picks one based on the hardware.
+		 */
+		static AsyncIO *create(uint32_t workerCount = 0);
+
+		virtual ~AsyncIO() = default;
+
+		void submit(const AsyncReadRequest &request);
+		void submit(const Vector<AsyncReadRequest> &requests);
+
+		/*
+		 * Runs the callbacks of every read that has finished so far.
+		 * Returns the number of callbacks run.
+		 */
+		uint32_t poll();
+
+		/*
+		 * Blocks until every submitted read has completed and had its callback run.
+		 */
+		void waitIdle();
+
+		uint32_t getPendingCount() const;
+
+		virtual const char *getBackendName() const = 0;
+
+	protected:
+		AsyncIO();
+
+		struct Completion
+		{
+			AsyncReadRequest *request;
+			int64_t bytesRead; // negative on failure
+		};
+
+		/*
+		 * Queue already-copied requests with the backend. Ownership of the pointers passes to the backend,
+		 * and it must hand each one back exactly once through complete().
+		 */
+		virtual void enqueue(AsyncReadRequest **requests, uint64_t count) = 0;
+
+		/*
+		 * Gather finished reads into the completion queue, optionally blocking until at least one is available.
+		 */
+		virtual void harvest(bool wait) = 0;
+
+		void complete(AsyncReadRequest *request, int64_t bytesRead);
+
+		mutable std::mutex m_completionMutex;
+		std::condition_variable m_completionCondition;
+		Vector<Completion> m_completions;
+
+		std::atomic<uint32_t> m_pending;
+	};
+
+	/**
+	 * Portable backend: a fixed set of worker threads doing blocking reads.
+	 */
+	class ThreadPoolAsyncIO : public AsyncIO
+	{
+	public:
+		ThreadPoolAsyncIO(uint32_t workerCount);
+		~ThreadPoolAsyncIO() override;
+
+		const char *getBackendName() const override;
+
+	protected:
+		void enqueue(AsyncReadRequest **requests, uint64_t count) override;
+		void harvest(bool wait) override;
+
+	private:
+		void workerMain();
+
+		Vector<std::thread *> m_workers;
+
+		std::mutex m_jobMutex;
+		std::condition_variable m_jobCondition;
+		std::deque<AsyncReadRequest *> m_jobs;
+
+		bool m_stopping;
+	};
+
+#ifdef LLT_IO_URING
+
+	/**
+	 * Linux backend: reads are submitted straight to the kernel through io_uring,
+	 * so no threads of our own are involved at all.
+	 * Talks to the raw syscalls rather than liburing so there's nothing extra to link.
+	 */
+	class UringAsyncIO : public AsyncIO
+	{
+	public:
+		UringAsyncIO();
+		~UringAsyncIO() override;
+
+		/*
+		 * Fails if the kernel doesn't support io_uring or it's been disabled (e.g: inside some containers).
+		 */
+		bool init(uint32_t queueDepth);
+
+		const char *getBackendName() const override;
+
+	protected:
+		void enqueue(AsyncReadRequest **requests, uint64_t count) override;
+		void harvest(bool wait) override;
+
+	private:
+		struct Ring;
+		struct InFlight;
+
+		void flushQueued();
+		void destroyRing();
+
+		Ring *m_ring;
+		uint32_t m_inFlightCount;
+
+		std::deque<InFlight *> m_queued;
+		Vector<InFlight *> m_submitting; // in the order they went into the sq during the current flushQueued()
+	};
+
+#endif // LLT_IO_URING
+
+	extern AsyncIO *g_asyncIO;
+}
+
+#endif // ASYNC_IO_H_
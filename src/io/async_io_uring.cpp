@@ -0,0 +1,366 @@
+#include "async_io.h"
+
+#ifdef LLT_IO_URING
+
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+using namespace llt;
+
+struct UringAsyncIO::Ring
+{
+	int fd;
+
+	uint32_t *sqHead;
+	uint32_t *sqTail;
+	uint32_t *sqMask;
+	uint32_t *sqEntries;
+	uint32_t *sqArray;
+	io_uring_sqe *sqes;
+
+	uint32_t *cqHead;
+	uint32_t *cqTail;
+	uint32_t *cqMask;
+	uint32_t cqEntries;
+	io_uring_cqe *cqes;
+
+	void *sqRing;
+	uint64_t sqRingSize;
+
+	void *cqRing;
+	uint64_t cqRingSize;
+
+	uint64_t sqesSize;
+};
+
+struct UringAsyncIO::InFlight
+{
+	AsyncReadRequest *request;
+	int fd;
+	uint64_t done;
+	iovec iov;
+};
+
+static uint32_t loadAcquire(const uint32_t *ptr)
+{
+	return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+static void storeRelease(uint32_t *ptr, uint32_t value)
+{
+	__atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+UringAsyncIO::UringAsyncIO()
+	: AsyncIO()
+	, m_ring(nullptr)
+	, m_inFlightCount(0)
+	, m_queued()
+	, m_submitting()
+{
+}
+
+UringAsyncIO::~UringAsyncIO()
+{
+	// let the kernel finish with our buffers before they go away
+	while (m_inFlightCount > 0) {
+		harvest(true);
+	}
+
+	for (InFlight *read : m_queued)
+	{
+		::close(read->fd);
+		delete read->request;
+		delete read;
+	}
+
+	for (auto &completion : m_completions) {
+		delete completion.request;
+	}
+
+	destroyRing();
+}
+
+bool UringAsyncIO::init(uint32_t queueDepth)
+{
+	io_uring_params params = {};
+
+	int fd = syscall(__NR_io_uring_setup, queueDepth, &params);
+
+	if (fd < 0) {
+		return false;
+	}
+
+	m_ring = new Ring();
+	m_ring->fd = fd;
+	m_ring->cqEntries = params.cq_entries;
+
+	m_ring->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+	m_ring->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+	// newer kernels let both rings share a single mapping
+	bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+
+	if (singleMap)
+	{
+		if (m_ring->cqRingSize > m_ring->sqRingSize) {
+			m_ring->sqRingSize = m_ring->cqRingSize;
+		}
+
+		m_ring->cqRingSize = m_ring->sqRingSize;
+	}
+
+	m_ring->sqRing = mmap(nullptr, m_ring->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+
+	if (m_ring->sqRing == MAP_FAILED)
+	{
+		m_ring->sqRing = nullptr;
+		destroyRing();
+		return false;
+	}
+
+	if (singleMap)
+	{
+		m_ring->cqRing = m_ring->sqRing;
+	}
+	else
+	{
+		m_ring->cqRing = mmap(nullptr, m_ring->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+
+		if (m_ring->cqRing == MAP_FAILED)
+		{
+			m_ring->cqRing = nullptr;
+			destroyRing();
+			return false;
+		}
+	}
+
+	m_ring->sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+	m_ring->sqes = (io_uring_sqe *)mmap(nullptr, m_ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+
+	if (m_ring->sqes == MAP_FAILED)
+	{
+		m_ring->sqes = nullptr;
+		destroyRing();
+		return false;
+	}
+
+	byte *sq = (byte *)m_ring->sqRing;
+	byte *cq = (byte *)m_ring->cqRing;
+
+	m_ring->sqHead		= (uint32_t *)(sq + params.sq_off.head);
+	m_ring->sqTail		= (uint32_t *)(sq + params.sq_off.tail);
+	m_ring->sqMask		= (uint32_t *)(sq + params.sq_off.ring_mask);
+	m_ring->sqEntries	= (uint32_t *)(sq + params.sq_off.ring_entries);
+	m_ring->sqArray		= (uint32_t *)(sq + params.sq_off.array);
+
+	m_ring->cqHead		= (uint32_t *)(cq + params.cq_off.head);
+	m_ring->cqTail		= (uint32_t *)(cq + params.cq_off.tail);
+	m_ring->cqMask		= (uint32_t *)(cq + params.cq_off.ring_mask);
+	m_ring->cqes		= (io_uring_cqe *)(cq + params.cq_off.cqes);
+
+	return true;
+}
+
+void UringAsyncIO::destroyRing()
+{
+	if (!m_ring) {
+		return;
+	}
+
+	if (m_ring->sqes) {
+		munmap(m_ring->sqes, m_ring->sqesSize);
+	}
+
+	if (m_ring->cqRing && m_ring->cqRing != m_ring->sqRing) {
+		munmap(m_ring->cqRing, m_ring->cqRingSize);
+	}
+
+	if (m_ring->sqRing) {
+		munmap(m_ring->sqRing, m_ring->sqRingSize);
+	}
+
+	::close(m_ring->fd);
+
+	delete m_ring;
+	m_ring = nullptr;
+}
+
+const char *UringAsyncIO::getBackendName() const
+{
+	return "io_uring";
+}
+
+void UringAsyncIO::enqueue(AsyncReadRequest **requests, uint64_t count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		int fd = ::open(requests[i]->path.cstr(), O_RDONLY | O_CLOEXEC);
+
+		if (fd < 0)
+		{
+			complete(requests[i], -1);
+			continue;
+		}
+
+		InFlight *read = new InFlight();
+		read->request = requests[i];
+		read->fd = fd;
+		read->done = 0;
+
+		m_queued.push_back(read);
+	}
+
+	flushQueued();
+}
+
+void UringAsyncIO::flushQueued()
+{
+	uint32_t tail = *m_ring->sqTail;
+	uint32_t head = loadAcquire(m_ring->sqHead);
+	uint32_t submitted = 0;
+
+	// never more in flight than the completion queue can hold, kernels without IORING_FEAT_NODROP just throw the extra completions away
+	// and we'd wait on them forever, anything over stays queued until harvest() frees up room
+	while (!m_queued.empty() && (tail - head) < *m_ring->sqEntries && m_inFlightCount + submitted < m_ring->cqEntries)
+	{
+		InFlight *read = m_queued.front();
+		m_queued.pop_front();
+
+		read->iov.iov_base = (byte *)read->request->buffer + read->done;
+		read->iov.iov_len = read->request->length - read->done;
+
+		uint32_t index = tail & *m_ring->sqMask;
+
+		io_uring_sqe *sqe = &m_ring->sqes[index];
+		mem::set(sqe, 0, sizeof(io_uring_sqe));
+
+		// readv rather than read so we work on every kernel that has io_uring at all
+		sqe->opcode = IORING_OP_READV;
+		sqe->fd = read->fd;
+		sqe->addr = (uint64_t)&read->iov;
+		sqe->len = 1;
+		sqe->off = read->request->offset + read->done;
+		sqe->user_data = (uint64_t)read;
+
+		m_ring->sqArray[index] = index;
+
+		m_submitting.pushBack(read);
+
+		tail++;
+		submitted++;
+	}
+
+	if (submitted == 0) {
+		return;
+	}
+
+	storeRelease(m_ring->sqTail, tail);
+
+	int consumed = syscall(__NR_io_uring_enter, m_ring->fd, submitted, 0, 0, nullptr, 0);
+
+	while (consumed < 0 && errno == EINTR) {
+		consumed = syscall(__NR_io_uring_enter, m_ring->fd, submitted, 0, 0, nullptr, 0);
+	}
+
+	int error = consumed < 0 ? errno : 0;
+
+	if (consumed < 0) {
+		consumed = 0;
+	}
+
+	m_inFlightCount += consumed;
+
+	if ((uint32_t)consumed == submitted)
+	{
+		m_submitting.clear();
+		return;
+	}
+
+	// whatever the kernel didn't take is still sitting past its head, so pull the tail back over it
+	// (there's no sqpoll thread that could pick them up in the meantime) and deal with those reads here
+	storeRelease(m_ring->sqTail, tail - (submitted - consumed));
+
+	// out of room for now, but once something in flight completes harvest() will try these again
+	bool retry = (error == EAGAIN || error == EBUSY || error == 0) && m_inFlightCount > 0;
+
+	for (uint32_t i = submitted; i > (uint32_t)consumed; i--)
+	{
+		InFlight *read = m_submitting[i - 1];
+
+		if (retry)
+		{
+			m_queued.push_front(read);
+			continue;
+		}
+
+		::close(read->fd);
+
+		complete(read->request, -1);
+
+		delete read;
+	}
+
+	m_submitting.clear();
+}
+
+void UringAsyncIO::harvest(bool wait)
+{
+	if (wait && m_inFlightCount > 0 && loadAcquire(m_ring->cqTail) == *m_ring->cqHead)
+	{
+		int result = syscall(__NR_io_uring_enter, m_ring->fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+
+		// a signal just means nothing came back yet, any other failure falls through to whatever is already in the queue
+		while (result < 0 && errno == EINTR) {
+			result = syscall(__NR_io_uring_enter, m_ring->fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+		}
+	}
+
+	uint32_t head = *m_ring->cqHead;
+	uint32_t tail = loadAcquire(m_ring->cqTail);
+
+	while (head != tail)
+	{
+		const io_uring_cqe &cqe = m_ring->cqes[head & *m_ring->cqMask];
+		InFlight *read = (InFlight *)cqe.user_data;
+		int result = cqe.res;
+
+		head++;
+		m_inFlightCount--;
+
+		if (result == -EAGAIN || result == -EINTR)
+		{
+			m_queued.push_front(read);
+			continue;
+		}
+
+		if (result > 0)
+		{
+			read->done += result;
+
+			// short read that isn't eof yet, go again for the rest
+			if (read->done < read->request->length)
+			{
+				m_queued.push_front(read);
+				continue;
+			}
+		}
+
+		::close(read->fd);
+
+		complete(read->request, result < 0 ? -1 : (int64_t)read->done);
+
+		delete read;
+	}
+
+	storeRelease(m_ring->cqHead, head);
+
+	flushQueued();
+}
+
+#endif // LLT_IO_URING
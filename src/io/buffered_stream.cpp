@@ -0,0 +1,257 @@
+#include "buffered_stream.h"
+
+using namespace llt;
+
+BufferedStream::BufferedStream(Stream &source, uint64_t bufferSize)
+	: Stream()
+	, m_source(&source)
+	, m_buffer(bufferSize)
+	, m_bufferPosition(0)
+	, m_cursor(0)
+	, m_length(0)
+{
+	int64_t sourcePosition = source.position();
+	m_bufferPosition = sourcePosition > 0 ? sourcePosition : 0;
+
+	// only used as an "is open" marker by the base class
+	p_stream = source.getStream();
+}
+
+BufferedStream::~BufferedStream()
+{
+	close();
+}
+
+uint64_t BufferedStream::refill() const
+{
+	if (!m_source) {
+		return 0;
+	}
+
+	uint64_t unread = m_length - m_cursor;
+
+	if (m_cursor > 0)
+	{
+		if (unread > 0) {
+			mem::move(m_buffer.data(), m_buffer.data() + m_cursor, unread);
+		}
+
+		m_bufferPosition += m_cursor;
+		m_length = unread;
+		m_cursor = 0;
+	}
+
+	int64_t sourceSize = m_source->size();
+	uint64_t bufferEnd = m_bufferPosition + m_length;
+
+	if (sourceSize < 0 || bufferEnd >= sourceSize) {
+		return 0;
+	}
+
+	uint64_t sourceRemaining = sourceSize - bufferEnd;
+	uint64_t space = m_buffer.size() - m_length;
+	uint64_t count = sourceRemaining < space ? sourceRemaining : space;
+
+	if (count > 0)
+	{
+		m_source->read(m_buffer.data() + m_length, count);
+		m_length += count;
+	}
+
+	return count;
+}
+
+void BufferedStream::read(void *buffer, uint64_t length) const
+{
+	char *dst = (char *)buffer;
+
+	while (length > 0)
+	{
+		uint64_t available = m_length - m_cursor;
+
+		if (available == 0)
+		{
+			// big reads skip the buffer entirely rather than going through it in chunks
+			if (length >= m_buffer.size() && m_source)
+			{
+				m_bufferPosition += m_length;
+				m_length = 0;
+				m_cursor = 0;
+
+				uint64_t sourceRemaining = size() - position();
+				uint64_t count = length < sourceRemaining ? length : sourceRemaining;
+
+				m_source->read(dst, count);
+				m_bufferPosition += count;
+
+				return;
+			}
+
+			if (refill() == 0) {
+				return;
+			}
+
+			continue;
+		}
+
+		uint64_t count = length < available ? length : available;
+
+		mem::copy(dst, m_buffer.data() + m_cursor, count);
+
+		m_cursor += count;
+		dst += count;
+		length -= count;
+	}
+}
+
+void BufferedStream::write(void *data, uint64_t length) const
+{
+	if (!m_source) {
+		return;
+	}
+
+	// after reading, the source sits at the end of what was read ahead rather than where the caller thinks it is,
+	// so it always has to be moved back, seek() would keep it where it is if the position is still buffered
+	uint64_t writePosition = position();
+
+	m_source->seek(writePosition);
+	m_source->write(data, length);
+
+	m_bufferPosition = writePosition + length;
+	m_length = 0;
+	m_cursor = 0;
+}
+
+void BufferedStream::seek(int64_t offset) const
+{
+	if (!m_source) {
+		return;
+	}
+
+	if (offset < 0) {
+		offset = 0;
+	}
+
+	// seeking within what's already buffered doesn't need to touch the source
+	if (offset >= m_bufferPosition && offset < m_bufferPosition + m_length)
+	{
+		m_cursor = offset - m_bufferPosition;
+		return;
+	}
+
+	m_source->seek(offset);
+
+	m_bufferPosition = offset;
+	m_length = 0;
+	m_cursor = 0;
+}
+
+void BufferedStream::close()
+{
+	// we don't own the source, just detach from it
+	m_source = nullptr;
+	m_length = 0;
+	m_cursor = 0;
+
+	p_stream = nullptr;
+}
+
+int64_t BufferedStream::position() const
+{
+	return m_source ? m_bufferPosition + m_cursor : -1;
+}
+
+int64_t BufferedStream::size() const
+{
+	return m_source ? m_source->size() : -1;
+}
+
+bool BufferedStream::eof() const
+{
+	return m_cursor >= m_length && position() >= size();
+}
+
+uint8_t BufferedStream::readU8() const
+{
+	return readValue<uint8_t>();
+}
+
+uint16_t BufferedStream::readU16() const
+{
+	return readValue<uint16_t>();
+}
+
+uint32_t BufferedStream::readU32() const
+{
+	return readValue<uint32_t>();
+}
+
+uint64_t BufferedStream::readU64() const
+{
+	return readValue<uint64_t>();
+}
+
+int32_t BufferedStream::readI32() const
+{
+	return readValue<int32_t>();
+}
+
+float BufferedStream::readF32() const
+{
+	return readValue<float>();
+}
+
+double BufferedStream::readF64() const
+{
+	return readValue<double>();
+}
+
+bool BufferedStream::readLine(std::string_view &line) const
+{
+	uint64_t searchFrom = m_cursor;
+
+	while (true)
+	{
+		const char *start = m_buffer.data() + m_cursor;
+		const char *end = m_buffer.data() + m_length;
+
+		const char *newline = (const char *)mem::chr((void *)(m_buffer.data() + searchFrom), '\n', m_length - searchFrom);
+
+		if (newline)
+		{
+			uint64_t lineLength = newline - start;
+
+			if (lineLength > 0 && start[lineLength - 1] == '\r') {
+				lineLength--;
+			}
+
+			line = std::string_view(start, lineLength);
+			m_cursor = (newline - m_buffer.data()) + 1;
+
+			return true;
+		}
+
+		uint64_t scanned = end - start;
+
+		// line is bigger than the whole buffer, grow it so the view can stay contiguous
+		if (m_cursor == 0 && m_length == m_buffer.size()) {
+			m_buffer.resize(m_buffer.size() * 2);
+		}
+
+		if (refill() == 0)
+		{
+			// no newline before eof, hand back whatever's left as the last line
+			if (m_length == m_cursor) {
+				return false;
+			}
+
+			line = std::string_view(m_buffer.data() + m_cursor, m_length - m_cursor);
+			m_cursor = m_length;
+
+			return true;
+		}
+
+		// refill compacted the buffer so the unread bytes now start at 0, skip the part we already scanned
+		searchFrom = scanned;
+	}
+}
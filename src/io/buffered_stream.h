@@ -0,0 +1,103 @@
+#ifndef BUFFERED_STREAM_H_
+#define BUFFERED_STREAM_H_
+
+#include <string_view>
+
+#include "stream.h"
+
+#include "container/vector.h"
+#include "container/string.h"
+
+namespace llt
+{
+	/**
+	 * Read-ahead buffer over any other stream.
+	 * The underlying stream is only touched when the buffer runs dry, so small reads
+	 * (single values, lines) cost a memcpy rather than a platform call each.
+	 *
+	 * The source stream must outlive this and shouldn't be read from directly while wrapped.
+	 */
+	class BufferedStream : public Stream
+	{
+	public:
+		static constexpr uint64_t DEFAULT_BUFFER_SIZE = LLT_KILOBYTES(64);
+
+		BufferedStream(Stream &source, uint64_t bufferSize = DEFAULT_BUFFER_SIZE);
+		~BufferedStream() override;
+
+		void read(void *buffer, uint64_t length) const override;
+		void write(void *data, uint64_t length) const override;
+		void seek(int64_t offset) const override;
+		void close() override;
+		int64_t position() const override;
+		int64_t size() const override;
+
+		bool eof() const;
+
+		uint8_t readU8() const;
+		uint16_t readU16() const;
+		uint32_t readU32() const;
+		uint64_t readU64() const;
+		int32_t readI32() const;
+		float readF32() const;
+		double readF64() const;
+
+		/*
+		 * Reads the next line without its line ending (handles both \n and \r\n).
+		 * The returned view points into the internal buffer and is only valid until the next read.
+		 * Returns false once there's nothing left to read.
+		 */
+		bool readLine(std::string_view &line) const;
+
+		/*
+		 * Same as above but copies the line out, truncating it if it doesn't fit.
+		 */
+		template <uint64_t Size>
+		bool readLine(Str<Size> &str) const;
+
+	private:
+		template <typename T>
+		T readValue() const;
+
+		/*
+		 * Moves any unread bytes to the front of the buffer and tops it up from the source.
+		 * Returns the number of new bytes pulled in.
+		 */
+		uint64_t refill() const;
+
+		Stream *m_source;
+
+		mutable Vector<char> m_buffer;
+		mutable uint64_t m_bufferPosition; // position in the source stream of m_buffer[0]
+		mutable uint64_t m_cursor;
+		mutable uint64_t m_length;
+	};
+
+	template <uint64_t Size>
+	bool BufferedStream::readLine(Str<Size> &str) const
+	{
+		std::string_view line;
+
+		if (!readLine(line)) {
+			return false;
+		}
+
+		str.clear();
+
+		for (uint64_t i = 0; i < line.size() && i < Size - 1; i++) {
+			str.pushBack(line[i]);
+		}
+
+		return true;
+	}
+
+	template <typename T>
+	T BufferedStream::readValue() const
+	{
+		T result = {};
+		read(&result, sizeof(T));
+		return result;
+	}
+}
+
+#endif // BUFFERED_STREAM_H_
@@ -5,12 +5,12 @@
 using namespace llt;
 
 FileStream::FileStream()
-	: Stream()
+	: PlatformStream()
 {
 }
 
 FileStream::FileStream(const char *filename, const char *mode)
-	: Stream()
+	: PlatformStream()
 {
 	open(filename, mode);
 }
@@ -1,7 +1,7 @@
 #ifndef FILE_STREAM_H_
 #define FILE_STREAM_H_
 
-#include "stream.h"
+#include "platform_stream.h"
 
 #include "container/string.h"
 
@@ -10,7 +10,7 @@ namespace llt
 	/**
 	 * File-specialized stream.
 	 */
-	class FileStream : public Stream
+	class FileStream : public PlatformStream
 	{
 	public:
 		FileStream();
@@ -23,6 +23,9 @@ namespace llt
 		 * Allows for iterating through each line in a file one-by-one.
 		 * Requires a variable "pointer" to be created beforehand and referenced
 		 * to cache the current line.
+		 *
+		 * This goes to the platform for every character, so wrap the stream in a
+		 * BufferedStream and use readLine() for anything more than a few lines.
 		 */
 		bool getLine(String &str, int32_t &pointer);
 	};
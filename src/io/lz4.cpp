@@ -0,0 +1,271 @@
+#include "lz4.h"
+
+using namespace llt;
+
+static constexpr uint64_t MIN_MATCH = 4;
+static constexpr uint64_t LAST_LITERALS = 5;	// the last 5 bytes are always literals
+static constexpr uint64_t MF_LIMIT = 12;		// a match can't start within the last 12 bytes
+static constexpr uint64_t MAX_OFFSET = 65535;
+static constexpr uint64_t MAX_INPUT_SIZE = 0x7E000000;
+
+static constexpr int HASH_LOG = 16;
+static constexpr int SKIP_TRIGGER = 6;
+
+static uint32_t read32(const byte *ptr)
+{
+	uint32_t result;
+	mem::copy(&result, ptr, sizeof(uint32_t));
+	return result;
+}
+
+static uint32_t hashSequence(uint32_t sequence)
+{
+	return (sequence * 2654435761u) >> (32 - HASH_LOG);
+}
+
+static byte *writeLength(byte *op, uint64_t length)
+{
+	while (length >= 255)
+	{
+		*op++ = 255;
+		length -= 255;
+	}
+
+	*op++ = (byte)length;
+
+	return op;
+}
+
+uint64_t lz4::compressBound(uint64_t size)
+{
+	return size + (size / 255) + 16;
+}
+
+int64_t lz4::compress(const void *src, uint64_t srcSize, void *dst, uint64_t dstCapacity)
+{
+	if (srcSize > MAX_INPUT_SIZE) {
+		return -1;
+	}
+
+	const byte *input = (const byte *)src;
+	const byte *ip = input;
+	const byte *anchor = input;
+	const byte *inputEnd = input + srcSize;
+
+	byte *op = (byte *)dst;
+	byte *outputEnd = op + dstCapacity;
+
+	if (srcSize > MF_LIMIT)
+	{
+		const byte *matchLimit = inputEnd - LAST_LITERALS;
+		const byte *searchLimit = inputEnd - MF_LIMIT;
+
+		// positions are relative to the input start, zero-initialised entries just fail the match check
+		uint32_t *table = new uint32_t[1 << HASH_LOG];
+		mem::set(table, 0, sizeof(uint32_t) * (1 << HASH_LOG));
+
+		uint64_t searchCount = 1 << SKIP_TRIGGER;
+
+		while (ip < searchLimit)
+		{
+			uint32_t sequence = read32(ip);
+			uint32_t h = hashSequence(sequence);
+
+			const byte *ref = input + table[h];
+			table[h] = ip - input;
+
+			if (ref >= ip || (uint64_t)(ip - ref) > MAX_OFFSET || read32(ref) != sequence)
+			{
+				// step further ahead the longer we go without finding anything (incompressible data)
+				ip += searchCount++ >> SKIP_TRIGGER;
+				continue;
+			}
+
+			searchCount = 1 << SKIP_TRIGGER;
+
+			// catch up backwards over bytes that also match
+			while (ip > anchor && ref > input && ip[-1] == ref[-1])
+			{
+				ip--;
+				ref--;
+			}
+
+			uint64_t matchLength = MIN_MATCH;
+
+			while (ip + matchLength < matchLimit && ip[matchLength] == ref[matchLength]) {
+				matchLength++;
+			}
+
+			uint64_t literalLength = ip - anchor;
+
+			if (op + 1 + (literalLength / 255) + 1 + literalLength + 2 + (matchLength / 255) + 1 > outputEnd)
+			{
+				delete[] table;
+				return -1;
+			}
+
+			byte *token = op++;
+
+			if (literalLength >= 15)
+			{
+				*token = 15 << 4;
+				op = writeLength(op, literalLength - 15);
+			}
+			else
+			{
+				*token = literalLength << 4;
+			}
+
+			mem::copy(op, anchor, literalLength);
+			op += literalLength;
+
+			uint64_t offset = ip - ref;
+			*op++ = offset & 0xFF;
+			*op++ = (offset >> 8) & 0xFF;
+
+			uint64_t storedMatchLength = matchLength - MIN_MATCH;
+
+			if (storedMatchLength >= 15)
+			{
+				*token |= 15;
+				op = writeLength(op, storedMatchLength - 15);
+			}
+			else
+			{
+				*token |= storedMatchLength;
+			}
+
+			ip += matchLength;
+			anchor = ip;
+
+			// seed the table with a position inside the match so runs chain together better
+			if (ip - 2 < searchLimit) {
+				table[hashSequence(read32(ip - 2))] = (ip - 2) - input;
+			}
+		}
+
+		delete[] table;
+	}
+
+	// whatever is left over goes out as a final literal-only sequence
+	uint64_t literalLength = inputEnd - anchor;
+
+	if (op + 1 + (literalLength / 255) + 1 + literalLength > outputEnd) {
+		return -1;
+	}
+
+	byte *token = op++;
+
+	if (literalLength >= 15)
+	{
+		*token = 15 << 4;
+		op = writeLength(op, literalLength - 15);
+	}
+	else
+	{
+		*token = literalLength << 4;
+	}
+
+	mem::copy(op, anchor, literalLength);
+	op += literalLength;
+
+	return op - (byte *)dst;
+}
+
+int64_t lz4::decompress(const void *src, uint64_t srcSize, void *dst, uint64_t dstCapacity)
+{
+	const byte *ip = (const byte *)src;
+	const byte *inputEnd = ip + srcSize;
+
+	byte *output = (byte *)dst;
+	byte *op = output;
+	byte *outputEnd = output + dstCapacity;
+
+	while (ip < inputEnd)
+	{
+		byte token = *ip++;
+
+		uint64_t literalLength = token >> 4;
+
+		if (literalLength == 15)
+		{
+			byte b;
+
+			do
+			{
+				if (ip >= inputEnd) {
+					return -1;
+				}
+
+				b = *ip++;
+				literalLength += b;
+			}
+			while (b == 255);
+		}
+
+		if (literalLength > (uint64_t)(inputEnd - ip) || literalLength > (uint64_t)(outputEnd - op)) {
+			return -1;
+		}
+
+		mem::copy(op, ip, literalLength);
+		ip += literalLength;
+		op += literalLength;
+
+		// the last sequence has no match part
+		if (ip >= inputEnd) {
+			break;
+		}
+
+		if (inputEnd - ip < 2) {
+			return -1;
+		}
+
+		uint64_t offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+
+		if (offset == 0 || offset > (uint64_t)(op - output)) {
+			return -1;
+		}
+
+		uint64_t matchLength = token & 15;
+
+		if (matchLength == 15)
+		{
+			byte b;
+
+			do
+			{
+				if (ip >= inputEnd) {
+					return -1;
+				}
+
+				b = *ip++;
+				matchLength += b;
+			}
+			while (b == 255);
+		}
+
+		matchLength += MIN_MATCH;
+
+		if (matchLength > (uint64_t)(outputEnd - op)) {
+			return -1;
+		}
+
+		const byte *match = op - offset;
+
+		if (offset >= matchLength)
+		{
+			mem::copy(op, match, matchLength);
+			op += matchLength;
+		}
+		else
+		{
+			// overlapping copy, this is how lz4 encodes runs
+			for (uint64_t i = 0; i < matchLength; i++) {
+				*op++ = *match++;
+			}
+		}
+	}
+
+	return op - output;
+}
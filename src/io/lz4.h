@@ -0,0 +1,33 @@
+#ifndef LZ4_H_
+#define LZ4_H_
+
+#include "core/common.h"
+
+namespace llt
+{
+	/*
+	 * Small in-tree implementation of the LZ4 block format.
+	 * Output is compatible with the reference LZ4_decompress_safe / LZ4_compress_default,
+	 * there's just no frame format, streaming or high-compression mode.
+	 */
+	namespace lz4
+	{
+		/*
+		 * Worst-case compressed size for an input of the given size.
+		 */
+		uint64_t compressBound(uint64_t size);
+
+		/*
+		 * Returns the number of bytes written to dst, or -1 if it didn't fit.
+		 */
+		int64_t compress(const void *src, uint64_t srcSize, void *dst, uint64_t dstCapacity);
+
+		/*
+		 * Returns the number of bytes written to dst, or -1 if the input is malformed or dst is too small.
+		 * Never reads or writes outside of the given ranges, even for corrupt input.
+		 */
+		int64_t decompress(const void *src, uint64_t srcSize, void *dst, uint64_t dstCapacity);
+	}
+}
+
+#endif // LZ4_H_
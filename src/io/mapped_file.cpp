@@ -0,0 +1,284 @@
+#include "mapped_file.h"
+
+#include "math/calc.h"
+
+#if _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif // _WIN32
+
+using namespace llt;
+
+MappedFile::MappedFile()
+	: m_data(nullptr)
+	, m_size(0)
+	, m_fileHandle(nullptr)
+	, m_mappingHandle(nullptr)
+{
+}
+
+MappedFile::MappedFile(const String &path, MappedFileAccessHint hint)
+	: MappedFile()
+{
+	open(path, hint);
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+	: m_data(other.m_data)
+	, m_size(other.m_size)
+	, m_fileHandle(other.m_fileHandle)
+	, m_mappingHandle(other.m_mappingHandle)
+{
+	other.m_data = nullptr;
+	other.m_size = 0;
+	other.m_fileHandle = nullptr;
+	other.m_mappingHandle = nullptr;
+}
+
+MappedFile &MappedFile::operator = (MappedFile &&other) noexcept
+{
+	if (this == &other) {
+		return *this;
+	}
+
+	close();
+
+	m_data = other.m_data;
+	m_size = other.m_size;
+	m_fileHandle = other.m_fileHandle;
+	m_mappingHandle = other.m_mappingHandle;
+
+	other.m_data = nullptr;
+	other.m_size = 0;
+	other.m_fileHandle = nullptr;
+	other.m_mappingHandle = nullptr;
+
+	return *this;
+}
+
+#if _WIN32
+
+bool MappedFile::open(const String &path, MappedFileAccessHint hint)
+{
+	close();
+
+	DWORD flags = FILE_ATTRIBUTE_NORMAL;
+
+	if (hint == MAPPED_FILE_ACCESS_SEQUENTIAL) {
+		flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+	} else if (hint == MAPPED_FILE_ACCESS_RANDOM) {
+		flags |= FILE_FLAG_RANDOM_ACCESS;
+	}
+
+	HANDLE file = CreateFileA(path.cstr(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		LLT_LOG("Failed to open file for mapping: %s", path.cstr());
+		return false;
+	}
+
+	LARGE_INTEGER fileSize = {};
+	GetFileSizeEx(file, &fileSize);
+
+	// can't map an empty file, so it's treated like one that couldn't be opened
+	if (fileSize.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	if (!mapping)
+	{
+		LLT_LOG("Failed to create file mapping: %s", path.cstr());
+		CloseHandle(file);
+		return false;
+	}
+
+	void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+	if (!data)
+	{
+		LLT_LOG("Failed to map view of file: %s", path.cstr());
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	m_data = (const byte *)data;
+	m_size = fileSize.QuadPart;
+	m_fileHandle = file;
+	m_mappingHandle = mapping;
+
+	advise(0, m_size, hint);
+
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (m_data) {
+		UnmapViewOfFile(m_data);
+	}
+
+	if (m_mappingHandle) {
+		CloseHandle((HANDLE)m_mappingHandle);
+	}
+
+	if (m_fileHandle) {
+		CloseHandle((HANDLE)m_fileHandle);
+	}
+
+	m_data = nullptr;
+	m_size = 0;
+	m_fileHandle = nullptr;
+	m_mappingHandle = nullptr;
+}
+
+void MappedFile::advise(uint64_t offset, uint64_t length, MappedFileAccessHint hint) const
+{
+	if (!m_data || offset >= m_size || hint != MAPPED_FILE_ACCESS_WILLNEED) {
+		return;
+	}
+
+	WIN32_MEMORY_RANGE_ENTRY range = {};
+	range.VirtualAddress = (PVOID)(m_data + offset);
+	range.NumberOfBytes = Calc<uint64_t>::min(length, m_size - offset);
+
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+#else
+
+bool MappedFile::open(const String &path, MappedFileAccessHint hint)
+{
+	close();
+
+	int fd = ::open(path.cstr(), O_RDONLY | O_CLOEXEC);
+
+	if (fd < 0)
+	{
+		LLT_LOG("Failed to open file for mapping: %s", path.cstr());
+		return false;
+	}
+
+	struct stat st = {};
+
+	if (fstat(fd, &st) != 0)
+	{
+		LLT_LOG("Failed to stat file for mapping: %s", path.cstr());
+		::close(fd);
+		return false;
+	}
+
+	// can't map an empty file, so it's treated like one that couldn't be opened
+	if (st.st_size == 0)
+	{
+		::close(fd);
+		return false;
+	}
+
+	// the mapping keeps its own reference to the file so the descriptor isn't needed past this point
+	void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+
+	if (data == MAP_FAILED)
+	{
+		LLT_LOG("Failed to map file: %s", path.cstr());
+		return false;
+	}
+
+	m_data = (const byte *)data;
+	m_size = st.st_size;
+
+	advise(0, m_size, hint);
+
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (m_data) {
+		munmap((void *)m_data, m_size);
+	}
+
+	m_data = nullptr;
+	m_size = 0;
+}
+
+void MappedFile::advise(uint64_t offset, uint64_t length, MappedFileAccessHint hint) const
+{
+	if (!m_data || offset >= m_size) {
+		return;
+	}
+
+	int advice = MADV_NORMAL;
+
+	switch (hint)
+	{
+		case MAPPED_FILE_ACCESS_SEQUENTIAL:
+			advice = MADV_SEQUENTIAL;
+			break;
+
+		case MAPPED_FILE_ACCESS_RANDOM:
+			advice = MADV_RANDOM;
+			break;
+
+		case MAPPED_FILE_ACCESS_WILLNEED:
+			advice = MADV_WILLNEED;
+			break;
+
+		default:
+			break;
+	}
+
+	// madvise wants a page-aligned start address
+	uint64_t pageSize = sysconf(_SC_PAGESIZE);
+	uint64_t alignedOffset = offset & ~(pageSize - 1);
+	uint64_t alignedLength = Calc<uint64_t>::min(length, m_size - offset) + (offset - alignedOffset);
+
+	madvise((void *)(m_data + alignedOffset), alignedLength, advice);
+}
+
+#endif // _WIN32
+
+bool MappedFile::isOpen() const
+{
+	return m_data != nullptr;
+}
+
+const byte *MappedFile::data() const
+{
+	return m_data;
+}
+
+uint64_t MappedFile::size() const
+{
+	return m_size;
+}
+
+std::span<const byte> MappedFile::view() const
+{
+	return std::span<const byte>(m_data, m_size);
+}
+
+std::span<const byte> MappedFile::view(uint64_t offset, uint64_t length) const
+{
+	if (offset >= m_size) {
+		return std::span<const byte>();
+	}
+
+	return std::span<const byte>(m_data + offset, Calc<uint64_t>::min(length, m_size - offset));
+}
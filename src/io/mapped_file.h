@@ -0,0 +1,69 @@
+#ifndef MAPPED_FILE_H_
+#define MAPPED_FILE_H_
+
+#include <span>
+
+#include "core/common.h"
+
+#include "container/string.h"
+
+namespace llt
+{
+	enum MappedFileAccessHint
+	{
+		MAPPED_FILE_ACCESS_NORMAL,		// no hint, let the os decide
+		MAPPED_FILE_ACCESS_SEQUENTIAL,	// read front to back once (shaders, caches)
+		MAPPED_FILE_ACCESS_RANDOM,		// jump around (archives, lookup tables)
+		MAPPED_FILE_ACCESS_WILLNEED		// we're about to touch all of it, start paging in now
+	};
+
+	/**
+	 * Read-only memory mapping of an entire file.
+	 * Data is paged in by the os on demand, so nothing is copied onto the heap.
+	 */
+	class MappedFile
+	{
+	public:
+		MappedFile();
+		MappedFile(const String &path, MappedFileAccessHint hint = MAPPED_FILE_ACCESS_SEQUENTIAL);
+		~MappedFile();
+
+		MappedFile(const MappedFile &other) = delete;
+		MappedFile &operator = (const MappedFile &other) = delete;
+
+		MappedFile(MappedFile &&other) noexcept;
+		MappedFile &operator = (MappedFile &&other) noexcept;
+
+		/*
+		 * Empty files can't be mapped, so opening one fails and leaves it closed,
+		 * the same as a file that doesn't exist.
+		 */
+		bool open(const String &path, MappedFileAccessHint hint = MAPPED_FILE_ACCESS_SEQUENTIAL);
+		void close();
+
+		/*
+		 * Re-apply an access hint to a sub-range of the mapping.
+		 */
+		void advise(uint64_t offset, uint64_t length, MappedFileAccessHint hint) const;
+
+		bool isOpen() const;
+
+		const byte *data() const;
+		uint64_t size() const;
+
+		/*
+		 * Zero-copy view into the mapping, clamped to the end of the file.
+		 */
+		std::span<const byte> view() const;
+		std::span<const byte> view(uint64_t offset, uint64_t length) const;
+
+	private:
+		const byte *m_data;
+		uint64_t m_size;
+
+		void *m_fileHandle;
+		void *m_mappingHandle;
+	};
+}
+
+#endif // MAPPED_FILE_H_
@@ -5,7 +5,7 @@
 using namespace llt;
 
 MemoryStream::MemoryStream()
-	: Stream()
+	: PlatformStream()
 {
 }
 
@@ -23,7 +23,7 @@ MemoryStream &MemoryStream::open(void *memory, uint64_t length)
 /////////////////////////////////////////////////////////
 
 ConstMemoryStream::ConstMemoryStream()
-	: Stream()
+	: PlatformStream()
 {
 }
 
@@ -1,14 +1,14 @@
 #ifndef MEMORY_STREAM_H_
 #define MEMORY_STREAM_H_
 
-#include "stream.h"
+#include "platform_stream.h"
 
 namespace llt
 {
 	/**
 	 * Memory-specialized stream.
 	 */
-	class MemoryStream : public Stream
+	class MemoryStream : public PlatformStream
 	{
 	public:
 		MemoryStream();
@@ -19,7 +19,7 @@ namespace llt
 	/**
 	 * Const-memory-specialized stream.
 	 */
-	class ConstMemoryStream : public Stream
+	class ConstMemoryStream : public PlatformStream
 	{
 	public:
 		ConstMemoryStream();
@@ -0,0 +1,95 @@
+#include "mmap_stream.h"
+
+using namespace llt;
+
+MmapStream::MmapStream()
+	: Stream()
+	, m_file()
+	, m_cursor(0)
+{
+}
+
+MmapStream::MmapStream(const String &path, MappedFileAccessHint hint)
+	: Stream()
+	, m_file()
+	, m_cursor(0)
+{
+	open(path, hint);
+}
+
+MmapStream::~MmapStream()
+{
+	close();
+}
+
+MmapStream &MmapStream::open(const String &path, MappedFileAccessHint hint)
+{
+	m_file.open(path, hint);
+	m_cursor = 0;
+
+	// the base stream only uses this as an "is open" marker, we never hand it to the platform layer
+	p_stream = (void *)m_file.data();
+
+	return *this;
+}
+
+void MmapStream::read(void *buffer, uint64_t length) const
+{
+	std::span<const byte> src = consume(length);
+	mem::copy(buffer, src.data(), src.size());
+}
+
+void MmapStream::write(void *data, uint64_t length) const
+{
+	LLT_ERROR("Attempted to write to a read-only memory-mapped stream.");
+}
+
+void MmapStream::seek(int64_t offset) const
+{
+	if (offset < 0) {
+		m_cursor = 0;
+	} else if (offset > m_file.size()) {
+		m_cursor = m_file.size();
+	} else {
+		m_cursor = offset;
+	}
+}
+
+void MmapStream::close()
+{
+	m_file.close();
+	m_cursor = 0;
+	p_stream = nullptr;
+}
+
+int64_t MmapStream::position() const
+{
+	return isOpen() ? m_cursor : -1;
+}
+
+int64_t MmapStream::size() const
+{
+	return isOpen() ? m_file.size() : -1;
+}
+
+bool MmapStream::isOpen() const
+{
+	return m_file.isOpen();
+}
+
+std::span<const byte> MmapStream::peek(uint64_t length) const
+{
+	return m_file.view(m_cursor, length);
+}
+
+std::span<const byte> MmapStream::consume(uint64_t length) const
+{
+	std::span<const byte> result = m_file.view(m_cursor, length);
+	m_cursor += result.size();
+	return result;
+}
+
+const MappedFile &MmapStream::getMapping() const
+{
+	return m_file;
+}
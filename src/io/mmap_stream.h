@@ -0,0 +1,49 @@
+#ifndef MMAP_STREAM_H_
+#define MMAP_STREAM_H_
+
+#include "stream.h"
+#include "mapped_file.h"
+
+namespace llt
+{
+	/**
+	 * Read-only stream over a memory-mapped file.
+	 * read() copies out of the mapping, but peek() / view() hand out pointers straight into it.
+	 */
+	class MmapStream : public Stream
+	{
+	public:
+		MmapStream();
+		MmapStream(const String &path, MappedFileAccessHint hint = MAPPED_FILE_ACCESS_SEQUENTIAL);
+		~MmapStream() override;
+
+		MmapStream &open(const String &path, MappedFileAccessHint hint = MAPPED_FILE_ACCESS_SEQUENTIAL);
+
+		void read(void *buffer, uint64_t length) const override;
+		void write(void *data, uint64_t length) const override;
+		void seek(int64_t offset) const override;
+		void close() override;
+		int64_t position() const override;
+		int64_t size() const override;
+
+		bool isOpen() const;
+
+		/*
+		 * Returns a view of up to length bytes at the current position without advancing.
+		 */
+		std::span<const byte> peek(uint64_t length) const;
+
+		/*
+		 * Same as peek() but advances the stream past the returned bytes.
+		 */
+		std::span<const byte> consume(uint64_t length) const;
+
+		const MappedFile &getMapping() const;
+
+	private:
+		MappedFile m_file;
+		mutable uint64_t m_cursor;
+	};
+}
+
+#endif // MMAP_STREAM_H_
@@ -0,0 +1,64 @@
+#include "platform_stream.h"
+
+#include "core/platform.h"
+
+using namespace llt;
+
+PlatformStream::PlatformStream()
+	: Stream()
+{
+}
+
+PlatformStream::~PlatformStream()
+{
+	close(); // the base destructor can only reach Stream::close()
+}
+
+void PlatformStream::read(void *buffer, uint64_t length) const
+{
+	if (p_stream) {
+		g_platform->streamRead(p_stream, buffer, length);
+	}
+}
+
+void PlatformStream::write(void *data, uint64_t length) const
+{
+	if (p_stream) {
+		g_platform->streamWrite(p_stream, data, length);
+	}
+}
+
+void PlatformStream::seek(int64_t offset) const
+{
+	if (p_stream) {
+		g_platform->streamSeek(p_stream, offset);
+	}
+}
+
+void PlatformStream::close()
+{
+	if (!p_stream) {
+		return;
+	}
+
+	g_platform->streamClose(p_stream);
+	p_stream = nullptr;
+}
+
+int64_t PlatformStream::position() const
+{
+	if (p_stream) {
+		return g_platform->streamPosition(p_stream);
+	}
+
+	return -1; // stream isnt open, return -1
+}
+
+int64_t PlatformStream::size() const
+{
+	if (p_stream) {
+		return g_platform->streamSize(p_stream);
+	}
+
+	return -1; // stream isnt open, return -1
+}
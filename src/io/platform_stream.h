@@ -0,0 +1,26 @@
+#ifndef PLATFORM_STREAM_H_
+#define PLATFORM_STREAM_H_
+
+#include "stream.h"
+
+namespace llt
+{
+	/**
+	 * Stream backed by a handle from the platform layer, which is what file and memory streams open.
+	 */
+	class PlatformStream : public Stream
+	{
+	public:
+		PlatformStream();
+		~PlatformStream() override;
+
+		void read(void *buffer, uint64_t length) const override;
+		void write(void *data, uint64_t length) const override;
+		void seek(int64_t offset) const override;
+		void close() override;
+		int64_t position() const override;
+		int64_t size() const override;
+	};
+}
+
+#endif // PLATFORM_STREAM_H_
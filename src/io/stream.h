@@ -7,6 +7,8 @@ namespace llt
 {
 	/**
 	 * Representation of a generic stream of data.
+	 * On its own it's an empty stream, the subclasses decide what's actually behind it
+	 * (PlatformStream for the platform layer's file and memory streams).
 	 */
 	class Stream
 	{
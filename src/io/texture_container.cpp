@@ -0,0 +1,909 @@
+#include "texture_container.h"
+
+#include "math/calc.h"
+
+#include <fstream>
+
+using namespace llt;
+
+// ---
+// KTX2
+
+static constexpr byte KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+struct KTX2Header
+{
+	byte identifier[12];
+
+	uint32_t vkFormat;
+	uint32_t typeSize;
+	uint32_t pixelWidth;
+	uint32_t pixelHeight;
+	uint32_t pixelDepth;
+	uint32_t layerCount;
+	uint32_t faceCount;
+	uint32_t levelCount;
+	uint32_t supercompressionScheme;
+
+	uint32_t dfdByteOffset;
+	uint32_t dfdByteLength;
+	uint32_t kvdByteOffset;
+	uint32_t kvdByteLength;
+	uint64_t sgdByteOffset;
+	uint64_t sgdByteLength;
+};
+
+struct KTX2Level
+{
+	uint64_t byteOffset;
+	uint64_t byteLength;
+	uint64_t uncompressedByteLength;
+};
+
+static_assert(sizeof(KTX2Header) == 80);
+
+// data format descriptor values, only what the writer needs (khronos data format spec, section 5)
+static constexpr uint32_t KHR_DF_VERSION_NUMBER = 2;
+static constexpr uint32_t KHR_DF_MODEL_RGBSDA = 1;
+static constexpr uint32_t KHR_DF_PRIMARIES_BT709 = 1;
+static constexpr uint32_t KHR_DF_TRANSFER_LINEAR = 1;
+
+static constexpr uint32_t KHR_DF_CHANNEL_R = 0;
+static constexpr uint32_t KHR_DF_CHANNEL_G = 1;
+static constexpr uint32_t KHR_DF_CHANNEL_B = 2;
+static constexpr uint32_t KHR_DF_CHANNEL_A = 15;
+
+static constexpr uint32_t KHR_DF_QUALIFIER_EXPONENT = 0x20;
+static constexpr uint32_t KHR_DF_QUALIFIER_SIGNED = 0x40;
+static constexpr uint32_t KHR_DF_QUALIFIER_FLOAT = 0x80;
+
+static constexpr uint32_t KHR_DF_FLOAT_LOWER = 0xBF800000; // -1.0f
+static constexpr uint32_t KHR_DF_FLOAT_UPPER = 0x3F800000; // 1.0f
+
+struct KTX2Sample
+{
+	uint32_t bitOffset;
+	uint32_t bitLength;
+	uint32_t channel;
+	uint32_t lower;
+	uint32_t upper;
+};
+
+// ---
+// DDS
+
+static constexpr uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+
+static constexpr uint32_t DDPF_ALPHAPIXELS	= 0x1;
+static constexpr uint32_t DDPF_FOURCC		= 0x4;
+static constexpr uint32_t DDPF_RGB			= 0x40;
+
+static constexpr uint32_t DDSCAPS2_CUBEMAP	= 0x200;
+static constexpr uint32_t DDSCAPS2_VOLUME	= 0x200000;
+
+static constexpr uint32_t DDS_DIMENSION_TEXTURE3D = 4;
+static constexpr uint32_t DDS_MISC_TEXTURECUBE = 0x4;
+
+static constexpr uint32_t makeFourCC(char a, char b, char c, char d)
+{
+	return (uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24);
+}
+
+struct DDSPixelFormat
+{
+	uint32_t size;
+	uint32_t flags;
+	uint32_t fourCC;
+	uint32_t rgbBitCount;
+	uint32_t rBitMask;
+	uint32_t gBitMask;
+	uint32_t bBitMask;
+	uint32_t aBitMask;
+};
+
+struct DDSHeader
+{
+	uint32_t magic;
+
+	uint32_t size;
+	uint32_t flags;
+	uint32_t height;
+	uint32_t width;
+	uint32_t pitchOrLinearSize;
+	uint32_t depth;
+	uint32_t mipMapCount;
+	uint32_t reserved1[11];
+	DDSPixelFormat pixelFormat;
+	uint32_t caps;
+	uint32_t caps2;
+	uint32_t caps3;
+	uint32_t caps4;
+	uint32_t reserved2;
+};
+
+struct DDSHeaderDX10
+{
+	uint32_t dxgiFormat;
+	uint32_t resourceDimension;
+	uint32_t miscFlag;
+	uint32_t arraySize;
+	uint32_t miscFlags2;
+};
+
+static_assert(sizeof(DDSHeader) == 128);
+static_assert(sizeof(DDSHeaderDX10) == 20);
+
+/*
+ * Only the dxgi formats we can actually do something with.
+ */
+static VkFormat getFormatFromDXGI(uint32_t dxgiFormat)
+{
+	switch (dxgiFormat)
+	{
+		case 2:		return VK_FORMAT_R32G32B32A32_SFLOAT;
+		case 10:	return VK_FORMAT_R16G16B16A16_SFLOAT;
+		case 16:	return VK_FORMAT_R32G32_SFLOAT;
+		case 24:	return VK_FORMAT_A2B10G10R10_UNORM_PACK32;
+		case 26:	return VK_FORMAT_B10G11R11_UFLOAT_PACK32;
+		case 28:	return VK_FORMAT_R8G8B8A8_UNORM;
+		case 29:	return VK_FORMAT_R8G8B8A8_SRGB;
+		case 34:	return VK_FORMAT_R16G16_SFLOAT;
+		case 41:	return VK_FORMAT_R32_SFLOAT;
+		case 49:	return VK_FORMAT_R8G8_UNORM;
+		case 54:	return VK_FORMAT_R16_SFLOAT;
+		case 61:	return VK_FORMAT_R8_UNORM;
+		case 71:	return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+		case 72:	return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+		case 74:	return VK_FORMAT_BC2_UNORM_BLOCK;
+		case 75:	return VK_FORMAT_BC2_SRGB_BLOCK;
+		case 77:	return VK_FORMAT_BC3_UNORM_BLOCK;
+		case 78:	return VK_FORMAT_BC3_SRGB_BLOCK;
+		case 80:	return VK_FORMAT_BC4_UNORM_BLOCK;
+		case 81:	return VK_FORMAT_BC4_SNORM_BLOCK;
+		case 83:	return VK_FORMAT_BC5_UNORM_BLOCK;
+		case 84:	return VK_FORMAT_BC5_SNORM_BLOCK;
+		case 87:	return VK_FORMAT_B8G8R8A8_UNORM;
+		case 91:	return VK_FORMAT_B8G8R8A8_SRGB;
+		case 95:	return VK_FORMAT_BC6H_UFLOAT_BLOCK;
+		case 96:	return VK_FORMAT_BC6H_SFLOAT_BLOCK;
+		case 98:	return VK_FORMAT_BC7_UNORM_BLOCK;
+		case 99:	return VK_FORMAT_BC7_SRGB_BLOCK;
+		default:	return VK_FORMAT_UNDEFINED;
+	}
+}
+
+/*
+ * Pre-dx10 headers describe the format with a fourcc or with channel masks.
+ */
+static VkFormat getFormatFromLegacyDDS(const DDSPixelFormat &pixelFormat)
+{
+	if (pixelFormat.flags & DDPF_FOURCC)
+	{
+		switch (pixelFormat.fourCC)
+		{
+			case makeFourCC('D', 'X', 'T', '1'):	return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+			case makeFourCC('D', 'X', 'T', '3'):	return VK_FORMAT_BC2_UNORM_BLOCK;
+			case makeFourCC('D', 'X', 'T', '5'):	return VK_FORMAT_BC3_UNORM_BLOCK;
+			case makeFourCC('A', 'T', 'I', '1'):	return VK_FORMAT_BC4_UNORM_BLOCK;
+			case makeFourCC('B', 'C', '4', 'U'):	return VK_FORMAT_BC4_UNORM_BLOCK;
+			case makeFourCC('A', 'T', 'I', '2'):	return VK_FORMAT_BC5_UNORM_BLOCK;
+			case makeFourCC('B', 'C', '5', 'U'):	return VK_FORMAT_BC5_UNORM_BLOCK;
+			case 113:								return VK_FORMAT_R16G16B16A16_SFLOAT; // D3DFMT_A16B16G16R16F
+			case 116:								return VK_FORMAT_R32G32B32A32_SFLOAT; // D3DFMT_A32B32G32R32F
+			default:								return VK_FORMAT_UNDEFINED;
+		}
+	}
+
+	if ((pixelFormat.flags & DDPF_RGB) && pixelFormat.rgbBitCount == 32)
+	{
+		bool hasAlpha = (pixelFormat.flags & DDPF_ALPHAPIXELS) != 0;
+
+		if (pixelFormat.rBitMask == 0x000000FF && pixelFormat.gBitMask == 0x0000FF00 && pixelFormat.bBitMask == 0x00FF0000) {
+			return hasAlpha ? VK_FORMAT_R8G8B8A8_UNORM : VK_FORMAT_UNDEFINED;
+		}
+
+		if (pixelFormat.rBitMask == 0x00FF0000 && pixelFormat.gBitMask == 0x0000FF00 && pixelFormat.bBitMask == 0x000000FF) {
+			return hasAlpha ? VK_FORMAT_B8G8R8A8_UNORM : VK_FORMAT_UNDEFINED;
+		}
+	}
+
+	return VK_FORMAT_UNDEFINED;
+}
+
+/*
+ * Size of one block (or texel, for uncompressed formats) of every format getFormatFromXXX can return.
+ * Doubles as the list of formats we accept from a KTX2 file.
+ */
+static bool getFormatBlockInfo(VkFormat format, uint32_t *blockBytes, uint32_t *blockDim)
+{
+	*blockDim = 1;
+
+	switch (format)
+	{
+		case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+		case VK_FORMAT_BC4_UNORM_BLOCK:
+		case VK_FORMAT_BC4_SNORM_BLOCK:
+			*blockBytes = 8;
+			*blockDim = 4;
+			return true;
+
+		case VK_FORMAT_BC2_UNORM_BLOCK:
+		case VK_FORMAT_BC2_SRGB_BLOCK:
+		case VK_FORMAT_BC3_UNORM_BLOCK:
+		case VK_FORMAT_BC3_SRGB_BLOCK:
+		case VK_FORMAT_BC5_UNORM_BLOCK:
+		case VK_FORMAT_BC5_SNORM_BLOCK:
+		case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+		case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+		case VK_FORMAT_BC7_UNORM_BLOCK:
+		case VK_FORMAT_BC7_SRGB_BLOCK:
+			*blockBytes = 16;
+			*blockDim = 4;
+			return true;
+
+		case VK_FORMAT_R8_UNORM:
+			*blockBytes = 1;
+			return true;
+
+		case VK_FORMAT_R8G8_UNORM:
+		case VK_FORMAT_R16_SFLOAT:
+			*blockBytes = 2;
+			return true;
+
+		case VK_FORMAT_R8G8B8A8_UNORM:
+		case VK_FORMAT_R8G8B8A8_SRGB:
+		case VK_FORMAT_B8G8R8A8_UNORM:
+		case VK_FORMAT_B8G8R8A8_SRGB:
+		case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+		case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+		case VK_FORMAT_R16G16_SFLOAT:
+		case VK_FORMAT_R32_SFLOAT:
+		case VK_FORMAT_E5B9G9R9_UFLOAT_PACK32:
+			*blockBytes = 4;
+			return true;
+
+		case VK_FORMAT_R16G16B16A16_SFLOAT:
+		case VK_FORMAT_R32G32_SFLOAT:
+			*blockBytes = 8;
+			return true;
+
+		case VK_FORMAT_R32G32B32A32_SFLOAT:
+			*blockBytes = 16;
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+// the most array layers any desktop driver reports for maxImageArrayLayers, more than that couldn't be uploaded anyway
+static constexpr uint32_t MAX_ARRAY_LAYERS = 2048;
+
+/*
+ * Length of the full mip chain for an image this size, anything past it would be smaller than a texel.
+ */
+static uint32_t getMaxMipCount(uint32_t width, uint32_t height)
+{
+	uint32_t size = CalcU::max(width, height);
+	uint32_t count = 1;
+
+	while (size > 1)
+	{
+		size >>= 1;
+		count++;
+	}
+
+	return count;
+}
+
+TextureContainer::TextureContainer()
+	: m_file()
+	, m_type(TEXTURE_CONTAINER_TYPE_NONE)
+	, m_format(VK_FORMAT_UNDEFINED)
+	, m_width(0)
+	, m_height(0)
+	, m_mipCount(0)
+	, m_layerCount(0)
+	, m_faceCount(0)
+	, m_keyValueOffset(0)
+	, m_keyValueSize(0)
+	, m_subresources()
+{
+}
+
+TextureContainerType TextureContainer::getTypeFromPath(const String &path)
+{
+	if (path.endsWith(".ktx2")) {
+		return TEXTURE_CONTAINER_TYPE_KTX2;
+	}
+
+	if (path.endsWith(".dds")) {
+		return TEXTURE_CONTAINER_TYPE_DDS;
+	}
+
+	return TEXTURE_CONTAINER_TYPE_NONE;
+}
+
+bool TextureContainer::load(const String &path)
+{
+	m_type = getTypeFromPath(path);
+
+	if (m_type == TEXTURE_CONTAINER_TYPE_NONE) {
+		return false;
+	}
+
+	m_file = g_vfs->open(path);
+
+	if (!m_file.isOpen()) {
+		return false;
+	}
+
+	bool valid = (m_type == TEXTURE_CONTAINER_TYPE_KTX2) ? parseKTX2(path) : parseDDS(path);
+
+	if (!valid)
+	{
+		m_file = VfsFile();
+		m_subresources.clear();
+
+		return false;
+	}
+
+	return true;
+}
+
+bool TextureContainer::parseKTX2(const String &path)
+{
+	if (m_file.size() < sizeof(KTX2Header))
+	{
+		LLT_LOG("KTX2 file is too small to be valid: %s", path.cstr());
+		return false;
+	}
+
+	const KTX2Header *header = (const KTX2Header *)m_file.data();
+
+	if (mem::compare(header->identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0)
+	{
+		LLT_LOG("KTX2 file has an invalid identifier: %s", path.cstr());
+		return false;
+	}
+
+	if (header->supercompressionScheme != 0 || header->vkFormat == VK_FORMAT_UNDEFINED)
+	{
+		LLT_LOG("Supercompressed KTX2 files aren't supported: %s", path.cstr());
+		return false;
+	}
+
+	if (header->pixelDepth > 1)
+	{
+		LLT_LOG("3D KTX2 textures aren't supported: %s", path.cstr());
+		return false;
+	}
+
+	uint32_t blockBytes = 0;
+	uint32_t blockDim = 0;
+
+	if (!getFormatBlockInfo((VkFormat)header->vkFormat, &blockBytes, &blockDim))
+	{
+		LLT_LOG("KTX2 file has an unsupported format: %s", path.cstr());
+		return false;
+	}
+
+	if (header->pixelWidth == 0)
+	{
+		LLT_LOG("KTX2 file has no width: %s", path.cstr());
+		return false;
+	}
+
+	// a level count of 0 asks us to generate the mips, which is exactly what we're trying to avoid, so just take the base level
+	uint32_t levelCount = CalcU::clamp(header->levelCount, 1, getMaxMipCount(header->pixelWidth, header->pixelHeight));
+
+	if (sizeof(KTX2Header) + sizeof(KTX2Level) * levelCount > m_file.size())
+	{
+		LLT_LOG("KTX2 level index is truncated: %s", path.cstr());
+		return false;
+	}
+
+	m_format = (VkFormat)header->vkFormat;
+	m_width = header->pixelWidth;
+	m_height = CalcU::max(header->pixelHeight, 1);
+
+	if ((uint64_t)header->kvdByteOffset + header->kvdByteLength <= m_file.size())
+	{
+		m_keyValueOffset = header->kvdByteOffset;
+		m_keyValueSize = header->kvdByteLength;
+	}
+
+	if (!initSubresources(levelCount, CalcU::max(header->layerCount, 1), header->faceCount == 6 ? 6 : 1))
+	{
+		LLT_LOG("KTX2 file has more layers than it could hold (%u): %s", header->layerCount, path.cstr());
+		return false;
+	}
+
+	const KTX2Level *levels = (const KTX2Level *)(m_file.data() + sizeof(KTX2Header));
+
+	for (int mip = 0; mip < m_mipCount; mip++)
+	{
+		// each level holds every layer, and every face of each layer, back to back
+		uint64_t imageCount = (uint64_t)m_layerCount * m_faceCount;
+		uint64_t imageSize = levels[mip].byteLength / imageCount;
+
+		uint64_t blocksWide = (CalcU::max(m_width >> mip, 1) + blockDim - 1) / blockDim;
+		uint64_t blocksHigh = (CalcU::max(m_height >> mip, 1) + blockDim - 1) / blockDim;
+
+		// the upload copies a whole level's worth of blocks, so a short one would read past the image
+		if (imageSize < blocksWide * blocksHigh * blockBytes)
+		{
+			LLT_LOG("KTX2 level %d is smaller than its format needs: %s", mip, path.cstr());
+			return false;
+		}
+
+		for (int layer = 0; layer < m_layerCount; layer++)
+		{
+			for (int face = 0; face < m_faceCount; face++)
+			{
+				uint64_t offset = levels[mip].byteOffset + imageSize * (layer * m_faceCount + face);
+
+				if (!setSubresource(mip, layer, face, offset, imageSize))
+				{
+					LLT_LOG("KTX2 level %d points outside of the file: %s", mip, path.cstr());
+					return false;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+bool TextureContainer::parseDDS(const String &path)
+{
+	if (m_file.size() < sizeof(DDSHeader))
+	{
+		LLT_LOG("DDS file is too small to be valid: %s", path.cstr());
+		return false;
+	}
+
+	const DDSHeader *header = (const DDSHeader *)m_file.data();
+
+	if (header->magic != DDS_MAGIC || header->size != sizeof(DDSHeader) - sizeof(uint32_t))
+	{
+		LLT_LOG("DDS file has an invalid header: %s", path.cstr());
+		return false;
+	}
+
+	uint64_t dataOffset = sizeof(DDSHeader);
+
+	uint32_t layerCount = 1;
+	uint32_t faceCount = 1;
+
+	bool hasDX10Header = (header->pixelFormat.flags & DDPF_FOURCC) && header->pixelFormat.fourCC == makeFourCC('D', 'X', '1', '0');
+
+	if (hasDX10Header)
+	{
+		if (m_file.size() < sizeof(DDSHeader) + sizeof(DDSHeaderDX10))
+		{
+			LLT_LOG("DDS file is missing its DX10 header: %s", path.cstr());
+			return false;
+		}
+
+		const DDSHeaderDX10 *dx10 = (const DDSHeaderDX10 *)(m_file.data() + sizeof(DDSHeader));
+
+		if (dx10->resourceDimension == DDS_DIMENSION_TEXTURE3D)
+		{
+			LLT_LOG("3D DDS textures aren't supported: %s", path.cstr());
+			return false;
+		}
+
+		m_format = getFormatFromDXGI(dx10->dxgiFormat);
+
+		layerCount = CalcU::max(dx10->arraySize, 1);
+		faceCount = (dx10->miscFlag & DDS_MISC_TEXTURECUBE) ? 6 : 1;
+
+		dataOffset += sizeof(DDSHeaderDX10);
+	}
+	else
+	{
+		if (header->caps2 & DDSCAPS2_VOLUME)
+		{
+			LLT_LOG("3D DDS textures aren't supported: %s", path.cstr());
+			return false;
+		}
+
+		m_format = getFormatFromLegacyDDS(header->pixelFormat);
+
+		// legacy cubemaps can technically leave faces out, but nothing we'd load does
+		faceCount = (header->caps2 & DDSCAPS2_CUBEMAP) ? 6 : 1;
+	}
+
+	uint32_t blockBytes = 0;
+	uint32_t blockDim = 0;
+
+	if (!getFormatBlockInfo(m_format, &blockBytes, &blockDim))
+	{
+		LLT_LOG("DDS file has an unsupported pixel format: %s", path.cstr());
+		return false;
+	}
+
+	if (header->width == 0 || header->height == 0)
+	{
+		LLT_LOG("DDS file has no size: %s", path.cstr());
+		return false;
+	}
+
+	m_width = header->width;
+	m_height = header->height;
+
+	// past the end of the chain the shifts below would run off the width and height entirely
+	if (!initSubresources(CalcU::clamp(header->mipMapCount, 1, getMaxMipCount(m_width, m_height)), layerCount, faceCount))
+	{
+		LLT_LOG("DDS file has more array layers than it could hold (%u): %s", layerCount, path.cstr());
+		return false;
+	}
+
+	// unlike ktx2, dds stores every mip of one image before moving onto the next
+	uint64_t offset = dataOffset;
+
+	for (int layer = 0; layer < m_layerCount; layer++)
+	{
+		for (int face = 0; face < m_faceCount; face++)
+		{
+			for (int mip = 0; mip < m_mipCount; mip++)
+			{
+				uint32_t width = CalcU::max(m_width >> mip, 1);
+				uint32_t height = CalcU::max(m_height >> mip, 1);
+
+				uint64_t blocksWide = (width + blockDim - 1) / blockDim;
+				uint64_t blocksHigh = (height + blockDim - 1) / blockDim;
+
+				uint64_t size = blocksWide * blocksHigh * blockBytes;
+
+				if (!setSubresource(mip, layer, face, offset, size))
+				{
+					LLT_LOG("DDS file is truncated: %s", path.cstr());
+					return false;
+				}
+
+				offset += size;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool TextureContainer::initSubresources(uint32_t mipCount, uint32_t layerCount, uint32_t faceCount)
+{
+	// the layer count comes straight from the file, so check it before it sizes anything
+	if (layerCount > MAX_ARRAY_LAYERS) {
+		return false;
+	}
+
+	uint64_t subresourceCount = (uint64_t)mipCount * layerCount * faceCount;
+
+	// every subresource takes up at least a byte of the file, so a header asking for more is lying
+	if (subresourceCount > m_file.size()) {
+		return false;
+	}
+
+	m_mipCount = mipCount;
+	m_layerCount = layerCount;
+	m_faceCount = faceCount;
+
+	m_subresources.clear();
+	m_subresources.resize(subresourceCount);
+
+	return true;
+}
+
+bool TextureContainer::setSubresource(uint32_t mip, uint32_t layer, uint32_t face, uint64_t offset, uint64_t size)
+{
+	// written so a huge offset from the file can't wrap around
+	if (size == 0 || offset > m_file.size() || size > m_file.size() - offset) {
+		return false;
+	}
+
+	TextureContainerSubresource &subresource = m_subresources[(mip * m_layerCount + layer) * m_faceCount + face];
+
+	subresource.offset = offset;
+	subresource.size = size;
+	subresource.width = CalcU::max(m_width >> mip, 1);
+	subresource.height = CalcU::max(m_height >> mip, 1);
+
+	return true;
+}
+
+TextureContainerType TextureContainer::getType() const
+{
+	return m_type;
+}
+
+VkFormat TextureContainer::getFormat() const
+{
+	return m_format;
+}
+
+uint32_t TextureContainer::getWidth() const
+{
+	return m_width;
+}
+
+uint32_t TextureContainer::getHeight() const
+{
+	return m_height;
+}
+
+uint32_t TextureContainer::getMipCount() const
+{
+	return m_mipCount;
+}
+
+uint32_t TextureContainer::getLayerCount() const
+{
+	return m_layerCount;
+}
+
+uint32_t TextureContainer::getFaceCount() const
+{
+	return m_faceCount;
+}
+
+bool TextureContainer::isCubemap() const
+{
+	return m_faceCount == 6;
+}
+
+const TextureContainerSubresource &TextureContainer::getSubresource(uint32_t mip, uint32_t layer, uint32_t face) const
+{
+	return m_subresources[(mip * m_layerCount + layer) * m_faceCount + face];
+}
+
+const char *TextureContainer::getKeyValue(const char *key) const
+{
+	uint64_t keyLength = cstr::length(key);
+
+	uint64_t offset = m_keyValueOffset;
+	uint64_t end = m_keyValueOffset + m_keyValueSize;
+
+	// every entry is a length, then the key and value (both null-terminated here), padded out to 4 bytes
+	while (offset + sizeof(uint32_t) <= end)
+	{
+		uint32_t entrySize = 0;
+		mem::copy(&entrySize, m_file.data() + offset, sizeof(uint32_t));
+
+		const char *entry = (const char *)(m_file.data() + offset + sizeof(uint32_t));
+		uint64_t entryEnd = offset + sizeof(uint32_t) + entrySize;
+
+		if (entryEnd > end) {
+			break;
+		}
+
+		if (entrySize > keyLength + 1 && mem::compare(entry, key, keyLength + 1) == 0 && entry[entrySize - 1] == '\0') {
+			return entry + keyLength + 1;
+		}
+
+		offset = (entryEnd + 3) & ~3ull;
+	}
+
+	return nullptr;
+}
+
+const byte *TextureContainer::getData() const
+{
+	return m_file.data();
+}
+
+uint64_t TextureContainer::getSize() const
+{
+	return m_file.size();
+}
+
+// ---
+
+TextureContainerWriter::TextureContainerWriter()
+	: m_format(VK_FORMAT_UNDEFINED)
+	, m_width(0)
+	, m_height(0)
+	, m_mipCount(0)
+	, m_faceCount(0)
+	, m_keyValueData()
+	, m_levels()
+{
+}
+
+uint32_t TextureContainerWriter::getTexelSize(VkFormat format)
+{
+	switch (format)
+	{
+		case VK_FORMAT_R32G32B32A32_SFLOAT:
+			return 16;
+
+		case VK_FORMAT_R16G16B16A16_SFLOAT:
+		case VK_FORMAT_R32G32_SFLOAT:
+			return 8;
+
+		case VK_FORMAT_E5B9G9R9_UFLOAT_PACK32:
+			return 4;
+
+		default:
+			return 0;
+	}
+}
+
+bool TextureContainerWriter::init(VkFormat format, uint32_t width, uint32_t height, uint32_t mipCount, uint32_t faceCount)
+{
+	if (getTexelSize(format) == 0)
+	{
+		LLT_LOG("Can't write KTX2 files with format %d", format);
+		return false;
+	}
+
+	m_format = format;
+	m_width = width;
+	m_height = height;
+	m_mipCount = CalcU::max(mipCount, 1);
+	m_faceCount = faceCount == 6 ? 6 : 1;
+
+	m_keyValueData.clear();
+
+	m_levels.clear();
+	m_levels.resize(m_mipCount);
+
+	for (int mip = 0; mip < m_mipCount; mip++)
+	{
+		uint64_t w = CalcU::max(m_width >> mip, 1);
+		uint64_t h = CalcU::max(m_height >> mip, 1);
+
+		m_levels[mip].resize(w * h * getTexelSize(format) * m_faceCount);
+	}
+
+	return true;
+}
+
+void TextureContainerWriter::addKeyValue(const char *key, const char *value)
+{
+	uint64_t keySize = cstr::length(key) + 1;
+	uint64_t valueSize = cstr::length(value) + 1;
+
+	uint32_t entrySize = keySize + valueSize;
+
+	uint64_t offset = m_keyValueData.size();
+	uint64_t paddedSize = (sizeof(uint32_t) + entrySize + 3) & ~3ull;
+
+	m_keyValueData.resize(offset + paddedSize);
+	mem::set(m_keyValueData.data() + offset, 0, paddedSize);
+
+	mem::copy(m_keyValueData.data() + offset, &entrySize, sizeof(uint32_t));
+	mem::copy(m_keyValueData.data() + offset + sizeof(uint32_t), key, keySize);
+	mem::copy(m_keyValueData.data() + offset + sizeof(uint32_t) + keySize, value, valueSize);
+}
+
+void TextureContainerWriter::setSubresource(uint32_t mip, uint32_t face, const void *data, uint64_t size)
+{
+	uint64_t imageSize = m_levels[mip].size() / m_faceCount;
+
+	LLT_ASSERT(size == imageSize, "Subresource is the wrong size for its mip.");
+
+	mem::copy(m_levels[mip].data() + imageSize * face, data, imageSize);
+}
+
+bool TextureContainerWriter::save(const String &path) const
+{
+	uint32_t texelSize = getTexelSize(m_format);
+
+	Vector<KTX2Sample> samples;
+
+	if (m_format == VK_FORMAT_E5B9G9R9_UFLOAT_PACK32)
+	{
+		const uint32_t channels[3] = { KHR_DF_CHANNEL_R, KHR_DF_CHANNEL_G, KHR_DF_CHANNEL_B };
+
+		for (int i = 0; i < 3; i++)
+		{
+			samples.pushBack({ 9u * i, 9, channels[i], 0, 8448 });
+			samples.pushBack({ 27, 5, channels[i] | (KHR_DF_QUALIFIER_EXPONENT << 24), 15, 31 });
+		}
+	}
+	else
+	{
+		uint32_t channelCount = m_format == VK_FORMAT_R32G32_SFLOAT ? 2 : 4;
+		uint32_t channelBits = (texelSize * 8) / channelCount;
+
+		const uint32_t channels[4] = { KHR_DF_CHANNEL_R, KHR_DF_CHANNEL_G, KHR_DF_CHANNEL_B, KHR_DF_CHANNEL_A };
+
+		for (int i = 0; i < channelCount; i++)
+		{
+			uint32_t qualifiers = (KHR_DF_QUALIFIER_FLOAT | KHR_DF_QUALIFIER_SIGNED) << 24;
+			samples.pushBack({ channelBits * i, channelBits, channels[i] | qualifiers, KHR_DF_FLOAT_LOWER, KHR_DF_FLOAT_UPPER });
+		}
+	}
+
+	// total size, then one basic descriptor block: 6 words of header and 4 per sample
+	Vector<uint32_t> dfd;
+
+	uint32_t blockSize = (6 + 4 * samples.size()) * sizeof(uint32_t);
+
+	dfd.pushBack(blockSize + sizeof(uint32_t));
+	dfd.pushBack(0); // khronos vendor, basic descriptor type
+	dfd.pushBack(KHR_DF_VERSION_NUMBER | (blockSize << 16));
+	dfd.pushBack(KHR_DF_MODEL_RGBSDA | (KHR_DF_PRIMARIES_BT709 << 8) | (KHR_DF_TRANSFER_LINEAR << 16));
+	dfd.pushBack(0); // 1x1x1 texel blocks
+	dfd.pushBack(texelSize);
+	dfd.pushBack(0);
+
+	for (auto &sample : samples)
+	{
+		dfd.pushBack(sample.bitOffset | ((sample.bitLength - 1) << 16) | (sample.channel << 24));
+		dfd.pushBack(0);
+		dfd.pushBack(sample.lower);
+		dfd.pushBack(sample.upper);
+	}
+
+	uint64_t dfdOffset = sizeof(KTX2Header) + sizeof(KTX2Level) * m_mipCount;
+	uint64_t dfdSize = dfd.size() * sizeof(uint32_t);
+
+	uint64_t kvdOffset = dfdOffset + dfdSize;
+	uint64_t kvdSize = m_keyValueData.size();
+
+	// levels have to start on a multiple of the texel size (and of 4), and go smallest first
+	uint64_t alignment = CalcU::max(texelSize, 4);
+
+	Vector<KTX2Level> levels(m_mipCount);
+
+	uint64_t offset = kvdOffset + kvdSize;
+
+	for (int mip = (int)m_mipCount - 1; mip >= 0; mip--)
+	{
+		offset = (offset + alignment - 1) & ~(alignment - 1);
+
+		levels[mip].byteOffset = offset;
+		levels[mip].byteLength = m_levels[mip].size();
+		levels[mip].uncompressedByteLength = m_levels[mip].size();
+
+		offset += m_levels[mip].size();
+	}
+
+	KTX2Header header = {};
+	mem::copy(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER));
+	header.vkFormat = m_format;
+	header.typeSize = m_format == VK_FORMAT_R16G16B16A16_SFLOAT ? 2 : 4;
+	header.pixelWidth = m_width;
+	header.pixelHeight = m_height;
+	header.pixelDepth = 0;
+	header.layerCount = 0;
+	header.faceCount = m_faceCount;
+	header.levelCount = m_mipCount;
+	header.supercompressionScheme = 0;
+	header.dfdByteOffset = dfdOffset;
+	header.dfdByteLength = dfdSize;
+	header.kvdByteOffset = kvdSize > 0 ? kvdOffset : 0;
+	header.kvdByteLength = kvdSize;
+	header.sgdByteOffset = 0;
+	header.sgdByteLength = 0;
+
+	Vector<byte> data(offset);
+	mem::set(data.data(), 0, data.size());
+
+	mem::copy(data.data(), &header, sizeof(KTX2Header));
+	mem::copy(data.data() + sizeof(KTX2Header), levels.data(), sizeof(KTX2Level) * m_mipCount);
+	mem::copy(data.data() + dfdOffset, dfd.data(), dfdSize);
+
+	if (kvdSize > 0) {
+		mem::copy(data.data() + kvdOffset, m_keyValueData.data(), kvdSize);
+	}
+
+	for (int mip = 0; mip < m_mipCount; mip++) {
+		mem::copy(data.data() + levels[mip].byteOffset, m_levels[mip].data(), m_levels[mip].size());
+	}
+
+	std::ofstream file(path.cstr(), std::ios::binary | std::ios::trunc);
+
+	if (!file.is_open())
+	{
+		LLT_LOG("Failed to open KTX2 file for writing: %s", path.cstr());
+		return false;
+	}
+
+	file.write((const char *)data.data(), data.size());
+
+	return file.good();
+}
@@ -0,0 +1,155 @@
+#ifndef TEXTURE_CONTAINER_H_
+#define TEXTURE_CONTAINER_H_
+
+#include "third_party/volk.h"
+
+#include "core/common.h"
+
+#include "container/vector.h"
+#include "container/string.h"
+
+#include "vfs.h"
+
+namespace llt
+{
+	enum TextureContainerType
+	{
+		TEXTURE_CONTAINER_TYPE_NONE,
+		TEXTURE_CONTAINER_TYPE_KTX2,
+		TEXTURE_CONTAINER_TYPE_DDS,
+		TEXTURE_CONTAINER_TYPE_MAX_ENUM
+	};
+
+	/*
+	 * Where one mip of one layer / face lives inside the container.
+	 */
+	struct TextureContainerSubresource
+	{
+		uint64_t offset;
+		uint64_t size;
+
+		uint32_t width;
+		uint32_t height;
+	};
+
+	/**
+	 * Reads pre-built textures out of KTX2 and DDS files.
+	 *
+	 * Unlike Image this keeps everything as it's stored: the native VkFormat, every mip level
+	 * and every array layer / cube face, so the whole thing can be copied to the gpu without
+	 * being touched on the cpu. Supercompressed (basis / zstd) KTX2 files aren't supported.
+	 */
+	class TextureContainer
+	{
+	public:
+		TextureContainer();
+		~TextureContainer() = default;
+
+		static TextureContainerType getTypeFromPath(const String &path);
+
+		/*
+		 * Opened through the vfs and kept open, so subresources point straight into the file.
+		 */
+		bool load(const String &path);
+
+		TextureContainerType getType() const;
+		VkFormat getFormat() const;
+
+		uint32_t getWidth() const;
+		uint32_t getHeight() const;
+
+		uint32_t getMipCount() const;
+		uint32_t getLayerCount() const;
+		uint32_t getFaceCount() const;
+
+		bool isCubemap() const;
+
+		const TextureContainerSubresource &getSubresource(uint32_t mip, uint32_t layer, uint32_t face) const;
+
+		/*
+		 * Value stored under a key in a KTX2 file's key/value data, or nullptr if it isn't there.
+		 * Values are expected to be null-terminated strings.
+		 */
+		const char *getKeyValue(const char *key) const;
+
+		/*
+		 * Subresource offsets are relative to this.
+		 */
+		const byte *getData() const;
+		uint64_t getSize() const;
+
+	private:
+		bool parseKTX2(const String &path);
+		bool parseDDS(const String &path);
+
+		/*
+		 * Sets up the subresource table once the dimensions are known.
+		 * Fails if the counts are more than the file could possibly hold.
+		 */
+		bool initSubresources(uint32_t mipCount, uint32_t layerCount, uint32_t faceCount);
+		bool setSubresource(uint32_t mip, uint32_t layer, uint32_t face, uint64_t offset, uint64_t size);
+
+		VfsFile m_file;
+
+		TextureContainerType m_type;
+		VkFormat m_format;
+
+		uint32_t m_width;
+		uint32_t m_height;
+
+		uint32_t m_mipCount;
+		uint32_t m_layerCount;
+		uint32_t m_faceCount;
+
+		uint64_t m_keyValueOffset;
+		uint64_t m_keyValueSize;
+
+		// ordered mip-major, then layer, then face
+		Vector<TextureContainerSubresource> m_subresources;
+	};
+
+	/**
+	 * Writes uncompressed textures out as KTX2 files that TextureContainer can read back.
+	 *
+	 * Only covers the handful of float formats we bake at runtime, and only single layer
+	 * 2d textures or cubemaps.
+	 */
+	class TextureContainerWriter
+	{
+	public:
+		TextureContainerWriter();
+		~TextureContainerWriter() = default;
+
+		/*
+		 * Bytes per texel, or 0 if the format can't be written.
+		 */
+		static uint32_t getTexelSize(VkFormat format);
+
+		bool init(VkFormat format, uint32_t width, uint32_t height, uint32_t mipCount, uint32_t faceCount);
+
+		/*
+		 * KTX2 wants these sorted by key, so they have to be added in order.
+		 */
+		void addKeyValue(const char *key, const char *value);
+
+		void setSubresource(uint32_t mip, uint32_t face, const void *data, uint64_t size);
+
+		bool save(const String &path) const;
+
+	private:
+		VkFormat m_format;
+
+		uint32_t m_width;
+		uint32_t m_height;
+
+		uint32_t m_mipCount;
+		uint32_t m_faceCount;
+
+		Vector<byte> m_keyValueData;
+
+		// one per mip, every face back to back
+		Vector<Vector<byte>> m_levels;
+	};
+}
+
+#endif // TEXTURE_CONTAINER_H_
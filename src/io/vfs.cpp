@@ -0,0 +1,208 @@
+#include "vfs.h"
+
+#include <filesystem>
+
+llt::VirtualFileSystem *llt::g_vfs = nullptr;
+
+using namespace llt;
+
+VfsFile::VfsFile()
+	: m_mapping()
+	, m_buffer()
+	, m_data(nullptr)
+	, m_size(0)
+	, m_open(false)
+	, m_fromArchive(false)
+{
+}
+
+bool VfsFile::isOpen() const
+{
+	return m_open;
+}
+
+bool VfsFile::isFromArchive() const
+{
+	return m_fromArchive;
+}
+
+const byte *VfsFile::data() const
+{
+	return m_data;
+}
+
+uint64_t VfsFile::size() const
+{
+	return m_size;
+}
+
+std::span<const byte> VfsFile::view() const
+{
+	return std::span<const byte>(m_data, m_size);
+}
+
+// ---
+
+VirtualFileSystem::VirtualFileSystem()
+	: m_mounts()
+{
+}
+
+VirtualFileSystem::~VirtualFileSystem()
+{
+	unmountAll();
+}
+
+bool VirtualFileSystem::mount(const String &archivePath, const String &mountPoint)
+{
+	ArchiveReader *reader = new ArchiveReader();
+
+	if (!reader->open(archivePath))
+	{
+		LLT_LOG("Couldn't mount archive %s, falling back to loose files.", archivePath.cstr());
+		delete reader;
+		return false;
+	}
+
+	Mount mount = {};
+	mount.archive = reader;
+	mount.mountPoint = archive::normalisePath(mountPoint.cstr());
+
+	m_mounts.pushBack(mount);
+
+	LLT_LOG("Mounted archive %s (%u entries) at %s", archivePath.cstr(), reader->getEntryCount(), mountPoint.cstr());
+
+	return true;
+}
+
+void VirtualFileSystem::unmountAll()
+{
+	for (auto &mount : m_mounts) {
+		delete mount.archive;
+	}
+
+	m_mounts.clear();
+}
+
+const archive::Entry *VirtualFileSystem::find(const String &path, const ArchiveReader **outArchive) const
+{
+	if (m_mounts.size() == 0) {
+		return nullptr;
+	}
+
+	String normalised = archive::normalisePath(path.cstr());
+
+	for (int i = m_mounts.size() - 1; i >= 0; i--)
+	{
+		const Mount &mount = m_mounts[i];
+		uint64_t prefixLength = mount.mountPoint.length();
+
+		const char *relative = nullptr;
+
+		if (prefixLength == 0) {
+			relative = normalised.cstr();
+		} else if (normalised.startsWith(mount.mountPoint) && normalised[prefixLength] == '/') {
+			relative = normalised.cstr() + prefixLength + 1;
+		} else {
+			continue;
+		}
+
+		const archive::Entry *entry = mount.archive->find(relative);
+
+		if (entry)
+		{
+			*outArchive = mount.archive;
+			return entry;
+		}
+	}
+
+	return nullptr;
+}
+
+bool VirtualFileSystem::exists(const String &path) const
+{
+	const ArchiveReader *archive = nullptr;
+
+	if (find(path, &archive)) {
+		return true;
+	}
+
+	std::error_code ec;
+	return std::filesystem::is_regular_file(path.cstr(), ec);
+}
+
+bool VirtualFileSystem::isInArchive(const String &path) const
+{
+	const ArchiveReader *archive = nullptr;
+	return find(path, &archive) != nullptr;
+}
+
+bool VirtualFileSystem::getFileSize(const String &path, uint64_t *outSize) const
+{
+	const ArchiveReader *archive = nullptr;
+	const archive::Entry *entry = find(path, &archive);
+
+	if (entry)
+	{
+		*outSize = entry->size;
+		return true;
+	}
+
+	std::error_code ec;
+	uint64_t size = std::filesystem::file_size(path.cstr(), ec);
+
+	if (ec) {
+		return false;
+	}
+
+	*outSize = size;
+	return true;
+}
+
+VfsFile VirtualFileSystem::open(const String &path) const
+{
+	VfsFile file;
+
+	const ArchiveReader *archive = nullptr;
+	const archive::Entry *entry = find(path, &archive);
+
+	if (entry)
+	{
+		file.m_fromArchive = true;
+
+		std::span<const byte> stored = archive->view(entry);
+
+		if (stored.size() == entry->size)
+		{
+			file.m_data = stored.data();
+			file.m_size = stored.size();
+			file.m_open = true;
+		}
+		else
+		{
+			file.m_buffer.resize(entry->size);
+
+			if (archive->extract(entry, file.m_buffer.data()))
+			{
+				file.m_data = file.m_buffer.data();
+				file.m_size = entry->size;
+				file.m_open = true;
+			}
+			else
+			{
+				LLT_LOG("Failed to extract %s from archive.", path.cstr());
+			}
+		}
+
+		return file;
+	}
+
+	if (file.m_mapping.open(path, MAPPED_FILE_ACCESS_SEQUENTIAL))
+	{
+		file.m_data = file.m_mapping.data();
+		file.m_size = file.m_mapping.size();
+		file.m_open = true;
+	}
+
+	return file;
+}
@@ -0,0 +1,91 @@
+#ifndef VFS_H_
+#define VFS_H_
+
+#include <span>
+
+#include "core/common.h"
+
+#include "container/vector.h"
+#include "container/string.h"
+
+#include "archive.h"
+#include "mapped_file.h"
+
+namespace llt
+{
+	/**
+	 * Contents of a file opened through the virtual file system.
+	 * Stored archive entries and loose files point straight into a mapping, compressed
+	 * archive entries are decompressed into a buffer owned by this.
+	 */
+	class VfsFile
+	{
+		friend class VirtualFileSystem;
+
+	public:
+		VfsFile();
+
+		bool isOpen() const;
+		bool isFromArchive() const;
+
+		const byte *data() const;
+		uint64_t size() const;
+
+		std::span<const byte> view() const;
+
+	private:
+		MappedFile m_mapping;
+		Vector<byte, MEM_TAG_IO> m_buffer;
+
+		const byte *m_data;
+		uint64_t m_size;
+
+		bool m_open;
+		bool m_fromArchive;
+	};
+
+	/**
+	 * Resolves paths against mounted archives first and falls back to loose files on disk.
+	 */
+	class VirtualFileSystem
+	{
+	public:
+		VirtualFileSystem();
+		~VirtualFileSystem();
+
+		/*
+		 * Any path under mountPoint gets looked up in the archive (relative to the mount point) before the disk.
+		 * Archives mounted later take priority over earlier ones.
+		 */
+		bool mount(const String &archivePath, const String &mountPoint);
+		void unmountAll();
+
+		bool exists(const String &path) const;
+		VfsFile open(const String &path) const;
+
+		/*
+		 * Whether open() would come from a mounted archive rather than a loose file.
+		 */
+		bool isInArchive(const String &path) const;
+
+		/*
+		 * Size of the file open() would return, without opening or decompressing it.
+		 */
+		bool getFileSize(const String &path, uint64_t *outSize) const;
+
+	private:
+		struct Mount
+		{
+			ArchiveReader *archive;
+			String mountPoint; // normalised, no trailing slash
+		};
+
+		const archive::Entry *find(const String &path, const ArchiveReader **outArchive) const;
+
+		Vector<Mount> m_mounts;
+	};
+
+	extern VirtualFileSystem *g_vfs;
+}
+
+#endif // VFS_H_
@@ -1,8 +1,113 @@
+#include <cstdlib>
+
 #include "core/app.h"
+#include "core/mem_tracker.h"
 
 using namespace llt;
 
-int main(void)
+/*
+ * --benchmark <scenario>	run a benchmark scenario (see core/benchmark.cpp) and exit
+ * --warmup <n>				frames rendered before measuring starts
+ * --frames <n>				frames measured
+ * --out <path>				report path, .json and .csv are added on
+ * --size <w>x<h>			render resolution
+ * --headless				render offscreen without a window
+ * --track-leaks			log every tracked allocation still alive on exit and where it came from (debug builds)
+ * --api-stats				count and time the vulkan calls made each frame
+ * --capture <path>			save one frame's graphics commands to path
+ * --capture-frame <n>		which frame --capture saves
+ * --replay <n>				replay the captured frame n times, write a report to --out and exit (headless only)
+ * --dynamic-res <ms>		lower the scene's resolution to keep the forward pass under ms on the gpu
+ * --min-scale <s>			the lowest --dynamic-res goes, as a fraction of full resolution
+ */
+static void parseArgs(int argc, char **argv, Config &config)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		const char *arg = argv[i];
+		const char *value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+		if (cstr::compare(arg, "--headless") == 0)
+		{
+			config.flags |= Config::FLAG_HEADLESS_BIT;
+		}
+		else if (cstr::compare(arg, "--track-leaks") == 0)
+		{
+			config.flags |= Config::FLAG_TRACK_LEAKS_BIT;
+		}
+		else if (cstr::compare(arg, "--api-stats") == 0)
+		{
+			config.flags |= Config::FLAG_API_STATS_BIT;
+		}
+		else if (cstr::compare(arg, "--benchmark") == 0 && value)
+		{
+			config.benchmarkScenario = value;
+
+			// vsync would just measure the refresh rate
+			config.vsync = false;
+			i++;
+		}
+		else if (cstr::compare(arg, "--warmup") == 0 && value)
+		{
+			config.benchmarkWarmupFrames = (unsigned)std::strtoul(value, nullptr, 10);
+			i++;
+		}
+		else if (cstr::compare(arg, "--frames") == 0 && value)
+		{
+			config.benchmarkMeasuredFrames = (unsigned)std::strtoul(value, nullptr, 10);
+			i++;
+		}
+		else if (cstr::compare(arg, "--out") == 0 && value)
+		{
+			config.benchmarkOutputPath = value;
+			i++;
+		}
+		else if (cstr::compare(arg, "--capture") == 0 && value)
+		{
+			config.capturePath = value;
+			i++;
+		}
+		else if (cstr::compare(arg, "--capture-frame") == 0 && value)
+		{
+			config.captureFrame = (unsigned)std::strtoul(value, nullptr, 10);
+			i++;
+		}
+		else if (cstr::compare(arg, "--replay") == 0 && value)
+		{
+			config.replayIterations = (unsigned)std::strtoul(value, nullptr, 10);
+			i++;
+		}
+		else if (cstr::compare(arg, "--dynamic-res") == 0 && value)
+		{
+			config.dynamicResolutionMs = std::strtof(value, nullptr);
+			i++;
+		}
+		else if (cstr::compare(arg, "--min-scale") == 0 && value)
+		{
+			config.dynamicResolutionMinScale = std::strtof(value, nullptr);
+			i++;
+		}
+		else if (cstr::compare(arg, "--size") == 0 && value)
+		{
+			unsigned width = 0;
+			unsigned height = 0;
+
+			if (sscanf(value, "%ux%u", &width, &height) == 2 && width > 0 && height > 0)
+			{
+				config.width = width;
+				config.height = height;
+			}
+
+			i++;
+		}
+		else
+		{
+			LLT_LOG("Unknown argument: %s", arg);
+		}
+	}
+}
+
+int main(int argc, char **argv)
 {
 	Config config;
 	config.name = "Lilythorn";
@@ -15,10 +120,19 @@ int main(void)
 	config.windowMode = WINDOW_MODE_WINDOWED_BIT;
 	config.flags = Config::FLAG_CENTRE_WINDOW_BIT;
 
+	parseArgs(argc, argv, config);
+
 	g_app = new App(config);
 	g_app->run();
-	
+
 	delete g_app;
 
+	// once the app's gone, so its own members aren't counted, whatever's left was never freed
+#ifdef LLT_DEBUG
+	if (config.hasFlag(Config::FLAG_TRACK_LEAKS_BIT)) {
+		memtrack::reportLeaks();
+	}
+#endif // LLT_DEBUG
+
 	return 0;
 }
@@ -22,7 +22,9 @@ BindlessResourceManager::BindlessResourceManager()
 	, m_bindlessSet()
 	, m_bindlessLayout()
 	, m_textureHandle_UID(0)
+	, m_freeTextureHandles()
 	, m_cubeHandle_UID(0)
+	, m_freeCubeHandles()
 	, m_samplerHandle_UID(0)
 {
 }
@@ -77,7 +79,7 @@ void BindlessResourceManager::init()
 	m_bindlessSet = m_bindlessPool.allocate(m_bindlessLayout);
 
 	m_frameConstantsBuffer = g_gpuBufferManager->createUniformBuffer(sizeof(FrameConstants));
-	m_transformationBuffer = g_gpuBufferManager->createStorageBuffer(sizeof(TransformData) * 16);
+	m_transformationBuffer = g_gpuBufferManager->createStorageBuffer(sizeof(TransformData) * MAX_TRANSFORMS);
 
 	writeFrameConstants({
 		.proj = glm::identity<glm::mat4>(),
@@ -85,7 +87,7 @@ void BindlessResourceManager::init()
 		.cameraPosition = glm::zero<glm::vec4>()
 	});
 
-	for (int i = 0; i < 16; i++)
+	for (int i = 0; i < MAX_TRANSFORMS; i++)
 	{
 		writeTransformData(i, {
 			.model = glm::identity<glm::mat4>(),
@@ -112,13 +114,20 @@ void BindlessResourceManager::writeFrameConstants(const FrameConstants &frameCon
 
 void BindlessResourceManager::writeTransformData(int index, const TransformData &transformData)
 {
+	LLT_ASSERT(index >= 0 && index < MAX_TRANSFORMS, "Transform index out of range.");
+
 	m_transformationBuffer->writeDataToMe(&transformData, sizeof(TransformData), sizeof(TransformData) * index);
 }
 
 BindlessResourceHandle BindlessResourceManager::registerTexture2D(const TextureView &view)
 {
 	BindlessResourceHandle handle = {};
-	handle.id = m_textureHandle_UID++;
+
+	if (m_freeTextureHandles.size() > 0) {
+		handle.id = m_freeTextureHandles.popBack();
+	} else {
+		handle.id = m_textureHandle_UID++;
+	}
 
 	writeTexture2Ds(handle.id, { view });
 	updateSet();
@@ -129,7 +138,12 @@ BindlessResourceHandle BindlessResourceManager::registerTexture2D(const TextureV
 BindlessResourceHandle BindlessResourceManager::registerCubemap(const TextureView &cubemap)
 {
 	BindlessResourceHandle handle = {};
-	handle.id = m_cubeHandle_UID++;
+
+	if (m_freeCubeHandles.size() > 0) {
+		handle.id = m_freeCubeHandles.popBack();
+	} else {
+		handle.id = m_cubeHandle_UID++;
+	}
 
 	writeCubemaps(handle.id, { cubemap });
 	updateSet();
@@ -148,6 +162,20 @@ BindlessResourceHandle BindlessResourceManager::registerSampler(const TextureSam
 	return handle;
 }
 
+void BindlessResourceManager::releaseTexture2D(const BindlessResourceHandle &handle)
+{
+	if (handle.id != BindlessResourceHandle::INVALID) {
+		m_freeTextureHandles.pushBack(handle.id);
+	}
+}
+
+void BindlessResourceManager::releaseCubemap(const BindlessResourceHandle &handle)
+{
+	if (handle.id != BindlessResourceHandle::INVALID) {
+		m_freeCubeHandles.pushBack(handle.id);
+	}
+}
+
 void BindlessResourceManager::writeTexture2Ds(uint32_t firstIndex, const Vector<TextureView> &views)
 {
 	for (int i = 0; i < views.size(); i++)
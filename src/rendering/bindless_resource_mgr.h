@@ -15,6 +15,7 @@ namespace llt
 		glm::mat4 proj;
 		glm::mat4 view;
 		glm::vec4 cameraPosition;
+		glm::vec4 irradianceSH[9]; // see MaterialSystem::calcIrradianceSH, only rgb is used
 //		Light lights[16];
 	};
 
@@ -40,6 +41,9 @@ namespace llt
 	class BindlessResourceManager
 	{
 	public:
+		// one for every draw in the forward pass
+		static constexpr int MAX_TRANSFORMS = 4096;
+
 		BindlessResourceManager();
 		~BindlessResourceManager();
 
@@ -54,6 +58,13 @@ namespace llt
 		BindlessResourceHandle registerCubemap(const TextureView &cubemap);
 		BindlessResourceHandle registerSampler(const TextureSampler *sampler);
 
+		/*
+		 * Hands the slot back to be reused by a later registerTexture2D.
+		 * Nothing in flight can still be sampling from it.
+		 */
+		void releaseTexture2D(const BindlessResourceHandle &handle);
+		void releaseCubemap(const BindlessResourceHandle &handle);
+
 		void writeTexture2Ds(uint32_t firstIndex, const Vector<TextureView> &views);
 		void writeCubemaps(uint32_t firstIndex, const Vector<TextureView> &cubemaps);
 		void writeSamplers(uint32_t firstIndex, const Vector<const TextureSampler *> &samplers);
@@ -71,9 +82,12 @@ namespace llt
 		VkDescriptorSet m_bindlessSet;
 		VkDescriptorSetLayout m_bindlessLayout;
 
-		// todo: this should be more like a freelist
+		// todo: this should be more like a freelist for samplers too
 		BindlessResourceID m_textureHandle_UID;
+		Vector<BindlessResourceID> m_freeTextureHandles;
+
 		BindlessResourceID m_cubeHandle_UID;
+		Vector<BindlessResourceID> m_freeCubeHandles;
 		BindlessResourceID m_samplerHandle_UID;
 	};
 
@@ -0,0 +1,859 @@
+#include "block_compression.h"
+
+#include "vulkan/image_ops.h"
+
+#include <cmath>
+#include <cfloat>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+
+#define LLT_BLOCK_COMPRESSION_X86
+
+#include <immintrin.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+
+#define LLT_TARGET_SSE
+
+#else
+
+#define LLT_TARGET_SSE __attribute__((target("ssse3")))
+
+#endif
+
+#endif // x86
+
+using namespace llt;
+
+// interpolation weights shared by bc6h and bc7, out of 64
+static constexpr int WEIGHTS_4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+/**
+ * Writes bits least significant first into a zeroed block.
+ */
+class BlockBitWriter
+{
+public:
+	BlockBitWriter(byte *data)
+		: m_data(data)
+		, m_position(0)
+	{
+	}
+
+	void write(uint32_t value, int bitCount)
+	{
+		for (int i = 0; i < bitCount; i++)
+		{
+			if ((value >> i) & 1) {
+				m_data[m_position >> 3] |= 1 << (m_position & 7);
+			}
+
+			m_position++;
+		}
+	}
+
+private:
+	byte *m_data;
+	int m_position;
+};
+
+static float clampf(float x, float mn, float mx)
+{
+	return x < mn ? mn : (x > mx ? mx : x);
+}
+
+static int clampi(int x, int mn, int mx)
+{
+	return x < mn ? mn : (x > mx ? mx : x);
+}
+
+/*
+ * Fits a line through the block: the mean plus the dominant eigenvector of the covariance matrix.
+ * The endpoints are the extremes of the texels projected onto that line.
+ */
+static void fitEndpoints(const float texels[16][4], int channels, float e0[4], float e1[4])
+{
+	float mean[4] = {};
+
+	for (int i = 0; i < bc::BLOCK_TEXELS; i++) {
+		for (int c = 0; c < channels; c++) {
+			mean[c] += texels[i][c];
+		}
+	}
+
+	for (int c = 0; c < channels; c++) {
+		mean[c] /= (float)bc::BLOCK_TEXELS;
+	}
+
+	float covariance[4][4] = {};
+
+	for (int i = 0; i < bc::BLOCK_TEXELS; i++)
+	{
+		float d[4] = {};
+
+		for (int c = 0; c < channels; c++) {
+			d[c] = texels[i][c] - mean[c];
+		}
+
+		for (int a = 0; a < channels; a++) {
+			for (int b = 0; b < channels; b++) {
+				covariance[a][b] += d[a] * d[b];
+			}
+		}
+	}
+
+	// start the power iteration from the channel with the most variance so it converges in a few steps
+	float axis[4] = {};
+	int widest = 0;
+
+	for (int c = 1; c < channels; c++) {
+		if (covariance[c][c] > covariance[widest][widest]) {
+			widest = c;
+		}
+	}
+
+	for (int c = 0; c < channels; c++) {
+		axis[c] = covariance[widest][c];
+	}
+
+	for (int iteration = 0; iteration < 8; iteration++)
+	{
+		float next[4] = {};
+		float lengthSq = 0.0f;
+
+		for (int a = 0; a < channels; a++)
+		{
+			for (int b = 0; b < channels; b++) {
+				next[a] += covariance[a][b] * axis[b];
+			}
+
+			lengthSq += next[a] * next[a];
+		}
+
+		if (lengthSq < FLT_EPSILON) {
+			break;
+		}
+
+		float invLength = 1.0f / std::sqrt(lengthSq);
+
+		for (int c = 0; c < channels; c++) {
+			axis[c] = next[c] * invLength;
+		}
+	}
+
+	float tMin = FLT_MAX;
+	float tMax = -FLT_MAX;
+
+	for (int i = 0; i < bc::BLOCK_TEXELS; i++)
+	{
+		float t = 0.0f;
+
+		for (int c = 0; c < channels; c++) {
+			t += (texels[i][c] - mean[c]) * axis[c];
+		}
+
+		tMin = t < tMin ? t : tMin;
+		tMax = t > tMax ? t : tMax;
+	}
+
+	for (int c = 0; c < channels; c++)
+	{
+		e0[c] = mean[c] + axis[c] * tMin;
+		e1[c] = mean[c] + axis[c] * tMax;
+	}
+}
+
+/*
+ * Given how far along the line each texel was placed, solves for the two endpoints that minimise the squared error.
+ */
+static bool solveEndpoints(const float texels[16][4], int channels, const float weights[16], float e0[4], float e1[4])
+{
+	float a = 0.0f, b = 0.0f, c = 0.0f;
+	float x0[4] = {};
+	float x1[4] = {};
+
+	for (int i = 0; i < bc::BLOCK_TEXELS; i++)
+	{
+		float w = weights[i];
+		float iw = 1.0f - w;
+
+		a += iw * iw;
+		b += iw * w;
+		c += w * w;
+
+		for (int j = 0; j < channels; j++)
+		{
+			x0[j] += iw * texels[i][j];
+			x1[j] += w * texels[i][j];
+		}
+	}
+
+	float det = a*c - b*b;
+
+	if (std::abs(det) < FLT_EPSILON) {
+		return false;
+	}
+
+	float invDet = 1.0f / det;
+
+	for (int j = 0; j < channels; j++)
+	{
+		e0[j] = (c*x0[j] - b*x1[j]) * invDet;
+		e1[j] = (a*x1[j] - b*x0[j]) * invDet;
+	}
+
+	return true;
+}
+
+static void loadBlock(const float *block, float texels[16][4])
+{
+	for (int i = 0; i < bc::BLOCK_TEXELS; i++) {
+		for (int c = 0; c < 4; c++) {
+			texels[i][c] = block[i*4 + c];
+		}
+	}
+}
+
+// --- palette search
+
+/*
+ * Picks the closest palette entry to every texel and returns the summed squared error.
+ * Ties go to the earlier entry.
+ */
+static float findClosestIndicesScalar(const float texels[16][4], const float palette[16][4], int paletteSize, int channels, int indices[16])
+{
+	float totalError = 0.0f;
+
+	for (int i = 0; i < bc::BLOCK_TEXELS; i++)
+	{
+		float bestError = FLT_MAX;
+		int bestIndex = 0;
+
+		for (int j = 0; j < paletteSize; j++)
+		{
+			float error = 0.0f;
+
+			for (int c = 0; c < channels; c++)
+			{
+				float d = texels[i][c] - palette[j][c];
+				error += d*d;
+			}
+
+			if (error < bestError)
+			{
+				bestError = error;
+				bestIndex = j;
+			}
+		}
+
+		indices[i] = bestIndex;
+		totalError += bestError;
+	}
+
+	return totalError;
+}
+
+#if defined(LLT_BLOCK_COMPRESSION_X86)
+
+/*
+ * Same search four texels at a time, one lane per texel.
+ * The error adds up the channels in the same order as the scalar version and the total is summed in texel order
+ * afterwards, so both pick the same indices and return the same error.
+ */
+LLT_TARGET_SSE
+static float findClosestIndicesSSE(const float texels[16][4], const float palette[16][4], int paletteSize, int channels, int indices[16])
+{
+	alignas(16) float bestErrors[bc::BLOCK_TEXELS];
+
+	for (int i = 0; i < bc::BLOCK_TEXELS; i += 4)
+	{
+		__m128 channel[4];
+
+		for (int c = 0; c < channels; c++) {
+			channel[c] = _mm_setr_ps(texels[i + 0][c], texels[i + 1][c], texels[i + 2][c], texels[i + 3][c]);
+		}
+
+		__m128 bestError = _mm_set1_ps(FLT_MAX);
+		__m128i bestIndex = _mm_setzero_si128();
+
+		for (int j = 0; j < paletteSize; j++)
+		{
+			__m128 d = _mm_sub_ps(channel[0], _mm_set1_ps(palette[j][0]));
+			__m128 error = _mm_mul_ps(d, d);
+
+			for (int c = 1; c < channels; c++)
+			{
+				d = _mm_sub_ps(channel[c], _mm_set1_ps(palette[j][c]));
+				error = _mm_add_ps(error, _mm_mul_ps(d, d));
+			}
+
+			__m128 better = _mm_cmplt_ps(error, bestError);
+
+			bestError = _mm_or_ps(_mm_and_ps(better, error), _mm_andnot_ps(better, bestError));
+			bestIndex = _mm_or_si128(_mm_and_si128(_mm_castps_si128(better), _mm_set1_epi32(j)), _mm_andnot_si128(_mm_castps_si128(better), bestIndex));
+		}
+
+		_mm_store_ps(bestErrors + i, bestError);
+		_mm_storeu_si128((__m128i *)(indices + i), bestIndex);
+	}
+
+	float totalError = 0.0f;
+
+	for (int i = 0; i < bc::BLOCK_TEXELS; i++) {
+		totalError += bestErrors[i];
+	}
+
+	return totalError;
+}
+
+#endif // LLT_BLOCK_COMPRESSION_X86
+
+static float findClosestIndices(const float texels[16][4], const float palette[16][4], int paletteSize, int channels, int indices[16])
+{
+#if defined(LLT_BLOCK_COMPRESSION_X86)
+	if (imageops::getSimdLevel() >= imageops::SIMD_LEVEL_SSE) {
+		return findClosestIndicesSSE(texels, palette, paletteSize, channels, indices);
+	}
+#endif // LLT_BLOCK_COMPRESSION_X86
+
+	return findClosestIndicesScalar(texels, palette, paletteSize, channels, indices);
+}
+
+// --- bc1
+
+static uint16_t packRGB565(const float colour[4])
+{
+	int r = clampi((int)std::round(colour[0] * (31.0f / 255.0f)), 0, 31);
+	int g = clampi((int)std::round(colour[1] * (63.0f / 255.0f)), 0, 63);
+	int b = clampi((int)std::round(colour[2] * (31.0f / 255.0f)), 0, 31);
+
+	return (r << 11) | (g << 5) | b;
+}
+
+static void unpackRGB565(uint16_t packed, int colour[3])
+{
+	int r = (packed >> 11) & 31;
+	int g = (packed >> 5) & 63;
+	int b = packed & 31;
+
+	colour[0] = (r << 3) | (r >> 2);
+	colour[1] = (g << 2) | (g >> 4);
+	colour[2] = (b << 3) | (b >> 2);
+}
+
+static float findBC1Indices(const float texels[16][4], uint16_t c0, uint16_t c1, uint32_t *indices)
+{
+	int endpoints[2][3];
+
+	unpackRGB565(c0, endpoints[0]);
+	unpackRGB565(c1, endpoints[1]);
+
+	float palette[16][4] = {};
+
+	for (int c = 0; c < 3; c++)
+	{
+		palette[0][c] = (float)endpoints[0][c];
+		palette[1][c] = (float)endpoints[1][c];
+		palette[2][c] = (float)((2*endpoints[0][c] + endpoints[1][c]) / 3);
+		palette[3][c] = (float)((endpoints[0][c] + 2*endpoints[1][c]) / 3);
+	}
+
+	int texelIndices[bc::BLOCK_TEXELS];
+	float totalError = findClosestIndices(texels, palette, 4, 3, texelIndices);
+
+	*indices = 0;
+
+	for (int i = 0; i < bc::BLOCK_TEXELS; i++) {
+		*indices |= texelIndices[i] << (i * 2);
+	}
+
+	return totalError;
+}
+
+void bc::encodeBC1(const float *block, byte *out)
+{
+	float texels[16][4];
+	loadBlock(block, texels);
+
+	float e0[4], e1[4];
+	fitEndpoints(texels, 3, e0, e1);
+
+	uint16_t c0 = packRGB565(e1);
+	uint16_t c1 = packRGB565(e0);
+
+	uint32_t indices = 0;
+	float error = findBC1Indices(texels, c0, c1, &indices);
+
+	// palette entries sit at 0, 1, 1/3 and 2/3 of the way from c0 to c1
+	static constexpr float BC1_WEIGHTS[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+	float weights[16];
+
+	for (int i = 0; i < BLOCK_TEXELS; i++) {
+		weights[i] = BC1_WEIGHTS[(indices >> (i * 2)) & 3];
+	}
+
+	if (solveEndpoints(texels, 3, weights, e0, e1))
+	{
+		uint16_t refinedC0 = packRGB565(e0);
+		uint16_t refinedC1 = packRGB565(e1);
+
+		uint32_t refinedIndices = 0;
+		float refinedError = findBC1Indices(texels, refinedC0, refinedC1, &refinedIndices);
+
+		if (refinedError < error)
+		{
+			c0 = refinedC0;
+			c1 = refinedC1;
+			indices = refinedIndices;
+		}
+	}
+
+	if (c0 < c1)
+	{
+		// four colour mode needs c0 > c1, swapping the endpoints flips the low bit of every index
+		uint16_t tmp = c0;
+		c0 = c1;
+		c1 = tmp;
+
+		indices ^= 0x55555555;
+	}
+	else if (c0 == c1)
+	{
+		indices = 0;
+	}
+
+	out[0] = c0 & 0xFF;
+	out[1] = c0 >> 8;
+	out[2] = c1 & 0xFF;
+	out[3] = c1 >> 8;
+	out[4] = indices & 0xFF;
+	out[5] = (indices >> 8) & 0xFF;
+	out[6] = (indices >> 16) & 0xFF;
+	out[7] = indices >> 24;
+}
+
+// --- bc4 / bc5
+
+void bc::encodeBC4(const float *block, int component, byte *out)
+{
+	float mn = FLT_MAX;
+	float mx = -FLT_MAX;
+
+	for (int i = 0; i < BLOCK_TEXELS; i++)
+	{
+		float v = block[i*4 + component];
+
+		mn = v < mn ? v : mn;
+		mx = v > mx ? v : mx;
+	}
+
+	int a0 = clampi((int)std::round(mx), 0, 255);
+	int a1 = clampi((int)std::round(mn), 0, 255);
+
+	out[0] = a0;
+	out[1] = a1;
+
+	uint64_t indices = 0;
+
+	if (a0 > a1)
+	{
+		// eight value mode: index 0 is a0, 1 is a1, and 2-7 step from a0 towards a1
+		float scale = 7.0f / (float)(a0 - a1);
+
+		for (int i = 0; i < BLOCK_TEXELS; i++)
+		{
+			int step = clampi((int)std::round((block[i*4 + component] - a1) * scale), 0, 7);
+			uint64_t index = step == 7 ? 0 : (step == 0 ? 1 : 8 - step);
+
+			indices |= index << (i * 3);
+		}
+	}
+
+	for (int i = 0; i < 6; i++) {
+		out[2 + i] = (indices >> (i * 8)) & 0xFF;
+	}
+}
+
+void bc::encodeBC5(const float *block, byte *out)
+{
+	encodeBC4(block, 0, out);
+	encodeBC4(block, 1, out + 8);
+}
+
+// --- bc6h
+
+static int unquantizeBC6H(int value)
+{
+	if (value == 0) {
+		return 0;
+	}
+
+	if (value == 1023) {
+		return 0xFFFF;
+	}
+
+	return ((value << 16) + 0x8000) >> 10;
+}
+
+static int quantizeBC6H(float half)
+{
+	// inverse of (unquantize(x) * 31) >> 6 for the unsigned case
+	return clampi((int)std::round((half - 15.0f) / 31.0f), 0, 1023);
+}
+
+static float findBC6HIndices(const float texels[16][4], const int q0[3], const int q1[3], int indices[16])
+{
+	float palette[16][4] = {};
+
+	for (int j = 0; j < 16; j++)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			int u0 = unquantizeBC6H(q0[c]);
+			int u1 = unquantizeBC6H(q1[c]);
+
+			int interpolated = ((64 - WEIGHTS_4[j]) * u0 + WEIGHTS_4[j] * u1 + 32) >> 6;
+
+			palette[j][c] = (float)((interpolated * 31) >> 6);
+		}
+	}
+
+	return findClosestIndices(texels, palette, 16, 3, indices);
+}
+
+void bc::encodeBC6H(const float *block, byte *out)
+{
+	// fit in half float bit space, which is roughly logarithmic and is what the hardware interpolates in
+	float texels[16][4];
+
+	for (int i = 0; i < BLOCK_TEXELS; i++)
+	{
+		for (int c = 0; c < 3; c++) {
+			texels[i][c] = (float)floatToHalf(clampf(block[i*4 + c], 0.0f, 65504.0f));
+		}
+
+		texels[i][3] = 0.0f;
+	}
+
+	float e0[4], e1[4];
+	fitEndpoints(texels, 3, e0, e1);
+
+	int q0[3], q1[3];
+
+	for (int c = 0; c < 3; c++)
+	{
+		q0[c] = quantizeBC6H(e0[c]);
+		q1[c] = quantizeBC6H(e1[c]);
+	}
+
+	int indices[16];
+	float error = findBC6HIndices(texels, q0, q1, indices);
+
+	float weights[16];
+
+	for (int i = 0; i < BLOCK_TEXELS; i++) {
+		weights[i] = WEIGHTS_4[indices[i]] / 64.0f;
+	}
+
+	if (solveEndpoints(texels, 3, weights, e0, e1))
+	{
+		int refinedQ0[3], refinedQ1[3];
+
+		for (int c = 0; c < 3; c++)
+		{
+			refinedQ0[c] = quantizeBC6H(e0[c]);
+			refinedQ1[c] = quantizeBC6H(e1[c]);
+		}
+
+		int refinedIndices[16];
+		float refinedError = findBC6HIndices(texels, refinedQ0, refinedQ1, refinedIndices);
+
+		if (refinedError < error)
+		{
+			for (int c = 0; c < 3; c++)
+			{
+				q0[c] = refinedQ0[c];
+				q1[c] = refinedQ1[c];
+			}
+
+			for (int i = 0; i < BLOCK_TEXELS; i++) {
+				indices[i] = refinedIndices[i];
+			}
+		}
+	}
+
+	// the anchor index only gets 3 bits, so its top bit has to be zero
+	if (indices[0] & 8)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			int tmp = q0[c];
+			q0[c] = q1[c];
+			q1[c] = tmp;
+		}
+
+		for (int i = 0; i < BLOCK_TEXELS; i++) {
+			indices[i] = 15 - indices[i];
+		}
+	}
+
+	mem::set(out, 0, 16);
+
+	BlockBitWriter writer(out);
+
+	writer.write(0x03, 5); // mode 11: one region, untransformed 10-bit endpoints
+
+	for (int c = 0; c < 3; c++) {
+		writer.write(q0[c], 10);
+	}
+
+	for (int c = 0; c < 3; c++) {
+		writer.write(q1[c], 10);
+	}
+
+	writer.write(indices[0], 3);
+
+	for (int i = 1; i < BLOCK_TEXELS; i++) {
+		writer.write(indices[i], 4);
+	}
+}
+
+// --- bc7
+
+static void quantizeBC7Endpoint(const float endpoint[4], int quantized[4], int *pBit)
+{
+	float bestError = FLT_MAX;
+
+	for (int p = 0; p < 2; p++)
+	{
+		int candidate[4];
+		float error = 0.0f;
+
+		for (int c = 0; c < 4; c++)
+		{
+			float v = clampf(endpoint[c], 0.0f, 255.0f);
+
+			candidate[c] = clampi((int)std::round((v - p) * 0.5f), 0, 127);
+
+			float d = (float)((candidate[c] << 1) | p) - v;
+			error += d*d;
+		}
+
+		if (error < bestError)
+		{
+			bestError = error;
+			*pBit = p;
+
+			for (int c = 0; c < 4; c++) {
+				quantized[c] = candidate[c];
+			}
+		}
+	}
+}
+
+static float findBC7Indices(const float texels[16][4], const int q0[4], int p0, const int q1[4], int p1, int indices[16])
+{
+	float palette[16][4];
+
+	for (int c = 0; c < 4; c++)
+	{
+		int v0 = (q0[c] << 1) | p0;
+		int v1 = (q1[c] << 1) | p1;
+
+		for (int j = 0; j < 16; j++) {
+			palette[j][c] = (float)(((64 - WEIGHTS_4[j]) * v0 + WEIGHTS_4[j] * v1 + 32) >> 6);
+		}
+	}
+
+	return findClosestIndices(texels, palette, 16, 4, indices);
+}
+
+void bc::encodeBC7(const float *block, byte *out)
+{
+	float texels[16][4];
+	loadBlock(block, texels);
+
+	float e0[4], e1[4];
+	fitEndpoints(texels, 4, e0, e1);
+
+	int q0[4], q1[4];
+	int p0, p1;
+
+	quantizeBC7Endpoint(e0, q0, &p0);
+	quantizeBC7Endpoint(e1, q1, &p1);
+
+	int indices[16];
+	float error = findBC7Indices(texels, q0, p0, q1, p1, indices);
+
+	float weights[16];
+
+	for (int i = 0; i < BLOCK_TEXELS; i++) {
+		weights[i] = WEIGHTS_4[indices[i]] / 64.0f;
+	}
+
+	if (solveEndpoints(texels, 4, weights, e0, e1))
+	{
+		int refinedQ0[4], refinedQ1[4];
+		int refinedP0, refinedP1;
+
+		quantizeBC7Endpoint(e0, refinedQ0, &refinedP0);
+		quantizeBC7Endpoint(e1, refinedQ1, &refinedP1);
+
+		int refinedIndices[16];
+		float refinedError = findBC7Indices(texels, refinedQ0, refinedP0, refinedQ1, refinedP1, refinedIndices);
+
+		if (refinedError < error)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				q0[c] = refinedQ0[c];
+				q1[c] = refinedQ1[c];
+			}
+
+			p0 = refinedP0;
+			p1 = refinedP1;
+
+			for (int i = 0; i < BLOCK_TEXELS; i++) {
+				indices[i] = refinedIndices[i];
+			}
+		}
+	}
+
+	// the anchor index only gets 3 bits, so its top bit has to be zero
+	if (indices[0] & 8)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			int tmp = q0[c];
+			q0[c] = q1[c];
+			q1[c] = tmp;
+		}
+
+		int tmp = p0;
+		p0 = p1;
+		p1 = tmp;
+
+		for (int i = 0; i < BLOCK_TEXELS; i++) {
+			indices[i] = 15 - indices[i];
+		}
+	}
+
+	mem::set(out, 0, 16);
+
+	BlockBitWriter writer(out);
+
+	writer.write(1 << 6, 7); // mode 6
+
+	for (int c = 0; c < 4; c++)
+	{
+		writer.write(q0[c], 7);
+		writer.write(q1[c], 7);
+	}
+
+	writer.write(p0, 1);
+	writer.write(p1, 1);
+
+	writer.write(indices[0], 3);
+
+	for (int i = 1; i < BLOCK_TEXELS; i++) {
+		writer.write(indices[i], 4);
+	}
+}
+
+// ---
+
+uint16_t bc::floatToHalf(float value)
+{
+	uint32_t bits = 0;
+	mem::copy(&bits, &value, sizeof(float));
+
+	uint32_t sign = (bits >> 16) & 0x8000;
+	int32_t exponent = (int32_t)((bits >> 23) & 0xFF) - 127 + 15;
+	uint32_t mantissa = bits & 0x7FFFFF;
+
+	if (((bits >> 23) & 0xFF) == 0xFF) {
+		return sign | 0x7C00 | (mantissa ? 0x200 : 0); // inf / nan
+	}
+
+	if (exponent >= 31) {
+		return sign | 0x7BFF; // clamp to the largest finite half
+	}
+
+	if (exponent <= 0)
+	{
+		if (exponent < -10) {
+			return sign;
+		}
+
+		// subnormal, shift the implicit leading one in
+		mantissa |= 0x800000;
+
+		uint32_t shift = 14 - exponent;
+		uint32_t half = mantissa >> shift;
+
+		// round to nearest
+		if ((mantissa >> (shift - 1)) & 1) {
+			half++;
+		}
+
+		return sign | half;
+	}
+
+	uint32_t half = sign | (exponent << 10) | (mantissa >> 13);
+
+	// round to nearest, carrying into the exponent is fine
+	if (mantissa & 0x1000) {
+		half++;
+	}
+
+	if ((half & 0x7FFF) > 0x7BFF) {
+		half = sign | 0x7BFF;
+	}
+
+	return half;
+}
+
+float bc::halfToFloat(uint16_t value)
+{
+	uint32_t sign = (value & 0x8000) << 16;
+	uint32_t exponent = (value >> 10) & 0x1F;
+	uint32_t mantissa = value & 0x3FF;
+
+	uint32_t bits = 0;
+
+	if (exponent == 0)
+	{
+		if (mantissa == 0)
+		{
+			bits = sign;
+		}
+		else
+		{
+			// renormalise the subnormal
+			exponent = 127 - 15 + 1;
+
+			while (!(mantissa & 0x400))
+			{
+				mantissa <<= 1;
+				exponent--;
+			}
+
+			mantissa &= 0x3FF;
+			bits = sign | (exponent << 23) | (mantissa << 13);
+		}
+	}
+	else if (exponent == 31)
+	{
+		bits = sign | 0x7F800000 | (mantissa << 13);
+	}
+	else
+	{
+		bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+	}
+
+	float result = 0.0f;
+	mem::copy(&result, &bits, sizeof(float));
+
+	return result;
+}
@@ -0,0 +1,52 @@
+#ifndef BLOCK_COMPRESSION_H_
+#define BLOCK_COMPRESSION_H_
+
+#include "core/common.h"
+
+namespace llt
+{
+	/*
+	 * CPU encoders for the BCn block formats.
+	 *
+	 * Every encoder takes a single 4x4 block as 16 row-major RGBA texels (64 floats).
+	 * LDR formats expect values in [0, 255], BC6H expects linear hdr values.
+	 *
+	 * These are single-pass endpoint fits (principal axis + one least squares refinement),
+	 * so they're nowhere near as slow as the reference encoders while still being close enough for cooking.
+	 */
+	namespace bc
+	{
+		static constexpr int BLOCK_DIM = 4;
+		static constexpr int BLOCK_TEXELS = BLOCK_DIM * BLOCK_DIM;
+
+		/*
+		 * 8 bytes, rgb only, alpha is ignored.
+		 */
+		void encodeBC1(const float *block, byte *out);
+
+		/*
+		 * 8 bytes, single channel read from the given component.
+		 */
+		void encodeBC4(const float *block, int component, byte *out);
+
+		/*
+		 * 16 bytes, red and green as two bc4 blocks.
+		 */
+		void encodeBC5(const float *block, byte *out);
+
+		/*
+		 * 16 bytes, unsigned half floats, alpha is ignored. Always uses the single region 10-bit mode.
+		 */
+		void encodeBC6H(const float *block, byte *out);
+
+		/*
+		 * 16 bytes, rgba. Always uses mode 6 (single subset, 7.7.7.7 endpoints + p-bits, 4-bit indices).
+		 */
+		void encodeBC7(const float *block, byte *out);
+
+		uint16_t floatToHalf(float value);
+		float halfToFloat(uint16_t value);
+	}
+}
+
+#endif // BLOCK_COMPRESSION_H_
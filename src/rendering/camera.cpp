@@ -51,12 +51,7 @@ void Camera::update(float dt)
 	m_yaw = lerp(m_yaw, m_targetYaw, dt * 50.0f);
 	m_pitch = lerp(m_pitch, m_targetPitch, dt * 50.0f);
 
-	float yaw = m_yaw + glm::half_pi<float>();
-	float pitch = m_pitch;
-
-	direction.x = glm::cos(yaw) * glm::cos(pitch);
-	direction.y = glm::sin(pitch);
-	direction.z = -glm::sin(yaw) * glm::cos(pitch);
+	updateDirection();
 
 	glm::vec3 v1 = glm::normalize(glm::cross(direction, glm::vec3(0.0f, 1.0f, 0.0f)));
 	glm::vec3 v2 = glm::normalize(glm::cross(v1, direction));
@@ -80,6 +75,16 @@ void Camera::update(float dt)
 	}
 }
 
+void Camera::updateDirection()
+{
+	float yaw = m_yaw + glm::half_pi<float>();
+	float pitch = m_pitch;
+
+	direction.x = glm::cos(yaw) * glm::cos(pitch);
+	direction.y = glm::sin(pitch);
+	direction.z = -glm::sin(yaw) * glm::cos(pitch);
+}
+
 glm::mat4 Camera::getView() const
 {
 	return glm::lookAt(position, position + direction, up);
@@ -104,3 +109,13 @@ void Camera::setPitch(double pitch)
 {
 	m_pitch = m_targetPitch = pitch;
 }
+
+void Camera::lookAt(const glm::vec3 &target)
+{
+	glm::vec3 dir = glm::normalize(target - position);
+
+	m_yaw = m_targetYaw = glm::atan(-dir.z, dir.x) - glm::half_pi<float>();
+	m_pitch = m_targetPitch = glm::asin(glm::clamp(dir.y, -1.0f, 1.0f));
+
+	updateDirection();
+}
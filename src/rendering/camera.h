@@ -20,6 +20,11 @@ class Camera
 		void setYaw(double yaw);
 		void setPitch(double pitch);
 
+		/*
+		 * Turns to face the target straight away, skipping the smoothing update() does.
+		 */
+		void lookAt(const glm::vec3 &target);
+
 		glm::vec3 position;
 		glm::vec3 up;
 		glm::vec3 direction;
@@ -32,6 +37,8 @@ class Camera
 		float far;
 
 	private:
+		void updateDirection();
+
 		float m_yaw = 0.0f;
 		float m_targetYaw = 0.0f;
 	
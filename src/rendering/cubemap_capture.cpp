@@ -0,0 +1,76 @@
+#include "cubemap_capture.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "math/calc.h"
+
+#include "vulkan/core.h"
+#include "vulkan/texture.h"
+#include "vulkan/render_info.h"
+#include "vulkan/command_buffer.h"
+#include "vulkan/pipeline_cache.h"
+#include "vulkan/pipeline_definition.h"
+
+using namespace llt;
+
+CubemapCapture::CubemapCapture()
+	: m_pushConstants()
+{
+	setOrigin(glm::vec3(0.0f));
+	setClipPlanes(0.1f, 10.0f);
+}
+
+CubemapCapture::~CubemapCapture()
+{
+}
+
+void CubemapCapture::setOrigin(const glm::vec3 &origin)
+{
+	m_pushConstants.origin = glm::vec4(origin, 1.0f);
+}
+
+void CubemapCapture::setClipPlanes(float near, float far)
+{
+	m_pushConstants.proj = glm::perspective(glm::radians(90.0f), 1.0f, near, far);
+}
+
+const CubemapCapture::PushConstants &CubemapCapture::getPushConstants() const
+{
+	return m_pushConstants;
+}
+
+void CubemapCapture::render(
+	CommandBuffer &cmd,
+	Texture *target,
+	int mipLevel,
+	VkAttachmentLoadOp loadOp,
+	GraphicsPipelineDefinition &pipeline,
+	const DrawFn &draw
+)
+{
+	uint32_t size = CalcU::max(target->getWidth() >> mipLevel, 1);
+
+	RenderInfo info;
+	info.setSize(size, size);
+	info.setViewMask(FACE_VIEW_MASK);
+	info.addColourAttachment(loadOp, target->getLayeredAttachmentView(mipLevel));
+
+	PipelineData pipelineData = g_vkCore->getPipelineCache().fetchGraphicsPipeline(pipeline, info);
+
+	cmd.beginRendering(info);
+	{
+		cmd.bindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineData.pipeline);
+
+		cmd.setViewport({ 0, 0, (float)size, (float)size });
+
+		cmd.pushConstants(
+			pipelineData.layout,
+			VK_SHADER_STAGE_ALL_GRAPHICS,
+			sizeof(m_pushConstants),
+			&m_pushConstants
+		);
+
+		draw(cmd, pipelineData);
+	}
+	cmd.endRendering();
+}
@@ -0,0 +1,65 @@
+#ifndef CUBEMAP_CAPTURE_H_
+#define CUBEMAP_CAPTURE_H_
+
+#include <glm/glm.hpp>
+
+#include "third_party/volk.h"
+
+#include "container/function.h"
+
+namespace llt
+{
+	class Texture;
+	class CommandBuffer;
+	class GraphicsPipelineDefinition;
+	struct PipelineData;
+
+	/**
+	 * Draws into all six faces of a cubemap mip in one pass rather than one pass per face.
+	 *
+	 * The pass is a multiview one with a bit per face in its view mask, so everything drawn runs once per face
+	 * with SV_ViewID saying which. cubemap_capture_vs has the six face rotations built in and only needs the
+	 * projection and where the capture is from pushed, so the same path works for the ibl bakes and for
+	 * reflection probes placed around a scene. Faces go +x, -x, +y, -y, +z, -z as in vulkan.
+	 */
+	class CubemapCapture
+	{
+	public:
+		static constexpr uint32_t FACE_VIEW_MASK = 0b111111;
+
+		struct PushConstants
+		{
+			glm::mat4 proj;
+			glm::vec4 origin;
+		};
+
+		using DrawFn = Function<void(CommandBuffer &, const PipelineData &)>;
+
+		CubemapCapture();
+		~CubemapCapture();
+
+		void setOrigin(const glm::vec3 &origin);
+		void setClipPlanes(float near, float far);
+
+		const PushConstants &getPushConstants() const;
+
+		/*
+		 * Records a pass over every face of the mip, the target has to be in COLOR_ATTACHMENT layout already.
+		 * The pipeline is bound and the push constants are set by the time draw gets called, so it only has to
+		 * bind its descriptor sets and draw. The pipeline's shader has to be built around cubemap_capture_vs.
+		 */
+		void render(
+			CommandBuffer &cmd,
+			Texture *target,
+			int mipLevel,
+			VkAttachmentLoadOp loadOp,
+			GraphicsPipelineDefinition &pipeline,
+			const DrawFn &draw
+		);
+
+	private:
+		PushConstants m_pushConstants;
+	};
+}
+
+#endif // CUBEMAP_CAPTURE_H_
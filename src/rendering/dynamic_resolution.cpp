@@ -0,0 +1,177 @@
+#include "dynamic_resolution.h"
+
+#include "core/profiler.h"
+#include "core/cpu_profiler.h"
+
+#include "math/calc.h"
+
+llt::DynamicResolution llt::g_dynamicResolution;
+
+using namespace llt;
+
+// the zone Renderer::render times the forward pass with
+static constexpr const char *FORWARD_ZONE = "forward";
+
+// how much of each new sample goes into the smoothed time
+static constexpr double SMOOTHING = 0.2;
+
+// over the target for this many samples in a row before the scale drops
+static constexpr int DECREASE_SAMPLES = 3;
+
+// under this much of the target for this many samples in a row before it goes back up
+static constexpr double INCREASE_THRESHOLD = 0.8;
+static constexpr int INCREASE_SAMPLES = 30;
+
+// going up aims this far under the target, so it doesn't land straight back over it
+static constexpr double INCREASE_AIM = 0.9;
+
+static constexpr float MAX_DECREASE = 0.25f;
+static constexpr float MAX_INCREASE = 0.125f;
+
+DynamicResolution::DynamicResolution()
+	: m_enabled(false)
+	, m_scale(MAX_SCALE)
+	, m_targetMs(0.0f)
+	, m_minScale(DEFAULT_MIN_SCALE)
+	, m_smoothedMs(0.0)
+	, m_lastSampleFrame(0)
+	, m_firstValidFrame(0)
+	, m_samplesOver(0)
+	, m_samplesUnder(0)
+{
+}
+
+void DynamicResolution::update()
+{
+	if (!m_enabled || m_targetMs <= 0.0f) {
+		return;
+	}
+
+	double ms = 0.0;
+	uint64_t frameIndex = 0;
+
+	if (!g_profiler->getLatestZoneTime(FORWARD_ZONE, &ms, &frameIndex)) {
+		return;
+	}
+
+	// either seen already, or rendered at a scale that isn't the current one
+	if (frameIndex <= m_lastSampleFrame || frameIndex < m_firstValidFrame) {
+		return;
+	}
+
+	m_lastSampleFrame = frameIndex;
+
+	if (m_smoothedMs <= 0.0) {
+		m_smoothedMs = ms;
+	} else {
+		m_smoothedMs += (ms - m_smoothedMs) * SMOOTHING;
+	}
+
+	if (m_smoothedMs > m_targetMs)
+	{
+		m_samplesOver++;
+		m_samplesUnder = 0;
+	}
+	else if (m_smoothedMs < m_targetMs * INCREASE_THRESHOLD)
+	{
+		m_samplesUnder++;
+		m_samplesOver = 0;
+	}
+	else
+	{
+		m_samplesOver = 0;
+		m_samplesUnder = 0;
+	}
+
+	bool decrease = m_samplesOver >= DECREASE_SAMPLES && m_scale > m_minScale;
+	bool increase = m_samplesUnder >= INCREASE_SAMPLES && m_scale < MAX_SCALE;
+
+	if (!decrease && !increase) {
+		return;
+	}
+
+	m_samplesOver = 0;
+	m_samplesUnder = 0;
+
+	// the forward pass costs roughly per pixel, so the time goes with the square of the scale
+	double aim = increase ? m_targetMs * INCREASE_AIM : m_targetMs;
+	float ideal = m_scale * (float)CalcD::sqrt(aim / CalcD::max(m_smoothedMs, 0.001));
+
+	float scale = increase
+		? CalcF::min(ideal, m_scale + MAX_INCREASE)
+		: CalcF::max(ideal, m_scale - MAX_DECREASE);
+
+	// always rounded down, so going up is cautious and going down is never too little
+	scale = CalcF::floor(scale / SCALE_STEP + 0.001f) * SCALE_STEP;
+	scale = CalcF::clamp(scale, m_minScale, MAX_SCALE);
+
+	if (scale == m_scale) {
+		return;
+	}
+
+	m_scale = scale;
+
+	// the frame being recorded now is the first one at the new scale
+	resetHistory();
+}
+
+void DynamicResolution::resetHistory()
+{
+	m_smoothedMs = 0.0;
+	m_samplesOver = 0;
+	m_samplesUnder = 0;
+	m_firstValidFrame = cpuprofiler::getFrameIndex();
+}
+
+bool DynamicResolution::isEnabled() const
+{
+	return m_enabled;
+}
+
+void DynamicResolution::setEnabled(bool enabled)
+{
+	m_enabled = enabled;
+
+	// back to full resolution when it's off, and starting from it when it's turned on
+	m_scale = MAX_SCALE;
+
+	resetHistory();
+}
+
+float DynamicResolution::getTargetMs() const
+{
+	return m_targetMs;
+}
+
+void DynamicResolution::setTargetMs(float targetMs)
+{
+	m_targetMs = targetMs;
+
+	resetHistory();
+}
+
+float DynamicResolution::getMinScale() const
+{
+	return m_minScale;
+}
+
+void DynamicResolution::setMinScale(float minScale)
+{
+	m_minScale = CalcF::clamp(minScale, SCALE_STEP, MAX_SCALE);
+	m_scale = CalcF::max(m_scale, m_minScale);
+}
+
+float DynamicResolution::getScale() const
+{
+	return m_scale;
+}
+
+uint32_t DynamicResolution::scaleSize(uint32_t size) const
+{
+	return CalcU::max((uint32_t)((float)size * m_scale + 0.5f), 1);
+}
+
+double DynamicResolution::getSmoothedMs() const
+{
+	return m_smoothedMs;
+}
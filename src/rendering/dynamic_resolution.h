@@ -0,0 +1,76 @@
+#ifndef DYNAMIC_RESOLUTION_H_
+#define DYNAMIC_RESOLUTION_H_
+
+#include "core/common.h"
+
+namespace llt
+{
+	/**
+	 * Picks the scale the scene is rendered at each frame so the forward pass stays within a gpu time budget.
+	 *
+	 * The forward zone's time comes back from the profiler a few frames late, and is smoothed before it's
+	 * compared with the target. It has to be over the target for a few samples in a row before the scale drops,
+	 * and well under it for a lot more before it goes back up, with nothing happening in between, so it settles
+	 * rather than flipping back and forth. Samples from frames rendered before the last change are ignored.
+	 *
+	 * The scale only says how much of the scene target gets rendered into, the target itself is never
+	 * reallocated (see GenericRenderTarget::setRenderArea), and the post process pass stretches it back out.
+	 */
+	class DynamicResolution
+	{
+	public:
+		static constexpr float MAX_SCALE = 1.0f;
+		static constexpr float DEFAULT_MIN_SCALE = 0.5f;
+
+		// the scale moves in steps of this, so tiny adjustments don't happen every other frame
+		static constexpr float SCALE_STEP = 1.0f / 32.0f;
+
+		DynamicResolution();
+		~DynamicResolution() = default;
+
+		/*
+		 * Reads the latest forward pass time and decides on the scale for the frame about to be recorded.
+		 * Does nothing while disabled.
+		 */
+		void update();
+
+		bool isEnabled() const;
+		void setEnabled(bool enabled);
+
+		float getTargetMs() const;
+		void setTargetMs(float targetMs);
+
+		float getMinScale() const;
+		void setMinScale(float minScale);
+
+		float getScale() const;
+
+		/*
+		 * A full size dimension at the current scale, never less than one.
+		 */
+		uint32_t scaleSize(uint32_t size) const;
+
+		double getSmoothedMs() const;
+
+	private:
+		void resetHistory();
+
+		bool m_enabled;
+
+		float m_scale;
+		float m_targetMs;
+		float m_minScale;
+
+		double m_smoothedMs;
+
+		uint64_t m_lastSampleFrame;
+		uint64_t m_firstValidFrame;
+
+		int m_samplesOver;
+		int m_samplesUnder;
+	};
+
+	extern DynamicResolution g_dynamicResolution;
+}
+
+#endif // DYNAMIC_RESOLUTION_H_
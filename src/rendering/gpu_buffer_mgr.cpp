@@ -52,6 +52,15 @@ GPUBuffer *GPUBufferMgr::createStagingBuffer(uint64_t size)
 	);
 }
 
+GPUBuffer *GPUBufferMgr::createReadbackBuffer(uint64_t size)
+{
+	return createBuffer(
+		VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VMA_MEMORY_USAGE_GPU_TO_CPU,
+		size
+	);
+}
+
 GPUBuffer *GPUBufferMgr::createVertexBuffer(uint64_t vertexCount, uint32_t vertexSize)
 {
 	GPUBuffer *vertexBuffer = createBuffer(
@@ -17,6 +17,7 @@ namespace llt
 		GPUBuffer *createBuffer(VkBufferUsageFlags usage, VmaMemoryUsage memoryUsage, uint64_t size);
 
 		GPUBuffer *createStagingBuffer(uint64_t size);
+		GPUBuffer *createReadbackBuffer(uint64_t size);
 		GPUBuffer *createVertexBuffer(uint64_t vertexCount, uint32_t vertexSize);
 		GPUBuffer *createIndexBuffer(uint64_t indexCount);
 		GPUBuffer *createUniformBuffer(uint64_t size);
@@ -0,0 +1,103 @@
+#include "ibl_cache.h"
+
+#include "texture_mgr.h"
+#include "gpu_buffer_mgr.h"
+
+#include "io/texture_container.h"
+
+#include "vulkan/core.h"
+#include "vulkan/util.h"
+#include "vulkan/texture.h"
+
+#include "math/calc.h"
+
+using namespace llt;
+
+static void formatKey(uint64_t key, char *buffer, uint64_t size)
+{
+	snprintf(buffer, size, "%016" PRIx64, key);
+}
+
+String iblcache::getPath(const String &sourcePath, const String &name)
+{
+	return sourcePath + "." + name + ".ktx2";
+}
+
+Texture *iblcache::load(const String &path, const String &name, uint64_t key)
+{
+	// the key is checked before anything is uploaded, a stale file is just a miss
+	{
+		TextureContainer container;
+
+		if (!container.load(path)) {
+			return nullptr;
+		}
+
+		const char *storedKey = container.getKeyValue(KEY_NAME);
+
+		char expectedKey[32] = {};
+		formatKey(key, expectedKey, sizeof(expectedKey));
+
+		if (!storedKey || cstr::compare(storedKey, expectedKey) != 0)
+		{
+			LLT_LOG("IBL cache is out of date: %s", path.cstr());
+			return nullptr;
+		}
+	}
+
+	return g_textureManager->load(name, path);
+}
+
+bool iblcache::save(const String &path, Texture *texture, uint64_t key)
+{
+	VkFormat format = texture->getFormat();
+	uint32_t texelSize = TextureContainerWriter::getTexelSize(format);
+
+	uint32_t faceCount = texture->getType() == VK_IMAGE_VIEW_TYPE_CUBE ? 6 : 1;
+
+	TextureContainerWriter writer;
+
+	if (!writer.init(format, texture->getWidth(), texture->getHeight(), texture->getMipLevels(), faceCount)) {
+		return false;
+	}
+
+	char keyString[32] = {};
+	formatKey(key, keyString, sizeof(keyString));
+
+	writer.addKeyValue(KEY_NAME, keyString);
+
+	uint64_t maxImageSize = (uint64_t)texture->getWidth() * texture->getHeight() * texelSize;
+
+	GPUBuffer *readbackBuffer = g_gpuBufferManager->createReadbackBuffer(maxImageSize);
+	Vector<byte> pixels(maxImageSize);
+
+	texture->transitionLayoutSingle(VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+
+	for (int mipLevel = 0; mipLevel < texture->getMipLevels(); mipLevel++)
+	{
+		uint64_t imageSize = (uint64_t)CalcU::max(texture->getWidth() >> mipLevel, 1) * CalcU::max(texture->getHeight() >> mipLevel, 1) * texelSize;
+
+		for (int i = 0; i < faceCount; i++)
+		{
+			CommandBuffer cmd = vkutil::beginSingleTimeCommands(g_vkCore->getGraphicsCommandPool());
+			readbackBuffer->readFromTexture(cmd, texture, 0, i, mipLevel);
+			vkutil::endSingleTimeGraphicsCommands(cmd);
+
+			readbackBuffer->readDataFromMe(pixels.data(), imageSize, 0);
+
+			writer.setSubresource(mipLevel, i, pixels.data(), imageSize);
+		}
+	}
+
+	texture->transitionLayoutSingle(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+	delete readbackBuffer;
+
+	if (!writer.save(path)) {
+		return false;
+	}
+
+	LLT_LOG("Saved IBL cache: %s", path.cstr());
+
+	return true;
+}
@@ -0,0 +1,40 @@
+#ifndef IBL_CACHE_H_
+#define IBL_CACHE_H_
+
+#include "core/common.h"
+
+#include "container/string.h"
+
+namespace llt
+{
+	class Texture;
+
+	/*
+	 * Keeps the baked ibl products (environment, irradiance and prefilter maps, the brdf lut) on disk
+	 * as KTX2 files, so they only have to be rendered again when whatever they were baked from changes.
+	 *
+	 * Each file stores the key it was baked with, anything that doesn't match is treated as a miss.
+	 */
+	namespace iblcache
+	{
+		static constexpr const char *KEY_NAME = "LLTcacheKey";
+
+		/*
+		 * Where the baked product called name for the given source lives.
+		 */
+		String getPath(const String &sourcePath, const String &name);
+
+		/*
+		 * Loads the texture through the texture manager under name, or returns nullptr if there's no
+		 * cache file or it was baked with a different key.
+		 */
+		Texture *load(const String &path, const String &name, uint64_t key);
+
+		/*
+		 * Reads every face and mip back off the gpu and writes them out. Stalls, so only do this once.
+		 */
+		bool save(const String &path, Texture *texture, uint64_t key);
+	}
+}
+
+#endif // IBL_CACHE_H_
@@ -2,6 +2,7 @@
 #define MATERIAL_H_
 
 #include "core/common.h"
+#include "core/mem_tracker.h"
 
 #include "container/array.h"
 #include "container/string.h"
@@ -78,7 +79,7 @@ namespace llt
 		}
 	};
 
-	class Material
+	class Material : public MemTagged<MEM_TAG_ASSETS>
 	{
 	public:
 		Material() = default;
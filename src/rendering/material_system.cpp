@@ -8,8 +8,17 @@
 #include "texture_mgr.h"
 #include "shader_mgr.h"
 #include "mesh_loader.h"
+#include "gpu_buffer_mgr.h"
+#include "ibl_cache.h"
+#include "cubemap_capture.h"
+
+#include "io/vfs.h"
+
+#include "core/thread_pool.h"
 
 #include "vulkan/core.h"
+#include "vulkan/util.h"
+#include "vulkan/image_ops.h"
 #include "vulkan/vertex_format.h"
 #include "vulkan/texture_view.h"
 #include "vulkan/descriptor_builder.h"
@@ -18,15 +27,151 @@ llt::MaterialSystem *llt::g_materialSystem = nullptr;
 
 using namespace llt;
 
+static constexpr int ENVIRONMENT_RESOLUTION = 1024;
+static constexpr int SH_PROJECTION_RESOLUTION = 32;
+static constexpr int PREFILTER_RESOLUTION = 128;
+static constexpr int PREFILTER_MIP_LEVELS = 5;
+static constexpr int BRDF_RESOLUTION = 512;
+
+static constexpr const char *ENVIRONMENT_HDR_PATH = "../../res/textures/rogland_clear_night_greg_zaal.hdr";
+static constexpr const char *BRDF_LUT_CACHE_PATH = "../../res/textures/brdf_lut.ktx2";
+
+// bump whenever the way the maps are baked changes in a way the shader hashes won't catch
+static constexpr uint64_t IBL_CACHE_VERSION = 1;
+
+static uint64_t calcCubemapSize(uint32_t size, uint32_t mipLevels, uint32_t texelSize)
+{
+	uint64_t total = 0;
+
+	for (int i = 0; i < mipLevels; i++)
+	{
+		uint64_t mipSize = CalcU::max(size >> i, 1);
+		total += mipSize * mipSize * 6 * texelSize;
+	}
+
+	return total;
+}
+
+// the passes render into the map and blit its mips, so both have to work in its format
+static bool canRenderDirectly(VkFormat format)
+{
+	VkFormatProperties formatProperties = {};
+	vkGetPhysicalDeviceFormatProperties(g_vkCore->m_physicalData.device, format, &formatProperties);
+
+	const VkFormatFeatureFlags required = VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT;
+
+	return (formatProperties.optimalTilingFeatures & required) == required;
+}
+
+/*
+ * What a map gets rendered into: the map itself, or an rgba32f copy of it when its format can't be rendered to.
+ */
+static Texture *createRenderTarget(Texture *map)
+{
+	if (canRenderDirectly(map->getFormat())) {
+		return map;
+	}
+
+	Texture *target = new Texture();
+
+	target->setSize(map->getWidth(), map->getHeight());
+	target->setProperties(VK_FORMAT_R32G32B32A32_SFLOAT, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_VIEW_TYPE_CUBE);
+	target->setMipLevels(map->getMipLevels());
+	target->createInternalResources();
+	target->transitionLayoutSingle(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+	return target;
+}
+
+/*
+ * Reads the float copy back a face at a time, packs it on the cpu and uploads it into the map.
+ * Only ever needed for E5B9G9R9, it's the only ibl format that can't be rendered to.
+ */
+static void packIntoRGB9E5(Texture *source, Texture *map)
+{
+	LLT_ASSERT(map->getFormat() == VK_FORMAT_E5B9G9R9_UFLOAT_PACK32, "Only E5B9G9R9 maps are packed on the cpu.");
+
+	uint64_t maxTexelCount = (uint64_t)source->getWidth() * source->getHeight();
+
+	GPUBuffer *readbackBuffer = g_gpuBufferManager->createReadbackBuffer(maxTexelCount * 4 * sizeof(float));
+	GPUBuffer *stagingBuffer = g_gpuBufferManager->createStagingBuffer(maxTexelCount * sizeof(uint32_t));
+
+	Vector<float> pixels(maxTexelCount * 4);
+	Vector<uint32_t> packed(maxTexelCount);
+
+	CommandBuffer transitionCmd = vkutil::beginSingleTimeCommands(g_vkCore->getGraphicsCommandPool());
+	{
+		source->transitionLayout(transitionCmd, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+		map->transitionLayout(transitionCmd, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+	}
+	vkutil::endSingleTimeGraphicsCommands(transitionCmd);
+
+	for (int mipLevel = 0; mipLevel < map->getMipLevels(); mipLevel++)
+	{
+		uint64_t texelCount = (uint64_t)CalcU::max(source->getWidth() >> mipLevel, 1) * CalcU::max(source->getHeight() >> mipLevel, 1);
+
+		for (int i = 0; i < 6; i++)
+		{
+			CommandBuffer readCmd = vkutil::beginSingleTimeCommands(g_vkCore->getGraphicsCommandPool());
+			readbackBuffer->readFromTexture(readCmd, source, 0, i, mipLevel);
+			vkutil::endSingleTimeGraphicsCommands(readCmd);
+
+			readbackBuffer->readDataFromMe(pixels.data(), texelCount * 4 * sizeof(float), 0);
+
+			imageops::packRGB9E5(pixels.data(), packed.data(), texelCount);
+
+			stagingBuffer->writeDataToMe(packed.data(), texelCount * sizeof(uint32_t), 0);
+
+			CommandBuffer writeCmd = vkutil::beginSingleTimeCommands(g_vkCore->getGraphicsCommandPool());
+			stagingBuffer->writeToTexture(writeCmd, map, texelCount * sizeof(uint32_t), 0, i, mipLevel);
+			vkutil::endSingleTimeGraphicsCommands(writeCmd);
+		}
+	}
+
+	map->transitionLayoutSingle(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+	delete readbackBuffer;
+	delete stagingBuffer;
+}
+
+/*
+ * Hands back the bindless slot of the cubemap view. The passes render through layered views, which never get one.
+ */
+static void releaseBindlessHandles(Texture *texture)
+{
+	g_bindlessResources->releaseCubemap(texture->getStandardView().getBindlessHandle());
+}
+
+static void resolveRenderTarget(Texture *target, Texture *map)
+{
+	if (target == map) {
+		return;
+	}
+
+	packIntoRGB9E5(target, map);
+
+	releaseBindlessHandles(target);
+
+	delete target;
+}
+
+/*
+ * Every format gets its own files so switching between them doesn't throw the others away.
+ */
+static String getEnvironmentCachePath(const char *name, IBLFormat format)
+{
+	return iblcache::getPath(ENVIRONMENT_HDR_PATH, String(name) + "." + MaterialSystem::getIBLFormatName(format));
+}
+
 MaterialSystem::MaterialSystem()
 	: m_registry()
+	, m_iblFormat(IBL_FORMAT_RGBA16F)
 	, m_descriptorPoolAllocator()
 	, m_environmentMap()
-	, m_irradianceMap()
 	, m_prefilterMap()
 	, m_brdfLUT()
+	, m_irradianceSH()
 	, m_equirectangularToCubemapPipeline()
-	, m_irradianceGenerationPipeline()
 	, m_prefilterGenerationPipeline()
 	, m_brdfIntegrationPipeline()
 {
@@ -71,195 +216,191 @@ void MaterialSystem::finalise()
 
 	CommandBuffer cmd = CommandBuffer::fromGraphics();
 
-	generateEnvironmentMaps(cmd);
-	precomputeBRDF(cmd);
+	if (!loadCachedEnvironmentMaps())
+	{
+		generateEnvironmentMaps(cmd);
+		saveEnvironmentMaps();
+	}
+
+	updateIrradianceSH();
+
+	m_brdfLUT = iblcache::load(BRDF_LUT_CACHE_PATH, "brdfIntegration", calcBRDFCacheKey());
+
+	if (!m_brdfLUT)
+	{
+		precomputeBRDF(cmd);
+		iblcache::save(BRDF_LUT_CACHE_PATH, m_brdfLUT, calcBRDFCacheKey());
+	}
 }
 
-// todo: this needs to be moved to a seperate class. IrradianceProbe or something idk
-// -> also lots of repeating code.
-void MaterialSystem::generateEnvironmentMaps(CommandBuffer &cmd)
+bool MaterialSystem::loadCachedEnvironmentMaps()
 {
-	glm::mat4 captureProjection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 10.0f);
+	uint64_t key = calcEnvironmentCacheKey();
 
-	glm::mat4 captureViews[] = {
-		glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3( 1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f)),
-		glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f)),
-		glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3( 0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)),
-		glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3( 0.0f,-1.0f, 0.0f), glm::vec3(0.0f, 0.0f,-1.0f)),
-		glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f),-glm::vec3( 0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f)),
-		glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f),-glm::vec3( 0.0f, 0.0f,-1.0f), glm::vec3(0.0f, 1.0f, 0.0f))
-	};
+	const char *names[] = { "environment_map", "prefilter_map" };
+	Texture *maps[2] = {};
 
-	SubMesh *cubeMesh = g_meshLoader->getCubeMesh();
+	bool loaded = true;
 
-	// ---
+	for (int i = 0; i < 2; i++)
+	{
+		maps[i] = iblcache::load(getEnvironmentCachePath(names[i], m_iblFormat), names[i], key);
+		loaded &= maps[i] != nullptr;
+	}
 
-	LLT_LOG("Generating environment map...");
+	if (!loaded)
+	{
+		// all or nothing, whatever did load gets baked over
+		for (int i = 0; i < 2; i++)
+		{
+			if (maps[i])
+			{
+				releaseBindlessHandles(maps[i]);
+				g_textureManager->destroyTexture(names[i]);
+			}
+		}
 
-	const int ENVIRONMENT_RESOLUTION = 1024;
+		return false;
+	}
 
-	m_environmentMap = g_textureManager->createCubemap(
-		"environment_map",
-		ENVIRONMENT_RESOLUTION,
-		VK_FORMAT_R32G32B32A32_SFLOAT,
-		4
-	);
+	m_environmentMap = maps[0];
+	m_prefilterMap = maps[1];
 
-	BoundTexture hdrImage(
-		g_textureManager->getTexture("environmentHDR"),
-		g_textureManager->getSampler("linear")
-	);
+	LLT_LOG("Loaded cached IBL maps (%s), %.2f MB.", getIBLFormatName(m_iblFormat), (double)getIBLMemorySize() / (double)LLT_MEGABYTES(1));
 
-	struct
-	{
-		glm::mat4 proj;
-		glm::mat4 view;
-	}
-	pc;
+	return true;
+}
 
-	pc.proj = captureProjection;
-	pc.view = glm::identity<glm::mat4>();
+void MaterialSystem::saveEnvironmentMaps()
+{
+	uint64_t key = calcEnvironmentCacheKey();
 
-	ShaderEffect *equirectangularToCubemapShader = g_shaderManager->getEffect("equirectangular_to_cubemap");
+	iblcache::save(getEnvironmentCachePath("environment_map", m_iblFormat), m_environmentMap, key);
+	iblcache::save(getEnvironmentCachePath("prefilter_map", m_iblFormat), m_prefilterMap, key);
+}
 
-	VkDescriptorSet etcDescriptorSet = m_descriptorPoolAllocator.allocate(equirectangularToCubemapShader->getDescriptorSetLayouts());
+uint64_t MaterialSystem::calcEnvironmentCacheKey() const
+{
+	uint64_t key = IBL_CACHE_VERSION;
 
-	DescriptorWriter()
-		.writeCombinedImage(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, hdrImage.getStandardImageInfo())
-		.updateSet(etcDescriptorSet);
+	VfsFile source = g_vfs->open(ENVIRONMENT_HDR_PATH);
 
-	m_equirectangularToCubemapPipeline.setShader(equirectangularToCubemapShader);
-	m_equirectangularToCubemapPipeline.setVertexFormat(g_primitiveVertexFormat);
-	m_equirectangularToCubemapPipeline.setDepthTest(false);
-	m_equirectangularToCubemapPipeline.setDepthWrite(false);
+	if (source.isOpen()) {
+		key = hash::calcBytes(key, source.data(), source.size());
+	}
 
-	cmd.beginRecording();
-	{
-		m_environmentMap->transitionLayout(cmd, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+	const char *effects[] = { "equirectangular_to_cubemap", "prefilter_convolution" };
 
-		for (int i = 0; i < 6; i++)
-		{
-			pc.view = captureViews[i];
+	for (auto *name : effects)
+	{
+		uint64_t effectHash = g_shaderManager->getEffect(name)->getCodeHash();
+		hash::combine(&key, &effectHash);
+	}
 
-			TextureView view = m_environmentMap->getView(1, i, 0);
+	const uint32_t settings[] = {
+		ENVIRONMENT_RESOLUTION,
+		PREFILTER_RESOLUTION,
+		PREFILTER_MIP_LEVELS,
+		(uint32_t)getIBLVkFormat(m_iblFormat)
+	};
 
-			RenderInfo targetInfo;
-			targetInfo.setSize(ENVIRONMENT_RESOLUTION, ENVIRONMENT_RESOLUTION);
-			targetInfo.addColourAttachment(VK_ATTACHMENT_LOAD_OP_LOAD, view);
+	return hash::calcBytes(key, settings, sizeof(settings));
+}
 
-			PipelineData pipelineData = g_vkCore->getPipelineCache().fetchGraphicsPipeline(m_equirectangularToCubemapPipeline, targetInfo);
+uint64_t MaterialSystem::calcBRDFCacheKey() const
+{
+	uint64_t key = IBL_CACHE_VERSION;
 
-			// todo: this is unoptimal: https://www.reddit.com/r/vulkan/comments/17rhrrc/question_about_rendering_to_cubemaps/
-			cmd.beginRendering(targetInfo);
-			{
-				cmd.bindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineData.pipeline);
+	uint64_t effectHash = g_shaderManager->getEffect("brdf_lut")->getCodeHash();
+	hash::combine(&key, &effectHash);
 
-				cmd.bindDescriptorSets(0, pipelineData.layout, { etcDescriptorSet }, {});
+	uint32_t resolution = BRDF_RESOLUTION;
+	hash::combine(&key, &resolution);
 
-				cmd.setViewport({ 0, 0, ENVIRONMENT_RESOLUTION, ENVIRONMENT_RESOLUTION });
+	return key;
+}
 
-				cmd.pushConstants(
-					pipelineData.layout,
-					VK_SHADER_STAGE_ALL_GRAPHICS,
-					sizeof(pc),
-					&pc
-				);
+void MaterialSystem::generateEnvironmentMaps(CommandBuffer &cmd)
+{
+	CubemapCapture capture;
+	capture.setClipPlanes(0.1f, 10.0f);
 
-				cubeMesh->render(cmd);
-			}
-			cmd.endRendering();
-		}
+	SubMesh *cubeMesh = g_meshLoader->getCubeMesh();
 
-		m_environmentMap->generateMipmaps(cmd);
-	}
-	cmd.submit();
+	VkFormat format = getIBLVkFormat(m_iblFormat);
 
 	// ---
-	
-	LLT_LOG("Generating irradiance map...");
 
-	const int IRRADIANCE_RESOLUTION = 32;
+	LLT_LOG("Generating environment map (%s)...", getIBLFormatName(m_iblFormat));
 
-	m_irradianceMap = g_textureManager->createCubemap(
-		"irradiance_map",
-		IRRADIANCE_RESOLUTION,
-		VK_FORMAT_R32G32B32A32_SFLOAT,
-		4
+	m_environmentMap = g_textureManager->createCubemap(
+		"environment_map",
+		ENVIRONMENT_RESOLUTION,
+		format,
+		vkutil::calcMipLevels(ENVIRONMENT_RESOLUTION, ENVIRONMENT_RESOLUTION)
 	);
 
-	BoundTexture envMapImage(
-		m_environmentMap,
+	// the prefilter pass samples the target too, so a packed map doesn't cost it any precision
+	Texture *environmentTarget = createRenderTarget(m_environmentMap);
+
+	// only needed when there's no cached bake. it's only ever sampled at the top level when it gets projected into the cubemap, so it's cooked without mips
+	g_textureManager->loadMany({
+		{ "environmentHDR", ENVIRONMENT_HDR_PATH, TEXTURE_COMPRESSION_BC6H, false }
+	});
+
+	BoundTexture hdrImage(
+		g_textureManager->getTexture("environmentHDR"),
 		g_textureManager->getSampler("linear")
 	);
-	
-	ShaderEffect *irradianceGenerationShader = g_shaderManager->getEffect("irradiance_convolution");
 
-	VkDescriptorSet icDescriptorSet = m_descriptorPoolAllocator.allocate(irradianceGenerationShader->getDescriptorSetLayouts());
+	ShaderEffect *equirectangularToCubemapShader = g_shaderManager->getEffect("equirectangular_to_cubemap");
+
+	VkDescriptorSet etcDescriptorSet = m_descriptorPoolAllocator.allocate(equirectangularToCubemapShader->getDescriptorSetLayouts());
 
 	DescriptorWriter()
-		.writeCombinedImage(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, envMapImage.getStandardImageInfo())
-		.updateSet(icDescriptorSet);
+		.writeCombinedImage(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, hdrImage.getStandardImageInfo())
+		.updateSet(etcDescriptorSet);
 
-	m_irradianceGenerationPipeline.setShader(irradianceGenerationShader);
-	m_irradianceGenerationPipeline.setVertexFormat(g_primitiveVertexFormat);
-	m_irradianceGenerationPipeline.setDepthTest(false);
-	m_irradianceGenerationPipeline.setDepthWrite(false);
+	m_equirectangularToCubemapPipeline.setShader(equirectangularToCubemapShader);
+	m_equirectangularToCubemapPipeline.setVertexFormat(g_primitiveVertexFormat);
+	m_equirectangularToCubemapPipeline.setDepthTest(false);
+	m_equirectangularToCubemapPipeline.setDepthWrite(false);
 
 	cmd.beginRecording();
 	{
-		m_irradianceMap->transitionLayout(cmd, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+		environmentTarget->transitionLayout(cmd, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
 
-		for (int i = 0; i < 6; i++)
+		capture.render(cmd, environmentTarget, 0, VK_ATTACHMENT_LOAD_OP_LOAD, m_equirectangularToCubemapPipeline, [&](CommandBuffer &cmd, const PipelineData &pipelineData) -> void
 		{
-			pc.view = captureViews[i];
-
-			TextureView view = m_irradianceMap->getView(1, i, 0);
-
-			RenderInfo targetInfo;
-			targetInfo.setSize(IRRADIANCE_RESOLUTION, IRRADIANCE_RESOLUTION);
-			targetInfo.addColourAttachment(VK_ATTACHMENT_LOAD_OP_LOAD, view);
+			cmd.bindDescriptorSets(0, pipelineData.layout, { etcDescriptorSet }, {});
 
-			PipelineData pipelineData = g_vkCore->getPipelineCache().fetchGraphicsPipeline(m_irradianceGenerationPipeline, targetInfo);
+			cubeMesh->render(cmd);
+		});
 
-			// todo: this is unoptimal: https://www.reddit.com/r/vulkan/comments/17rhrrc/question_about_rendering_to_cubemaps/
-			cmd.beginRendering(targetInfo);
-			{
-				cmd.bindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineData.pipeline);
-
-				cmd.bindDescriptorSets(0, pipelineData.layout, { icDescriptorSet }, {});
-
-				cmd.setViewport({ 0, 0, IRRADIANCE_RESOLUTION, IRRADIANCE_RESOLUTION });
-
-				cmd.pushConstants(
-					pipelineData.layout,
-					VK_SHADER_STAGE_ALL_GRAPHICS,
-					sizeof(pc),
-					&pc
-				);
-
-				cubeMesh->render(cmd);
-			}
-			cmd.endRendering();
-		}
-
-		m_irradianceMap->generateMipmaps(cmd);
+		environmentTarget->generateMipmaps(cmd);
 	}
 	cmd.submit();
 
 	// ---
+	
+	BoundTexture envMapImage(
+		environmentTarget,
+		g_textureManager->getSampler("linear")
+	);
 
-	LLT_LOG("Generating prefilter map...");
+	// ---
 
-	const int PREFILTER_RESOLUTION = 128;
-	const int PREFILTER_MIP_LEVELS = 5;
+	LLT_LOG("Generating prefilter map...");
 
 	m_prefilterMap = g_textureManager->createCubemap(
 		"prefilter_map",
 		PREFILTER_RESOLUTION,
-		VK_FORMAT_R32G32B32A32_SFLOAT,
+		format,
 		PREFILTER_MIP_LEVELS
 	);
 
+	Texture *prefilterTarget = createRenderTarget(m_prefilterMap);
+
 	struct
 	{
 		float roughness = 0.0f;
@@ -287,63 +428,287 @@ void MaterialSystem::generateEnvironmentMaps(CommandBuffer &cmd)
 
 	cmd.beginRecording();
 	{
-		m_prefilterMap->transitionLayout(cmd, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+		prefilterTarget->transitionLayout(cmd, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
 
 		for (int mipLevel = 0; mipLevel < PREFILTER_MIP_LEVELS; mipLevel++)
 		{
-			int width = PREFILTER_RESOLUTION >> mipLevel;
-			int height = PREFILTER_RESOLUTION >> mipLevel;
-
 			float roughness = (float)mipLevel / (float)(PREFILTER_MIP_LEVELS - 1);
 
 			prefilterParams.roughness = roughness;
 			uint32_t dynamicOffset = sizeof(prefilterParams) * mipLevel;
 			pfParameterBuffer->writeDataToMe(&prefilterParams, sizeof(prefilterParams), dynamicOffset);
 
-			for (int i = 0; i < 6; i++)
+			capture.render(cmd, prefilterTarget, mipLevel, VK_ATTACHMENT_LOAD_OP_LOAD, m_prefilterGenerationPipeline, [&](CommandBuffer &cmd, const PipelineData &pipelineData) -> void
 			{
-				pc.view = captureViews[i];
+				cmd.bindDescriptorSets(
+					0,
+					pipelineData.layout,
+					{ pfDescriptorSet },
+					{ dynamicOffset }
+				);
 
-				TextureView view = m_prefilterMap->getView(1, i, mipLevel);
+				cubeMesh->render(cmd);
+			});
+		}
+	}
+	cmd.submit();
 
-				RenderInfo info;
-				info.setSize(width, height);
-				info.addColourAttachment(VK_ATTACHMENT_LOAD_OP_LOAD, view);
+	prefilterTarget->transitionLayoutSingle(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 
-				PipelineData pipelineData = g_vkCore->getPipelineCache().fetchGraphicsPipeline(m_prefilterGenerationPipeline, info);
+	delete pfParameterBuffer;
 
-				// todo: this is unoptimal: https://www.reddit.com/r/vulkan/comments/17rhrrc/question_about_rendering_to_cubemaps/
-				cmd.beginRendering(info);
-				{
-					cmd.bindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineData.pipeline);
+	// ---
 
-					cmd.bindDescriptorSets(
-						0,
-						pipelineData.layout,
-						{ pfDescriptorSet },
-						{ dynamicOffset }
-					);
+	resolveRenderTarget(environmentTarget, m_environmentMap);
+	resolveRenderTarget(prefilterTarget, m_prefilterMap);
 
-					cmd.setViewport({ 0, 0, (float)width, (float)height });
+	LLT_LOG("IBL maps take up %.2f MB.", (double)getIBLMemorySize() / (double)LLT_MEGABYTES(1));
+}
 
-					cmd.pushConstants(
-						pipelineData.layout,
-						VK_SHADER_STAGE_ALL_GRAPHICS,
-						sizeof(pc),
-						&pc
-					);
+void MaterialSystem::updateIrradianceSH()
+{
+	// the projection only needs a small mip, there's nothing left for 9 coefficients to pick up in the bigger ones
+	uint32_t sourceMip = 0;
 
-					cubeMesh->render(cmd);
-				}
-				cmd.endRendering();
-			}
+	while ((m_environmentMap->getWidth() >> sourceMip) > SH_PROJECTION_RESOLUTION && sourceMip + 1 < m_environmentMap->getMipLevels()) {
+		sourceMip++;
+	}
+
+	uint32_t size = CalcU::max(m_environmentMap->getWidth() >> sourceMip, 1);
+
+	// blitting into an rgba32f copy decodes whatever format the map is stored in
+	Texture *faces = new Texture();
+
+	faces->setSize(size, size);
+	faces->setProperties(VK_FORMAT_R32G32B32A32_SFLOAT, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_VIEW_TYPE_CUBE);
+	faces->createInternalResources();
+
+	Vector<VkImageBlit> regions;
+
+	for (int i = 0; i < 6; i++)
+	{
+		VkImageBlit region = {};
+
+		region.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, sourceMip, (uint32_t)i, 1 };
+		region.srcOffsets[1] = { (int32_t)size, (int32_t)size, 1 };
+
+		region.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, (uint32_t)i, 1 };
+		region.dstOffsets[1] = { (int32_t)size, (int32_t)size, 1 };
+
+		regions.pushBack(region);
+	}
+
+	uint64_t faceSize = (uint64_t)size * size * 4 * sizeof(float);
+
+	GPUBuffer *readbackBuffer = g_gpuBufferManager->createReadbackBuffer(faceSize * 6);
+
+	CommandBuffer cmd = vkutil::beginSingleTimeCommands(g_vkCore->getGraphicsCommandPool());
+	{
+		m_environmentMap->transitionLayout(cmd, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+		faces->transitionLayout(cmd, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+		cmd.blitImage(
+			m_environmentMap->getImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			faces->getImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			regions,
+			VK_FILTER_NEAREST
+		);
+
+		m_environmentMap->transitionLayout(cmd, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		faces->transitionLayout(cmd, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+
+		for (int i = 0; i < 6; i++) {
+			readbackBuffer->readFromTexture(cmd, faces, faceSize * i, i, 0);
 		}
 	}
-	cmd.submit();
+	vkutil::endSingleTimeGraphicsCommands(cmd);
 
-	m_prefilterMap->transitionLayoutSingle(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	Vector<float> pixels(size * size * 4 * 6);
+	readbackBuffer->readDataFromMe(pixels.data(), faceSize * 6, 0);
 
-	delete pfParameterBuffer;
+	delete readbackBuffer;
+
+	releaseBindlessHandles(faces);
+	delete faces;
+
+	calcIrradianceSH(pixels.data(), size, m_irradianceSH);
+}
+
+void MaterialSystem::calcIrradianceSH(const float *faces, uint32_t size, glm::vec4 *coefficients)
+{
+	float faceSH[6][imageops::SH9_FLOAT_COUNT] = {};
+
+	uint64_t faceFloatCount = (uint64_t)size * size * 4;
+
+	g_threadPool->parallelFor(6, [&](uint32_t face) {
+		imageops::projectSH9(faces + faceFloatCount * face, size, face, faceSH[face]);
+	});
+
+	float sh[imageops::SH9_FLOAT_COUNT] = {};
+
+	for (int face = 0; face < 6; face++)
+	{
+		for (int i = 0; i < imageops::SH9_FLOAT_COUNT; i++) {
+			sh[i] += faceSH[face][i];
+		}
+	}
+
+	float normalisation = (4.0f * CalcF::PI) / sh[27];
+
+	// convolving radiance with the clamped cosine lobe scales each band by pi, 2pi/3 and pi/4, which is then divided by pi to
+	// match what the old irradiance map stored. the basis constants are folded in too, so the shader only has the polynomial left
+	const float bandScales[IRRADIANCE_SH_COEFFICIENT_COUNT] = { 1.0f, 2.0f / 3.0f, 2.0f / 3.0f, 2.0f / 3.0f, 0.25f, 0.25f, 0.25f, 0.25f, 0.25f };
+	const float basisConstants[IRRADIANCE_SH_COEFFICIENT_COUNT] = { 0.282095f, 0.488603f, 0.488603f, 0.488603f, 1.092548f, 1.092548f, 0.315392f, 1.092548f, 0.546274f };
+
+	for (int i = 0; i < IRRADIANCE_SH_COEFFICIENT_COUNT; i++)
+	{
+		float scale = normalisation * bandScales[i] * basisConstants[i];
+		coefficients[i] = glm::vec4(sh[i*3 + 0], sh[i*3 + 1], sh[i*3 + 2], 0.0f) * scale;
+	}
+}
+
+void MaterialSystem::releaseEnvironmentMaps()
+{
+	if (!m_environmentMap) {
+		return;
+	}
+
+	releaseBindlessHandles(m_environmentMap);
+	releaseBindlessHandles(m_prefilterMap);
+
+	g_textureManager->destroyTexture("environment_map");
+	g_textureManager->destroyTexture("prefilter_map");
+
+	m_environmentMap = nullptr;
+	m_prefilterMap = nullptr;
+}
+
+void MaterialSystem::setIBLFormat(IBLFormat format)
+{
+	if (format == m_iblFormat) {
+		return;
+	}
+
+	if (!isIBLFormatSupported(format))
+	{
+		LLT_LOG("IBL format %s isn't supported, sticking with %s.", getIBLFormatName(format), getIBLFormatName(m_iblFormat));
+		return;
+	}
+
+	m_iblFormat = format;
+
+	// nothing to regenerate until finalise() has made them
+	if (!m_environmentMap) {
+		return;
+	}
+
+	// every frame in flight is sampling the old maps
+	g_vkCore->syncStall();
+
+	releaseEnvironmentMaps();
+
+	// the only sets in here are the ones used to generate the maps and the brdf lut, none of which are needed any more
+	m_descriptorPoolAllocator.clear();
+
+	if (!loadCachedEnvironmentMaps())
+	{
+		CommandBuffer cmd = CommandBuffer::fromGraphics();
+
+		generateEnvironmentMaps(cmd);
+		saveEnvironmentMaps();
+	}
+
+	updateIrradianceSH();
+}
+
+IBLFormat MaterialSystem::getIBLFormat() const
+{
+	return m_iblFormat;
+}
+
+bool MaterialSystem::isIBLFormatSupported(IBLFormat format)
+{
+	VkFormatProperties formatProperties = {};
+	vkGetPhysicalDeviceFormatProperties(g_vkCore->m_physicalData.device, getIBLVkFormat(format), &formatProperties);
+
+	const VkFormatFeatureFlags required = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+	return (formatProperties.optimalTilingFeatures & required) == required;
+}
+
+VkFormat MaterialSystem::getIBLVkFormat(IBLFormat format)
+{
+	switch (format)
+	{
+		case IBL_FORMAT_RGBA32F:
+			return VK_FORMAT_R32G32B32A32_SFLOAT;
+
+		case IBL_FORMAT_RGBA16F:
+			return VK_FORMAT_R16G16B16A16_SFLOAT;
+
+		case IBL_FORMAT_RGB9E5:
+			return VK_FORMAT_E5B9G9R9_UFLOAT_PACK32;
+
+		default:
+			LLT_ERROR("Unknown IBL format: %d", format);
+			return VK_FORMAT_UNDEFINED;
+	}
+}
+
+const char *MaterialSystem::getIBLFormatName(IBLFormat format)
+{
+	switch (format)
+	{
+		case IBL_FORMAT_RGBA32F:
+			return "RGBA32F";
+
+		case IBL_FORMAT_RGBA16F:
+			return "RGBA16F";
+
+		case IBL_FORMAT_RGB9E5:
+			return "RGB9E5";
+
+		default:
+			return "Unknown";
+	}
+}
+
+uint64_t MaterialSystem::calcIBLMemorySize(IBLFormat format)
+{
+	uint32_t texelSize = 0;
+
+	switch (format)
+	{
+		case IBL_FORMAT_RGBA32F:
+			texelSize = 16;
+			break;
+
+		case IBL_FORMAT_RGBA16F:
+			texelSize = 8;
+			break;
+
+		case IBL_FORMAT_RGB9E5:
+			texelSize = 4;
+			break;
+
+		default:
+			LLT_ERROR("Unknown IBL format: %d", format);
+	}
+
+	return
+		calcCubemapSize(ENVIRONMENT_RESOLUTION, vkutil::calcMipLevels(ENVIRONMENT_RESOLUTION, ENVIRONMENT_RESOLUTION), texelSize) +
+		calcCubemapSize(PREFILTER_RESOLUTION, PREFILTER_MIP_LEVELS, texelSize);
+}
+
+uint64_t MaterialSystem::getIBLMemorySize() const
+{
+	if (!m_environmentMap) {
+		return 0;
+	}
+
+	return
+		m_environmentMap->getAllocationSize() +
+		m_prefilterMap->getAllocationSize();
 }
 
 void MaterialSystem::precomputeBRDF(CommandBuffer &cmd)
@@ -352,8 +717,6 @@ void MaterialSystem::precomputeBRDF(CommandBuffer &cmd)
 
 	SubMesh *quadMesh = g_meshLoader->getQuadMesh();
 
-	const int BRDF_RESOLUTION = 512;
-
 	m_brdfLUT = g_textureManager->createAttachment(
 		"brdfIntegration",
 		BRDF_RESOLUTION, BRDF_RESOLUTION,
@@ -377,6 +740,9 @@ void MaterialSystem::precomputeBRDF(CommandBuffer &cmd)
 	PipelineData pipelineData = g_vkCore->getPipelineCache().fetchGraphicsPipeline(m_brdfIntegrationPipeline, info);
 
 	cmd.beginRecording();
+
+	m_brdfLUT->transitionLayout(cmd, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+
 	cmd.beginRendering(info);
 
 	cmd.bindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineData.pipeline);
@@ -388,6 +754,9 @@ void MaterialSystem::precomputeBRDF(CommandBuffer &cmd)
 	quadMesh->render(cmd);
 
 	cmd.endRendering();
+
+	m_brdfLUT->transitionLayout(cmd, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
 	cmd.submit();
 }
 
@@ -401,9 +770,14 @@ const MaterialRegistry &MaterialSystem::getRegistry() const
 	return m_registry;
 }
 
-Texture *MaterialSystem::getIrradianceMap() const
+Texture *MaterialSystem::getEnvironmentMap() const
+{
+	return m_environmentMap;
+}
+
+const glm::vec4 *MaterialSystem::getIrradianceSH() const
 {
-	return m_irradianceMap;
+	return m_irradianceSH;
 }
 
 Texture *MaterialSystem::getPrefilterMap() const
@@ -540,3 +914,16 @@ void MaterialRegistry::addTechnique(const String &name, const Technique &techniq
 {
 	m_techniques.insert(name, technique);
 }
+
+void MaterialRegistry::remapTexture(BindlessResourceID oldID, BindlessResourceID newID)
+{
+	for (auto &[hash, material] : m_materials)
+	{
+		for (auto &texture : material->m_textures)
+		{
+			if (texture.id == oldID) {
+				texture.id = newID;
+			}
+		}
+	}
+}
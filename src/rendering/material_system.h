@@ -25,9 +25,22 @@ namespace llt
 		Material *buildMaterial(MaterialData &data);
 		void addTechnique(const String &name, const Technique &technique);
 
+		/*
+		 * Points every material that uses the old texture slot at the new one instead.
+		 */
+		void remapTexture(BindlessResourceID oldID, BindlessResourceID newID);
+
 	private:
-		HashMap<uint64_t, Material*> m_materials;
-		HashMap<String, Technique> m_techniques;
+		HashMap<uint64_t, Material*, MEM_TAG_ASSETS> m_materials;
+		HashMap<String, Technique, MEM_TAG_ASSETS> m_techniques;
+	};
+
+	enum IBLFormat
+	{
+		IBL_FORMAT_RGBA32F,
+		IBL_FORMAT_RGBA16F,
+		IBL_FORMAT_RGB9E5,		// shared exponent, can't usually be rendered to so it's rendered in rgba32f and packed on the cpu
+		IBL_FORMAT_MAX_ENUM
 	};
 
 	class MaterialSystem
@@ -42,11 +55,48 @@ namespace llt
 		MaterialRegistry &getRegistry();
 		const MaterialRegistry &getRegistry() const;
 
-		Texture *getIrradianceMap() const;
+		static constexpr int IRRADIANCE_SH_COEFFICIENT_COUNT = 9;
+
+		/*
+		 * The format the environment and prefilter maps are stored in, rgba16f by default.
+		 * Changing it once the maps exist regenerates both, which stalls the gpu.
+		 */
+		void setIBLFormat(IBLFormat format);
+		IBLFormat getIBLFormat() const;
+
+		static bool isIBLFormatSupported(IBLFormat format);
+		static VkFormat getIBLVkFormat(IBLFormat format);
+		static const char *getIBLFormatName(IBLFormat format);
+
+		/*
+		 * What the maps would take up in the given format, mips included.
+		 */
+		static uint64_t calcIBLMemorySize(IBLFormat format);
+
+		/*
+		 * What they actually take up right now, as allocated.
+		 */
+		uint64_t getIBLMemorySize() const;
+
+		Texture *getEnvironmentMap() const;
 		Texture *getPrefilterMap() const;
 
 		Texture *getBRDFLUT() const;
 
+		/*
+		 * Reprojects the environment map into the irradiance sh, e.g: after a dynamic sky has been rendered into it.
+		 * Reads a 32x32 mip back off the gpu, so it stalls, but the projection itself is only a few thousand texels.
+		 */
+		void updateIrradianceSH();
+
+		/*
+		 * Projects an rgba32f cubemap (faces back to back, +x, -x, +y, -y, +z, -z) into the coefficients the
+		 * shader evaluates for diffuse ambient. For skies that already have their pixels on the cpu.
+		 */
+		static void calcIrradianceSH(const float *faces, uint32_t size, glm::vec4 *coefficients);
+
+		const glm::vec4 *getIrradianceSH() const;
+
 		Texture *getDiffuseFallback() const;
 		Texture *getAOFallback() const;
 		Texture *getRoughnessMetallicFallback() const;
@@ -55,19 +105,32 @@ namespace llt
 
 	private:
 		void generateEnvironmentMaps(CommandBuffer &cmd);
+		void releaseEnvironmentMaps();
+
+		/*
+		 * The baked maps are cached on disk per format, keyed on everything that goes into baking them.
+		 */
+		bool loadCachedEnvironmentMaps();
+		void saveEnvironmentMaps();
+
+		uint64_t calcEnvironmentCacheKey() const;
+		uint64_t calcBRDFCacheKey() const;
+
 		void precomputeBRDF(CommandBuffer &cmd);
 
 		MaterialRegistry m_registry;
 
+		IBLFormat m_iblFormat;
+
 		DescriptorPoolDynamic m_descriptorPoolAllocator;
 
 		Texture *m_environmentMap;
-		Texture *m_irradianceMap;
 		Texture *m_prefilterMap;
 		Texture *m_brdfLUT;
 
+		glm::vec4 m_irradianceSH[IRRADIANCE_SH_COEFFICIENT_COUNT];
+
 		GraphicsPipelineDefinition m_equirectangularToCubemapPipeline;
-		GraphicsPipelineDefinition m_irradianceGenerationPipeline;
 		GraphicsPipelineDefinition m_prefilterGenerationPipeline;
 		GraphicsPipelineDefinition m_brdfIntegrationPipeline;
 	};
@@ -1,6 +1,8 @@
 #ifndef MODEL_H_
 #define MODEL_H_
 
+#include "core/mem_tracker.h"
+
 #include "container/string.h"
 #include "container/vector.h"
 
@@ -10,7 +12,7 @@ namespace llt
 {
 	class RenderObject;
 
-	class Mesh
+	class Mesh : public MemTagged<MEM_TAG_ASSETS>
 	{
 	public:
 		Mesh();
@@ -0,0 +1,324 @@
+#include "mesh_cache.h"
+
+#include <filesystem>
+#include <fstream>
+
+using namespace llt;
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+String meshcache::getCachePath(const String &sourcePath)
+{
+	return sourcePath + ".llmc";
+}
+
+MeshCacheWriter::MeshCacheWriter(uint32_t vertexSize)
+	: m_vertexSize(vertexSize)
+	, m_subMeshes()
+	, m_materials()
+	, m_strings()
+	, m_vertices()
+	, m_indices()
+{
+}
+
+void MeshCacheWriter::addSubMesh(
+	const void *pVertices, uint32_t nVertices,
+	const uint16_t *pIndices, uint32_t nIndices,
+	const glm::vec3 &boundsMin, const glm::vec3 &boundsMax,
+	uint32_t materialIndex
+)
+{
+	meshcache::SubMeshEntry entry = {};
+	entry.firstVertex = m_vertices.size() / m_vertexSize;
+	entry.vertexCount = nVertices;
+	entry.firstIndex = m_indices.size();
+	entry.indexCount = nIndices;
+	entry.materialIndex = materialIndex;
+
+	entry.boundsMin[0] = boundsMin.x;
+	entry.boundsMin[1] = boundsMin.y;
+	entry.boundsMin[2] = boundsMin.z;
+
+	entry.boundsMax[0] = boundsMax.x;
+	entry.boundsMax[1] = boundsMax.y;
+	entry.boundsMax[2] = boundsMax.z;
+
+	uint64_t vertexBytes = (uint64_t)nVertices * m_vertexSize;
+	uint64_t vertexStart = m_vertices.size();
+
+	m_vertices.resize(vertexStart + vertexBytes);
+	mem::copy(m_vertices.data() + vertexStart, pVertices, vertexBytes);
+
+	uint64_t indexStart = m_indices.size();
+
+	m_indices.resize(indexStart + nIndices);
+	mem::copy(m_indices.data() + indexStart, pIndices, sizeof(uint16_t) * nIndices);
+
+	m_subMeshes.pushBack(entry);
+}
+
+uint32_t MeshCacheWriter::addMaterial(const char *const *texturePaths)
+{
+	meshcache::MaterialEntry entry = {};
+
+	for (int i = 0; i < meshcache::TEXTURE_SLOT_COUNT; i++)
+	{
+		if (texturePaths[i] && texturePaths[i][0] != '\0') {
+			entry.textures[i] = addString(texturePaths[i]);
+		} else {
+			entry.textures[i] = meshcache::NO_TEXTURE;
+		}
+	}
+
+	m_materials.pushBack(entry);
+
+	return m_materials.size() - 1;
+}
+
+uint32_t MeshCacheWriter::addString(const char *str)
+{
+	uint32_t offset = m_strings.size();
+	uint64_t length = cstr::length(str) + 1; // include the null terminator
+
+	m_strings.resize(offset + length);
+	mem::copy(m_strings.data() + offset, str, length);
+
+	return offset;
+}
+
+bool MeshCacheWriter::save(const String &path, uint32_t importFlags, uint64_t sourceSize) const
+{
+	meshcache::Header header = {};
+	header.magic = meshcache::MAGIC;
+	header.version = meshcache::VERSION;
+	header.importFlags = importFlags;
+	header.vertexSize = m_vertexSize;
+	header.subMeshCount = m_subMeshes.size();
+	header.materialCount = m_materials.size();
+	header.sourceSize = sourceSize;
+
+	header.subMeshTableOffset = sizeof(meshcache::Header);
+	header.materialTableOffset = header.subMeshTableOffset + sizeof(meshcache::SubMeshEntry) * m_subMeshes.size();
+
+	header.stringTableOffset = header.materialTableOffset + sizeof(meshcache::MaterialEntry) * m_materials.size();
+	header.stringTableSize = m_strings.size();
+
+	header.vertexBlobOffset = alignUp(header.stringTableOffset + header.stringTableSize, meshcache::BLOB_ALIGNMENT);
+	header.vertexBlobSize = m_vertices.size();
+
+	header.indexBlobOffset = alignUp(header.vertexBlobOffset + header.vertexBlobSize, meshcache::BLOB_ALIGNMENT);
+	header.indexBlobSize = m_indices.size() * sizeof(uint16_t);
+
+	uint64_t totalSize = header.indexBlobOffset + header.indexBlobSize;
+
+	// assemble the whole file in memory first so a failed write never leaves a half-valid header behind
+	Vector<byte> data(totalSize, 0);
+
+	mem::copy(data.data(), &header, sizeof(header));
+	mem::copy(data.data() + header.subMeshTableOffset, m_subMeshes.data(), sizeof(meshcache::SubMeshEntry) * m_subMeshes.size());
+	mem::copy(data.data() + header.materialTableOffset, m_materials.data(), sizeof(meshcache::MaterialEntry) * m_materials.size());
+	mem::copy(data.data() + header.stringTableOffset, m_strings.data(), m_strings.size());
+	mem::copy(data.data() + header.vertexBlobOffset, m_vertices.data(), m_vertices.size());
+	mem::copy(data.data() + header.indexBlobOffset, m_indices.data(), header.indexBlobSize);
+
+	std::ofstream file(path.cstr(), std::ios::binary | std::ios::trunc);
+
+	if (!file.is_open())
+	{
+		LLT_LOG("Failed to open mesh cache for writing: %s", path.cstr());
+		return false;
+	}
+
+	file.write((const char *)data.data(), totalSize);
+
+	return file.good();
+}
+
+// ---
+
+MeshCacheReader::MeshCacheReader()
+	: m_header(nullptr)
+	, m_file()
+{
+}
+
+bool MeshCacheReader::isUpToDate(const String &cachePath, const String &sourcePath, uint32_t importFlags, uint32_t vertexSize)
+{
+	uint64_t sourceSize = 0;
+
+	if (!g_vfs->getFileSize(sourcePath, &sourceSize)) {
+		return false;
+	}
+
+	// only loose files have timestamps worth comparing, anything packed was cooked before it went in
+	if (!g_vfs->isInArchive(cachePath) && !g_vfs->isInArchive(sourcePath))
+	{
+		std::error_code ec;
+
+		auto cacheTime = std::filesystem::last_write_time(cachePath.cstr(), ec);
+		if (ec) return false;
+
+		auto sourceTime = std::filesystem::last_write_time(sourcePath.cstr(), ec);
+		if (ec) return false;
+
+		// source was modified after we cooked it, reimport
+		if (sourceTime > cacheTime) {
+			return false;
+		}
+	}
+
+	VfsFile file = g_vfs->open(cachePath);
+
+	if (!file.isOpen() || file.size() < sizeof(meshcache::Header)) {
+		return false;
+	}
+
+	meshcache::Header header = {};
+	mem::copy(&header, file.data(), sizeof(header));
+
+	return
+		header.magic == meshcache::MAGIC &&
+		header.version == meshcache::VERSION &&
+		header.importFlags == importFlags &&
+		header.vertexSize == vertexSize &&
+		header.sourceSize == sourceSize;
+}
+
+bool MeshCacheReader::open(const String &path, uint32_t importFlags, uint32_t vertexSize)
+{
+	m_file = g_vfs->open(path);
+
+	if (!m_file.isOpen()) {
+		return false;
+	}
+
+	if (m_file.size() < sizeof(meshcache::Header))
+	{
+		m_file = VfsFile();
+		return false;
+	}
+
+	m_header = (const meshcache::Header *)m_file.data();
+
+	if (!validate(importFlags, vertexSize))
+	{
+		m_header = nullptr;
+		m_file = VfsFile();
+
+		return false;
+	}
+
+	return true;
+}
+
+bool MeshCacheReader::validate(uint32_t importFlags, uint32_t vertexSize) const
+{
+	if (m_header->magic != meshcache::MAGIC || m_header->version != meshcache::VERSION) {
+		return false;
+	}
+
+	if (m_header->importFlags != importFlags || m_header->vertexSize != vertexSize || vertexSize == 0) {
+		return false;
+	}
+
+	// make sure nothing points outside of the file
+	if (!fitsInFile(m_header->subMeshTableOffset, sizeof(meshcache::SubMeshEntry) * (uint64_t)m_header->subMeshCount) ||
+		!fitsInFile(m_header->materialTableOffset, sizeof(meshcache::MaterialEntry) * (uint64_t)m_header->materialCount) ||
+		!fitsInFile(m_header->stringTableOffset, m_header->stringTableSize) ||
+		!fitsInFile(m_header->vertexBlobOffset, m_header->vertexBlobSize) ||
+		!fitsInFile(m_header->indexBlobOffset, m_header->indexBlobSize))
+	{
+		return false;
+	}
+
+	// every string is read as a c string, so the last one has to be terminated inside the table
+	const byte *strings = m_file.data() + m_header->stringTableOffset;
+
+	if (m_header->stringTableSize > 0 && strings[m_header->stringTableSize - 1] != '\0') {
+		return false;
+	}
+
+	uint64_t blobVertexCount = m_header->vertexBlobSize / m_header->vertexSize;
+	uint64_t blobIndexCount = m_header->indexBlobSize / sizeof(uint16_t);
+
+	const meshcache::SubMeshEntry *subMeshes = (const meshcache::SubMeshEntry *)(m_file.data() + m_header->subMeshTableOffset);
+
+	for (uint32_t i = 0; i < m_header->subMeshCount; i++)
+	{
+		const meshcache::SubMeshEntry &entry = subMeshes[i];
+
+		if ((uint64_t)entry.firstVertex + entry.vertexCount > blobVertexCount ||
+			(uint64_t)entry.firstIndex + entry.indexCount > blobIndexCount)
+		{
+			return false;
+		}
+
+		if (entry.materialIndex != meshcache::NO_MATERIAL && entry.materialIndex >= m_header->materialCount) {
+			return false;
+		}
+	}
+
+	const meshcache::MaterialEntry *materials = (const meshcache::MaterialEntry *)(m_file.data() + m_header->materialTableOffset);
+
+	for (uint32_t i = 0; i < m_header->materialCount; i++)
+	{
+		for (int j = 0; j < meshcache::TEXTURE_SLOT_COUNT; j++)
+		{
+			uint32_t offset = materials[i].textures[j];
+
+			if (offset != meshcache::NO_TEXTURE && offset >= m_header->stringTableSize) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool MeshCacheReader::fitsInFile(uint64_t offset, uint64_t size) const
+{
+	// written so a huge offset or size can't wrap around
+	return offset <= m_file.size() && size <= m_file.size() - offset;
+}
+
+uint32_t MeshCacheReader::getSubMeshCount() const
+{
+	return m_header ? m_header->subMeshCount : 0;
+}
+
+const meshcache::SubMeshEntry &MeshCacheReader::getSubMesh(int idx) const
+{
+	const meshcache::SubMeshEntry *entries = (const meshcache::SubMeshEntry *)(m_file.data() + m_header->subMeshTableOffset);
+	return entries[idx];
+}
+
+const void *MeshCacheReader::getVertices(const meshcache::SubMeshEntry &entry) const
+{
+	return m_file.data() + m_header->vertexBlobOffset + (uint64_t)entry.firstVertex * m_header->vertexSize;
+}
+
+const uint16_t *MeshCacheReader::getIndices(const meshcache::SubMeshEntry &entry) const
+{
+	return (const uint16_t *)(m_file.data() + m_header->indexBlobOffset) + entry.firstIndex;
+}
+
+uint32_t MeshCacheReader::getMaterialCount() const
+{
+	return m_header ? m_header->materialCount : 0;
+}
+
+const char *MeshCacheReader::getMaterialTexture(uint32_t materialIndex, int slot) const
+{
+	const meshcache::MaterialEntry *entries = (const meshcache::MaterialEntry *)(m_file.data() + m_header->materialTableOffset);
+	uint32_t offset = entries[materialIndex].textures[slot];
+
+	if (offset == meshcache::NO_TEXTURE) {
+		return nullptr;
+	}
+
+	return (const char *)(m_file.data() + m_header->stringTableOffset + offset);
+}
@@ -0,0 +1,166 @@
+#ifndef MESH_CACHE_H_
+#define MESH_CACHE_H_
+
+#include <glm/vec3.hpp>
+
+#include "core/common.h"
+
+#include "container/vector.h"
+#include "container/string.h"
+
+#include "io/vfs.h"
+
+namespace llt
+{
+	/*
+	 * On-disk layout of a cooked mesh. Everything is little-endian and laid out
+	 * so that the vertex and index blobs can be handed straight to the staging
+	 * buffer without any per-vertex conversion.
+	 *
+	 * [Header][SubMeshEntry * n][MaterialEntry * m][string table][vertex blob][index blob]
+	 */
+	namespace meshcache
+	{
+		static constexpr uint32_t MAGIC = 0x434D4C4C; // "LLMC"
+		static constexpr uint32_t VERSION = 1;
+
+		static constexpr uint64_t BLOB_ALIGNMENT = 16;
+
+		static constexpr int TEXTURE_SLOT_COUNT = 5;
+		static constexpr uint32_t NO_TEXTURE = 0xFFFFFFFF;
+		static constexpr uint32_t NO_MATERIAL = 0xFFFFFFFF;
+
+		struct Header
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t importFlags;
+			uint32_t vertexSize;
+
+			uint32_t subMeshCount;
+			uint32_t materialCount;
+
+			uint64_t sourceSize;
+
+			uint64_t subMeshTableOffset;
+			uint64_t materialTableOffset;
+
+			uint64_t stringTableOffset;
+			uint64_t stringTableSize;
+
+			uint64_t vertexBlobOffset;
+			uint64_t vertexBlobSize;
+
+			uint64_t indexBlobOffset;
+			uint64_t indexBlobSize;
+		};
+
+		struct SubMeshEntry
+		{
+			uint32_t firstVertex;
+			uint32_t vertexCount;
+			uint32_t firstIndex;
+			uint32_t indexCount;
+
+			uint32_t materialIndex;
+			uint32_t _padding;
+
+			float boundsMin[3];
+			float boundsMax[3];
+		};
+
+		struct MaterialEntry
+		{
+			// offsets into the string table, NO_TEXTURE means use the fallback
+			uint32_t textures[TEXTURE_SLOT_COUNT];
+		};
+	}
+
+	/**
+	 * Accumulates processed submeshes and serialises them into a mesh cache file.
+	 */
+	class MeshCacheWriter
+	{
+	public:
+		MeshCacheWriter(uint32_t vertexSize);
+		~MeshCacheWriter() = default;
+
+		void addSubMesh(
+			const void *pVertices, uint32_t nVertices,
+			const uint16_t *pIndices, uint32_t nIndices,
+			const glm::vec3 &boundsMin, const glm::vec3 &boundsMax,
+			uint32_t materialIndex
+		);
+
+		/*
+		 * Each entry is a texture path relative to the mesh directory, or nullptr / "" for the fallback.
+		 */
+		uint32_t addMaterial(const char *const *texturePaths);
+
+		bool save(const String &path, uint32_t importFlags, uint64_t sourceSize) const;
+
+	private:
+		uint32_t addString(const char *str);
+
+		uint32_t m_vertexSize;
+
+		Vector<meshcache::SubMeshEntry, MEM_TAG_ASSETS> m_subMeshes;
+		Vector<meshcache::MaterialEntry, MEM_TAG_ASSETS> m_materials;
+
+		Vector<byte, MEM_TAG_ASSETS> m_strings;
+		Vector<byte, MEM_TAG_ASSETS> m_vertices;
+		Vector<uint16_t, MEM_TAG_ASSETS> m_indices;
+	};
+
+	/**
+	 * Read-only view over a mesh cache file, opened through the vfs.
+	 * Loose caches and ones stored uncompressed in an archive are memory-mapped, so vertex and index data are read
+	 * straight out of the page cache.
+	 */
+	class MeshCacheReader
+	{
+	public:
+		MeshCacheReader();
+		~MeshCacheReader() = default;
+
+		/*
+		 * Checks whether a valid cache exists for the given source: the cache must
+		 * be newer than the source and match the import flags and vertex layout.
+		 * Archives don't keep timestamps, so if either one was packed only the sizes and layout are compared.
+		 */
+		static bool isUpToDate(const String &cachePath, const String &sourcePath, uint32_t importFlags, uint32_t vertexSize);
+
+		bool open(const String &path, uint32_t importFlags, uint32_t vertexSize);
+
+		uint32_t getSubMeshCount() const;
+		const meshcache::SubMeshEntry &getSubMesh(int idx) const;
+
+		const void *getVertices(const meshcache::SubMeshEntry &entry) const;
+		const uint16_t *getIndices(const meshcache::SubMeshEntry &entry) const;
+
+		uint32_t getMaterialCount() const;
+
+		/*
+		 * Returns nullptr if the slot should use the fallback texture.
+		 */
+		const char *getMaterialTexture(uint32_t materialIndex, int slot) const;
+
+	private:
+		/*
+		 * Checks the header, and every submesh range, material index and string offset against the file,
+		 * so the getters can trust what they read.
+		 */
+		bool validate(uint32_t importFlags, uint32_t vertexSize) const;
+		bool fitsInFile(uint64_t offset, uint64_t size) const;
+
+		const meshcache::Header *m_header;
+		VfsFile m_file;
+	};
+
+	namespace meshcache
+	{
+		String getCachePath(const String &sourcePath);
+	}
+}
+
+#endif // MESH_CACHE_H_
@@ -2,18 +2,169 @@
 #include "texture_mgr.h"
 #include "material_system.h"
 
+#include "core/cpu_profiler.h"
+
+#include "io/vfs.h"
+
+#include <assimp/IOStream.hpp>
+#include <assimp/IOSystem.hpp>
+
 #include <filesystem>
 
+#include <glm/common.hpp>
+
 llt::MeshLoader *llt::g_meshLoader = nullptr;
 
 using namespace llt;
 
+static constexpr uint32_t IMPORT_FLAGS =
+	aiProcess_Triangulate |
+	aiProcess_FlipWindingOrder |
+	aiProcess_CalcTangentSpace |
+	aiProcess_FlipUVs;
+
+// must match the order the texturedPBR technique expects its bindings in
+static constexpr aiTextureType MATERIAL_TEXTURE_SLOTS[meshcache::TEXTURE_SLOT_COUNT] =
+{
+	aiTextureType_DIFFUSE,
+	aiTextureType_LIGHTMAP,
+	aiTextureType_DIFFUSE_ROUGHNESS,
+	aiTextureType_NORMALS,
+	aiTextureType_EMISSIVE
+};
+
+// bc7 keeps the alpha channel for the diffuse, bc5 gives normals two full channels, bc1 is plenty for the rest
+static constexpr TextureCompression MATERIAL_TEXTURE_COMPRESSION[meshcache::TEXTURE_SLOT_COUNT] =
+{
+	TEXTURE_COMPRESSION_BC7,
+	TEXTURE_COMPRESSION_BC1,
+	TEXTURE_COMPRESSION_BC1,
+	TEXTURE_COMPRESSION_BC5,
+	TEXTURE_COMPRESSION_BC1
+};
+
+static void addTextureRequest(Vector<TextureLoadRequest> &requests, const String &directory, const char *texturePath, TextureCompression compression)
+{
+	if (texturePath && texturePath[0] != '\0')
+	{
+		String fullPath = directory + texturePath;
+		requests.pushBack({ fullPath, fullPath, compression });
+	}
+}
+
+/**
+ * Lets assimp pull the model and everything it references (.bin buffers, etc...) through the vfs.
+ */
+class VfsAssimpStream : public Assimp::IOStream
+{
+public:
+	VfsAssimpStream(VfsFile &&file)
+		: m_file(std::move(file))
+		, m_cursor(0)
+	{
+	}
+
+	size_t Read(void *buffer, size_t size, size_t count) override
+	{
+		if (size == 0) {
+			return 0;
+		}
+
+		size_t available = (m_file.size() - m_cursor) / size;
+		size_t readCount = count < available ? count : available;
+
+		mem::copy(buffer, m_file.data() + m_cursor, readCount * size);
+		m_cursor += readCount * size;
+
+		return readCount;
+	}
+
+	size_t Write(const void *buffer, size_t size, size_t count) override
+	{
+		return 0; // read-only
+	}
+
+	aiReturn Seek(size_t offset, aiOrigin origin) override
+	{
+		size_t target = 0;
+
+		switch (origin)
+		{
+			case aiOrigin_SET: target = offset; break;
+			case aiOrigin_CUR: target = m_cursor + offset; break;
+			case aiOrigin_END: target = m_file.size() - offset; break;
+			default: return aiReturn_FAILURE;
+		}
+
+		if (target > m_file.size()) {
+			return aiReturn_FAILURE;
+		}
+
+		m_cursor = target;
+		return aiReturn_SUCCESS;
+	}
+
+	size_t Tell() const override
+	{
+		return m_cursor;
+	}
+
+	size_t FileSize() const override
+	{
+		return m_file.size();
+	}
+
+	void Flush() override
+	{
+	}
+
+private:
+	VfsFile m_file;
+	size_t m_cursor;
+};
+
+class VfsAssimpIOSystem : public Assimp::IOSystem
+{
+public:
+	bool Exists(const char *path) const override
+	{
+		return g_vfs->exists(path);
+	}
+
+	char getOsSeparator() const override
+	{
+		return '/';
+	}
+
+	Assimp::IOStream *Open(const char *path, const char *mode) override
+	{
+		if (mode[0] != 'r') {
+			return nullptr;
+		}
+
+		VfsFile file = g_vfs->open(path);
+
+		if (!file.isOpen()) {
+			return nullptr;
+		}
+
+		return new VfsAssimpStream(std::move(file));
+	}
+
+	void Close(Assimp::IOStream *stream) override
+	{
+		delete stream;
+	}
+};
+
 MeshLoader::MeshLoader()
 	: m_meshCache()
 	, m_importer()
 	, m_quadMesh(nullptr)
 	, m_cubeMesh(nullptr)
 {
+	m_importer.SetIOHandler(new VfsAssimpIOSystem()); // importer takes ownership
+
 	createQuadMesh();
 	createCubeMesh();
 }
@@ -109,29 +260,114 @@ SubMesh *MeshLoader::getCubeMesh()
 
 Mesh *MeshLoader::loadMesh(const String &name, const String &path)
 {
+	LLT_PROFILE_SCOPE("MeshLoader::loadMesh");
+
 	if (m_meshCache.contains(name)) {
 		return m_meshCache.get(name);
 	}
 
-	const aiScene *scene = m_importer.ReadFile(path.cstr(),
-		aiProcess_Triangulate |
-		aiProcess_FlipWindingOrder |
-		aiProcess_CalcTangentSpace |
-		aiProcess_FlipUVs
-	);
+	Mesh *mesh = new Mesh();
 
-	if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+	std::filesystem::path filePath(path.cstr());
+	std::string directory = filePath.parent_path().string() + "/";
+
+	mesh->setDirectory(directory.c_str());
+
+	String cachePath = meshcache::getCachePath(path);
+
+	bool cached =
+		MeshCacheReader::isUpToDate(cachePath, path, IMPORT_FLAGS, g_modelVertexFormat.getVertexSize()) &&
+		loadCachedMesh(mesh, cachePath);
+
+	if (!cached && !importMesh(mesh, path, cachePath))
 	{
-		LLT_ERROR("Failed to load mesh at path: %s, Error: %s", path.cstr(), m_importer.GetErrorString());
+		delete mesh;
 		return nullptr;
 	}
 
+	m_meshCache.insert(name, mesh);
+	return mesh;
+}
+
+Mesh *MeshLoader::createMesh(const String &name)
+{
+	if (m_meshCache.contains(name)) {
+		return m_meshCache.get(name);
+	}
+
 	Mesh *mesh = new Mesh();
 
-	std::filesystem::path filePath(path.cstr());
-	std::string directory = filePath.parent_path().string() + "/";
+	m_meshCache.insert(name, mesh);
+	return mesh;
+}
 
-	mesh->setDirectory(directory.c_str());
+bool MeshLoader::loadCachedMesh(Mesh *mesh, const String &cachePath)
+{
+	LLT_PROFILE_SCOPE("MeshLoader::loadCachedMesh");
+
+	MeshCacheReader reader;
+
+	if (!reader.open(cachePath, IMPORT_FLAGS, g_modelVertexFormat.getVertexSize()))
+	{
+		LLT_LOG("Mesh cache at %s is invalid, reimporting.", cachePath.cstr());
+		return false;
+	}
+
+	// load every texture the mesh references up front, so they're decoded in parallel and uploaded together
+	Vector<TextureLoadRequest> textureRequests;
+
+	for (int i = 0; i < reader.getMaterialCount(); i++)
+	{
+		for (int j = 0; j < meshcache::TEXTURE_SLOT_COUNT; j++) {
+			addTextureRequest(textureRequests, mesh->getDirectory(), reader.getMaterialTexture(i, j), MATERIAL_TEXTURE_COMPRESSION[j]);
+		}
+	}
+
+	g_textureManager->loadMany(textureRequests);
+
+	for (int i = 0; i < reader.getSubMeshCount(); i++)
+	{
+		const meshcache::SubMeshEntry &entry = reader.getSubMesh(i);
+
+		SubMesh *submesh = mesh->createSubmesh();
+
+		submesh->build(
+			g_modelVertexFormat,
+			reader.getVertices(entry), entry.vertexCount,
+			reader.getIndices(entry), entry.indexCount
+		);
+
+		submesh->setBounds(
+			{ entry.boundsMin[0], entry.boundsMin[1], entry.boundsMin[2] },
+			{ entry.boundsMax[0], entry.boundsMax[1], entry.boundsMax[2] }
+		);
+
+		if (entry.materialIndex != meshcache::NO_MATERIAL && entry.materialIndex < reader.getMaterialCount())
+		{
+			const char *texturePaths[meshcache::TEXTURE_SLOT_COUNT];
+
+			for (int j = 0; j < meshcache::TEXTURE_SLOT_COUNT; j++) {
+				texturePaths[j] = reader.getMaterialTexture(entry.materialIndex, j);
+			}
+
+			buildMaterial(submesh, texturePaths);
+		}
+	}
+
+	return true;
+}
+
+bool MeshLoader::importMesh(Mesh *mesh, const String &path, const String &cachePath)
+{
+	LLT_PROFILE_SCOPE("MeshLoader::importMesh");
+
+	const aiScene *scene = m_importer.ReadFile(path.cstr(), IMPORT_FLAGS);
+
+	if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+	{
+		LLT_ERROR("Failed to load mesh at path: %s, Error: %s", path.cstr(), m_importer.GetErrorString());
+		return false;
+	}
 
 	aiMatrix4x4 identity(
 		1.0f, 0.0f, 0.0f, 0.0f,
@@ -140,31 +376,65 @@ Mesh *MeshLoader::loadMesh(const String &name, const String &path)
 		0.0f, 0.0f, 0.0f, 1.0f
 	);
 
-	processNodes(mesh, scene->mRootNode, scene, identity);
+	Vector<TextureLoadRequest> textureRequests;
 
-	m_meshCache.insert(name, mesh);
-	return mesh;
+	for (int i = 0; i < scene->mNumMaterials; i++)
+	{
+		const aiMaterial *assimpMaterial = scene->mMaterials[i];
+
+		for (int j = 0; j < meshcache::TEXTURE_SLOT_COUNT; j++)
+		{
+			aiString texturePath;
+
+			if (assimpMaterial->GetTexture(MATERIAL_TEXTURE_SLOTS[j], 0, &texturePath) == AI_SUCCESS) {
+				addTextureRequest(textureRequests, mesh->getDirectory(), texturePath.C_Str(), MATERIAL_TEXTURE_COMPRESSION[j]);
+			}
+		}
+	}
+
+	g_textureManager->loadMany(textureRequests);
+
+	MeshCacheWriter cache(g_modelVertexFormat.getVertexSize());
+
+	// maps assimp material indices to cache material indices so shared materials are only written once
+	Vector<uint32_t> cachedMaterials(scene->mNumMaterials, meshcache::NO_MATERIAL);
+
+	processNodes(mesh, scene->mRootNode, scene, identity, cache, cachedMaterials);
+
+	// through the vfs so it matches what isUpToDate() compares against when the source is packed
+	uint64_t sourceSize = 0;
+
+	if (!g_vfs->getFileSize(path, &sourceSize) || !cache.save(cachePath, IMPORT_FLAGS, sourceSize)) {
+		LLT_LOG("Failed to write mesh cache: %s", cachePath.cstr());
+	}
+
+	m_importer.FreeScene();
+
+	return true;
 }
 
-void MeshLoader::processNodes(Mesh *mesh, aiNode *node, const aiScene *scene, const aiMatrix4x4& transform)
+void MeshLoader::processNodes(Mesh *mesh, aiNode *node, const aiScene *scene, const aiMatrix4x4& transform, MeshCacheWriter &cache, Vector<uint32_t> &cachedMaterials)
 {
 	for(int i = 0; i < node->mNumMeshes; i++)
 	{
 		aiMesh *assimpMesh = scene->mMeshes[node->mMeshes[i]];
-		processSubMesh(mesh->createSubmesh(), assimpMesh, scene, node->mTransformation * transform);
+		processSubMesh(mesh->createSubmesh(), assimpMesh, scene, node->mTransformation * transform, cache, cachedMaterials);
 	}
 
 	for(int i = 0; i < node->mNumChildren; i++)
 	{
-		processNodes(mesh, node->mChildren[i], scene, node->mTransformation * transform);
+		processNodes(mesh, node->mChildren[i], scene, node->mTransformation * transform, cache, cachedMaterials);
 	}
 }
 
-void MeshLoader::processSubMesh(SubMesh *submesh, aiMesh *assimpMesh, const aiScene *scene, const aiMatrix4x4& transform)
+void MeshLoader::processSubMesh(SubMesh *submesh, aiMesh *assimpMesh, const aiScene *scene, const aiMatrix4x4& transform, MeshCacheWriter &cache, Vector<uint32_t> &cachedMaterials)
 {
 	Vector<ModelVertex> vertices(assimpMesh->mNumVertices);
 	Vector<uint16_t> indices;
 
+	glm::vec3 boundsMin(0.0f);
+	glm::vec3 boundsMax(0.0f);
+
 	for (int i = 0; i < assimpMesh->mNumVertices; i++)
 	{
 		const aiVector3D &vtx = transform * assimpMesh->mVertices[i];
@@ -173,6 +443,17 @@ void MeshLoader::processSubMesh(SubMesh *submesh, aiMesh *assimpMesh, const aiSc
 
 		vertex.position = { vtx.x, vtx.y, vtx.z };
 
+		if (i == 0)
+		{
+			boundsMin = vertex.position;
+			boundsMax = vertex.position;
+		}
+		else
+		{
+			boundsMin = glm::min(boundsMin, vertex.position);
+			boundsMax = glm::max(boundsMax, vertex.position);
+		}
+
 		if (assimpMesh->HasTextureCoords(0))
 		{
 			const aiVector3D &uv = assimpMesh->mTextureCoords[0][i];
@@ -239,61 +520,93 @@ void MeshLoader::processSubMesh(SubMesh *submesh, aiMesh *assimpMesh, const aiSc
 		indices.data(), indices.size()
 	);
 
-	if (assimpMesh->mMaterialIndex >= 0)
+	submesh->setBounds(boundsMin, boundsMax);
+
+	uint32_t cachedMaterial = meshcache::NO_MATERIAL;
+
+	if (assimpMesh->mMaterialIndex < scene->mNumMaterials)
 	{
 		const aiMaterial *assimpMaterial = scene->mMaterials[assimpMesh->mMaterialIndex];
 
-		MaterialData data;
-		data.technique = "texturedPBR_opaque"; // temporarily just the forced material type
+		aiString texturePaths[meshcache::TEXTURE_SLOT_COUNT];
+		const char *texturePathPtrs[meshcache::TEXTURE_SLOT_COUNT];
+
+		for (int i = 0; i < meshcache::TEXTURE_SLOT_COUNT; i++)
+		{
+			// only the first texture of each type is ever bound
+			if (assimpMaterial->GetTextureCount(MATERIAL_TEXTURE_SLOTS[i]) > 0 &&
+				assimpMaterial->GetTexture(MATERIAL_TEXTURE_SLOTS[i], 0, &texturePaths[i]) == AI_SUCCESS)
+			{
+				texturePathPtrs[i] = texturePaths[i].C_Str();
+			}
+			else
+			{
+				texturePathPtrs[i] = nullptr;
+			}
+		}
 
-		fetchMaterialBoundTextures(data.textures, submesh->getParent()->getDirectory(), assimpMaterial, aiTextureType_DIFFUSE,				g_materialSystem->getDiffuseFallback());
-		fetchMaterialBoundTextures(data.textures, submesh->getParent()->getDirectory(), assimpMaterial, aiTextureType_LIGHTMAP,				g_materialSystem->getAOFallback());
-		fetchMaterialBoundTextures(data.textures, submesh->getParent()->getDirectory(), assimpMaterial, aiTextureType_DIFFUSE_ROUGHNESS,	g_materialSystem->getRoughnessMetallicFallback());
-		fetchMaterialBoundTextures(data.textures, submesh->getParent()->getDirectory(), assimpMaterial, aiTextureType_NORMALS,				g_materialSystem->getNormalFallback());
-		fetchMaterialBoundTextures(data.textures, submesh->getParent()->getDirectory(), assimpMaterial, aiTextureType_EMISSIVE,				g_materialSystem->getEmissiveFallback());
+		buildMaterial(submesh, texturePathPtrs);
 
-		Material *material = g_materialSystem->getRegistry().buildMaterial(data);
+		cachedMaterial = cachedMaterials[assimpMesh->mMaterialIndex];
 
-		submesh->setMaterial(material);
+		if (cachedMaterial == meshcache::NO_MATERIAL)
+		{
+			cachedMaterial = cache.addMaterial(texturePathPtrs);
+			cachedMaterials[assimpMesh->mMaterialIndex] = cachedMaterial;
+		}
 	}
+
+	cache.addSubMesh(
+		vertices.data(), vertices.size(),
+		indices.data(), indices.size(),
+		boundsMin, boundsMax,
+		cachedMaterial
+	);
 }
 
-void MeshLoader::fetchMaterialBoundTextures(Vector<TextureView> &textures, const String &localPath, const aiMaterial *material, aiTextureType type, Texture *fallback)
+void MeshLoader::buildMaterial(SubMesh *submesh, const char *const *texturePaths)
 {
-	Vector<Texture *> maps = loadMaterialTextures(material, type, localPath);
-
-	if (maps.size() >= 1)
+	Texture *fallbacks[meshcache::TEXTURE_SLOT_COUNT] =
 	{
-		textures.pushBack(maps[0]->getStandardView());
-	}
-	else
-	{
-		if (fallback)
-		{
-			textures.pushBack(fallback->getStandardView());
-		}
+		g_materialSystem->getDiffuseFallback(),
+		g_materialSystem->getAOFallback(),
+		g_materialSystem->getRoughnessMetallicFallback(),
+		g_materialSystem->getNormalFallback(),
+		g_materialSystem->getEmissiveFallback()
+	};
+
+	MaterialData data;
+	data.technique = "texturedPBR_opaque"; // temporarily just the forced material type
+
+	for (int i = 0; i < meshcache::TEXTURE_SLOT_COUNT; i++) {
+		fetchMaterialBoundTexture(data.textures, submesh->getParent()->getDirectory(), texturePaths[i], fallbacks[i], MATERIAL_TEXTURE_COMPRESSION[i]);
 	}
+
+	Material *material = g_materialSystem->getRegistry().buildMaterial(data);
+
+	submesh->setMaterial(material);
 }
 
-Vector<Texture *> MeshLoader::loadMaterialTextures(const aiMaterial *material, aiTextureType type, const String &localPath)
+void MeshLoader::fetchMaterialBoundTexture(Vector<TextureView> &textures, const String &localPath, const char *texturePath, Texture *fallback, TextureCompression compression)
 {
-	Vector<Texture *> result;
-
-	for (int i = 0; i < material->GetTextureCount(type); i++)
+	if (texturePath && texturePath[0] != '\0')
 	{
-		aiString texturePath;
-		material->GetTexture(type, i, &texturePath);
+		String fullPath = localPath + texturePath;
 
-		aiString basePath = aiString(localPath.cstr());
-		basePath.Append(texturePath.C_Str());
-
-		Texture *tex = g_textureManager->getTexture(basePath.C_Str());
+		Texture *tex = g_textureManager->getTexture(fullPath);
 
 		if (!tex)
-			tex = g_textureManager->load(basePath.C_Str(), basePath.C_Str());
+			tex = g_textureManager->load(fullPath, fullPath, compression);
 
-		result.pushBack(tex);
+		if (tex)
+		{
+			textures.pushBack(tex->getStandardView());
+			return;
+		}
 	}
 
-	return result;
+	if (fallback)
+	{
+		textures.pushBack(fallback->getStandardView());
+	}
 }
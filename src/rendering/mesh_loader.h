@@ -9,6 +9,8 @@
 #include "container/hash_map.h"
 
 #include "mesh.h"
+#include "mesh_cache.h"
+#include "texture_cache.h"
 
 namespace llt
 {
@@ -20,6 +22,11 @@ namespace llt
 
 		Mesh *loadMesh(const String &name, const String &path);
 
+		/*
+		 * An empty mesh to build submeshes into by hand, freed along with the loaded ones.
+		 */
+		Mesh *createMesh(const String &name);
+
 		SubMesh *getQuadMesh();
 		SubMesh *getCubeMesh();
 
@@ -30,13 +37,19 @@ namespace llt
 		SubMesh *m_quadMesh;
 		SubMesh *m_cubeMesh;
 
-		void processNodes(Mesh *mesh, aiNode *node, const aiScene *scene, const aiMatrix4x4& transform);
-		void processSubMesh(SubMesh *submesh, aiMesh *assimpMesh, const aiScene *scene, const aiMatrix4x4& transform);
+		bool loadCachedMesh(Mesh *mesh, const String &cachePath);
+		bool importMesh(Mesh *mesh, const String &path, const String &cachePath);
+
+		void processNodes(Mesh *mesh, aiNode *node, const aiScene *scene, const aiMatrix4x4& transform, MeshCacheWriter &cache, Vector<uint32_t> &cachedMaterials);
+		void processSubMesh(SubMesh *submesh, aiMesh *assimpMesh, const aiScene *scene, const aiMatrix4x4& transform, MeshCacheWriter &cache, Vector<uint32_t> &cachedMaterials);
 
-		void fetchMaterialBoundTextures(Vector<TextureView> &textures, const String &localPath, const aiMaterial *material, aiTextureType type, Texture *fallback);
-		Vector<Texture*> loadMaterialTextures(const aiMaterial *material, aiTextureType type, const String &localPath);
+		/*
+		 * Texture paths are relative to the mesh directory, nullptr means use the fallback for that slot.
+		 */
+		void buildMaterial(SubMesh *submesh, const char *const *texturePaths);
+		void fetchMaterialBoundTexture(Vector<TextureView> &textures, const String &localPath, const char *texturePath, Texture *fallback, TextureCompression compression);
 
-		HashMap<String, Mesh*> m_meshCache;
+		HashMap<String, Mesh*, MEM_TAG_ASSETS> m_meshCache;
 		Assimp::Importer m_importer;
 	};
 
@@ -0,0 +1,377 @@
+#include "mip_generator.h"
+
+#include "vulkan/core.h"
+#include "vulkan/util.h"
+#include "vulkan/texture.h"
+#include "vulkan/shader.h"
+#include "vulkan/gpu_buffer.h"
+#include "vulkan/command_buffer.h"
+#include "vulkan/descriptor_builder.h"
+
+#include "io/vfs.h"
+
+#include "math/calc.h"
+
+#include "shader_mgr.h"
+#include "gpu_buffer_mgr.h"
+
+llt::MipGenerator *llt::g_mipGenerator = nullptr;
+
+using namespace llt;
+
+static const char *MIP_DOWNSAMPLE_SHADER_PATH = "../../res/shaders/compiled/mip_downsample_cs.spv";
+
+struct MipDownsamplePushConstants
+{
+	uint32_t sourceSize[2];
+	uint32_t mipCount;
+	uint32_t tileCount;
+	uint32_t isSRGB;
+};
+
+// averaged over this many runs, the first one also pays for pipeline and view creation
+static constexpr int BENCHMARK_RUNS = 8;
+
+MipGenerator::MipGenerator()
+	: m_effect(nullptr)
+	, m_pipeline()
+	, m_descriptorPool()
+	, m_textureSets()
+	, m_freeSets()
+	, m_counterBuffer(nullptr)
+	, m_midMipBuffer(nullptr)
+{
+}
+
+MipGenerator::~MipGenerator()
+{
+	cleanUp();
+}
+
+void MipGenerator::init()
+{
+	if (!g_vkCore->m_physicalData.features.features.shaderStorageImageWriteWithoutFormat)
+	{
+		LLT_LOG("Device can't write to storage images without a format, mipmaps will be blitted.");
+		return;
+	}
+
+	if (!g_vfs->exists(MIP_DOWNSAMPLE_SHADER_PATH))
+	{
+		LLT_LOG("Mip downsample shader hasn't been compiled, mipmaps will be blitted.");
+		return;
+	}
+
+	VkDescriptorSetLayout layout = DescriptorLayoutBuilder()
+		.bind(0, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE)
+		.bind(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, MAX_MIPS_PER_PASS)
+		.bind(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+		.bind(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+		.build(VK_SHADER_STAGE_COMPUTE_BIT);
+
+	m_effect = g_shaderManager->createEffect("mip_downsample");
+	m_effect->setDescriptorSetLayouts({ layout });
+	m_effect->setPushConstantsSize(sizeof(MipDownsamplePushConstants));
+	m_effect->addStage(g_shaderManager->load("mip_downsample_cs", MIP_DOWNSAMPLE_SHADER_PATH, VK_SHADER_STAGE_COMPUTE_BIT));
+
+	m_pipeline.setShader(m_effect);
+
+	m_descriptorPool.init(64, {
+		{ VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,		1.0f },
+		{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,		(float)MAX_MIPS_PER_PASS },
+		{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,	2.0f }
+	});
+
+	// the counters have to start at zero, after that the last group on each layer resets its own
+	uint32_t counters[MAX_LAYERS] = {};
+
+	m_counterBuffer = g_gpuBufferManager->createStorageBuffer(sizeof(counters));
+	m_counterBuffer->writeDataToMe(counters, sizeof(counters), 0);
+
+	m_midMipBuffer = g_gpuBufferManager->createBuffer(
+		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		VMA_MEMORY_USAGE_GPU_ONLY,
+		sizeof(float) * 4 * TILE_SIZE * TILE_SIZE * MAX_LAYERS
+	);
+}
+
+void MipGenerator::cleanUp()
+{
+	if (!m_effect) {
+		return;
+	}
+
+	m_descriptorPool.cleanUp();
+
+	m_textureSets.clear();
+	m_freeSets.clear();
+
+	delete m_counterBuffer;
+	m_counterBuffer = nullptr;
+
+	delete m_midMipBuffer;
+	m_midMipBuffer = nullptr;
+
+	m_effect = nullptr;
+}
+
+bool MipGenerator::isSupported(const Texture &texture) const
+{
+	if (!m_effect) {
+		return false;
+	}
+
+	VkImageViewType type = texture.getType();
+
+	if (type != VK_IMAGE_VIEW_TYPE_2D && type != VK_IMAGE_VIEW_TYPE_2D_ARRAY && type != VK_IMAGE_VIEW_TYPE_CUBE) {
+		return false;
+	}
+
+	return
+		texture.hasStorageUsage() &&
+		texture.getMipLevels() > 1 &&
+		texture.getLayerCount() <= MAX_LAYERS;
+}
+
+bool MipGenerator::generate(CommandBuffer &cmd, Texture &texture)
+{
+	if (!isSupported(texture)) {
+		return false;
+	}
+
+	const Vector<VkDescriptorSet> &sets = fetchSets(texture);
+
+	PipelineData pipelineData = g_vkCore->getPipelineCache().fetchComputePipeline(m_pipeline);
+
+	texture.transitionLayout(cmd, VK_IMAGE_LAYOUT_GENERAL);
+
+	cmd.bindPipeline(VK_PIPELINE_BIND_POINT_COMPUTE, pipelineData.pipeline);
+
+	// the counters and mid mip are shared by every dispatch
+	VkMemoryBarrier2 bufferBarrier = {};
+	bufferBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+	bufferBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+	bufferBarrier.srcAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT;
+	bufferBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+	bufferBarrier.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT;
+
+	MipDownsamplePushConstants pc = {};
+
+	uint32_t sourceMip = 0;
+
+	for (int pass = 0; pass < sets.size(); pass++)
+	{
+		if (pass > 0)
+		{
+			// the previous pass wrote this one's source
+			texture.transitionLayout(cmd, VK_IMAGE_LAYOUT_GENERAL);
+		}
+
+		cmd.pipelineBarrier(0, { bufferBarrier }, {}, {});
+
+		uint32_t mipCount = getPassMipCount(texture, sourceMip);
+
+		pc.sourceSize[0] = CalcU::max(texture.getWidth() >> sourceMip, 1);
+		pc.sourceSize[1] = CalcU::max(texture.getHeight() >> sourceMip, 1);
+		pc.mipCount = mipCount;
+		pc.isSRGB = vkutil::isSRGB(texture.getFormat()) ? 1 : 0;
+
+		uint32_t tilesX = (pc.sourceSize[0] + TILE_SIZE - 1) / TILE_SIZE;
+		uint32_t tilesY = (pc.sourceSize[1] + TILE_SIZE - 1) / TILE_SIZE;
+
+		pc.tileCount = tilesX * tilesY;
+
+		cmd.bindDescriptorSets(0, pipelineData.layout, { sets[pass] }, {});
+
+		cmd.pushConstants(
+			pipelineData.layout,
+			VK_SHADER_STAGE_COMPUTE_BIT,
+			sizeof(pc),
+			&pc
+		);
+
+		cmd.dispatch(tilesX, tilesY, texture.getLayerCount());
+
+		sourceMip += mipCount;
+	}
+
+	texture.transitionLayout(cmd, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+	return true;
+}
+
+void MipGenerator::release(const Texture *texture)
+{
+	if (!m_textureSets.contains(texture)) {
+		return;
+	}
+
+	for (auto &set : m_textureSets.get(texture)) {
+		m_freeSets.pushBack(set);
+	}
+
+	m_textureSets.erase(texture);
+}
+
+Vector<MipBenchmarkResult> MipGenerator::benchmark()
+{
+	Vector<MipBenchmarkResult> results;
+
+	struct BenchmarkCase
+	{
+		const char *name;
+		uint32_t size;
+		VkFormat format;
+		VkImageViewType type;
+	};
+
+	const BenchmarkCase cases[] = {
+		{ "4K RGBA8",			4096, VK_FORMAT_R8G8B8A8_UNORM,			VK_IMAGE_VIEW_TYPE_2D	},
+		{ "1K RGBA32F Cubemap",	1024, VK_FORMAT_R32G32B32A32_SFLOAT,	VK_IMAGE_VIEW_TYPE_CUBE	}
+	};
+
+	VkQueryPoolCreateInfo queryPoolInfo = {};
+	queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	queryPoolInfo.queryCount = 2;
+
+	VkQueryPool queryPool = VK_NULL_HANDLE;
+
+	LLT_VK_CHECK(
+		vkCreateQueryPool(g_vkCore->m_device, &queryPoolInfo, nullptr, &queryPool),
+		"Failed to create mip benchmark query pool"
+	);
+
+	for (auto &benchmarkCase : cases)
+	{
+		Texture texture;
+		texture.setSize(benchmarkCase.size, benchmarkCase.size);
+		texture.setProperties(benchmarkCase.format, VK_IMAGE_TILING_OPTIMAL, benchmarkCase.type);
+		texture.setMipLevels(vkutil::calcMipLevels(benchmarkCase.size, benchmarkCase.size));
+		texture.setSampleCount(VK_SAMPLE_COUNT_1_BIT);
+		texture.createInternalResources();
+
+		MipBenchmarkResult result = {};
+		result.name = benchmarkCase.name;
+		result.computeMs = isSupported(texture) ? timeGeneration(texture, true, queryPool) : -1.0;
+		result.blitMs = timeGeneration(texture, false, queryPool);
+
+		if (result.computeMs >= 0.0) {
+			LLT_LOG("Mip generation, %s: compute %.3fms, blit %.3fms (%.2fx)", result.name.cstr(), result.computeMs, result.blitMs, result.blitMs / result.computeMs);
+		} else {
+			LLT_LOG("Mip generation, %s: compute unsupported, blit %.3fms", result.name.cstr(), result.blitMs);
+		}
+
+		results.pushBack(result);
+	}
+
+	vkDestroyQueryPool(g_vkCore->m_device, queryPool, nullptr);
+
+	return results;
+}
+
+uint32_t MipGenerator::getPassMipCount(const Texture &texture, uint32_t sourceMip) const
+{
+	uint32_t remaining = texture.getMipLevels() - 1 - sourceMip;
+	uint32_t sourceSize = CalcU::max(texture.getWidth() >> sourceMip, texture.getHeight() >> sourceMip);
+
+	// the last group only has room for 64x64 tiles worth of results, so anything bigger stops at the per-tile levels
+	uint32_t maxMips = (sourceSize > TILE_SIZE * TILE_SIZE) ? MAX_MIPS_PER_PASS / 2 : MAX_MIPS_PER_PASS;
+
+	return CalcU::min(remaining, maxMips);
+}
+
+const Vector<VkDescriptorSet> &MipGenerator::fetchSets(Texture &texture)
+{
+	if (m_textureSets.contains(&texture)) {
+		return m_textureSets.get(&texture);
+	}
+
+	Vector<VkDescriptorSet> sets;
+
+	uint32_t sourceMip = 0;
+
+	while (sourceMip < texture.getMipLevels() - 1)
+	{
+		uint32_t mipCount = getPassMipCount(texture, sourceMip);
+
+		VkDescriptorSet set = VK_NULL_HANDLE;
+
+		if (m_freeSets.size() > 0) {
+			set = m_freeSets.popBack();
+		} else {
+			set = m_descriptorPool.allocate(m_effect->getDescriptorSetLayouts());
+		}
+
+		DescriptorWriter writer;
+
+		writer.writeSampledImage(0, texture.getStorageView(sourceMip).getHandle(), VK_IMAGE_LAYOUT_GENERAL);
+
+		// every slot needs something valid in it, the ones past the end of this pass are never written to
+		for (int i = 0; i < MAX_MIPS_PER_PASS; i++)
+		{
+			uint32_t mip = sourceMip + 1 + CalcU::min(i, mipCount - 1);
+			writer.writeCombinedImage(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, texture.getStorageView(mip).getHandle(), VK_IMAGE_LAYOUT_GENERAL, VK_NULL_HANDLE, i);
+		}
+
+		writer.writeBuffer(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_counterBuffer->getDescriptorInfo());
+		writer.writeBuffer(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_midMipBuffer->getDescriptorInfo());
+
+		writer.updateSet(set);
+
+		sets.pushBack(set);
+
+		sourceMip += mipCount;
+	}
+
+	m_textureSets.insert(&texture, sets);
+
+	return m_textureSets.get(&texture);
+}
+
+double MipGenerator::timeGeneration(Texture &texture, bool compute, VkQueryPool queryPool)
+{
+	double totalMs = 0.0;
+
+	for (int i = 0; i < BENCHMARK_RUNS; i++)
+	{
+		CommandBuffer cmd = vkutil::beginSingleTimeCommands(g_vkCore->getGraphicsCommandPool());
+
+		cmd.resetQueryPool(queryPool, 0, 2);
+
+		// same state the uploader leaves textures in
+		texture.transitionLayout(cmd, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+		cmd.writeTimestamp(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, 0);
+
+		if (compute) {
+			generate(cmd, texture);
+		} else {
+			texture.blitMipmaps(cmd);
+		}
+
+		cmd.writeTimestamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, 1);
+
+		vkutil::endSingleTimeGraphicsCommands(cmd);
+
+		uint64_t timestamps[2] = {};
+
+		vkGetQueryPoolResults(
+			g_vkCore->m_device,
+			queryPool,
+			0, 2,
+			sizeof(timestamps), timestamps,
+			sizeof(uint64_t),
+			VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT
+		);
+
+		double period = g_vkCore->m_physicalData.properties.properties.limits.timestampPeriod;
+
+		// skip the first run, it pays for pipeline and view creation
+		if (i > 0) {
+			totalMs += (period * (double)(timestamps[1] - timestamps[0])) / 1000000.0;
+		}
+	}
+
+	return totalMs / (BENCHMARK_RUNS - 1);
+}
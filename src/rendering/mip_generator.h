@@ -0,0 +1,96 @@
+#ifndef MIP_GENERATOR_H_
+#define MIP_GENERATOR_H_
+
+#include "third_party/volk.h"
+
+#include "container/vector.h"
+#include "container/hash_map.h"
+#include "container/string.h"
+
+#include "vulkan/pipeline_definition.h"
+#include "vulkan/descriptor_allocator.h"
+
+namespace llt
+{
+	class Texture;
+	class CommandBuffer;
+	class GPUBuffer;
+	class ShaderEffect;
+
+	struct MipBenchmarkResult
+	{
+		String name;
+
+		double computeMs;
+		double blitMs;
+	};
+
+	/**
+	 * Builds mip chains in compute rather than blitting them a level at a time.
+	 *
+	 * One dispatch writes up to 12 levels: every group reduces a 64x64 tile six levels in group shared
+	 * memory, then the last group to finish on each layer reduces the results of all the others another
+	 * six levels. srgb textures are read and written through unorm views and converted in the shader, so
+	 * the averaging happens in linear space. Cubemaps and arrays do every layer in the same dispatch.
+	 *
+	 * Textures this can't handle (block compressed, multisampled, formats without storage support...)
+	 * are left to the blit path in Texture::generateMipmaps.
+	 */
+	class MipGenerator
+	{
+	public:
+		static constexpr uint32_t MAX_MIPS_PER_PASS = 12;
+		static constexpr uint32_t TILE_SIZE = 64;
+		static constexpr uint32_t MAX_LAYERS = 16;
+
+		MipGenerator();
+		~MipGenerator();
+
+		/*
+		 * Until this is called everything goes through the blit path.
+		 */
+		void init();
+		void cleanUp();
+
+		bool isSupported(const Texture &texture) const;
+
+		/*
+		 * Fills in every level below the first from the first and leaves the texture in SHADER_READ_ONLY layout.
+		 * Returns false without recording anything if the texture has to be blitted instead.
+		 */
+		bool generate(CommandBuffer &cmd, Texture &texture);
+
+		/*
+		 * Frees the descriptor sets kept for the texture, called when its image goes away.
+		 */
+		void release(const Texture *texture);
+
+		/*
+		 * Times this against the blit path on a 4k rgba8 texture and a 1k rgba32f cubemap, and logs the results.
+		 */
+		Vector<MipBenchmarkResult> benchmark();
+
+	private:
+		uint32_t getPassMipCount(const Texture &texture, uint32_t sourceMip) const;
+
+		const Vector<VkDescriptorSet> &fetchSets(Texture &texture);
+
+		double timeGeneration(Texture &texture, bool compute, VkQueryPool queryPool);
+
+		ShaderEffect *m_effect;
+		ComputePipelineDefinition m_pipeline;
+
+		DescriptorPoolDynamic m_descriptorPool;
+
+		// one set per pass, written once and kept for as long as the texture is around
+		HashMap<const Texture *, Vector<VkDescriptorSet>> m_textureSets;
+		Vector<VkDescriptorSet> m_freeSets;
+
+		GPUBuffer *m_counterBuffer;
+		GPUBuffer *m_midMipBuffer;
+	};
+
+	extern MipGenerator *g_mipGenerator;
+}
+
+#endif // MIP_GENERATOR_H_
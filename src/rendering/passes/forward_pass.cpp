@@ -1,5 +1,7 @@
 #include "forward_pass.h"
 
+#include "core/cpu_profiler.h"
+
 #include "vulkan/core.h"
 #include "vulkan/command_buffer.h"
 
@@ -23,18 +25,27 @@ void ForwardPass::dispose()
 
 void ForwardPass::render(CommandBuffer &cmd, const Camera &camera, const Vector<SubMesh *> &renderList)
 {
+	LLT_PROFILE_SCOPE("ForwardPass::render");
+
 	if (renderList.size() <= 0)
 		return;
 
-	g_bindlessResources->writeFrameConstants({
+	// anything past the transform table doesn't get drawn rather than overwriting whatever comes after it
+	uint64_t drawCount = Calc<uint64_t>::min(renderList.size(), BindlessResourceManager::MAX_TRANSFORMS);
+
+	FrameConstants frameConstants = {
 		.proj = camera.getProj(),
 		.view = camera.getView(),
 		.cameraPosition = { camera.position.x, camera.position.y, camera.position.z, 0.0f }
-	});
+	};
+
+	mem::copy(frameConstants.irradianceSH, g_materialSystem->getIrradianceSH(), sizeof(frameConstants.irradianceSH));
+
+	g_bindlessResources->writeFrameConstants(frameConstants);
 
 	uint64_t currentMaterialHash = 0;
 
-	for (int i = 0; i < renderList.size(); i++)
+	for (int i = 0; i < drawCount; i++)
 	{
 		SubMesh *mesh = renderList[i];
 		Material *mat = mesh->getMaterial();
@@ -62,7 +73,6 @@ void ForwardPass::render(CommandBuffer &cmd, const Camera &camera, const Vector<
 		{
 			BindlessResourceID transform_ID;
 
-			BindlessResourceID irradianceMap_ID;
 			BindlessResourceID prefilterMap_ID;
 
 			BindlessResourceID brdfLUT_ID;
@@ -78,9 +88,8 @@ void ForwardPass::render(CommandBuffer &cmd, const Camera &camera, const Vector<
 		}
 		pushConstants;
 
-		pushConstants.transform_ID = 0;
+		pushConstants.transform_ID = i;
 
-		pushConstants.irradianceMap_ID = g_materialSystem->getIrradianceMap()->getStandardView().getBindlessHandle().id;
 		pushConstants.prefilterMap_ID = g_materialSystem->getPrefilterMap()->getStandardView().getBindlessHandle().id;
 
 		pushConstants.brdfLUT_ID = g_materialSystem->getBRDFLUT()->getStandardView().getBindlessHandle().id;
@@ -7,6 +7,9 @@
 
 #include "math/colour.h"
 
+#include "core/profiler.h"
+#include "core/cpu_profiler.h"
+
 #include "vulkan/core.h"
 #include "vulkan/shader.h"
 #include "vulkan/pipeline_definition.h"
@@ -22,6 +25,8 @@ void PostProcessPass::init(DescriptorPoolDynamic &pool, RenderTarget *input)
 {
 	initDefaultValues();
 
+	m_input = input;
+
 	createBloomResources(pool, input);
 	createHDRResources(pool, input);
 }
@@ -69,8 +74,8 @@ void PostProcessPass::createBloomResources(DescriptorPoolDynamic &pool, RenderTa
 {
 	m_bloomTarget = g_renderTargetManager->createTarget(
 		"bloomTarget",
-		g_vkCore->m_swapchain->getWidth(),
-		g_vkCore->m_swapchain->getHeight(),
+		g_vkCore->getBackbuffer()->getWidth(),
+		g_vkCore->getBackbuffer()->getHeight(),
 		{
 			VK_FORMAT_R32G32B32A32_SFLOAT
 		},
@@ -143,6 +148,8 @@ void PostProcessPass::createBloomResources(DescriptorPoolDynamic &pool, RenderTa
 
 void PostProcessPass::render(CommandBuffer &cmd)
 {
+	LLT_PROFILE_SCOPE("PostProcessPass::render");
+
 	renderBloomDownsamples(cmd);
 	renderBloomUpsamples(cmd);
 
@@ -151,91 +158,111 @@ void PostProcessPass::render(CommandBuffer &cmd)
 
 void PostProcessPass::applyHDRTexture(CommandBuffer &cmd)
 {
+	LLT_PROFILE_SCOPE("PostProcessPass::applyHDRTexture");
+
 	struct
 	{
 		float exposure;
 		float bloomIntensity;
+		glm::vec2 uvScale;
+		glm::vec2 uvMax;
 	}
 	pc;
 
 	pc.exposure = m_exposure;
 	pc.bloomIntensity = m_bloomIntensity;
 
+	getInputUVs(&pc.uvScale, &pc.uvMax);
+
 	SubMesh *quadMesh = g_meshLoader->getQuadMesh();
 
 	cmd.beginRecording();
-	cmd.beginRendering(g_vkCore->m_swapchain);
 	{
-		PipelineData pipelineData = g_vkCore->getPipelineCache().fetchGraphicsPipeline(m_hdrPipeline, cmd.getCurrentRenderInfo());
+		ScopeTimer timer("tonemapping", cmd);
 
-		cmd.bindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineData.pipeline);
+		cmd.beginRendering(g_vkCore->getBackbuffer());
+		{
+			PipelineData pipelineData = g_vkCore->getPipelineCache().fetchGraphicsPipeline(m_hdrPipeline, cmd.getCurrentRenderInfo());
+
+			cmd.bindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineData.pipeline);
 
-		cmd.bindDescriptorSets(0, pipelineData.layout, { m_hdrSet }, {});
+			cmd.bindDescriptorSets(0, pipelineData.layout, { m_hdrSet }, {});
 
-		cmd.pushConstants(
-			pipelineData.layout,
-			VK_SHADER_STAGE_ALL_GRAPHICS,
-			sizeof(pc),
-			&pc
-		);
+			cmd.pushConstants(
+				pipelineData.layout,
+				VK_SHADER_STAGE_ALL_GRAPHICS,
+				sizeof(pc),
+				&pc
+			);
 
-		quadMesh->render(cmd);
+			quadMesh->render(cmd);
+		}
+		cmd.endRendering();
 	}
-	cmd.endRendering();
 	cmd.submit();
 }
 
 void PostProcessPass::renderBloomDownsamples(CommandBuffer &cmd)
 {
+	LLT_PROFILE_SCOPE("PostProcessPass::renderBloomDownsamples");
+
 	struct
 	{
+		glm::vec2 uvScale;
+		glm::vec2 uvMax;
 		int mipLevel;
 	}
 	pc;
 
+	getInputUVs(&pc.uvScale, &pc.uvMax);
+
 	Texture *attachment = m_bloomTarget->getAttachment(0);
 	SubMesh *quad = g_meshLoader->getQuadMesh();
 
 	cmd.beginRecording();
-
-	for (int mipLevel = 0; mipLevel < attachment->getMipLevels(); mipLevel++)
 	{
-		int width  = attachment->getWidth()  >> mipLevel;
-		int height = attachment->getHeight() >> mipLevel;
-
-		RenderInfo info;
-		info.setSize(width, height);
-		info.addColourAttachment(VK_ATTACHMENT_LOAD_OP_LOAD, m_bloomViews[mipLevel]);
+		ScopeTimer timer("bloom downsample", cmd);
 
-		cmd.beginRendering(info);
+		for (int mipLevel = 0; mipLevel < attachment->getMipLevels(); mipLevel++)
 		{
-			PipelineData pipelineData = g_vkCore->getPipelineCache().fetchGraphicsPipeline(m_bloomDownsamplePipeline, cmd.getCurrentRenderInfo());
+			int width  = attachment->getWidth()  >> mipLevel;
+			int height = attachment->getHeight() >> mipLevel;
 
-			cmd.bindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineData.pipeline);
+			RenderInfo info;
+			info.setSize(width, height);
+			info.addColourAttachment(VK_ATTACHMENT_LOAD_OP_LOAD, m_bloomViews[mipLevel]);
 
-			cmd.bindDescriptorSets(0, pipelineData.layout, { m_bloomDownsampleSet }, {});
+			cmd.beginRendering(info);
+			{
+				PipelineData pipelineData = g_vkCore->getPipelineCache().fetchGraphicsPipeline(m_bloomDownsamplePipeline, cmd.getCurrentRenderInfo());
 
-			pc.mipLevel = mipLevel;
+				cmd.bindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineData.pipeline);
 
-			cmd.pushConstants(
-				pipelineData.layout,
-				VK_SHADER_STAGE_ALL_GRAPHICS,
-				sizeof(pc),
-				&pc
-			);
+				cmd.bindDescriptorSets(0, pipelineData.layout, { m_bloomDownsampleSet }, {});
 
-			cmd.setViewport({ 0.0f, 0.0f, (float)width, (float)height });
+				pc.mipLevel = mipLevel;
 
-			quad->render(cmd);
+				cmd.pushConstants(
+					pipelineData.layout,
+					VK_SHADER_STAGE_ALL_GRAPHICS,
+					sizeof(pc),
+					&pc
+				);
+
+				cmd.setViewport({ 0.0f, 0.0f, (float)width, (float)height });
+
+				quad->render(cmd);
+			}
+			cmd.endRendering();
 		}
-		cmd.endRendering();
 	}
-
 	cmd.submit();
 }
 
 void PostProcessPass::renderBloomUpsamples(CommandBuffer &cmd)
 {
+	LLT_PROFILE_SCOPE("PostProcessPass::renderBloomUpsamples");
+
 	struct
 	{
 		float filterRadius;
@@ -281,6 +308,17 @@ void PostProcessPass::renderBloomUpsamples(CommandBuffer &cmd)
 	}
 }
 
+void PostProcessPass::getInputUVs(glm::vec2 *scale, glm::vec2 *max) const
+{
+	glm::vec2 fullSize = { (float)m_input->getWidth(), (float)m_input->getHeight() };
+	glm::vec2 areaSize = { (float)m_input->getRenderAreaWidth(), (float)m_input->getRenderAreaHeight() };
+
+	(*scale) = areaSize / fullSize;
+
+	// half a texel in from the edge, so the linear filter stops at the last rendered texel
+	(*max) = (areaSize - 0.5f) / fullSize;
+}
+
 float PostProcessPass::getExposure() const
 {
 	return m_exposure;
@@ -1,6 +1,8 @@
 #ifndef POST_PROCESS_PASS_H_
 #define POST_PROCESS_PASS_H_
 
+#include <glm/glm.hpp>
+
 #include "vulkan/pipeline_definition.h"
 #include "vulkan/texture_view.h"
 
@@ -44,6 +46,12 @@ namespace llt
 		void renderBloomDownsamples(CommandBuffer &cmd);
 		void renderBloomUpsamples(CommandBuffer &cmd);
 
+		/*
+		 * What the quad's uvs get multiplied by to cover the input's render area,
+		 * and how far they can go before sampling would blend in texels from outside of it.
+		 */
+		void getInputUVs(glm::vec2 *scale, glm::vec2 *max) const;
+
 		float m_exposure;
 		float m_bloomRadius;
 		float m_bloomIntensity;
@@ -60,6 +68,9 @@ namespace llt
 		TextureView m_bloomViews[BLOOM_MIPS];
 
 		RenderTarget *m_bloomTarget;
+
+		// only its render area is filled in, which is what gets sampled and stretched over the output
+		RenderTarget *m_input;
 	};
 
 	extern PostProcessPass g_postProcessPass;
@@ -5,6 +5,7 @@
 #include "camera.h"
 
 #include "core/profiler.h"
+#include "core/cpu_profiler.h"
 
 #include "input/input.h"
 
@@ -14,6 +15,8 @@
 #include "vulkan/texture.h"
 #include "vulkan/descriptor_builder.h"
 #include "vulkan/render_target.h"
+#include "vulkan/render_stats.h"
+#include "vulkan/api_stats.h"
 
 #include "material.h"
 #include "material_system.h"
@@ -21,6 +24,8 @@
 #include "shader_mgr.h"
 #include "texture_mgr.h"
 #include "render_target_mgr.h"
+#include "mip_generator.h"
+#include "dynamic_resolution.h"
 
 #include "./passes/forward_pass.h"
 #include "./passes/post_process_pass.h"
@@ -36,6 +41,7 @@ Renderer::Renderer()
 	, m_skyboxMesh()
 	, m_skyboxPipeline()
 	, m_skyboxSet()
+	, m_skyboxView(VK_NULL_HANDLE)
 	, m_descriptorPool()
 	, m_descriptorLayoutCache()
 {
@@ -44,6 +50,7 @@ Renderer::Renderer()
 void Renderer::init()
 {
 	g_gpuBufferManager->createGlobalStagingBuffers();
+	g_textureManager->init();
 
 	m_descriptorPool.init(64 * mgc::FRAMES_IN_FLIGHT, {
 		{ VK_DESCRIPTOR_TYPE_SAMPLER, 					0.5f },
@@ -66,15 +73,18 @@ void Renderer::init()
 	g_materialSystem = new MaterialSystem();
 	g_materialSystem->init();
 
-	g_textureManager->loadDefaultTexturesAndSamplers();
+	// shaders first so the default textures can have their mips generated in compute
 	g_shaderManager->loadDefaultShaders();
+	g_mipGenerator->init();
+
+	g_textureManager->loadDefaultTexturesAndSamplers();
 
 	g_materialSystem->finalise();
 
 	m_target = g_renderTargetManager->createTarget(
 		"target",
-		g_vkCore->m_swapchain->getWidth(),
-		g_vkCore->m_swapchain->getHeight(),
+		g_vkCore->getBackbuffer()->getWidth(),
+		g_vkCore->getBackbuffer()->getHeight(),
 		{
 			VK_FORMAT_R32G32B32A32_SFLOAT
 		},
@@ -91,7 +101,10 @@ void Renderer::init()
 	g_forwardPass.init();
 	g_postProcessPass.init(m_descriptorPool, m_target);
 	g_shadowPass.init();
+}
 
+void Renderer::loadDefaultScene()
+{
 	auto assimpModel = m_currentScene.createRenderObject();
 	assimpModel->transform.setPosition({ 0.0f, 0.0f, 0.0f });
 	assimpModel->transform.setRotation(glm::radians(0.0f), { 1.0f, 0.0f, 0.0f });
@@ -119,43 +132,84 @@ void Renderer::setScene(const Scene &scene)
 	m_currentScene = scene;
 }
 
+Scene &Renderer::getScene()
+{
+	return m_currentScene;
+}
+
 void Renderer::render(const Camera &camera, float deltaTime)
 {
+	LLT_PROFILE_SCOPE("Renderer::render");
+
 	m_currentScene.updatePrevMatrices();
 
+	// the scene and skybox only draw into the scaled corner of the target, post processing scales it back up
+	g_dynamicResolution.update();
+
+	m_target->setRenderArea(
+		g_dynamicResolution.scaleSize(m_target->getWidth()),
+		g_dynamicResolution.scaleSize(m_target->getHeight())
+	);
+
 	CommandBuffer cmd = CommandBuffer::fromGraphics();
 
 	cmd.beginRecording();
-	cmd.beginRendering(m_target);
+	g_profiler->beginFrame(cmd);
 	{
-		auto &renderList = m_currentScene.getRenderList();
-		
-		g_forwardPass.render(cmd, camera, renderList);
+		ScopeTimer timer("forward", cmd, true);
+
+		cmd.beginRendering(m_target);
+		{
+			auto &renderList = m_currentScene.getRenderList();
+
+			// picked up by the streamer on the next texture manager update
+			g_textureManager->getStreamer().requestFromRenderList(camera, renderList);
+			
+			g_forwardPass.render(cmd, camera, renderList);
+		}
+		cmd.endRendering();
 	}
-	cmd.endRendering();
 	cmd.submit();
 
 	m_target->toggleClear(false);
 
 	cmd.beginRecording();
-	cmd.beginRendering(m_target);
-	renderSkybox(cmd, camera);
-	cmd.endRendering();
+	{
+		ScopeTimer timer("skybox", cmd);
+
+		cmd.beginRendering(m_target);
+		renderSkybox(cmd, camera);
+		cmd.endRendering();
+	}
 	cmd.submit();
 
 	m_target->toggleClear(true);
 
 	g_postProcessPass.render(cmd);
 
-	ImGui::Render();
+	// there's no imgui without a window to put it in
+	if (!g_vkCore->isHeadless())
+	{
+		ImGui::Render();
+
+		renderImGui(cmd);
+	}
+
+	g_profiler->endFrame();
 
-	renderImGui(cmd);
+	{
+		LLT_PROFILE_SCOPE("swap buffers");
+		g_vkCore->swapBuffers();
+	}
 
-	g_vkCore->swapBuffers();
+	renderstats::endFrame();
+	apistats::endFrame();
 }
 
 void Renderer::renderImGui(CommandBuffer &cmd)
 {
+	LLT_PROFILE_SCOPE("Renderer::renderImGui");
+
 	RenderInfo renderInfo;
 	
 	renderInfo.setSize(
@@ -169,12 +223,16 @@ void Renderer::renderImGui(CommandBuffer &cmd)
 	);
 
 	cmd.beginRecording();
-	cmd.beginRendering(renderInfo);
+	{
+		ScopeTimer timer("imgui", cmd);
+
+		cmd.beginRendering(renderInfo);
 
-	ImDrawData *drawData = ImGui::GetDrawData();
-	ImGui_ImplVulkan_RenderDrawData(drawData, cmd.getHandle());
+		ImDrawData *drawData = ImGui::GetDrawData();
+		ImGui_ImplVulkan_RenderDrawData(drawData, cmd.getHandle());
 
-	cmd.endRendering();
+		cmd.endRendering();
+	}
 	cmd.submit();
 }
 
@@ -221,16 +279,9 @@ void Renderer::createSkyboxResources()
 
 	ShaderEffect *skyboxShader = g_shaderManager->getEffect("skybox");
 
-	BoundTexture skyboxCubemap(
-		g_textureManager->getTexture("environment_map"),
-		g_textureManager->getSampler("linear")
-	);
-
 	m_skyboxSet = m_descriptorPool.allocate(skyboxShader->getDescriptorSetLayouts());
 
-	DescriptorWriter()
-		.writeCombinedImage(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, skyboxCubemap.getStandardImageInfo())
-		.updateSet(m_skyboxSet);
+	writeSkyboxSet();
 
 	m_skyboxPipeline.setShader(skyboxShader);
 	m_skyboxPipeline.setVertexFormat(g_primitiveVertexFormat);
@@ -239,8 +290,29 @@ void Renderer::createSkyboxResources()
 	m_skyboxPipeline.setDepthOp(VK_COMPARE_OP_LESS_OR_EQUAL);
 }
 
+void Renderer::writeSkyboxSet()
+{
+	BoundTexture skyboxCubemap(
+		g_materialSystem->getEnvironmentMap(),
+		g_textureManager->getSampler("linear")
+	);
+
+	m_skyboxView = skyboxCubemap.getStandardImageInfo().imageView;
+
+	DescriptorWriter()
+		.writeCombinedImage(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, skyboxCubemap.getStandardImageInfo())
+		.updateSet(m_skyboxSet);
+}
+
 void Renderer::renderSkybox(CommandBuffer &cmd, const Camera &camera)
 {
+	LLT_PROFILE_SCOPE("Renderer::renderSkybox");
+
+	// the environment map is remade whenever the ibl format changes, which stalls first so nothing is still using the set
+	if (g_materialSystem->getEnvironmentMap()->getStandardView().getHandle() != m_skyboxView) {
+		writeSkyboxSet();
+	}
+
 	PipelineData pipelineData = g_vkCore->getPipelineCache().fetchGraphicsPipeline(m_skyboxPipeline, cmd.getCurrentRenderInfo());
 
 	struct
@@ -21,10 +21,17 @@ namespace llt
 
 		void render(const Camera &camera, float deltaTime);
 
+		/*
+		 * The spinning cube you get when nothing else asks for a scene.
+		 */
+		void loadDefaultScene();
+
 		void setScene(const Scene &scene);
+		Scene &getScene();
 
 	private:
 		void createSkyboxResources();
+		void writeSkyboxSet();
 
 		void renderSkybox(CommandBuffer &cmd, const Camera &camera);
 		void renderImGui(CommandBuffer &cmd);
@@ -36,6 +43,7 @@ namespace llt
 		SubMesh m_skyboxMesh;
 		GraphicsPipelineDefinition m_skyboxPipeline;
 		VkDescriptorSet m_skyboxSet;
+		VkImageView m_skyboxView;
 
 		DescriptorPoolDynamic m_descriptorPool;
 		DescriptorLayoutCache m_descriptorLayoutCache;
@@ -68,6 +68,11 @@ void Scene::updatePrevMatrices()
 		entity.storePrevMatrix();
 }
 
+void Scene::reserve(uint64_t count)
+{
+	m_renderObjects.allocate(count);
+}
+
 Vector<RenderObject>::Iterator Scene::createRenderObject()
 {
 	m_renderListDirty = true;
@@ -20,6 +20,12 @@ namespace llt
 
 		void updatePrevMatrices();
 
+		/*
+		 * Meshes point back at the render object that owns them, so reserve up front when
+		 * creating a lot of them or they'll be left pointing into the old storage.
+		 */
+		void reserve(uint64_t count);
+
 		Vector<RenderObject>::Iterator createRenderObject();
 
 		const Vector<SubMesh *> &getRenderList();
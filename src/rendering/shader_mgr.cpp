@@ -1,14 +1,12 @@
 #include "shader_mgr.h"
 
-#include "io/file_stream.h"
+#include "io/vfs.h"
 
 #include "vulkan/core.h"
 #include "vulkan/descriptor_builder.h"
 
 #include "material_system.h"
-
-#include <fstream>
-#include <vector>
+#include "cubemap_capture.h"
 
 llt::ShaderMgr *llt::g_shaderManager = nullptr;
 
@@ -41,12 +39,12 @@ void ShaderMgr::loadDefaultShaders()
 void ShaderMgr::loadDefaultShaderPrograms()
 {
 	load("primitive_vs",					"../../res/shaders/compiled/primitive_vs.spv",						VK_SHADER_STAGE_VERTEX_BIT);
+	load("cubemap_capture_vs",				"../../res/shaders/compiled/cubemap_capture_vs.spv",				VK_SHADER_STAGE_VERTEX_BIT);
 	load("skybox_vs",						"../../res/shaders/compiled/skybox_vs.spv",							VK_SHADER_STAGE_VERTEX_BIT);
 	load("primitive_quad_vs",				"../../res/shaders/compiled/primitive_quad_vs.spv",					VK_SHADER_STAGE_VERTEX_BIT);
 	load("model_vs",						"../../res/shaders/compiled/model_vs.spv",							VK_SHADER_STAGE_VERTEX_BIT);
 
 	load("equirectangular_to_cubemap_ps",	"../../res/shaders/compiled/equirectangular_to_cubemap_ps.spv",		VK_SHADER_STAGE_FRAGMENT_BIT);
-	load("irradiance_convolution_ps",		"../../res/shaders/compiled/irradiance_convolution_ps.spv",			VK_SHADER_STAGE_FRAGMENT_BIT);
 	load("prefilter_convolution_ps",		"../../res/shaders/compiled/prefilter_convolution_ps.spv",			VK_SHADER_STAGE_FRAGMENT_BIT);
 	load("brdf_integrator_ps",				"../../res/shaders/compiled/brdf_integrator_ps.spv",				VK_SHADER_STAGE_FRAGMENT_BIT);
 	load("texturedPBR_ps",					"../../res/shaders/compiled/texturedPBR_ps.spv",					VK_SHADER_STAGE_FRAGMENT_BIT);
@@ -112,24 +110,11 @@ void ShaderMgr::createDefaultShaderEffects()
 
 		ShaderEffect *equirectangularToCubemap_effect = createEffect("equirectangular_to_cubemap");
 		equirectangularToCubemap_effect->setDescriptorSetLayouts({ layout });
-		equirectangularToCubemap_effect->setPushConstantsSize(sizeof(float)*16 * 2);
-		equirectangularToCubemap_effect->addStage(get("primitive_vs"));
+		equirectangularToCubemap_effect->setPushConstantsSize(sizeof(CubemapCapture::PushConstants));
+		equirectangularToCubemap_effect->addStage(get("cubemap_capture_vs"));
 		equirectangularToCubemap_effect->addStage(get("equirectangular_to_cubemap_ps"));
 	}
 
-	// IRRADIANCE CONVOLUTION
-	{
-		VkDescriptorSetLayout layout = DescriptorLayoutBuilder()
-			.bind(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
-			.build(VK_SHADER_STAGE_ALL_GRAPHICS);
-
-		ShaderEffect *irradianceConvolution_effect = createEffect("irradiance_convolution");
-		irradianceConvolution_effect->setDescriptorSetLayouts({ layout });
-		irradianceConvolution_effect->setPushConstantsSize(sizeof(float)*16 * 2);
-		irradianceConvolution_effect->addStage(get("primitive_vs"));
-		irradianceConvolution_effect->addStage(get("irradiance_convolution_ps"));
-	}
-
 	// PREFILTER CONVOLUTION
 	{
 		VkDescriptorSetLayout layout = DescriptorLayoutBuilder()
@@ -139,8 +124,8 @@ void ShaderMgr::createDefaultShaderEffects()
 
 		ShaderEffect *prefilterConvolution_effect = createEffect("prefilter_convolution");
 		prefilterConvolution_effect->setDescriptorSetLayouts({ layout });
-		prefilterConvolution_effect->setPushConstantsSize(sizeof(float)*16 * 2);
-		prefilterConvolution_effect->addStage(get("primitive_vs"));
+		prefilterConvolution_effect->setPushConstantsSize(sizeof(CubemapCapture::PushConstants));
+		prefilterConvolution_effect->addStage(get("cubemap_capture_vs"));
 		prefilterConvolution_effect->addStage(get("prefilter_convolution_ps"));
 	}
 
@@ -165,7 +150,7 @@ void ShaderMgr::createDefaultShaderEffects()
 
 		ShaderEffect *hdrTonemapping_effect = createEffect("hdr_tonemapping");
 		hdrTonemapping_effect->setDescriptorSetLayouts({ layout });
-		hdrTonemapping_effect->setPushConstantsSize(sizeof(float)*2);
+		hdrTonemapping_effect->setPushConstantsSize(sizeof(float)*2 + sizeof(float)*2 * 2); // exposure, bloom intensity, uv scale and max
 		hdrTonemapping_effect->addStage(get("primitive_quad_vs"));
 		hdrTonemapping_effect->addStage(get("hdr_tonemapping_ps"));
 	}
@@ -178,7 +163,7 @@ void ShaderMgr::createDefaultShaderEffects()
 
 		ShaderEffect *bloomDownsample_effect = createEffect("bloom_downsample");
 		bloomDownsample_effect->setDescriptorSetLayouts({ layout });
-		bloomDownsample_effect->setPushConstantsSize(sizeof(int));
+		bloomDownsample_effect->setPushConstantsSize(sizeof(float)*2 * 2 + sizeof(int)); // uv scale and max, mip level
 		bloomDownsample_effect->addStage(get("primitive_quad_vs"));
 		bloomDownsample_effect->addStage(get("bloom_downsample_ps"));
 	}
@@ -207,29 +192,18 @@ ShaderProgram *ShaderMgr::load(const String &name, const String &source, VkShade
 	if (m_shaderCache.contains(name))
 		return m_shaderCache.get(name);
 
-	/*
-	FileStream fs(source.cstr(), "r");
-	Vector<char> sourceData(fs.size());
-	fs.read(sourceData.data(), fs.size());
-	fs.close();
-	*/
-
-	// todo: there should be platform abstractions for the file handles
-	// like FileStream myFile = g_platform->openFile(...)
-	// on windows it uses the SDL i/o streams
-	// on mac / linux something else idk
-
-	std::ifstream file(source.cstr(), std::ios::binary | std::ios::ate);
+	// spir-v is handed to the driver straight out of the archive / file mapping, no intermediate copy
+	VfsFile file = g_vfs->open(source);
 
-	std::streamsize size = file.tellg();
-	file.seekg(0, std::ios::beg);
-
-	std::vector<char> sourceData(size);
-	file.read(sourceData.data(), size);
+	if (!file.isOpen())
+	{
+		LLT_ERROR("Failed to load shader at path: %s", source.cstr());
+		return nullptr;
+	}
 
 	ShaderProgram *shader = new ShaderProgram();
 	shader->setStage(stage);
-	shader->loadFromSource(sourceData.data(), sourceData.size());
+	shader->loadFromSource((const char *)file.data(), file.size());
 
 	m_shaderCache.insert(name, shader);
 
@@ -12,6 +12,8 @@ SubMesh::SubMesh()
 	, m_indexBuffer(nullptr)
 	, m_nVertices(0)
 	, m_nIndices(0)
+	, m_boundsMin(0.0f)
+	, m_boundsMax(0.0f)
 {
 }
 
@@ -58,8 +60,8 @@ void SubMesh::render(CommandBuffer &cmd) const
 
 void SubMesh::build(
 	const VertexFormat &format,
-	void *pVertices, uint32_t nVertices,
-	uint16_t *pIndices, uint32_t nIndices
+	const void *pVertices, uint32_t nVertices,
+	const uint16_t *pIndices, uint32_t nIndices
 )
 {
 	m_vertexFormat = &format;
@@ -127,3 +129,19 @@ uint64_t SubMesh::getIndexCount() const
 {
 	return m_nIndices;
 }
+
+void SubMesh::setBounds(const glm::vec3 &min, const glm::vec3 &max)
+{
+	m_boundsMin = min;
+	m_boundsMax = max;
+}
+
+const glm::vec3 &SubMesh::getBoundsMin() const
+{
+	return m_boundsMin;
+}
+
+const glm::vec3 &SubMesh::getBoundsMax() const
+{
+	return m_boundsMax;
+}
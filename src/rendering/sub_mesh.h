@@ -1,7 +1,10 @@
 #ifndef MESH_H_
 #define MESH_H_
 
+#include <glm/vec3.hpp>
+
 #include "core/common.h"
+#include "core/mem_tracker.h"
 
 #include "container/vector.h"
 
@@ -15,7 +18,7 @@ namespace llt
 	/**
 	 * Generic mesh class for representing, storing and manipulating a mesh.
 	 */
-	class SubMesh
+	class SubMesh : public MemTagged<MEM_TAG_ASSETS>
 	{
 		friend class Mesh;
 
@@ -25,7 +28,7 @@ namespace llt
 
 		void render(CommandBuffer &cmd) const;
 
-		void build(const VertexFormat &format, void *pVertices, uint32_t nVertices, uint16_t *pIndices, uint32_t nIndices);
+		void build(const VertexFormat &format, const void *pVertices, uint32_t nVertices, const uint16_t *pIndices, uint32_t nIndices);
 
 		Mesh *getParent();
 		const Mesh *getParent() const;
@@ -40,6 +43,10 @@ namespace llt
 		uint64_t getVertexCount() const;
 		uint64_t getIndexCount() const;
 
+		void setBounds(const glm::vec3 &min, const glm::vec3 &max);
+		const glm::vec3 &getBoundsMin() const;
+		const glm::vec3 &getBoundsMax() const;
+
 	private:
 		Mesh *m_parent;
 		const VertexFormat *m_vertexFormat;
@@ -51,6 +58,9 @@ namespace llt
 
 		uint32_t m_nVertices;
 		uint32_t m_nIndices;
+
+		glm::vec3 m_boundsMin;
+		glm::vec3 m_boundsMax;
 	};
 }
 
@@ -0,0 +1,458 @@
+#include "texture_cache.h"
+#include "block_compression.h"
+
+#include "core/thread_pool.h"
+
+#include "vulkan/image.h"
+#include "vulkan/image_ops.h"
+
+#include "math/calc.h"
+
+#include <filesystem>
+#include <fstream>
+#include <cmath>
+
+using namespace llt;
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+String texturecache::getCachePath(const String &sourcePath, TextureCompression compression)
+{
+	return sourcePath + "." + getName(compression) + ".lltc";
+}
+
+VkFormat texturecache::getFormat(TextureCompression compression)
+{
+	switch (compression)
+	{
+		case TEXTURE_COMPRESSION_BC1:
+			return VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+
+		case TEXTURE_COMPRESSION_BC5:
+			return VK_FORMAT_BC5_UNORM_BLOCK;
+
+		case TEXTURE_COMPRESSION_BC6H:
+			return VK_FORMAT_BC6H_UFLOAT_BLOCK;
+
+		case TEXTURE_COMPRESSION_BC7:
+			return VK_FORMAT_BC7_UNORM_BLOCK;
+
+		default:
+			return VK_FORMAT_UNDEFINED;
+	}
+}
+
+uint32_t texturecache::getBytesPerBlock(TextureCompression compression)
+{
+	return compression == TEXTURE_COMPRESSION_BC1 ? 8 : 16;
+}
+
+const char *texturecache::getName(TextureCompression compression)
+{
+	switch (compression)
+	{
+		case TEXTURE_COMPRESSION_BC1:
+			return "bc1";
+
+		case TEXTURE_COMPRESSION_BC5:
+			return "bc5";
+
+		case TEXTURE_COMPRESSION_BC6H:
+			return "bc6h";
+
+		case TEXTURE_COMPRESSION_BC7:
+			return "bc7";
+
+		default:
+			return "none";
+	}
+}
+
+// ---
+
+/*
+ * Averaged normals get shorter, this pushes them back onto the unit sphere.
+ */
+static void renormalise(float *texels, uint32_t width, uint32_t height)
+{
+	for (uint64_t i = 0; i < (uint64_t)width * height; i++)
+	{
+		float *out = &texels[i * 4];
+
+		float n[3];
+		float lengthSq = 0.0f;
+
+		for (int c = 0; c < 3; c++)
+		{
+			n[c] = out[c] / 127.5f - 1.0f;
+			lengthSq += n[c] * n[c];
+		}
+
+		if (lengthSq > 0.0f)
+		{
+			float invLength = 1.0f / std::sqrt(lengthSq);
+
+			for (int c = 0; c < 3; c++) {
+				out[c] = (n[c] * invLength + 1.0f) * 127.5f;
+			}
+		}
+	}
+}
+
+static void compressLevel(const float *texels, uint32_t width, uint32_t height, TextureCompression compression, byte *out, ThreadPool *pool)
+{
+	uint32_t blocksX = (width + bc::BLOCK_DIM - 1) / bc::BLOCK_DIM;
+	uint32_t blocksY = (height + bc::BLOCK_DIM - 1) / bc::BLOCK_DIM;
+
+	uint32_t bytesPerBlock = texturecache::getBytesPerBlock(compression);
+
+	auto compressRow = [&](uint32_t by) -> void
+	{
+		float block[bc::BLOCK_TEXELS * 4];
+
+		for (uint32_t bx = 0; bx < blocksX; bx++)
+		{
+			// blocks hanging off the edge of small levels just repeat the last row / column
+			for (int y = 0; y < bc::BLOCK_DIM; y++)
+			{
+				uint32_t sy = CalcU::min(by * bc::BLOCK_DIM + y, height - 1);
+
+				for (int x = 0; x < bc::BLOCK_DIM; x++)
+				{
+					uint32_t sx = CalcU::min(bx * bc::BLOCK_DIM + x, width - 1);
+
+					mem::copy(&block[(y * bc::BLOCK_DIM + x) * 4], &texels[(sy * width + sx) * 4], sizeof(float) * 4);
+				}
+			}
+
+			byte *dst = out + ((uint64_t)by * blocksX + bx) * bytesPerBlock;
+
+			switch (compression)
+			{
+				case TEXTURE_COMPRESSION_BC1:
+					bc::encodeBC1(block, dst);
+					break;
+
+				case TEXTURE_COMPRESSION_BC5:
+					bc::encodeBC5(block, dst);
+					break;
+
+				case TEXTURE_COMPRESSION_BC6H:
+					bc::encodeBC6H(block, dst);
+					break;
+
+				case TEXTURE_COMPRESSION_BC7:
+					bc::encodeBC7(block, dst);
+					break;
+
+				default:
+					break;
+			}
+		}
+	};
+
+	if (pool && blocksY > 1)
+	{
+		pool->parallelFor(blocksY, compressRow);
+	}
+	else
+	{
+		for (uint32_t by = 0; by < blocksY; by++) {
+			compressRow(by);
+		}
+	}
+}
+
+// ---
+
+TextureCacheWriter::TextureCacheWriter()
+	: m_data()
+{
+}
+
+bool TextureCacheWriter::cook(const Image &image, TextureCompression compression, bool mipmapped, uint64_t sourceSize, ThreadPool *pool)
+{
+	if (compression == TEXTURE_COMPRESSION_NONE || compression >= TEXTURE_COMPRESSION_MAX_ENUM || !image.getData()) {
+		return false;
+	}
+
+	uint32_t width = image.getWidth();
+	uint32_t height = image.getHeight();
+
+	bool hdr = compression == TEXTURE_COMPRESSION_BC6H;
+	bool normalMap = compression == TEXTURE_COMPRESSION_BC5;
+
+	uint32_t mipCount = 1;
+
+	if (mipmapped)
+	{
+		while (mipCount < texturecache::MAX_MIP_LEVELS && ((width >> mipCount) > 0 || (height >> mipCount) > 0)) {
+			mipCount++;
+		}
+	}
+
+	texturecache::Header header = {};
+	header.magic = texturecache::MAGIC;
+	header.version = texturecache::VERSION;
+	header.compression = compression;
+	header.flags = mipmapped ? texturecache::FLAG_MIPMAPPED : 0;
+	header.width = width;
+	header.height = height;
+	header.mipCount = mipCount;
+	header.sourceSize = sourceSize;
+
+	texturecache::MipEntry mips[texturecache::MAX_MIP_LEVELS] = {};
+
+	uint64_t offset = alignUp(sizeof(texturecache::Header) + sizeof(texturecache::MipEntry) * mipCount, texturecache::DATA_ALIGNMENT);
+
+	for (int i = 0; i < mipCount; i++)
+	{
+		mips[i].width = CalcU::max(width >> i, 1);
+		mips[i].height = CalcU::max(height >> i, 1);
+
+		uint64_t blocksX = (mips[i].width + bc::BLOCK_DIM - 1) / bc::BLOCK_DIM;
+		uint64_t blocksY = (mips[i].height + bc::BLOCK_DIM - 1) / bc::BLOCK_DIM;
+
+		mips[i].offset = offset;
+		mips[i].size = blocksX * blocksY * texturecache::getBytesPerBlock(compression);
+
+		offset = alignUp(offset + mips[i].size, texturecache::DATA_ALIGNMENT);
+	}
+
+	m_data.clear();
+	m_data.resize(offset);
+
+	mem::set(m_data.data(), 0, offset);
+	mem::copy(m_data.data(), &header, sizeof(header));
+	mem::copy(m_data.data() + sizeof(header), mips, sizeof(texturecache::MipEntry) * mipCount);
+
+	// work in floats throughout so ldr and hdr share the same mip generation,
+	// ldr encoders take [0, 255] and bc6h takes linear values
+	Vector<float> level(width * height * 4);
+
+	for (uint64_t i = 0; i < (uint64_t)width * height * 4; i++)
+	{
+		float v = 0.0f;
+
+		if (image.getFormat() == Image::FORMAT_RGBAF) {
+			v = ((const float *)image.getData())[i];
+			v = hdr ? v : CalcF::clamp(v, 0.0f, 1.0f) * 255.0f;
+		} else {
+			v = ((const byte *)image.getData())[i];
+			v = hdr ? v / 255.0f : v;
+		}
+
+		level[i] = v;
+	}
+
+	Vector<float> nextLevel;
+
+	for (int i = 0; i < mipCount; i++)
+	{
+		if (i > 0)
+		{
+			nextLevel.resize(mips[i].width * mips[i].height * 4);
+			imageops::downsample(level.data(), mips[i - 1].width, mips[i - 1].height, nextLevel.data(), imageops::DOWNSAMPLE_FILTER_BOX);
+
+			if (normalMap) {
+				renormalise(nextLevel.data(), mips[i].width, mips[i].height);
+			}
+
+			level = std::move(nextLevel);
+			nextLevel = Vector<float>();
+		}
+
+		compressLevel(level.data(), mips[i].width, mips[i].height, compression, m_data.data() + mips[i].offset, pool);
+	}
+
+	return true;
+}
+
+bool TextureCacheWriter::save(const String &path) const
+{
+	std::ofstream file(path.cstr(), std::ios::binary | std::ios::trunc);
+
+	if (!file.is_open())
+	{
+		LLT_LOG("Failed to open texture cache for writing: %s", path.cstr());
+		return false;
+	}
+
+	file.write((const char *)m_data.data(), m_data.size());
+
+	return file.good();
+}
+
+Vector<byte> TextureCacheWriter::release()
+{
+	return std::move(m_data);
+}
+
+// ---
+
+TextureCacheReader::TextureCacheReader()
+	: m_header(nullptr)
+	, m_file()
+	, m_buffer()
+	, m_data(nullptr)
+	, m_size(0)
+{
+}
+
+bool TextureCacheReader::isUpToDate(const String &cachePath, const String &sourcePath, TextureCompression compression, bool mipmapped)
+{
+	std::error_code ec;
+
+	if (!std::filesystem::exists(cachePath.cstr(), ec)) {
+		return false;
+	}
+
+	auto cacheTime = std::filesystem::last_write_time(cachePath.cstr(), ec);
+	if (ec) return false;
+
+	auto sourceTime = std::filesystem::last_write_time(sourcePath.cstr(), ec);
+	if (ec) return false;
+
+	// source was modified after we cooked it, recook
+	if (sourceTime > cacheTime) {
+		return false;
+	}
+
+	std::ifstream file(cachePath.cstr(), std::ios::binary);
+
+	texturecache::Header header = {};
+	file.read((char *)&header, sizeof(header));
+
+	if (!file.good()) {
+		return false;
+	}
+
+	uint64_t sourceSize = std::filesystem::file_size(sourcePath.cstr(), ec);
+	if (ec) return false;
+
+	return
+		header.magic == texturecache::MAGIC &&
+		header.version == texturecache::VERSION &&
+		header.compression == compression &&
+		((header.flags & texturecache::FLAG_MIPMAPPED) != 0) == mipmapped &&
+		header.sourceSize == sourceSize;
+}
+
+bool TextureCacheReader::open(const String &path)
+{
+	if (!m_file.open(path, MAPPED_FILE_ACCESS_WILLNEED)) {
+		return false;
+	}
+
+	m_data = m_file.data();
+	m_size = m_file.size();
+
+	if (!validate())
+	{
+		m_file.close();
+		return false;
+	}
+
+	return true;
+}
+
+bool TextureCacheReader::open(Vector<byte> &&data)
+{
+	m_buffer = std::move(data);
+
+	m_data = m_buffer.data();
+	m_size = m_buffer.size();
+
+	if (!validate())
+	{
+		m_buffer.clear();
+		return false;
+	}
+
+	return true;
+}
+
+bool TextureCacheReader::validate()
+{
+	m_header = nullptr;
+
+	if (m_size < sizeof(texturecache::Header)) {
+		return false;
+	}
+
+	const texturecache::Header *header = (const texturecache::Header *)m_data;
+
+	if (header->magic != texturecache::MAGIC || header->version != texturecache::VERSION) {
+		return false;
+	}
+
+	if (header->compression == TEXTURE_COMPRESSION_NONE || header->compression >= TEXTURE_COMPRESSION_MAX_ENUM) {
+		return false;
+	}
+
+	if (header->mipCount == 0 || header->mipCount > texturecache::MAX_MIP_LEVELS) {
+		return false;
+	}
+
+	if (sizeof(texturecache::Header) + sizeof(texturecache::MipEntry) * header->mipCount > m_size) {
+		return false;
+	}
+
+	const texturecache::MipEntry *mips = (const texturecache::MipEntry *)(m_data + sizeof(texturecache::Header));
+
+	// make sure nothing points outside of the file
+	for (int i = 0; i < header->mipCount; i++)
+	{
+		if (mips[i].offset + mips[i].size > m_size) {
+			return false;
+		}
+	}
+
+	m_header = header;
+
+	return true;
+}
+
+TextureCompression TextureCacheReader::getCompression() const
+{
+	return (TextureCompression)m_header->compression;
+}
+
+VkFormat TextureCacheReader::getFormat() const
+{
+	return texturecache::getFormat(getCompression());
+}
+
+uint32_t TextureCacheReader::getWidth() const
+{
+	return m_header->width;
+}
+
+uint32_t TextureCacheReader::getHeight() const
+{
+	return m_header->height;
+}
+
+uint32_t TextureCacheReader::getMipCount() const
+{
+	return m_header ? m_header->mipCount : 0;
+}
+
+const texturecache::MipEntry &TextureCacheReader::getMip(int level) const
+{
+	const texturecache::MipEntry *mips = (const texturecache::MipEntry *)(m_data + sizeof(texturecache::Header));
+	return mips[level];
+}
+
+const byte *TextureCacheReader::getData() const
+{
+	return m_data;
+}
+
+uint64_t TextureCacheReader::getSize() const
+{
+	return m_size;
+}
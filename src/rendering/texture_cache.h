@@ -0,0 +1,145 @@
+#ifndef TEXTURE_CACHE_H_
+#define TEXTURE_CACHE_H_
+
+#include "third_party/volk.h"
+
+#include "core/common.h"
+
+#include "container/vector.h"
+#include "container/string.h"
+
+#include "io/mapped_file.h"
+
+namespace llt
+{
+	class Image;
+	class ThreadPool;
+
+	enum TextureCompression
+	{
+		TEXTURE_COMPRESSION_NONE,
+		TEXTURE_COMPRESSION_BC1,	// opaque colour, 4 bits per texel
+		TEXTURE_COMPRESSION_BC5,	// two channels (tangent space normals), 8 bits per texel
+		TEXTURE_COMPRESSION_BC6H,	// hdr colour, 8 bits per texel
+		TEXTURE_COMPRESSION_BC7,	// colour + alpha, 8 bits per texel
+		TEXTURE_COMPRESSION_MAX_ENUM
+	};
+
+	/*
+	 * On-disk layout of a cooked texture: a block compressed mip chain that can be
+	 * copied into the staging buffer and uploaded as-is.
+	 *
+	 * [Header][MipEntry * mipCount][mip 0][mip 1]...
+	 */
+	namespace texturecache
+	{
+		static constexpr uint32_t MAGIC = 0x43544C4C; // "LLTC"
+		static constexpr uint32_t VERSION = 1;
+
+		static constexpr uint64_t DATA_ALIGNMENT = 16;
+		static constexpr uint32_t MAX_MIP_LEVELS = 16;
+
+		static constexpr uint32_t FLAG_MIPMAPPED = 1 << 0;
+
+		struct Header
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t compression;
+			uint32_t flags;
+
+			uint32_t width;
+			uint32_t height;
+			uint32_t mipCount;
+			uint32_t _padding;
+
+			uint64_t sourceSize;
+		};
+
+		struct MipEntry
+		{
+			uint64_t offset;
+			uint64_t size;
+
+			uint32_t width;
+			uint32_t height;
+		};
+
+		String getCachePath(const String &sourcePath, TextureCompression compression);
+
+		VkFormat getFormat(TextureCompression compression);
+		uint32_t getBytesPerBlock(TextureCompression compression);
+		const char *getName(TextureCompression compression);
+	}
+
+	/**
+	 * Builds the mip chain for an image and block compresses every level.
+	 */
+	class TextureCacheWriter
+	{
+	public:
+		TextureCacheWriter();
+		~TextureCacheWriter() = default;
+
+		/*
+		 * If a pool is given the blocks of each level are spread across its workers.
+		 */
+		bool cook(const Image &image, TextureCompression compression, bool mipmapped, uint64_t sourceSize, ThreadPool *pool);
+
+		bool save(const String &path) const;
+
+		/*
+		 * Hands the cooked file over, e.g: to a TextureCacheReader, leaving the writer empty.
+		 */
+		Vector<byte> release();
+
+	private:
+		Vector<byte> m_data;
+	};
+
+	/**
+	 * Read-only view over a cooked texture, either memory-mapped from disk or straight out of a writer.
+	 */
+	class TextureCacheReader
+	{
+	public:
+		TextureCacheReader();
+		~TextureCacheReader() = default;
+
+		/*
+		 * The cache must be newer than the source and have been cooked with the same settings.
+		 */
+		static bool isUpToDate(const String &cachePath, const String &sourcePath, TextureCompression compression, bool mipmapped);
+
+		bool open(const String &path);
+		bool open(Vector<byte> &&data);
+
+		TextureCompression getCompression() const;
+		VkFormat getFormat() const;
+
+		uint32_t getWidth() const;
+		uint32_t getHeight() const;
+
+		uint32_t getMipCount() const;
+		const texturecache::MipEntry &getMip(int level) const;
+
+		/*
+		 * Start of the whole file, mip offsets are relative to this.
+		 */
+		const byte *getData() const;
+		uint64_t getSize() const;
+
+	private:
+		bool validate();
+
+		const texturecache::Header *m_header;
+
+		MappedFile m_file;
+		Vector<byte> m_buffer;
+
+		const byte *m_data;
+		uint64_t m_size;
+	};
+}
+
+#endif // TEXTURE_CACHE_H_
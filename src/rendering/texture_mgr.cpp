@@ -5,19 +5,62 @@
 #include "vulkan/texture_sampler.h"
 #include "vulkan/core.h"
 #include "vulkan/descriptor_builder.h"
+#include "vulkan/util.h"
+
+#include "core/thread_pool.h"
+#include "core/cpu_profiler.h"
+
+#include "io/vfs.h"
+#include "io/async_io.h"
+#include "io/texture_container.h"
+
+#include "math/calc.h"
+
+#include <filesystem>
 
 llt::TextureMgr *llt::g_textureManager = nullptr;
 
 using namespace llt;
 
 TextureMgr::TextureMgr()
-	: m_textureCache()
+	: m_uploader()
+	, m_streamer()
+	, m_pendingLoads()
+	, m_asyncDecodeQueue()
+	, m_memoryStats()
+	, m_blockCompressionSupported(false)
+	, m_textureCache()
 	, m_samplerCache()
 {
 }
 
 TextureMgr::~TextureMgr()
 {
+	// reads might still be landing in our pending loads, and their callbacks hand them to the workers
+	if (g_asyncIO) {
+		g_asyncIO->waitIdle();
+	}
+
+	// workers might still be decoding into our pending loads
+	g_threadPool->waitIdle();
+
+	m_uploader.cleanUp();
+
+	// nothing is uploading any more, so the streamer can let go of its sources and spare images
+	m_streamer.cleanUp();
+
+	// anything that never finished is dropped without running its callbacks
+	for (auto *load : m_pendingLoads)
+	{
+		delete load->image;
+		delete load->cooked;
+		delete load->container;
+		delete load->texture;
+		delete load;
+	}
+
+	m_pendingLoads.clear();
+
 	for (auto &[name, texture] : m_textureCache) {
 		delete texture;
 	}
@@ -31,19 +74,85 @@ TextureMgr::~TextureMgr()
 	m_samplerCache.clear();
 }
 
+void TextureMgr::init()
+{
+	m_uploader.init(g_gpuBufferManager->textureStagingBuffer);
+	m_streamer.init(&m_uploader);
+
+	// every supported feature gets enabled at device creation, so this is all we need to check
+	m_blockCompressionSupported = g_vkCore->m_physicalData.features.features.textureCompressionBC == VK_TRUE;
+
+	if (!m_blockCompressionSupported) {
+		LLT_LOG("BC texture compression isn't supported, compressed textures will be loaded uncompressed.");
+	}
+}
+
+void TextureMgr::update()
+{
+	LLT_PROFILE_SCOPE("TextureMgr::update");
+
+	Vector<PendingLoad *> decoded;
+
+	{
+		std::lock_guard<std::mutex> lock(m_asyncDecodeQueue.mutex);
+		decoded = std::move(m_asyncDecodeQueue.decoded);
+	}
+
+	if (decoded.size() > 0)
+	{
+		for (auto *load : decoded) {
+			recordUpload(load);
+		}
+
+		// everything decoded since last frame goes out in one batch
+		uint64_t ticket = m_uploader.submit();
+
+		for (auto *load : decoded) {
+			load->ticket = ticket;
+		}
+	}
+
+	m_uploader.update();
+	m_streamer.update();
+
+	for (int i = 0; i < m_pendingLoads.size();)
+	{
+		PendingLoad *load = m_pendingLoads[i];
+
+		if (!load->decoded || (load->texture && !m_uploader.isComplete(load->ticket)))
+		{
+			i++;
+			continue;
+		}
+
+		m_pendingLoads.erase(i);
+
+		if (load->texture) {
+			m_textureCache.insert(load->name, load->texture);
+		}
+
+		// callbacks are free to kick off more loads, so only run them once the load is off the list
+		for (auto &callback : load->callbacks) {
+			callback(load->texture);
+		}
+
+		delete load;
+	}
+}
+
 void TextureMgr::loadDefaultTexturesAndSamplers()
 {
 	createSampler("linear",		TextureSampler::Style(VK_FILTER_LINEAR));
 	createSampler("nearest",	TextureSampler::Style(VK_FILTER_NEAREST));
 
-	load("fallback_white",		"../../res/textures/standard/white.png");
-	load("fallback_black",		"../../res/textures/standard/black.png");
-	load("fallback_normals",	"../../res/textures/standard/normal_fallback.png");
+	loadMany({
+		{ "fallback_white",		"../../res/textures/standard/white.png" },
+		{ "fallback_black",		"../../res/textures/standard/black.png" },
+		{ "fallback_normals",	"../../res/textures/standard/normal_fallback.png" },
 
-	load("environmentHDR",		"../../res/textures/rogland_clear_night_greg_zaal.hdr");
-
-	load("stone",				"../../res/textures/smooth_stone.png");
-	load("wood",				"../../res/textures/wood.jpg");
+		{ "stone",				"../../res/textures/smooth_stone.png" },
+		{ "wood",				"../../res/textures/wood.jpg" }
+	});
 }
 
 TextureSampler *TextureMgr::getSampler(const String &name)
@@ -56,10 +165,605 @@ Texture *TextureMgr::getTexture(const String &name)
 	return m_textureCache.getOrDefault(name, nullptr);
 }
 
-Texture *TextureMgr::load(const String &name, const String &path)
+Texture *TextureMgr::load(const String &name, const String &path, TextureCompression compression)
+{
+	if (m_textureCache.contains(name)) {
+		return m_textureCache.get(name);
+	}
+
+	return loadMany({ { name, path, compression } })[0];
+}
+
+Vector<Texture *> TextureMgr::loadMany(const Vector<TextureLoadRequest> &requests)
+{
+	LLT_PROFILE_SCOPE("TextureMgr::loadMany");
+
+	// if any of these are already loading asynchronously let them finish instead of loading them twice
+	for (auto &request : requests)
+	{
+		if (getPendingLoad(request.name))
+		{
+			finishPendingLoads();
+			break;
+		}
+	}
+
+	DecodeQueue queue;
+	Vector<PendingLoad *> loads;
+	Vector<AsyncReadRequest> reads;
+
+	for (auto &request : requests)
+	{
+		if (m_textureCache.contains(request.name)) {
+			continue;
+		}
+
+		bool duplicate = false;
+
+		for (auto *load : loads)
+		{
+			if (load->name == request.name)
+			{
+				duplicate = true;
+				break;
+			}
+		}
+
+		if (duplicate) {
+			continue;
+		}
+
+		PendingLoad *load = createPendingLoad(request.name, request.path, request.compression, request.mipmapped);
+
+		loads.pushBack(load);
+
+		AsyncReadRequest read;
+
+		if (prepareRead(load, &queue, &read)) {
+			reads.pushBack(read);
+		} else {
+			decodeAsync(load, &queue);
+		}
+	}
+
+	if (reads.size() > 0)
+	{
+		// one submission for the lot, and each decode starts as soon as its own read lands
+		g_asyncIO->submit(reads);
+		g_asyncIO->waitIdle();
+	}
+
+	// record uploads in whatever order the decodes finish, so the staging copies overlap with the decodes still running
+	int recorded = 0;
+
+	while (recorded < loads.size())
+	{
+		Vector<PendingLoad *> decoded;
+
+		{
+			std::unique_lock<std::mutex> lock(queue.mutex);
+			queue.condition.wait(lock, [&queue]() { return queue.decoded.size() > 0; });
+
+			decoded = std::move(queue.decoded);
+		}
+
+		for (auto *load : decoded)
+		{
+			recordUpload(load);
+			recorded++;
+		}
+	}
+
+	m_uploader.wait(m_uploader.submit());
+
+	for (auto *load : loads)
+	{
+		if (load->texture) {
+			m_textureCache.insert(load->name, load->texture);
+		}
+
+		delete load;
+	}
+
+	Vector<Texture *> result(requests.size());
+
+	for (int i = 0; i < requests.size(); i++) {
+		result[i] = getTexture(requests[i].name);
+	}
+
+	return result;
+}
+
+void TextureMgr::loadAsync(const String &name, const String &path, const TextureLoadedFn &onLoaded, TextureCompression compression)
+{
+	if (m_textureCache.contains(name))
+	{
+		if (onLoaded) {
+			onLoaded(m_textureCache.get(name));
+		}
+
+		return;
+	}
+
+	PendingLoad *load = getPendingLoad(name);
+
+	if (!load)
+	{
+		load = createPendingLoad(name, path, compression, true);
+
+		m_pendingLoads.pushBack(load);
+
+		AsyncReadRequest read;
+
+		// the read's callback runs from the g_asyncIO->poll() at the start of the frame
+		if (prepareRead(load, &m_asyncDecodeQueue, &read)) {
+			g_asyncIO->submit(read);
+		} else {
+			decodeAsync(load, &m_asyncDecodeQueue);
+		}
+	}
+
+	if (onLoaded) {
+		load->callbacks.pushBack(onLoaded);
+	}
+}
+
+uint32_t TextureMgr::getPendingLoadCount() const
+{
+	return m_pendingLoads.size();
+}
+
+TextureMemoryStats TextureMgr::getMemoryStats() const
+{
+	TextureMemoryStats stats = m_memoryStats;
+	stats.residentBytes += m_streamer.getResidentBytes();
+	stats.streamedCount = m_streamer.getStreamedCount();
+
+	return stats;
+}
+
+bool TextureMgr::isBlockCompressionSupported() const
+{
+	return m_blockCompressionSupported;
+}
+
+TextureStreamer &TextureMgr::getStreamer()
+{
+	return m_streamer;
+}
+
+const TextureStreamer &TextureMgr::getStreamer() const
+{
+	return m_streamer;
+}
+
+TextureMgr::PendingLoad *TextureMgr::createPendingLoad(const String &name, const String &path, TextureCompression compression, bool mipmapped)
+{
+	PendingLoad *load = new PendingLoad();
+	load->name = name;
+	load->path = path;
+	load->compression = m_blockCompressionSupported ? compression : TEXTURE_COMPRESSION_NONE;
+	load->mipmapped = mipmapped;
+	load->image = nullptr;
+	load->cooked = nullptr;
+	load->container = nullptr;
+	load->texture = nullptr;
+	load->decoded = false;
+	load->ticket = 0;
+
+	return load;
+}
+
+static Image *decodeImage(const byte *data, uint64_t size)
+{
+	Image *image = new Image();
+	image->loadFromMemory(data, size);
+
+	if (!image->getData())
+	{
+		delete image;
+		return nullptr;
+	}
+
+	// nothing samples hdr textures precisely enough to need full floats, so halve the upload while still on the worker
+	if (image->getFormat() == Image::FORMAT_RGBAF) {
+		image->convert(Image::FORMAT_RGBA16F);
+	}
+
+	return image;
+}
+
+static Image *decodeImage(const String &path)
+{
+	VfsFile file = g_vfs->open(path);
+
+	if (!file.isOpen()) {
+		return nullptr;
+	}
+
+	return decodeImage(file.data(), file.size());
+}
+
+/*
+ * Runs on a worker. Uses the cache file if it's still valid, otherwise cooks a new one
+ * (with the blocks spread across the rest of the pool) and writes it out for next time.
+ */
+static TextureCacheReader *loadCookedTexture(const String &path, TextureCompression compression, bool mipmapped)
+{
+	String cachePath = texturecache::getCachePath(path, compression);
+
+	if (TextureCacheReader::isUpToDate(cachePath, path, compression, mipmapped))
+	{
+		TextureCacheReader *reader = new TextureCacheReader();
+
+		if (reader->open(cachePath)) {
+			return reader;
+		}
+
+		delete reader;
+	}
+
+	VfsFile file = g_vfs->open(path);
+
+	if (!file.isOpen()) {
+		return nullptr;
+	}
+
+	Image image;
+	image.loadFromMemory(file.data(), file.size());
+
+	if (!image.getData()) {
+		return nullptr;
+	}
+
+	TextureCacheWriter writer;
+
+	if (!writer.cook(image, compression, mipmapped, file.size(), g_threadPool)) {
+		return nullptr;
+	}
+
+	// not being able to write the cache isn't fatal, we just cook it again next time
+	if (!writer.save(cachePath)) {
+		LLT_LOG("Failed to write texture cache: %s", cachePath.cstr());
+	}
+
+	TextureCacheReader *reader = new TextureCacheReader();
+
+	if (!reader->open(writer.release()))
+	{
+		delete reader;
+		return nullptr;
+	}
+
+	return reader;
+}
+
+void TextureMgr::decodeAsync(PendingLoad *load, DecodeQueue *queue)
+{
+	g_threadPool->enqueue([load, queue]() -> void
+	{
+		LLT_PROFILE_SCOPE("decode texture");
+
+		if (TextureContainer::getTypeFromPath(load->path) != TEXTURE_CONTAINER_TYPE_NONE)
+		{
+			// already in its final gpu format, so there's nothing to decode or cook
+			load->container = new TextureContainer();
+
+			if (!load->container->load(load->path))
+			{
+				delete load->container;
+				load->container = nullptr;
+			}
+		}
+		else
+		{
+			if (load->compression != TEXTURE_COMPRESSION_NONE) {
+				load->cooked = loadCookedTexture(load->path, load->compression, load->mipmapped);
+			}
+
+			// fall back to the plain image if cooking didn't work out
+			if (!load->cooked && load->fileData.size() > 0)
+			{
+				load->image = decodeImage(load->fileData.data(), load->fileData.size());
+				load->fileData = Vector<byte, MEM_TAG_IO>();
+			}
+			else if (!load->cooked)
+			{
+				load->image = decodeImage(load->path);
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(queue->mutex);
+			queue->decoded.pushBack(load);
+		}
+
+		queue->condition.notify_one();
+	});
+}
+
+bool TextureMgr::prepareRead(PendingLoad *load, DecodeQueue *queue, AsyncReadRequest *request)
+{
+	if (!g_asyncIO || load->compression != TEXTURE_COMPRESSION_NONE) {
+		return false;
+	}
+
+	if (TextureContainer::getTypeFromPath(load->path) != TEXTURE_CONTAINER_TYPE_NONE || g_vfs->isInArchive(load->path)) {
+		return false;
+	}
+
+	std::error_code ec;
+	uint64_t size = std::filesystem::file_size(load->path.cstr(), ec);
+
+	// let the worker find out it's missing and report it the usual way
+	if (ec || size == 0) {
+		return false;
+	}
+
+	load->fileData.resize(size);
+
+	request->path = load->path;
+	request->buffer = load->fileData.data();
+	request->offset = 0;
+	request->length = size;
+
+	request->callback = [this, load, queue](const AsyncReadResult &result) -> void
+	{
+		// a failed or short read goes back to opening the file on the worker
+		if (!result.success || result.bytesRead != load->fileData.size()) {
+			load->fileData = Vector<byte, MEM_TAG_IO>();
+		}
+
+		decodeAsync(load, queue);
+	};
+
+	return true;
+}
+
+bool TextureMgr::recordUpload(PendingLoad *load)
+{
+	load->decoded = true;
+
+	if (load->cooked)
+	{
+		recordCookedUpload(load);
+		return true;
+	}
+
+	if (load->container) {
+		return recordContainerUpload(load);
+	}
+
+	if (!load->image)
+	{
+		LLT_ERROR("Failed to load texture at path: %s", load->path.cstr());
+		return false;
+	}
+
+	Texture *texture = new Texture();
+
+	texture->fromImage(*load->image, VK_IMAGE_VIEW_TYPE_2D, vkutil::calcMipLevels(load->image->getWidth(), load->image->getHeight()), VK_SAMPLE_COUNT_1_BIT);
+	texture->createInternalResources();
+
+	m_uploader.upload(texture, load->image->getData(), load->image->getSize());
+
+	m_memoryStats.residentBytes += load->image->getSize();
+	m_memoryStats.uncompressedBytes += load->image->getSize();
+	m_memoryStats.textureCount++;
+
+	// the pixels live in the staging ring now
+	delete load->image;
+	load->image = nullptr;
+
+	load->texture = texture;
+
+	return true;
+}
+
+void TextureMgr::recordCookedUpload(PendingLoad *load)
+{
+	const TextureCacheReader *cooked = load->cooked;
+
+	// what the same chain would cost as plain rgba8 / rgba32f
+	uint64_t uncompressedTexelSize = (cooked->getCompression() == TEXTURE_COMPRESSION_BC6H) ? 16 : 4;
+
+	if (TextureStreamer::isStreamable(cooked->getWidth(), cooked->getHeight(), cooked->getMipCount(), 1))
+	{
+		for (int i = 0; i < cooked->getMipCount(); i++) {
+			m_memoryStats.uncompressedBytes += (uint64_t)cooked->getMip(i).width * cooked->getMip(i).height * uncompressedTexelSize;
+		}
+
+		m_memoryStats.textureCount++;
+		m_memoryStats.compressedCount++;
+
+		// the streamer keeps the file mapped so it can pull the bigger mips out of it later
+		load->texture = m_streamer.createStreamed(load->cooked);
+		load->cooked = nullptr;
+
+		return;
+	}
+
+	Texture *texture = new Texture();
+
+	texture->setSize(cooked->getWidth(), cooked->getHeight());
+	texture->setProperties(cooked->getFormat(), VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_VIEW_TYPE_2D);
+	texture->setMipLevels(cooked->getMipCount());
+	texture->setSampleCount(VK_SAMPLE_COUNT_1_BIT);
+	texture->setTransient(false);
+	texture->createInternalResources();
+
+	// the mips are stored back to back, so the whole chain goes into the ring in one copy
+	const texturecache::MipEntry &firstMip = cooked->getMip(0);
+	const texturecache::MipEntry &lastMip = cooked->getMip(cooked->getMipCount() - 1);
+
+	uint64_t chainSize = (lastMip.offset + lastMip.size) - firstMip.offset;
+
+	TextureUploadRegion regions[texturecache::MAX_MIP_LEVELS] = {};
+
+	for (int i = 0; i < cooked->getMipCount(); i++)
+	{
+		const texturecache::MipEntry &mip = cooked->getMip(i);
+
+		regions[i].offset = mip.offset - firstMip.offset;
+		regions[i].mipLevel = i;
+		regions[i].arrayLayer = 0;
+
+		m_memoryStats.uncompressedBytes += (uint64_t)mip.width * mip.height * uncompressedTexelSize;
+	}
+
+	m_uploader.uploadRegions(texture, cooked->getData() + firstMip.offset, chainSize, regions, cooked->getMipCount());
+
+	m_memoryStats.residentBytes += chainSize;
+	m_memoryStats.textureCount++;
+	m_memoryStats.compressedCount++;
+
+	delete load->cooked;
+	load->cooked = nullptr;
+
+	load->texture = texture;
+}
+
+bool TextureMgr::recordContainerUpload(PendingLoad *load)
 {
-	Image image(path.cstr());
-	return createFromImage(name, image);
+	const TextureContainer *container = load->container;
+
+	bool supported = true;
+
+	if (container->getLayerCount() > 1)
+	{
+		LLT_LOG("Texture arrays aren't supported yet, can't load: %s", load->path.cstr());
+		supported = false;
+	}
+	else if (vkutil::isBlockCompressed(container->getFormat()) && !m_blockCompressionSupported)
+	{
+		LLT_LOG("Texture is block compressed but the device doesn't support it, can't load: %s", load->path.cstr());
+		supported = false;
+	}
+
+	if (!supported)
+	{
+		delete load->container;
+		load->container = nullptr;
+
+		return false;
+	}
+
+	if (TextureStreamer::isStreamable(container->getWidth(), container->getHeight(), container->getMipCount(), container->getFaceCount()))
+	{
+		recordContainerStats(container);
+
+		load->texture = m_streamer.createStreamed(load->container);
+		load->container = nullptr;
+
+		return true;
+	}
+
+	Texture *texture = new Texture();
+
+	texture->setSize(container->getWidth(), container->getHeight());
+	texture->setProperties(container->getFormat(), VK_IMAGE_TILING_OPTIMAL, container->isCubemap() ? VK_IMAGE_VIEW_TYPE_CUBE : VK_IMAGE_VIEW_TYPE_2D);
+	texture->setMipLevels(container->getMipCount());
+	texture->setSampleCount(VK_SAMPLE_COUNT_1_BIT);
+	texture->setTransient(false);
+	texture->createInternalResources();
+
+	// ktx2 and dds order their subresources differently, so just take the span that covers all of them
+	uint64_t start = UINT64_MAX;
+	uint64_t end = 0;
+
+	for (int mip = 0; mip < container->getMipCount(); mip++)
+	{
+		for (int face = 0; face < container->getFaceCount(); face++)
+		{
+			const TextureContainerSubresource &subresource = container->getSubresource(mip, 0, face);
+
+			start = Calc<uint64_t>::min(start, subresource.offset);
+			end = Calc<uint64_t>::max(end, subresource.offset + subresource.size);
+		}
+	}
+
+	Vector<TextureUploadRegion> regions;
+
+	for (int mip = 0; mip < container->getMipCount(); mip++)
+	{
+		for (int face = 0; face < container->getFaceCount(); face++)
+		{
+			TextureUploadRegion region = {};
+			region.offset = container->getSubresource(mip, 0, face).offset - start;
+			region.mipLevel = mip;
+			region.arrayLayer = face;
+
+			regions.pushBack(region);
+		}
+	}
+
+	m_uploader.uploadRegions(texture, container->getData() + start, end - start, regions.data(), regions.size());
+
+	m_memoryStats.residentBytes += end - start;
+
+	recordContainerStats(container);
+
+	// the file is copied into the ring now
+	delete load->container;
+	load->container = nullptr;
+
+	load->texture = texture;
+
+	return true;
+}
+
+void TextureMgr::recordContainerStats(const TextureContainer *container)
+{
+	m_memoryStats.textureCount++;
+
+	if (!vkutil::isBlockCompressed(container->getFormat()))
+	{
+		for (int mip = 0; mip < container->getMipCount(); mip++)
+		{
+			for (int face = 0; face < container->getFaceCount(); face++) {
+				m_memoryStats.uncompressedBytes += container->getSubresource(mip, 0, face).size;
+			}
+		}
+
+		return;
+	}
+
+	m_memoryStats.compressedCount++;
+
+	bool isHDR = container->getFormat() == VK_FORMAT_BC6H_UFLOAT_BLOCK || container->getFormat() == VK_FORMAT_BC6H_SFLOAT_BLOCK;
+
+	for (int mip = 0; mip < container->getMipCount(); mip++)
+	{
+		const TextureContainerSubresource &subresource = container->getSubresource(mip, 0, 0);
+		m_memoryStats.uncompressedBytes += (uint64_t)subresource.width * subresource.height * container->getFaceCount() * (isHDR ? 16 : 4);
+	}
+}
+
+TextureMgr::PendingLoad *TextureMgr::getPendingLoad(const String &name)
+{
+	for (auto *load : m_pendingLoads)
+	{
+		if (load->name == name) {
+			return load;
+		}
+	}
+
+	return nullptr;
+}
+
+void TextureMgr::finishPendingLoads()
+{
+	// reads hand their loads over to the workers from their callbacks, so those have to have run first
+	g_asyncIO->waitIdle();
+
+	// once the workers are idle every pending load is sitting in the decode queue
+	g_threadPool->waitIdle();
+
+	update();
+
+	m_uploader.waitIdle();
+
+	update();
 }
 
 Texture *TextureMgr::createFromImage(const String &name, const Image &image)
@@ -70,17 +774,11 @@ Texture *TextureMgr::createFromImage(const String &name, const Image &image)
 
 	Texture *texture = new Texture();
 
-	texture->fromImage(image, VK_IMAGE_VIEW_TYPE_2D, 4, VK_SAMPLE_COUNT_1_BIT);
-	texture->setMipLevels(1);
+	texture->fromImage(image, VK_IMAGE_VIEW_TYPE_2D, vkutil::calcMipLevels(image.getWidth(), image.getHeight()), VK_SAMPLE_COUNT_1_BIT);
 	texture->createInternalResources();
-	texture->transitionLayoutSingle(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
 
-	g_gpuBufferManager->textureStagingBuffer->writeDataToMe(image.getData(), image.getSize(), 0);
-	g_gpuBufferManager->textureStagingBuffer->writeToTextureSingle(texture, image.getSize());
-
-	CommandBuffer cmd = vkutil::beginSingleTimeCommands(g_vkCore->getGraphicsCommandPool());
-	texture->generateMipmaps(cmd);
-	vkutil::endSingleTimeGraphicsCommands(cmd);
+	m_uploader.upload(texture, image.getData(), image.getSize());
+	m_uploader.wait(m_uploader.submit());
 
 	m_textureCache.insert(name, texture);
 	return texture;
@@ -96,19 +794,25 @@ Texture *TextureMgr::createFromData(const String &name, uint32_t width, uint32_t
 
 	texture->setSize(width, height);
 	texture->setProperties(format, tiling, VK_IMAGE_VIEW_TYPE_2D);
+
+	if (data) {
+		texture->setMipLevels(vkutil::calcMipLevels(width, height));
+	}
+
 	texture->createInternalResources();
 
 	CommandBuffer cmd = vkutil::beginSingleTimeCommands(g_vkCore->getGraphicsCommandPool());
 
 	if (data)
 	{
+		// these write straight to the start of the staging buffer, so nothing can still be uploading out of it
+		m_uploader.waitIdle();
+
 		texture->transitionLayout(cmd, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
 
 		g_gpuBufferManager->textureStagingBuffer->writeDataToMe(data, size, 0);
 		g_gpuBufferManager->textureStagingBuffer->writeToTextureSingle(texture, size);
 
-		texture->setMipLevels(4);
-
 		texture->generateMipmaps(cmd);
 	}
 	else
@@ -176,6 +880,8 @@ Texture *TextureMgr::createCubemap(const String &name, const Image &right, const
 
 	const Image *sides[] = { &right, &left, &top, &bottom, &front, &back };
 
+	m_uploader.waitIdle();
+
 	for (int i = 0; i < 6; i++)
 	{
 		g_gpuBufferManager->textureStagingBuffer->writeDataToMe(sides[i]->getData(), sides[i]->getSize(), sides[i]->getSize() * i);
@@ -209,3 +915,13 @@ TextureSampler *TextureMgr::createSampler(const String &name, const TextureSampl
 	m_samplerCache.insert(name, sampler);
 	return sampler;
 }
+
+void TextureMgr::destroyTexture(const String &name)
+{
+	if (!m_textureCache.contains(name)) {
+		return;
+	}
+
+	delete m_textureCache.get(name);
+	m_textureCache.erase(name);
+}
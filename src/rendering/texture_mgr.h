@@ -1,16 +1,48 @@
 #ifndef VK_TEXTURE_MGR_H_
 #define VK_TEXTURE_MGR_H_
 
+#include <mutex>
+#include <condition_variable>
+
 #include "container/vector.h"
 #include "container/hash_map.h"
+#include "container/function.h"
 
 #include "vulkan/texture.h"
 
+#include "texture_uploader.h"
+#include "texture_cache.h"
+#include "texture_streamer.h"
+
 namespace llt
 {
 	class Texture;
 	class TextureSampler;
 	class Image;
+	class TextureContainer;
+
+	struct AsyncReadRequest;
+
+	struct TextureLoadRequest
+	{
+		String name;
+		String path;
+
+		TextureCompression compression = TEXTURE_COMPRESSION_NONE;
+		bool mipmapped = true;
+	};
+
+	struct TextureMemoryStats
+	{
+		uint64_t residentBytes;		// what the loaded textures actually take up on the gpu
+		uint64_t uncompressedBytes;	// what they would take up if none of them were block compressed
+
+		uint32_t textureCount;
+		uint32_t compressedCount;
+		uint32_t streamedCount;
+	};
+
+	using TextureLoadedFn = Function<void(Texture *)>;
 
 	class TextureMgr
 	{
@@ -18,12 +50,56 @@ namespace llt
 		TextureMgr();
 		~TextureMgr();
 
+		/*
+		 * Needs the global staging buffers to exist already.
+		 */
+		void init();
+
+		/*
+		 * Finishes off any async loads whose uploads have landed and runs their callbacks.
+		 */
+		void update();
+
 		void loadDefaultTexturesAndSamplers();
 
 		Texture *getTexture(const String &name);
 		TextureSampler *getSampler(const String &name);
 
-		Texture *load(const String &name, const String &path);
+		/*
+		 * Compressed loads are cooked into a cache file next to the source the first time they're
+		 * loaded, and from then on the compressed mip chain is uploaded straight from that file.
+		 *
+		 * KTX2 and DDS files are always uploaded as they're stored (format, mips, cube faces), so the
+		 * compression setting is ignored for them.
+		 */
+		Texture *load(const String &name, const String &path, TextureCompression compression = TEXTURE_COMPRESSION_NONE);
+
+		/*
+		 * Decodes every image on the worker threads and uploads them all in as few command buffers as possible.
+		 * Blocks until they're all ready, returned in the same order as the requests (nullptr if one failed).
+		 */
+		Vector<Texture *> loadMany(const Vector<TextureLoadRequest> &requests);
+
+		/*
+		 * Same as loadMany, but returns straight away. The callback is run from update() once the texture is
+		 * usable, or immediately if it's already loaded. Until then getTexture() won't return it.
+		 */
+		void loadAsync(const String &name, const String &path, const TextureLoadedFn &onLoaded = nullptr, TextureCompression compression = TEXTURE_COMPRESSION_NONE);
+
+		uint32_t getPendingLoadCount() const;
+
+		/*
+		 * Only covers textures that went through load / loadMany / loadAsync.
+		 * Streamed textures count whatever of their mip chain is resident right now.
+		 */
+		TextureMemoryStats getMemoryStats() const;
+		bool isBlockCompressionSupported() const;
+
+		/*
+		 * Cooked, KTX2 and DDS textures with a big enough mip chain are streamed rather than fully resident.
+		 */
+		TextureStreamer &getStreamer();
+		const TextureStreamer &getStreamer() const;
 		
 		Texture *createFromImage(const String &name, const Image &image);
 		Texture *createFromData(const String &name, uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, const byte *data, uint64_t size);
@@ -34,9 +110,76 @@ namespace llt
 
 		TextureSampler *createSampler(const String &name, const TextureSampler::Style &style);
 
+		/*
+		 * Frees a texture made with one of the create functions so the name can be reused.
+		 * Nothing in flight can still be using it.
+		 */
+		void destroyTexture(const String &name);
+
 	private:
-		HashMap<String, Texture*> m_textureCache;
-		HashMap<String, TextureSampler*> m_samplerCache;
+		struct PendingLoad
+		{
+			String name;
+			String path;
+
+			TextureCompression compression;
+			bool mipmapped;
+
+			Vector<byte, MEM_TAG_IO> fileData; // the whole source file, if it was read through g_asyncIO
+
+			Image *image;
+			TextureCacheReader *cooked; // set instead of image if the load was compressed
+			TextureContainer *container; // set instead of image for ktx2 / dds files
+			Texture *texture;
+
+			bool decoded;
+			uint64_t ticket; // upload batch the texture was recorded into
+
+			Vector<TextureLoadedFn> callbacks;
+		};
+
+		/**
+		 * Where the workers hand back loads once they've been decoded.
+		 */
+		struct DecodeQueue
+		{
+			std::mutex mutex;
+			std::condition_variable condition;
+			Vector<PendingLoad *> decoded;
+		};
+
+		PendingLoad *createPendingLoad(const String &name, const String &path, TextureCompression compression, bool mipmapped);
+		void decodeAsync(PendingLoad *load, DecodeQueue *queue);
+
+		/*
+		 * Plain images sitting loose on disk are read through g_asyncIO before being decoded, fills in the read
+		 * that hands the load over to decodeAsync once it lands. Returns false if the load should go straight to
+		 * decodeAsync instead (archived, cooked or container files, which are opened by the worker).
+		 */
+		bool prepareRead(PendingLoad *load, DecodeQueue *queue, AsyncReadRequest *request);
+
+		/*
+		 * Creates the texture for a decoded load and records its upload into the open batch.
+		 */
+		bool recordUpload(PendingLoad *load);
+		void recordCookedUpload(PendingLoad *load);
+		bool recordContainerUpload(PendingLoad *load);
+		void recordContainerStats(const TextureContainer *container);
+
+		PendingLoad *getPendingLoad(const String &name);
+		void finishPendingLoads();
+
+		TextureUploader m_uploader;
+		TextureStreamer m_streamer;
+
+		Vector<PendingLoad *> m_pendingLoads;
+		DecodeQueue m_asyncDecodeQueue;
+
+		TextureMemoryStats m_memoryStats;
+		bool m_blockCompressionSupported;
+
+		HashMap<String, Texture*, MEM_TAG_ASSETS> m_textureCache;
+		HashMap<String, TextureSampler*, MEM_TAG_ASSETS> m_samplerCache;
 	};
 
 	extern TextureMgr *g_textureManager;
@@ -0,0 +1,552 @@
+#include "texture_streamer.h"
+
+#include <glm/glm.hpp>
+
+#include "core/cpu_profiler.h"
+
+#include "vulkan/core.h"
+#include "vulkan/texture.h"
+
+#include "io/texture_container.h"
+
+#include "math/calc.h"
+
+#include "texture_uploader.h"
+#include "texture_cache.h"
+#include "camera.h"
+#include "sub_mesh.h"
+#include "mesh.h"
+#include "render_object.h"
+#include "material.h"
+#include "material_system.h"
+
+using namespace llt;
+
+// how many frames a texture can go without being requested before it counts as unused
+static constexpr uint64_t VISIBLE_FRAMES = 60;
+
+// keeps a sudden camera cut from turning into one giant upload
+static constexpr int MAX_CHANGES_PER_FRAME = 4;
+
+TextureStreamer::TextureStreamer()
+	: m_uploader(nullptr)
+	, m_textures()
+	, m_slots()
+	, m_pending()
+	, m_retired()
+	, m_budget(DEFAULT_BUDGET)
+	, m_residentBytes(0)
+	, m_frame(0)
+{
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	cleanUp();
+}
+
+void TextureStreamer::init(TextureUploader *uploader)
+{
+	m_uploader = uploader;
+}
+
+void TextureStreamer::cleanUp()
+{
+	// the uploader has already been waited on by now, so nothing is reading from these
+	for (auto &change : m_pending) {
+		delete change.next;
+	}
+
+	m_pending.clear();
+
+	releaseRetired(true);
+
+	// the textures themselves belong to the texture manager
+	for (auto *streamed : m_textures)
+	{
+		delete streamed->cooked;
+		delete streamed->container;
+		delete streamed;
+	}
+
+	m_textures.clear();
+	m_slots.clear();
+
+	m_residentBytes = 0;
+}
+
+bool TextureStreamer::isStreamable(uint32_t width, uint32_t height, uint32_t mipCount, uint32_t faceCount)
+{
+	return
+		faceCount == 1 &&
+		mipCount > 1 && mipCount <= MAX_MIP_LEVELS &&
+		CalcU::max(width, height) > RESIDENT_MIP_SIZE;
+}
+
+Texture *TextureStreamer::createStreamed(TextureCacheReader *source)
+{
+	StreamedTexture *streamed = new StreamedTexture();
+	streamed->cooked = source;
+	streamed->container = nullptr;
+	streamed->format = source->getFormat();
+	streamed->width = source->getWidth();
+	streamed->height = source->getHeight();
+	streamed->mipCount = source->getMipCount();
+
+	for (int i = 0; i < streamed->mipCount; i++)
+	{
+		streamed->mipData[i] = source->getData() + source->getMip(i).offset;
+		streamed->mipSize[i] = source->getMip(i).size;
+	}
+
+	return createStreamed(streamed);
+}
+
+Texture *TextureStreamer::createStreamed(TextureContainer *source)
+{
+	StreamedTexture *streamed = new StreamedTexture();
+	streamed->cooked = nullptr;
+	streamed->container = source;
+	streamed->format = source->getFormat();
+	streamed->width = source->getWidth();
+	streamed->height = source->getHeight();
+	streamed->mipCount = source->getMipCount();
+
+	for (int i = 0; i < streamed->mipCount; i++)
+	{
+		streamed->mipData[i] = source->getData() + source->getSubresource(i, 0, 0).offset;
+		streamed->mipSize[i] = source->getSubresource(i, 0, 0).size;
+	}
+
+	return createStreamed(streamed);
+}
+
+Texture *TextureStreamer::createStreamed(StreamedTexture *streamed)
+{
+	uint32_t baseMip = 0;
+
+	while (baseMip < streamed->mipCount - 1 && CalcU::max(streamed->width >> baseMip, streamed->height >> baseMip) > RESIDENT_MIP_SIZE) {
+		baseMip++;
+	}
+
+	streamed->baseMip = baseMip;
+	streamed->residentMip = baseMip;
+	streamed->targetMip = baseMip;
+	streamed->requestedMip = baseMip;
+	streamed->lastRequestFrame = 0;
+
+	streamed->texture = recordChain(streamed, baseMip);
+
+	m_textures.pushBack(streamed);
+	m_slots.insert(streamed->texture->getStandardView().getBindlessHandle().id, streamed);
+
+	m_residentBytes += getChainSize(streamed, baseMip);
+
+	return streamed->texture;
+}
+
+void TextureStreamer::requestFromRenderList(const Camera &camera, const Vector<SubMesh *> &renderList)
+{
+	float tanHalfFov = CalcF::tan(glm::radians(camera.fov) * 0.5f);
+
+	for (SubMesh *mesh : renderList)
+	{
+		const Material *material = mesh->getMaterial();
+
+		if (!material) {
+			continue;
+		}
+
+		glm::mat4 transform = mesh->getParent()->getOwner()->transform.getMatrix();
+
+		glm::vec3 localCentre = (mesh->getBoundsMin() + mesh->getBoundsMax()) * 0.5f;
+		glm::vec3 localExtents = (mesh->getBoundsMax() - mesh->getBoundsMin()) * 0.5f;
+
+		float scale = CalcF::max(glm::length(glm::vec3(transform[0])), CalcF::max(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+
+		glm::vec3 centre = glm::vec3(transform * glm::vec4(localCentre, 1.0f));
+		float radius = glm::length(localExtents) * scale;
+
+		float distance = CalcF::max(glm::length(centre - camera.position) - radius, camera.near);
+
+		// roughly how many pixels the mesh covers across, assuming its uvs span the whole texture once
+		float screenSize = CalcF::max((radius / (distance * tanHalfFov)) * camera.height, 1.0f);
+
+		for (auto &handle : material->m_textures)
+		{
+			StreamedTexture *streamed = m_slots.getOrDefault(handle.id, nullptr);
+
+			if (!streamed) {
+				continue;
+			}
+
+			float texelsPerPixel = (float)CalcU::max(streamed->width, streamed->height) / screenSize;
+			int mip = (texelsPerPixel > 1.0f) ? (int)CalcF::log2(texelsPerPixel) : 0;
+
+			requestMip(handle.id, mip);
+		}
+	}
+}
+
+void TextureStreamer::requestMip(BindlessResourceID id, uint32_t mip)
+{
+	StreamedTexture *streamed = m_slots.getOrDefault(id, nullptr);
+
+	if (!streamed) {
+		return;
+	}
+
+	mip = CalcU::min(mip, streamed->baseMip);
+
+	if (streamed->lastRequestFrame != m_frame)
+	{
+		streamed->requestedMip = mip;
+		streamed->lastRequestFrame = m_frame;
+	}
+	else
+	{
+		streamed->requestedMip = CalcU::min(streamed->requestedMip, mip);
+	}
+}
+
+void TextureStreamer::update()
+{
+	LLT_PROFILE_SCOPE("TextureStreamer::update");
+
+	finishChanges();
+	releaseRetired(false);
+
+	uint64_t budget = getEffectiveBudget();
+
+	// what everything will take up once the changes in flight land
+	uint64_t committed = 0;
+
+	for (auto *streamed : m_textures) {
+		committed += getChainSize(streamed, streamed->targetMip);
+	}
+
+	int changes = 0;
+
+	// stream in, most recently requested first, and the ones furthest off what they want before those
+	while (changes < MAX_CHANGES_PER_FRAME)
+	{
+		StreamedTexture *best = nullptr;
+
+		for (auto *streamed : m_textures)
+		{
+			if (streamed->targetMip != streamed->residentMip || !isVisible(streamed) || streamed->requestedMip >= streamed->residentMip) {
+				continue;
+			}
+
+			if (!best ||
+				streamed->lastRequestFrame > best->lastRequestFrame ||
+				(streamed->lastRequestFrame == best->lastRequestFrame && streamed->residentMip - streamed->requestedMip > best->residentMip - best->requestedMip))
+			{
+				best = streamed;
+			}
+		}
+
+		if (!best) {
+			break;
+		}
+
+		uint32_t topMip = best->requestedMip;
+		uint64_t current = getChainSize(best, best->residentMip);
+
+		// make room by trimming textures nobody is looking at, never ones that are still in use
+		while (committed + getChainSize(best, topMip) - current > budget && changes < MAX_CHANGES_PER_FRAME - 1)
+		{
+			StreamedTexture *victim = findEvictionCandidate(best, false);
+
+			if (!victim) {
+				break;
+			}
+
+			uint32_t victimMip = getEvictionTarget(victim, false);
+
+			committed -= getChainSize(victim, victim->residentMip) - getChainSize(victim, victimMip);
+
+			beginChange(victim, victimMip);
+			changes++;
+		}
+
+		// if it still doesn't fit then bring in as much as will
+		while (topMip < best->residentMip && committed + getChainSize(best, topMip) - current > budget) {
+			topMip++;
+		}
+
+		// nothing left to evict, so anything further down the list won't fit either
+		if (topMip == best->residentMip) {
+			break;
+		}
+
+		committed += getChainSize(best, topMip) - current;
+
+		beginChange(best, topMip);
+		changes++;
+	}
+
+	// still over, e.g. the budget was lowered or the driver is under memory pressure, so visible textures have to give up mips too
+	while (committed > budget && changes < MAX_CHANGES_PER_FRAME)
+	{
+		StreamedTexture *victim = findEvictionCandidate(nullptr, true);
+
+		if (!victim) {
+			break;
+		}
+
+		uint32_t victimMip = getEvictionTarget(victim, true);
+
+		committed -= getChainSize(victim, victim->residentMip) - getChainSize(victim, victimMip);
+
+		beginChange(victim, victimMip);
+		changes++;
+	}
+
+	if (changes > 0)
+	{
+		uint64_t ticket = m_uploader->submit();
+
+		for (auto &change : m_pending)
+		{
+			if (change.ticket == 0) {
+				change.ticket = ticket;
+			}
+		}
+	}
+
+	m_frame++;
+}
+
+void TextureStreamer::setBudget(uint64_t bytes)
+{
+	m_budget = bytes;
+}
+
+uint64_t TextureStreamer::getBudget() const
+{
+	return m_budget;
+}
+
+uint64_t TextureStreamer::getResidentBytes() const
+{
+	return m_residentBytes;
+}
+
+uint32_t TextureStreamer::getStreamedCount() const
+{
+	return m_textures.size();
+}
+
+uint32_t TextureStreamer::getPendingCount() const
+{
+	return m_pending.size();
+}
+
+Texture *TextureStreamer::recordChain(StreamedTexture *streamed, uint32_t topMip)
+{
+	Texture *texture = new Texture();
+
+	texture->setSize(CalcU::max(streamed->width >> topMip, 1), CalcU::max(streamed->height >> topMip, 1));
+	texture->setProperties(streamed->format, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_VIEW_TYPE_2D);
+	texture->setMipLevels(streamed->mipCount - topMip);
+	texture->setSampleCount(VK_SAMPLE_COUNT_1_BIT);
+	texture->setTransient(false);
+	texture->createInternalResources();
+
+	// sources store their mips back to back, but not always in the same order, so copy the span covering all of them
+	const byte *start = streamed->mipData[topMip];
+	const byte *end = streamed->mipData[topMip] + streamed->mipSize[topMip];
+
+	for (int i = topMip; i < streamed->mipCount; i++)
+	{
+		if (streamed->mipData[i] < start) {
+			start = streamed->mipData[i];
+		}
+
+		if (streamed->mipData[i] + streamed->mipSize[i] > end) {
+			end = streamed->mipData[i] + streamed->mipSize[i];
+		}
+	}
+
+	TextureUploadRegion regions[MAX_MIP_LEVELS] = {};
+
+	for (int i = topMip; i < streamed->mipCount; i++)
+	{
+		regions[i - topMip].offset = streamed->mipData[i] - start;
+		regions[i - topMip].mipLevel = i - topMip;
+		regions[i - topMip].arrayLayer = 0;
+	}
+
+	m_uploader->uploadRegions(texture, start, end - start, regions, streamed->mipCount - topMip);
+
+	return texture;
+}
+
+void TextureStreamer::beginChange(StreamedTexture *streamed, uint32_t topMip)
+{
+	PendingChange change = {};
+	change.streamed = streamed;
+	change.next = recordChain(streamed, topMip);
+	change.ticket = 0; // filled in once the batch is submitted
+
+	streamed->targetMip = topMip;
+
+	m_pending.pushBack(change);
+}
+
+void TextureStreamer::finishChanges()
+{
+	for (int i = 0; i < m_pending.size();)
+	{
+		PendingChange &change = m_pending[i];
+
+		if (!m_uploader->isComplete(change.ticket))
+		{
+			i++;
+			continue;
+		}
+
+		StreamedTexture *streamed = change.streamed;
+		Texture *texture = streamed->texture;
+
+		BindlessResourceHandle oldHandle = texture->getStandardView().getBindlessHandle();
+
+		texture->swapResources(*change.next);
+
+		// this registers a fresh slot for the new image, the old slot stays valid for the frames still using it
+		BindlessResourceHandle newHandle = texture->getStandardView().getBindlessHandle();
+
+		if (g_materialSystem) {
+			g_materialSystem->getRegistry().remapTexture(oldHandle.id, newHandle.id);
+		}
+
+		m_slots.erase(oldHandle.id);
+		m_slots.insert(newHandle.id, streamed);
+
+		m_residentBytes -= getChainSize(streamed, streamed->residentMip);
+		m_residentBytes += getChainSize(streamed, streamed->targetMip);
+
+		streamed->residentMip = streamed->targetMip;
+
+		RetiredImage retired = {};
+		retired.texture = change.next;
+		retired.handle = oldHandle;
+		retired.releaseFrame = m_frame + mgc::FRAMES_IN_FLIGHT + 1;
+
+		m_retired.pushBack(retired);
+
+		m_pending.erase(i);
+	}
+}
+
+void TextureStreamer::releaseRetired(bool force)
+{
+	for (int i = 0; i < m_retired.size();)
+	{
+		RetiredImage &retired = m_retired[i];
+
+		if (!force && retired.releaseFrame > m_frame)
+		{
+			i++;
+			continue;
+		}
+
+		// when forced we're shutting down and the bindless set is already gone
+		if (!force) {
+			g_bindlessResources->releaseTexture2D(retired.handle);
+		}
+
+		delete retired.texture;
+
+		m_retired.erase(i);
+	}
+}
+
+TextureStreamer::StreamedTexture *TextureStreamer::findEvictionCandidate(const StreamedTexture *exclude, bool allowVisible) const
+{
+	StreamedTexture *candidate = nullptr;
+
+	for (auto *streamed : m_textures)
+	{
+		if (streamed == exclude || streamed->targetMip != streamed->residentMip) {
+			continue;
+		}
+
+		if (getEvictionTarget(streamed, allowVisible) <= streamed->residentMip) {
+			continue;
+		}
+
+		// least recently used goes first
+		if (!candidate || streamed->lastRequestFrame < candidate->lastRequestFrame) {
+			candidate = streamed;
+		}
+	}
+
+	return candidate;
+}
+
+uint32_t TextureStreamer::getEvictionTarget(const StreamedTexture *streamed, bool allowVisible) const
+{
+	if (!isVisible(streamed)) {
+		return streamed->baseMip;
+	}
+
+	// more resident than it currently needs
+	if (streamed->requestedMip > streamed->residentMip) {
+		return streamed->requestedMip;
+	}
+
+	if (allowVisible) {
+		return CalcU::min(streamed->residentMip + 1, streamed->baseMip);
+	}
+
+	return streamed->residentMip;
+}
+
+bool TextureStreamer::isVisible(const StreamedTexture *streamed) const
+{
+	return streamed->lastRequestFrame + VISIBLE_FRAMES >= m_frame && streamed->lastRequestFrame > 0;
+}
+
+uint64_t TextureStreamer::getChainSize(const StreamedTexture *streamed, uint32_t topMip) const
+{
+	uint64_t size = 0;
+
+	for (int i = topMip; i < streamed->mipCount; i++) {
+		size += streamed->mipSize[i];
+	}
+
+	return size;
+}
+
+uint64_t TextureStreamer::getEffectiveBudget() const
+{
+	VmaBudget budgets[VK_MAX_MEMORY_HEAPS] = {};
+	vmaGetHeapBudgets(g_vkCore->m_vmaAllocator, budgets);
+
+	const VkPhysicalDeviceMemoryProperties *memoryProperties = nullptr;
+	vmaGetMemoryProperties(g_vkCore->m_vmaAllocator, &memoryProperties);
+
+	uint64_t overshoot = 0;
+
+	for (int i = 0; i < memoryProperties->memoryHeapCount; i++)
+	{
+		if (!(memoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)) {
+			continue;
+		}
+
+		if (budgets[i].usage > budgets[i].budget) {
+			overshoot += budgets[i].usage - budgets[i].budget;
+		}
+	}
+
+	if (overshoot == 0) {
+		return m_budget;
+	}
+
+	// the driver wants memory back, so give up at least as much as we're over by
+	uint64_t reduced = (m_residentBytes > overshoot) ? m_residentBytes - overshoot : 0;
+
+	return Calc<uint64_t>::min(m_budget, reduced);
+}
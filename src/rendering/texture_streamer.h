@@ -0,0 +1,156 @@
+#ifndef TEXTURE_STREAMER_H_
+#define TEXTURE_STREAMER_H_
+
+#include "third_party/volk.h"
+
+#include "core/common.h"
+
+#include "container/vector.h"
+#include "container/hash_map.h"
+
+#include "bindless_resource_mgr.h"
+
+namespace llt
+{
+	class Texture;
+	class TextureUploader;
+	class TextureCacheReader;
+	class TextureContainer;
+	class Camera;
+	class SubMesh;
+
+	/**
+	 * Keeps only the mips of a texture that are actually needed on the gpu.
+	 *
+	 * Streamed textures start out with just their small mips resident, and keep the full mip chain around
+	 * on the cpu (mapped cache file, ktx2, dds...). Each frame the render list says how sharp every texture
+	 * needs to be, and textures get rebuilt with more or fewer mips to match, staying under a memory budget
+	 * by trimming whichever textures were used least recently.
+	 *
+	 * A residency change builds a whole new image on the side and only swaps it in once its upload has
+	 * landed. The new image gets its own bindless slot and materials are pointed at it in one go, so a
+	 * frame never sees a half-uploaded texture. The old image and slot are released once no frame in flight
+	 * can still be using them.
+	 */
+	class TextureStreamer
+	{
+	public:
+		static constexpr uint64_t DEFAULT_BUDGET = LLT_MEGABYTES(512);
+
+		// mips this size and smaller are always resident, and textures that are no bigger aren't streamed at all
+		static constexpr uint32_t RESIDENT_MIP_SIZE = 128;
+
+		static constexpr uint32_t MAX_MIP_LEVELS = 16;
+
+		TextureStreamer();
+		~TextureStreamer();
+
+		void init(TextureUploader *uploader);
+		void cleanUp();
+
+		static bool isStreamable(uint32_t width, uint32_t height, uint32_t mipCount, uint32_t faceCount);
+
+		/*
+		 * Creates the texture with only its small mips resident and records their upload into the open batch.
+		 * Takes ownership of the source, the rest of the mips are streamed out of it later on.
+		 */
+		Texture *createStreamed(TextureCacheReader *source);
+		Texture *createStreamed(TextureContainer *source);
+
+		/*
+		 * Picks a mip for every streamed texture in the render list from how big its mesh is on screen.
+		 */
+		void requestFromRenderList(const Camera &camera, const Vector<SubMesh *> &renderList);
+
+		/*
+		 * Asks for the texture in this bindless slot to have at least this mip resident. Takes the sharpest
+		 * request each frame, and ignores slots that don't belong to a streamed texture.
+		 */
+		void requestMip(BindlessResourceID id, uint32_t mip);
+
+		/*
+		 * Once per frame: swaps in residency changes whose uploads have landed, releases the images they
+		 * replaced, then starts the next lot of changes within the budget.
+		 */
+		void update();
+
+		void setBudget(uint64_t bytes);
+		uint64_t getBudget() const;
+
+		uint64_t getResidentBytes() const;
+		uint32_t getStreamedCount() const;
+		uint32_t getPendingCount() const;
+
+	private:
+		struct StreamedTexture
+		{
+			Texture *texture;
+
+			// whichever one the mip chain lives in
+			TextureCacheReader *cooked;
+			TextureContainer *container;
+
+			VkFormat format;
+
+			uint32_t width;
+			uint32_t height;
+			uint32_t mipCount;
+
+			const byte *mipData[MAX_MIP_LEVELS];
+			uint64_t mipSize[MAX_MIP_LEVELS];
+
+			uint32_t baseMip;		// top mip of the chain that's always resident
+			uint32_t residentMip;	// top mip of the chain that's on the gpu right now
+			uint32_t targetMip;		// what it'll be once any pending change lands
+
+			uint32_t requestedMip;
+			uint64_t lastRequestFrame;
+		};
+
+		struct PendingChange
+		{
+			StreamedTexture *streamed;
+			Texture *next;
+			uint64_t ticket;
+		};
+
+		struct RetiredImage
+		{
+			Texture *texture; // holds the replaced image after the swap
+			BindlessResourceHandle handle;
+			uint64_t releaseFrame;
+		};
+
+		Texture *createStreamed(StreamedTexture *streamed);
+
+		/*
+		 * Builds a texture holding the chain from topMip down and records its upload.
+		 */
+		Texture *recordChain(StreamedTexture *streamed, uint32_t topMip);
+
+		void beginChange(StreamedTexture *streamed, uint32_t topMip);
+		void finishChanges();
+		void releaseRetired(bool force);
+
+		StreamedTexture *findEvictionCandidate(const StreamedTexture *exclude, bool allowVisible) const;
+		uint32_t getEvictionTarget(const StreamedTexture *streamed, bool allowVisible) const;
+
+		bool isVisible(const StreamedTexture *streamed) const;
+		uint64_t getChainSize(const StreamedTexture *streamed, uint32_t topMip) const;
+		uint64_t getEffectiveBudget() const;
+
+		TextureUploader *m_uploader;
+
+		Vector<StreamedTexture *> m_textures;
+		HashMap<BindlessResourceID, StreamedTexture *> m_slots;
+
+		Vector<PendingChange> m_pending;
+		Vector<RetiredImage> m_retired;
+
+		uint64_t m_budget;
+		uint64_t m_residentBytes;
+		uint64_t m_frame;
+	};
+}
+
+#endif // TEXTURE_STREAMER_H_
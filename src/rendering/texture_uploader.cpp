@@ -0,0 +1,271 @@
+#include "texture_uploader.h"
+
+#include "vulkan/core.h"
+#include "vulkan/util.h"
+#include "vulkan/gpu_buffer.h"
+#include "vulkan/texture.h"
+#include "vulkan/command_buffer.h"
+#include "vulkan/render_stats.h"
+
+#include "math/calc.h"
+
+using namespace llt;
+
+// buffer-to-image copies need the offset to be a multiple of the texel size, 16 covers every format we load
+static constexpr uint64_t STAGING_ALIGNMENT = 16;
+
+TextureUploader::TextureUploader()
+	: m_stagingBuffer(nullptr)
+	, m_cursor(0)
+	, m_commandPool(VK_NULL_HANDLE)
+	, m_openBatch(VK_NULL_HANDLE)
+	, m_inFlight()
+	, m_nextTicket(1)
+	, m_completedTicket(0)
+{
+}
+
+TextureUploader::~TextureUploader()
+{
+	cleanUp();
+}
+
+void TextureUploader::init(GPUBuffer *stagingBuffer)
+{
+	m_stagingBuffer = stagingBuffer;
+	m_cursor = 0;
+
+	// the per-frame pools get reset every frame, so uploads that outlive a frame need a pool of their own
+	VkCommandPoolCreateInfo createInfo = {};
+	createInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	createInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	createInfo.queueFamilyIndex = g_vkCore->m_graphicsQueue.getFamilyIdx().value();
+
+	LLT_VK_CHECK(
+		vkCreateCommandPool(g_vkCore->m_device, &createInfo, nullptr, &m_commandPool),
+		"Failed to create texture upload command pool"
+	);
+}
+
+void TextureUploader::cleanUp()
+{
+	if (m_commandPool == VK_NULL_HANDLE) {
+		return;
+	}
+
+	waitIdle();
+
+	vkDestroyCommandPool(g_vkCore->m_device, m_commandPool, nullptr);
+	m_commandPool = VK_NULL_HANDLE;
+
+	m_stagingBuffer = nullptr;
+}
+
+void TextureUploader::upload(Texture *texture, const void *data, uint64_t size)
+{
+	uint64_t offset = allocate(size);
+
+	m_stagingBuffer->writeDataToMe(data, size, offset);
+
+	if (m_openBatch == VK_NULL_HANDLE) {
+		beginBatch();
+	}
+
+	CommandBuffer cmd(m_openBatch);
+
+	texture->transitionLayout(cmd, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+	m_stagingBuffer->writeToTexture(cmd, texture, size, offset);
+	texture->generateMipmaps(cmd);
+}
+
+void TextureUploader::uploadRegions(Texture *texture, const void *data, uint64_t size, const TextureUploadRegion *regions, uint32_t regionCount)
+{
+	uint64_t offset = allocate(size);
+
+	m_stagingBuffer->writeDataToMe(data, size, offset);
+
+	if (m_openBatch == VK_NULL_HANDLE) {
+		beginBatch();
+	}
+
+	CommandBuffer cmd(m_openBatch);
+
+	Vector<VkBufferImageCopy> copies(regionCount);
+
+	for (int i = 0; i < regionCount; i++)
+	{
+		copies[i] = {};
+		copies[i].bufferOffset = offset + regions[i].offset;
+		copies[i].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		copies[i].imageSubresource.mipLevel = regions[i].mipLevel;
+		copies[i].imageSubresource.baseArrayLayer = regions[i].arrayLayer;
+		copies[i].imageSubresource.layerCount = 1;
+		copies[i].imageExtent = {
+			CalcU::max(texture->getWidth() >> regions[i].mipLevel, 1),
+			CalcU::max(texture->getHeight() >> regions[i].mipLevel, 1),
+			1
+		};
+	}
+
+	texture->transitionLayout(cmd, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+	// every level, layer and face goes across in a single copy
+	cmd.copyBufferToImage(m_stagingBuffer->getHandle(), texture->getImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, copies);
+
+	texture->transitionLayout(cmd, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+uint64_t TextureUploader::submit()
+{
+	if (m_openBatch == VK_NULL_HANDLE)
+	{
+		// nothing recorded, so the last submitted batch is the one to wait on
+		return m_nextTicket - 1;
+	}
+
+	vkEndCommandBuffer(m_openBatch);
+
+	VkFenceCreateInfo fenceCreateInfo = {};
+	fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+	Batch batch = {};
+	batch.commandBuffer = m_openBatch;
+	batch.ticket = m_nextTicket++;
+
+	LLT_VK_CHECK(
+		vkCreateFence(g_vkCore->m_device, &fenceCreateInfo, nullptr, &batch.fence),
+		"Failed to create texture upload fence"
+	);
+
+	VkSubmitInfo submitInfo = {};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &batch.commandBuffer;
+
+	LLT_VK_CHECK(
+		vkQueueSubmit(g_vkCore->m_graphicsQueue.getQueue(), 1, &submitInfo, batch.fence),
+		"Failed to submit texture upload batch"
+	);
+
+	g_renderStats.submissions++;
+
+	m_inFlight.pushBack(batch);
+	m_openBatch = VK_NULL_HANDLE;
+
+	return batch.ticket;
+}
+
+void TextureUploader::update()
+{
+	retire(false);
+}
+
+bool TextureUploader::isComplete(uint64_t ticket)
+{
+	if (ticket > m_completedTicket) {
+		retire(false);
+	}
+
+	return ticket <= m_completedTicket;
+}
+
+void TextureUploader::wait(uint64_t ticket)
+{
+	while (!isComplete(ticket))
+	{
+		// batches are retired oldest first, so waiting on the front one always makes progress
+		vkWaitForFences(g_vkCore->m_device, 1, &m_inFlight[0].fence, VK_TRUE, UINT64_MAX);
+
+		g_renderStats.fenceWaits++;
+	}
+}
+
+void TextureUploader::waitIdle()
+{
+	if (m_openBatch != VK_NULL_HANDLE) {
+		submit();
+	}
+
+	retire(true);
+
+	m_cursor = 0;
+}
+
+bool TextureUploader::hasOpenBatch() const
+{
+	return m_openBatch != VK_NULL_HANDLE;
+}
+
+uint64_t TextureUploader::allocate(uint64_t size)
+{
+	uint64_t alignedSize = (size + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1);
+
+	if (alignedSize > m_stagingBuffer->getSize())
+	{
+		LLT_ERROR("Texture upload of %llu bytes doesn't fit in the staging buffer.", size);
+		return 0;
+	}
+
+	if (m_cursor + alignedSize > m_stagingBuffer->getSize())
+	{
+		// out of room, everything up to here has to land on the gpu before we can reuse the start of the ring
+		waitIdle();
+	}
+
+	uint64_t offset = m_cursor;
+	m_cursor += alignedSize;
+
+	return offset;
+}
+
+void TextureUploader::beginBatch()
+{
+	VkCommandBufferAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocInfo.commandPool = m_commandPool;
+	allocInfo.commandBufferCount = 1;
+
+	LLT_VK_CHECK(
+		vkAllocateCommandBuffers(g_vkCore->m_device, &allocInfo, &m_openBatch),
+		"Failed to allocate texture upload command buffer"
+	);
+
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	LLT_VK_CHECK(
+		vkBeginCommandBuffer(m_openBatch, &beginInfo),
+		"Failed to begin texture upload command buffer"
+	);
+}
+
+void TextureUploader::retire(bool wait)
+{
+	while (m_inFlight.size() > 0)
+	{
+		Batch &batch = m_inFlight[0];
+
+		if (wait)
+		{
+			vkWaitForFences(g_vkCore->m_device, 1, &batch.fence, VK_TRUE, UINT64_MAX);
+			g_renderStats.fenceWaits++;
+		}
+		else if (vkGetFenceStatus(g_vkCore->m_device, batch.fence) != VK_SUCCESS) {
+			break;
+		}
+
+		m_completedTicket = batch.ticket;
+
+		vkDestroyFence(g_vkCore->m_device, batch.fence, nullptr);
+		vkFreeCommandBuffers(g_vkCore->m_device, m_commandPool, 1, &batch.commandBuffer);
+
+		m_inFlight.erase(0);
+	}
+
+	// nothing left reading from the ring, so we can start packing from the beginning again
+	if (m_inFlight.size() == 0 && m_openBatch == VK_NULL_HANDLE) {
+		m_cursor = 0;
+	}
+}
@@ -0,0 +1,103 @@
+#ifndef TEXTURE_UPLOADER_H_
+#define TEXTURE_UPLOADER_H_
+
+#include "third_party/volk.h"
+
+#include "core/common.h"
+
+#include "container/vector.h"
+
+namespace llt
+{
+	class Texture;
+	class GPUBuffer;
+
+	/*
+	 * One subresource of a pre-built texture, offset is relative to the start of the data passed to uploadRegions.
+	 */
+	struct TextureUploadRegion
+	{
+		uint64_t offset;
+		uint32_t mipLevel;
+		uint32_t arrayLayer;
+	};
+
+	/**
+	 * Batches texture uploads into a single command buffer.
+	 *
+	 * Pixel data is packed linearly into a staging ring, and every copy + mip generation is recorded
+	 * into the currently open batch. submit() hands that batch to the graphics queue with its own fence
+	 * and returns a ticket, which can then be polled or waited on to find out when those textures are usable.
+	 *
+	 * When the ring runs out of space the open batch is submitted and we wait for everything in flight
+	 * before wrapping back to the start, so nothing still being copied from can be overwritten.
+	 */
+	class TextureUploader
+	{
+	public:
+		TextureUploader();
+		~TextureUploader();
+
+		void init(GPUBuffer *stagingBuffer);
+		void cleanUp();
+
+		/*
+		 * Copies the pixels into the ring and records the upload, leaving the texture in SHADER_READ_ONLY layout.
+		 * The texture must already have its internal resources created.
+		 */
+		void upload(Texture *texture, const void *data, uint64_t size);
+
+		/*
+		 * Uploads subresources that already exist (cooked mip chains, ktx2 / dds files, etc...) as-is
+		 * with one buffer-to-image copy, without generating any mips. Also leaves the texture in SHADER_READ_ONLY layout.
+		 */
+		void uploadRegions(Texture *texture, const void *data, uint64_t size, const TextureUploadRegion *regions, uint32_t regionCount);
+
+		/*
+		 * Submits the open batch without waiting on it. Returns the ticket of the batch.
+		 */
+		uint64_t submit();
+
+		/*
+		 * Retires any batches the gpu has finished with.
+		 */
+		void update();
+
+		bool isComplete(uint64_t ticket);
+		void wait(uint64_t ticket);
+
+		/*
+		 * Submits anything still open and blocks until the gpu has finished every batch.
+		 * Afterwards the whole staging buffer is free to be written to directly.
+		 */
+		void waitIdle();
+
+		bool hasOpenBatch() const;
+
+	private:
+		struct Batch
+		{
+			VkCommandBuffer commandBuffer;
+			VkFence fence;
+			uint64_t ticket;
+		};
+
+		uint64_t allocate(uint64_t size);
+
+		void beginBatch();
+		void retire(bool wait);
+
+		GPUBuffer *m_stagingBuffer;
+		uint64_t m_cursor;
+
+		VkCommandPool m_commandPool;
+		VkCommandBuffer m_openBatch;
+
+		Vector<Batch> m_inFlight;
+
+		uint64_t m_nextTicket;
+		uint64_t m_completedTicket;
+	};
+}
+
+#endif // TEXTURE_UPLOADER_H_
@@ -0,0 +1,164 @@
+#include "api_stats.h"
+
+#include <type_traits>
+
+#include "third_party/volk.h"
+
+#include "core/cpu_profiler.h"
+
+// the entry points that are worth paying for, anything called once at load time isn't
+#define LLT_API_STATS_FUNCTIONS(X) \
+	X(vkQueueSubmit) \
+	X(vkQueueSubmit2) \
+	X(vkQueuePresentKHR) \
+	X(vkQueueWaitIdle) \
+	X(vkAcquireNextImageKHR) \
+	X(vkWaitForFences) \
+	X(vkResetFences) \
+	X(vkGetFenceStatus) \
+	X(vkResetCommandPool) \
+	X(vkBeginCommandBuffer) \
+	X(vkEndCommandBuffer) \
+	X(vkAllocateDescriptorSets) \
+	X(vkResetDescriptorPool) \
+	X(vkUpdateDescriptorSets) \
+	X(vkMapMemory) \
+	X(vkUnmapMemory) \
+	X(vkFlushMappedMemoryRanges) \
+	X(vkGetQueryPoolResults) \
+	X(vkCmdBeginRendering) \
+	X(vkCmdEndRendering) \
+	X(vkCmdBindPipeline) \
+	X(vkCmdBindDescriptorSets) \
+	X(vkCmdPushConstants) \
+	X(vkCmdBindVertexBuffers) \
+	X(vkCmdBindIndexBuffer) \
+	X(vkCmdSetViewport) \
+	X(vkCmdSetScissor) \
+	X(vkCmdDrawIndexed) \
+	X(vkCmdDrawIndexedIndirect) \
+	X(vkCmdDrawIndexedIndirectCount) \
+	X(vkCmdDispatch) \
+	X(vkCmdPipelineBarrier) \
+	X(vkCmdPipelineBarrier2) \
+	X(vkCmdCopyBuffer) \
+	X(vkCmdCopyBufferToImage) \
+	X(vkCmdCopyImage) \
+	X(vkCmdCopyImageToBuffer) \
+	X(vkCmdBlitImage) \
+	X(vkCmdWriteTimestamp) \
+	X(vkCmdResetQueryPool) \
+	X(vkCmdBeginQuery) \
+	X(vkCmdEndQuery)
+
+using namespace llt;
+
+enum ApiFunction
+{
+#define LLT_API_STATS_ENUM(_name) API_FUNCTION_##_name,
+	LLT_API_STATS_FUNCTIONS(LLT_API_STATS_ENUM)
+#undef LLT_API_STATS_ENUM
+	API_FUNCTION_MAX_ENUM
+};
+
+static const char *g_functionNames[] = {
+#define LLT_API_STATS_NAME(_name) #_name,
+	LLT_API_STATS_FUNCTIONS(LLT_API_STATS_NAME)
+#undef LLT_API_STATS_NAME
+};
+
+static uint64_t g_calls[API_FUNCTION_MAX_ENUM];
+static uint64_t g_ticks[API_FUNCTION_MAX_ENUM];
+
+static Vector<ApiCallStats> g_lastFrame;
+static bool g_installed = false;
+
+template <ApiFunction Function, typename Pfn>
+struct ApiHook;
+
+/*
+ * One per hooked function, holds on to the real pointer and stands in for it in the table.
+ */
+template <ApiFunction Function, typename Result, typename ...Args>
+struct ApiHook<Function, Result (VKAPI_PTR *)(Args...)>
+{
+	static inline Result (VKAPI_PTR *real)(Args...) = nullptr;
+
+	static Result VKAPI_PTR call(Args ...args)
+	{
+		uint64_t begin = cpuprofiler::now();
+
+		if constexpr (std::is_void_v<Result>)
+		{
+			real(args...);
+
+			g_ticks[Function] += cpuprofiler::now() - begin;
+			g_calls[Function]++;
+		}
+		else
+		{
+			Result result = real(args...);
+
+			g_ticks[Function] += cpuprofiler::now() - begin;
+			g_calls[Function]++;
+
+			return result;
+		}
+	}
+};
+
+void apistats::install()
+{
+	// functions the device doesn't have are left null, the renderer checks for them itself
+#define LLT_API_STATS_HOOK(_name) \
+	if (_name) { \
+		ApiHook<API_FUNCTION_##_name, PFN_##_name>::real = _name; \
+		_name = ApiHook<API_FUNCTION_##_name, PFN_##_name>::call; \
+	}
+
+	LLT_API_STATS_FUNCTIONS(LLT_API_STATS_HOOK)
+
+#undef LLT_API_STATS_HOOK
+
+	g_lastFrame.clear();
+
+	for (int i = 0; i < API_FUNCTION_MAX_ENUM; i++)
+	{
+		g_lastFrame.pushBack({ g_functionNames[i], 0, 0.0 });
+
+		g_calls[i] = 0;
+		g_ticks[i] = 0;
+	}
+
+	g_installed = true;
+
+	LLT_LOG("Counting calls to %d vulkan functions.", (int)API_FUNCTION_MAX_ENUM);
+}
+
+bool apistats::isInstalled()
+{
+	return g_installed;
+}
+
+void apistats::endFrame()
+{
+	if (!g_installed) {
+		return;
+	}
+
+	double msPerTick = 1000.0 / (double)cpuprofiler::getTicksPerSecond();
+
+	for (int i = 0; i < API_FUNCTION_MAX_ENUM; i++)
+	{
+		g_lastFrame[i].calls = g_calls[i];
+		g_lastFrame[i].ms = (double)g_ticks[i] * msPerTick;
+
+		g_calls[i] = 0;
+		g_ticks[i] = 0;
+	}
+}
+
+const Vector<ApiCallStats> &apistats::getLastFrame()
+{
+	return g_lastFrame;
+}
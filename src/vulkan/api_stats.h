@@ -0,0 +1,49 @@
+#ifndef API_STATS_H_
+#define API_STATS_H_
+
+#include "core/common.h"
+
+#include "container/vector.h"
+
+namespace llt
+{
+	/*
+	 * How often one vulkan entry point was called over a frame and how long the driver took to return.
+	 */
+	struct ApiCallStats
+	{
+		const char *name;
+		uint64_t calls;
+		double ms;
+	};
+
+	/**
+	 * Optional shim over volk's function table that counts the calls made to the device and command buffer
+	 * entry points the renderer leans on and times each one on the cpu.
+	 *
+	 * Once installed, every hooked pointer in the table is swapped for a wrapper that reads the clock on
+	 * either side of the real call, so it's off unless asked for (--api-stats). Only calls made through
+	 * volk's globals are seen, vma and imgui load their own pointers. Like the render stats everything's
+	 * counted on the main thread, the only one that talks to vulkan.
+	 */
+	namespace apistats
+	{
+		/*
+		 * Has to be called right after volkLoadDevice(), which would put the real pointers back.
+		 */
+		void install();
+		bool isInstalled();
+
+		/*
+		 * Keeps what the frame called around for getLastFrame() and starts counting the next one.
+		 */
+		void endFrame();
+
+		/*
+		 * Every hooked function in the same order each time, including those that weren't called.
+		 */
+		const Vector<ApiCallStats> &getLastFrame();
+	}
+}
+
+#endif // API_STATS_H_
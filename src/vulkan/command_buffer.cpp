@@ -2,10 +2,14 @@
 
 #include "core/common.h"
 
+#include "math/calc.h"
+
 #include "core.h"
 #include "render_target.h"
 #include "render_info.h"
 #include "shader.h"
+#include "render_stats.h"
+#include "frame_capture.h"
 
 using namespace llt;
 
@@ -45,6 +49,8 @@ void CommandBuffer::beginRecording()
 	cauto &currentFrame = g_vkCore->m_graphicsQueue.getCurrentFrame();
 	vkWaitForFences(g_vkCore->m_device, 1, &currentFrame.inFlightFence, VK_TRUE, UINT64_MAX);
 
+	g_renderStats.fenceWaits++;
+
 	VkCommandBufferBeginInfo commandBufferBeginInfo = {};
 	commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 	commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
@@ -118,6 +124,8 @@ void CommandBuffer::submit(VkSemaphoreSubmitInfo computeSemaphore)
 		"Failed to submit draw command to buffer"
 	);
 
+	g_renderStats.submissions++;
+
 	m_currentTarget = nullptr;
 }
 
@@ -149,11 +157,19 @@ void CommandBuffer::beginRendering(const RenderInfo &info)
 
 	m_isRendering = true;
 
+	if (FrameCapture *capture = getCapture()) {
+		capture->recordBeginRendering(info);
+	}
+
 	vkCmdBeginRendering(m_buffer, &renderInfo);
 }
 
 void CommandBuffer::endRendering()
 {
+	if (FrameCapture *capture = getCapture()) {
+		capture->recordEndRendering();
+	}
+
 	vkCmdEndRendering(m_buffer);
 
 	if (m_currentTarget)
@@ -169,11 +185,17 @@ const RenderInfo &CommandBuffer::getCurrentRenderInfo() const
 
 void CommandBuffer::bindPipeline(VkPipelineBindPoint bindPoint, VkPipeline pipeline)
 {
+	if (FrameCapture *capture = getCapture()) {
+		capture->recordBindPipeline(bindPoint, pipeline);
+	}
+
 	vkCmdBindPipeline(
 		m_buffer,
 		bindPoint,
 		pipeline
 	);
+
+	g_renderStats.pipelineBinds++;
 }
 
 void CommandBuffer::drawIndexed(
@@ -184,6 +206,10 @@ void CommandBuffer::drawIndexed(
 	uint32_t firstInstance
 )
 {
+	if (FrameCapture *capture = getCapture()) {
+		capture->recordDrawIndexed(indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+	}
+
 	vkCmdSetViewport(m_buffer, 0, 1, &m_viewport);
 	vkCmdSetScissor(m_buffer, 0, 1, &m_scissor);
 
@@ -195,6 +221,10 @@ void CommandBuffer::drawIndexed(
 		vertexOffset,
 		firstInstance
 	);
+
+	g_renderStats.drawCalls++;
+	g_renderStats.instances += instanceCount;
+	g_renderStats.triangles += (uint64_t)(indexCount / 3) * instanceCount;
 }
 
 void CommandBuffer::drawIndexedIndirect(
@@ -204,6 +234,10 @@ void CommandBuffer::drawIndexedIndirect(
 	uint32_t stride
 )
 {
+	if (FrameCapture *capture = getCapture()) {
+		capture->recordDrawIndexedIndirect(buffer, offset, drawCount, stride);
+	}
+
 	vkCmdDrawIndexedIndirect(
 		m_buffer,
 		buffer,
@@ -211,6 +245,9 @@ void CommandBuffer::drawIndexedIndirect(
 		drawCount,
 		stride
 	);
+
+	// what's actually in the buffer is only known to the gpu
+	g_renderStats.drawCalls += drawCount;
 }
 
 void CommandBuffer::drawIndexedIndirectCount(
@@ -222,6 +259,10 @@ void CommandBuffer::drawIndexedIndirectCount(
 	uint32_t stride
 )
 {
+	if (FrameCapture *capture = getCapture()) {
+		capture->recordDrawIndexedIndirectCount(buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride);
+	}
+
 	vkCmdDrawIndexedIndirectCount(
 		m_buffer,
 		buffer,
@@ -231,6 +272,8 @@ void CommandBuffer::drawIndexedIndirectCount(
 		maxDrawCount,
 		stride
 	);
+
+	g_renderStats.drawCalls += maxDrawCount;
 }
 
 void CommandBuffer::bindDescriptorSets(
@@ -240,6 +283,10 @@ void CommandBuffer::bindDescriptorSets(
 	const Vector<uint32_t> &dynamicOffsets
 )
 {
+	if (FrameCapture *capture = getCapture()) {
+		capture->recordBindDescriptorSets(firstSet, layout, descriptorSets, dynamicOffsets);
+	}
+
 	vkCmdBindDescriptorSets(
 		m_buffer,
 		m_isRendering ? VK_PIPELINE_BIND_POINT_GRAPHICS : VK_PIPELINE_BIND_POINT_COMPUTE,
@@ -250,10 +297,17 @@ void CommandBuffer::bindDescriptorSets(
 		dynamicOffsets.size(),
 		dynamicOffsets.data()
 	);
+
+	g_renderStats.descriptorSetBinds += descriptorSets.size();
 }
 
 void CommandBuffer::setViewport(const VkViewport &viewport)
 {
+	// stored as it was passed in, replaying it flips it the same way again
+	if (FrameCapture *capture = getCapture()) {
+		capture->recordSetViewport(viewport);
+	}
+
 	m_viewport.x = viewport.x;
 	m_viewport.y = viewport.height - viewport.y;
 	m_viewport.width = viewport.width;
@@ -262,6 +316,10 @@ void CommandBuffer::setViewport(const VkViewport &viewport)
 
 void CommandBuffer::setScissor(const VkRect2D &scissor)
 {
+	if (FrameCapture *capture = getCapture()) {
+		capture->recordSetScissor(scissor);
+	}
+
 	m_scissor = scissor;
 }
 
@@ -273,6 +331,10 @@ void CommandBuffer::pushConstants(
 	uint32_t offset
 )
 {
+	if (FrameCapture *capture = getCapture()) {
+		capture->recordPushConstants(layout, stageFlags, size, data, offset);
+	}
+
 	vkCmdPushConstants(
 		m_buffer,
 		layout,
@@ -281,6 +343,8 @@ void CommandBuffer::pushConstants(
 		size,
 		data
 	);
+
+	g_renderStats.pushConstantBytes += size;
 }
 
 void CommandBuffer::bindVertexBuffers(
@@ -290,6 +354,10 @@ void CommandBuffer::bindVertexBuffers(
 	VkDeviceSize *offsets
 )
 {
+	if (FrameCapture *capture = getCapture()) {
+		capture->recordBindVertexBuffers(firstBinding, count, buffers, offsets);
+	}
+
 	vkCmdBindVertexBuffers(
 		m_buffer,
 		firstBinding,
@@ -305,6 +373,10 @@ void CommandBuffer::bindIndexBuffer(
 	VkIndexType indexType
 )
 {
+	if (FrameCapture *capture = getCapture()) {
+		capture->recordBindIndexBuffer(buffer, offset, indexType);
+	}
+
 	vkCmdBindIndexBuffer(
 		m_buffer,
 		buffer,
@@ -320,6 +392,10 @@ void CommandBuffer::pipelineBarrier(
 	const Vector<VkImageMemoryBarrier2> &imageMemoryBarriers
 )
 {
+	if (FrameCapture *capture = getCapture()) {
+		capture->recordPipelineBarrier(dependencyFlags, memoryBarriers, bufferMemoryBarriers, imageMemoryBarriers);
+	}
+
 	VkDependencyInfo dependency = {};
 	dependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR;
 
@@ -338,6 +414,8 @@ void CommandBuffer::pipelineBarrier(
 		m_buffer,
 		&dependency
 	);
+
+	g_renderStats.barriers += memoryBarriers.size() + bufferMemoryBarriers.size() + imageMemoryBarriers.size();
 }
 
 void CommandBuffer::transitionForMipmapGeneration(Texture &texture)
@@ -347,7 +425,7 @@ void CommandBuffer::transitionForMipmapGeneration(Texture &texture)
 		texture.transitionLayout(*this, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
 }
 
-void CommandBuffer::generateMipmaps(const Texture &texture)
+void CommandBuffer::generateMipmaps(const Texture &texture, VkFilter filter)
 {
 	VkImageMemoryBarrier2 barrier = {};
 	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
@@ -379,10 +457,11 @@ void CommandBuffer::generateMipmaps(const Texture &texture)
 
 		for (int face = 0; face < texture.getFaceCount(); face++)
 		{
-			int srcMipWidth  = (int)texture.getWidth()  >> (i - 1);
-			int srcMipHeight = (int)texture.getHeight() >> (i - 1);
-			int dstMipWidth  = (int)texture.getWidth()  >> (i - 0);
-			int dstMipHeight = (int)texture.getHeight() >> (i - 0);
+			// full chains of non-square textures bottom out at 1 on one side before the other
+			int srcMipWidth  = CalcI::max((int)texture.getWidth()  >> (i - 1), 1);
+			int srcMipHeight = CalcI::max((int)texture.getHeight() >> (i - 1), 1);
+			int dstMipWidth  = CalcI::max((int)texture.getWidth()  >> (i - 0), 1);
+			int dstMipHeight = CalcI::max((int)texture.getHeight() >> (i - 0), 1);
 
 			VkImageBlit blit = {};
 
@@ -404,7 +483,7 @@ void CommandBuffer::generateMipmaps(const Texture &texture)
 				texture.getImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
 				texture.getImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
 				{ blit },
-				VK_FILTER_LINEAR
+				filter
 			);
 		}
 
@@ -447,6 +526,10 @@ void CommandBuffer::blitImage(
 	VkFilter filter
 )
 {
+	if (FrameCapture *capture = getCapture()) {
+		capture->recordBlitImage(srcImage, srcImageLayout, dstImage, dstImageLayout, regions, filter);
+	}
+
 	vkCmdBlitImage(
 		m_buffer,
 		srcImage, srcImageLayout,
@@ -463,6 +546,10 @@ void CommandBuffer::copyBufferToBuffer(
 	const Vector<VkBufferCopy> &regions
 )
 {
+	if (FrameCapture *capture = getCapture()) {
+		capture->recordCopyBufferToBuffer(srcBuffer, dstBuffer, regions);
+	}
+
 	vkCmdCopyBuffer(
 		m_buffer,
 		srcBuffer,
@@ -479,6 +566,10 @@ void CommandBuffer::copyBufferToImage(
 	const Vector<VkBufferImageCopy> &regions
 )
 {
+	if (FrameCapture *capture = getCapture()) {
+		capture->recordCopyBufferToImage(srcBuffer, dstImage, dstImageLayout, regions);
+	}
+
 	vkCmdCopyBufferToImage(
 		m_buffer,
 		srcBuffer,
@@ -489,6 +580,27 @@ void CommandBuffer::copyBufferToImage(
 	);
 }
 
+void CommandBuffer::copyImageToBuffer(
+	VkImage srcImage,
+	VkImageLayout srcImageLayout,
+	VkBuffer dstBuffer,
+	const Vector<VkBufferImageCopy> &regions
+)
+{
+	if (FrameCapture *capture = getCapture()) {
+		capture->recordCopyImageToBuffer(srcImage, srcImageLayout, dstBuffer, regions);
+	}
+
+	vkCmdCopyImageToBuffer(
+		m_buffer,
+		srcImage,
+		srcImageLayout,
+		dstBuffer,
+		regions.size(),
+		regions.data()
+	);
+}
+
 void CommandBuffer::writeTimestamp(VkPipelineStageFlagBits pipelineStage, VkQueryPool pool, uint32_t query)
 {
 	vkCmdWriteTimestamp(
@@ -509,6 +621,25 @@ void CommandBuffer::resetQueryPool(VkQueryPool pool, uint32_t firstQuery, uint32
 	);
 }
 
+void CommandBuffer::beginQuery(VkQueryPool pool, uint32_t query)
+{
+	vkCmdBeginQuery(
+		m_buffer,
+		pool,
+		query,
+		0
+	);
+}
+
+void CommandBuffer::endQuery(VkQueryPool pool, uint32_t query)
+{
+	vkCmdEndQuery(
+		m_buffer,
+		pool,
+		query
+	);
+}
+
 void CommandBuffer::beginCompute()
 {
 	cauto &currentFrame = g_vkCore->m_computeQueues[0].getCurrentFrame(); // current buffer comes from here! (note to myself tomorrow after i get sleep)
@@ -516,6 +647,8 @@ void CommandBuffer::beginCompute()
 	vkWaitForFences(g_vkCore->m_device, 1, &currentFrame.inFlightFence, VK_TRUE, UINT64_MAX);
 	vkResetCommandPool(g_vkCore->m_device, currentFrame.commandPool, 0);
 
+	g_renderStats.fenceWaits++;
+
 	VkCommandBufferBeginInfo commandBufferBeginInfo = {};
 	commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 
@@ -550,10 +683,16 @@ void CommandBuffer::endCompute(VkSemaphore signalSemaphore)
 		vkQueueSubmit(g_vkCore->m_computeQueues[0].getQueue(), 1, &submitInfo, currentFrame.inFlightFence),
 		"Failed to submit compute command buffer"
 	);
+
+	g_renderStats.submissions++;
 }
 
 void CommandBuffer::dispatch(uint32_t gcX, uint32_t gcY, uint32_t gcZ)
 {
+	if (FrameCapture *capture = getCapture()) {
+		capture->recordDispatch(gcX, gcY, gcZ);
+	}
+
 	vkCmdDispatch(m_buffer, gcX, gcY, gcZ);
 }
 
@@ -561,3 +700,12 @@ VkCommandBuffer CommandBuffer::getHandle() const
 {
 	return m_buffer;
 }
+
+FrameCapture *CommandBuffer::getCapture() const
+{
+	if (g_frameCapture && g_frameCapture->isCapturing(m_buffer)) {
+		return g_frameCapture;
+	}
+
+	return nullptr;
+}
@@ -10,6 +10,7 @@ namespace llt
 {
 	class GenericRenderTarget;
 	class ShaderEffect;
+	class FrameCapture;
 
 	class CommandBuffer
 	{
@@ -98,7 +99,7 @@ namespace llt
 		);
 
 		void transitionForMipmapGeneration(Texture &texture);
-		void generateMipmaps(const Texture &texture);
+		void generateMipmaps(const Texture &texture, VkFilter filter = VK_FILTER_LINEAR);
 
 		void blitImage(
 			VkImage srcImage, VkImageLayout srcImageLayout,
@@ -120,10 +121,20 @@ namespace llt
 			const Vector<VkBufferImageCopy> &regions
 		);
 
+		void copyImageToBuffer(
+			VkImage srcImage,
+			VkImageLayout srcImageLayout,
+			VkBuffer dstBuffer,
+			const Vector<VkBufferImageCopy> &regions
+		);
+
 		void writeTimestamp(VkPipelineStageFlagBits pipelineStage, VkQueryPool pool, uint32_t query);
 
 		void resetQueryPool(VkQueryPool pool, uint32_t firstQuery, uint32_t queryCount);
 
+		void beginQuery(VkQueryPool pool, uint32_t query);
+		void endQuery(VkQueryPool pool, uint32_t query);
+
 		void beginCompute();
 		void endCompute(VkSemaphore signalSemaphore);
 
@@ -132,6 +143,9 @@ namespace llt
 		VkCommandBuffer getHandle() const;
 
 	private:
+		// the capture this buffer is being recorded into, if there is one
+		FrameCapture *getCapture() const;
+
 		VkCommandBuffer m_buffer;
 
 		VkViewport m_viewport;
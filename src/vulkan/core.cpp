@@ -10,11 +10,18 @@
 #include "util.h"
 #include "texture.h"
 #include "swapchain.h"
+#include "render_target.h"
+#include "gpu_buffer.h"
+#include "image.h"
+#include "render_stats.h"
+#include "api_stats.h"
 
+#include "rendering/gpu_buffer_mgr.h"
 #include "rendering/render_target_mgr.h"
 #include "rendering/texture_mgr.h"
 #include "rendering/shader_mgr.h"
 #include "rendering/bindless_resource_mgr.h"
+#include "rendering/mip_generator.h"
 
 llt::VulkanCore *llt::g_vkCore = nullptr;
 
@@ -109,19 +116,23 @@ static void debugPopulateDebugUtilsMessengerCreateInfoExt(VkDebugUtilsMessengerC
 
 #endif // LLT_DEBUG
 
-static Vector<const char*> getInstanceExtensions()
+static Vector<const char*> getInstanceExtensions(bool headless)
 {
-	uint32_t extCount = 0;
-	const char *const *names = g_platform->vkGetInstanceExtensions(&extCount);
+	Vector<const char*> extensions;
 
-	if (!names) {
-		LLT_ERROR("Unable to get instance extension count.");
-	}
+	// the platform's extensions are only for creating a surface
+	if (!headless)
+	{
+		uint32_t extCount = 0;
+		const char *const *names = g_platform->vkGetInstanceExtensions(&extCount);
 
-	Vector<const char*> extensions(extCount);
+		if (!names) {
+			LLT_ERROR("Unable to get instance extension count.");
+		}
 
-	for (int i = 0; i < extCount; i++) {
-		extensions[i] = names[i];
+		for (int i = 0; i < extCount; i++) {
+			extensions.pushBack(names[i]);
+		}
 	}
 
 #if LLT_DEBUG
@@ -154,6 +165,9 @@ VulkanCore::VulkanCore(const Config &config)
 	, m_pipelineProcessCache()
 	, m_swapchain()
 	, m_currentFrameIdx()
+	, m_headless(config.hasFlag(Config::FLAG_HEADLESS_BIT))
+	, m_headlessTarget(nullptr)
+	, m_apiStats(config.hasFlag(Config::FLAG_API_STATS_BIT))
 #if LLT_DEBUG
 	, m_debugMessenger()
 #endif // LLT_DEBUG
@@ -202,7 +216,7 @@ VulkanCore::VulkanCore(const Config &config)
 #endif // LLT_DEBUG
 
 	// get our extensions
-	auto extensions = getInstanceExtensions();
+	auto extensions = getInstanceExtensions(m_headless);
 	createInfo.enabledExtensionCount = extensions.size();
 	createInfo.ppEnabledExtensionNames = extensions.data();
 
@@ -233,6 +247,7 @@ VulkanCore::VulkanCore(const Config &config)
 	g_shaderManager       	= new ShaderMgr();
 	g_renderTargetManager 	= new RenderTargetMgr();
 	g_bindlessResources		= new BindlessResourceManager();
+	g_mipGenerator			= new MipGenerator();
 
 	// finished :D
 	LLT_LOG("Vulkan Backend Initialized!");
@@ -245,23 +260,32 @@ VulkanCore::~VulkanCore()
 
 	// ---
 
-	ImGui_ImplVulkan_Shutdown();
-	ImGui_ImplSDL3_Shutdown();
-	ImGui::DestroyContext();
+	// imgui is never set up when running headless
+	if (ImGui::GetCurrentContext())
+	{
+		ImGui_ImplVulkan_Shutdown();
+		ImGui_ImplSDL3_Shutdown();
+		ImGui::DestroyContext();
+	}
 
 	m_descriptorLayoutCache.cleanUp();
 
 	m_imGuiDescriptorPool.cleanUp();
 
-	m_swapchain->cleanUpSwapChain();
+	if (m_swapchain) {
+		m_swapchain->cleanUpSwapChain();
+	}
 
 	delete g_bindlessResources;
 	delete g_renderTargetManager;
 	delete g_shaderManager;
 	delete g_textureManager;
+	delete g_mipGenerator;
 	delete g_gpuBufferManager;
 
-	m_swapchain->cleanUpTextures();
+	if (m_swapchain) {
+		m_swapchain->cleanUpTextures();
+	}
 
 	m_pipelineCache.dispose();
 	vkDestroyPipelineCache(m_device, m_pipelineProcessCache, nullptr);
@@ -304,10 +328,8 @@ VulkanCore::~VulkanCore()
 	LLT_LOG("Vulkan Backend Destroyed!");
 }
 
-void VulkanCore::enumeratePhysicalDevices()
+void VulkanCore::enumeratePhysicalDevices(VkSurfaceKHR surface)
 {
-	VkSurfaceKHR surface = m_swapchain->getSurface();
-
 	// get the total devices we have
 	uint32_t deviceCount = 0;
 	vkEnumeratePhysicalDevices(m_instance, &deviceCount, nullptr);
@@ -369,6 +391,48 @@ void VulkanCore::enumeratePhysicalDevices()
 	LLT_LOG("Selected a suitable GPU: %d", i);
 }
 
+/*
+ * Needs the extension and for it to be able to read the same clock the cpu profiler does.
+ */
+static bool supportsCalibratedTimestamps(VkPhysicalDevice device)
+{
+	uint32_t extensionCount = 0;
+	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+	Vector<VkExtensionProperties> extensions(extensionCount);
+	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, extensions.data());
+
+	bool hasExtension = false;
+
+	for (cauto &extension : extensions)
+	{
+		if (cstr::compare(extension.extensionName, VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME) == 0) {
+			hasExtension = true;
+		}
+	}
+
+	if (!hasExtension) {
+		return false;
+	}
+
+	uint32_t domainCount = 0;
+	vkGetPhysicalDeviceCalibrateableTimeDomainsEXT(device, &domainCount, nullptr);
+
+	Vector<VkTimeDomainEXT> domains(domainCount);
+	vkGetPhysicalDeviceCalibrateableTimeDomainsEXT(device, &domainCount, domains.data());
+
+	bool hasDevice = false;
+	bool hasHost = false;
+
+	for (VkTimeDomainEXT domain : domains)
+	{
+		hasDevice |= domain == VK_TIME_DOMAIN_DEVICE_EXT;
+		hasHost |= domain == vkutil::HOST_TIME_DOMAIN;
+	}
+
+	return hasDevice && hasHost;
+}
+
 void VulkanCore::createLogicalDevice()
 {
 	const float QUEUE_PRIORITY = 1.0f;
@@ -437,16 +501,40 @@ void VulkanCore::createLogicalDevice()
 	synchronisation2FeaturesExt.synchronization2 = VK_TRUE;
 	synchronisation2FeaturesExt.pNext = &bufferDeviceAddressFeaturesExt;
 
+	// core and required since 1.1, lets cubemaps be drawn in a single pass
+	VkPhysicalDeviceMultiviewFeatures multiviewFeaturesExt = {};
+	multiviewFeaturesExt.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES;
+	multiviewFeaturesExt.multiview = VK_TRUE;
+	multiviewFeaturesExt.pNext = &synchronisation2FeaturesExt;
+
+	Vector<const char *> extensions;
+
+	for (int i = 0; i < LLT_ARRAY_LENGTH(vkutil::DEVICE_EXTENSIONS); i++)
+	{
+		// nothing to present to when headless, so no need for the swapchain
+		if (m_headless && cstr::compare(vkutil::DEVICE_EXTENSIONS[i], VK_KHR_SWAPCHAIN_EXTENSION_NAME) == 0) {
+			continue;
+		}
+
+		extensions.pushBack(vkutil::DEVICE_EXTENSIONS[i]);
+	}
+
+	m_physicalData.calibratedTimestamps = supportsCalibratedTimestamps(m_physicalData.device);
+
+	if (m_physicalData.calibratedTimestamps) {
+		extensions.pushBack(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+	}
+
 	VkDeviceCreateInfo createInfo = {};
 	createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
 	createInfo.queueCreateInfoCount = queueCreateInfos.size();
 	createInfo.pQueueCreateInfos = queueCreateInfos.data();
 	createInfo.enabledLayerCount = 0;
 	createInfo.ppEnabledLayerNames = nullptr;
-	createInfo.ppEnabledExtensionNames = vkutil::DEVICE_EXTENSIONS;
-	createInfo.enabledExtensionCount = LLT_ARRAY_LENGTH(vkutil::DEVICE_EXTENSIONS);
+	createInfo.ppEnabledExtensionNames = extensions.data();
+	createInfo.enabledExtensionCount = extensions.size();
 	createInfo.pEnabledFeatures = &m_physicalData.features.features;
-	createInfo.pNext = &synchronisation2FeaturesExt;
+	createInfo.pNext = &multiviewFeaturesExt;
 
 #if LLT_DEBUG
 	// enable the validation layers on the device
@@ -465,6 +553,10 @@ void VulkanCore::createLogicalDevice()
 
 	volkLoadDevice(m_device);
 
+	if (m_apiStats) {
+		apistats::install();
+	}
+
 	// get the device queues for the four core vulkan families
 	VkQueue tmpQueue;
 
@@ -649,12 +741,98 @@ void VulkanCore::createCommandBuffers()
 
 Swapchain *VulkanCore::createSwapchain()
 {
+	LLT_ASSERT(!m_headless, "Can't create a swapchain when running headless.");
+
 	m_swapchain = new Swapchain();
 	m_swapchain->createSurface();
 
-	enumeratePhysicalDevices();
+	createDevice(m_swapchain->getSurface());
+
+	m_swapchain->finalise();
+
+	return m_swapchain;
+}
+
+RenderTarget *VulkanCore::createHeadlessTarget(uint32_t width, uint32_t height)
+{
+	LLT_ASSERT(m_headless, "Headless targets are only for running headless.");
+
+	createDevice(VK_NULL_HANDLE);
+
+	// stands in for the swapchain's format, and readily saved out as a png
+	m_swapChainImageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+
+	// multisampled like the swapchain so the same pipelines work for both
+	m_headlessTarget = g_renderTargetManager->createTarget(
+		"headless",
+		width, height,
+		{ m_swapChainImageFormat },
+		m_maxMsaaSamples,
+		1
+	);
+
+	m_headlessTarget->createDepthAttachment();
+	m_headlessTarget->toggleClear(true);
+
+	LLT_LOG("Created headless target! (%ux%u)", width, height);
+
+	return m_headlessTarget;
+}
+
+GenericRenderTarget *VulkanCore::getBackbuffer() const
+{
+	if (m_headless) {
+		return m_headlessTarget;
+	}
+
+	return m_swapchain;
+}
+
+bool VulkanCore::isHeadless() const
+{
+	return m_headless;
+}
+
+bool VulkanCore::saveHeadlessTarget(const char *path)
+{
+	LLT_ASSERT(m_headlessTarget, "No headless target to read back.");
+
+	vkDeviceWaitIdle(m_device);
+
+	Texture *colour = m_headlessTarget->getAttachment(0);
+
+	uint64_t size = (uint64_t)colour->getWidth() * colour->getHeight() * 4;
 
-	findQueueFamilies(m_physicalData.device, m_swapchain->getSurface());
+	GPUBuffer *readbackBuffer = g_gpuBufferManager->createReadbackBuffer(size);
+
+	VkImageLayout layout = colour->getImageLayout();
+	colour->transitionLayoutSingle(VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+
+	CommandBuffer cmd = vkutil::beginSingleTimeCommands(getGraphicsCommandPool());
+	readbackBuffer->readFromTexture(cmd, colour, 0, 0, 0);
+	vkutil::endSingleTimeGraphicsCommands(cmd);
+
+	colour->transitionLayoutSingle(layout);
+
+	Image image(colour->getWidth(), colour->getHeight(), Image::FORMAT_RGBA8);
+	readbackBuffer->readDataFromMe(image.getData(), size, 0);
+
+	delete readbackBuffer;
+
+	if (!image.saveToPng(path)) {
+		return false;
+	}
+
+	LLT_LOG("Saved headless frame: %s", path);
+
+	return true;
+}
+
+void VulkanCore::createDevice(VkSurfaceKHR surface)
+{
+	enumeratePhysicalDevices(surface);
+
+	findQueueFamilies(m_physicalData.device, surface);
 
 	createLogicalDevice();
 	createPipelineProcessCache();
@@ -695,10 +873,6 @@ Swapchain *VulkanCore::createSwapchain()
 //	createComputeResources();
 
 	g_bindlessResources->init();
-
-	m_swapchain->finalise();
-
-	return m_swapchain;
 }
 
 VkSampleCountFlagBits VulkanCore::getMaxUsableSampleCount() const
@@ -745,8 +919,12 @@ void VulkanCore::findQueueFamilies(VkPhysicalDevice physicalDevice, VkSurfaceKHR
 	{
 		if ((queueFamilies[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) && numQueuesFound[i] == 0)
 		{
-			VkBool32 presentSupport = VK_FALSE;
-			vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &presentSupport);
+			// anything that can do graphics will do when there's nothing to present to
+			VkBool32 presentSupport = VK_TRUE;
+
+			if (surface != VK_NULL_HANDLE) {
+				vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &presentSupport);
+			}
 
 			if (presentSupport)
 			{
@@ -776,7 +954,9 @@ void VulkanCore::findQueueFamilies(VkPhysicalDevice physicalDevice, VkSurfaceKHR
 
 void VulkanCore::onWindowResize(int width, int height)
 {
-	m_swapchain->onWindowResize(width, height);
+	if (m_swapchain) {
+		m_swapchain->onWindowResize(width, height);
+	}
 }
 
 int VulkanCore::getCurrentFrameIdx() const
@@ -829,18 +1009,25 @@ void VulkanCore::swapBuffers()
 	vkWaitForFences(g_vkCore->m_device, 1, &currentFrame.inFlightFence, VK_TRUE, UINT64_MAX);
 	vkResetCommandPool(g_vkCore->m_device, currentFrame.commandPool, 0);
 
-	m_swapchain->swapBuffers();
+	g_renderStats.fenceWaits++;
+
+	// headless frames just stay in the target, there's nothing to present them to
+	if (m_swapchain) {
+		m_swapchain->swapBuffers();
+	}
 
 	m_currentFrameIdx = (m_currentFrameIdx + 1) % mgc::FRAMES_IN_FLIGHT;
 
 //	g_shaderBufferManager->resetBufferUsageInFrame();
 
-	m_swapchain->acquireNextImage();
+	if (m_swapchain) {
+		m_swapchain->acquireNextImage();
+	}
 }
 
 void VulkanCore::syncStall() const
 {
-	while (g_platform->getWindowSize() == glm::ivec2(0, 0)) {}
+	while (g_platform->hasWindow() && g_platform->getWindowSize() == glm::ivec2(0, 0)) {}
 	vkDeviceWaitIdle(m_device);
 }
 
@@ -16,11 +16,16 @@
 
 namespace llt
 {
+	class RenderTarget;
+
 	struct PhysicalDeviceData
 	{
 		VkPhysicalDevice device;
 		VkPhysicalDeviceProperties2 properties;
 		VkPhysicalDeviceFeatures2 features;
+
+		// VK_EXT_calibrated_timestamps is optional, it's only there to line gpu timestamps up with the cpu clock
+		bool calibratedTimestamps;
 	};
 
 	class VulkanCore
@@ -31,6 +36,23 @@ namespace llt
 
 		Swapchain *createSwapchain();
 
+		/*
+		 * Used instead of a swapchain when running headless. Frames are rendered into the target and
+		 * nothing is presented, they just stay there until they're read back.
+		 */
+		RenderTarget *createHeadlessTarget(uint32_t width, uint32_t height);
+
+		/*
+		 * Where the frame ends up, the swapchain or the headless target.
+		 */
+		GenericRenderTarget *getBackbuffer() const;
+		bool isHeadless() const;
+
+		/*
+		 * Reads back the last frame rendered into the headless target and saves it as a png, stalling until it's finished.
+		 */
+		bool saveHeadlessTarget(const char *path);
+
 		void swapBuffers();
 
 		void onWindowResize(int width, int height);
@@ -66,7 +88,9 @@ namespace llt
 		ImGui_ImplVulkan_InitInfo getImGuiInitInfo() const;
 
 	private:
-		void enumeratePhysicalDevices();
+		void createDevice(VkSurfaceKHR surface);
+
+		void enumeratePhysicalDevices(VkSurfaceKHR surface);
 		
 		void createLogicalDevice();
 		void createCommandPools();
@@ -83,6 +107,11 @@ namespace llt
 		uint64_t m_currentFrameIdx;
 		VkPipelineCache m_pipelineProcessCache;
 
+		bool m_headless;
+		RenderTarget *m_headlessTarget;
+
+		bool m_apiStats;
+
 #if LLT_DEBUG
 		VkDebugUtilsMessengerEXT m_debugMessenger;
 #endif // LLT_DEBUG
@@ -0,0 +1,602 @@
+#include "frame_capture.h"
+
+#include <fstream>
+
+#include "io/mmap_stream.h"
+
+#include "core.h"
+#include "command_buffer.h"
+#include "render_info.h"
+
+llt::FrameCapture *llt::g_frameCapture = nullptr;
+
+using namespace llt;
+
+/*
+ * Walks a capture's stream front to back, the reads have to line up with the writes exactly.
+ */
+class StreamReader
+{
+public:
+	StreamReader(const byte *data, uint64_t size)
+		: m_cursor(data)
+		, m_end(data + size)
+	{
+	}
+
+	bool atEnd() const
+	{
+		return m_cursor >= m_end;
+	}
+
+	template <typename T>
+	T read()
+	{
+		LLT_ASSERT(m_cursor + sizeof(T) <= m_end, "Read past the end of a frame capture.");
+
+		T value;
+		mem::copy(&value, m_cursor, sizeof(T));
+		m_cursor += sizeof(T);
+
+		return value;
+	}
+
+	template <typename T>
+	void readArray(Vector<T> &array)
+	{
+		uint32_t count = read<uint32_t>();
+
+		LLT_ASSERT(m_cursor + sizeof(T) * count <= m_end, "Read past the end of a frame capture.");
+
+		array.clear();
+		array.resize(count);
+
+		mem::copy(array.data(), m_cursor, sizeof(T) * count);
+		m_cursor += sizeof(T) * count;
+	}
+
+private:
+	const byte *m_cursor;
+	const byte *m_end;
+};
+
+// the structs are stored as they were, any chained structs wouldn't be valid anymore
+template <typename T>
+static void clearNext(Vector<T> &array)
+{
+	for (auto &item : array) {
+		item.pNext = nullptr;
+	}
+}
+
+FrameCapture::FrameCapture()
+	: m_buffer(VK_NULL_HANDLE)
+	, m_capturing(false)
+	, m_commandCount(0)
+	, m_stream()
+{
+}
+
+FrameCapture::~FrameCapture()
+{
+}
+
+void FrameCapture::begin()
+{
+	m_buffer = g_vkCore->m_graphicsQueue.getCurrentFrame().commandBuffer;
+	m_capturing = true;
+
+	m_commandCount = 0;
+	m_stream.clear();
+}
+
+void FrameCapture::end()
+{
+	m_capturing = false;
+	m_buffer = VK_NULL_HANDLE;
+}
+
+bool FrameCapture::isCapturing(VkCommandBuffer buffer) const
+{
+	return m_capturing && buffer == m_buffer;
+}
+
+bool FrameCapture::save(const char *path) const
+{
+	FileHeader header = {};
+	header.magic = MAGIC;
+	header.version = VERSION;
+	header.commandCount = m_commandCount;
+	header.streamSize = m_stream.size();
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+	if (!file.is_open())
+	{
+		LLT_LOG("Failed to open frame capture for writing: %s", path);
+		return false;
+	}
+
+	file.write((const char *)&header, sizeof(header));
+	file.write((const char *)m_stream.data(), m_stream.size());
+
+	return file.good();
+}
+
+bool FrameCapture::load(const char *path)
+{
+	MmapStream file(path, MAPPED_FILE_ACCESS_WILLNEED);
+
+	if (!file.isOpen())
+	{
+		LLT_LOG("Failed to open frame capture: %s", path);
+		return false;
+	}
+
+	FileHeader header = {};
+
+	if (file.size() >= (int64_t)sizeof(FileHeader)) {
+		file.read(&header, sizeof(FileHeader));
+	}
+
+	if (header.magic != MAGIC || header.version != VERSION)
+	{
+		LLT_LOG("Not a frame capture, or one from a different version: %s", path);
+		return false;
+	}
+
+	// straight out of the mapping, no stream buffer in between
+	std::span<const byte> commands = file.consume(header.streamSize);
+
+	if (commands.size() != header.streamSize)
+	{
+		LLT_LOG("Frame capture is truncated: %s", path);
+		return false;
+	}
+
+	m_stream.clear();
+	m_stream.resize(header.streamSize);
+
+	mem::copy(m_stream.data(), commands.data(), commands.size());
+
+	m_commandCount = header.commandCount;
+
+	return true;
+}
+
+void FrameCapture::replay(CommandBuffer &cmd) const
+{
+	StreamReader reader(m_stream.data(), m_stream.size());
+
+	// kept across commands so replaying doesn't allocate once they've grown
+	RenderInfo renderInfo;
+	Vector<VkDescriptorSet> descriptorSets;
+	Vector<uint32_t> dynamicOffsets;
+	Vector<byte> pushConstants;
+	Vector<VkBuffer> buffers;
+	Vector<VkDeviceSize> offsets;
+	Vector<VkMemoryBarrier2> memoryBarriers;
+	Vector<VkBufferMemoryBarrier2> bufferMemoryBarriers;
+	Vector<VkImageMemoryBarrier2> imageMemoryBarriers;
+	Vector<VkImageBlit> blits;
+	Vector<VkBufferCopy> bufferCopies;
+	Vector<VkBufferImageCopy> imageCopies;
+
+	while (!reader.atEnd())
+	{
+		CaptureCommand command = (CaptureCommand)reader.read<uint8_t>();
+
+		switch (command)
+		{
+			case CAPTURE_COMMAND_BEGIN_RENDERING:
+			{
+				renderInfo.m_width = reader.read<uint32_t>();
+				renderInfo.m_height = reader.read<uint32_t>();
+				renderInfo.m_samples = reader.read<VkSampleCountFlagBits>();
+				renderInfo.m_viewMask = reader.read<uint32_t>();
+				renderInfo.m_attachmentCount = reader.read<int>();
+				renderInfo.m_depthAttachment = reader.read<VkRenderingAttachmentInfoKHR>();
+				renderInfo.m_depthAttachment.pNext = nullptr;
+
+				reader.readArray(renderInfo.m_colourAttachments);
+				reader.readArray(renderInfo.m_colourFormats);
+				clearNext(renderInfo.m_colourAttachments);
+
+				cmd.beginRendering(renderInfo);
+				break;
+			}
+
+			case CAPTURE_COMMAND_END_RENDERING:
+			{
+				cmd.endRendering();
+				break;
+			}
+
+			case CAPTURE_COMMAND_BIND_PIPELINE:
+			{
+				VkPipelineBindPoint bindPoint = reader.read<VkPipelineBindPoint>();
+				VkPipeline pipeline = reader.read<VkPipeline>();
+
+				cmd.bindPipeline(bindPoint, pipeline);
+				break;
+			}
+
+			case CAPTURE_COMMAND_BIND_DESCRIPTOR_SETS:
+			{
+				uint32_t firstSet = reader.read<uint32_t>();
+				VkPipelineLayout layout = reader.read<VkPipelineLayout>();
+
+				reader.readArray(descriptorSets);
+				reader.readArray(dynamicOffsets);
+
+				cmd.bindDescriptorSets(firstSet, layout, descriptorSets, dynamicOffsets);
+				break;
+			}
+
+			case CAPTURE_COMMAND_PUSH_CONSTANTS:
+			{
+				VkPipelineLayout layout = reader.read<VkPipelineLayout>();
+				VkShaderStageFlagBits stageFlags = reader.read<VkShaderStageFlagBits>();
+				uint32_t offset = reader.read<uint32_t>();
+
+				reader.readArray(pushConstants);
+
+				cmd.pushConstants(layout, stageFlags, pushConstants.size(), pushConstants.data(), offset);
+				break;
+			}
+
+			case CAPTURE_COMMAND_BIND_VERTEX_BUFFERS:
+			{
+				uint32_t firstBinding = reader.read<uint32_t>();
+
+				reader.readArray(buffers);
+				reader.readArray(offsets);
+
+				cmd.bindVertexBuffers(firstBinding, buffers.size(), buffers.data(), offsets.data());
+				break;
+			}
+
+			case CAPTURE_COMMAND_BIND_INDEX_BUFFER:
+			{
+				VkBuffer buffer = reader.read<VkBuffer>();
+				VkDeviceSize offset = reader.read<VkDeviceSize>();
+				VkIndexType indexType = reader.read<VkIndexType>();
+
+				cmd.bindIndexBuffer(buffer, offset, indexType);
+				break;
+			}
+
+			case CAPTURE_COMMAND_SET_VIEWPORT:
+			{
+				cmd.setViewport(reader.read<VkViewport>());
+				break;
+			}
+
+			case CAPTURE_COMMAND_SET_SCISSOR:
+			{
+				cmd.setScissor(reader.read<VkRect2D>());
+				break;
+			}
+
+			case CAPTURE_COMMAND_DRAW_INDEXED:
+			{
+				uint32_t indexCount = reader.read<uint32_t>();
+				uint32_t instanceCount = reader.read<uint32_t>();
+				uint32_t firstIndex = reader.read<uint32_t>();
+				int32_t vertexOffset = reader.read<int32_t>();
+				uint32_t firstInstance = reader.read<uint32_t>();
+
+				cmd.drawIndexed(indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+				break;
+			}
+
+			case CAPTURE_COMMAND_DRAW_INDEXED_INDIRECT:
+			{
+				VkBuffer buffer = reader.read<VkBuffer>();
+				VkDeviceSize offset = reader.read<VkDeviceSize>();
+				uint32_t drawCount = reader.read<uint32_t>();
+				uint32_t stride = reader.read<uint32_t>();
+
+				cmd.drawIndexedIndirect(buffer, offset, drawCount, stride);
+				break;
+			}
+
+			case CAPTURE_COMMAND_DRAW_INDEXED_INDIRECT_COUNT:
+			{
+				VkBuffer buffer = reader.read<VkBuffer>();
+				VkDeviceSize offset = reader.read<VkDeviceSize>();
+				VkBuffer countBuffer = reader.read<VkBuffer>();
+				VkDeviceSize countBufferOffset = reader.read<VkDeviceSize>();
+				uint32_t maxDrawCount = reader.read<uint32_t>();
+				uint32_t stride = reader.read<uint32_t>();
+
+				cmd.drawIndexedIndirectCount(buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride);
+				break;
+			}
+
+			case CAPTURE_COMMAND_DISPATCH:
+			{
+				uint32_t gcX = reader.read<uint32_t>();
+				uint32_t gcY = reader.read<uint32_t>();
+				uint32_t gcZ = reader.read<uint32_t>();
+
+				cmd.dispatch(gcX, gcY, gcZ);
+				break;
+			}
+
+			case CAPTURE_COMMAND_PIPELINE_BARRIER:
+			{
+				VkDependencyFlags dependencyFlags = reader.read<VkDependencyFlags>();
+
+				reader.readArray(memoryBarriers);
+				reader.readArray(bufferMemoryBarriers);
+				reader.readArray(imageMemoryBarriers);
+
+				clearNext(memoryBarriers);
+				clearNext(bufferMemoryBarriers);
+				clearNext(imageMemoryBarriers);
+
+				cmd.pipelineBarrier(dependencyFlags, memoryBarriers, bufferMemoryBarriers, imageMemoryBarriers);
+				break;
+			}
+
+			case CAPTURE_COMMAND_BLIT_IMAGE:
+			{
+				VkImage srcImage = reader.read<VkImage>();
+				VkImageLayout srcImageLayout = reader.read<VkImageLayout>();
+				VkImage dstImage = reader.read<VkImage>();
+				VkImageLayout dstImageLayout = reader.read<VkImageLayout>();
+				VkFilter filter = reader.read<VkFilter>();
+
+				reader.readArray(blits);
+
+				cmd.blitImage(srcImage, srcImageLayout, dstImage, dstImageLayout, blits, filter);
+				break;
+			}
+
+			case CAPTURE_COMMAND_COPY_BUFFER_TO_BUFFER:
+			{
+				VkBuffer srcBuffer = reader.read<VkBuffer>();
+				VkBuffer dstBuffer = reader.read<VkBuffer>();
+
+				reader.readArray(bufferCopies);
+
+				cmd.copyBufferToBuffer(srcBuffer, dstBuffer, bufferCopies);
+				break;
+			}
+
+			case CAPTURE_COMMAND_COPY_BUFFER_TO_IMAGE:
+			{
+				VkBuffer srcBuffer = reader.read<VkBuffer>();
+				VkImage dstImage = reader.read<VkImage>();
+				VkImageLayout dstImageLayout = reader.read<VkImageLayout>();
+
+				reader.readArray(imageCopies);
+
+				cmd.copyBufferToImage(srcBuffer, dstImage, dstImageLayout, imageCopies);
+				break;
+			}
+
+			case CAPTURE_COMMAND_COPY_IMAGE_TO_BUFFER:
+			{
+				VkImage srcImage = reader.read<VkImage>();
+				VkImageLayout srcImageLayout = reader.read<VkImageLayout>();
+				VkBuffer dstBuffer = reader.read<VkBuffer>();
+
+				reader.readArray(imageCopies);
+
+				cmd.copyImageToBuffer(srcImage, srcImageLayout, dstBuffer, imageCopies);
+				break;
+			}
+
+			default:
+			{
+				LLT_ERROR("Unknown command in frame capture: %d", (int)command);
+				return;
+			}
+		}
+	}
+}
+
+uint64_t FrameCapture::getCommandCount() const
+{
+	return m_commandCount;
+}
+
+uint64_t FrameCapture::getSize() const
+{
+	return sizeof(FileHeader) + m_stream.size();
+}
+
+void FrameCapture::writeCommand(CaptureCommand command)
+{
+	write((uint8_t)command);
+	m_commandCount++;
+}
+
+void FrameCapture::writeBytes(const void *data, uint64_t size)
+{
+	uint64_t offset = m_stream.size();
+
+	m_stream.resize(offset + size);
+	mem::copy(m_stream.data() + offset, data, size);
+}
+
+void FrameCapture::recordBeginRendering(const RenderInfo &info)
+{
+	writeCommand(CAPTURE_COMMAND_BEGIN_RENDERING);
+
+	write(info.m_width);
+	write(info.m_height);
+	write(info.m_samples);
+	write(info.m_viewMask);
+	write(info.m_attachmentCount);
+	write(info.m_depthAttachment);
+
+	writeArray(info.m_colourAttachments.data(), info.m_colourAttachments.size());
+	writeArray(info.m_colourFormats.data(), info.m_colourFormats.size());
+}
+
+void FrameCapture::recordEndRendering()
+{
+	writeCommand(CAPTURE_COMMAND_END_RENDERING);
+}
+
+void FrameCapture::recordBindPipeline(VkPipelineBindPoint bindPoint, VkPipeline pipeline)
+{
+	writeCommand(CAPTURE_COMMAND_BIND_PIPELINE);
+
+	write(bindPoint);
+	write(pipeline);
+}
+
+void FrameCapture::recordBindDescriptorSets(uint32_t firstSet, VkPipelineLayout layout, const Vector<VkDescriptorSet> &descriptorSets, const Vector<uint32_t> &dynamicOffsets)
+{
+	writeCommand(CAPTURE_COMMAND_BIND_DESCRIPTOR_SETS);
+
+	write(firstSet);
+	write(layout);
+
+	writeArray(descriptorSets.data(), descriptorSets.size());
+	writeArray(dynamicOffsets.data(), dynamicOffsets.size());
+}
+
+void FrameCapture::recordPushConstants(VkPipelineLayout layout, VkShaderStageFlagBits stageFlags, uint32_t size, const void *data, uint32_t offset)
+{
+	writeCommand(CAPTURE_COMMAND_PUSH_CONSTANTS);
+
+	write(layout);
+	write(stageFlags);
+	write(offset);
+
+	writeArray((const byte *)data, size);
+}
+
+void FrameCapture::recordBindVertexBuffers(uint32_t firstBinding, uint32_t count, const VkBuffer *buffers, const VkDeviceSize *offsets)
+{
+	writeCommand(CAPTURE_COMMAND_BIND_VERTEX_BUFFERS);
+
+	write(firstBinding);
+
+	writeArray(buffers, count);
+	writeArray(offsets, count);
+}
+
+void FrameCapture::recordBindIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType)
+{
+	writeCommand(CAPTURE_COMMAND_BIND_INDEX_BUFFER);
+
+	write(buffer);
+	write(offset);
+	write(indexType);
+}
+
+void FrameCapture::recordSetViewport(const VkViewport &viewport)
+{
+	writeCommand(CAPTURE_COMMAND_SET_VIEWPORT);
+	write(viewport);
+}
+
+void FrameCapture::recordSetScissor(const VkRect2D &scissor)
+{
+	writeCommand(CAPTURE_COMMAND_SET_SCISSOR);
+	write(scissor);
+}
+
+void FrameCapture::recordDrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance)
+{
+	writeCommand(CAPTURE_COMMAND_DRAW_INDEXED);
+
+	write(indexCount);
+	write(instanceCount);
+	write(firstIndex);
+	write(vertexOffset);
+	write(firstInstance);
+}
+
+void FrameCapture::recordDrawIndexedIndirect(VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride)
+{
+	writeCommand(CAPTURE_COMMAND_DRAW_INDEXED_INDIRECT);
+
+	write(buffer);
+	write(offset);
+	write(drawCount);
+	write(stride);
+}
+
+void FrameCapture::recordDrawIndexedIndirectCount(VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer, VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride)
+{
+	writeCommand(CAPTURE_COMMAND_DRAW_INDEXED_INDIRECT_COUNT);
+
+	write(buffer);
+	write(offset);
+	write(countBuffer);
+	write(countBufferOffset);
+	write(maxDrawCount);
+	write(stride);
+}
+
+void FrameCapture::recordDispatch(uint32_t gcX, uint32_t gcY, uint32_t gcZ)
+{
+	writeCommand(CAPTURE_COMMAND_DISPATCH);
+
+	write(gcX);
+	write(gcY);
+	write(gcZ);
+}
+
+void FrameCapture::recordPipelineBarrier(VkDependencyFlags dependencyFlags, const Vector<VkMemoryBarrier2> &memoryBarriers, const Vector<VkBufferMemoryBarrier2> &bufferMemoryBarriers, const Vector<VkImageMemoryBarrier2> &imageMemoryBarriers)
+{
+	writeCommand(CAPTURE_COMMAND_PIPELINE_BARRIER);
+
+	write(dependencyFlags);
+
+	writeArray(memoryBarriers.data(), memoryBarriers.size());
+	writeArray(bufferMemoryBarriers.data(), bufferMemoryBarriers.size());
+	writeArray(imageMemoryBarriers.data(), imageMemoryBarriers.size());
+}
+
+void FrameCapture::recordBlitImage(VkImage srcImage, VkImageLayout srcImageLayout, VkImage dstImage, VkImageLayout dstImageLayout, const Vector<VkImageBlit> &regions, VkFilter filter)
+{
+	writeCommand(CAPTURE_COMMAND_BLIT_IMAGE);
+
+	write(srcImage);
+	write(srcImageLayout);
+	write(dstImage);
+	write(dstImageLayout);
+	write(filter);
+
+	writeArray(regions.data(), regions.size());
+}
+
+void FrameCapture::recordCopyBufferToBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, const Vector<VkBufferCopy> &regions)
+{
+	writeCommand(CAPTURE_COMMAND_COPY_BUFFER_TO_BUFFER);
+
+	write(srcBuffer);
+	write(dstBuffer);
+
+	writeArray(regions.data(), regions.size());
+}
+
+void FrameCapture::recordCopyBufferToImage(VkBuffer srcBuffer, VkImage dstImage, VkImageLayout dstImageLayout, const Vector<VkBufferImageCopy> &regions)
+{
+	writeCommand(CAPTURE_COMMAND_COPY_BUFFER_TO_IMAGE);
+
+	write(srcBuffer);
+	write(dstImage);
+	write(dstImageLayout);
+
+	writeArray(regions.data(), regions.size());
+}
+
+void FrameCapture::recordCopyImageToBuffer(VkImage srcImage, VkImageLayout srcImageLayout, VkBuffer dstBuffer, const Vector<VkBufferImageCopy> &regions)
+{
+	writeCommand(CAPTURE_COMMAND_COPY_IMAGE_TO_BUFFER);
+
+	write(srcImage);
+	write(srcImageLayout);
+	write(dstBuffer);
+
+	writeArray(regions.data(), regions.size());
+}
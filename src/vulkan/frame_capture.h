@@ -0,0 +1,131 @@
+#ifndef FRAME_CAPTURE_H_
+#define FRAME_CAPTURE_H_
+
+#include "third_party/volk.h"
+
+#include "core/common.h"
+
+#include "container/vector.h"
+
+namespace llt
+{
+	class CommandBuffer;
+	class RenderInfo;
+
+	enum CaptureCommand
+	{
+		CAPTURE_COMMAND_BEGIN_RENDERING,
+		CAPTURE_COMMAND_END_RENDERING,
+		CAPTURE_COMMAND_BIND_PIPELINE,
+		CAPTURE_COMMAND_BIND_DESCRIPTOR_SETS,
+		CAPTURE_COMMAND_PUSH_CONSTANTS,
+		CAPTURE_COMMAND_BIND_VERTEX_BUFFERS,
+		CAPTURE_COMMAND_BIND_INDEX_BUFFER,
+		CAPTURE_COMMAND_SET_VIEWPORT,
+		CAPTURE_COMMAND_SET_SCISSOR,
+		CAPTURE_COMMAND_DRAW_INDEXED,
+		CAPTURE_COMMAND_DRAW_INDEXED_INDIRECT,
+		CAPTURE_COMMAND_DRAW_INDEXED_INDIRECT_COUNT,
+		CAPTURE_COMMAND_DISPATCH,
+		CAPTURE_COMMAND_PIPELINE_BARRIER,
+		CAPTURE_COMMAND_BLIT_IMAGE,
+		CAPTURE_COMMAND_COPY_BUFFER_TO_BUFFER,
+		CAPTURE_COMMAND_COPY_BUFFER_TO_IMAGE,
+		CAPTURE_COMMAND_COPY_IMAGE_TO_BUFFER,
+		CAPTURE_COMMAND_MAX_ENUM
+	};
+
+	/**
+	 * Everything one frame recorded through CommandBuffer on the graphics queue, as a flat stream of commands
+	 * that can be written out and re-issued through a CommandBuffer again later.
+	 *
+	 * Commands are captured at the level CommandBuffer sees them: render infos, pipeline, descriptor set and
+	 * buffer handles, push constant blobs and draw parameters. Handles are kept as they are, so a capture
+	 * can only be replayed in the run that made it, while the resources it names are still alive.
+	 * Queries aren't captured (they belong to the profiler), and neither is anything that goes around
+	 * CommandBuffer straight to vulkan, like imgui.
+	 */
+	class FrameCapture
+	{
+	public:
+		static constexpr uint32_t MAGIC = 0x43464C4C; // "LLFC"
+		static constexpr uint32_t VERSION = 1;
+
+		FrameCapture();
+		~FrameCapture();
+
+		/*
+		 * Starts capturing what's recorded into the current frame's graphics command buffer.
+		 */
+		void begin();
+		void end();
+
+		bool isCapturing(VkCommandBuffer buffer) const;
+
+		bool save(const char *path) const;
+		bool load(const char *path);
+
+		/*
+		 * Re-issues every command into cmd, which has to be recording and outside of any rendering.
+		 */
+		void replay(CommandBuffer &cmd) const;
+
+		uint64_t getCommandCount() const;
+		uint64_t getSize() const;
+
+		void recordBeginRendering(const RenderInfo &info);
+		void recordEndRendering();
+		void recordBindPipeline(VkPipelineBindPoint bindPoint, VkPipeline pipeline);
+		void recordBindDescriptorSets(uint32_t firstSet, VkPipelineLayout layout, const Vector<VkDescriptorSet> &descriptorSets, const Vector<uint32_t> &dynamicOffsets);
+		void recordPushConstants(VkPipelineLayout layout, VkShaderStageFlagBits stageFlags, uint32_t size, const void *data, uint32_t offset);
+		void recordBindVertexBuffers(uint32_t firstBinding, uint32_t count, const VkBuffer *buffers, const VkDeviceSize *offsets);
+		void recordBindIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType);
+		void recordSetViewport(const VkViewport &viewport);
+		void recordSetScissor(const VkRect2D &scissor);
+		void recordDrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance);
+		void recordDrawIndexedIndirect(VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride);
+		void recordDrawIndexedIndirectCount(VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer, VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride);
+		void recordDispatch(uint32_t gcX, uint32_t gcY, uint32_t gcZ);
+		void recordPipelineBarrier(VkDependencyFlags dependencyFlags, const Vector<VkMemoryBarrier2> &memoryBarriers, const Vector<VkBufferMemoryBarrier2> &bufferMemoryBarriers, const Vector<VkImageMemoryBarrier2> &imageMemoryBarriers);
+		void recordBlitImage(VkImage srcImage, VkImageLayout srcImageLayout, VkImage dstImage, VkImageLayout dstImageLayout, const Vector<VkImageBlit> &regions, VkFilter filter);
+		void recordCopyBufferToBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, const Vector<VkBufferCopy> &regions);
+		void recordCopyBufferToImage(VkBuffer srcBuffer, VkImage dstImage, VkImageLayout dstImageLayout, const Vector<VkBufferImageCopy> &regions);
+		void recordCopyImageToBuffer(VkImage srcImage, VkImageLayout srcImageLayout, VkBuffer dstBuffer, const Vector<VkBufferImageCopy> &regions);
+
+	private:
+		struct FileHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint64_t commandCount;
+			uint64_t streamSize;
+		};
+
+		void writeCommand(CaptureCommand command);
+		void writeBytes(const void *data, uint64_t size);
+
+		template <typename T>
+		void write(const T &value)
+		{
+			writeBytes(&value, sizeof(T));
+		}
+
+		template <typename T>
+		void writeArray(const T *data, uint32_t count)
+		{
+			write(count);
+			writeBytes(data, sizeof(T) * count);
+		}
+
+		VkCommandBuffer m_buffer;
+		bool m_capturing;
+
+		uint64_t m_commandCount;
+		Vector<byte, MEM_TAG_RENDERING> m_stream;
+	};
+
+	// only set while a frame is being captured
+	extern FrameCapture *g_frameCapture;
+}
+
+#endif // FRAME_CAPTURE_H_
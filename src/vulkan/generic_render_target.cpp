@@ -1,6 +1,7 @@
 #include "generic_render_target.h"
 
 #include "math/colour.h"
+#include "math/calc.h"
 
 using namespace llt;
 
@@ -76,3 +77,21 @@ RenderTargetType GenericRenderTarget::getType() const
 {
 	return m_type;
 }
+
+void GenericRenderTarget::setRenderArea(uint32_t width, uint32_t height)
+{
+	m_renderInfo.setSize(
+		CalcU::min(width, m_width),
+		CalcU::min(height, m_height)
+	);
+}
+
+uint32_t GenericRenderTarget::getRenderAreaWidth() const
+{
+	return m_renderInfo.getWidth();
+}
+
+uint32_t GenericRenderTarget::getRenderAreaHeight() const
+{
+	return m_renderInfo.getHeight();
+}
@@ -56,6 +56,14 @@ namespace llt
 		uint32_t getHeight() const;
 		RenderTargetType getType() const;
 
+		/*
+		 * Renders into just the top left width x height of the attachments, which stay the size they are.
+		 * The viewport and scissor follow it. Clamped to the full size, which is what it starts as.
+		 */
+		void setRenderArea(uint32_t width, uint32_t height);
+		uint32_t getRenderAreaWidth() const;
+		uint32_t getRenderAreaHeight() const;
+
 	protected:
 		uint32_t m_width;
 		uint32_t m_height;
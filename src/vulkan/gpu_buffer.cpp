@@ -5,6 +5,9 @@
 #include "texture.h"
 #include "core.h"
 #include "util.h"
+#include "render_stats.h"
+
+#include "math/calc.h"
 
 using namespace llt;
 
@@ -70,6 +73,8 @@ void GPUBuffer::readDataFromMe(void *dst, uint64_t length, uint64_t offset) cons
 void GPUBuffer::writeDataToMe(const void *src, uint64_t length, uint64_t offset) const
 {
 	vmaCopyMemoryToAllocation(g_vkCore->m_vmaAllocator, src, m_allocation, offset, length);
+
+	g_renderStats.uploadBytes += length;
 }
 
 void GPUBuffer::writeToBuffer(const GPUBuffer *other, uint64_t length, uint64_t srcOffset, uint64_t dstOffset)
@@ -96,18 +101,18 @@ void GPUBuffer::writeToTextureSingle(const Texture *texture, uint64_t size, uint
 	vkutil::endSingleTimeTransferCommands(commandBuffer);
 }
 
-void GPUBuffer::writeToTexture(CommandBuffer &commandBuffer, const Texture *texture, uint64_t size, uint64_t offset, uint32_t baseArrayLayer)
+void GPUBuffer::writeToTexture(CommandBuffer &commandBuffer, const Texture *texture, uint64_t size, uint64_t offset, uint32_t baseArrayLayer, uint32_t mipLevel)
 {
 	VkBufferImageCopy region = {};
 	region.bufferOffset = offset;
 	region.bufferRowLength = 0;
 	region.bufferImageHeight = 0;
 	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	region.imageSubresource.mipLevel = 0;
+	region.imageSubresource.mipLevel = mipLevel;
 	region.imageSubresource.baseArrayLayer = baseArrayLayer;
 	region.imageSubresource.layerCount = 1;
 	region.imageOffset = { 0, 0, 0 };
-	region.imageExtent = { texture->getWidth(), texture->getHeight(), 1 };
+	region.imageExtent = { CalcU::max(texture->getWidth() >> mipLevel, 1), CalcU::max(texture->getHeight() >> mipLevel, 1), 1 };
 
 	commandBuffer.copyBufferToImage(
 		m_buffer, texture->getImage(),
@@ -116,6 +121,27 @@ void GPUBuffer::writeToTexture(CommandBuffer &commandBuffer, const Texture *text
 	);
 }
 
+void GPUBuffer::readFromTexture(CommandBuffer &commandBuffer, const Texture *texture, uint64_t offset, uint32_t baseArrayLayer, uint32_t mipLevel)
+{
+	VkBufferImageCopy region = {};
+	region.bufferOffset = offset;
+	region.bufferRowLength = 0;
+	region.bufferImageHeight = 0;
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.mipLevel = mipLevel;
+	region.imageSubresource.baseArrayLayer = baseArrayLayer;
+	region.imageSubresource.layerCount = 1;
+	region.imageOffset = { 0, 0, 0 };
+	region.imageExtent = { CalcU::max(texture->getWidth() >> mipLevel, 1), CalcU::max(texture->getHeight() >> mipLevel, 1), 1 };
+
+	commandBuffer.copyImageToBuffer(
+		texture->getImage(),
+		VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		m_buffer,
+		{ region }
+	);
+}
+
 VkDescriptorBufferInfo GPUBuffer::getDescriptorInfo(uint32_t offset) const
 {
 	return {
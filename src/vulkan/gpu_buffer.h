@@ -7,13 +7,14 @@
 #include "third_party/vk_mem_alloc.h"
 
 #include "core/common.h"
+#include "core/mem_tracker.h"
 
 namespace llt
 {
 	class Texture;
 	class VulkanCore;
 
-	class GPUBuffer
+	class GPUBuffer : public MemTagged<MEM_TAG_RENDERING>
 	{
 	public:
 		GPUBuffer(VkBufferUsageFlags usage, VmaMemoryUsage memoryUsage);
@@ -28,7 +29,12 @@ namespace llt
 		void writeToBuffer(const GPUBuffer *other, uint64_t length, uint64_t srcOffset, uint64_t dstOffset);
 
 		void writeToTextureSingle(const Texture *texture, uint64_t size, uint64_t offset = 0, uint32_t baseArrayLayer = 0);
-		void writeToTexture(CommandBuffer &commandBuffer, const Texture *texture, uint64_t size, uint64_t offset = 0, uint32_t baseArrayLayer = 0);
+		void writeToTexture(CommandBuffer &commandBuffer, const Texture *texture, uint64_t size, uint64_t offset = 0, uint32_t baseArrayLayer = 0, uint32_t mipLevel = 0);
+
+		/*
+		 * Copies one layer of one mip into this buffer, the texture has to be in TRANSFER_SRC_OPTIMAL layout.
+		 */
+		void readFromTexture(CommandBuffer &commandBuffer, const Texture *texture, uint64_t offset = 0, uint32_t baseArrayLayer = 0, uint32_t mipLevel = 0);
 
 		VkDescriptorBufferInfo getDescriptorInfo(uint32_t offset = 0) const;
 		VkDescriptorBufferInfo getDescriptorInfoRange(uint32_t range, uint32_t offset = 0) const;
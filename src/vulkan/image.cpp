@@ -1,5 +1,7 @@
 #include "image.h"
 #include "math/colour.h"
+#include "io/mapped_file.h"
+#include "container/vector.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "third_party/stb_image.h"
@@ -36,13 +38,21 @@ Image::Image(const char *path)
 }
 
 Image::Image(int width, int height)
+	: Image(width, height, FORMAT_RGBA8)
+{
+}
+
+Image::Image(int width, int height, Format format)
 	: m_width(width)
 	, m_height(height)
-	, m_channels(0)
+	, m_channels(4)
 	, m_stbiManaged(false)
-	, m_format(FORMAT_RGBA8)
+	, m_format(format)
 {
-	m_pixels = new Colour[width * height];
+	uint64_t size = (uint64_t)width * height * getBytesPerPixel(format);
+
+	m_pixels = new byte[size];
+	mem::set(m_pixels, 0, size);
 }
 
 Image::~Image()
@@ -56,17 +66,33 @@ void Image::load(const String &path)
 }
 
 void Image::load(const char *path)
+{
+	// decode straight out of the mapping instead of having stb buffer the file through stdio
+	MappedFile file(path, MAPPED_FILE_ACCESS_SEQUENTIAL);
+
+	if (!file.isOpen())
+	{
+		LLT_ERROR("Couldn't open image: %s", path);
+		return;
+	}
+
+	loadFromMemory(file.data(), file.size());
+}
+
+void Image::loadFromMemory(const void *data, uint64_t size)
 {
 	int w, h, channels;
 
-	if (stbi_is_hdr(path))
+	const stbi_uc *buffer = (const stbi_uc *)data;
+
+	if (stbi_is_hdr_from_memory(buffer, size))
 	{
-		m_pixels = stbi_loadf(path, &w, &h, &channels, 4);
+		m_pixels = stbi_loadf_from_memory(buffer, size, &w, &h, &channels, 4);
 		m_format = FORMAT_RGBAF;
 	}
 	else
 	{
-		m_pixels = stbi_load(path, &w, &h, &channels, 4);
+		m_pixels = stbi_load_from_memory(buffer, size, &w, &h, &channels, 4);
 		m_format = FORMAT_RGBA8;
 
 		if (!m_pixels)
@@ -89,12 +115,112 @@ void Image::free()
 	if (m_stbiManaged) {
 		stbi_image_free(m_pixels);
 	} else {
-		delete[] (Colour *)m_pixels;
+		delete[] (byte *)m_pixels;
 	}
 
 	m_pixels = nullptr;
 }
 
+void Image::convert(Format format)
+{
+	if (format == m_format || !m_pixels) {
+		return;
+	}
+
+	uint64_t pixelCount = getPixelCount();
+	byte *pixels = new byte[pixelCount * getBytesPerPixel(format)];
+
+	if (m_format == FORMAT_RGBA8 && format == FORMAT_RGBAF)
+	{
+		imageops::srgbToLinear((const byte *)m_pixels, (float *)pixels, pixelCount);
+	}
+	else if (m_format == FORMAT_RGBAF && format == FORMAT_RGBA8)
+	{
+		imageops::linearToSrgb((const float *)m_pixels, pixels, pixelCount);
+	}
+	else if (m_format == FORMAT_RGBAF && format == FORMAT_RGBA16F)
+	{
+		imageops::packHalf((const float *)m_pixels, (uint16_t *)pixels, pixelCount);
+	}
+	else if (m_format == FORMAT_RGBA8 && format == FORMAT_RGBA16F)
+	{
+		Vector<float> linear(pixelCount * 4);
+
+		imageops::srgbToLinear((const byte *)m_pixels, linear.data(), pixelCount);
+		imageops::packHalf(linear.data(), (uint16_t *)pixels, pixelCount);
+	}
+	else
+	{
+		delete[] pixels;
+
+		LLT_ERROR("Half precision images can't be converted to anything else.");
+		return;
+	}
+
+	setOwnedPixels(pixels, m_width, m_height, format);
+}
+
+void Image::premultiplyAlpha()
+{
+	if (m_format == FORMAT_RGBA8) {
+		imageops::premultiplyAlpha((byte *)m_pixels, getPixelCount());
+	} else if (m_format == FORMAT_RGBAF) {
+		imageops::premultiplyAlpha((float *)m_pixels, getPixelCount());
+	} else {
+		LLT_ERROR("Can't premultiply a half precision image.");
+	}
+}
+
+void Image::downsample(Image &dst, imageops::DownsampleFilter filter) const
+{
+	LLT_ASSERT(m_format == FORMAT_RGBAF, "Only RGBAF images can be downsampled.");
+
+	uint32_t width = m_width > 1 ? m_width / 2 : 1;
+	uint32_t height = m_height > 1 ? m_height / 2 : 1;
+
+	dst.setOwnedPixels(new byte[(uint64_t)width * height * getBytesPerPixel(FORMAT_RGBAF)], width, height, FORMAT_RGBAF);
+
+	imageops::downsample((const float *)m_pixels, m_width, m_height, (float *)dst.m_pixels, filter);
+}
+
+void Image::swizzle(const int channels[4])
+{
+	LLT_ASSERT(m_format == FORMAT_RGBA8, "Only RGBA8 images can be swizzled.");
+
+	imageops::swizzle((const byte *)m_pixels, (byte *)m_pixels, getPixelCount(), channels);
+}
+
+void Image::packChannels(const Image *sources[4], const int channels[4], const byte fills[4])
+{
+	const Image *first = nullptr;
+
+	for (int i = 0; i < 4; i++)
+	{
+		if (sources[i] && !first) {
+			first = sources[i];
+		}
+	}
+
+	LLT_ASSERT(first, "Need at least one source image to pack channels from.");
+
+	imageops::ChannelSource channelSources[4];
+
+	for (int i = 0; i < 4; i++)
+	{
+		LLT_ASSERT(!sources[i] || (sources[i]->m_format == FORMAT_RGBA8 && sources[i]->m_width == first->m_width && sources[i]->m_height == first->m_height), "Packed channels must all come from RGBA8 images of the same size.");
+
+		channelSources[i].pixels = sources[i] ? (const byte *)sources[i]->m_pixels : nullptr;
+		channelSources[i].channel = channels[i];
+		channelSources[i].fill = fills[i];
+	}
+
+	byte *pixels = new byte[(uint64_t)first->m_width * first->m_height * getBytesPerPixel(FORMAT_RGBA8)];
+
+	imageops::packChannels(channelSources, pixels, (uint64_t)first->m_width * first->m_height);
+
+	setOwnedPixels(pixels, first->m_width, first->m_height, FORMAT_RGBA8);
+}
+
 void Image::paint(const BrushFn &brush)
 {
 	paint(RectI(0, 0, m_width, m_height), brush);
@@ -214,11 +340,37 @@ uint32_t Image::getPixelCount() const
 
 uint64_t Image::getSize() const
 {
-	uint64_t unit = m_format == FORMAT_RGBA8 ? sizeof(uint8_t) : sizeof(float);
-	return m_width * m_height * 4 * unit;
+	return (uint64_t)m_width * m_height * getBytesPerPixel(m_format);
 }
 
 int Image::getChannels() const
 {
 	return m_channels;
 }
+
+uint64_t Image::getBytesPerPixel(Format format)
+{
+	switch (format)
+	{
+		case FORMAT_RGBAF:
+			return sizeof(float) * 4;
+
+		case FORMAT_RGBA16F:
+			return sizeof(uint16_t) * 4;
+
+		default:
+			return sizeof(uint8_t) * 4;
+	}
+}
+
+void Image::setOwnedPixels(byte *pixels, uint32_t width, uint32_t height, Format format)
+{
+	free();
+
+	m_pixels = pixels;
+	m_width = width;
+	m_height = height;
+	m_format = format;
+	m_channels = 4;
+	m_stbiManaged = false;
+}
@@ -8,6 +8,8 @@
 
 #include "math/rect.h"
 
+#include "image_ops.h"
+
 namespace llt
 {
 	struct Colour;
@@ -19,6 +21,7 @@ namespace llt
 		{
 			FORMAT_RGBA8, // ldr
 			FORMAT_RGBAF, // hdr
+			FORMAT_RGBA16F, // hdr, half precision
 		};
 
 		using BrushFn = Function<Colour(uint32_t, uint32_t)>;
@@ -27,11 +30,17 @@ namespace llt
 		Image(const String &path);
 		Image(const char *path);
 		Image(int width, int height);
+		Image(int width, int height, Format format);
 		~Image();
 
 		void load(const String &path);
 		void load(const char *path);
 
+		/*
+		 * Decode an encoded image (png, jpg, hdr, ...) that's already in memory.
+		 */
+		void loadFromMemory(const void *data, uint64_t size);
+
 		void free();
 
 		/*
@@ -45,6 +54,30 @@ namespace llt
 		void setPixels(const Colour *data);
 		void setPixels(uint64_t dstFirst, const Colour *data, uint64_t srcFirst, uint64_t count);
 
+		/*
+		 * Converts the pixels in place. ldr pixels are treated as srgb and hdr ones as linear.
+		 * Half precision images can't be converted back out of.
+		 */
+		void convert(Format format);
+
+		void premultiplyAlpha();
+
+		/*
+		 * Fills dst with this image at half the size. Only for RGBAF images.
+		 */
+		void downsample(Image &dst, imageops::DownsampleFilter filter) const;
+
+		/*
+		 * Rearranges the channels of an RGBA8 image, see imageops::swizzle.
+		 */
+		void swizzle(const int channels[4]);
+
+		/*
+		 * Builds this image out of a channel from each of up to four RGBA8 images of the same size,
+		 * e.g: separate ao/roughness/metal maps into one orm map. Null sources are filled with their fill value.
+		 */
+		void packChannels(const Image *sources[4], const int channels[4], const byte fills[4]);
+
 		bool saveToPng(const char *file) const;
 		bool saveToPng(Stream &stream) const;
 		bool saveToJpg(const char *file, int quality) const;
@@ -63,6 +96,13 @@ namespace llt
 		int getChannels() const;
 
 	private:
+		static uint64_t getBytesPerPixel(Format format);
+
+		/*
+		 * Takes ownership of pixels allocated with new byte[], freeing whatever was there before.
+		 */
+		void setOwnedPixels(byte *pixels, uint32_t width, uint32_t height, Format format);
+
 		void *m_pixels;
 		Format m_format;
 
@@ -0,0 +1,1729 @@
+#include "image_ops.h"
+
+#include "container/vector.h"
+
+#include "math/calc.h"
+
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+
+#define LLT_IMAGE_OPS_X86
+
+#include <immintrin.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+
+#include <intrin.h>
+
+// msvc lets any intrinsic through, so there's nothing to enable per function
+#define LLT_TARGET_SSE
+#define LLT_TARGET_AVX2
+
+#else
+
+#include <cpuid.h>
+
+#define LLT_TARGET_SSE __attribute__((target("ssse3")))
+#define LLT_TARGET_AVX2 __attribute__((target("avx2,f16c")))
+
+#endif
+
+#endif // x86
+
+using namespace llt;
+
+static imageops::SimdLevel g_simdLevelCap = imageops::SIMD_LEVEL_MAX_ENUM;
+
+static constexpr float SRGB_LINEAR_THRESHOLD = 0.0031308f;
+static constexpr float RGB9E5_MAX = 65408.0f; // (511 / 512) * 2^16
+
+static constexpr int KAISER_TAPS = 6;
+static constexpr float KAISER_ALPHA = 4.0f;
+
+static uint32_t floatBits(float value)
+{
+	uint32_t bits = 0;
+	mem::copy(&bits, &value, sizeof(float));
+	return bits;
+}
+
+static float bitsFloat(uint32_t bits)
+{
+	float value = 0.0f;
+	mem::copy(&value, &bits, sizeof(float));
+	return value;
+}
+
+static float srgbDecode(float value)
+{
+	return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+static float srgbEncode(float value)
+{
+	return value <= SRGB_LINEAR_THRESHOLD ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+}
+
+// nans end up as 0
+static float saturate(float value)
+{
+	return !(value > 0.0f) ? 0.0f : (value < 1.0f ? value : 1.0f);
+}
+
+/*
+ * Every srgb byte decoded ahead of time, it's only 256 entries.
+ */
+struct SrgbTable
+{
+	float values[256];
+
+	SrgbTable()
+	{
+		for (int i = 0; i < 256; i++) {
+			values[i] = srgbDecode((float)i / 255.0f);
+		}
+	}
+};
+
+static const SrgbTable &getSrgbTable()
+{
+	static SrgbTable table;
+	return table;
+}
+
+/*
+ * Windowed sinc for halving. Output texel x is centred between source texels 2x and 2x+1,
+ * so the taps land at 2x-2 ... 2x+3, half a texel off from the centre.
+ */
+struct KaiserWeights
+{
+	float values[KAISER_TAPS];
+
+	KaiserWeights()
+	{
+		float sum = 0.0f;
+
+		for (int i = 0; i < KAISER_TAPS; i++)
+		{
+			double distance = (double)i - (KAISER_TAPS - 1) * 0.5;
+
+			// cutoff at half the source nyquist
+			double x = distance * 0.5;
+			double sinc = std::sin(CalcD::PI * x) / (CalcD::PI * x);
+
+			double ratio = distance / (KAISER_TAPS * 0.5);
+			double window = besselI0(KAISER_ALPHA * std::sqrt(1.0 - ratio * ratio)) / besselI0(KAISER_ALPHA);
+
+			values[i] = (float)(sinc * window);
+			sum += values[i];
+		}
+
+		for (int i = 0; i < KAISER_TAPS; i++) {
+			values[i] /= sum;
+		}
+	}
+
+	static double besselI0(double x)
+	{
+		double result = 1.0;
+		double term = 1.0;
+
+		for (int k = 1; k < 32; k++)
+		{
+			double t = x / (2.0 * k);
+			term *= t * t;
+			result += term;
+		}
+
+		return result;
+	}
+};
+
+static const KaiserWeights &getKaiserWeights()
+{
+	static KaiserWeights weights;
+	return weights;
+}
+
+static uint32_t getHalvedSize(uint32_t size)
+{
+	return CalcU::max(size >> 1, 1);
+}
+
+static uint32_t clampIndex(int index, uint32_t size)
+{
+	return (uint32_t)CalcI::clamp(index, 0, (int)size - 1);
+}
+
+/*
+ * Round to nearest even, same as the f16c instructions apart from nan payloads.
+ */
+static uint16_t floatToHalf(float value)
+{
+	uint32_t bits = floatBits(value);
+	uint32_t sign = bits & 0x80000000u;
+
+	bits ^= sign;
+
+	uint32_t half = 0;
+
+	if (bits >= (127 + 16) << 23)
+	{
+		// too big for a half, or already inf / nan
+		half = bits > (255u << 23) ? 0x7E00 : 0x7C00;
+	}
+	else if (bits < (113 << 23))
+	{
+		// subnormal or zero, let the float adder do the rounding
+		const uint32_t magic = ((127 - 15) + (23 - 10) + 1) << 23;
+		half = floatBits(bitsFloat(bits) + bitsFloat(magic)) - magic;
+	}
+	else
+	{
+		uint32_t mantissaOdd = (bits >> 13) & 1;
+
+		bits += ((uint32_t)(15 - 127) << 23) + 0xFFF;
+		bits += mantissaOdd;
+
+		half = bits >> 13;
+	}
+
+	return (uint16_t)(half | (sign >> 16));
+}
+
+static uint32_t packRGB9E5Pixel(const float *pixel)
+{
+	float rgb[3];
+
+	for (int c = 0; c < 3; c++) {
+		rgb[c] = !(pixel[c] > 0.0f) ? 0.0f : (pixel[c] < RGB9E5_MAX ? pixel[c] : RGB9E5_MAX);
+	}
+
+	float maxChannel = CalcF::max(rgb[0], CalcF::max(rgb[1], rgb[2]));
+
+	// floor(log2(max)) straight out of the exponent bits, zero and denormals clamp to the bottom
+	int exponent = CalcI::max((int)(floatBits(maxChannel) >> 23) - 127, -16) + 16;
+
+	float scale = bitsFloat((uint32_t)(127 + 24 - exponent) << 23);
+
+	if ((uint32_t)(maxChannel * scale + 0.5f) == 512)
+	{
+		exponent++;
+		scale = bitsFloat((uint32_t)(127 + 24 - exponent) << 23);
+	}
+
+	uint32_t r = (uint32_t)(rgb[0] * scale + 0.5f);
+	uint32_t g = (uint32_t)(rgb[1] * scale + 0.5f);
+	uint32_t b = (uint32_t)(rgb[2] * scale + 0.5f);
+
+	return r | (g << 9) | (b << 18) | ((uint32_t)exponent << 27);
+}
+
+static constexpr float SH_BAND0 = 0.282095f;
+static constexpr float SH_BAND1 = 0.488603f;
+static constexpr float SH_BAND2 = 1.092548f;
+static constexpr float SH_BAND2_ZZ = 0.315392f;
+static constexpr float SH_BAND2_XX_YY = 0.546274f;
+
+// the major axis, then the directions s and t run along, for each face in +x, -x, +y, -y, +z, -z order
+static constexpr float CUBE_FACE_AXES[6][3][3] = {
+	{ {  1.0f,  0.0f,  0.0f }, {  0.0f,  0.0f, -1.0f }, {  0.0f, -1.0f,  0.0f } },
+	{ { -1.0f,  0.0f,  0.0f }, {  0.0f,  0.0f,  1.0f }, {  0.0f, -1.0f,  0.0f } },
+	{ {  0.0f,  1.0f,  0.0f }, {  1.0f,  0.0f,  0.0f }, {  0.0f,  0.0f,  1.0f } },
+	{ {  0.0f, -1.0f,  0.0f }, {  1.0f,  0.0f,  0.0f }, {  0.0f,  0.0f, -1.0f } },
+	{ {  0.0f,  0.0f,  1.0f }, {  1.0f,  0.0f,  0.0f }, {  0.0f, -1.0f,  0.0f } },
+	{ {  0.0f,  0.0f, -1.0f }, { -1.0f,  0.0f,  0.0f }, {  0.0f, -1.0f,  0.0f } }
+};
+
+/*
+ * Adds one cubemap texel at (s, t) in [-1, 1] on the face to the projection.
+ * The simd versions do exactly the same sums, just on more texels at once.
+ */
+static void projectSH9Texel(const float *pixel, uint32_t face, float s, float t, float texelArea, float *sh)
+{
+	const float (*axes)[3] = CUBE_FACE_AXES[face];
+
+	float lengthSq = 1.0f + s*s + t*t;
+	float invLength = 1.0f / std::sqrt(lengthSq);
+
+	// the solid angle the texel covers once it's projected onto the unit sphere
+	float weight = (texelArea * invLength) / lengthSq;
+
+	float x = (axes[0][0] + s*axes[1][0] + t*axes[2][0]) * invLength;
+	float y = (axes[0][1] + s*axes[1][1] + t*axes[2][1]) * invLength;
+	float z = (axes[0][2] + s*axes[1][2] + t*axes[2][2]) * invLength;
+
+	float basis[9] = {
+		SH_BAND0,
+		SH_BAND1 * y,
+		SH_BAND1 * z,
+		SH_BAND1 * x,
+		SH_BAND2 * x * y,
+		SH_BAND2 * y * z,
+		SH_BAND2_ZZ * (3.0f * z * z - 1.0f),
+		SH_BAND2 * x * z,
+		SH_BAND2_XX_YY * (x * x - y * y)
+	};
+
+	for (int i = 0; i < 9; i++)
+	{
+		float basisWeight = basis[i] * weight;
+
+		sh[i*3 + 0] += pixel[0] * basisWeight;
+		sh[i*3 + 1] += pixel[1] * basisWeight;
+		sh[i*3 + 2] += pixel[2] * basisWeight;
+	}
+
+	sh[27] += weight;
+}
+
+// ---
+
+void imageops::scalar::downsample(const float *src, uint32_t srcWidth, uint32_t srcHeight, float *dst, DownsampleFilter filter)
+{
+	uint32_t dstWidth = getHalvedSize(srcWidth);
+	uint32_t dstHeight = getHalvedSize(srcHeight);
+
+	if (filter == DOWNSAMPLE_FILTER_BOX)
+	{
+		for (uint32_t y = 0; y < dstHeight; y++)
+		{
+			const float *row0 = src + (uint64_t)CalcU::min(y * 2 + 0, srcHeight - 1) * srcWidth * 4;
+			const float *row1 = src + (uint64_t)CalcU::min(y * 2 + 1, srcHeight - 1) * srcWidth * 4;
+
+			for (uint32_t x = 0; x < dstWidth; x++)
+			{
+				uint32_t x0 = CalcU::min(x * 2 + 0, srcWidth - 1);
+				uint32_t x1 = CalcU::min(x * 2 + 1, srcWidth - 1);
+
+				for (int c = 0; c < 4; c++) {
+					dst[((uint64_t)y * dstWidth + x) * 4 + c] = (((row0[x0*4 + c] + row0[x1*4 + c]) + row1[x0*4 + c]) + row1[x1*4 + c]) * 0.25f;
+				}
+			}
+		}
+
+		return;
+	}
+
+	const float *weights = getKaiserWeights().values;
+
+	// horizontal first into a half width image, then vertical from that
+	Vector<float> rows((uint64_t)dstWidth * srcHeight * 4);
+
+	for (uint32_t y = 0; y < srcHeight; y++)
+	{
+		const float *row = src + (uint64_t)y * srcWidth * 4;
+
+		for (uint32_t x = 0; x < dstWidth; x++)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				float sum = 0.0f;
+
+				for (int k = 0; k < KAISER_TAPS; k++) {
+					sum += weights[k] * row[clampIndex((int)(x*2) - 2 + k, srcWidth) * 4 + c];
+				}
+
+				rows[((uint64_t)y * dstWidth + x) * 4 + c] = sum;
+			}
+		}
+	}
+
+	for (uint32_t y = 0; y < dstHeight; y++)
+	{
+		for (uint32_t i = 0; i < dstWidth * 4; i++)
+		{
+			float sum = 0.0f;
+
+			for (int k = 0; k < KAISER_TAPS; k++) {
+				sum += weights[k] * rows[(uint64_t)clampIndex((int)(y*2) - 2 + k, srcHeight) * dstWidth * 4 + i];
+			}
+
+			dst[(uint64_t)y * dstWidth * 4 + i] = sum;
+		}
+	}
+}
+
+void imageops::scalar::srgbToLinear(const byte *src, float *dst, uint64_t pixelCount)
+{
+	const float *table = getSrgbTable().values;
+
+	for (uint64_t i = 0; i < pixelCount; i++)
+	{
+		dst[i*4 + 0] = table[src[i*4 + 0]];
+		dst[i*4 + 1] = table[src[i*4 + 1]];
+		dst[i*4 + 2] = table[src[i*4 + 2]];
+		dst[i*4 + 3] = (float)src[i*4 + 3] * (1.0f / 255.0f);
+	}
+}
+
+void imageops::scalar::linearToSrgb(const float *src, byte *dst, uint64_t pixelCount)
+{
+	for (uint64_t i = 0; i < pixelCount; i++)
+	{
+		for (int c = 0; c < 3; c++) {
+			dst[i*4 + c] = (byte)(srgbEncode(saturate(src[i*4 + c])) * 255.0f + 0.5f);
+		}
+
+		dst[i*4 + 3] = (byte)(saturate(src[i*4 + 3]) * 255.0f + 0.5f);
+	}
+}
+
+void imageops::scalar::premultiplyAlpha(byte *pixels, uint64_t pixelCount)
+{
+	for (uint64_t i = 0; i < pixelCount; i++)
+	{
+		uint32_t alpha = pixels[i*4 + 3];
+
+		for (int c = 0; c < 3; c++) {
+			pixels[i*4 + c] = (byte)((pixels[i*4 + c] * alpha + 127) / 255);
+		}
+	}
+}
+
+void imageops::scalar::premultiplyAlpha(float *pixels, uint64_t pixelCount)
+{
+	for (uint64_t i = 0; i < pixelCount; i++)
+	{
+		for (int c = 0; c < 3; c++) {
+			pixels[i*4 + c] *= pixels[i*4 + 3];
+		}
+	}
+}
+
+void imageops::scalar::packHalf(const float *src, uint16_t *dst, uint64_t pixelCount)
+{
+	for (uint64_t i = 0; i < pixelCount * 4; i++) {
+		dst[i] = floatToHalf(src[i]);
+	}
+}
+
+void imageops::scalar::packRGB9E5(const float *src, uint32_t *dst, uint64_t pixelCount)
+{
+	for (uint64_t i = 0; i < pixelCount; i++) {
+		dst[i] = packRGB9E5Pixel(src + i*4);
+	}
+}
+
+void imageops::scalar::swizzle(const byte *src, byte *dst, uint64_t pixelCount, const int channels[4])
+{
+	for (uint64_t i = 0; i < pixelCount; i++)
+	{
+		byte pixel[6] = { src[i*4 + 0], src[i*4 + 1], src[i*4 + 2], src[i*4 + 3], 0, 255 };
+
+		for (int c = 0; c < 4; c++) {
+			dst[i*4 + c] = pixel[channels[c]];
+		}
+	}
+}
+
+void imageops::scalar::packChannels(const ChannelSource sources[4], byte *dst, uint64_t pixelCount)
+{
+	for (uint64_t i = 0; i < pixelCount; i++)
+	{
+		for (int c = 0; c < 4; c++) {
+			dst[i*4 + c] = sources[c].pixels ? sources[c].pixels[i*4 + sources[c].channel] : sources[c].fill;
+		}
+	}
+}
+
+void imageops::scalar::projectSH9(const float *src, uint32_t size, uint32_t face, float *sh)
+{
+	float invSize = 1.0f / (float)size;
+	float texelArea = 4.0f * invSize * invSize;
+
+	for (uint32_t y = 0; y < size; y++)
+	{
+		float t = (2.0f * y + 1.0f) * invSize - 1.0f;
+
+		for (uint32_t x = 0; x < size; x++)
+		{
+			float s = (2.0f * x + 1.0f) * invSize - 1.0f;
+
+			projectSH9Texel(src + ((uint64_t)y * size + x) * 4, face, s, t, texelArea, sh);
+		}
+	}
+}
+
+// ---
+
+#if defined(LLT_IMAGE_OPS_X86)
+
+/*
+ * The sse versions stick to ssse3 at most, which every x64 cpu from the last 15 years has.
+ */
+
+LLT_TARGET_SSE
+static __m128 selectPS(__m128 mask, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+LLT_TARGET_SSE
+static __m128i selectEpi32(__m128i mask, __m128i a, __m128i b)
+{
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+LLT_TARGET_SSE
+static void downsampleBoxSSE(const float *src, uint32_t srcWidth, uint32_t srcHeight, float *dst)
+{
+	uint32_t dstWidth = getHalvedSize(srcWidth);
+	uint32_t dstHeight = getHalvedSize(srcHeight);
+
+	const __m128 quarter = _mm_set1_ps(0.25f);
+
+	for (uint32_t y = 0; y < dstHeight; y++)
+	{
+		const float *row0 = src + (uint64_t)CalcU::min(y * 2 + 0, srcHeight - 1) * srcWidth * 4;
+		const float *row1 = src + (uint64_t)CalcU::min(y * 2 + 1, srcHeight - 1) * srcWidth * 4;
+
+		float *out = dst + (uint64_t)y * dstWidth * 4;
+
+		for (uint32_t x = 0; x < dstWidth; x++)
+		{
+			uint32_t x0 = CalcU::min(x * 2 + 0, srcWidth - 1);
+			uint32_t x1 = CalcU::min(x * 2 + 1, srcWidth - 1);
+
+			__m128 sum = _mm_add_ps(_mm_loadu_ps(row0 + x0*4), _mm_loadu_ps(row0 + x1*4));
+			sum = _mm_add_ps(sum, _mm_loadu_ps(row1 + x0*4));
+			sum = _mm_add_ps(sum, _mm_loadu_ps(row1 + x1*4));
+
+			_mm_storeu_ps(out + x*4, _mm_mul_ps(sum, quarter));
+		}
+	}
+}
+
+LLT_TARGET_SSE
+static void downsampleKaiserSSE(const float *src, uint32_t srcWidth, uint32_t srcHeight, float *dst)
+{
+	uint32_t dstWidth = getHalvedSize(srcWidth);
+	uint32_t dstHeight = getHalvedSize(srcHeight);
+
+	__m128 weights[KAISER_TAPS];
+
+	for (int k = 0; k < KAISER_TAPS; k++) {
+		weights[k] = _mm_set1_ps(getKaiserWeights().values[k]);
+	}
+
+	Vector<float> rows((uint64_t)dstWidth * srcHeight * 4);
+
+	for (uint32_t y = 0; y < srcHeight; y++)
+	{
+		const float *row = src + (uint64_t)y * srcWidth * 4;
+		float *out = rows.data() + (uint64_t)y * dstWidth * 4;
+
+		for (uint32_t x = 0; x < dstWidth; x++)
+		{
+			__m128 sum = _mm_mul_ps(weights[0], _mm_loadu_ps(row + clampIndex((int)(x*2) - 2, srcWidth) * 4));
+
+			for (int k = 1; k < KAISER_TAPS; k++) {
+				sum = _mm_add_ps(sum, _mm_mul_ps(weights[k], _mm_loadu_ps(row + clampIndex((int)(x*2) - 2 + k, srcWidth) * 4)));
+			}
+
+			_mm_storeu_ps(out + x*4, sum);
+		}
+	}
+
+	for (uint32_t y = 0; y < dstHeight; y++)
+	{
+		const float *taps[KAISER_TAPS];
+
+		for (int k = 0; k < KAISER_TAPS; k++) {
+			taps[k] = rows.data() + (uint64_t)clampIndex((int)(y*2) - 2 + k, srcHeight) * dstWidth * 4;
+		}
+
+		float *out = dst + (uint64_t)y * dstWidth * 4;
+
+		for (uint32_t i = 0; i < dstWidth * 4; i += 4)
+		{
+			__m128 sum = _mm_mul_ps(weights[0], _mm_loadu_ps(taps[0] + i));
+
+			for (int k = 1; k < KAISER_TAPS; k++) {
+				sum = _mm_add_ps(sum, _mm_mul_ps(weights[k], _mm_loadu_ps(taps[k] + i)));
+			}
+
+			_mm_storeu_ps(out + i, sum);
+		}
+	}
+}
+
+/*
+ * Ian Taylor's fit of the srgb curve, a few sqrts instead of a pow.
+ */
+LLT_TARGET_SSE
+static __m128i linearToSrgbPixelSSE(__m128 pixel)
+{
+	const __m128 alphaMask = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+
+	pixel = _mm_min_ps(_mm_max_ps(pixel, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+
+	__m128 s = _mm_sqrt_ps(pixel);
+	__m128 t = _mm_sqrt_ps(s);
+	__m128 u = _mm_sqrt_ps(t);
+
+	__m128 curve = _mm_mul_ps(_mm_set1_ps(0.662002687f), s);
+	curve = _mm_add_ps(curve, _mm_mul_ps(_mm_set1_ps(0.684122060f), t));
+	curve = _mm_sub_ps(curve, _mm_mul_ps(_mm_set1_ps(0.323583601f), u));
+	curve = _mm_sub_ps(curve, _mm_mul_ps(_mm_set1_ps(0.0225411470f), pixel));
+
+	__m128 linear = _mm_mul_ps(pixel, _mm_set1_ps(12.92f));
+
+	__m128 encoded = selectPS(_mm_cmple_ps(pixel, _mm_set1_ps(SRGB_LINEAR_THRESHOLD)), linear, curve);
+	encoded = _mm_min_ps(_mm_max_ps(encoded, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+	encoded = selectPS(alphaMask, pixel, encoded);
+
+	return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(encoded, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+}
+
+LLT_TARGET_SSE
+static void linearToSrgbSSE(const float *src, byte *dst, uint64_t pixelCount)
+{
+	uint64_t i = 0;
+
+	for (; i + 4 <= pixelCount; i += 4)
+	{
+		__m128i p0 = linearToSrgbPixelSSE(_mm_loadu_ps(src + i*4 + 0));
+		__m128i p1 = linearToSrgbPixelSSE(_mm_loadu_ps(src + i*4 + 4));
+		__m128i p2 = linearToSrgbPixelSSE(_mm_loadu_ps(src + i*4 + 8));
+		__m128i p3 = linearToSrgbPixelSSE(_mm_loadu_ps(src + i*4 + 12));
+
+		__m128i packed = _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3));
+
+		_mm_storeu_si128((__m128i *)(dst + i*4), packed);
+	}
+
+	imageops::scalar::linearToSrgb(src + i*4, dst + i*4, pixelCount - i);
+}
+
+/*
+ * round(c * a / 255) without the divide: (t + (t >> 8)) >> 8 where t = c * a + 128.
+ */
+LLT_TARGET_SSE
+static __m128i premultiplyHalfSSE(__m128i channels)
+{
+	__m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(channels, 0xFF), 0xFF);
+	__m128i t = _mm_add_epi16(_mm_mullo_epi16(channels, alpha), _mm_set1_epi16(128));
+
+	return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+LLT_TARGET_SSE
+static void premultiplyAlphaSSE(byte *pixels, uint64_t pixelCount)
+{
+	const __m128i rgbMask = _mm_set1_epi32(0x00FFFFFF);
+
+	uint64_t i = 0;
+
+	for (; i + 4 <= pixelCount; i += 4)
+	{
+		__m128i px = _mm_loadu_si128((const __m128i *)(pixels + i*4));
+
+		__m128i lo = premultiplyHalfSSE(_mm_unpacklo_epi8(px, _mm_setzero_si128()));
+		__m128i hi = premultiplyHalfSSE(_mm_unpackhi_epi8(px, _mm_setzero_si128()));
+
+		__m128i result = selectEpi32(rgbMask, _mm_packus_epi16(lo, hi), px);
+
+		_mm_storeu_si128((__m128i *)(pixels + i*4), result);
+	}
+
+	imageops::scalar::premultiplyAlpha(pixels + i*4, pixelCount - i);
+}
+
+LLT_TARGET_SSE
+static void premultiplyAlphaFloatSSE(float *pixels, uint64_t pixelCount)
+{
+	const __m128 alphaMask = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+
+	for (uint64_t i = 0; i < pixelCount; i++)
+	{
+		__m128 px = _mm_loadu_ps(pixels + i*4);
+		__m128 alpha = _mm_shuffle_ps(px, px, 0xFF);
+
+		_mm_storeu_ps(pixels + i*4, selectPS(alphaMask, px, _mm_mul_ps(px, alpha)));
+	}
+}
+
+/*
+ * Same steps as floatToHalf, with every branch taken and the right one picked at the end.
+ */
+LLT_TARGET_SSE
+static __m128i floatToHalfSSE(__m128 value)
+{
+	const __m128i magic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+
+	__m128i bits = _mm_castps_si128(value);
+	__m128i sign = _mm_and_si128(bits, _mm_set1_epi32(0x80000000));
+
+	bits = _mm_xor_si128(bits, sign);
+
+	__m128i isInfNan = _mm_cmpgt_epi32(bits, _mm_set1_epi32(((127 + 16) << 23) - 1));
+	__m128i isSubnormal = _mm_cmplt_epi32(bits, _mm_set1_epi32(113 << 23));
+
+	__m128i infNan = _mm_or_si128(_mm_set1_epi32(0x7C00), _mm_and_si128(_mm_cmpgt_epi32(bits, _mm_set1_epi32(255 << 23)), _mm_set1_epi32(0x200)));
+
+	__m128i subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(bits), _mm_castsi128_ps(magic))), magic);
+
+	__m128i mantissaOdd = _mm_and_si128(_mm_srli_epi32(bits, 13), _mm_set1_epi32(1));
+	__m128i normal = _mm_add_epi32(bits, _mm_set1_epi32((int)(((uint32_t)(15 - 127) << 23) + 0xFFF)));
+	normal = _mm_srli_epi32(_mm_add_epi32(normal, mantissaOdd), 13);
+
+	__m128i half = selectEpi32(isInfNan, infNan, selectEpi32(isSubnormal, subnormal, normal));
+	half = _mm_or_si128(half, _mm_srli_epi32(sign, 16));
+
+	// sign extend so the saturating pack leaves the bits alone
+	return _mm_srai_epi32(_mm_slli_epi32(half, 16), 16);
+}
+
+LLT_TARGET_SSE
+static void packHalfSSE(const float *src, uint16_t *dst, uint64_t pixelCount)
+{
+	uint64_t i = 0;
+
+	for (; i + 2 <= pixelCount; i += 2)
+	{
+		__m128i p0 = floatToHalfSSE(_mm_loadu_ps(src + i*4 + 0));
+		__m128i p1 = floatToHalfSSE(_mm_loadu_ps(src + i*4 + 4));
+
+		_mm_storeu_si128((__m128i *)(dst + i*4), _mm_packs_epi32(p0, p1));
+	}
+
+	imageops::scalar::packHalf(src + i*4, dst + i*4, pixelCount - i);
+}
+
+LLT_TARGET_SSE
+static void packRGB9E5SSE(const float *src, uint32_t *dst, uint64_t pixelCount)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 maxValue = _mm_set1_ps(RGB9E5_MAX);
+	const __m128 half = _mm_set1_ps(0.5f);
+
+	uint64_t i = 0;
+
+	for (; i + 4 <= pixelCount; i += 4)
+	{
+		__m128 p0 = _mm_loadu_ps(src + i*4 + 0);
+		__m128 p1 = _mm_loadu_ps(src + i*4 + 4);
+		__m128 p2 = _mm_loadu_ps(src + i*4 + 8);
+		__m128 p3 = _mm_loadu_ps(src + i*4 + 12);
+
+		// to one register per channel
+		__m128 t0 = _mm_unpacklo_ps(p0, p1);
+		__m128 t1 = _mm_unpacklo_ps(p2, p3);
+		__m128 t2 = _mm_unpackhi_ps(p0, p1);
+		__m128 t3 = _mm_unpackhi_ps(p2, p3);
+
+		// max(x, 0) picks 0 for nans
+		__m128 r = _mm_min_ps(_mm_max_ps(_mm_shuffle_ps(t0, t1, 0x44), zero), maxValue);
+		__m128 g = _mm_min_ps(_mm_max_ps(_mm_shuffle_ps(t0, t1, 0xEE), zero), maxValue);
+		__m128 b = _mm_min_ps(_mm_max_ps(_mm_shuffle_ps(t2, t3, 0x44), zero), maxValue);
+
+		__m128 maxChannel = _mm_max_ps(r, _mm_max_ps(g, b));
+
+		__m128i exponent = _mm_sub_epi32(_mm_srli_epi32(_mm_castps_si128(maxChannel), 23), _mm_set1_epi32(127));
+		exponent = selectEpi32(_mm_cmpgt_epi32(exponent, _mm_set1_epi32(-16)), exponent, _mm_set1_epi32(-16));
+		exponent = _mm_add_epi32(exponent, _mm_set1_epi32(16));
+
+		__m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_sub_epi32(_mm_set1_epi32(127 + 24), exponent), 23));
+
+		__m128i maxMantissa = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(maxChannel, scale), half));
+
+		// rounded up into the next exponent
+		exponent = _mm_sub_epi32(exponent, _mm_cmpeq_epi32(maxMantissa, _mm_set1_epi32(512)));
+		scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_sub_epi32(_mm_set1_epi32(127 + 24), exponent), 23));
+
+		__m128i ri = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(r, scale), half));
+		__m128i gi = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(g, scale), half));
+		__m128i bi = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(b, scale), half));
+
+		__m128i packed = _mm_or_si128(
+			_mm_or_si128(ri, _mm_slli_epi32(gi, 9)),
+			_mm_or_si128(_mm_slli_epi32(bi, 18), _mm_slli_epi32(exponent, 27))
+		);
+
+		_mm_storeu_si128((__m128i *)(dst + i), packed);
+	}
+
+	imageops::scalar::packRGB9E5(src + i*4, dst + i, pixelCount - i);
+}
+
+/*
+ * pshufb masks for four pixels at a time, 0x80 zeroes the byte.
+ */
+static void buildSwizzleMasks(const int channels[4], byte shuffle[16], byte ones[16])
+{
+	for (int p = 0; p < 4; p++)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			shuffle[p*4 + c] = channels[c] <= imageops::CHANNEL_A ? (byte)(p*4 + channels[c]) : 0x80;
+			ones[p*4 + c] = channels[c] == imageops::CHANNEL_ONE ? 0xFF : 0x00;
+		}
+	}
+}
+
+static void buildPackMasks(const imageops::ChannelSource sources[4], byte shuffles[4][16], byte fill[16])
+{
+	for (int p = 0; p < 4; p++)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			for (int s = 0; s < 4; s++) {
+				shuffles[s][p*4 + c] = (s == c && sources[s].pixels) ? (byte)(p*4 + sources[s].channel) : 0x80;
+			}
+
+			fill[p*4 + c] = sources[c].pixels ? 0x00 : sources[c].fill;
+		}
+	}
+}
+
+LLT_TARGET_SSE
+static void swizzleSSE(const byte *src, byte *dst, uint64_t pixelCount, const int channels[4])
+{
+	byte shuffleBytes[16], onesBytes[16];
+	buildSwizzleMasks(channels, shuffleBytes, onesBytes);
+
+	__m128i shuffle = _mm_loadu_si128((const __m128i *)shuffleBytes);
+	__m128i ones = _mm_loadu_si128((const __m128i *)onesBytes);
+
+	uint64_t i = 0;
+
+	for (; i + 4 <= pixelCount; i += 4)
+	{
+		__m128i px = _mm_loadu_si128((const __m128i *)(src + i*4));
+		_mm_storeu_si128((__m128i *)(dst + i*4), _mm_or_si128(_mm_shuffle_epi8(px, shuffle), ones));
+	}
+
+	imageops::scalar::swizzle(src + i*4, dst + i*4, pixelCount - i, channels);
+}
+
+LLT_TARGET_SSE
+static void packChannelsSSE(const imageops::ChannelSource sources[4], byte *dst, uint64_t pixelCount)
+{
+	byte shuffleBytes[4][16], fillBytes[16];
+	buildPackMasks(sources, shuffleBytes, fillBytes);
+
+	__m128i shuffles[4];
+
+	for (int s = 0; s < 4; s++) {
+		shuffles[s] = _mm_loadu_si128((const __m128i *)shuffleBytes[s]);
+	}
+
+	__m128i fill = _mm_loadu_si128((const __m128i *)fillBytes);
+
+	uint64_t i = 0;
+
+	for (; i + 4 <= pixelCount; i += 4)
+	{
+		__m128i result = fill;
+
+		for (int s = 0; s < 4; s++)
+		{
+			if (sources[s].pixels) {
+				result = _mm_or_si128(result, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(sources[s].pixels + i*4)), shuffles[s]));
+			}
+		}
+
+		_mm_storeu_si128((__m128i *)(dst + i*4), result);
+	}
+
+	imageops::ChannelSource rest[4];
+
+	for (int s = 0; s < 4; s++)
+	{
+		rest[s] = sources[s];
+		rest[s].pixels = sources[s].pixels ? sources[s].pixels + i*4 : nullptr;
+	}
+
+	imageops::scalar::packChannels(rest, dst + i*4, pixelCount - i);
+}
+
+LLT_TARGET_SSE
+static void calcSH9BasisSSE(__m128 x, __m128 y, __m128 z, __m128 basis[9])
+{
+	__m128 band1 = _mm_set1_ps(SH_BAND1);
+	__m128 band2 = _mm_set1_ps(SH_BAND2);
+
+	basis[0] = _mm_set1_ps(SH_BAND0);
+	basis[1] = _mm_mul_ps(band1, y);
+	basis[2] = _mm_mul_ps(band1, z);
+	basis[3] = _mm_mul_ps(band1, x);
+	basis[4] = _mm_mul_ps(_mm_mul_ps(band2, x), y);
+	basis[5] = _mm_mul_ps(_mm_mul_ps(band2, y), z);
+	basis[6] = _mm_mul_ps(_mm_set1_ps(SH_BAND2_ZZ), _mm_sub_ps(_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(3.0f), z), z), _mm_set1_ps(1.0f)));
+	basis[7] = _mm_mul_ps(_mm_mul_ps(band2, x), z);
+	basis[8] = _mm_mul_ps(_mm_set1_ps(SH_BAND2_XX_YY), _mm_sub_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)));
+}
+
+/*
+ * Four texels of a row at a time, transposed so each register holds one channel.
+ */
+LLT_TARGET_SSE
+static void projectSH9SSE(const float *src, uint32_t size, uint32_t face, float *sh)
+{
+	const float (*axes)[3] = CUBE_FACE_AXES[face];
+
+	float invSize = 1.0f / (float)size;
+	float texelArea = 4.0f * invSize * invSize;
+
+	__m128 acc[28];
+
+	for (int i = 0; i < 28; i++) {
+		acc[i] = _mm_setzero_ps();
+	}
+
+	__m128 one = _mm_set1_ps(1.0f);
+	__m128 invSizes = _mm_set1_ps(invSize);
+	__m128 texelAreas = _mm_set1_ps(texelArea);
+	__m128 offsets = _mm_setr_ps(1.0f, 3.0f, 5.0f, 7.0f);
+
+	for (uint32_t y = 0; y < size; y++)
+	{
+		float t = (2.0f * y + 1.0f) * invSize - 1.0f;
+
+		const float *row = src + (uint64_t)y * size * 4;
+
+		uint32_t x = 0;
+
+		for (; x + 4 <= size; x += 4)
+		{
+			__m128 s = _mm_sub_ps(_mm_mul_ps(_mm_add_ps(_mm_set1_ps(2.0f * x), offsets), invSizes), one);
+
+			__m128 lengthSq = _mm_add_ps(_mm_add_ps(one, _mm_mul_ps(s, s)), _mm_set1_ps(t*t));
+			__m128 invLength = _mm_div_ps(one, _mm_sqrt_ps(lengthSq));
+			__m128 weight = _mm_div_ps(_mm_mul_ps(texelAreas, invLength), lengthSq);
+
+			__m128 dir[3];
+
+			for (int c = 0; c < 3; c++) {
+				dir[c] = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_set1_ps(axes[0][c]), _mm_mul_ps(s, _mm_set1_ps(axes[1][c]))), _mm_set1_ps(t*axes[2][c])), invLength);
+			}
+
+			__m128 basis[9];
+			calcSH9BasisSSE(dir[0], dir[1], dir[2], basis);
+
+			__m128 r = _mm_loadu_ps(row + (x + 0)*4);
+			__m128 g = _mm_loadu_ps(row + (x + 1)*4);
+			__m128 b = _mm_loadu_ps(row + (x + 2)*4);
+			__m128 a = _mm_loadu_ps(row + (x + 3)*4);
+
+			_MM_TRANSPOSE4_PS(r, g, b, a);
+
+			for (int i = 0; i < 9; i++)
+			{
+				__m128 basisWeight = _mm_mul_ps(basis[i], weight);
+
+				acc[i*3 + 0] = _mm_add_ps(acc[i*3 + 0], _mm_mul_ps(r, basisWeight));
+				acc[i*3 + 1] = _mm_add_ps(acc[i*3 + 1], _mm_mul_ps(g, basisWeight));
+				acc[i*3 + 2] = _mm_add_ps(acc[i*3 + 2], _mm_mul_ps(b, basisWeight));
+			}
+
+			acc[27] = _mm_add_ps(acc[27], weight);
+		}
+
+		for (; x < size; x++)
+		{
+			float s = (2.0f * x + 1.0f) * invSize - 1.0f;
+
+			projectSH9Texel(row + x*4, face, s, t, texelArea, sh);
+		}
+	}
+
+	for (int i = 0; i < 28; i++)
+	{
+		float lanes[4];
+		_mm_storeu_ps(lanes, acc[i]);
+
+		sh[i] += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+	}
+}
+
+// ---
+
+/*
+ * avx2 versions, two rgba float pixels or eight rgba8 pixels to a register.
+ */
+
+LLT_TARGET_AVX2
+static __m256 loadPixelPairAVX2(const float *first, const float *second)
+{
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(first)), _mm_loadu_ps(second), 1);
+}
+
+LLT_TARGET_AVX2
+static void downsampleBoxAVX2(const float *src, uint32_t srcWidth, uint32_t srcHeight, float *dst)
+{
+	uint32_t dstWidth = getHalvedSize(srcWidth);
+	uint32_t dstHeight = getHalvedSize(srcHeight);
+
+	const __m256 quarter = _mm256_set1_ps(0.25f);
+
+	for (uint32_t y = 0; y < dstHeight; y++)
+	{
+		const float *row0 = src + (uint64_t)CalcU::min(y * 2 + 0, srcHeight - 1) * srcWidth * 4;
+		const float *row1 = src + (uint64_t)CalcU::min(y * 2 + 1, srcHeight - 1) * srcWidth * 4;
+
+		float *out = dst + (uint64_t)y * dstWidth * 4;
+
+		uint32_t x = 0;
+
+		// two output pixels from four source ones per row, as long as none of them need clamping
+		for (; x + 2 <= dstWidth && x*2 + 3 < srcWidth; x += 2)
+		{
+			__m256 a0 = _mm256_loadu_ps(row0 + x*8 + 0);
+			__m256 a1 = _mm256_loadu_ps(row0 + x*8 + 8);
+			__m256 b0 = _mm256_loadu_ps(row1 + x*8 + 0);
+			__m256 b1 = _mm256_loadu_ps(row1 + x*8 + 8);
+
+			// even source pixels in one register and odd in the other, so the adds happen in the same order as the scalar version
+			__m256 sum = _mm256_add_ps(_mm256_permute2f128_ps(a0, a1, 0x20), _mm256_permute2f128_ps(a0, a1, 0x31));
+			sum = _mm256_add_ps(sum, _mm256_permute2f128_ps(b0, b1, 0x20));
+			sum = _mm256_add_ps(sum, _mm256_permute2f128_ps(b0, b1, 0x31));
+
+			_mm256_storeu_ps(out + x*4, _mm256_mul_ps(sum, quarter));
+		}
+
+		for (; x < dstWidth; x++)
+		{
+			uint32_t x0 = CalcU::min(x * 2 + 0, srcWidth - 1);
+			uint32_t x1 = CalcU::min(x * 2 + 1, srcWidth - 1);
+
+			__m128 sum = _mm_add_ps(_mm_loadu_ps(row0 + x0*4), _mm_loadu_ps(row0 + x1*4));
+			sum = _mm_add_ps(sum, _mm_loadu_ps(row1 + x0*4));
+			sum = _mm_add_ps(sum, _mm_loadu_ps(row1 + x1*4));
+
+			_mm_storeu_ps(out + x*4, _mm_mul_ps(sum, _mm256_castps256_ps128(quarter)));
+		}
+	}
+}
+
+LLT_TARGET_AVX2
+static void downsampleKaiserAVX2(const float *src, uint32_t srcWidth, uint32_t srcHeight, float *dst)
+{
+	uint32_t dstWidth = getHalvedSize(srcWidth);
+	uint32_t dstHeight = getHalvedSize(srcHeight);
+
+	__m256 weights[KAISER_TAPS];
+
+	for (int k = 0; k < KAISER_TAPS; k++) {
+		weights[k] = _mm256_set1_ps(getKaiserWeights().values[k]);
+	}
+
+	Vector<float> rows((uint64_t)dstWidth * srcHeight * 4);
+
+	for (uint32_t y = 0; y < srcHeight; y++)
+	{
+		const float *row = src + (uint64_t)y * srcWidth * 4;
+		float *out = rows.data() + (uint64_t)y * dstWidth * 4;
+
+		uint32_t x = 0;
+
+		for (; x + 2 <= dstWidth; x += 2)
+		{
+			__m256 sum = _mm256_mul_ps(weights[0], loadPixelPairAVX2(
+				row + clampIndex((int)(x*2) - 2, srcWidth) * 4,
+				row + clampIndex((int)(x*2), srcWidth) * 4
+			));
+
+			for (int k = 1; k < KAISER_TAPS; k++)
+			{
+				sum = _mm256_add_ps(sum, _mm256_mul_ps(weights[k], loadPixelPairAVX2(
+					row + clampIndex((int)(x*2) - 2 + k, srcWidth) * 4,
+					row + clampIndex((int)(x*2) + k, srcWidth) * 4
+				)));
+			}
+
+			_mm256_storeu_ps(out + x*4, sum);
+		}
+
+		for (; x < dstWidth; x++)
+		{
+			__m128 sum = _mm_mul_ps(_mm256_castps256_ps128(weights[0]), _mm_loadu_ps(row + clampIndex((int)(x*2) - 2, srcWidth) * 4));
+
+			for (int k = 1; k < KAISER_TAPS; k++) {
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm256_castps256_ps128(weights[k]), _mm_loadu_ps(row + clampIndex((int)(x*2) - 2 + k, srcWidth) * 4)));
+			}
+
+			_mm_storeu_ps(out + x*4, sum);
+		}
+	}
+
+	for (uint32_t y = 0; y < dstHeight; y++)
+	{
+		const float *taps[KAISER_TAPS];
+
+		for (int k = 0; k < KAISER_TAPS; k++) {
+			taps[k] = rows.data() + (uint64_t)clampIndex((int)(y*2) - 2 + k, srcHeight) * dstWidth * 4;
+		}
+
+		float *out = dst + (uint64_t)y * dstWidth * 4;
+
+		uint32_t i = 0;
+
+		for (; i + 8 <= dstWidth * 4; i += 8)
+		{
+			__m256 sum = _mm256_mul_ps(weights[0], _mm256_loadu_ps(taps[0] + i));
+
+			for (int k = 1; k < KAISER_TAPS; k++) {
+				sum = _mm256_add_ps(sum, _mm256_mul_ps(weights[k], _mm256_loadu_ps(taps[k] + i)));
+			}
+
+			_mm256_storeu_ps(out + i, sum);
+		}
+
+		for (; i < dstWidth * 4; i += 4)
+		{
+			__m128 sum = _mm_mul_ps(_mm256_castps256_ps128(weights[0]), _mm_loadu_ps(taps[0] + i));
+
+			for (int k = 1; k < KAISER_TAPS; k++) {
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm256_castps256_ps128(weights[k]), _mm_loadu_ps(taps[k] + i)));
+			}
+
+			_mm_storeu_ps(out + i, sum);
+		}
+	}
+}
+
+LLT_TARGET_AVX2
+static void srgbToLinearAVX2(const byte *src, float *dst, uint64_t pixelCount)
+{
+	const float *table = getSrgbTable().values;
+	const __m256 inv255 = _mm256_set1_ps(1.0f / 255.0f);
+
+	uint64_t i = 0;
+
+	for (; i + 2 <= pixelCount; i += 2)
+	{
+		__m256i indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(src + i*4)));
+
+		__m256 colour = _mm256_i32gather_ps(table, indices, 4);
+		__m256 alpha = _mm256_mul_ps(_mm256_cvtepi32_ps(indices), inv255);
+
+		_mm256_storeu_ps(dst + i*4, _mm256_blend_ps(colour, alpha, 0x88));
+	}
+
+	imageops::scalar::srgbToLinear(src + i*4, dst + i*4, pixelCount - i);
+}
+
+LLT_TARGET_AVX2
+static __m256i linearToSrgbPairAVX2(__m256 pixels)
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.0f);
+
+	pixels = _mm256_min_ps(_mm256_max_ps(pixels, zero), one);
+
+	__m256 s = _mm256_sqrt_ps(pixels);
+	__m256 t = _mm256_sqrt_ps(s);
+	__m256 u = _mm256_sqrt_ps(t);
+
+	__m256 curve = _mm256_mul_ps(_mm256_set1_ps(0.662002687f), s);
+	curve = _mm256_add_ps(curve, _mm256_mul_ps(_mm256_set1_ps(0.684122060f), t));
+	curve = _mm256_sub_ps(curve, _mm256_mul_ps(_mm256_set1_ps(0.323583601f), u));
+	curve = _mm256_sub_ps(curve, _mm256_mul_ps(_mm256_set1_ps(0.0225411470f), pixels));
+
+	__m256 linear = _mm256_mul_ps(pixels, _mm256_set1_ps(12.92f));
+
+	__m256 encoded = _mm256_blendv_ps(curve, linear, _mm256_cmp_ps(pixels, _mm256_set1_ps(SRGB_LINEAR_THRESHOLD), _CMP_LE_OQ));
+	encoded = _mm256_min_ps(_mm256_max_ps(encoded, zero), one);
+	encoded = _mm256_blend_ps(encoded, pixels, 0x88);
+
+	return _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(encoded, _mm256_set1_ps(255.0f)), _mm256_set1_ps(0.5f)));
+}
+
+LLT_TARGET_AVX2
+static void linearToSrgbAVX2(const float *src, byte *dst, uint64_t pixelCount)
+{
+	// the packs work within each 128-bit lane, this puts the pixels back in order afterwards
+	const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+	uint64_t i = 0;
+
+	for (; i + 8 <= pixelCount; i += 8)
+	{
+		__m256i p01 = linearToSrgbPairAVX2(_mm256_loadu_ps(src + i*4 + 0));
+		__m256i p23 = linearToSrgbPairAVX2(_mm256_loadu_ps(src + i*4 + 8));
+		__m256i p45 = linearToSrgbPairAVX2(_mm256_loadu_ps(src + i*4 + 16));
+		__m256i p67 = linearToSrgbPairAVX2(_mm256_loadu_ps(src + i*4 + 24));
+
+		__m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(p01, p23), _mm256_packs_epi32(p45, p67));
+
+		_mm256_storeu_si256((__m256i *)(dst + i*4), _mm256_permutevar8x32_epi32(packed, order));
+	}
+
+	linearToSrgbSSE(src + i*4, dst + i*4, pixelCount - i);
+}
+
+LLT_TARGET_AVX2
+static __m256i premultiplyHalfAVX2(__m256i channels)
+{
+	__m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(channels, 0xFF), 0xFF);
+	__m256i t = _mm256_add_epi16(_mm256_mullo_epi16(channels, alpha), _mm256_set1_epi16(128));
+
+	return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+LLT_TARGET_AVX2
+static void premultiplyAlphaAVX2(byte *pixels, uint64_t pixelCount)
+{
+	const __m256i rgbMask = _mm256_set1_epi32(0x00FFFFFF);
+
+	uint64_t i = 0;
+
+	for (; i + 8 <= pixelCount; i += 8)
+	{
+		__m256i px = _mm256_loadu_si256((const __m256i *)(pixels + i*4));
+
+		__m256i lo = premultiplyHalfAVX2(_mm256_unpacklo_epi8(px, _mm256_setzero_si256()));
+		__m256i hi = premultiplyHalfAVX2(_mm256_unpackhi_epi8(px, _mm256_setzero_si256()));
+
+		__m256i result = _mm256_blendv_epi8(px, _mm256_packus_epi16(lo, hi), rgbMask);
+
+		_mm256_storeu_si256((__m256i *)(pixels + i*4), result);
+	}
+
+	premultiplyAlphaSSE(pixels + i*4, pixelCount - i);
+}
+
+LLT_TARGET_AVX2
+static void premultiplyAlphaFloatAVX2(float *pixels, uint64_t pixelCount)
+{
+	uint64_t i = 0;
+
+	for (; i + 2 <= pixelCount; i += 2)
+	{
+		__m256 px = _mm256_loadu_ps(pixels + i*4);
+		__m256 alpha = _mm256_permute_ps(px, 0xFF);
+
+		_mm256_storeu_ps(pixels + i*4, _mm256_blend_ps(_mm256_mul_ps(px, alpha), px, 0x88));
+	}
+
+	premultiplyAlphaFloatSSE(pixels + i*4, pixelCount - i);
+}
+
+LLT_TARGET_AVX2
+static void packHalfAVX2(const float *src, uint16_t *dst, uint64_t pixelCount)
+{
+	uint64_t i = 0;
+
+	for (; i + 2 <= pixelCount; i += 2)
+	{
+		__m128i halves = _mm256_cvtps_ph(_mm256_loadu_ps(src + i*4), _MM_FROUND_TO_NEAREST_INT);
+		_mm_storeu_si128((__m128i *)(dst + i*4), halves);
+	}
+
+	imageops::scalar::packHalf(src + i*4, dst + i*4, pixelCount - i);
+}
+
+LLT_TARGET_AVX2
+static void packRGB9E5AVX2(const float *src, uint32_t *dst, uint64_t pixelCount)
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 maxValue = _mm256_set1_ps(RGB9E5_MAX);
+	const __m256 half = _mm256_set1_ps(0.5f);
+
+	uint64_t i = 0;
+
+	for (; i + 8 <= pixelCount; i += 8)
+	{
+		// pixels 0-3 in the low lanes and 4-7 in the high ones, so the shuffles below transpose both halves at once
+		__m256 p0 = loadPixelPairAVX2(src + i*4 + 0, src + i*4 + 16);
+		__m256 p1 = loadPixelPairAVX2(src + i*4 + 4, src + i*4 + 20);
+		__m256 p2 = loadPixelPairAVX2(src + i*4 + 8, src + i*4 + 24);
+		__m256 p3 = loadPixelPairAVX2(src + i*4 + 12, src + i*4 + 28);
+
+		__m256 t0 = _mm256_unpacklo_ps(p0, p1);
+		__m256 t1 = _mm256_unpacklo_ps(p2, p3);
+		__m256 t2 = _mm256_unpackhi_ps(p0, p1);
+		__m256 t3 = _mm256_unpackhi_ps(p2, p3);
+
+		__m256 r = _mm256_min_ps(_mm256_max_ps(_mm256_shuffle_ps(t0, t1, 0x44), zero), maxValue);
+		__m256 g = _mm256_min_ps(_mm256_max_ps(_mm256_shuffle_ps(t0, t1, 0xEE), zero), maxValue);
+		__m256 b = _mm256_min_ps(_mm256_max_ps(_mm256_shuffle_ps(t2, t3, 0x44), zero), maxValue);
+
+		__m256 maxChannel = _mm256_max_ps(r, _mm256_max_ps(g, b));
+
+		__m256i exponent = _mm256_sub_epi32(_mm256_srli_epi32(_mm256_castps_si256(maxChannel), 23), _mm256_set1_epi32(127));
+		exponent = _mm256_add_epi32(_mm256_max_epi32(exponent, _mm256_set1_epi32(-16)), _mm256_set1_epi32(16));
+
+		__m256 scale = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_sub_epi32(_mm256_set1_epi32(127 + 24), exponent), 23));
+
+		__m256i maxMantissa = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(maxChannel, scale), half));
+
+		exponent = _mm256_sub_epi32(exponent, _mm256_cmpeq_epi32(maxMantissa, _mm256_set1_epi32(512)));
+		scale = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_sub_epi32(_mm256_set1_epi32(127 + 24), exponent), 23));
+
+		__m256i ri = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(r, scale), half));
+		__m256i gi = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(g, scale), half));
+		__m256i bi = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(b, scale), half));
+
+		__m256i packed = _mm256_or_si256(
+			_mm256_or_si256(ri, _mm256_slli_epi32(gi, 9)),
+			_mm256_or_si256(_mm256_slli_epi32(bi, 18), _mm256_slli_epi32(exponent, 27))
+		);
+
+		_mm256_storeu_si256((__m256i *)(dst + i), packed);
+	}
+
+	packRGB9E5SSE(src + i*4, dst + i, pixelCount - i);
+}
+
+LLT_TARGET_AVX2
+static void swizzleAVX2(const byte *src, byte *dst, uint64_t pixelCount, const int channels[4])
+{
+	byte shuffleBytes[16], onesBytes[16];
+	buildSwizzleMasks(channels, shuffleBytes, onesBytes);
+
+	// the shuffle works within each 128-bit lane, so the same mask goes in both
+	__m256i shuffle = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)shuffleBytes));
+	__m256i ones = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)onesBytes));
+
+	uint64_t i = 0;
+
+	for (; i + 8 <= pixelCount; i += 8)
+	{
+		__m256i px = _mm256_loadu_si256((const __m256i *)(src + i*4));
+		_mm256_storeu_si256((__m256i *)(dst + i*4), _mm256_or_si256(_mm256_shuffle_epi8(px, shuffle), ones));
+	}
+
+	swizzleSSE(src + i*4, dst + i*4, pixelCount - i, channels);
+}
+
+LLT_TARGET_AVX2
+static void packChannelsAVX2(const imageops::ChannelSource sources[4], byte *dst, uint64_t pixelCount)
+{
+	byte shuffleBytes[4][16], fillBytes[16];
+	buildPackMasks(sources, shuffleBytes, fillBytes);
+
+	__m256i shuffles[4];
+
+	for (int s = 0; s < 4; s++) {
+		shuffles[s] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)shuffleBytes[s]));
+	}
+
+	__m256i fill = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)fillBytes));
+
+	uint64_t i = 0;
+
+	for (; i + 8 <= pixelCount; i += 8)
+	{
+		__m256i result = fill;
+
+		for (int s = 0; s < 4; s++)
+		{
+			if (sources[s].pixels) {
+				result = _mm256_or_si256(result, _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)(sources[s].pixels + i*4)), shuffles[s]));
+			}
+		}
+
+		_mm256_storeu_si256((__m256i *)(dst + i*4), result);
+	}
+
+	imageops::ChannelSource rest[4];
+
+	for (int s = 0; s < 4; s++)
+	{
+		rest[s] = sources[s];
+		rest[s].pixels = sources[s].pixels ? sources[s].pixels + i*4 : nullptr;
+	}
+
+	packChannelsSSE(rest, dst + i*4, pixelCount - i);
+}
+
+LLT_TARGET_AVX2
+static void calcSH9BasisAVX2(__m256 x, __m256 y, __m256 z, __m256 basis[9])
+{
+	__m256 band1 = _mm256_set1_ps(SH_BAND1);
+	__m256 band2 = _mm256_set1_ps(SH_BAND2);
+
+	basis[0] = _mm256_set1_ps(SH_BAND0);
+	basis[1] = _mm256_mul_ps(band1, y);
+	basis[2] = _mm256_mul_ps(band1, z);
+	basis[3] = _mm256_mul_ps(band1, x);
+	basis[4] = _mm256_mul_ps(_mm256_mul_ps(band2, x), y);
+	basis[5] = _mm256_mul_ps(_mm256_mul_ps(band2, y), z);
+	basis[6] = _mm256_mul_ps(_mm256_set1_ps(SH_BAND2_ZZ), _mm256_sub_ps(_mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(3.0f), z), z), _mm256_set1_ps(1.0f)));
+	basis[7] = _mm256_mul_ps(_mm256_mul_ps(band2, x), z);
+	basis[8] = _mm256_mul_ps(_mm256_set1_ps(SH_BAND2_XX_YY), _mm256_sub_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)));
+}
+
+/*
+ * Eight texels of a row at a time, as two sse transposes glued together.
+ */
+LLT_TARGET_AVX2
+static void projectSH9AVX2(const float *src, uint32_t size, uint32_t face, float *sh)
+{
+	const float (*axes)[3] = CUBE_FACE_AXES[face];
+
+	float invSize = 1.0f / (float)size;
+	float texelArea = 4.0f * invSize * invSize;
+
+	__m256 acc[28];
+
+	for (int i = 0; i < 28; i++) {
+		acc[i] = _mm256_setzero_ps();
+	}
+
+	__m256 one = _mm256_set1_ps(1.0f);
+	__m256 invSizes = _mm256_set1_ps(invSize);
+	__m256 texelAreas = _mm256_set1_ps(texelArea);
+	__m256 offsets = _mm256_setr_ps(1.0f, 3.0f, 5.0f, 7.0f, 9.0f, 11.0f, 13.0f, 15.0f);
+
+	for (uint32_t y = 0; y < size; y++)
+	{
+		float t = (2.0f * y + 1.0f) * invSize - 1.0f;
+
+		const float *row = src + (uint64_t)y * size * 4;
+
+		uint32_t x = 0;
+
+		for (; x + 8 <= size; x += 8)
+		{
+			__m256 s = _mm256_sub_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_set1_ps(2.0f * x), offsets), invSizes), one);
+
+			__m256 lengthSq = _mm256_add_ps(_mm256_add_ps(one, _mm256_mul_ps(s, s)), _mm256_set1_ps(t*t));
+			__m256 invLength = _mm256_div_ps(one, _mm256_sqrt_ps(lengthSq));
+			__m256 weight = _mm256_div_ps(_mm256_mul_ps(texelAreas, invLength), lengthSq);
+
+			__m256 dir[3];
+
+			for (int c = 0; c < 3; c++) {
+				dir[c] = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_set1_ps(axes[0][c]), _mm256_mul_ps(s, _mm256_set1_ps(axes[1][c]))), _mm256_set1_ps(t*axes[2][c])), invLength);
+			}
+
+			__m256 basis[9];
+			calcSH9BasisAVX2(dir[0], dir[1], dir[2], basis);
+
+			__m128 r0 = _mm_loadu_ps(row + (x + 0)*4);
+			__m128 g0 = _mm_loadu_ps(row + (x + 1)*4);
+			__m128 b0 = _mm_loadu_ps(row + (x + 2)*4);
+			__m128 a0 = _mm_loadu_ps(row + (x + 3)*4);
+
+			__m128 r1 = _mm_loadu_ps(row + (x + 4)*4);
+			__m128 g1 = _mm_loadu_ps(row + (x + 5)*4);
+			__m128 b1 = _mm_loadu_ps(row + (x + 6)*4);
+			__m128 a1 = _mm_loadu_ps(row + (x + 7)*4);
+
+			_MM_TRANSPOSE4_PS(r0, g0, b0, a0);
+			_MM_TRANSPOSE4_PS(r1, g1, b1, a1);
+
+			__m256 r = _mm256_set_m128(r1, r0);
+			__m256 g = _mm256_set_m128(g1, g0);
+			__m256 b = _mm256_set_m128(b1, b0);
+
+			for (int i = 0; i < 9; i++)
+			{
+				__m256 basisWeight = _mm256_mul_ps(basis[i], weight);
+
+				acc[i*3 + 0] = _mm256_add_ps(acc[i*3 + 0], _mm256_mul_ps(r, basisWeight));
+				acc[i*3 + 1] = _mm256_add_ps(acc[i*3 + 1], _mm256_mul_ps(g, basisWeight));
+				acc[i*3 + 2] = _mm256_add_ps(acc[i*3 + 2], _mm256_mul_ps(b, basisWeight));
+			}
+
+			acc[27] = _mm256_add_ps(acc[27], weight);
+		}
+
+		for (; x < size; x++)
+		{
+			float s = (2.0f * x + 1.0f) * invSize - 1.0f;
+
+			projectSH9Texel(row + x*4, face, s, t, texelArea, sh);
+		}
+	}
+
+	for (int i = 0; i < 28; i++)
+	{
+		float lanes[8];
+		_mm256_storeu_ps(lanes, acc[i]);
+
+		sh[i] += ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+	}
+}
+
+#endif // LLT_IMAGE_OPS_X86
+
+// ---
+
+imageops::SimdLevel imageops::getSupportedSimdLevel()
+{
+	static SimdLevel supported = []() -> SimdLevel
+	{
+#if defined(LLT_IMAGE_OPS_X86)
+
+#if defined(_MSC_VER) && !defined(__clang__)
+		int info[4] = {};
+
+		__cpuid(info, 0);
+		int maxLeaf = info[0];
+
+		__cpuid(info, 1);
+
+		bool ssse3 = (info[2] & (1 << 9)) != 0;
+		bool f16c = (info[2] & (1 << 29)) != 0;
+
+		// the os has to be saving the ymm registers as well as the cpu having avx
+		bool avx = (info[2] & (1 << 28)) != 0 && (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+		bool avx2 = false;
+
+		if (avx && maxLeaf >= 7)
+		{
+			__cpuidex(info, 7, 0);
+			avx2 = (info[1] & (1 << 5)) != 0;
+		}
+#else
+		__builtin_cpu_init();
+
+		bool ssse3 = __builtin_cpu_supports("ssse3");
+		bool avx2 = __builtin_cpu_supports("avx2");
+
+		unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+		bool f16c = __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_F16C) != 0;
+#endif
+
+		if (avx2 && f16c) {
+			return SIMD_LEVEL_AVX2;
+		}
+
+		if (ssse3) {
+			return SIMD_LEVEL_SSE;
+		}
+#endif // LLT_IMAGE_OPS_X86
+
+		return SIMD_LEVEL_SCALAR;
+	}();
+
+	return supported;
+}
+
+imageops::SimdLevel imageops::getSimdLevel()
+{
+	SimdLevel supported = getSupportedSimdLevel();
+	return g_simdLevelCap < supported ? g_simdLevelCap : supported;
+}
+
+void imageops::setSimdLevel(SimdLevel level)
+{
+	g_simdLevelCap = level;
+}
+
+const char *imageops::getSimdLevelName(SimdLevel level)
+{
+	switch (level)
+	{
+		case SIMD_LEVEL_SCALAR:
+			return "scalar";
+
+		case SIMD_LEVEL_SSE:
+			return "sse";
+
+		case SIMD_LEVEL_AVX2:
+			return "avx2";
+
+		default:
+			return "unknown";
+	}
+}
+
+void imageops::downsample(const float *src, uint32_t srcWidth, uint32_t srcHeight, float *dst, DownsampleFilter filter)
+{
+#if defined(LLT_IMAGE_OPS_X86)
+	switch (getSimdLevel())
+	{
+		case SIMD_LEVEL_AVX2:
+			filter == DOWNSAMPLE_FILTER_BOX ? downsampleBoxAVX2(src, srcWidth, srcHeight, dst) : downsampleKaiserAVX2(src, srcWidth, srcHeight, dst);
+			return;
+
+		case SIMD_LEVEL_SSE:
+			filter == DOWNSAMPLE_FILTER_BOX ? downsampleBoxSSE(src, srcWidth, srcHeight, dst) : downsampleKaiserSSE(src, srcWidth, srcHeight, dst);
+			return;
+
+		default:
+			break;
+	}
+#endif // LLT_IMAGE_OPS_X86
+
+	scalar::downsample(src, srcWidth, srcHeight, dst, filter);
+}
+
+void imageops::srgbToLinear(const byte *src, float *dst, uint64_t pixelCount)
+{
+	// without a gather there's nothing to gain over the table lookups, so sse stays scalar
+#if defined(LLT_IMAGE_OPS_X86)
+	if (getSimdLevel() == SIMD_LEVEL_AVX2)
+	{
+		srgbToLinearAVX2(src, dst, pixelCount);
+		return;
+	}
+#endif // LLT_IMAGE_OPS_X86
+
+	scalar::srgbToLinear(src, dst, pixelCount);
+}
+
+void imageops::linearToSrgb(const float *src, byte *dst, uint64_t pixelCount)
+{
+#if defined(LLT_IMAGE_OPS_X86)
+	switch (getSimdLevel())
+	{
+		case SIMD_LEVEL_AVX2:
+			linearToSrgbAVX2(src, dst, pixelCount);
+			return;
+
+		case SIMD_LEVEL_SSE:
+			linearToSrgbSSE(src, dst, pixelCount);
+			return;
+
+		default:
+			break;
+	}
+#endif // LLT_IMAGE_OPS_X86
+
+	scalar::linearToSrgb(src, dst, pixelCount);
+}
+
+void imageops::premultiplyAlpha(byte *pixels, uint64_t pixelCount)
+{
+#if defined(LLT_IMAGE_OPS_X86)
+	switch (getSimdLevel())
+	{
+		case SIMD_LEVEL_AVX2:
+			premultiplyAlphaAVX2(pixels, pixelCount);
+			return;
+
+		case SIMD_LEVEL_SSE:
+			premultiplyAlphaSSE(pixels, pixelCount);
+			return;
+
+		default:
+			break;
+	}
+#endif // LLT_IMAGE_OPS_X86
+
+	scalar::premultiplyAlpha(pixels, pixelCount);
+}
+
+void imageops::premultiplyAlpha(float *pixels, uint64_t pixelCount)
+{
+#if defined(LLT_IMAGE_OPS_X86)
+	switch (getSimdLevel())
+	{
+		case SIMD_LEVEL_AVX2:
+			premultiplyAlphaFloatAVX2(pixels, pixelCount);
+			return;
+
+		case SIMD_LEVEL_SSE:
+			premultiplyAlphaFloatSSE(pixels, pixelCount);
+			return;
+
+		default:
+			break;
+	}
+#endif // LLT_IMAGE_OPS_X86
+
+	scalar::premultiplyAlpha(pixels, pixelCount);
+}
+
+void imageops::packHalf(const float *src, uint16_t *dst, uint64_t pixelCount)
+{
+#if defined(LLT_IMAGE_OPS_X86)
+	switch (getSimdLevel())
+	{
+		case SIMD_LEVEL_AVX2:
+			packHalfAVX2(src, dst, pixelCount);
+			return;
+
+		case SIMD_LEVEL_SSE:
+			packHalfSSE(src, dst, pixelCount);
+			return;
+
+		default:
+			break;
+	}
+#endif // LLT_IMAGE_OPS_X86
+
+	scalar::packHalf(src, dst, pixelCount);
+}
+
+void imageops::packRGB9E5(const float *src, uint32_t *dst, uint64_t pixelCount)
+{
+#if defined(LLT_IMAGE_OPS_X86)
+	switch (getSimdLevel())
+	{
+		case SIMD_LEVEL_AVX2:
+			packRGB9E5AVX2(src, dst, pixelCount);
+			return;
+
+		case SIMD_LEVEL_SSE:
+			packRGB9E5SSE(src, dst, pixelCount);
+			return;
+
+		default:
+			break;
+	}
+#endif // LLT_IMAGE_OPS_X86
+
+	scalar::packRGB9E5(src, dst, pixelCount);
+}
+
+void imageops::swizzle(const byte *src, byte *dst, uint64_t pixelCount, const int channels[4])
+{
+#if defined(LLT_IMAGE_OPS_X86)
+	switch (getSimdLevel())
+	{
+		case SIMD_LEVEL_AVX2:
+			swizzleAVX2(src, dst, pixelCount, channels);
+			return;
+
+		case SIMD_LEVEL_SSE:
+			swizzleSSE(src, dst, pixelCount, channels);
+			return;
+
+		default:
+			break;
+	}
+#endif // LLT_IMAGE_OPS_X86
+
+	scalar::swizzle(src, dst, pixelCount, channels);
+}
+
+void imageops::packChannels(const ChannelSource sources[4], byte *dst, uint64_t pixelCount)
+{
+#if defined(LLT_IMAGE_OPS_X86)
+	switch (getSimdLevel())
+	{
+		case SIMD_LEVEL_AVX2:
+			packChannelsAVX2(sources, dst, pixelCount);
+			return;
+
+		case SIMD_LEVEL_SSE:
+			packChannelsSSE(sources, dst, pixelCount);
+			return;
+
+		default:
+			break;
+	}
+#endif // LLT_IMAGE_OPS_X86
+
+	scalar::packChannels(sources, dst, pixelCount);
+}
+
+void imageops::projectSH9(const float *src, uint32_t size, uint32_t face, float *sh)
+{
+#if defined(LLT_IMAGE_OPS_X86)
+	switch (getSimdLevel())
+	{
+		case SIMD_LEVEL_AVX2:
+			projectSH9AVX2(src, size, face, sh);
+			return;
+
+		case SIMD_LEVEL_SSE:
+			projectSH9SSE(src, size, face, sh);
+			return;
+
+		default:
+			break;
+	}
+#endif // LLT_IMAGE_OPS_X86
+
+	scalar::projectSH9(src, size, face, sh);
+}
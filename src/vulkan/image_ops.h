@@ -0,0 +1,133 @@
+#ifndef IMAGE_OPS_H_
+#define IMAGE_OPS_H_
+
+#include "core/common.h"
+
+namespace llt
+{
+	/*
+	 * CPU pixel kernels for the cook and load paths.
+	 *
+	 * Everything works on tightly packed rgba pixels, either 8 bits or 32-bit floats per channel.
+	 * Each kernel has an sse (up to ssse3) and an avx2 version, picked at runtime from what the cpu supports,
+	 * and a plain scalar version in imageops::scalar that the others are checked against (see tools/image_bench).
+	 */
+	namespace imageops
+	{
+		enum SimdLevel
+		{
+			SIMD_LEVEL_SCALAR,
+			SIMD_LEVEL_SSE,
+			SIMD_LEVEL_AVX2,
+			SIMD_LEVEL_MAX_ENUM
+		};
+
+		enum DownsampleFilter
+		{
+			DOWNSAMPLE_FILTER_BOX,		// 2x2 average
+			DOWNSAMPLE_FILTER_KAISER	// 6x6 kaiser windowed sinc, sharper but can ring a little on hard edges
+		};
+
+		enum Channel
+		{
+			CHANNEL_R,
+			CHANNEL_G,
+			CHANNEL_B,
+			CHANNEL_A,
+			CHANNEL_ZERO,
+			CHANNEL_ONE
+		};
+
+		/*
+		 * One output channel of packChannels. Without pixels the channel is filled with the fill value instead.
+		 */
+		struct ChannelSource
+		{
+			const byte *pixels;
+			int channel;
+			byte fill;
+		};
+
+		/*
+		 * The best level the cpu supports, unless it's been lowered with setSimdLevel.
+		 */
+		SimdLevel getSimdLevel();
+		SimdLevel getSupportedSimdLevel();
+
+		/*
+		 * Caps the level the kernels use, anything above what the cpu supports is ignored.
+		 */
+		void setSimdLevel(SimdLevel level);
+
+		const char *getSimdLevelName(SimdLevel level);
+
+		/*
+		 * Halves an rgba float image (rounding down, never below 1), clamping at the edges.
+		 */
+		void downsample(const float *src, uint32_t srcWidth, uint32_t srcHeight, float *dst, DownsampleFilter filter);
+
+		/*
+		 * srgb encoded rgba8 to linear floats in [0, 1], alpha is only rescaled.
+		 */
+		void srgbToLinear(const byte *src, float *dst, uint64_t pixelCount);
+
+		/*
+		 * The other way, clamping to [0, 1]. The simd versions use a polynomial fit and can be a step off the exact curve.
+		 */
+		void linearToSrgb(const float *src, byte *dst, uint64_t pixelCount);
+
+		void premultiplyAlpha(byte *pixels, uint64_t pixelCount);
+		void premultiplyAlpha(float *pixels, uint64_t pixelCount);
+
+		/*
+		 * rgba32f to rgba16f, rounding to nearest even. Out of range values become infinity.
+		 */
+		void packHalf(const float *src, uint16_t *dst, uint64_t pixelCount);
+
+		/*
+		 * rgb32f to the shared exponent E5B9G9R9 format, alpha is dropped. Negatives and nans become zero.
+		 */
+		void packRGB9E5(const float *src, uint32_t *dst, uint64_t pixelCount);
+
+		/*
+		 * Rearranges the channels of rgba8 pixels, channels[i] being the Channel that ends up in channel i.
+		 * src and dst can be the same.
+		 */
+		void swizzle(const byte *src, byte *dst, uint64_t pixelCount, const int channels[4]);
+
+		/*
+		 * Builds rgba8 pixels out of a channel from each of four rgba8 images, e.g: ao/roughness/metal into orm.
+		 */
+		void packChannels(const ChannelSource sources[4], byte *dst, uint64_t pixelCount);
+
+		/*
+		 * Projects one face of a square rgba32f cubemap onto the first 9 real spherical harmonics, adding to sh:
+		 * the rgb of each coefficient in turn, then the total solid angle the texels covered.
+		 * Faces go +x, -x, +y, -y, +z, -z as in vulkan. Once every face is in, scaling by 4pi over
+		 * that total cancels out the error in the per-texel solid angles.
+		 * The simd versions sum in a different order, so they only match the scalar one to rounding.
+		 */
+		static constexpr int SH9_FLOAT_COUNT = 28;
+
+		void projectSH9(const float *src, uint32_t size, uint32_t face, float *sh);
+
+		/*
+		 * Reference implementations, always scalar whatever the simd level is.
+		 */
+		namespace scalar
+		{
+			void downsample(const float *src, uint32_t srcWidth, uint32_t srcHeight, float *dst, DownsampleFilter filter);
+			void srgbToLinear(const byte *src, float *dst, uint64_t pixelCount);
+			void linearToSrgb(const float *src, byte *dst, uint64_t pixelCount);
+			void premultiplyAlpha(byte *pixels, uint64_t pixelCount);
+			void premultiplyAlpha(float *pixels, uint64_t pixelCount);
+			void packHalf(const float *src, uint16_t *dst, uint64_t pixelCount);
+			void packRGB9E5(const float *src, uint32_t *dst, uint64_t pixelCount);
+			void swizzle(const byte *src, byte *dst, uint64_t pixelCount, const int channels[4]);
+			void packChannels(const ChannelSource sources[4], byte *dst, uint64_t pixelCount);
+			void projectSH9(const float *src, uint32_t size, uint32_t face, float *sh);
+		}
+	}
+}
+
+#endif // IMAGE_OPS_H_
@@ -130,6 +130,10 @@ PipelineData PipelineCache::fetchGraphicsPipeline(const GraphicsPipelineDefiniti
 		hash::combine(&createdPipelineHash, &definition.getShaderStage(i));
 	}
 
+	// a pipeline built for multiview can only be used inside a pass with the same view mask
+	uint32_t viewMask = renderInfo.getViewMask();
+	hash::combine(&createdPipelineHash, &viewMask);
+
 	if (m_pipelines.contains(createdPipelineHash))
 	{
 		VkPipelineLayout layout = fetchPipelineLayout(definition.getShader());
@@ -155,6 +159,7 @@ PipelineData PipelineCache::fetchGraphicsPipeline(const GraphicsPipelineDefiniti
 	pipelineRenderingCreateInfo.pColorAttachmentFormats = colourFormats.data();
 	pipelineRenderingCreateInfo.depthAttachmentFormat = depthStencilFormat;
 	pipelineRenderingCreateInfo.stencilAttachmentFormat = depthStencilFormat;
+	pipelineRenderingCreateInfo.viewMask = viewMask;
 
 	VkPipelineLayout layout = fetchPipelineLayout(definition.getShader());
 
@@ -13,6 +13,7 @@ RenderInfo::RenderInfo()
 	, m_width(0)
 	, m_height(0)
 	, m_samples(VK_SAMPLE_COUNT_1_BIT)
+	, m_viewMask(0)
 {
 }
 
@@ -28,6 +29,7 @@ VkRenderingInfo RenderInfo::getInfo() const
 	info.renderArea.offset = { 0, 0 };
 	info.renderArea.extent = { m_width, m_height };
 	info.layerCount = 1;
+	info.viewMask = m_viewMask;
 	info.colorAttachmentCount = m_colourAttachments.size();
 	info.pColorAttachments = m_colourAttachments.data();
 	info.pDepthAttachment = (m_depthAttachment.imageView != VK_NULL_HANDLE) ? &m_depthAttachment : nullptr;
@@ -176,3 +178,13 @@ uint32_t RenderInfo::getHeight() const
 {
 	return m_height;
 }
+
+void RenderInfo::setViewMask(uint32_t mask)
+{
+	m_viewMask = mask;
+}
+
+uint32_t RenderInfo::getViewMask() const
+{
+	return m_viewMask;
+}
@@ -20,6 +20,8 @@ namespace llt
 	 */
 	class RenderInfo
 	{
+		friend class FrameCapture;
+
 	public:
 		RenderInfo();
 		~RenderInfo();
@@ -54,6 +56,13 @@ namespace llt
 		uint32_t getWidth() const;
 		uint32_t getHeight() const;
 
+		/*
+		 * Renders every layer with a bit set in the mask in the same pass (multiview), each as a different SV_ViewID.
+		 * The attachments then need to be array views covering those layers. Zero is a normal single layer pass.
+		 */
+		void setViewMask(uint32_t mask);
+		uint32_t getViewMask() const;
+
 	private:
 		uint32_t m_width;
 		uint32_t m_height;
@@ -66,6 +75,8 @@ namespace llt
 		int m_attachmentCount;
 
 		VkSampleCountFlagBits m_samples;
+
+		uint32_t m_viewMask;
 	};
 }
 
@@ -0,0 +1,18 @@
+#include "render_stats.h"
+
+llt::RenderStats llt::g_renderStats = {};
+
+using namespace llt;
+
+static RenderStats g_lastFrame = {};
+
+void renderstats::endFrame()
+{
+	g_lastFrame = g_renderStats;
+	g_renderStats = {};
+}
+
+const RenderStats &renderstats::getLastFrame()
+{
+	return g_lastFrame;
+}
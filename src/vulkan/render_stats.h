@@ -0,0 +1,47 @@
+#ifndef RENDER_STATS_H_
+#define RENDER_STATS_H_
+
+#include "core/common.h"
+
+namespace llt
+{
+	/**
+	 * What a frame asked of the gpu, counted as the work is recorded.
+	 *
+	 * Every counter is a plain add on the main thread (the only one that talks to vulkan), so they're
+	 * left on in release too. Work recorded between two calls to renderstats::endFrame() counts towards
+	 * the same frame, uploads and waits outside of the renderer included.
+	 */
+	struct RenderStats
+	{
+		uint64_t drawCalls;
+		uint64_t instances;
+		uint64_t triangles;
+
+		uint64_t pipelineBinds;
+		uint64_t descriptorSetBinds;
+		uint64_t pushConstantBytes;
+
+		uint64_t barriers;
+		uint64_t submissions;
+		uint64_t fenceWaits;
+
+		// written from the host into gpu visible memory, staging copies and constant updates alike
+		uint64_t uploadBytes;
+	};
+
+	// the frame currently being recorded
+	extern RenderStats g_renderStats;
+
+	namespace renderstats
+	{
+		/*
+		 * Keeps what the frame recorded around for getLastFrame() and starts counting the next one.
+		 */
+		void endFrame();
+
+		const RenderStats &getLastFrame();
+	}
+}
+
+#endif // RENDER_STATS_H_
@@ -7,6 +7,7 @@ using namespace llt;
 ShaderProgram::ShaderProgram()
 	: m_stage()
 	, m_module(VK_NULL_HANDLE)
+	, m_codeHash(0)
 {
 }
 
@@ -36,6 +37,8 @@ void ShaderProgram::loadFromSource(const char *source, uint64_t size)
 		vkCreateShaderModule(g_vkCore->m_device, &moduleCreateInfo, nullptr, &m_module),
 		"Failed to create shader module"
 	);
+
+	m_codeHash = hash::calcBytes(0, source, size);
 }
 
 VkPipelineShaderStageCreateInfo ShaderProgram::getShaderStageCreateInfo() const
@@ -64,6 +67,11 @@ VkShaderModule ShaderProgram::getModule() const
 	return m_module;
 }
 
+uint64_t ShaderProgram::getCodeHash() const
+{
+	return m_codeHash;
+}
+
 // ---
 
 ShaderEffect::ShaderEffect()
@@ -107,3 +115,16 @@ uint64_t ShaderEffect::getPushConstantsSize() const
 {
 	return m_pushConstantsSize;
 }
+
+uint64_t ShaderEffect::getCodeHash() const
+{
+	uint64_t result = 0;
+
+	for (auto *stage : m_stages)
+	{
+		uint64_t stageHash = stage->getCodeHash();
+		hash::combine(&result, &stageHash);
+	}
+
+	return result;
+}
@@ -31,9 +31,13 @@ namespace llt
 
 		VkShaderModule getModule() const;
 
+		// of the spir-v it was made from, so anything built with it can tell when the shader changes
+		uint64_t getCodeHash() const;
+
 	private:
 		VkShaderStageFlagBits m_stage;
 		VkShaderModule m_module;
+		uint64_t m_codeHash;
 	};
 
 	class ShaderEffect
@@ -53,6 +57,9 @@ namespace llt
 		void setPushConstantsSize(uint64_t size);
 		uint64_t getPushConstantsSize() const;
 
+		// combines the code hashes of every stage
+		uint64_t getCodeHash() const;
+
 	private:
 		Vector<ShaderProgram *> m_stages;
 
@@ -1,8 +1,11 @@
 #include "texture.h"
 
+#include <utility>
+
 #include "math/calc.h"
 
 #include "rendering/bindless_resource_mgr.h"
+#include "rendering/mip_generator.h"
 
 #include "core.h"
 #include "util.h"
@@ -16,6 +19,8 @@ Texture::Texture()
 	, m_imageLayout(VK_IMAGE_LAYOUT_UNDEFINED)
 	, m_mipmapCount(1)
 	, m_viewCache()
+	, m_storageViewCache()
+	, m_layeredAttachmentViewCache()
 	, m_numSamples(VK_SAMPLE_COUNT_1_BIT)
 	, m_transient(false)
 	, m_stage(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT)
@@ -24,6 +29,7 @@ Texture::Texture()
 	, m_format()
 	, m_tiling()
 	, m_type()
+	, m_usage(0)
 	, m_width(0)
 	, m_height(0)
 	, m_depth(1)
@@ -52,10 +58,29 @@ void Texture::cleanUp()
 
 	m_viewCache.clear();
 
+	for (auto &[id, view] : m_storageViewCache)
+	{
+		view.cleanUp();
+	}
+
+	m_storageViewCache.clear();
+
+	for (auto &[id, view] : m_layeredAttachmentViewCache)
+	{
+		view.cleanUp();
+	}
+
+	m_layeredAttachmentViewCache.clear();
+
+	if (g_mipGenerator) {
+		g_mipGenerator->release(this);
+	}
+
 	m_imageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 	m_format = VK_FORMAT_MAX_ENUM;
 	m_tiling = VK_IMAGE_TILING_MAX_ENUM;
 	m_type = VK_IMAGE_VIEW_TYPE_MAX_ENUM;
+	m_usage = 0;
 	m_width = 0;
 	m_height = 0;
 	m_mipmapCount = 0;
@@ -121,16 +146,34 @@ void Texture::createInternalResources()
 		createInfo.usage |= VK_IMAGE_USAGE_STORAGE_BIT;
 	}
 
+	// lets the mip chain be generated in compute rather than blitted level by level
+	if (!m_transient && m_mipmapCount > 1 && m_numSamples == VK_SAMPLE_COUNT_1_BIT && !vkutil::isBlockCompressed(m_format) && !vkutil::hasStencilComponent(m_format))
+	{
+		VkFormatProperties formatProperties = {};
+		vkGetPhysicalDeviceFormatProperties(g_vkCore->m_physicalData.device, vkutil::getLinearFormat(m_format), &formatProperties);
+
+		if (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT) {
+			createInfo.usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+		}
+	}
+
+	// srgb formats can't be written to from compute, so those writes go through a unorm view instead
+	if ((createInfo.usage & VK_IMAGE_USAGE_STORAGE_BIT) && vkutil::isSRGB(m_format)) {
+		createInfo.flags |= VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT | VK_IMAGE_CREATE_EXTENDED_USAGE_BIT;
+	}
+
 	if (vkutil::hasStencilComponent(m_format)) {
 		createInfo.usage |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
-	} else {
-		createInfo.usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+	} else if (vkutil::isRenderable(m_format)) {
+		createInfo.usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT; // compressed and some packed formats (e.g: E5B9G9R9) can't be rendered to
 	}
 
 	if (m_type == VK_IMAGE_VIEW_TYPE_CUBE) {
 		createInfo.flags |= VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
 	}
 
+	m_usage = createInfo.usage;
+
 	VmaAllocationCreateInfo vmaAllocInfo = {};
 	vmaAllocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
 	vmaAllocInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
@@ -141,6 +184,31 @@ void Texture::createInternalResources()
 	);
 }
 
+void Texture::swapResources(Texture &other)
+{
+	LLT_ASSERT(m_format == other.m_format, "Can't swap resources between textures of different formats.");
+
+	std::swap(m_image, other.m_image);
+	std::swap(m_allocation, other.m_allocation);
+	std::swap(m_allocationInfo, other.m_allocationInfo);
+	std::swap(m_imageLayout, other.m_imageLayout);
+	std::swap(m_stage, other.m_stage);
+	std::swap(m_viewCache, other.m_viewCache);
+	std::swap(m_storageViewCache, other.m_storageViewCache);
+	std::swap(m_layeredAttachmentViewCache, other.m_layeredAttachmentViewCache);
+	std::swap(m_usage, other.m_usage);
+	std::swap(m_width, other.m_width);
+	std::swap(m_height, other.m_height);
+	std::swap(m_mipmapCount, other.m_mipmapCount);
+
+	// descriptor sets written against either image are stale now
+	if (g_mipGenerator)
+	{
+		g_mipGenerator->release(this);
+		g_mipGenerator->release(&other);
+	}
+}
+
 TextureView Texture::getStandardView()
 {
 	return getView(getLayerCount(), 0, 0);
@@ -189,6 +257,15 @@ TextureView Texture::getView(int layerCount, int layer, int baseMipLevel)
 	viewCreateInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
 	viewCreateInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
 
+	// the srgb format itself can't be used for storage, so leave that usage to the storage views
+	VkImageViewUsageCreateInfo usageCreateInfo = {};
+	usageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO;
+	usageCreateInfo.usage = m_usage & ~VK_IMAGE_USAGE_STORAGE_BIT;
+
+	if (hasStorageUsage() && vkutil::isSRGB(m_format)) {
+		viewCreateInfo.pNext = &usageCreateInfo;
+	}
+
 	VkImageView view = {};
 
 	LLT_VK_CHECK(
@@ -215,6 +292,103 @@ TextureView Texture::getView(int layerCount, int layer, int baseMipLevel)
 	return textureView;
 }
 
+TextureView Texture::getStorageView(int mipLevel)
+{
+	uint64_t hash = mipLevel;
+
+	if (m_storageViewCache.contains(hash))
+	{
+		return m_storageViewCache[hash];
+	}
+
+	VkFormat format = vkutil::getLinearFormat(m_format);
+
+	VkImageViewCreateInfo viewCreateInfo = {};
+	viewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewCreateInfo.image = m_image;
+	viewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+	viewCreateInfo.format = format;
+
+	viewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	viewCreateInfo.subresourceRange.baseMipLevel = mipLevel;
+	viewCreateInfo.subresourceRange.levelCount = 1;
+	viewCreateInfo.subresourceRange.baseArrayLayer = 0;
+	viewCreateInfo.subresourceRange.layerCount = getLayerCount();
+
+	viewCreateInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+	viewCreateInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+	viewCreateInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+	viewCreateInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+
+	VkImageView view = {};
+
+	LLT_VK_CHECK(
+		vkCreateImageView(g_vkCore->m_device, &viewCreateInfo, nullptr, &view),
+		"Failed to create texture storage view."
+	);
+
+	TextureView textureView(view, format);
+
+	m_storageViewCache.insert(
+		hash,
+		textureView
+	);
+
+	return textureView;
+}
+
+TextureView Texture::getLayeredAttachmentView(int mipLevel)
+{
+	uint64_t hash = mipLevel;
+
+	if (m_layeredAttachmentViewCache.contains(hash))
+	{
+		return m_layeredAttachmentViewCache[hash];
+	}
+
+	VkImageViewCreateInfo viewCreateInfo = {};
+	viewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewCreateInfo.image = m_image;
+	viewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+	viewCreateInfo.format = m_format;
+
+	viewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	viewCreateInfo.subresourceRange.baseMipLevel = mipLevel;
+	viewCreateInfo.subresourceRange.levelCount = 1;
+	viewCreateInfo.subresourceRange.baseArrayLayer = 0;
+	viewCreateInfo.subresourceRange.layerCount = getLayerCount();
+
+	viewCreateInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+	viewCreateInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+	viewCreateInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+	viewCreateInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+
+	// same as the sampled views, an srgb format can't take the storage usage along with it
+	VkImageViewUsageCreateInfo usageCreateInfo = {};
+	usageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO;
+	usageCreateInfo.usage = m_usage & ~VK_IMAGE_USAGE_STORAGE_BIT;
+
+	if (hasStorageUsage() && vkutil::isSRGB(m_format)) {
+		viewCreateInfo.pNext = &usageCreateInfo;
+	}
+
+	VkImageView view = {};
+
+	LLT_VK_CHECK(
+		vkCreateImageView(g_vkCore->m_device, &viewCreateInfo, nullptr, &view),
+		"Failed to create texture layered attachment view."
+	);
+
+	TextureView textureView(view, m_format);
+
+	m_layeredAttachmentViewCache.insert(
+		hash,
+		textureView
+	);
+
+	return textureView;
+}
+
 void Texture::transitionLayoutSingle(VkImageLayout newLayout)
 {
 	CommandBuffer cmd = vkutil::beginSingleTimeCommands(g_vkCore->m_graphicsQueue.getCurrentFrame().commandPool);
@@ -246,18 +420,30 @@ void Texture::transitionLayout(CommandBuffer &cmd, VkImageLayout newLayout)
 
 // also transitions the texture into SHADER_READ_ONLY layout
 void Texture::generateMipmaps(CommandBuffer &cmd)
+{
+	if (g_mipGenerator && g_mipGenerator->generate(cmd, *this)) {
+		return;
+	}
+
+	// no compute path for this one, so fall back to blitting the chain
+	blitMipmaps(cmd);
+}
+
+void Texture::blitMipmaps(CommandBuffer &cmd)
 {
 	VkFormatProperties formatProperties = {};
 	vkGetPhysicalDeviceFormatProperties(g_vkCore->m_physicalData.device, m_format, &formatProperties);
 
+	VkFilter filter = VK_FILTER_LINEAR;
+
 	if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT))
 	{
-		LLT_ERROR("Texture image format doesn't support linear blitting.");
-		return;
+		LLT_LOG("Texture image format doesn't support linear blitting, mipmaps will be point sampled.");
+		filter = VK_FILTER_NEAREST;
 	}
 
 	cmd.transitionForMipmapGeneration(*this);
-	cmd.generateMipmaps(*this);
+	cmd.generateMipmaps(*this, filter);
 
 	m_imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL; // todo: this should be in the command buffer. also in general cmd.generateMipmaps is a bit of a mess
 }
@@ -315,6 +501,10 @@ void Texture::fromImage(const Image &image, VkImageViewType type, uint32_t mipLe
 			format = VK_FORMAT_R32G32B32A32_SFLOAT;
 			break;
 
+		case Image::Format::FORMAT_RGBA16F:
+			format = VK_FORMAT_R16G16B16A16_SFLOAT;
+			break;
+
 		default:
 			LLT_ERROR("Unknown image format encountered when creating texture from image: %d", image.getFormat());
 	}
@@ -390,6 +580,11 @@ void Texture::setUnorderedAccessView(bool uav)
 	m_isUAV = uav;
 }
 
+bool Texture::hasStorageUsage() const
+{
+	return (m_usage & VK_IMAGE_USAGE_STORAGE_BIT) != 0;
+}
+
 uint32_t Texture::getLayerCount() const
 {
 	return (m_type == VK_IMAGE_VIEW_TYPE_1D_ARRAY || m_type == VK_IMAGE_VIEW_TYPE_2D_ARRAY) ? m_depth : getFaceCount();
@@ -405,6 +600,11 @@ VkImage Texture::getImage() const
 	return m_image;
 }
 
+uint64_t Texture::getAllocationSize() const
+{
+	return m_image != VK_NULL_HANDLE ? m_allocationInfo.size : 0;
+}
+
 uint32_t Texture::getWidth() const
 {
 	return m_width;
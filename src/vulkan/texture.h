@@ -5,6 +5,7 @@
 #include "third_party/vk_mem_alloc.h"
 
 #include "core/common.h"
+#include "core/mem_tracker.h"
 
 #include "container/vector.h"
 #include "container/hash_map.h"
@@ -24,7 +25,7 @@ namespace llt
 		TEXTURE_PROPERTY_MAX_ENUM
 	};
 
-	class Texture
+	class Texture : public MemTagged<MEM_TAG_RENDERING>
 	{
 	public:
 		Texture();
@@ -45,6 +46,12 @@ namespace llt
 
 		void createInternalResources();
 
+		/*
+		 * Trades the image, its memory, views and dimensions with another texture of the same format.
+		 * Lets a texture be rebuilt at a different size while everything keeps pointing at the same Texture.
+		 */
+		void swapResources(Texture &other);
+
 		VkImageMemoryBarrier2 getBarrier() const;
 		VkImageMemoryBarrier2 getBarrier(VkImageLayout newLayout) const;
 		
@@ -52,6 +59,7 @@ namespace llt
 		void transitionLayoutSingle(VkImageLayout newLayout);
 
 		void generateMipmaps(CommandBuffer &cmd);
+		void blitMipmaps(CommandBuffer &cmd);
 
 		void setParent(RenderTarget *getParent);
 		const RenderTarget *getParent() const;
@@ -60,11 +68,19 @@ namespace llt
 		bool isUnorderedAccessView() const;
 		void setUnorderedAccessView(bool uav);
 
+		/*
+		 * Whether the image was created with storage usage, either because it's a uav or so its mips can be generated in compute.
+		 */
+		bool hasStorageUsage() const;
+
 		uint32_t getLayerCount() const;
 		uint32_t getFaceCount() const;
 
 		VkImage getImage() const;
 
+		// how much device memory the image actually took, including any padding the driver added
+		uint64_t getAllocationSize() const;
+
 		uint32_t getWidth() const;
 		uint32_t getHeight() const;
 
@@ -80,6 +96,18 @@ namespace llt
 		TextureView getStandardView();
 		TextureView getView(int layerCount, int layer, int baseMipLevel);
 
+		/*
+		 * Every layer of a single mip as a 2d array, in the linear format if this is an srgb texture.
+		 * For compute, so it isn't registered as a bindless texture.
+		 */
+		TextureView getStorageView(int mipLevel);
+
+		/*
+		 * Every layer of a single mip as a 2d array, for drawing into all of them in one multiview pass.
+		 * Only ever an attachment, so it isn't registered as a bindless texture either.
+		 */
+		TextureView getLayeredAttachmentView(int mipLevel);
+
 		VkPipelineStageFlags getStage() const;
 
 	private:
@@ -92,6 +120,8 @@ namespace llt
 		bool m_transient;
 
 		HashMap<uint64_t, TextureView> m_viewCache;
+		HashMap<uint64_t, TextureView> m_storageViewCache;
+		HashMap<uint64_t, TextureView> m_layeredAttachmentViewCache;
 
 		VkPipelineStageFlags m_stage;
 
@@ -101,6 +131,7 @@ namespace llt
 		VkFormat m_format;
 		VkImageTiling m_tiling;
 		VkImageViewType m_type;
+		VkImageUsageFlags m_usage;
 
 		uint32_t m_width;
 		uint32_t m_height;
@@ -1,6 +1,7 @@
 #include "util.h"
 
 #include "core.h"
+#include "render_stats.h"
 
 #include "core/platform.h"
 
@@ -106,6 +107,63 @@ bool vkutil::hasStencilComponent(VkFormat format)
 	return (format == VK_FORMAT_D32_SFLOAT_S8_UINT) || (format == VK_FORMAT_D24_UNORM_S8_UINT);
 }
 
+bool vkutil::isBlockCompressed(VkFormat format)
+{
+	return format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_BC7_SRGB_BLOCK;
+}
+
+bool vkutil::isSRGB(VkFormat format)
+{
+	return getLinearFormat(format) != format;
+}
+
+bool vkutil::isRenderable(VkFormat format)
+{
+	if (isBlockCompressed(format)) {
+		return false;
+	}
+
+	VkFormatProperties formatProperties = {};
+	vkGetPhysicalDeviceFormatProperties(g_vkCore->m_physicalData.device, format, &formatProperties);
+
+	return formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT;
+}
+
+VkFormat vkutil::getLinearFormat(VkFormat format)
+{
+	switch (format)
+	{
+		case VK_FORMAT_R8_SRGB:
+			return VK_FORMAT_R8_UNORM;
+
+		case VK_FORMAT_R8G8_SRGB:
+			return VK_FORMAT_R8G8_UNORM;
+
+		case VK_FORMAT_R8G8B8A8_SRGB:
+			return VK_FORMAT_R8G8B8A8_UNORM;
+
+		case VK_FORMAT_B8G8R8A8_SRGB:
+			return VK_FORMAT_B8G8R8A8_UNORM;
+
+		case VK_FORMAT_A8B8G8R8_SRGB_PACK32:
+			return VK_FORMAT_A8B8G8R8_UNORM_PACK32;
+
+		default:
+			return format;
+	}
+}
+
+uint32_t vkutil::calcMipLevels(uint32_t width, uint32_t height)
+{
+	uint32_t levels = 1;
+
+	while ((width | height) >> levels) {
+		levels++;
+	}
+
+	return levels;
+}
+
 CommandBuffer vkutil::beginSingleTimeCommands(VkCommandPool cmdPool)
 {
 	// first we allocate the command buffer then we begin recording onto the command buffer
@@ -150,6 +208,10 @@ void vkutil::endSingleTimeCommands(VkCommandPool cmdPool, const CommandBuffer &c
 	vkQueueSubmit(graphics, 1, &submitInfo, VK_NULL_HANDLE);
 	vkQueueWaitIdle(graphics);
 
+	// waiting on the whole queue is at least as bad as a fence, so it's counted as one
+	g_renderStats.submissions++;
+	g_renderStats.fenceWaits++;
+
 	vkFreeCommandBuffers(g_vkCore->m_device, cmdPool, 1, &cmdBuffer);
 }
 
@@ -265,9 +327,15 @@ uint32_t vkutil::assignPhysicalDeviceUsability(
 
 	// it must have the required extensions
 	if (hasRequiredExtensions) {
+		resultUsability += 1;
+	}
+
+	// no surface means we're headless, so there's no swapchain to worry about
+	if (surface == VK_NULL_HANDLE) {
+		adequateSwapChain = true;
+	} else if (hasRequiredExtensions) {
 		SwapChainSupportDetails swapChainSupportDetails = querySwapChainSupport(physicalDevice, surface);
 		adequateSwapChain = swapChainSupportDetails.surfaceFormats.any() && swapChainSupportDetails.presentModes.any();
-		resultUsability += 1;
 	}
 
 	// essential features must be satisfied
@@ -288,6 +356,9 @@ VkPipelineStageFlags vkutil::getTransferPipelineStageFlags(VkImageLayout layout)
 		case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
 			return VK_PIPELINE_STAGE_TRANSFER_BIT;
 
+		case VK_IMAGE_LAYOUT_GENERAL:
+			return VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
 		case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
 			return VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 
@@ -321,6 +392,9 @@ VkAccessFlags vkutil::getTransferAccessFlags(VkImageLayout layout)
 		case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
 			return VK_ACCESS_TRANSFER_WRITE_BIT;
 
+		case VK_IMAGE_LAYOUT_GENERAL:
+			return VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
 		case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
 			return VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
 
@@ -41,6 +41,13 @@ namespace llt
 #endif // LLT_MAC_SUPPORT
 		};
 
+		// the clock the cpu profiler reads, so gpu timestamps can be calibrated against it
+#if _WIN32
+		static constexpr VkTimeDomainEXT HOST_TIME_DOMAIN = VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT;
+#else
+		static constexpr VkTimeDomainEXT HOST_TIME_DOMAIN = VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+#endif // _WIN32
+
 		VkSurfaceFormatKHR chooseSwapSurfaceFormat(const Vector<VkSurfaceFormatKHR> &availableSurfaceFormats);
 		VkPresentModeKHR chooseSwapPresentMode(const Vector<VkPresentModeKHR> &availablePresentModes, bool enableVsync);
 		VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR &capabilities);
@@ -51,6 +58,17 @@ namespace llt
 		VkFormat findDepthFormat(VkPhysicalDevice device);
 
 		bool hasStencilComponent(VkFormat format);
+		bool isBlockCompressed(VkFormat format);
+		bool isSRGB(VkFormat format);
+
+		// whether the format can be a colour attachment with optimal tiling
+		bool isRenderable(VkFormat format);
+
+		// the unorm format an srgb one can be viewed as, since srgb formats can't be used for storage
+		VkFormat getLinearFormat(VkFormat format);
+
+		// every level down to 1x1
+		uint32_t calcMipLevels(uint32_t width, uint32_t height);
 
 		CommandBuffer beginSingleTimeCommands(VkCommandPool cmdPool);
 
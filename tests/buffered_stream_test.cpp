@@ -0,0 +1,262 @@
+#include "test.h"
+
+#include "io/buffered_stream.h"
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace llt;
+
+/*
+ * Growable in-memory stream, so the tests can read and write without going near the platform layer.
+ * Counts how often it gets read from so we can tell whether the buffering actually happened.
+ */
+class TestStream : public Stream
+{
+public:
+	TestStream(const std::string &contents = "")
+		: Stream()
+		, m_data(contents.begin(), contents.end())
+		, m_position(0)
+		, m_readCount(0)
+	{
+		p_stream = this;
+	}
+
+	void read(void *buffer, uint64_t length) const override
+	{
+		uint64_t count = std::min<uint64_t>(length, m_data.size() - m_position);
+
+		mem::copy(buffer, m_data.data() + m_position, count);
+
+		m_position += count;
+		m_readCount++;
+	}
+
+	void write(void *data, uint64_t length) const override
+	{
+		if (m_position + length > m_data.size()) {
+			m_data.resize(m_position + length);
+		}
+
+		mem::copy(m_data.data() + m_position, data, length);
+
+		m_position += length;
+	}
+
+	void seek(int64_t offset) const override
+	{
+		m_position = std::min<uint64_t>(offset < 0 ? 0 : offset, m_data.size());
+	}
+
+	void close() override
+	{
+		p_stream = nullptr;
+	}
+
+	int64_t position() const override
+	{
+		return m_position;
+	}
+
+	int64_t size() const override
+	{
+		return m_data.size();
+	}
+
+	std::string contents() const
+	{
+		return std::string(m_data.begin(), m_data.end());
+	}
+
+	mutable std::vector<char> m_data;
+	mutable uint64_t m_position;
+	mutable uint64_t m_readCount;
+};
+
+template <typename T>
+static void append(std::string &str, T value)
+{
+	str.append((const char *)&value, sizeof(T));
+}
+
+static void testTypedReads()
+{
+	std::string contents;
+
+	append<uint8_t>(contents, 0xAB);
+	append<uint16_t>(contents, 0xBEEF);
+	append<uint32_t>(contents, 0xDEADBEEF);
+	append<uint64_t>(contents, 0x0123456789ABCDEFull);
+	append<int32_t>(contents, -12345);
+	append<float>(contents, 1.5f);
+	append<double>(contents, -2.25);
+
+	TestStream source(contents);
+
+	// small enough that the values straddle refills
+	BufferedStream stream(source, 5);
+
+	LLT_CHECK(stream.size() == (int64_t)contents.size());
+
+	LLT_CHECK(stream.readU8() == 0xAB);
+	LLT_CHECK(stream.readU16() == 0xBEEF);
+	LLT_CHECK(stream.readU32() == 0xDEADBEEF);
+	LLT_CHECK(stream.readU64() == 0x0123456789ABCDEFull);
+	LLT_CHECK(stream.readI32() == -12345);
+	LLT_CHECK(stream.readF32() == 1.5f);
+	LLT_CHECK(stream.readF64() == -2.25);
+
+	LLT_CHECK(stream.position() == (int64_t)contents.size());
+	LLT_CHECK(stream.eof());
+
+	// reading past the end leaves the default value
+	LLT_CHECK(stream.readU32() == 0);
+}
+
+static void testSmallReadsAreBuffered()
+{
+	std::string contents;
+
+	for (uint32_t i = 0; i < 1024; i++) {
+		append<uint32_t>(contents, i);
+	}
+
+	TestStream source(contents);
+	BufferedStream stream(source, 1024);
+
+	bool allMatch = true;
+
+	for (uint32_t i = 0; i < 1024; i++) {
+		allMatch &= stream.readU32() == i;
+	}
+
+	LLT_CHECK(allMatch);
+
+	// 4kb through a 1kb buffer is four source reads, not a thousand
+	LLT_CHECK(source.m_readCount == 4);
+
+	// a read bigger than the buffer goes straight to the source
+	stream.seek(0);
+	source.m_readCount = 0;
+
+	std::vector<char> big(contents.size());
+	stream.read(big.data(), big.size());
+
+	LLT_CHECK(std::string(big.begin(), big.end()) == contents);
+	LLT_CHECK(source.m_readCount == 1);
+}
+
+static void testLineViews()
+{
+	TestStream source("first\nsecond\r\n\nthis one is longer than the buffer\nlast");
+
+	// smaller than the long line, so readLine has to grow the buffer to keep the view contiguous
+	BufferedStream stream(source, 8);
+
+	std::string_view line;
+
+	LLT_CHECK(stream.readLine(line) && line == "first");
+	LLT_CHECK(stream.readLine(line) && line == "second");
+	LLT_CHECK(stream.readLine(line) && line.empty());
+	LLT_CHECK(stream.readLine(line) && line == "this one is longer than the buffer");
+
+	// no newline at the very end still counts as a line
+	LLT_CHECK(stream.readLine(line) && line == "last");
+
+	LLT_CHECK(!stream.readLine(line));
+	LLT_CHECK(stream.eof());
+}
+
+static void testLineCopies()
+{
+	TestStream source("short\r\nmuch too long to fit\n");
+	BufferedStream stream(source);
+
+	Str<8> str;
+
+	LLT_CHECK(stream.readLine(str) && str == "short");
+
+	// truncated to what fits, but the rest of the line is still skipped
+	LLT_CHECK(stream.readLine(str) && str == "much to");
+
+	LLT_CHECK(!stream.readLine(str));
+}
+
+static void testMixedReadWrite()
+{
+	TestStream source("0123456789abcdefghij");
+	BufferedStream stream(source, 4);
+
+	char buffer[4] = {};
+
+	stream.read(buffer, 3);
+	LLT_CHECK(std::string_view(buffer, 3) == "012");
+
+	// the source has been read ahead, but the write has to land where we think we are
+	char patch[] = { 'X', 'Y' };
+	stream.write(patch, 2);
+
+	LLT_CHECK(stream.position() == 5);
+	LLT_CHECK(source.contents() == "012XY56789abcdefghij");
+
+	// and reading carries on right after what was written
+	stream.read(buffer, 3);
+	LLT_CHECK(std::string_view(buffer, 3) == "567");
+
+	// seeking back into what's buffered, then out of it
+	stream.seek(6);
+	LLT_CHECK(stream.readU8() == '6');
+
+	stream.seek(15);
+	LLT_CHECK(stream.readU8() == 'f');
+	LLT_CHECK(stream.position() == 16);
+
+	// writing past the end grows the source
+	stream.seek(20);
+	char tail[] = { '!', '?' };
+	stream.write(tail, 2);
+
+	LLT_CHECK(stream.size() == 22);
+	LLT_CHECK(source.contents() == "012XY56789abcdefghij!?");
+
+	stream.seek(18);
+
+	std::string_view line;
+	LLT_CHECK(stream.readLine(line) && line == "ij!?");
+}
+
+static void testClose()
+{
+	TestStream source("abc");
+
+	{
+		BufferedStream stream(source);
+
+		LLT_CHECK(stream.getStream() != nullptr);
+
+		stream.close();
+
+		LLT_CHECK(stream.getStream() == nullptr);
+		LLT_CHECK(stream.position() == -1);
+		LLT_CHECK(stream.size() == -1);
+	}
+
+	// closing the buffer just detaches it, the source is still usable
+	LLT_CHECK(source.getStream() != nullptr);
+	LLT_CHECK(source.size() == 3);
+}
+
+int main(int argc, char **argv)
+{
+	testTypedReads();
+	testSmallReadsAreBuffered();
+	testLineViews();
+	testLineCopies();
+	testMixedReadWrite();
+	testClose();
+
+	return test::result("buffered_stream");
+}
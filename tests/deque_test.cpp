@@ -0,0 +1,181 @@
+#include "test.h"
+
+#include "container/deque.h"
+#include "container/string.h"
+
+#include <deque>
+#include <random>
+#include <string>
+
+using namespace llt;
+
+// small chunks so the random run crosses chunk edges and recentres the map all the time
+using TestDeque = Deque<std::string, 4>;
+
+static void checkMatches(TestDeque &deque, const std::deque<std::string> &reference)
+{
+	LLT_CHECK(deque.size() == reference.size());
+	LLT_CHECK(deque.empty() == reference.empty());
+
+	uint64_t i = 0;
+
+	for (auto it = deque.begin(); it != deque.end(); it++)
+	{
+		LLT_CHECK(i < reference.size() && *it == reference[i]);
+		i++;
+	}
+
+	LLT_CHECK(i == reference.size());
+
+	for (i = 0; i < reference.size(); i++) {
+		LLT_CHECK(deque[i] == reference[i]);
+	}
+
+	if (!reference.empty())
+	{
+		LLT_CHECK(deque.front() == reference.front());
+		LLT_CHECK(deque.back() == reference.back());
+	}
+}
+
+/*
+ * Random pushes and pops at both ends against std::deque, starting from a single chunk.
+ */
+static void testAgainstReference()
+{
+	std::mt19937 rng(4321);
+	std::uniform_int_distribution<int> opDist(0, 5);
+
+	TestDeque deque(1);
+	std::deque<std::string> reference;
+
+	for (int i = 0; i < 20000; i++)
+	{
+		std::string value = std::to_string(i);
+
+		switch (opDist(rng))
+		{
+			case 0:
+				deque.pushBack(value);
+				reference.push_back(value);
+				break;
+
+			case 1:
+				deque.emplaceFront(value);
+				reference.push_front(value);
+				break;
+
+			case 2:
+				if (!reference.empty())
+				{
+					LLT_CHECK(deque.popFront() == reference.front());
+					reference.pop_front();
+				}
+				break;
+
+			case 3:
+				if (!reference.empty())
+				{
+					LLT_CHECK(deque.popBack() == reference.back());
+					reference.pop_back();
+				}
+				break;
+
+			case 4:
+				deque.emplaceBack(value);
+				reference.push_back(value);
+				break;
+
+			case 5:
+				deque.pushFront(value);
+				reference.push_front(value);
+				break;
+		}
+
+		if (i % 250 == 0) {
+			checkMatches(deque, reference);
+		}
+	}
+
+	checkMatches(deque, reference);
+
+	TestDeque copy(deque);
+	checkMatches(copy, reference);
+
+	TestDeque assigned;
+	assigned.pushBack("x");
+	assigned = deque;
+	checkMatches(assigned, reference);
+
+	TestDeque moved(std::move(deque));
+	checkMatches(moved, reference);
+	LLT_CHECK(deque.empty());
+
+	deque.clear();
+	LLT_CHECK(deque.empty() && deque.begin() == deque.end());
+}
+
+/*
+ * A queue that pushes at the back and pops at the front, which used to run off the end of the map
+ * and then keep growing it forever.
+ */
+static void testQueueReusesChunks()
+{
+	Deque<int, 8> queue(2);
+
+	for (int i = 0; i < 4; i++) {
+		queue.pushBack(i);
+	}
+
+	uint64_t liveContainers = test::liveAllocations(MEM_TAG_CONTAINERS);
+
+	int next = 4;
+
+	for (int i = 0; i < 100000; i++)
+	{
+		LLT_CHECK(queue.popFront() == next - 4);
+		queue.pushBack(next++);
+	}
+
+	LLT_CHECK(queue.size() == 4);
+
+	// nothing left over from the recentring, and nowhere near one chunk per push
+	LLT_CHECK(test::liveAllocations(MEM_TAG_CONTAINERS) <= liveContainers + 8);
+}
+
+static void testNoLeaks()
+{
+	uint64_t liveContainers = test::liveAllocations(MEM_TAG_CONTAINERS);
+	uint64_t liveStrings = test::liveAllocations(MEM_TAG_STRINGS);
+
+	{
+		Deque<String, 4> deque;
+
+		for (int i = 0; i < 100; i++)
+		{
+			deque.pushBack("back");
+			deque.emplaceFront("front");
+		}
+
+		for (int i = 0; i < 50; i++)
+		{
+			deque.popBack();
+			deque.popFront();
+		}
+
+		Deque<String, 4> copy = deque;
+		LLT_CHECK(copy.size() == 100);
+	}
+
+	LLT_CHECK(test::liveAllocations(MEM_TAG_CONTAINERS) == liveContainers);
+	LLT_CHECK(test::liveAllocations(MEM_TAG_STRINGS) == liveStrings);
+}
+
+int main(int argc, char **argv)
+{
+	testAgainstReference();
+	testQueueReusesChunks();
+	testNoLeaks();
+
+	return test::result("deque");
+}
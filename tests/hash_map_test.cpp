@@ -0,0 +1,228 @@
+#include "test.h"
+
+#include "container/hash_map.h"
+#include "container/string.h"
+
+#include <map>
+#include <random>
+
+using namespace llt;
+
+/*
+ * Checks the iteration list holds exactly what the reference does, with the links consistent both ways.
+ */
+static void checkMatches(const HashMap<int, int> &map, const std::map<int, int> &reference)
+{
+	LLT_CHECK(map.getElementCount() == (int)reference.size());
+	LLT_CHECK(map.isEmpty() == reference.empty());
+
+	int count = 0;
+	const HashMap<int, int>::Element *prev = nullptr;
+
+	for (const HashMap<int, int>::Element *e = map.first(); e; e = e->next)
+	{
+		LLT_CHECK(e->prev == prev);
+
+		auto it = reference.find(e->data.first);
+		LLT_CHECK(it != reference.end() && it->second == e->data.second);
+
+		prev = e;
+		count++;
+	}
+
+	LLT_CHECK(count == (int)reference.size());
+	LLT_CHECK(map.last() == prev);
+}
+
+/*
+ * Random inserts, erases and lookups against std::map. Keys come from a small range so buckets fill up
+ * and bucket heads get erased while others are still behind them.
+ */
+static void testAgainstReference()
+{
+	std::mt19937 rng(1234);
+	std::uniform_int_distribution<int> keyDist(0, 300);
+	std::uniform_int_distribution<int> opDist(0, 3);
+
+	HashMap<int, int> map;
+	std::map<int, int> reference;
+
+	for (int i = 0; i < 20000; i++)
+	{
+		int key = keyDist(rng);
+
+		switch (opDist(rng))
+		{
+			case 0:
+			case 1:
+				if (!map.contains(key))
+				{
+					map.insert(key, i);
+					reference[key] = i;
+				}
+				break;
+
+			case 2:
+				map.erase(key);
+				reference.erase(key);
+				break;
+
+			case 3:
+				LLT_CHECK(map.contains(key) == (reference.count(key) > 0));
+
+				if (reference.count(key) > 0)
+				{
+					LLT_CHECK(map.get(key) == reference[key]);
+
+					map.get(key) = -i;
+					reference[key] = -i;
+				}
+				break;
+		}
+
+		if (i % 500 == 0) {
+			checkMatches(map, reference);
+		}
+	}
+
+	checkMatches(map, reference);
+}
+
+/*
+ * Erasing the first element of a bucket that still has others in it, which used to leave the bucket
+ * pointing at the freed element.
+ */
+static void testEraseBucketHead()
+{
+	HashMap<int, int> map;
+
+	int capacity = map.getCapacity();
+
+	// three keys that all land in the same bucket as the first one
+	int sameBucket[3] = { 0 };
+	int found = 1;
+
+	for (int key = 1; found < 3; key++)
+	{
+		if (hash::calc(&key) % capacity == hash::calc(&sameBucket[0]) % capacity) {
+			sameBucket[found++] = key;
+		}
+	}
+
+	for (int key : sameBucket) {
+		map.insert(key, key * 10);
+	}
+
+	LLT_CHECK(map.getCapacity() == capacity);
+
+	// whichever one the bucket starts with, erasing each in turn has to leave the rest reachable
+	for (int i = 0; i < 3; i++)
+	{
+		map.erase(map.first()->data.first);
+
+		LLT_CHECK(map.getElementCount() == 3 - i - 1);
+
+		for (const auto &pair : map) {
+			LLT_CHECK(map.contains(pair.first) && map.get(pair.first) == pair.first * 10);
+		}
+	}
+
+	LLT_CHECK(map.isEmpty());
+	LLT_CHECK(map.first() == nullptr);
+}
+
+/*
+ * The map has to grow, otherwise every bucket ends up with a long chain in it.
+ */
+static void testGrowth()
+{
+	HashMap<int, int> map;
+
+	for (int i = 0; i < 5000; i++) {
+		map.insert(i, i);
+	}
+
+	LLT_CHECK(map.getCapacity() > map.getElementCount());
+
+	for (int i = 0; i < 5000; i++) {
+		LLT_CHECK(map.contains(i) && map.get(i) == i);
+	}
+
+	LLT_CHECK(!map.contains(5000));
+}
+
+static void testCopyAndMove()
+{
+	HashMap<int, int> map;
+	std::map<int, int> reference;
+
+	for (int i = 0; i < 100; i++)
+	{
+		map.insert(i * 7, i);
+		reference[i * 7] = i;
+	}
+
+	HashMap<int, int> copy(map);
+	checkMatches(copy, reference);
+
+	HashMap<int, int> assigned;
+	assigned.insert(-1, -1);
+	assigned = map;
+	checkMatches(assigned, reference);
+
+	// the const and non-const versions have to agree on where the list ends
+	const HashMap<int, int> &constMap = map;
+	LLT_CHECK(constMap.last() == map.last());
+	LLT_CHECK(constMap.last()->next == nullptr);
+
+	HashMap<int, int> moved(std::move(map));
+	checkMatches(moved, reference);
+	LLT_CHECK(map.getElementCount() == 0);
+
+	HashMap<int, int> moveAssigned;
+	moveAssigned = std::move(moved);
+	checkMatches(moveAssigned, reference);
+}
+
+static void testNoLeaks()
+{
+	uint64_t liveContainers = test::liveAllocations(MEM_TAG_CONTAINERS);
+	uint64_t liveStrings = test::liveAllocations(MEM_TAG_STRINGS);
+
+	{
+		HashMap<String, String> map;
+
+		for (int i = 0; i < 200; i++)
+		{
+			char key[16];
+			snprintf(key, sizeof(key), "key%d", i);
+
+			map.insert(key, "value");
+		}
+
+		for (int i = 0; i < 200; i += 2)
+		{
+			char key[16];
+			snprintf(key, sizeof(key), "key%d", i);
+
+			map.erase(key);
+		}
+
+		HashMap<String, String> copy = map;
+		LLT_CHECK(copy.getElementCount() == 100);
+	}
+
+	LLT_CHECK(test::liveAllocations(MEM_TAG_CONTAINERS) == liveContainers);
+	LLT_CHECK(test::liveAllocations(MEM_TAG_STRINGS) == liveStrings);
+}
+
+int main(int argc, char **argv)
+{
+	testAgainstReference();
+	testEraseBucketHead();
+	testGrowth();
+	testCopyAndMove();
+	testNoLeaks();
+
+	return test::result("hash_map");
+}
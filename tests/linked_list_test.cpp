@@ -0,0 +1,175 @@
+#include "test.h"
+
+#include "container/linked_list.h"
+#include "container/string.h"
+
+#include <list>
+#include <random>
+#include <string>
+
+using namespace llt;
+
+static void checkMatches(const LinkedList<std::string> &list, const std::list<std::string> &reference)
+{
+	LLT_CHECK(list.size() == reference.size());
+	LLT_CHECK(list.empty() == reference.empty());
+
+	auto expected = reference.begin();
+	uint64_t count = 0;
+
+	for (auto it = list.begin(); it != list.end(); it++)
+	{
+		LLT_CHECK(expected != reference.end() && *it == *expected);
+
+		expected++;
+		count++;
+	}
+
+	LLT_CHECK(count == reference.size());
+
+	// and the same again backwards, so the prev links get checked too
+	auto rexpected = reference.rbegin();
+
+	for (auto it = list.end(); it != list.begin(); )
+	{
+		it--;
+
+		LLT_CHECK(rexpected != reference.rend() && *it == *rexpected);
+		rexpected++;
+	}
+
+	if (!reference.empty())
+	{
+		LLT_CHECK(list.front() == reference.front());
+		LLT_CHECK(list.back() == reference.back());
+	}
+}
+
+/*
+ * Random inserts and erases at both ends and in the middle against std::list.
+ */
+static void testAgainstReference()
+{
+	std::mt19937 rng(1357);
+	std::uniform_int_distribution<int> opDist(0, 6);
+
+	LinkedList<std::string> list;
+	std::list<std::string> reference;
+
+	for (int i = 0; i < 5000; i++)
+	{
+		std::string value = std::to_string(i % 50);
+
+		// the same position in both, somewhere in the middle
+		int position = std::uniform_int_distribution<int>(0, (int)reference.size())(rng);
+
+		auto it = list.begin() + position;
+		auto rit = std::next(reference.begin(), position);
+
+		switch (opDist(rng))
+		{
+			case 0:
+				list.pushBack(value);
+				reference.push_back(value);
+				break;
+
+			case 1:
+				list.emplaceFront(value);
+				reference.push_front(value);
+				break;
+
+			case 2:
+				list.insert(value, it);
+				reference.insert(rit, value);
+				break;
+
+			case 3:
+				list.emplace(it, value);
+				reference.emplace(rit, value);
+				break;
+
+			case 4:
+				if (rit != reference.end())
+				{
+					auto next = list.erase(it);
+					auto rnext = reference.erase(rit);
+
+					LLT_CHECK((next == list.end()) == (rnext == reference.end()));
+				}
+				break;
+
+			case 5:
+				if (!reference.empty())
+				{
+					if (i % 2 == 0)
+					{
+						list.popFront();
+						reference.pop_front();
+					}
+					else
+					{
+						list.popBack();
+						reference.pop_back();
+					}
+				}
+				break;
+
+			case 6:
+				if (i % 10 == 0)
+				{
+					list.remove(value);
+					reference.remove(value);
+				}
+				break;
+		}
+
+		if (i % 250 == 0) {
+			checkMatches(list, reference);
+		}
+	}
+
+	checkMatches(list, reference);
+
+	list.clear();
+	reference.clear();
+
+	checkMatches(list, reference);
+	LLT_CHECK(list.begin() == list.end());
+}
+
+static void testNoLeaks()
+{
+	uint64_t liveContainers = test::liveAllocations(MEM_TAG_CONTAINERS);
+	uint64_t liveStrings = test::liveAllocations(MEM_TAG_STRINGS);
+
+	{
+		LinkedList<String> list;
+
+		for (int i = 0; i < 100; i++)
+		{
+			list.pushBack("back");
+			list.emplaceFront("front");
+		}
+
+		for (int i = 0; i < 50; i++)
+		{
+			list.popFront();
+			list.popBack();
+		}
+
+		list.remove("back");
+
+		LLT_CHECK(list.size() == 50);
+	}
+
+	LLT_CHECK(test::liveAllocations(MEM_TAG_CONTAINERS) == liveContainers);
+	LLT_CHECK(test::liveAllocations(MEM_TAG_STRINGS) == liveStrings);
+}
+
+int main(int argc, char **argv)
+{
+	testAgainstReference();
+	testNoLeaks();
+
+	return test::result("linked_list");
+}
@@ -0,0 +1,154 @@
+#include "test.h"
+
+#include "io/mmap_stream.h"
+
+#include <stdio.h>
+
+using namespace llt;
+
+static const char *TEST_FILE = "mmap_stream_test.bin";
+static const char *EMPTY_FILE = "mmap_stream_test_empty.bin";
+
+static void writeFile(const char *path, const byte *data, uint64_t length)
+{
+	FILE *file = ::fopen(path, "wb");
+
+	if (!file) {
+		return;
+	}
+
+	if (length > 0) {
+		::fwrite(data, 1, length, file);
+	}
+
+	::fclose(file);
+}
+
+static void testRead()
+{
+	byte contents[256];
+
+	for (int i = 0; i < 256; i++) {
+		contents[i] = (byte)i;
+	}
+
+	writeFile(TEST_FILE, contents, sizeof(contents));
+
+	MmapStream stream(TEST_FILE);
+
+	LLT_CHECK(stream.isOpen());
+	LLT_CHECK(stream.size() == 256);
+	LLT_CHECK(stream.position() == 0);
+
+	uint32_t word = 0;
+	stream.read(&word, sizeof(word));
+
+	LLT_CHECK(word == 0x03020100);
+	LLT_CHECK(stream.position() == 4);
+
+	// peeking shouldn't move us, consuming should
+	std::span<const byte> peeked = stream.peek(4);
+
+	LLT_CHECK(peeked.size() == 4 && peeked[0] == 4 && peeked[3] == 7);
+	LLT_CHECK(stream.position() == 4);
+
+	std::span<const byte> consumed = stream.consume(4);
+
+	LLT_CHECK(consumed.data() == peeked.data());
+	LLT_CHECK(stream.position() == 8);
+
+	// views point straight into the mapping
+	LLT_CHECK(consumed.data() == stream.getMapping().data() + 4);
+
+	// asking for more than is left gets cut short at the end of the file
+	stream.seek(250);
+
+	std::span<const byte> tail = stream.consume(100);
+
+	LLT_CHECK(tail.size() == 6 && tail[5] == 255);
+	LLT_CHECK(stream.position() == 256);
+	LLT_CHECK(stream.consume(1).empty());
+
+	// seeking clamps to the file
+	stream.seek(-10);
+	LLT_CHECK(stream.position() == 0);
+
+	stream.seek(1000);
+	LLT_CHECK(stream.position() == 256);
+
+	stream.seek(128);
+
+	byte value = 0;
+	stream.read(&value, 1);
+
+	LLT_CHECK(value == 128);
+
+	stream.close();
+
+	LLT_CHECK(!stream.isOpen());
+	LLT_CHECK(stream.size() == -1);
+	LLT_CHECK(stream.position() == -1);
+
+	::remove(TEST_FILE);
+}
+
+static void testReopen()
+{
+	byte first[] = { 1, 2, 3 };
+	byte second[] = { 9, 8, 7, 6, 5 };
+
+	MmapStream stream;
+
+	LLT_CHECK(!stream.isOpen());
+
+	writeFile(TEST_FILE, first, sizeof(first));
+	stream.open(TEST_FILE);
+	stream.seek(2);
+
+	LLT_CHECK(stream.size() == 3);
+	LLT_CHECK(stream.position() == 2);
+
+	stream.close();
+
+	// opening again should start back at the front of the new file
+	writeFile(TEST_FILE, second, sizeof(second));
+	stream.open(TEST_FILE);
+
+	LLT_CHECK(stream.size() == 5);
+	LLT_CHECK(stream.position() == 0);
+	LLT_CHECK(stream.peek(1).size() == 1 && stream.peek(1)[0] == 9);
+
+	stream.close();
+
+	::remove(TEST_FILE);
+}
+
+static void testMissingAndEmpty()
+{
+	MmapStream missing("mmap_stream_test_does_not_exist.bin");
+
+	LLT_CHECK(!missing.isOpen());
+	LLT_CHECK(missing.size() == -1);
+	LLT_CHECK(missing.consume(16).empty());
+
+	// nothing to map, so it shouldn't pretend to be open
+	writeFile(EMPTY_FILE, nullptr, 0);
+
+	MmapStream empty(EMPTY_FILE);
+
+	LLT_CHECK(!empty.isOpen());
+	LLT_CHECK(empty.peek(1).empty());
+
+	empty.close();
+
+	::remove(EMPTY_FILE);
+}
+
+int main(int argc, char **argv)
+{
+	testRead();
+	testReopen();
+	testMissingAndEmpty();
+
+	return test::result("mmap_stream");
+}
@@ -0,0 +1,51 @@
+#ifndef TEST_H_
+#define TEST_H_
+
+#include <stdio.h>
+
+#include "core/common.h"
+#include "core/mem_tracker.h"
+
+/*
+ * Just enough for the regression tests to report what went wrong.
+ *
+ * A failed check prints where it was and carries on, so one run shows everything that's broken.
+ * main() returns test::result() so ctest sees the failure.
+ */
+namespace llt::test
+{
+	inline int g_failures = 0;
+
+	inline void check(bool ok, const char *expr, const char *file, int line)
+	{
+		if (!ok)
+		{
+			::printf("%s:%d: check failed: %s\n", file, line, expr);
+			g_failures++;
+		}
+	}
+
+	/*
+	 * How many allocations are still alive under the tag, for checking nothing leaked.
+	 */
+	inline uint64_t liveAllocations(MemTag tag)
+	{
+		return memtrack::getStats(tag).liveAllocations;
+	}
+
+	inline int result(const char *name)
+	{
+		if (g_failures > 0)
+		{
+			::printf("%s: %d checks failed\n", name, g_failures);
+			return 1;
+		}
+
+		::printf("%s: ok\n", name);
+		return 0;
+	}
+}
+
+#define LLT_CHECK(_exp) (::llt::test::check((_exp), #_exp, __FILE__, __LINE__))
+
+#endif // TEST_H_
@@ -0,0 +1,209 @@
+#include "test.h"
+
+#include "container/vector.h"
+#include "container/string.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace llt;
+
+static void checkMatches(const Vector<String> &vector, const std::vector<std::string> &reference)
+{
+	LLT_CHECK(vector.size() == reference.size());
+
+	for (uint64_t i = 0; i < reference.size() && i < vector.size(); i++) {
+		LLT_CHECK(reference[i] == vector[i].cstr());
+	}
+}
+
+/*
+ * Random inserts at both ends and in the middle against std::vector, with elements that own memory
+ * so anything moved the wrong number of times shows up.
+ */
+static void testAgainstReference()
+{
+	std::mt19937 rng(2468);
+	std::uniform_int_distribution<int> opDist(0, 6);
+
+	Vector<String> vector;
+	std::vector<std::string> reference;
+
+	for (int i = 0; i < 5000; i++)
+	{
+		std::string value = std::to_string(i);
+
+		switch (opDist(rng))
+		{
+			case 0:
+				vector.pushBack(value.c_str());
+				reference.push_back(value);
+				break;
+
+			case 1:
+				vector.emplaceBack(value.c_str());
+				reference.push_back(value);
+				break;
+
+			case 2:
+				vector.pushFront(value.c_str());
+				reference.insert(reference.begin(), value);
+				break;
+
+			case 3:
+				vector.emplaceFront(value.c_str());
+				reference.insert(reference.begin(), value);
+				break;
+
+			case 4:
+			{
+				int index = std::uniform_int_distribution<int>(0, (int)reference.size())(rng);
+				vector.insert(index, value.c_str());
+				reference.insert(reference.begin() + index, value);
+				break;
+			}
+
+			case 5:
+				if (!reference.empty())
+				{
+					LLT_CHECK(reference.front() == vector.popFront().cstr());
+					reference.erase(reference.begin());
+				}
+				break;
+
+			case 6:
+				if (!reference.empty())
+				{
+					LLT_CHECK(reference.back() == vector.popBack().cstr());
+					reference.pop_back();
+				}
+				break;
+		}
+
+		if (i % 250 == 0) {
+			checkMatches(vector, reference);
+		}
+	}
+
+	checkMatches(vector, reference);
+
+	Vector<String> copy(vector);
+	checkMatches(copy, reference);
+
+	Vector<String> moved(std::move(vector));
+	checkMatches(moved, reference);
+	LLT_CHECK(vector.size() == 0);
+}
+
+/*
+ * Erasing used to destroy the erased elements and then move-assign the tail over them, so a String
+ * released the buffer it had already freed. Shrinking with resize() erases the end, same problem.
+ */
+static void testErase()
+{
+	uint64_t liveStrings = test::liveAllocations(MEM_TAG_STRINGS);
+
+	{
+		std::mt19937 rng(97531);
+
+		Vector<String> vector;
+		std::vector<std::string> reference;
+
+		for (int i = 0; i < 3000; i++)
+		{
+			std::string value = std::to_string(i);
+
+			vector.pushBack(value.c_str());
+			reference.push_back(value);
+
+			if (i % 3 != 0) {
+				continue;
+			}
+
+			int index = std::uniform_int_distribution<int>(0, (int)reference.size() - 1)(rng);
+			int amount = std::uniform_int_distribution<int>(1, (int)reference.size() - index)(rng);
+
+			// keep it growing overall
+			amount = amount > 2 ? 2 : amount;
+
+			if (i % 2 == 0) {
+				vector.erase(index, amount);
+			} else {
+				vector.erase(Vector<String>::Iterator(vector.data() + index), amount);
+			}
+
+			reference.erase(reference.begin() + index, reference.begin() + index + amount);
+		}
+
+		checkMatches(vector, reference);
+
+		// the last element, with nothing after it to move down
+		vector.erase(vector.size() - 1);
+		reference.pop_back();
+
+		checkMatches(vector, reference);
+
+		vector.resize(reference.size() / 2);
+		reference.resize(reference.size() / 2);
+
+		checkMatches(vector, reference);
+
+		vector.resize(0);
+		LLT_CHECK(vector.size() == 0);
+	}
+
+	LLT_CHECK(test::liveAllocations(MEM_TAG_STRINGS) == liveStrings);
+}
+
+/*
+ * Pushing used to default-construct a slot and then construct over it, leaking whatever the first one
+ * allocated, and the sized constructors built elements out to the capacity rather than the size.
+ */
+static void testNoLeaks()
+{
+	uint64_t liveContainers = test::liveAllocations(MEM_TAG_CONTAINERS);
+	uint64_t liveStrings = test::liveAllocations(MEM_TAG_STRINGS);
+
+	{
+		Vector<String> vector;
+
+		for (int i = 0; i < 100; i++)
+		{
+			vector.pushBack("back");
+			vector.emplaceFront("front");
+			vector.insert(vector.size() / 2, "middle");
+		}
+
+		for (int i = 0; i < 50; i++)
+		{
+			vector.popBack();
+			vector.popFront();
+		}
+
+		LLT_CHECK(vector.size() == 200);
+
+		Vector<String> sized(3);
+		Vector<String> filled(5, "fill");
+
+		LLT_CHECK(sized.size() == 3);
+		LLT_CHECK(filled.size() == 5 && filled[4] == "fill");
+
+		Vector<String> copy = vector;
+		copy = filled;
+
+		LLT_CHECK(copy.size() == 5);
+	}
+
+	LLT_CHECK(test::liveAllocations(MEM_TAG_CONTAINERS) == liveContainers);
+	LLT_CHECK(test::liveAllocations(MEM_TAG_STRINGS) == liveStrings);
+}
+
+int main(int argc, char **argv)
+{
+	testAgainstReference();
+	testErase();
+	testNoLeaks();
+
+	return test::result("vector");
+}
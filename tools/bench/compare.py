@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+
+# Compares two benchmark reports (the .json the engine writes with --benchmark) and flags anything that got slower.
+#
+#   compare.py baseline.json candidate.json [--threshold 5] [--metrics p50,p95,p99]
+#
+# Exits with 1 if any compared metric regressed by more than the threshold (percent), so it can gate a ci job.
+
+import argparse
+import json
+import sys
+
+# frame times from benchmark runs, record and gpu times from replaying a captured frame (--replay)
+TIMINGS = ("cpuFrameMs", "gpuFrameMs", "cpuRecordMs", "gpuMs")
+MEMORY = ("gpuMemoryPeakMB", "cpuMemoryPeakMB")
+
+def load(path):
+	with open(path, "r") as file:
+		return json.load(file)
+
+def main():
+	parser = argparse.ArgumentParser(description="Flag frame time regressions between two benchmark reports.")
+	parser.add_argument("baseline")
+	parser.add_argument("candidate")
+	parser.add_argument("--threshold", type=float, default=5.0, help="percent slower before it counts as a regression")
+	parser.add_argument("--metrics", default="avg,p50,p95,p99", help="comma separated percentiles to compare")
+	args = parser.parse_args()
+
+	baseline = load(args.baseline)
+	candidate = load(args.candidate)
+
+	if baseline.get("scenario") != candidate.get("scenario"):
+		print(f"warning: comparing different scenarios ({baseline.get('scenario')} vs {candidate.get('scenario')})")
+
+	# renderScale is only there with dynamic resolution, where the frame times depend on how far it scaled down
+	for key in ("width", "height", "drawCount", "triangleCount", "commandCount", "renderScale"):
+		if baseline.get(key) != candidate.get(key):
+			print(f"warning: {key} differs ({baseline.get(key)} vs {candidate.get(key)}), the scenes aren't the same")
+
+	metrics = [metric.strip() for metric in args.metrics.split(",") if metric.strip()]
+	regressions = 0
+
+	print(f"{'metric':<20} {'baseline':>10} {'candidate':>10} {'change':>9}")
+
+	for timing in TIMINGS:
+		before = baseline.get(timing, {})
+		after = candidate.get(timing, {})
+
+		# belongs to the other kind of report
+		if not before and not after:
+			continue
+
+		# no gpu times at all usually means the profiler wasn't running, nothing to compare
+		if before.get("count", 0) == 0 or after.get("count", 0) == 0:
+			print(f"{timing:<20} skipped, no samples")
+			continue
+
+		for metric in metrics:
+			if metric not in before or metric not in after:
+				continue
+
+			old = before[metric]
+			new = after[metric]
+			change = ((new - old) / old * 100.0) if old > 0.0 else 0.0
+
+			flag = ""
+
+			if change > args.threshold:
+				flag = "  REGRESSION"
+				regressions += 1
+			elif change < -args.threshold:
+				flag = "  improved"
+
+			print(f"{timing + '.' + metric:<20} {old:>10.3f} {new:>10.3f} {change:>+8.1f}%{flag}")
+
+	for memory in MEMORY:
+		old_memory = baseline.get(memory, 0.0)
+		new_memory = candidate.get(memory, 0.0)
+
+		if old_memory <= 0.0:
+			continue
+
+		change = (new_memory - old_memory) / old_memory * 100.0
+		flag = "  REGRESSION" if change > args.threshold else ""
+
+		if flag:
+			regressions += 1
+
+		print(f"{memory:<20} {old_memory:>10.1f} {new_memory:>10.1f} {change:>+8.1f}%{flag}")
+
+	# driver time per entry point, only in reports from runs with --api-stats. informational, never a regression
+	old_api = baseline.get("vulkanApi", {})
+	new_api = candidate.get("vulkanApi", {})
+
+	for name in sorted(set(old_api) | set(new_api)):
+		old_call = old_api.get(name, {})
+		new_call = new_api.get(name, {})
+
+		old_ms = old_call.get("msPerFrame", 0.0)
+		new_ms = new_call.get("msPerFrame", 0.0)
+		old_calls = old_call.get("callsPerFrame", 0.0)
+		new_calls = new_call.get("callsPerFrame", 0.0)
+
+		print(f"{name:<32} {old_calls:>8.1f} -> {new_calls:>8.1f} calls {old_ms:>8.4f} -> {new_ms:>8.4f} ms")
+
+	if regressions > 0:
+		print(f"{regressions} regression(s) over {args.threshold}%")
+		return 1
+
+	print("no regressions")
+	return 0
+
+if __name__ == "__main__":
+	sys.exit(main())
@@ -0,0 +1,362 @@
+#include "vulkan/image_ops.h"
+#include "container/vector.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <random>
+
+using namespace llt;
+
+/*
+ * Checks every simd level of the image kernels against the scalar reference, then reports throughput for each.
+ *
+ * The correctness pass uses odd sizes so the scalar tails and edge clamping get exercised too.
+ * Results have to match exactly, apart from linearToSrgb where the simd curve fit is allowed to be a step off,
+ * and the sh projection which sums in a different order so only has to match to rounding.
+ * Exits with 1 if anything doesn't match.
+ *
+ * usage: lilythorn_image_bench [size] [--runs N]
+ */
+
+struct KernelInputs
+{
+	uint32_t width;
+	uint32_t height;
+
+	Vector<float> hdr;		// rgba floats across the whole range packHalf and packRGB9E5 care about
+	Vector<float> unit;		// rgba floats mostly in [0, 1]
+	Vector<byte> ldr;		// rgba8
+	Vector<byte> ldr2;
+	Vector<byte> ldr3;
+
+	uint64_t getPixelCount() const { return (uint64_t)width * height; }
+};
+
+static void fillInputs(KernelInputs &inputs, uint32_t width, uint32_t height, uint32_t seed)
+{
+	std::mt19937 rng(seed);
+
+	std::uniform_real_distribution<float> hdrDist(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> unitDist(-0.05f, 1.05f);
+	std::uniform_int_distribution<int> byteDist(0, 255);
+
+	inputs.width = width;
+	inputs.height = height;
+
+	uint64_t count = inputs.getPixelCount() * 4;
+
+	inputs.hdr.resize(count);
+	inputs.unit.resize(count);
+	inputs.ldr.resize(count);
+	inputs.ldr2.resize(count);
+	inputs.ldr3.resize(count);
+
+	for (uint64_t i = 0; i < count; i++)
+	{
+		// spread over many exponents, from denormal halves up past the largest rgb9e5 value
+		float magnitude = std::pow(2.0f, hdrDist(rng) * 20.0f - 4.0f);
+		inputs.hdr[i] = hdrDist(rng) < -0.9f ? -magnitude : magnitude;
+
+		inputs.unit[i] = unitDist(rng);
+
+		inputs.ldr[i] = (byte)byteDist(rng);
+		inputs.ldr2[i] = (byte)byteDist(rng);
+		inputs.ldr3[i] = (byte)byteDist(rng);
+	}
+}
+
+/*
+ * One kernel run: reads from the inputs and writes to the output buffer, returns how many bytes it read.
+ */
+using KernelFn = uint64_t (*)(const KernelInputs &inputs, Vector<byte> &output);
+
+struct Kernel
+{
+	const char *name;
+	KernelFn run;
+	int tolerance; // largest allowed difference per output byte, 0 means exact
+	float relativeTolerance; // if set the output is compared as floats instead, relative to each value (or 1, if it's smaller)
+};
+
+static uint64_t runDownsampleBox(const KernelInputs &inputs, Vector<byte> &output)
+{
+	uint32_t w = inputs.width > 1 ? inputs.width / 2 : 1;
+	uint32_t h = inputs.height > 1 ? inputs.height / 2 : 1;
+
+	output.resize((uint64_t)w * h * 4 * sizeof(float));
+	imageops::downsample(inputs.unit.data(), inputs.width, inputs.height, (float *)output.data(), imageops::DOWNSAMPLE_FILTER_BOX);
+
+	return inputs.unit.size() * sizeof(float);
+}
+
+static uint64_t runDownsampleKaiser(const KernelInputs &inputs, Vector<byte> &output)
+{
+	uint32_t w = inputs.width > 1 ? inputs.width / 2 : 1;
+	uint32_t h = inputs.height > 1 ? inputs.height / 2 : 1;
+
+	output.resize((uint64_t)w * h * 4 * sizeof(float));
+	imageops::downsample(inputs.unit.data(), inputs.width, inputs.height, (float *)output.data(), imageops::DOWNSAMPLE_FILTER_KAISER);
+
+	return inputs.unit.size() * sizeof(float);
+}
+
+static uint64_t runSrgbToLinear(const KernelInputs &inputs, Vector<byte> &output)
+{
+	output.resize(inputs.getPixelCount() * 4 * sizeof(float));
+	imageops::srgbToLinear(inputs.ldr.data(), (float *)output.data(), inputs.getPixelCount());
+
+	return inputs.ldr.size();
+}
+
+static uint64_t runLinearToSrgb(const KernelInputs &inputs, Vector<byte> &output)
+{
+	output.resize(inputs.getPixelCount() * 4);
+	imageops::linearToSrgb(inputs.unit.data(), output.data(), inputs.getPixelCount());
+
+	return inputs.unit.size() * sizeof(float);
+}
+
+static uint64_t runPremultiply(const KernelInputs &inputs, Vector<byte> &output)
+{
+	output.resize(inputs.ldr.size());
+	mem::copy(output.data(), inputs.ldr.data(), inputs.ldr.size());
+
+	imageops::premultiplyAlpha(output.data(), inputs.getPixelCount());
+
+	return inputs.ldr.size();
+}
+
+static uint64_t runPremultiplyFloat(const KernelInputs &inputs, Vector<byte> &output)
+{
+	output.resize(inputs.unit.size() * sizeof(float));
+	mem::copy(output.data(), inputs.unit.data(), output.size());
+
+	imageops::premultiplyAlpha((float *)output.data(), inputs.getPixelCount());
+
+	return output.size();
+}
+
+static uint64_t runPackHalf(const KernelInputs &inputs, Vector<byte> &output)
+{
+	output.resize(inputs.getPixelCount() * 4 * sizeof(uint16_t));
+	imageops::packHalf(inputs.hdr.data(), (uint16_t *)output.data(), inputs.getPixelCount());
+
+	return inputs.hdr.size() * sizeof(float);
+}
+
+static uint64_t runPackRGB9E5(const KernelInputs &inputs, Vector<byte> &output)
+{
+	output.resize(inputs.getPixelCount() * sizeof(uint32_t));
+	imageops::packRGB9E5(inputs.hdr.data(), (uint32_t *)output.data(), inputs.getPixelCount());
+
+	return inputs.hdr.size() * sizeof(float);
+}
+
+static uint64_t runSwizzle(const KernelInputs &inputs, Vector<byte> &output)
+{
+	const int channels[4] = { imageops::CHANNEL_B, imageops::CHANNEL_G, imageops::CHANNEL_R, imageops::CHANNEL_ONE };
+
+	output.resize(inputs.ldr.size());
+	imageops::swizzle(inputs.ldr.data(), output.data(), inputs.getPixelCount(), channels);
+
+	return inputs.ldr.size();
+}
+
+static uint64_t runPackChannels(const KernelInputs &inputs, Vector<byte> &output)
+{
+	// ao, roughness and metal from three separate maps, no alpha
+	const imageops::ChannelSource sources[4] = {
+		{ inputs.ldr.data(),	imageops::CHANNEL_R,	0	},
+		{ inputs.ldr2.data(),	imageops::CHANNEL_G,	0	},
+		{ inputs.ldr3.data(),	imageops::CHANNEL_B,	0	},
+		{ nullptr,				imageops::CHANNEL_A,	255	}
+	};
+
+	output.resize(inputs.ldr.size());
+	imageops::packChannels(sources, output.data(), inputs.getPixelCount());
+
+	return inputs.ldr.size() * 3;
+}
+
+static uint64_t runProjectSH9(const KernelInputs &inputs, Vector<byte> &output)
+{
+	// every face out of the same pixels, which is enough to go through all the face directions
+	uint32_t size = inputs.width < inputs.height ? inputs.width : inputs.height;
+
+	output.resize(imageops::SH9_FLOAT_COUNT * sizeof(float));
+	mem::set(output.data(), 0, output.size());
+
+	for (int face = 0; face < 6; face++) {
+		imageops::projectSH9(inputs.unit.data(), size, face, (float *)output.data());
+	}
+
+	return (uint64_t)size * size * 4 * sizeof(float) * 6;
+}
+
+static const Kernel KERNELS[] = {
+	{ "downsample (box)",		runDownsampleBox,		0 },
+	{ "downsample (kaiser)",	runDownsampleKaiser,	0 },
+	{ "srgb to linear",			runSrgbToLinear,		0 },
+	{ "linear to srgb",			runLinearToSrgb,		1 },
+	{ "premultiply (rgba8)",	runPremultiply,			0 },
+	{ "premultiply (rgba32f)",	runPremultiplyFloat,	0 },
+	{ "pack rgba16f",			runPackHalf,			0 },
+	{ "pack rgb9e5",			runPackRGB9E5,			0 },
+	{ "swizzle",				runSwizzle,				0 },
+	{ "pack channels",			runPackChannels,		0 },
+	{ "project sh9",			runProjectSH9,			0,		1e-4f }
+};
+
+static bool matches(const Vector<byte> &expected, const Vector<byte> &actual, const Kernel &kernel, uint64_t &firstMismatch)
+{
+	if (expected.size() != actual.size())
+	{
+		firstMismatch = 0;
+		return false;
+	}
+
+	if (kernel.relativeTolerance > 0.0f)
+	{
+		const float *expectedFloats = (const float *)expected.data();
+		const float *actualFloats = (const float *)actual.data();
+
+		for (uint64_t i = 0; i < expected.size() / sizeof(float); i++)
+		{
+			float scale = std::abs(expectedFloats[i]) > 1.0f ? std::abs(expectedFloats[i]) : 1.0f;
+
+			if (std::abs(expectedFloats[i] - actualFloats[i]) > kernel.relativeTolerance * scale)
+			{
+				firstMismatch = i * sizeof(float);
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	int tolerance = kernel.tolerance;
+
+	for (uint64_t i = 0; i < expected.size(); i++)
+	{
+		if (abs((int)expected[i] - (int)actual[i]) > tolerance)
+		{
+			firstMismatch = i;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool checkCorrectness(imageops::SimdLevel level)
+{
+	bool passed = true;
+
+	// odd and tiny sizes so every tail and edge case gets hit
+	const uint32_t sizes[][2] = { { 1, 1 }, { 3, 1 }, { 1, 5 }, { 7, 3 }, { 33, 17 }, { 257, 131 } };
+
+	for (auto &size : sizes)
+	{
+		KernelInputs inputs;
+		fillInputs(inputs, size[0], size[1], size[0] * 31 + size[1]);
+
+		for (auto &kernel : KERNELS)
+		{
+			Vector<byte> expected, actual;
+
+			imageops::setSimdLevel(imageops::SIMD_LEVEL_SCALAR);
+			kernel.run(inputs, expected);
+
+			imageops::setSimdLevel(level);
+			kernel.run(inputs, actual);
+
+			uint64_t mismatch = 0;
+
+			if (!matches(expected, actual, kernel, mismatch))
+			{
+				LLT_LOG("FAIL %-24s %-6s %ux%u, first difference at byte %" PRIu64,
+					kernel.name, imageops::getSimdLevelName(level),
+					size[0], size[1], mismatch
+				);
+
+				passed = false;
+			}
+		}
+	}
+
+	return passed;
+}
+
+static double timeKernel(const Kernel &kernel, const KernelInputs &inputs, int runs, uint64_t &bytesRead)
+{
+	Vector<byte> output;
+
+	// warm up, and gets the output allocated
+	bytesRead = kernel.run(inputs, output);
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	for (int i = 0; i < runs; i++) {
+		kernel.run(inputs, output);
+	}
+
+	auto end = std::chrono::high_resolution_clock::now();
+
+	return std::chrono::duration<double>(end - start).count() / runs;
+}
+
+int main(int argc, char **argv)
+{
+	uint32_t size = 2048;
+	int runs = 10;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+			runs = atoi(argv[++i]);
+		} else {
+			size = atoi(argv[i]);
+		}
+	}
+
+	imageops::SimdLevel supported = imageops::getSupportedSimdLevel();
+
+	LLT_LOG("Best supported simd level: %s", imageops::getSimdLevelName(supported));
+
+	bool passed = true;
+
+	for (int level = imageops::SIMD_LEVEL_SSE; level <= supported; level++) {
+		passed &= checkCorrectness((imageops::SimdLevel)level);
+	}
+
+	LLT_LOG("Correctness: %s", passed ? "all simd levels match the scalar reference" : "FAILED");
+
+	KernelInputs inputs;
+	fillInputs(inputs, size, size, 1234);
+
+	LLT_LOG("");
+	LLT_LOG("Throughput over a %ux%u image, %d runs (MB/s of input):", size, size, runs);
+	LLT_LOG("%-24s %12s %12s %12s", "kernel", "scalar", "sse", "avx2");
+
+	for (auto &kernel : KERNELS)
+	{
+		double throughput[imageops::SIMD_LEVEL_MAX_ENUM] = {};
+
+		for (int level = 0; level <= supported; level++)
+		{
+			imageops::setSimdLevel((imageops::SimdLevel)level);
+
+			uint64_t bytesRead = 0;
+			double seconds = timeKernel(kernel, inputs, runs, bytesRead);
+
+			throughput[level] = ((double)bytesRead / (double)LLT_MEGABYTES(1)) / seconds;
+		}
+
+		LLT_LOG("%-24s %12.1f %12.1f %12.1f", kernel.name, throughput[0], throughput[1], throughput[2]);
+	}
+
+	return passed ? 0 : 1;
+}
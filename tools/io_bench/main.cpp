@@ -0,0 +1,185 @@
+#include "io/async_io.h"
+
+#include <filesystem>
+#include <fstream>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#if !_WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif // !_WIN32
+
+using namespace llt;
+
+/*
+ * Reads every file under a directory (res/ by default) and reports throughput for:
+ * - plain blocking ifstream reads, one file after another (what the asset loaders do today)
+ * - one batched submission to the async i/o service
+ *
+ * Each is run cold (page cache dropped for the files first) and warm.
+ * Dropping the cache uses posix_fadvise(DONTNEED), which works without root but only on linux;
+ * on other platforms the "cold" numbers are really just a second warm run.
+ *
+ * usage: lilythorn_io_bench [directory] [--workers N] [--threadpool]
+ */
+
+struct FileEntry
+{
+	String path;
+	uint64_t size;
+	uint64_t offset; // into the shared destination buffer
+};
+
+static void dropFromPageCache(const Vector<FileEntry> &files)
+{
+#if !_WIN32
+	for (auto &file : files)
+	{
+		int fd = ::open(file.path.cstr(), O_RDONLY);
+
+		if (fd < 0) {
+			continue;
+		}
+
+		posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+		::close(fd);
+	}
+#endif // !_WIN32
+}
+
+static double readBlocking(const Vector<FileEntry> &files, byte *buffer)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	for (auto &file : files)
+	{
+		std::ifstream stream(file.path.cstr(), std::ios::binary);
+		stream.read((char *)buffer + file.offset, file.size);
+	}
+
+	auto end = std::chrono::high_resolution_clock::now();
+
+	return std::chrono::duration<double>(end - start).count();
+}
+
+static double readAsync(AsyncIO *io, const Vector<FileEntry> &files, byte *buffer, uint64_t &failures)
+{
+	Vector<AsyncReadRequest> requests;
+
+	for (auto &file : files)
+	{
+		AsyncReadRequest request;
+		request.path = file.path;
+		request.buffer = buffer + file.offset;
+		request.length = file.size;
+		request.callback = [&failures](const AsyncReadResult &result) {
+			if (!result.success) {
+				failures++;
+			}
+		};
+
+		requests.pushBack(request);
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	io->submit(requests);
+	io->waitIdle();
+
+	auto end = std::chrono::high_resolution_clock::now();
+
+	return std::chrono::duration<double>(end - start).count();
+}
+
+static void report(const char *name, const char *cache, double seconds, uint64_t totalBytes, uint64_t fileCount)
+{
+	double megabytes = (double)totalBytes / (double)LLT_MEGABYTES(1);
+
+	LLT_LOG("%-24s %-6s %10.2f ms %10.1f MB/s %10.0f files/s",
+		name, cache,
+		seconds * 1000.0,
+		megabytes / seconds,
+		(double)fileCount / seconds
+	);
+}
+
+int main(int argc, char **argv)
+{
+	const char *directory = "../../res";
+	uint32_t workerCount = 0;
+	bool forceThreadPool = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+			workerCount = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--threadpool") == 0) {
+			forceThreadPool = true;
+		} else {
+			directory = argv[i];
+		}
+	}
+
+	std::error_code ec;
+
+	if (!std::filesystem::is_directory(directory, ec))
+	{
+		LLT_LOG("Not a directory: %s", directory);
+		return 1;
+	}
+
+	Vector<FileEntry> files;
+	uint64_t totalBytes = 0;
+
+	for (auto &entry : std::filesystem::recursive_directory_iterator(directory, ec))
+	{
+		if (!entry.is_regular_file()) {
+			continue;
+		}
+
+		FileEntry file;
+		file.path = entry.path().string().c_str();
+		file.size = entry.file_size();
+		file.offset = totalBytes;
+
+		// keep every destination 4k aligned, same as a real loader would for direct uploads
+		totalBytes += (file.size + 4095) & ~4095ull;
+
+		files.pushBack(file);
+	}
+
+	if (files.size() == 0)
+	{
+		LLT_LOG("No files found in: %s", directory);
+		return 1;
+	}
+
+	Vector<byte> buffer(totalBytes);
+
+	AsyncIO *io = forceThreadPool
+		? new ThreadPoolAsyncIO(workerCount > 0 ? workerCount : 4)
+		: AsyncIO::create(workerCount);
+
+	LLT_LOG("%llu files, %.1f MB, async backend: %s", (unsigned long long)files.size(), (double)totalBytes / (double)LLT_MEGABYTES(1), io->getBackendName());
+	LLT_LOG("--------------------------------------------------------------------------------");
+
+	uint64_t failures = 0;
+
+	dropFromPageCache(files);
+	report("blocking ifstream", "cold", readBlocking(files, buffer.data()), totalBytes, files.size());
+	report("blocking ifstream", "warm", readBlocking(files, buffer.data()), totalBytes, files.size());
+
+	dropFromPageCache(files);
+	report(io->getBackendName(), "cold", readAsync(io, files, buffer.data(), failures), totalBytes, files.size());
+	report(io->getBackendName(), "warm", readAsync(io, files, buffer.data(), failures), totalBytes, files.size());
+
+	if (failures > 0) {
+		LLT_LOG("%llu async reads failed!", (unsigned long long)failures);
+	}
+
+	delete io;
+
+	return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,457 @@
+#include "harness.h"
+
+#include <vector>
+#include <unordered_map>
+#include <deque>
+#include <list>
+#include <bitset>
+#include <functional>
+#include <random>
+
+#include "container/vector.h"
+#include "container/hash_map.h"
+#include "container/deque.h"
+#include "container/linked_list.h"
+#include "container/bitset.h"
+#include "container/function.h"
+
+using namespace llt;
+using microbench::doNotOptimize;
+
+// small enough to stay in cache, big enough that per-call overhead isn't all that's measured
+static constexpr uint64_t ELEMENT_COUNT = 4096;
+static constexpr uint64_t BIT_COUNT = 4096;
+
+static Vector<uint64_t> g_keys;
+
+// built once up front for the cases that only read
+static Vector<uint64_t> *g_vector = nullptr;
+static std::vector<uint64_t> *g_stdVector = nullptr;
+static HashMap<uint64_t, uint64_t> *g_hashMap = nullptr;
+static std::unordered_map<uint64_t, uint64_t> *g_stdHashMap = nullptr;
+static LinkedList<uint64_t> *g_linkedList = nullptr;
+static std::list<uint64_t> *g_stdList = nullptr;
+static Bitset<BIT_COUNT> *g_bitset = nullptr;
+static std::bitset<BIT_COUNT> *g_stdBitset = nullptr;
+
+static void buildInputs()
+{
+	std::mt19937_64 rng(1234);
+
+	g_keys.clear();
+
+	for (uint64_t i = 0; i < ELEMENT_COUNT; i++) {
+		g_keys.pushBack(rng());
+	}
+
+	g_vector = new Vector<uint64_t>();
+	g_stdVector = new std::vector<uint64_t>();
+	g_hashMap = new HashMap<uint64_t, uint64_t>();
+	g_stdHashMap = new std::unordered_map<uint64_t, uint64_t>();
+	g_linkedList = new LinkedList<uint64_t>();
+	g_stdList = new std::list<uint64_t>();
+	g_bitset = new Bitset<BIT_COUNT>();
+	g_stdBitset = new std::bitset<BIT_COUNT>();
+
+	for (uint64_t i = 0; i < ELEMENT_COUNT; i++)
+	{
+		uint64_t key = g_keys[i];
+
+		g_vector->pushBack(key);
+		g_stdVector->push_back(key);
+
+		g_hashMap->insert(key, i);
+		g_stdHashMap->insert({ key, i });
+
+		g_linkedList->pushBack(key);
+		g_stdList->push_back(key);
+
+		if (key & 1)
+		{
+			g_bitset->enable(i % BIT_COUNT);
+			g_stdBitset->set(i % BIT_COUNT);
+		}
+	}
+}
+
+// vector
+
+static void vectorPushBack()
+{
+	Vector<uint64_t> vector;
+
+	for (uint64_t key : g_keys) {
+		vector.pushBack(key);
+	}
+
+	doNotOptimize(vector.data());
+}
+
+static void stdVectorPushBack()
+{
+	std::vector<uint64_t> vector;
+
+	for (uint64_t key : g_keys) {
+		vector.push_back(key);
+	}
+
+	doNotOptimize(vector.data());
+}
+
+static void vectorIterate()
+{
+	uint64_t sum = 0;
+
+	for (uint64_t value : *g_vector) {
+		sum += value;
+	}
+
+	doNotOptimize(sum);
+}
+
+static void stdVectorIterate()
+{
+	uint64_t sum = 0;
+
+	for (uint64_t value : *g_stdVector) {
+		sum += value;
+	}
+
+	doNotOptimize(sum);
+}
+
+// from the front of a copy, so every erase has to shift everything after it down
+static void vectorEraseFront()
+{
+	Vector<uint64_t> vector = *g_vector;
+
+	while (!vector.empty()) {
+		vector.erase(0);
+	}
+
+	doNotOptimize(vector.data());
+}
+
+static void stdVectorEraseFront()
+{
+	std::vector<uint64_t> vector = *g_stdVector;
+
+	while (!vector.empty()) {
+		vector.erase(vector.begin());
+	}
+
+	doNotOptimize(vector.data());
+}
+
+// hash map
+
+static void hashMapInsert()
+{
+	HashMap<uint64_t, uint64_t> map;
+
+	for (uint64_t i = 0; i < ELEMENT_COUNT; i++) {
+		map.insert(g_keys[i], i);
+	}
+
+	doNotOptimize(map.getElementCount());
+}
+
+static void stdHashMapInsert()
+{
+	std::unordered_map<uint64_t, uint64_t> map;
+
+	for (uint64_t i = 0; i < ELEMENT_COUNT; i++) {
+		map.insert({ g_keys[i], i });
+	}
+
+	doNotOptimize(map.size());
+}
+
+static void hashMapLookup()
+{
+	uint64_t sum = 0;
+
+	for (uint64_t key : g_keys) {
+		sum += g_hashMap->get(key);
+	}
+
+	doNotOptimize(sum);
+}
+
+static void stdHashMapLookup()
+{
+	uint64_t sum = 0;
+
+	for (uint64_t key : g_keys) {
+		sum += g_stdHashMap->find(key)->second;
+	}
+
+	doNotOptimize(sum);
+}
+
+// keys that were never inserted, so every probe walks its whole bucket
+static void hashMapLookupMiss()
+{
+	uint64_t found = 0;
+
+	for (uint64_t key : g_keys) {
+		found += g_hashMap->contains(~key);
+	}
+
+	doNotOptimize(found);
+}
+
+static void stdHashMapLookupMiss()
+{
+	uint64_t found = 0;
+
+	for (uint64_t key : g_keys) {
+		found += g_stdHashMap->count(~key);
+	}
+
+	doNotOptimize(found);
+}
+
+static void hashMapIterate()
+{
+	uint64_t sum = 0;
+
+	for (auto &pair : *g_hashMap) {
+		sum += pair.second;
+	}
+
+	doNotOptimize(sum);
+}
+
+static void stdHashMapIterate()
+{
+	uint64_t sum = 0;
+
+	for (auto &pair : *g_stdHashMap) {
+		sum += pair.second;
+	}
+
+	doNotOptimize(sum);
+}
+
+// includes copying the map, there's no other way to get a full one back each run
+static void hashMapErase()
+{
+	HashMap<uint64_t, uint64_t> map = *g_hashMap;
+
+	for (uint64_t key : g_keys) {
+		map.erase(key);
+	}
+
+	doNotOptimize(map.getElementCount());
+}
+
+static void stdHashMapErase()
+{
+	std::unordered_map<uint64_t, uint64_t> map = *g_stdHashMap;
+
+	for (uint64_t key : g_keys) {
+		map.erase(key);
+	}
+
+	doNotOptimize(map.size());
+}
+
+// deque
+
+static void dequeQueue()
+{
+	Deque<uint64_t> deque;
+	uint64_t sum = 0;
+
+	for (uint64_t key : g_keys)
+	{
+		deque.pushBack(key);
+
+		// keeps a few hundred in flight, like a work queue would
+		if (deque.size() > 256) {
+			sum += deque.popFront();
+		}
+	}
+
+	doNotOptimize(sum);
+}
+
+static void stdDequeQueue()
+{
+	std::deque<uint64_t> deque;
+	uint64_t sum = 0;
+
+	for (uint64_t key : g_keys)
+	{
+		deque.push_back(key);
+
+		if (deque.size() > 256)
+		{
+			sum += deque.front();
+			deque.pop_front();
+		}
+	}
+
+	doNotOptimize(sum);
+}
+
+// linked list
+
+static void linkedListPushBack()
+{
+	LinkedList<uint64_t> list;
+
+	for (uint64_t key : g_keys) {
+		list.pushBack(key);
+	}
+
+	doNotOptimize(list.size());
+}
+
+static void stdListPushBack()
+{
+	std::list<uint64_t> list;
+
+	for (uint64_t key : g_keys) {
+		list.push_back(key);
+	}
+
+	doNotOptimize(list.size());
+}
+
+static void linkedListIterate()
+{
+	uint64_t sum = 0;
+
+	for (uint64_t value : *g_linkedList) {
+		sum += value;
+	}
+
+	doNotOptimize(sum);
+}
+
+static void stdListIterate()
+{
+	uint64_t sum = 0;
+
+	for (uint64_t value : *g_stdList) {
+		sum += value;
+	}
+
+	doNotOptimize(sum);
+}
+
+// bitset
+
+static void bitsetToggle()
+{
+	Bitset<BIT_COUNT> bits;
+
+	for (uint64_t key : g_keys) {
+		bits.toggle(key % BIT_COUNT);
+	}
+
+	doNotOptimize(bits.onCount());
+}
+
+static void stdBitsetToggle()
+{
+	std::bitset<BIT_COUNT> bits;
+
+	for (uint64_t key : g_keys) {
+		bits.flip(key % BIT_COUNT);
+	}
+
+	doNotOptimize(bits.count());
+}
+
+static void bitsetCount()
+{
+	doNotOptimize(g_bitset->onCount());
+}
+
+static void stdBitsetCount()
+{
+	doNotOptimize(g_stdBitset->count());
+}
+
+// function
+
+static uint64_t g_functionBias = 7;
+
+static void functionCall()
+{
+	Function<uint64_t(uint64_t)> fn = [&](uint64_t x) -> uint64_t { return x * 3 + g_functionBias; };
+	uint64_t sum = 0;
+
+	for (uint64_t key : g_keys) {
+		sum += fn(key);
+	}
+
+	doNotOptimize(sum);
+}
+
+static void stdFunctionCall()
+{
+	std::function<uint64_t(uint64_t)> fn = [&](uint64_t x) -> uint64_t { return x * 3 + g_functionBias; };
+	uint64_t sum = 0;
+
+	for (uint64_t key : g_keys) {
+		sum += fn(key);
+	}
+
+	doNotOptimize(sum);
+}
+
+// a capture too big for std::function's small buffer, so both have to allocate
+static void functionConstruct()
+{
+	uint64_t sum = 0;
+
+	for (uint64_t key : g_keys)
+	{
+		uint64_t a = key, b = key >> 1, c = key >> 2, d = key >> 3;
+		Function<uint64_t(void)> fn = [a, b, c, d]() -> uint64_t { return a + b + c + d; };
+
+		sum += fn();
+	}
+
+	doNotOptimize(sum);
+}
+
+static void stdFunctionConstruct()
+{
+	uint64_t sum = 0;
+
+	for (uint64_t key : g_keys)
+	{
+		uint64_t a = key, b = key >> 1, c = key >> 2, d = key >> 3;
+		std::function<uint64_t(void)> fn = [a, b, c, d]() -> uint64_t { return a + b + c + d; };
+
+		sum += fn();
+	}
+
+	doNotOptimize(sum);
+}
+
+void microbench::addContainerCases(Vector<Case> &cases)
+{
+	buildInputs();
+
+	cases.pushBack({ "vector",		"pushBack",			ELEMENT_COUNT,	vectorPushBack,		stdVectorPushBack,		0 });
+	cases.pushBack({ "vector",		"iterate",			ELEMENT_COUNT,	vectorIterate,		stdVectorIterate,		0 });
+	cases.pushBack({ "vector",		"erase front",		ELEMENT_COUNT,	vectorEraseFront,	stdVectorEraseFront,	0 });
+	cases.pushBack({ "hashmap",		"insert",			ELEMENT_COUNT,	hashMapInsert,		stdHashMapInsert,		0 });
+	cases.pushBack({ "hashmap",		"lookup (hit)",		ELEMENT_COUNT,	hashMapLookup,		stdHashMapLookup,		0 });
+	cases.pushBack({ "hashmap",		"lookup (miss)",	ELEMENT_COUNT,	hashMapLookupMiss,	stdHashMapLookupMiss,	0 });
+	cases.pushBack({ "hashmap",		"iterate",			ELEMENT_COUNT,	hashMapIterate,		stdHashMapIterate,		0 });
+	cases.pushBack({ "hashmap",		"copy + erase",		ELEMENT_COUNT,	hashMapErase,		stdHashMapErase,		0 });
+	cases.pushBack({ "deque",		"push/pop queue",	ELEMENT_COUNT,	dequeQueue,			stdDequeQueue,			0 });
+	cases.pushBack({ "linkedlist",	"pushBack",			ELEMENT_COUNT,	linkedListPushBack,	stdListPushBack,		0 });
+	cases.pushBack({ "linkedlist",	"iterate",			ELEMENT_COUNT,	linkedListIterate,	stdListIterate,			0 });
+	cases.pushBack({ "bitset",		"toggle",			ELEMENT_COUNT,	bitsetToggle,		stdBitsetToggle,		0 });
+	cases.pushBack({ "bitset",		"count",			BIT_COUNT,		bitsetCount,		stdBitsetCount,			0 });
+	cases.pushBack({ "function",	"call",				ELEMENT_COUNT,	functionCall,		stdFunctionCall,		0 });
+	cases.pushBack({ "function",	"construct + call",	ELEMENT_COUNT,	functionConstruct,	stdFunctionConstruct,	0 });
+}
@@ -0,0 +1,105 @@
+#include "harness.h"
+
+#include <functional>
+#include <string_view>
+#include <random>
+
+#include "container/string.h"
+
+using namespace llt;
+using microbench::doNotOptimize;
+
+static constexpr uint64_t KEY_COUNT = 4096;
+static constexpr uint64_t BLOB_SIZE = LLT_KILOBYTES(64);
+
+static Vector<uint64_t> g_keys;
+static Vector<String> g_names;
+static Vector<byte> g_blob;
+
+static void buildInputs()
+{
+	std::mt19937_64 rng(5678);
+
+	for (uint64_t i = 0; i < KEY_COUNT; i++) {
+		g_keys.pushBack(rng());
+	}
+
+	char buffer[64];
+
+	for (uint64_t i = 0; i < 256; i++)
+	{
+		snprintf(buffer, sizeof(buffer), "u_material_%u.albedoTexture", (unsigned)(rng() % 100000));
+		g_names.pushBack(String(buffer));
+	}
+
+	g_blob.resize(BLOB_SIZE);
+
+	for (uint64_t i = 0; i < BLOB_SIZE; i++) {
+		g_blob[i] = (byte)rng();
+	}
+}
+
+// what HashMap does with every integer key
+static void hashInteger()
+{
+	uint64_t sum = 0;
+
+	for (uint64_t &key : g_keys) {
+		sum += hash::calc(&key);
+	}
+
+	doNotOptimize(sum);
+}
+
+// only a fair fight with an stdlib that actually mixes integers, libstdc++ and libc++ hand them back unchanged
+static void stdHashInteger()
+{
+	uint64_t sum = 0;
+
+	for (uint64_t key : g_keys) {
+		sum += std::hash<uint64_t>()(key);
+	}
+
+	doNotOptimize(sum);
+}
+
+static void hashString()
+{
+	uint64_t sum = 0;
+
+	for (auto &name : g_names) {
+		sum += hash::calc(0, name.cstr());
+	}
+
+	doNotOptimize(sum);
+}
+
+static void stdHashString()
+{
+	uint64_t sum = 0;
+
+	for (auto &name : g_names) {
+		sum += std::hash<std::string_view>()(std::string_view(name.cstr(), name.length()));
+	}
+
+	doNotOptimize(sum);
+}
+
+static void hashBytes()
+{
+	doNotOptimize(hash::calcBytes(0, g_blob.data(), g_blob.size()));
+}
+
+static void stdHashBytes()
+{
+	doNotOptimize(std::hash<std::string_view>()(std::string_view((const char *)g_blob.data(), g_blob.size())));
+}
+
+void microbench::addHashCases(Vector<Case> &cases)
+{
+	buildInputs();
+
+	cases.pushBack({ "hash",	"calc (uint64)",		KEY_COUNT,			hashInteger,	stdHashInteger,	sizeof(uint64_t) });
+	cases.pushBack({ "hash",	"calc (c string)",		g_names.size(),		hashString,		stdHashString,	0 });
+	cases.pushBack({ "hash",	"calcBytes (64KB)",		1,					hashBytes,		stdHashBytes,	BLOB_SIZE });
+}
@@ -0,0 +1,205 @@
+#include "harness.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "math/calc.h"
+#include "math/transform.h"
+
+using namespace llt;
+using microbench::doNotOptimize;
+
+static constexpr uint64_t FLOAT_COUNT = 4096;
+static constexpr uint64_t MATRIX_COUNT = 1024;
+
+static Vector<float> g_floats;
+static Vector<float> g_output;
+
+static Vector<glm::mat4> g_matrices;
+static Vector<glm::mat4> g_matrixOutput;
+static Vector<glm::vec4> g_points;
+static Vector<glm::vec4> g_pointOutput;
+
+static Vector<glm::vec3> g_positions;
+static Vector<glm::quat> g_rotations;
+static Vector<Transform> g_transforms;
+
+static void buildInputs()
+{
+	std::mt19937 rng(91011);
+	std::uniform_real_distribution<float> dist(-2.0f, 2.0f);
+
+	for (uint64_t i = 0; i < FLOAT_COUNT; i++) {
+		g_floats.pushBack(dist(rng));
+	}
+
+	g_output.resize(FLOAT_COUNT);
+
+	for (uint64_t i = 0; i < MATRIX_COUNT; i++)
+	{
+		glm::vec3 position(dist(rng), dist(rng), dist(rng));
+		glm::vec3 axis = glm::normalize(glm::vec3(dist(rng), dist(rng), dist(rng)) + glm::vec3(0.0f, 0.0f, 4.0f));
+		glm::quat rotation = glm::angleAxis(dist(rng), axis);
+
+		g_matrices.pushBack(glm::translate(glm::mat4(1.0f), position) * glm::mat4_cast(rotation));
+		g_points.pushBack(glm::vec4(position, 1.0f));
+
+		g_positions.pushBack(position);
+		g_rotations.pushBack(rotation);
+	}
+
+	g_matrixOutput.resize(MATRIX_COUNT);
+	g_pointOutput.resize(MATRIX_COUNT);
+
+	g_transforms.resize(MATRIX_COUNT);
+
+	for (auto &transform : g_transforms) {
+		transform.setScale(glm::vec3(1.0f));
+	}
+}
+
+// scalar helpers over a whole array, against what std has for the same thing
+
+static void calcClamp()
+{
+	for (uint64_t i = 0; i < FLOAT_COUNT; i++) {
+		g_output[i] = CalcF::clamp(g_floats[i], -1.0f, 1.0f);
+	}
+
+	doNotOptimize(g_output.data());
+}
+
+static void stdClamp()
+{
+	for (uint64_t i = 0; i < FLOAT_COUNT; i++) {
+		g_output[i] = std::clamp(g_floats[i], -1.0f, 1.0f);
+	}
+
+	doNotOptimize(g_output.data());
+}
+
+static void calcLerp()
+{
+	for (uint64_t i = 0; i < FLOAT_COUNT; i++) {
+		g_output[i] = CalcF::lerp(g_floats[i], 1.0f, 0.25f);
+	}
+
+	doNotOptimize(g_output.data());
+}
+
+static void stdLerp()
+{
+	for (uint64_t i = 0; i < FLOAT_COUNT; i++) {
+		g_output[i] = std::lerp(g_floats[i], 1.0f, 0.25f);
+	}
+
+	doNotOptimize(g_output.data());
+}
+
+static void calcSqrt()
+{
+	for (uint64_t i = 0; i < FLOAT_COUNT; i++) {
+		g_output[i] = CalcF::sqrt(CalcF::abs(g_floats[i]));
+	}
+
+	doNotOptimize(g_output.data());
+}
+
+static void stdSqrt()
+{
+	for (uint64_t i = 0; i < FLOAT_COUNT; i++) {
+		g_output[i] = std::sqrt(std::abs(g_floats[i]));
+	}
+
+	doNotOptimize(g_output.data());
+}
+
+static void calcSinCos()
+{
+	for (uint64_t i = 0; i < FLOAT_COUNT; i++) {
+		g_output[i] = CalcF::sin(g_floats[i]) + CalcF::cos(g_floats[i]);
+	}
+
+	doNotOptimize(g_output.data());
+}
+
+static void stdSinCos()
+{
+	for (uint64_t i = 0; i < FLOAT_COUNT; i++) {
+		g_output[i] = std::sin(g_floats[i]) + std::cos(g_floats[i]);
+	}
+
+	doNotOptimize(g_output.data());
+}
+
+// matrix and transform kernels, nothing in std to hold them up against
+
+static void matrixMultiply()
+{
+	for (uint64_t i = 0; i < MATRIX_COUNT; i++) {
+		g_matrixOutput[i] = g_matrices[i] * g_matrices[(i + 1) % MATRIX_COUNT];
+	}
+
+	doNotOptimize(g_matrixOutput.data());
+}
+
+static void matrixInverse()
+{
+	for (uint64_t i = 0; i < MATRIX_COUNT; i++) {
+		g_matrixOutput[i] = glm::inverse(g_matrices[i]);
+	}
+
+	doNotOptimize(g_matrixOutput.data());
+}
+
+static void matrixTransformPoints()
+{
+	const glm::mat4 &viewProj = g_matrices[0];
+
+	for (uint64_t i = 0; i < MATRIX_COUNT; i++) {
+		g_pointOutput[i] = viewProj * g_points[i];
+	}
+
+	doNotOptimize(g_pointOutput.data());
+}
+
+// what happens to every moving object every frame
+static void transformRebuild()
+{
+	for (uint64_t i = 0; i < MATRIX_COUNT; i++)
+	{
+		g_transforms[i].setPosition(g_positions[i]);
+		g_matrixOutput[i] = g_transforms[i].getMatrix();
+	}
+
+	doNotOptimize(g_matrixOutput.data());
+}
+
+static void quaternionToMatrix()
+{
+	for (uint64_t i = 0; i < MATRIX_COUNT; i++) {
+		g_matrixOutput[i] = glm::mat4_cast(g_rotations[i]);
+	}
+
+	doNotOptimize(g_matrixOutput.data());
+}
+
+void microbench::addMathCases(Vector<Case> &cases)
+{
+	buildInputs();
+
+	cases.pushBack({ "calc",		"clamp",				FLOAT_COUNT,	calcClamp,				stdClamp,	0 });
+	cases.pushBack({ "calc",		"lerp",					FLOAT_COUNT,	calcLerp,				stdLerp,	0 });
+	cases.pushBack({ "calc",		"sqrt",					FLOAT_COUNT,	calcSqrt,				stdSqrt,	0 });
+	cases.pushBack({ "calc",		"sin + cos",			FLOAT_COUNT,	calcSinCos,				stdSinCos,	0 });
+	cases.pushBack({ "matrix",		"mat4 * mat4",			MATRIX_COUNT,	matrixMultiply,			nullptr,	0 });
+	cases.pushBack({ "matrix",		"inverse",				MATRIX_COUNT,	matrixInverse,			nullptr,	0 });
+	cases.pushBack({ "matrix",		"mat4 * vec4",			MATRIX_COUNT,	matrixTransformPoints,	nullptr,	0 });
+	cases.pushBack({ "matrix",		"quat to mat4",			MATRIX_COUNT,	quaternionToMatrix,		nullptr,	0 });
+	cases.pushBack({ "transform",	"set + getMatrix",		MATRIX_COUNT,	transformRebuild,		nullptr,	0 });
+}
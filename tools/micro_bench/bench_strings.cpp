@@ -0,0 +1,225 @@
+#include "harness.h"
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cctype>
+
+#include "container/string.h"
+
+using namespace llt;
+using microbench::doNotOptimize;
+
+static constexpr uint64_t STRING_COUNT = 256;
+
+// path-like, roughly what the asset and shader caches hash and compare all day
+static Vector<String> g_strings;
+static std::vector<std::string> g_stdStrings;
+
+static void buildInputs()
+{
+	static const char *directories[] = { "res/models/", "res/textures/", "res/shaders/", "res/fonts/" };
+	static const char *extensions[] = { ".gltf", ".png", ".spv", ".ttf" };
+
+	char buffer[128];
+
+	for (uint64_t i = 0; i < STRING_COUNT; i++)
+	{
+		snprintf(buffer, sizeof(buffer), "%sAsset_%04u/Scene_Part%u%s", directories[i % 4], (unsigned)(i * 2654435761u % 10000), (unsigned)i, extensions[(i / 4) % 4]);
+
+		g_strings.pushBack(String(buffer));
+		g_stdStrings.push_back(std::string(buffer));
+	}
+}
+
+static void stringConstruct()
+{
+	uint64_t total = 0;
+
+	for (auto &str : g_strings)
+	{
+		String copy(str.cstr());
+		total += copy.length();
+	}
+
+	doNotOptimize(total);
+}
+
+static void stdStringConstruct()
+{
+	uint64_t total = 0;
+
+	for (auto &str : g_stdStrings)
+	{
+		std::string copy(str.c_str());
+		total += copy.length();
+	}
+
+	doNotOptimize(total);
+}
+
+static void stringConcat()
+{
+	uint64_t total = 0;
+
+	for (auto &str : g_strings)
+	{
+		String joined = String("../../") + str;
+		total += joined.length();
+	}
+
+	doNotOptimize(total);
+}
+
+static void stdStringConcat()
+{
+	uint64_t total = 0;
+
+	for (auto &str : g_stdStrings)
+	{
+		std::string joined = std::string("../../") + str;
+		total += joined.length();
+	}
+
+	doNotOptimize(total);
+}
+
+static void stringCompare()
+{
+	uint64_t equal = 0;
+
+	for (uint64_t i = 0; i < STRING_COUNT; i++) {
+		equal += g_strings[i] == g_strings[(i * 7) % STRING_COUNT];
+	}
+
+	doNotOptimize(equal);
+}
+
+static void stdStringCompare()
+{
+	uint64_t equal = 0;
+
+	for (uint64_t i = 0; i < STRING_COUNT; i++) {
+		equal += g_stdStrings[i] == g_stdStrings[(i * 7) % STRING_COUNT];
+	}
+
+	doNotOptimize(equal);
+}
+
+static void stringFind()
+{
+	int64_t total = 0;
+
+	for (auto &str : g_strings) {
+		total += str.indexOf("Scene_Part");
+	}
+
+	doNotOptimize(total);
+}
+
+static void stdStringFind()
+{
+	int64_t total = 0;
+
+	for (auto &str : g_stdStrings) {
+		total += (int64_t)str.find("Scene_Part");
+	}
+
+	doNotOptimize(total);
+}
+
+static void stringEndsWith()
+{
+	uint64_t count = 0;
+
+	for (auto &str : g_strings) {
+		count += str.endsWith(".spv");
+	}
+
+	doNotOptimize(count);
+}
+
+static void stdStringEndsWith()
+{
+	uint64_t count = 0;
+
+	for (auto &str : g_stdStrings) {
+		count += str.ends_with(".spv");
+	}
+
+	doNotOptimize(count);
+}
+
+static void stringToLower()
+{
+	uint64_t total = 0;
+
+	for (auto &str : g_strings)
+	{
+		String lower = str.toLower();
+		total += lower[0];
+	}
+
+	doNotOptimize(total);
+}
+
+static void stdStringToLower()
+{
+	uint64_t total = 0;
+
+	for (auto &str : g_stdStrings)
+	{
+		std::string lower = str;
+		std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) -> char { return (char)std::tolower(c); });
+		total += lower[0];
+	}
+
+	doNotOptimize(total);
+}
+
+static void stringSplit()
+{
+	uint64_t parts = 0;
+
+	for (auto &str : g_strings) {
+		parts += str.split("/").size();
+	}
+
+	doNotOptimize(parts);
+}
+
+static void stdStringSplit()
+{
+	uint64_t parts = 0;
+
+	for (auto &str : g_stdStrings)
+	{
+		std::vector<std::string> split;
+		uint64_t start = 0;
+		uint64_t end = 0;
+
+		while ((end = str.find('/', start)) != std::string::npos)
+		{
+			split.push_back(str.substr(start, end - start));
+			start = end + 1;
+		}
+
+		split.push_back(str.substr(start));
+		parts += split.size();
+	}
+
+	doNotOptimize(parts);
+}
+
+void microbench::addStringCases(Vector<Case> &cases)
+{
+	buildInputs();
+
+	cases.pushBack({ "string",	"construct",	STRING_COUNT,	stringConstruct,	stdStringConstruct,	0 });
+	cases.pushBack({ "string",	"concat",		STRING_COUNT,	stringConcat,		stdStringConcat,	0 });
+	cases.pushBack({ "string",	"compare",		STRING_COUNT,	stringCompare,		stdStringCompare,	0 });
+	cases.pushBack({ "string",	"find",			STRING_COUNT,	stringFind,			stdStringFind,		0 });
+	cases.pushBack({ "string",	"endsWith",		STRING_COUNT,	stringEndsWith,		stdStringEndsWith,	0 });
+	cases.pushBack({ "string",	"toLower",		STRING_COUNT,	stringToLower,		stdStringToLower,	0 });
+	cases.pushBack({ "string",	"split",		STRING_COUNT,	stringSplit,		stdStringSplit,		0 });
+}
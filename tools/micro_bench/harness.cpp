@@ -0,0 +1,174 @@
+#include "harness.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "core/cpu_profiler.h"
+
+using namespace llt;
+
+static uint64_t g_allocationCount = 0;
+
+// everything funnels through here, std containers and mem::alloc() alike, so both sides are counted the same way
+void *operator new (std::size_t size)
+{
+	g_allocationCount++;
+
+	if (void *ptr = std::malloc(size ? size : 1)) {
+		return ptr;
+	}
+
+	throw std::bad_alloc();
+}
+
+void *operator new[] (std::size_t size)
+{
+	return operator new (size);
+}
+
+void operator delete (void *ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[] (void *ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete (void *ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[] (void *ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+uint64_t microbench::getAllocationCount()
+{
+	return g_allocationCount;
+}
+
+static double ticksToSeconds(uint64_t ticks)
+{
+	return (double)ticks / (double)cpuprofiler::getTicksPerSecond();
+}
+
+microbench::Result microbench::measure(RunFn run, uint64_t opsPerRun, const Options &options)
+{
+	Result result = {};
+
+	// also gets any lazily built inputs and the caches warmed up
+	uint64_t warmupStart = cpuprofiler::now();
+
+	do {
+		run();
+	} while (ticksToSeconds(cpuprofiler::now() - warmupStart) < options.warmupSeconds);
+
+	// the allocation count doesn't change from run to run, so one is enough
+	uint64_t allocationsBefore = getAllocationCount();
+	run();
+	result.allocationsPerOp = (double)(getAllocationCount() - allocationsBefore) / (double)opsPerRun;
+
+	// keep doubling the runs per sample until a sample is long enough that the clock's resolution doesn't matter
+	uint64_t runsPerSample = 1;
+
+	for (;;)
+	{
+		uint64_t start = cpuprofiler::now();
+
+		for (uint64_t i = 0; i < runsPerSample; i++) {
+			run();
+		}
+
+		if (ticksToSeconds(cpuprofiler::now() - start) >= options.sampleSeconds) {
+			break;
+		}
+
+		runsPerSample *= 2;
+	}
+
+	Vector<double> samples;
+
+	for (unsigned i = 0; i < options.samples; i++)
+	{
+		uint64_t start = cpuprofiler::now();
+
+		for (uint64_t j = 0; j < runsPerSample; j++) {
+			run();
+		}
+
+		double seconds = ticksToSeconds(cpuprofiler::now() - start);
+		samples.pushBack((seconds * 1e9) / (double)(runsPerSample * opsPerRun));
+	}
+
+	std::sort(samples.data(), samples.data() + samples.size());
+
+	result.nsPerOp = samples[samples.size() / 2];
+	result.minNsPerOp = samples[0];
+
+	return result;
+}
+
+static bool passesFilter(const microbench::Case &benchCase, const char *filter)
+{
+	if (!filter) {
+		return true;
+	}
+
+	return std::strstr(benchCase.group, filter) || std::strstr(benchCase.name, filter);
+}
+
+unsigned microbench::runCases(const Vector<Case> &cases, const Options &options)
+{
+	LLT_LOG("%-12s %-28s %10s %10s %10s %8s %10s %10s %8s", "group", "case", "ns/op", "min", "std ns/op", "vs std", "allocs/op", "std allocs", "GB/s");
+
+	unsigned count = 0;
+
+	for (auto &benchCase : cases)
+	{
+		if (!passesFilter(benchCase, options.filter)) {
+			continue;
+		}
+
+		Result ours = measure(benchCase.run, benchCase.opsPerRun, options);
+
+		char gbPerSecond[16] = "-";
+
+		if (benchCase.bytesPerOp > 0) {
+			snprintf(gbPerSecond, sizeof(gbPerSecond), "%.2f", (double)benchCase.bytesPerOp / ours.nsPerOp);
+		}
+
+		if (benchCase.stdRun)
+		{
+			Result theirs = measure(benchCase.stdRun, benchCase.opsPerRun, options);
+
+			// above 1 is slower than std
+			LLT_LOG(
+				"%-12s %-28s %10.2f %10.2f %10.2f %7.2fx %10.2f %10.2f %8s",
+				benchCase.group, benchCase.name,
+				ours.nsPerOp, ours.minNsPerOp, theirs.nsPerOp, ours.nsPerOp / theirs.nsPerOp,
+				ours.allocationsPerOp, theirs.allocationsPerOp,
+				gbPerSecond
+			);
+		}
+		else
+		{
+			LLT_LOG(
+				"%-12s %-28s %10.2f %10.2f %10s %8s %10.2f %10s %8s",
+				benchCase.group, benchCase.name,
+				ours.nsPerOp, ours.minNsPerOp, "-", "-",
+				ours.allocationsPerOp, "-",
+				gbPerSecond
+			);
+		}
+
+		count++;
+	}
+
+	return count;
+}
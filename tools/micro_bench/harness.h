@@ -0,0 +1,84 @@
+#ifndef MICRO_BENCH_HARNESS_H_
+#define MICRO_BENCH_HARNESS_H_
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif // _MSC_VER
+
+#include "core/common.h"
+
+#include "container/vector.h"
+
+namespace llt
+{
+	namespace microbench
+	{
+		/*
+		 * Does one run's worth of work, whatever that is for the case, always the same amount.
+		 */
+		using RunFn = void (*)();
+
+		/**
+		 * One thing being measured, done once our way and (where there is one) once the std:: way.
+		 * A run does opsPerRun operations, so each side's time and allocation count can be given per op.
+		 */
+		struct Case
+		{
+			const char *group;
+			const char *name;
+			uint64_t opsPerRun;
+			RunFn run;
+			RunFn stdRun;		// null if nothing in std does the same thing
+			uint64_t bytesPerOp;	// only set for throughput cases, adds a GB/s column
+		};
+
+		struct Result
+		{
+			double nsPerOp;		// median over the samples
+			double minNsPerOp;
+			double allocationsPerOp;
+		};
+
+		struct Options
+		{
+			const char *filter = nullptr;	// only cases whose group or name contains this
+			unsigned samples = 9;
+			double warmupSeconds = 0.05;
+			double sampleSeconds = 0.02;	// each sample repeats the run until it's taken at least this long
+		};
+
+		/*
+		 * Every allocation made through the global operator new since the program started, mem::alloc() included.
+		 */
+		uint64_t getAllocationCount();
+
+		Result measure(RunFn run, uint64_t opsPerRun, const Options &options);
+
+		/*
+		 * Runs every case that passes the filter and prints a table of the results. Returns how many ran.
+		 */
+		unsigned runCases(const Vector<Case> &cases, const Options &options);
+
+		/*
+		 * Keeps the compiler from throwing away work whose result is never used.
+		 */
+		template <typename T>
+		inline void doNotOptimize(const T &value)
+		{
+#if defined(_MSC_VER)
+			static const void *volatile sink;
+			sink = &value;
+			_ReadWriteBarrier();
+#else
+			asm volatile("" : : "r,m"(value) : "memory");
+#endif // _MSC_VER
+		}
+
+		void addContainerCases(Vector<Case> &cases);
+		void addStringCases(Vector<Case> &cases);
+		void addHashCases(Vector<Case> &cases);
+		void addMathCases(Vector<Case> &cases);
+	}
+}
+
+#endif // MICRO_BENCH_HARNESS_H_
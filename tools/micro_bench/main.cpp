@@ -0,0 +1,57 @@
+#include "harness.h"
+
+#include <cstring>
+#include <cstdlib>
+
+using namespace llt;
+
+/*
+ * Times the containers, strings, hashing and math everything else is built on, each case next to the std:: way
+ * of doing the same thing where there is one. Every case runs for a short warm-up, then for a number of samples
+ * long enough to not be at the mercy of the clock, and the median is what's reported. Allocations are counted by
+ * replacing the global operator new, so std containers and ours are counted the same way.
+ *
+ * The tool is always built optimised, but the library under it isn't in a debug build and asserts stay on,
+ * so only trust numbers from a release build (-DDEBUG_MODE=false).
+ *
+ * usage: lilythorn_micro_bench [filter] [--samples N]
+ */
+int main(int argc, char **argv)
+{
+	microbench::Options options;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+			options.samples = (unsigned)atoi(argv[++i]);
+		} else {
+			options.filter = argv[i];
+		}
+	}
+
+	if (options.samples == 0) {
+		options.samples = 1;
+	}
+
+#ifdef LLT_DEBUG
+	LLT_LOG("Debug build, asserts are on and the library isn't optimised. Numbers are only good for comparing against each other.");
+	LLT_LOG("");
+#endif // LLT_DEBUG
+
+	Vector<microbench::Case> cases;
+
+	microbench::addContainerCases(cases);
+	microbench::addStringCases(cases);
+	microbench::addHashCases(cases);
+	microbench::addMathCases(cases);
+
+	unsigned count = microbench::runCases(cases, options);
+
+	if (count == 0)
+	{
+		LLT_LOG("Nothing matched '%s'.", options.filter);
+		return 1;
+	}
+
+	return 0;
+}
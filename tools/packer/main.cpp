@@ -0,0 +1,162 @@
+#include "io/archive.h"
+#include "io/mapped_file.h"
+#include "io/mmap_stream.h"
+#include "io/buffered_stream.h"
+
+#include <filesystem>
+#include <cstring>
+
+using namespace llt;
+
+/*
+ * Packs every file under a directory into a single archive, with paths stored relative to that directory.
+ * Mesh caches (.llmc) are packed too, always stored uncompressed, so cook the meshes before packing.
+ *
+ * usage: lilythorn_packer <input directory> <output archive> [--store] [--exclude <substring>]... [--exclude-file <path>]...
+ *
+ * --store          don't try to compress anything
+ * --exclude        skip any file whose relative path contains the substring (can be repeated)
+ * --exclude-file   same as --exclude for every line of the file, blank lines and lines starting with # are ignored
+ */
+
+static bool readExcludeFile(const char *path, Vector<String> &excludes)
+{
+	MmapStream file(path, MAPPED_FILE_ACCESS_SEQUENTIAL);
+
+	// empty files can't be mapped, but there's nothing to exclude in one either
+	if (!file.isOpen())
+	{
+		std::error_code ec;
+		return std::filesystem::file_size(path, ec) == 0 && !ec;
+	}
+
+	BufferedStream stream(file, LLT_KILOBYTES(4));
+	String line;
+
+	while (stream.readLine(line))
+	{
+		String pattern = line.trim();
+
+		if (pattern.empty() || pattern[0] == '#') {
+			continue;
+		}
+
+		excludes.pushBack(pattern);
+	}
+
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 3)
+	{
+		LLT_LOG("usage: lilythorn_packer <input directory> <output archive> [--store] [--exclude <substring>]... [--exclude-file <path>]...");
+		return 1;
+	}
+
+	const char *inputDirectory = argv[1];
+	const char *outputPath = argv[2];
+
+	bool compress = true;
+
+	// other archives never belong in an archive
+	Vector<String> excludes = { ".llpk" };
+
+	for (int i = 3; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--store") == 0) {
+			compress = false;
+		} else if (strcmp(argv[i], "--exclude") == 0 && i + 1 < argc) {
+			excludes.pushBack(argv[++i]);
+		} else if (strcmp(argv[i], "--exclude-file") == 0 && i + 1 < argc) {
+			if (!readExcludeFile(argv[++i], excludes))
+			{
+				LLT_LOG("Failed to read exclude file: %s", argv[i]);
+				return 1;
+			}
+		} else {
+			LLT_LOG("Unknown argument: %s", argv[i]);
+			return 1;
+		}
+	}
+
+	std::error_code ec;
+
+	if (!std::filesystem::is_directory(inputDirectory, ec))
+	{
+		LLT_LOG("Not a directory: %s", inputDirectory);
+		return 1;
+	}
+
+	ArchiveWriter writer;
+	uint32_t compressedCount = 0;
+
+	for (auto &entry : std::filesystem::recursive_directory_iterator(inputDirectory, ec))
+	{
+		if (!entry.is_regular_file()) {
+			continue;
+		}
+
+		std::string relative = std::filesystem::relative(entry.path(), inputDirectory, ec).generic_string();
+
+		bool excluded = false;
+
+		for (auto &exclude : excludes)
+		{
+			if (strstr(relative.c_str(), exclude.cstr()))
+			{
+				excluded = true;
+				break;
+			}
+		}
+
+		if (excluded) {
+			continue;
+		}
+
+		MappedFile file(entry.path().string().c_str(), MAPPED_FILE_ACCESS_SEQUENTIAL);
+
+		if (!file.isOpen() && entry.file_size() > 0)
+		{
+			LLT_LOG("Failed to read %s, skipping.", relative.c_str());
+			continue;
+		}
+
+		uint64_t storedBefore = writer.getTotalStoredSize();
+
+		// mesh caches are laid out to be handed straight to the staging buffer, so keep them mappable rather than compressed
+		bool isMeshCache = relative.ends_with(".llmc");
+
+		writer.addFile(relative.c_str(), file.data(), file.size(), compress && !isMeshCache);
+
+		bool wasCompressed = writer.getTotalStoredSize() - storedBefore < file.size();
+
+		if (wasCompressed) {
+			compressedCount++;
+		}
+
+		LLT_LOG("  %-64s %10llu -> %10llu%s",
+			relative.c_str(),
+			(unsigned long long)file.size(),
+			(unsigned long long)(writer.getTotalStoredSize() - storedBefore),
+			wasCompressed ? " (lz4)" : ""
+		);
+	}
+
+	if (!writer.save(outputPath))
+	{
+		LLT_LOG("Failed to write archive: %s", outputPath);
+		return 1;
+	}
+
+	LLT_LOG("Packed %u files (%u compressed), %.2f MB -> %.2f MB into %s",
+		writer.getEntryCount(),
+		compressedCount,
+		(double)writer.getTotalSize() / (double)LLT_MEGABYTES(1),
+		(double)writer.getTotalStoredSize() / (double)LLT_MEGABYTES(1),
+		outputPath
+	);
+
+	return 0;
+}